@@ -10,17 +10,20 @@ ENDIF()
 # Don't embed rpaths in the executables.
 SET(CMAKE_SKIP_RPATH ON)
 
-# If we're not using x86, disable emulation functionality.
-# TODO: Port everything from asm to C/C++!
-# TODO: Add configuration option.
+# Starscream and mdZ80 are written in x86 assembly.
+# On other systems, the portable 68000 (md68k) and Z80 cores are used.
 INCLUDE(CheckSystemX8632)
 CHECK_SYSTEM_X86_32(GENS_CPU_X86_32)
 IF(GENS_CPU_X86_32)
-	SET(GENS_ENABLE_EMULATION 1)
+	OPTION(USE_PORTABLE_M68K "Use the portable C++ 68000 core instead of Starscream." OFF)
+	OPTION(USE_PORTABLE_Z80 "Use the portable C Z80 core instead of the mdZ80 assembly core." OFF)
+ELSE(GENS_CPU_X86_32)
+	SET(USE_PORTABLE_M68K 1)
+	SET(USE_PORTABLE_Z80 1)
 ENDIF(GENS_CPU_X86_32)
-IF(NOT GENS_ENABLE_EMULATION)
-	MESSAGE(WARNING "System is not X86_32; CPU emulation will be disabled. (FOR DEBUGGING ONLY)")
-ENDIF(NOT GENS_ENABLE_EMULATION)
+
+# CPU emulation is available on all systems.
+SET(GENS_ENABLE_EMULATION 1)
 
 # Common flag variables:
 # [common]
@@ -33,6 +33,9 @@
 #include "libgens/sound/SoundMgr.hpp"
 using LibGens::SoundMgr;
 
+// LibGens A/V recorder.
+#include "libgens/Util/AvRecorder.hpp"
+
 // aligned_malloc()
 #include "libcompat/aligned_malloc.h"
 
@@ -46,6 +49,7 @@ GensPortAudio::GensPortAudio()
 	// Clear internal variables.
 	m_bufferPos = 0;
 	m_sampleSize = 0;
+	m_avRecorder = nullptr;
 
 	// FIXME: SoundMgr::writeStereo() requires a 16-byte
 	// aligned destination buffer for SSE2.
@@ -312,6 +316,11 @@ int GensPortAudio::write(void)
 	// Increment the buffer position.
 	m_bufferPos += written;
 
+	// Send the audio to the A/V recorder.
+	// This only copies the samples; it never blocks.
+	if (m_avRecorder && written > 0)
+		m_avRecorder->pushAudio(m_tmpWriteBuf, written, (m_stereo ? 2 : 1));
+
 	// Unlock the ring buffer.
 	// TODO
 	//m_buffer.writeUnlock();
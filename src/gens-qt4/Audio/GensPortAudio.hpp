@@ -38,6 +38,10 @@
 // Audio Ring Buffer.
 #include "ARingBuffer.hpp"
 
+namespace LibGens {
+	class AvRecorder;
+}
+
 namespace GensQt4 {
 
 class GensPortAudio : public ABackend
@@ -67,6 +71,15 @@ class GensPortAudio : public ABackend
 		 */
 		int write(void);
 
+		/**
+		 * Set the A/V recorder.
+		 * write() sends audio to the recorder
+		 * in addition to the audio stream.
+		 * @param avRecorder A/V recorder. (If nullptr, audio isn't recorded.)
+		 */
+		void setAvRecorder(LibGens::AvRecorder *avRecorder)
+			{ m_avRecorder = avRecorder; }
+
 		void wpSegWait(void) const { /*m_buffer.wpSegWait();*/ }
 		bool isBufferEmpty(void) const { return true; /*return m_buffer.isBufferEmpty();*/ }
 
@@ -107,6 +120,9 @@ class GensPortAudio : public ABackend
 		// GensPortAudio will be removed later, so I'm using
 		// a bounce buffer as a workaround.
 		int16_t *m_tmpWriteBuf;
+
+		// A/V recorder. (not owned by GensPortAudio)
+		LibGens::AvRecorder *m_avRecorder;
 };
 
 }
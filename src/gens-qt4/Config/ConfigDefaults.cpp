@@ -54,6 +54,7 @@ const ConfigDefaults::DefaultSetting ConfigDefaults::DefaultSettings[] =
 	{"OSD/fpsColor",		"#ffffff", 0, 0,	DefaultSetting::VT_COLOR, 0, 0},
 	{"OSD/msgEnabled",		"true", 0, 0,		DefaultSetting::VT_BOOL, 0, 0},
 	{"OSD/msgColor",		"#ffffff", 0, 0,	DefaultSetting::VT_COLOR, 0, 0},
+	{"OSD/perfCountersEnabled",	"false", 0, 0,		DefaultSetting::VT_BOOL, 0, 0},
 
 	/** Intro effect. **/
 	// TODO: Use enum constants for range.
@@ -96,12 +97,16 @@ const ConfigDefaults::DefaultSetting ConfigDefaults::DefaultSettings[] =
 
 	/** Savestates. **/
 	{"Savestates/saveSlot", "0", 0, DefaultSetting::DEF_ALLOW_SAME_VALUE, DefaultSetting::VT_RANGE, 0, 9},
+	{"Savestates/compression", "2", 0, 0, DefaultSetting::VT_RANGE, 0, 3},	// LibZomg::Zomg::CompressionProfile
+	{"Savestates/preview", "true", 0, 0, DefaultSetting::VT_BOOL, 0, 0},
 
 	/** GensWindow configuration. **/
 	{"GensWindow/showMenuBar", "true", 0, 0, DefaultSetting::VT_BOOL, 0, 0},
 
 	/** Emulation options. (Options menu) **/
 	{"Options/enableSRam", "true", 0, 0, DefaultSetting::VT_BOOL, 0, 0},
+	{"Options/runAhead", "0", 0, 0, DefaultSetting::VT_RANGE, 0, 8},
+	{"Options/runAheadThread", "false", 0, 0, DefaultSetting::VT_BOOL, 0, 0},
 
 	/** End of array. **/
 	{nullptr, nullptr, 0, 0, DefaultSetting::VT_NONE, 0, 0}
@@ -28,8 +28,18 @@
 
 // LibGens includes.
 #include "libgens/Util/Timing.hpp"
+#include "libgens/Util/RewindBuffer.hpp"
+#include "libgens/Util/RunAhead.hpp"
+#include "libgens/Util/SaveStateWriter.hpp"
+#include "libgens/Util/AvRecorder.hpp"
+#include "libgens/Util/VgmLogger.hpp"
 #include "libgens/Rom.hpp"
 using LibGens::Rom;
+using LibGens::RewindBuffer;
+using LibGens::RunAhead;
+using LibGens::SaveStateWriter;
+using LibGens::AvRecorder;
+using LibGens::VgmLogger;
 
 #include "libgens/EmuContext/EmuContext.hpp"
 #include "libgens/EmuContext/EmuContextFactory.hpp"
@@ -93,6 +103,21 @@ EmuManager::EmuManager(QObject *parent, VBackend *vBackend)
 	m_rom = nullptr;
 	m_paused.data = 0;
 
+	// Rewind buffer is created when a ROM is loaded.
+	m_rewindBuffer = nullptr;
+	m_rewindFrames = 0;
+
+	// Run-ahead manager is created when a ROM is loaded.
+	m_runAhead = nullptr;
+
+	// A/V recorder.
+	m_avRecorder = new AvRecorder();
+	m_avRecordNumber = 0;
+
+	// VGM logger.
+	m_vgmLogger = new VgmLogger();
+	m_vgmNumber = 0;
+
 	// If a video backend is specified, connect its destroyed() signal.
 	if (m_vBackend) {
 		connect(m_vBackend, SIGNAL(destroyed(QObject*)),
@@ -103,6 +128,15 @@ EmuManager::EmuManager(QObject *parent, VBackend *vBackend)
 	// TODO: Move saveSlot validation intn ConfigStore
 	m_saveSlot = gqt4_cfg->getInt(QLatin1String("Savestates/saveSlot")) % 10;
 
+	// Savestate writer.
+	m_saveStateWriter = new SaveStateWriter();
+
+	// Savestate compression settings.
+	LibZomg::Zomg::SetDefaultCompressionProfile((LibZomg::Zomg::CompressionProfile)
+		gqt4_cfg->getInt(QLatin1String("Savestates/compression")));
+	LibZomg::Zomg::SetDefaultPreviewEnabled(
+		gqt4_cfg->get(QLatin1String("Savestates/preview")).toBool());
+
 	// TODO: Load initial VdpPalette settings.
 
 	// Create the Audio Backend.
@@ -113,6 +147,10 @@ EmuManager::EmuManager(QObject *parent, VBackend *vBackend)
 	// Configuration settings.
 	gqt4_cfg->registerChangeNotification(QLatin1String("Savestates/saveSlot"),
 					this, SLOT(saveSlot_changed_slot(QVariant)));
+	gqt4_cfg->registerChangeNotification(QLatin1String("Savestates/compression"),
+					this, SLOT(zomgCompression_changed_slot(QVariant)));
+	gqt4_cfg->registerChangeNotification(QLatin1String("Savestates/preview"),
+					this, SLOT(zomgPreview_changed_slot(QVariant)));
 	gqt4_cfg->registerChangeNotification(QLatin1String("autoFixChecksum"),
 					this, SLOT(autoFixChecksum_changed_slot(QVariant)));
 
@@ -145,10 +183,25 @@ EmuManager::EmuManager(QObject *parent, VBackend *vBackend)
 	// Emulation options. (Options menu)
 	gqt4_cfg->registerChangeNotification(QLatin1String("Options/enableSRam"),
 					this, SLOT(enableSRam_changed_slot(QVariant)));
+
+	// Onscreen display.
+	gqt4_cfg->registerChangeNotification(QLatin1String("OSD/perfCountersEnabled"),
+					this, SLOT(perfCountersEnabled_changed_slot(QVariant)));
 }
 
 EmuManager::~EmuManager()
 {
+	// Delete the A/V recorder.
+	// This finishes the recording, if any.
+	m_audio->setAvRecorder(nullptr);
+	delete m_avRecorder;
+	m_avRecorder = nullptr;
+
+	// Delete the VGM logger.
+	// The logger was detached when the ROM was closed.
+	delete m_vgmLogger;
+	m_vgmLogger = nullptr;
+
 	// Delete the audio backend.
 	m_audio->close();
 	delete m_audio;
@@ -157,6 +210,19 @@ EmuManager::~EmuManager()
 	// Delete the ROM.
 	// TODO
 	
+	// Delete the rewind buffer.
+	delete m_rewindBuffer;
+	m_rewindBuffer = nullptr;
+
+	// Delete the run-ahead manager.
+	delete m_runAhead;
+	m_runAhead = nullptr;
+
+	// Delete the savestate writer.
+	// This waits for pending savestates to be written.
+	delete m_saveStateWriter;
+	m_saveStateWriter = nullptr;
+
 	// TODO: Do we really need to clear this?
 	m_paused.data = 0;
 	
@@ -431,11 +497,24 @@ int EmuManager::loadRom_int(LibGens::Rom *rom)
 	// Delete any existing emulation context.
 	// FIXME: Delete gqt4_emuContext after VBackend is finished using it. (MEMORY LEAK)
 	m_vBackend->setEmuContext(nullptr);
+	delete m_runAhead;
+	m_runAhead = nullptr;
 	delete gqt4_emuContext;
 
 	// Create the emulation context.
 	// TODO: Move the emuContext to GensWindow.
 	gqt4_emuContext = EmuContextFactory::createContext(rom, lg_region);
+
+	// Create the secondary context for threaded run-ahead, if enabled.
+	// NOTE: This must be done before the ROM is closed.
+	const int runAheadFrames = gqt4_cfg->getInt(QLatin1String("Options/runAhead"));
+	EmuContext *runAheadContext = nullptr;
+	if (gqt4_emuContext && runAheadFrames > 0 &&
+	    gqt4_cfg->get(QLatin1String("Options/runAheadThread")).toBool() &&
+	    RunAhead::IsThreadedModeSupported())
+	{
+		runAheadContext = EmuContextFactory::createContext(rom, lg_region);
+	}
 	rom->close();	// TODO: Let EmuContext handle this...
 
 	if (!gqt4_emuContext || !gqt4_emuContext->isRomOpened()) {
@@ -443,6 +522,7 @@ int EmuManager::loadRom_int(LibGens::Rom *rom)
 		// TODO: EmuMD error code constants.
 		// TODO: Show an error message.
 		fprintf(stderr, "Error: Initialization of gqt4_emuContext failed. (TODO: Error code.)\n");
+		delete runAheadContext;
 		delete gqt4_emuContext;
 		gqt4_emuContext = nullptr;
 		delete rom;
@@ -474,6 +554,22 @@ int EmuManager::loadRom_int(LibGens::Rom *rom)
 	// Set the EmuContext settings.
 	// TODO: Load these in EmuContext directly?
 	gqt4_emuContext->setSaveDataEnable(gqt4_cfg->get(QLatin1String("Options/enableSRam")).toBool());
+	gqt4_emuContext->setPerfCountersEnabled(gqt4_cfg->get(QLatin1String("OSD/perfCountersEnabled")).toBool());
+
+	// Create the rewind buffer.
+	delete m_rewindBuffer;
+	m_rewindBuffer = new RewindBuffer();
+	m_rewindFrames = 0;
+
+	// Create the run-ahead manager.
+	if (runAheadFrames > 0) {
+		m_runAhead = new RunAhead(gqt4_emuContext, runAheadFrames);
+		if (runAheadContext && runAheadContext->isRomOpened()) {
+			m_runAhead->setSecondary(runAheadContext);
+		} else {
+			delete runAheadContext;
+		}
+	}
 
 	// TODO: The following should be set in the specific EmuContext.
 
@@ -499,6 +595,7 @@ int EmuManager::loadRom_int(LibGens::Rom *rom)
 	// Start the emulation thread.
 	m_paused.data = 0;
 	gqt4_emuThread = new EmuThread();
+	gqt4_emuThread->setRunAhead(m_runAhead);
 	QObject::connect(gqt4_emuThread, SIGNAL(frameDone(bool)),
 			 this, SLOT(emuFrameDone(bool)));
 	gqt4_emuThread->start();
@@ -570,12 +667,23 @@ int EmuManager::closeRom(bool emitStateChanged)
 		// (SaveData() will call the LibGens OSD handler if necessary.)
 		gqt4_emuContext->saveData();
 
+		// Stop A/V recording and VGM logging.
+		doAvRecord(false);
+		doVgmLog(false);
+
 		// Delete the emulation context.
 		// FIXME: Delete gqt4_emuContext after VBackend is finished using it. (MEMORY LEAK)
 		m_vBackend->setEmuContext(nullptr);
+		delete m_runAhead;
+		m_runAhead = nullptr;
 		delete gqt4_emuContext;
 		gqt4_emuContext = nullptr;
 
+		// Delete the rewind buffer.
+		delete m_rewindBuffer;
+		m_rewindBuffer = nullptr;
+		m_rewindFrames = 0;
+
 		// Delete the Rom instance.
 		// TODO: Handle this in gqt4_emuContext.
 		delete m_rom;
@@ -722,6 +830,12 @@ void EmuManager::emuFrameDone(bool wasFastFrame)
 			double fps = ((double)m_frames / (timeDiff_fps / 1000000.0));
 			emit updateFps(fps);
 
+			// Push the per-subsystem frame times.
+			// NOTE: The emulation thread is waiting, so
+			// the performance counters are stable here.
+			if (gqt4_emuContext->isPerfCountersEnabled())
+				emit updatePerf(getPerfSummary());
+
 			// Reset the timer and frame counter.
 			m_lastTime_fps = thisTime;
 			m_frames = 0;
@@ -736,6 +850,9 @@ void EmuManager::emuFrameDone(bool wasFastFrame)
 	if (!m_qEmuRequest.isEmpty())
 		processQEmuRequest();
 
+	// Check for savestates that have been written.
+	checkSaveStates();
+
 	// Update the I/O Manager.
 	if (m_keyManager) {
 		m_keyManager->updateIoManager(gqt4_emuContext->m_ioManager);
@@ -745,10 +862,26 @@ void EmuManager::emuFrameDone(bool wasFastFrame)
 	if (!wasFastFrame)
 		updateVBackend();
 
+	// Queue the frame for the A/V recorder.
+	// If the recorder can't keep up, the
+	// frame is dropped; this never blocks.
+	const bool recording = m_avRecorder->isOpen();
+	if (recording && !wasFastFrame)
+		m_avRecorder->pushFrame(gqt4_emuContext->m_vdp->MD_Screen);
+
 	// If emulation is paused, don't resume the emulation thread.
 	if (m_paused.data)
 		return;
 
+	// Rewind, or capture the current frame for rewinding.
+	// NOTE: Capturing while rewinding would undo the rewind.
+	if (m_rewindFrames > 0) {
+		m_rewindFrames--;
+		m_rewindBuffer->rewind(gqt4_emuContext);
+	} else {
+		m_rewindBuffer->capture(gqt4_emuContext);
+	}
+
 	/** Auto Frame Skip **/
 	// TODO: Figure out how to properly implement the old Gens method of synchronizing to audio.
 #if 0
@@ -792,6 +925,10 @@ void EmuManager::emuFrameDone(bool wasFastFrame)
 	// Update the last time value.
 	m_lastTime = thisTime;
 
+	// Every frame is rendered while recording.
+	if (recording)
+		doFastFrame = false;
+
 	// Tell the emulation thread that we're ready for another frame.
 	if (gqt4_emuThread)
 		gqt4_emuThread->resume(doFastFrame);
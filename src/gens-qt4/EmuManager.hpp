@@ -27,6 +27,7 @@
 // Qt includes.
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
+#include <QtCore/QStringList>
 #include <QtGui/QImage>
 
 // LibGens includes.
@@ -42,6 +43,14 @@
 // Video Backend.
 #include "VBackend/VBackend.hpp"
 
+namespace LibGens {
+	class AvRecorder;
+	class VgmLogger;
+	class RewindBuffer;
+	class RunAhead;
+	class SaveStateWriter;
+}
+
 namespace GensQt4 {
 
 // Audio backend.
@@ -77,6 +86,8 @@ class EmuManager : public QObject
 			{ return m_paused; }
 		inline int saveSlot(void) const
 			{ return m_saveSlot; }
+		bool isAvRecording(void) const;
+		bool isVgmLogging(void) const;
 
 		// ROM information.
 		QString romName(void);		// Active ROM name.
@@ -106,6 +117,12 @@ class EmuManager : public QObject
 
 	signals:
 		void updateFps(double fps);
+
+		/**
+		 * Per-subsystem frame times have been updated.
+		 * @param perf One line per subsystem, with p50/p99 times. (empty if disabled)
+		 */
+		void updatePerf(const QStringList &perf);
 		void stateChanged(void);		// Emulation state changed. Update the Gens title.
 
 		/**
@@ -122,6 +139,18 @@ class EmuManager : public QObject
 		 */
 		void osdShowPreview(int duration, const QImage& img);
 
+		/**
+		 * A/V recording has started or stopped.
+		 * @param recording True if recording; false if not.
+		 */
+		void avRecordingChanged(bool recording);
+
+		/**
+		 * VGM logging has started or stopped.
+		 * @param logging True if logging; false if not.
+		 */
+		void vgmLoggingChanged(bool logging);
+
 	protected:
 		// Load ROM.
 		// HACK: Works around the threading issue when opening a new ROM without closing the old one.
@@ -164,6 +193,37 @@ class EmuManager : public QObject
 		/** Savestates. **/
 		int m_saveSlot;
 
+		// Savestates are written on a background thread.
+		LibGens::SaveStateWriter *m_saveStateWriter;
+
+		/** Rewind. **/
+		LibGens::RewindBuffer *m_rewindBuffer;
+
+		// Number of frames left to rewind.
+		// QAction doesn't report key releases, so each
+		// rewind request rewinds for a fixed number of
+		// frames. Key autorepeat keeps it going.
+		int m_rewindFrames;
+
+		/** Run-ahead. **/
+		// Created when a ROM is loaded, if enabled.
+		// NOTE: Must be deleted before gqt4_emuContext.
+		LibGens::RunAhead *m_runAhead;
+
+		/** A/V recording. **/
+		// Frames are rendered and recorded on the
+		// emulation thread; files are written on
+		// the recorder's worker thread.
+		LibGens::AvRecorder *m_avRecorder;
+		int m_avRecordNumber;	// Current recording number.
+
+		/** VGM logging. **/
+		// Sound chip writes are logged on the emulation
+		// thread; the file is written on the logger's
+		// worker thread.
+		LibGens::VgmLogger *m_vgmLogger;
+		int m_vgmNumber;	// Current VGM log number.
+
 		/**
 		 * Get the savestate filename.
 		 * TODO: Move savestate code to another file?
@@ -306,6 +366,10 @@ class EmuManager : public QObject
 				RQT_RESET_CPU,
 				RQT_REGION_CODE,
 				RQT_ENABLE_SRAM,
+				RQT_PERF_COUNTERS,
+				RQT_REWIND,
+				RQT_AV_RECORD,
+				RQT_VGM_LOG,
 			};
 
 			// RQT_PALETTE_SETTING types.
@@ -369,6 +433,15 @@ class EmuManager : public QObject
 
 				// Enable/disable SRam.
 				bool enableSRam;
+
+				// Enable/disable performance counters.
+				bool perfCounters;
+
+				// Start/stop A/V recording.
+				bool avRecord;
+
+				// Start/stop VGM logging.
+				bool vgmLog;
 			};
 		};
 
@@ -390,6 +463,23 @@ class EmuManager : public QObject
 		void saveState(void); // Save to current slot.
 		void loadState(void); // Load from current slot.
 
+		/**
+		 * Rewind the emulation state.
+		 */
+		void rewind(void);
+
+		/**
+		 * Start or stop A/V recording.
+		 * @param record True to start recording; false to stop.
+		 */
+		void avRecord(bool record);
+
+		/**
+		 * Start or stop VGM logging.
+		 * @param log True to start logging; false to stop.
+		 */
+		void vgmLog(bool log);
+
 		/**
 		 * Toggle the paused state.
 		 */
@@ -404,6 +494,18 @@ class EmuManager : public QObject
 		 */
 		void saveSlot_changed_slot(const QVariant &saveSlot);
 
+		/**
+		 * Savestate compression profile has changed.
+		 * @param compression (int) New compression profile.
+		 */
+		void zomgCompression_changed_slot(const QVariant &compression); // LibZomg::Zomg::CompressionProfile
+
+		/**
+		 * Savestate preview image setting has changed.
+		 * @param preview (bool) New preview image setting.
+		 */
+		void zomgPreview_changed_slot(const QVariant &preview);
+
 		/**
 		 * Change the Auto Fix Checksum setting.
 		 * @param autoFixChecksum (bool) New Auto Fix Checksum setting.
@@ -428,6 +530,12 @@ class EmuManager : public QObject
 		 */
 		void enableSRam_changed_slot(const QVariant &enableSRam);
 
+		/**
+		 * Enable performance counters setting has changed.
+		 * @param perfCounters (bool) New Enable performance counters setting.
+		 */
+		void perfCountersEnabled_changed_slot(const QVariant &perfCounters);
+
 	public slots:
 		/**
 		 * Reset the emulator.
@@ -470,6 +578,10 @@ class EmuManager : public QObject
 		void doSaveState(QString filename, int saveSlot);
 		void doLoadState(QString filename, int saveSlot);
 		void doSaveSlot(int newSaveSlot);
+		void checkSaveStates(void);
+		void doRewind(void);
+		void doAvRecord(bool record);
+		void doVgmLog(bool log);
 
 		void doPauseRequest(paused_t newPaused);
 		void doResetEmulator(bool hardReset);
@@ -480,6 +592,9 @@ class EmuManager : public QObject
 		void doRegionCode(LibGens::SysVersion::RegionCode_t region);
 
 		void doEnableSRam(bool enableSRam);
+
+		void doPerfCounters(bool perfCounters);
+		QStringList getPerfSummary(void) const;
 };
 
 /**
@@ -38,9 +38,16 @@ using LibGens::EmuContext;
 #include "libgens/Vdp/Vdp.hpp"
 #include "libgens/Util/MdFb.hpp"
 #include "libgens/Util/Screenshot.hpp"
+#include "libgens/Util/RewindBuffer.hpp"
+#include "libgens/Util/SaveStateWriter.hpp"
+#include "libgens/Util/AvRecorder.hpp"
+#include "libgens/Util/VgmLogger.hpp"
 using LibGens::Vdp;
 using LibGens::MdFb;
 using LibGens::Screenshot;
+using LibGens::SaveStateWriter;
+using LibGens::AvRecorder;
+using LibGens::VgmLogger;
 
 // LibGens CPU includes.
 #include "libgens/cpu/M68K.hpp"
@@ -176,6 +183,58 @@ void EmuManager::loadState(void)
 		processQEmuRequest();
 }
 
+/**
+ * Rewind the emulation state.
+ */
+void EmuManager::rewind(void)
+{
+	if (!m_rom)
+		return;
+
+	EmuRequest_t rq;
+	rq.rqType = EmuRequest_t::RQT_REWIND;
+	m_qEmuRequest.enqueue(rq);
+
+	if (m_paused.data)
+		processQEmuRequest();
+}
+
+/**
+ * Start or stop A/V recording.
+ * @param record True to start recording; false to stop.
+ */
+void EmuManager::avRecord(bool record)
+{
+	if (!m_rom)
+		return;
+
+	EmuRequest_t rq;
+	rq.rqType = EmuRequest_t::RQT_AV_RECORD;
+	rq.avRecord = record;
+	m_qEmuRequest.enqueue(rq);
+
+	if (m_paused.data)
+		processQEmuRequest();
+}
+
+/**
+ * Start or stop VGM logging.
+ * @param log True to start logging; false to stop.
+ */
+void EmuManager::vgmLog(bool log)
+{
+	if (!m_rom)
+		return;
+
+	EmuRequest_t rq;
+	rq.rqType = EmuRequest_t::RQT_VGM_LOG;
+	rq.vgmLog = log;
+	m_qEmuRequest.enqueue(rq);
+
+	if (m_paused.data)
+		processQEmuRequest();
+}
+
 /**
  * Set the paused state.
  * @param paused_set Paused flags to set.
@@ -256,6 +315,28 @@ void EmuManager::saveSlot_changed_slot(const QVariant &saveSlot)
 		processQEmuRequest();
 }
 
+/**
+ * Savestate compression profile has changed.
+ * @param compression (int) New compression profile.
+ */
+void EmuManager::zomgCompression_changed_slot(const QVariant &compression)
+{
+	// SaveStateWriter captures the compression settings
+	// when the state is saved, so this doesn't need to be
+	// queued for the emulation thread.
+	LibZomg::Zomg::SetDefaultCompressionProfile(
+		(LibZomg::Zomg::CompressionProfile)compression.toInt());
+}
+
+/**
+ * Savestate preview image setting has changed.
+ * @param preview (bool) New preview image setting.
+ */
+void EmuManager::zomgPreview_changed_slot(const QVariant &preview)
+{
+	LibZomg::Zomg::SetDefaultPreviewEnabled(preview.toBool());
+}
+
 /**
  * Enable SRam/EEPRom setting has changed.
  * @param enableSRam (bool) New Enable SRam/EEPRom setting.
@@ -272,6 +353,22 @@ void EmuManager::enableSRam_changed_slot(const QVariant &enableSRam)
 		processQEmuRequest();
 }
 
+/**
+ * Enable performance counters setting has changed.
+ * @param perfCounters (bool) New Enable performance counters setting.
+ */
+void EmuManager::perfCountersEnabled_changed_slot(const QVariant &perfCounters)
+{
+	// Queue the Enable performance counters request.
+	EmuRequest_t rq;
+	rq.rqType = EmuRequest_t::RQT_PERF_COUNTERS;
+	rq.perfCounters = perfCounters.toBool();
+	m_qEmuRequest.enqueue(rq);
+
+	if (!m_rom || m_paused.data)
+		processQEmuRequest();
+}
+
 /**
  * Change the Auto Fix Checksum setting.
  * @param autoFixChecksum (bool) New Auto Fix Checksum setting.
@@ -476,6 +573,26 @@ void EmuManager::processQEmuRequest(void)
 				doEnableSRam(rq.enableSRam);
 				break;
 
+			case EmuRequest_t::RQT_PERF_COUNTERS:
+				// Enable/disable performance counters.
+				doPerfCounters(rq.perfCounters);
+				break;
+
+			case EmuRequest_t::RQT_REWIND:
+				// Rewind the emulation state.
+				doRewind();
+				break;
+
+			case EmuRequest_t::RQT_AV_RECORD:
+				// Start or stop A/V recording.
+				doAvRecord(rq.avRecord);
+				break;
+
+			case EmuRequest_t::RQT_VGM_LOG:
+				// Start or stop VGM logging.
+				doVgmLog(rq.vgmLog);
+				break;
+
 			case EmuRequest_t::RQT_UNKNOWN:
 			default:
 				// Unknown emulation request.
@@ -577,28 +694,53 @@ void EmuManager::doAudioStereo(bool newStereo)
  */
 void EmuManager::doSaveState(QString filename, int saveSlot)
 {
-	// Save the ZOMG file.
+	// Capture the emulation state.
+	// The ZOMG file is written on a background thread.
+	// checkSaveStates() shows the OSD message once it's written.
 	const QString nativeFilename = QDir::toNativeSeparators(filename);
-	int ret = gqt4_emuContext->zomgSave(nativeFilename.toUtf8().constData());
-
-	QString osdMsg;
-	if (ret == 0) {
-		// Savestate saved.
-		if (saveSlot >= 0) {
-			//: OSD message indicating a savestate has been saved.
-			osdMsg = tr("State %1 saved.", "osd").arg(saveSlot);
-		} else {
-			//: OSD message indicating a savestate has been saved using a specified filename.
-			osdMsg = tr("State saved in %1", "osd").arg(nativeFilename);
-		}
-	} else {
+	int ret = m_saveStateWriter->save(gqt4_emuContext,
+			nativeFilename.toUtf8().constData(), saveSlot);
+	if (ret != 0) {
 		// Error saving savestate.
 		//: OSD message indicating an error occurred while saving the savestate.
-		osdMsg = tr("Error saving state: %1", "osd").arg(ret);
+		emit osdPrintMsg(1500, tr("Error saving state: %1", "osd").arg(ret));
+		return;
 	}
 
-	// Print the message to the OSD.
-	emit osdPrintMsg(1500, osdMsg);
+	if (m_paused.data) {
+		// Emulation is paused, so emuFrameDone() won't
+		// be called. Wait for the savestate here.
+		m_saveStateWriter->flush();
+		checkSaveStates();
+	}
+}
+
+/**
+ * Show OSD messages for savestates that have been written.
+ */
+void EmuManager::checkSaveStates(void)
+{
+	SaveStateWriter::Result result;
+	while (m_saveStateWriter->poll(&result)) {
+		QString osdMsg;
+		if (result.ret == 0) {
+			// Savestate saved.
+			if (result.id >= 0) {
+				//: OSD message indicating a savestate has been saved.
+				osdMsg = tr("State %1 saved.", "osd").arg(result.id);
+			} else {
+				//: OSD message indicating a savestate has been saved using a specified filename.
+				osdMsg = tr("State saved in %1", "osd").arg(QString::fromUtf8(result.filename.c_str()));
+			}
+		} else {
+			// Error saving savestate.
+			//: OSD message indicating an error occurred while saving the savestate.
+			osdMsg = tr("Error saving state: %1", "osd").arg(result.ret);
+		}
+
+		// Print the message to the OSD.
+		emit osdPrintMsg(1500, osdMsg);
+	}
 }
 
 /**
@@ -610,6 +752,10 @@ void EmuManager::doLoadState(QString filename, int saveSlot)
 {
 	// TODO: Redraw the screen if emulation is paused.
 
+	// Make sure the savestate isn't still being written.
+	m_saveStateWriter->flush();
+	checkSaveStates();
+
 	// Load the ZOMG file.
 	const QString nativeFilename = QDir::toNativeSeparators(filename);
 	int ret = gqt4_emuContext->zomgLoad(nativeFilename.toUtf8().constData());
@@ -932,4 +1078,223 @@ void EmuManager::doEnableSRam(bool enableSRam)
 	emit osdPrintMsg(1500, msg);
 }
 
+/**
+ * Enable/disable performance counters.
+ * @param perfCounters New enable/disable performance counters value.
+ */
+void EmuManager::doPerfCounters(bool perfCounters)
+{
+	if (gqt4_emuContext)
+		gqt4_emuContext->setPerfCountersEnabled(perfCounters);
+
+	// Clear the OSD if the counters were disabled.
+	if (!perfCounters)
+		emit updatePerf(QStringList());
+}
+
+/**
+ * Rewind the emulation state.
+ * The actual rewinding is done in emuFrameDone().
+ */
+void EmuManager::doRewind(void)
+{
+	if (!m_rewindBuffer)
+		return;
+
+	if (m_rewindBuffer->count() == 0) {
+		//: OSD message indicating there's nothing to rewind.
+		emit osdPrintMsg(1500, tr("Rewind buffer is empty.", "osd"));
+		return;
+	}
+
+	// Rewind for 0.5 seconds. This covers the usual
+	// keyboard autorepeat delay.
+	m_rewindFrames = (gqt4_emuContext->versionRegisterObject()->isPal() ? 25 : 30);
+}
+
+/**
+ * Is A/V recording active?
+ * @return True if recording; false if not.
+ */
+bool EmuManager::isAvRecording(void) const
+{
+	return m_avRecorder->isOpen();
+}
+
+/**
+ * Start or stop A/V recording.
+ * @param record True to start recording; false to stop.
+ */
+void EmuManager::doAvRecord(bool record)
+{
+	if (m_avRecorder->isOpen() == record)
+		return;
+
+	QString osdMsg;
+	if (!record) {
+		// Stop recording.
+		// This waits for queued frames to be written.
+		m_audio->setAvRecorder(nullptr);
+		int ret = m_avRecorder->close();
+		AvRecorder::Stats stats;
+		m_avRecorder->stats(&stats);
+		if (ret == 0) {
+			//: OSD message indicating A/V recording has stopped.
+			osdMsg = tr("Recording %1 stopped. (%2 frames, %3 dropped; %4 audio samples dropped)", "osd")
+				.arg(m_avRecordNumber).arg(stats.frames).arg(stats.droppedFrames)
+				.arg(stats.droppedSamples);
+		} else {
+			//: OSD message indicating an error occurred while writing an A/V recording.
+			osdMsg = tr("Error writing recording %1: %2", "osd")
+				.arg(m_avRecordNumber).arg(QLatin1String(strerror(-ret)));
+		}
+		emit osdPrintMsg(1500, osdMsg);
+		emit avRecordingChanged(false);
+		return;
+	}
+
+	// Get the ROM filename (without extension).
+	const QString romFilename = QString::fromUtf8(m_rom->filename_baseNoExt().c_str());
+
+	// Find a recording number that isn't in use.
+	const QString recFilenamePrefix =
+		gqt4_cfg->configPath(PathConfig::GCPATH_WAV) + romFilename + QChar(L'_');
+	QString vidFilename, wavFilename;
+	int recNumber = -1;
+	do {
+		recNumber++;
+		const QString recFilename = recFilenamePrefix +
+				QString::number(recNumber).rightJustified(3, QChar(L'0'));
+		vidFilename = recFilename + QLatin1String(".ppm");
+		wavFilename = recFilename + QLatin1String(".wav");
+	} while (QFile::exists(vidFilename) || QFile::exists(wavFilename));
+
+	// Start recording.
+	int ret = m_avRecorder->open(
+		QDir::toNativeSeparators(vidFilename).toUtf8().constData(),
+		QDir::toNativeSeparators(wavFilename).toUtf8().constData(),
+		m_audio->rate(), (m_audio->isStereo() ? 2 : 1));
+	if (ret != 0) {
+		//: OSD message indicating an error occurred while starting an A/V recording.
+		osdMsg = tr("Error starting recording: %1", "osd")
+			.arg(QLatin1String(strerror(-ret)));
+		emit osdPrintMsg(1500, osdMsg);
+		emit avRecordingChanged(false);
+		return;
+	}
+
+	m_avRecordNumber = recNumber;
+	m_audio->setAvRecorder(m_avRecorder);
+
+	//: OSD message indicating A/V recording has started.
+	osdMsg = tr("Recording %1 started.", "osd").arg(recNumber);
+	emit osdPrintMsg(1500, osdMsg);
+	emit avRecordingChanged(true);
+}
+
+/**
+ * Is VGM logging active?
+ * @return True if logging; false if not.
+ */
+bool EmuManager::isVgmLogging(void) const
+{
+	return m_vgmLogger->isOpen();
+}
+
+/**
+ * Start or stop VGM logging.
+ * @param log True to start logging; false to stop.
+ */
+void EmuManager::doVgmLog(bool log)
+{
+	if (m_vgmLogger->isOpen() == log)
+		return;
+
+	QString osdMsg;
+	if (!log) {
+		// Stop logging.
+		// This waits for queued frames to be written.
+		if (gqt4_emuContext)
+			gqt4_emuContext->setVgmLogger(nullptr);
+		int ret = m_vgmLogger->close();
+		VgmLogger::Stats stats;
+		m_vgmLogger->stats(&stats);
+		if (ret == 0) {
+			//: OSD message indicating VGM logging has stopped.
+			osdMsg = tr("VGM log %1 stopped. (%2 frames, %3 events dropped)", "osd")
+				.arg(m_vgmNumber).arg(stats.frames).arg(stats.droppedEvents);
+		} else {
+			//: OSD message indicating an error occurred while writing a VGM log.
+			osdMsg = tr("Error writing VGM log %1: %2", "osd")
+				.arg(m_vgmNumber).arg(QLatin1String(strerror(-ret)));
+		}
+		emit osdPrintMsg(1500, osdMsg);
+		emit vgmLoggingChanged(false);
+		return;
+	}
+
+	// Get the ROM filename (without extension).
+	const QString romFilename = QString::fromUtf8(m_rom->filename_baseNoExt().c_str());
+
+	// Find a VGM log number that isn't in use.
+	const QString vgmFilenamePrefix =
+		gqt4_cfg->configPath(PathConfig::GCPATH_VGM) + romFilename + QChar(L'_');
+	QString vgmFilename;
+	int vgmNumber = -1;
+	do {
+		vgmNumber++;
+		vgmFilename = vgmFilenamePrefix +
+				QString::number(vgmNumber).rightJustified(3, QChar(L'0')) +
+				QLatin1String(".vgm");
+	} while (QFile::exists(vgmFilename));
+
+	// Start logging.
+	int ret = m_vgmLogger->open(
+		QDir::toNativeSeparators(vgmFilename).toUtf8().constData(),
+		gqt4_emuContext->versionRegisterObject()->isPal());
+	if (ret != 0) {
+		//: OSD message indicating an error occurred while starting a VGM log.
+		osdMsg = tr("Error starting VGM log: %1", "osd")
+			.arg(QLatin1String(strerror(-ret)));
+		emit osdPrintMsg(1500, osdMsg);
+		emit vgmLoggingChanged(false);
+		return;
+	}
+
+	m_vgmNumber = vgmNumber;
+	gqt4_emuContext->setVgmLogger(m_vgmLogger);
+
+	//: OSD message indicating VGM logging has started.
+	osdMsg = tr("VGM log %1 started.", "osd").arg(vgmNumber);
+	emit osdPrintMsg(1500, osdMsg);
+	emit vgmLoggingChanged(true);
+}
+
+/**
+ * Get the per-subsystem frame times.
+ * This must be called while the emulation thread is waiting.
+ * @return One line per subsystem, with p50/p99 times.
+ */
+QStringList EmuManager::getPerfSummary(void) const
+{
+	QStringList perf;
+	if (!gqt4_emuContext)
+		return perf;
+
+	const LibGens::PerfHistory *history = gqt4_emuContext->perfHistory();
+	if (history->count() == 0)
+		return perf;
+
+	for (int i = 0; i <= LibGens::PerfHistory::FRAME_TOTAL; i++) {
+		const QString name = (i == LibGens::PerfHistory::FRAME_TOTAL
+			? tr("Frame", "perf")
+			: QLatin1String(LibGens::PerfCounters::SubsystemName((LibGens::PerfCounters::Subsystem)i)));
+		perf.append(QString::fromLatin1("%1 %2/%3")
+			.arg(name)
+			.arg((double)history->percentile(i, 50) / 1.0e6, 0, 'f', 2)
+			.arg((double)history->percentile(i, 99) / 1.0e6, 0, 'f', 2));
+	}
+	return perf;
+}
+
 }
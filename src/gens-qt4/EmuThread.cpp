@@ -24,6 +24,9 @@
 #include "EmuThread.hpp"
 #include "gqt4_main.hpp"
 
+// LibGens
+#include "libgens/Util/RunAhead.hpp"
+
 namespace GensQt4 {
 
 EmuThread::EmuThread(QObject *parent)
@@ -31,6 +34,7 @@ EmuThread::EmuThread(QObject *parent)
 {
 	m_stop = false;
 	m_doFastFrame = false;
+	m_runAhead = nullptr;
 }
 
 EmuThread::~EmuThread()
@@ -73,10 +77,17 @@ void EmuThread::run(void)
 	while (!m_stop)
 	{
 		// Run a frame of emulation.
-		if (!m_doFastFrame)
-			gqt4_emuContext->execFrame();
-		else
-			gqt4_emuContext->execFrameFast();
+		if (m_runAhead) {
+			if (!m_doFastFrame)
+				m_runAhead->execFrame();
+			else
+				m_runAhead->execFrameFast();
+		} else {
+			if (!m_doFastFrame)
+				gqt4_emuContext->execFrame();
+			else
+				gqt4_emuContext->execFrameFast();
+		}
 		
 		// Signal that the frame has been drawn.
 		emit frameDone(m_doFastFrame);
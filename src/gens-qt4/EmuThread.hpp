@@ -28,6 +28,10 @@
 #include <QtCore/QWaitCondition>
 #include <QtCore/QMutex>
 
+namespace LibGens {
+	class RunAhead;
+}
+
 namespace GensQt4 {
 
 class EmuThread : public QThread
@@ -46,6 +50,14 @@ class EmuThread : public QThread
 	public:
 		inline bool isStopRequested(void);
 
+		/**
+		 * Set the run-ahead manager.
+		 * This must be called before the thread is started.
+		 * @param runAhead Run-ahead manager, or nullptr to run frames directly.
+		 */
+		inline void setRunAhead(LibGens::RunAhead *runAhead)
+			{ m_runAhead = runAhead; }
+
 	signals:
 		void frameDone(bool wasFastFrame);
 
@@ -60,6 +72,9 @@ class EmuThread : public QThread
 
 		bool m_stop;
 		bool m_doFastFrame;
+
+		// Run-ahead manager. (not owned by EmuThread)
+		LibGens::RunAhead *m_runAhead;
 };
 
 /**
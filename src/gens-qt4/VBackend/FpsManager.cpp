@@ -53,8 +53,12 @@ void FpsManager::reset(void)
 		m_fps[i] = -1.0;
 	}
 
+	// Clear the per-subsystem frame times.
+	m_perf.clear();
+
 	// Average FPS has been updated.
 	emit updated(m_fpsAvg);
+	emit perfUpdated(m_perf);
 }
 
 /**
@@ -86,4 +90,14 @@ void FpsManager::push(double fps)
 	emit updated(m_fpsAvg);
 }
 
+/**
+ * Push the per-subsystem frame times.
+ * @param perf One line per subsystem, with p50/p99 times. (empty if disabled)
+ */
+void FpsManager::pushPerf(const QStringList &perf)
+{
+	m_perf = perf;
+	emit perfUpdated(m_perf);
+}
+
 }
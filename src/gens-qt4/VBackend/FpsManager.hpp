@@ -25,6 +25,7 @@
 #define __GENS_QT4_VBACKEND_FPSMANAGER_HPP__
 
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 
 namespace GensQt4 {
 
@@ -58,6 +59,18 @@ class FpsManager : public QObject
 		 */
 		double get(void);
 
+		/**
+		 * Push the per-subsystem frame times.
+		 * @param perf One line per subsystem, with p50/p99 times. (empty if disabled)
+		 */
+		void pushPerf(const QStringList &perf);
+
+		/**
+		 * Get the per-subsystem frame times.
+		 * @return One line per subsystem, with p50/p99 times. (empty if disabled)
+		 */
+		QStringList getPerf(void) const;
+
 	signals:
 		/**
 		 * The FPS manager has been updated.
@@ -65,11 +78,18 @@ class FpsManager : public QObject
 		 */
 		void updated(double fps);
 
+		/**
+		 * The per-subsystem frame times have been updated.
+		 * @param perf One line per subsystem, with p50/p99 times.
+		 */
+		void perfUpdated(const QStringList &perf);
+
 	private:
 		// TODO: Make this a private class?
 		double m_fps[8];
 		double m_fpsAvg;	// Average fps.
 		int m_fpsPtr;		// Pointer to next fps slot to use.
+		QStringList m_perf;	// Per-subsystem frame times.
 };
 
 /**
@@ -79,6 +99,13 @@ class FpsManager : public QObject
 inline double FpsManager::get(void)
 	{ return m_fpsAvg; }
 
+/**
+ * Get the per-subsystem frame times.
+ * @return One line per subsystem, with p50/p99 times. (empty if disabled)
+ */
+inline QStringList FpsManager::getPerf(void) const
+	{ return m_perf; }
+
 }
 
 #endif /* __GENS_QT4_VBACKEND_FPSMANAGER_HPP__ */
@@ -835,6 +835,17 @@ void GLBackend::printOsdText(void)
 		printOsdLine(ms_Osd_chrW+1, y+1, sFps);
 		glb_setColor(osdFpsColor());
 		printOsdLine(ms_Osd_chrW, y, sFps);
+
+		// Per-subsystem frame times, if enabled.
+		// Printed bottom-up, so the first subsystem is on top.
+		const QStringList perf = m_fpsManager.getPerf();
+		for (int i = (perf.size() - 1); i >= 0; i--) {
+			y -= ms_Osd_chrH;
+			glb_setColor(clShadow);
+			printOsdLine(ms_Osd_chrW+1, y+1, perf[i]);
+			glb_setColor(osdFpsColor());
+			printOsdLine(ms_Osd_chrW, y, perf[i]);
+		}
 	}
 
 	// If messages are enabled, print them on the screen.
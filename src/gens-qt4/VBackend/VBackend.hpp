@@ -228,6 +228,7 @@ class VBackend : public QWidget
 		// FPS manager.
 		void fpsReset(void);
 		void fpsPush(double fps);
+		void fpsPushPerf(const QStringList &perf);
 
 		// Recording OSD.
 		int recSetStatus(const QString &component, bool isRecording);
@@ -210,6 +210,17 @@ void VBackend::fpsPush(double fps)
 		setOsdListDirty();
 }
 
+/**
+ * Push the per-subsystem frame times.
+ * @param perf One line per subsystem, with p50/p99 times. (empty if disabled)
+ */
+void VBackend::fpsPushPerf(const QStringList &perf)
+{
+	m_fpsManager.pushPerf(perf);
+	if (osdFpsEnabled() && isRunning() && !isPaused())
+		setOsdListDirty();
+}
+
 /*! Recording status. **/
 
 /**
@@ -76,6 +76,7 @@ const GensMenuShortcutsPrivate::KeyBinding_t GensMenuShortcutsPrivate::KeyBindin
 	{"graphics/stretch/full",	"actionGraphicsStretchFull"},
 	// Graphics menu.
 	{"graphics/screenShot",		"actionGraphicsScreenshot"},
+	{"graphics/record",		"actionGraphicsRecord"},
 
 	// System menu.
 	{"system/region",		"actionSystemRegion"},
@@ -98,6 +99,7 @@ const GensMenuShortcutsPrivate::KeyBinding_t GensMenuShortcutsPrivate::KeyBindin
 	// Options menu.
 	{"options/enableSRam",		"actionOptionsSRAM"},
 	{"options/controllers",		"actionOptionsControllers"},
+	{"options/vgmLog",		"actionOptionsVgmLog"},
 
 	// NOTE: Test menus aren't going to be added here.
 
@@ -123,6 +125,7 @@ const GensMenuShortcutsPrivate::KeyBinding_t GensMenuShortcutsPrivate::KeyBindin
 	{"other/saveSlotNext",		"actionNoMenuSaveSlotNext"},
 	{"other/saveSaveAs",		"actionNoMenuSaveStateAs"},
 	{"other/saveLoadFrom",		"actionNoMenuLoadStateFrom"},
+	{"other/rewind",		"actionNoMenuRewind"},
 
 	// End of key bindings.
 	{nullptr, nullptr}
@@ -183,6 +186,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_gens[KeyBinding_count+1
 	0,				// actionGraphicsStretchFull
 	// Graphics menu.
 	KEYM_SHIFT | KEYV_BACKSPACE,	// actionGraphicsScreenshot
+	KEYV_F11,			// actionGraphicsRecord
 
 	// System menu.
 	KEYM_SHIFT | KEYV_F3,		// actionSystemRegion
@@ -205,6 +209,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_gens[KeyBinding_count+1
 	// Options menu.
 	0,				// actionOptionsSRAM
 	0,				// actionOptionsControllers
+	KEYM_SHIFT | KEYV_F11,		// actionOptionsVgmLog
 
 	// NOTE: Test menus aren't going to be added here.
 
@@ -229,6 +234,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_gens[KeyBinding_count+1
 	KEYV_F7,			// actionNoMenuSaveSlotNext
 	KEYM_SHIFT | KEYV_F5,		// actionNoMenuSaveStateAs
 	KEYM_SHIFT | KEYV_F8,		// actionNoMenuLoadStateFrom
+	KEYV_BACKSPACE,			// actionNoMenuRewind
 
 	// End of key bindings.
 	// TODO: Make this -1, or remove the last entry entirely?
@@ -297,6 +303,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_kega[KeyBinding_count+1
 	0,				// actionGraphicsStretchFull
 	// Graphics menu.
 	KEYM_SHIFT | KEYV_F12,		// actionGraphicsScreenshot
+	0,				// actionGraphicsRecord
 
 	// System menu.
 	0,				// actionSystemRegion
@@ -319,6 +326,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_kega[KeyBinding_count+1
 	// Options menu.
 	0,				// actionOptionsSRAM
 	0,				// actionOptionsControllers
+	0,				// actionOptionsVgmLog
 
 	// NOTE: Test menus aren't going to be added here.
 
@@ -345,6 +353,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_kega[KeyBinding_count+1
 	KEYV_F7,			// actionNoMenuSaveSlotNext
 	KEYM_SHIFT | KEYV_F5,		// actionNoMenuSaveStateAs
 	KEYM_SHIFT | KEYV_F8,		// actionNoMenuLoadStateFrom
+	KEYV_BACKSPACE,			// actionNoMenuRewind
 
 	// End of key bindings.
 	// TODO: Make this -1, or remove the last entry entirely?
@@ -418,6 +427,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_regen[KeyBinding_count+
 	// NOTE: This is the same as "unfiltered" screenshots.
 	// Gens/GS II does not support filtered screenshots by design.
 	KEYV_F5,			// actionGraphicsScreenshot
+	0,				// actionGraphicsRecord
 
 	// System menu.
 	0,				// actionSystemRegion
@@ -440,6 +450,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_regen[KeyBinding_count+
 	// Options menu.
 	KEYM_SHIFT | KEYV_s,		// actionOptionsSRAM
 	KEYM_ALT | KEYV_r,		// actionOptionsControllers
+	0,				// actionOptionsVgmLog
 
 	// NOTE: Test menus aren't going to be added here.
 
@@ -464,6 +475,7 @@ const GensKey_t GensMenuShortcutsPrivate::DefKeyBindings_regen[KeyBinding_count+
 	0,				// actionNoMenuSaveSlotNext
 	KEYM_SHIFT | KEYV_F9,		// actionNoMenuSaveStateAs
 	KEYM_SHIFT | KEYV_F10,		// actionNoMenuLoadStateFrom
+	0,				// actionNoMenuRewind
 
 	// End of key bindings.
 	// TODO: Make this -1, or remove the last entry entirely?
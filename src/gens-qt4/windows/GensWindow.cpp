@@ -220,12 +220,18 @@ GensWindow::GensWindow(QWidget *parent, Qt::WindowFlags flags)
 	// Connect Emulation Manager signals to GensWindow.
 	QObject::connect(d->emuManager, SIGNAL(updateFps(double)),
 		this, SLOT(updateFps(double)));
+	QObject::connect(d->emuManager, SIGNAL(updatePerf(QStringList)),
+		this, SLOT(updatePerf(QStringList)));
 	QObject::connect(d->emuManager, SIGNAL(stateChanged(void)),
 		this, SLOT(stateChanged(void)));
 	QObject::connect(d->emuManager, SIGNAL(osdPrintMsg(int,QString)),
 		this, SLOT(osdPrintMsg(int,QString)));
 	QObject::connect(d->emuManager, SIGNAL(osdShowPreview(int,QImage)),
 		this, SLOT(osdShowPreview(int,QImage)));
+	QObject::connect(d->emuManager, SIGNAL(avRecordingChanged(bool)),
+		d->ui.actionGraphicsRecord, SLOT(setChecked(bool)));
+	QObject::connect(d->emuManager, SIGNAL(vgmLoggingChanged(bool)),
+		d->ui.actionOptionsVgmLog, SLOT(setChecked(bool)));
 
        // Auto Pause: Application Focus Changed signal, and setting change signal.
        QObject::connect(gqt4_app, SIGNAL(focusChanged(QWidget*,QWidget*)),
@@ -517,6 +523,15 @@ void GensWindow::updateFps(double fps)
 	d->vBackend->fpsPush(fps);
 }
 
+/**
+ * Update the per-subsystem frame times.
+ */
+void GensWindow::updatePerf(const QStringList &perf)
+{
+	Q_D(GensWindow);
+	d->vBackend->fpsPushPerf(perf);
+}
+
 /**
  * Emulation state changed.
  * - Update the video backend properties.
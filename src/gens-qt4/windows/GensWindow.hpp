@@ -99,6 +99,11 @@ class GensWindow : public QMainWindow
 		 */
 		void updateFps(double fps);
 
+		/**
+		 * Update the per-subsystem frame times.
+		 */
+		void updatePerf(const QStringList &perf);
+
 		/**
 		 * Emulation state changed.
 		 * - Update the video backend "running" state.
@@ -184,6 +189,7 @@ class GensWindow : public QMainWindow
 		void mnu_mnuGraphicsStretch_triggered(void);
 		void map_actionGraphicsStretch_triggered(int stretchMode);
 		void on_actionGraphicsScreenshot_triggered(void);
+		void on_actionGraphicsRecord_triggered(bool checked);
 
 		// System
 		void mnu_mnuSystemRegion_triggered(void);
@@ -201,6 +207,7 @@ class GensWindow : public QMainWindow
 		// Options
 		void on_actionOptionsSRAM_triggered(bool checked);
 		void on_actionOptionsControllers_triggered(void);
+		void on_actionOptionsVgmLog_triggered(bool checked);
 		// SoundTest; remove this later.
 		void map_actionSound_triggered(int freq);
 		void on_actionSoundMono_triggered(void);
@@ -216,6 +223,7 @@ class GensWindow : public QMainWindow
 		void on_actionNoMenuSaveSlotNext_triggered(void);
 		void on_actionNoMenuSaveStateAs_triggered(void);
 		void on_actionNoMenuLoadStateFrom_triggered(void);
+		void on_actionNoMenuRewind_triggered(void);
 
 	private slots:
 		/** Menu synchronization slots. **/
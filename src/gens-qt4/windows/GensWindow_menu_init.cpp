@@ -261,6 +261,7 @@ void GensWindowPrivate::initMenuBar(void)
 	nonMenu->addAction(ui.actionNoMenuSaveSlotNext);
 	nonMenu->addAction(ui.actionNoMenuLoadStateFrom);
 	nonMenu->addAction(ui.actionNoMenuSaveStateAs);
+	nonMenu->addAction(ui.actionNoMenuRewind);
 	menuShortcuts->addMenu(nonMenu);
 
 	// Synchronize the menu items.
@@ -150,6 +150,12 @@ void GensWindow::on_actionGraphicsScreenshot_triggered(void)
 	d->emuManager->screenShot();
 }
 
+void GensWindow::on_actionGraphicsRecord_triggered(bool checked)
+{
+	Q_D(GensWindow);
+	d->emuManager->avRecord(checked);
+}
+
 /** System **/
 
 void GensWindow::mnu_mnuSystemRegion_triggered(void)
@@ -229,6 +235,12 @@ void GensWindow::on_actionOptionsControllers_triggered(void)
 	CtrlConfigWindow::ShowSingle(this);
 }
 
+void GensWindow::on_actionOptionsVgmLog_triggered(bool checked)
+{
+	Q_D(GensWindow);
+	d->emuManager->vgmLog(checked);
+}
+
 // SoundTest; remove this later.
 void GensWindow::map_actionSound_triggered(int freq)
 {
@@ -294,4 +306,10 @@ void GensWindow::on_actionNoMenuLoadStateFrom_triggered(void)
 	// TODO (wasn't implemented in GensActions)
 }
 
+void GensWindow::on_actionNoMenuRewind_triggered(void)
+{
+	Q_D(GensWindow);
+	d->emuManager->rewind();
+}
+
 }
@@ -116,6 +116,10 @@ void GensWindowPrivate::updateMenusForStateChanged(void)
 	ui.actionFileSaveState->setEnabled(isRomOpen);
 	ui.actionFileLoadState->setEnabled(isRomOpen);
 	ui.actionGraphicsScreenshot->setEnabled(isRomOpen);
+	ui.actionGraphicsRecord->setEnabled(isRomOpen);
+	ui.actionGraphicsRecord->setChecked(isRomOpen && this->emuManager->isAvRecording());
+	ui.actionOptionsVgmLog->setEnabled(isRomOpen);
+	ui.actionOptionsVgmLog->setChecked(isRomOpen && this->emuManager->isVgmLogging());
 	ui.actionSystemHardReset->setEnabled(isRomOpen);
 	ui.actionSystemSoftReset->setEnabled(isRomOpen);
 
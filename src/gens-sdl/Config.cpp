@@ -221,4 +221,66 @@ int doScreenShot(const MdFb *fb, const Rom *rom)
 	return (ret == 0 ? scrNumber : ret);
 }
 
+/**
+ * Get filenames for a new A/V recording.
+ * @param rom		[in] ROM object.
+ * @param videoFilename	[out] Video filename. (.ppm)
+ * @param audioFilename	[out] Audio filename. (.wav)
+ * @return Recording number on success; negative errno on error.
+ */
+int getRecordingFilenames(const Rom *rom,
+	string *videoFilename, string *audioFilename)
+{
+	const string configDir = getConfigDir("Recordings");
+	if (configDir.empty() || !rom)
+		return -EINVAL;
+
+	string romFilename(configDir);
+	romFilename += DIR_SEP_CHR;
+	romFilename += rom->filename_baseNoExt();
+
+	// Find a number that isn't used by either file.
+	char vidFilename[260], wavFilename[260];
+	int recNumber = -1;
+	do {
+		recNumber++;
+		snprintf(vidFilename, sizeof(vidFilename), "%s_%03d.ppm",
+			 romFilename.c_str(), recNumber);
+		snprintf(wavFilename, sizeof(wavFilename), "%s_%03d.wav",
+			 romFilename.c_str(), recNumber);
+	} while (!access(vidFilename, F_OK) || !access(wavFilename, F_OK));
+
+	*videoFilename = vidFilename;
+	*audioFilename = wavFilename;
+	return recNumber;
+}
+
+/**
+ * Get the filename for a new VGM log.
+ * @param rom		[in] ROM object.
+ * @param vgmFilename	[out] VGM filename. (.vgm)
+ * @return VGM log number on success; negative errno on error.
+ */
+int getVgmFilename(const Rom *rom, string *vgmFilename)
+{
+	const string configDir = getConfigDir("VGM");
+	if (configDir.empty() || !rom)
+		return -EINVAL;
+
+	string romFilename(configDir);
+	romFilename += DIR_SEP_CHR;
+	romFilename += rom->filename_baseNoExt();
+
+	char filename[260];
+	int vgmNumber = -1;
+	do {
+		vgmNumber++;
+		snprintf(filename, sizeof(filename), "%s_%03d.vgm",
+			 romFilename.c_str(), vgmNumber);
+	} while (!access(filename, F_OK));
+
+	*vgmFilename = filename;
+	return vgmNumber;
+}
+
 }
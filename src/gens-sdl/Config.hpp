@@ -62,6 +62,24 @@ std::string getSavestateFilename(const LibGens::Rom *rom, int saveSlot);
  */
 int doScreenShot(const LibGens::MdFb *fb, const LibGens::Rom *rom);
 
+/**
+ * Get filenames for a new A/V recording.
+ * @param rom		[in] ROM object.
+ * @param videoFilename	[out] Video filename. (.ppm)
+ * @param audioFilename	[out] Audio filename. (.wav)
+ * @return Recording number on success; negative errno on error.
+ */
+int getRecordingFilenames(const LibGens::Rom *rom,
+	std::string *videoFilename, std::string *audioFilename);
+
+/**
+ * Get the filename for a new VGM log.
+ * @param rom		[in] ROM object.
+ * @param vgmFilename	[out] VGM filename. (.vgm)
+ * @return VGM log number on success; negative errno on error.
+ */
+int getVgmFilename(const LibGens::Rom *rom, std::string *vgmFilename);
+
 }
 
 #endif /* __GENS_SDL_CONFIG_HPP__ */
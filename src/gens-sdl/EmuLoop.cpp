@@ -43,10 +43,20 @@ using GensSdl::VBackend;
 #include "libgens/Util/MdFb.hpp"
 #include "libgens/Vdp/Vdp.hpp"
 #include "libgens/EmuContext/SysVersion.hpp"
+#include "libgens/Util/RewindBuffer.hpp"
+#include "libgens/Util/RunAhead.hpp"
+#include "libgens/Util/SaveStateWriter.hpp"
+#include "libgens/Util/AvRecorder.hpp"
+#include "libgens/Util/VgmLogger.hpp"
 using LibGens::Rom;
 using LibGens::MdFb;
 using LibGens::Vdp;
 using LibGens::SysVersion;
+using LibGens::RewindBuffer;
+using LibGens::RunAhead;
+using LibGens::SaveStateWriter;
+using LibGens::AvRecorder;
+using LibGens::VgmLogger;
 
 // Emulation Context.
 #include "libgens/EmuContext/EmuContext.hpp"
@@ -103,6 +113,27 @@ class EmuLoopPrivate : public EventLoopPrivate
 		// Save slot.
 		int saveSlot_selected;
 
+		// Last time the performance counters were shown.
+		uint64_t lastPerfTime;
+
+		// Rewind buffer.
+		RewindBuffer *rewindBuffer;
+		bool rewinding;		// True while the rewind key is held.
+
+		// Run-ahead manager. (nullptr if disabled)
+		RunAhead *runAhead;
+
+		// Savestates are written on a background thread.
+		SaveStateWriter *saveStateWriter;
+
+		// A/V recorder.
+		AvRecorder *avRecorder;
+		int avRecordNumber;	// Current recording number.
+
+		// VGM logger.
+		VgmLogger *vgmLogger;
+		int vgmNumber;		// Current VGM log number.
+
 		// Keymaps.
 		static const GensKey_t keyMap_md[];
 		static const GensKey_t keyMap_pico[];
@@ -135,6 +166,23 @@ class EmuLoopPrivate : public EventLoopPrivate
 		 */
 		void doSaveState(void);
 
+		/**
+		 * Show OSD messages for savestates that have been written.
+		 */
+		void checkSaveStates(void);
+
+		/**
+		 * Start or stop rewinding.
+		 * @param rewind True to start rewinding; false to stop.
+		 */
+		void doRewind(bool rewind);
+
+		/**
+		 * Run an emulated frame, handling rewind and run-ahead.
+		 * @param fast If true, run a fast frame. (no VDP updates)
+		 */
+		void execFrame(bool fast);
+
 		/**
 		 * Change stretch mode parameters.
 		 */
@@ -145,6 +193,27 @@ class EmuLoopPrivate : public EventLoopPrivate
 		 */
 		void doScreenShot(void);
 
+		/**
+		 * Start or stop A/V recording.
+		 */
+		void doAvRecord(void);
+
+		/**
+		 * Start or stop VGM logging.
+		 */
+		void doVgmLog(void);
+
+		/**
+		 * Toggle the performance counters.
+		 */
+		void doPerfCounters(void);
+
+		/**
+		 * Show the performance counters in the OSD.
+		 * This is only done once per second.
+		 */
+		void showPerfCounters(void);
+
 		/**
 		 * Update the window title information.
 		 * This uses the system abbreviation
@@ -175,15 +244,30 @@ EmuLoopPrivate::EmuLoopPrivate()
 	, emuContext(nullptr)
 	, keyManager(nullptr)
 	, saveSlot_selected(0)
+	, lastPerfTime(0)
+	, rewindBuffer(nullptr)
+	, rewinding(false)
+	, runAhead(nullptr)
+	, saveStateWriter(nullptr)
+	, avRecorder(nullptr)
+	, avRecordNumber(0)
+	, vgmLogger(nullptr)
+	, vgmNumber(0)
 {
 	last_paused.data = 0;
 }
 
 EmuLoopPrivate::~EmuLoopPrivate()
 {
+	// NOTE: runAhead must be deleted before emuContext.
+	delete runAhead;
 	delete rom;
 	delete emuContext;
 	delete keyManager;
+	delete rewindBuffer;
+	delete saveStateWriter;
+	delete avRecorder;
+	delete vgmLogger;
 }
 
 /**
@@ -311,6 +395,10 @@ void EmuLoopPrivate::doLoadState(void)
 	if (saveSlot_selected < 0 || saveSlot_selected > 9)
 		return;
 
+	// Make sure the savestate isn't still being written.
+	saveStateWriter->flush();
+	checkSaveStates();
+
 	string filename = getSavestateFilename(rom, saveSlot_selected);
 	int ret = emuContext->zomgLoad(filename.c_str());
 	if (ret == 0) {
@@ -341,14 +429,12 @@ void EmuLoopPrivate::doSaveState(void)
 	if (saveSlot_selected < 0 || saveSlot_selected > 9)
 		return;
 
+	// The state is captured here, but the file is written
+	// on a background thread. checkSaveStates() shows the
+	// OSD message once the file has been written.
 	string filename = getSavestateFilename(rom, saveSlot_selected);
-	int ret = emuContext->zomgSave(filename.c_str());
-	if (ret == 0) {
-		// State saved.
-		vBackend->osd_printf(1500,
-				"Slot %d saved.",
-				saveSlot_selected);
-	} else {
+	int ret = saveStateWriter->save(emuContext, filename.c_str(), saveSlot_selected);
+	if (ret != 0) {
 		// Error saving state.
 		vBackend->osd_printf(1500,
 				"Error saving Slot %d:\n* %s",
@@ -356,6 +442,98 @@ void EmuLoopPrivate::doSaveState(void)
 	}
 }
 
+/**
+ * Show OSD messages for savestates that have been written.
+ */
+void EmuLoopPrivate::checkSaveStates(void)
+{
+	SaveStateWriter::Result result;
+	while (saveStateWriter->poll(&result)) {
+		if (result.ret == 0) {
+			// State saved.
+			vBackend->osd_printf(1500,
+					"Slot %d saved.",
+					result.id);
+		} else {
+			// Error saving state.
+			vBackend->osd_printf(1500,
+					"Error saving Slot %d:\n* %s",
+					result.id, strerror(-result.ret));
+		}
+	}
+}
+
+/**
+ * Start or stop rewinding.
+ * @param rewind True to start rewinding; false to stop.
+ */
+void EmuLoopPrivate::doRewind(bool rewind)
+{
+	if (rewinding == rewind)
+		return;
+	rewinding = rewind;
+	if (rewind && rewindBuffer->count() == 0) {
+		vBackend->osd_print(1500, "Rewind buffer is empty.");
+	}
+}
+
+/**
+ * Run an emulated frame, handling rewind and run-ahead.
+ * @param fast If true, run a fast frame. (no VDP updates)
+ */
+void EmuLoopPrivate::execFrame(bool fast)
+{
+	// Every frame is rendered while recording.
+	const bool recording = avRecorder->isOpen();
+	if (recording) {
+		fast = false;
+	}
+
+	if (rewinding) {
+		// Go back one snapshot, then run a frame
+		// from there so the screen is updated.
+		// If the buffer is empty, the game stays
+		// frozen at the oldest snapshot.
+		int ret = rewindBuffer->rewind(emuContext);
+		if (ret != 0) {
+			if (ret != -ENOENT) {
+				vBackend->osd_printf(1500,
+					"Error rewinding:\n* %s", strerror(-ret));
+				rewinding = false;
+			}
+			return;
+		}
+	}
+
+	if (runAhead) {
+		if (fast) {
+			runAhead->execFrameFast();
+		} else {
+			runAhead->execFrame();
+		}
+	} else {
+		if (fast) {
+			emuContext->execFrameFast();
+		} else {
+			emuContext->execFrame();
+		}
+	}
+
+	// Don't capture while rewinding, since
+	// that would undo the rewind.
+	if (!rewinding) {
+		rewindBuffer->capture(emuContext);
+	}
+
+	if (recording) {
+		// Queue the frame for the recorder.
+		// If the recorder can't keep up, the frame is
+		// dropped and the previous frame is repeated
+		// in its place; this never blocks.
+		avRecorder->pushFrame(emuContext->m_vdp->MD_Screen);
+	}
+}
+
 /**
  * Change stretch mode parameters.
  */
@@ -403,6 +581,138 @@ void EmuLoopPrivate::doScreenShot(void)
 	}
 }
 
+/**
+ * Start or stop A/V recording.
+ */
+void EmuLoopPrivate::doAvRecord(void)
+{
+	if (avRecorder->isOpen()) {
+		// Stop recording.
+		// This waits for queued frames to be written.
+		sdlHandler->set_av_recorder(nullptr);
+		int ret = avRecorder->close();
+		AvRecorder::Stats stats;
+		avRecorder->stats(&stats);
+		if (ret == 0) {
+			vBackend->osd_printf(1500,
+				"Recording %d stopped.\n* %u frames, %u dropped.\n* %u audio samples dropped.",
+				avRecordNumber, stats.frames, stats.droppedFrames,
+				stats.droppedSamples);
+		} else {
+			vBackend->osd_printf(1500,
+				"Error writing recording %d:\n* %s",
+				avRecordNumber, strerror(-ret));
+		}
+		return;
+	}
+
+	// Start recording.
+	string videoFilename, audioFilename;
+	int ret = getRecordingFilenames(rom, &videoFilename, &audioFilename);
+	if (ret >= 0) {
+		avRecordNumber = ret;
+		const int rate = sdlHandler->audio_rate();
+		ret = avRecorder->open(videoFilename.c_str(),
+			(rate > 0 ? audioFilename.c_str() : nullptr),
+			rate, (sdlHandler->audio_stereo() ? 2 : 1));
+	}
+	if (ret < 0) {
+		vBackend->osd_printf(1500,
+			"Error starting recording:\n* %s", strerror(-ret));
+		return;
+	}
+
+	sdlHandler->set_av_recorder(avRecorder);
+	vBackend->osd_printf(1500, "Recording %d started.", avRecordNumber);
+}
+
+/**
+ * Start or stop VGM logging.
+ */
+void EmuLoopPrivate::doVgmLog(void)
+{
+	if (vgmLogger->isOpen()) {
+		// Stop logging.
+		// This waits for queued frames to be written.
+		emuContext->setVgmLogger(nullptr);
+		int ret = vgmLogger->close();
+		VgmLogger::Stats stats;
+		vgmLogger->stats(&stats);
+		if (ret == 0) {
+			vBackend->osd_printf(1500,
+				"VGM log %d stopped.\n* %u frames, %u events dropped.",
+				vgmNumber, stats.frames, stats.droppedEvents);
+		} else {
+			vBackend->osd_printf(1500,
+				"Error writing VGM log %d:\n* %s",
+				vgmNumber, strerror(-ret));
+		}
+		return;
+	}
+
+	// Start logging.
+	string vgmFilename;
+	int ret = getVgmFilename(rom, &vgmFilename);
+	if (ret >= 0) {
+		vgmNumber = ret;
+		ret = vgmLogger->open(vgmFilename.c_str(),
+			emuContext->versionRegisterObject()->isPal());
+	}
+	if (ret < 0) {
+		vBackend->osd_printf(1500,
+			"Error starting VGM log:\n* %s", strerror(-ret));
+		return;
+	}
+
+	emuContext->setVgmLogger(vgmLogger);
+	vBackend->osd_printf(1500, "VGM log %d started.", vgmNumber);
+}
+
+/**
+ * Toggle the performance counters.
+ */
+void EmuLoopPrivate::doPerfCounters(void)
+{
+	const bool enable = !emuContext->isPerfCountersEnabled();
+	emuContext->setPerfCountersEnabled(enable);
+	lastPerfTime = clks.timing.getTime();
+	vBackend->osd_printf(1500, "Performance counters %s.",
+		(enable ? "enabled" : "disabled"));
+}
+
+/**
+ * Show the performance counters in the OSD.
+ * This is only done once per second.
+ */
+void EmuLoopPrivate::showPerfCounters(void)
+{
+	const uint64_t curTime = clks.timing.getTime();
+	if (curTime - lastPerfTime < 1000000)
+		return;
+	lastPerfTime = curTime;
+
+	const LibGens::PerfHistory *const history = emuContext->perfHistory();
+	if (history->count() == 0)
+		return;
+
+	// Times are shown as "p50/p99", in milliseconds.
+	// Four counters per line to keep the OSD readable.
+	char msg[256];
+	int pos = 0;
+	for (int i = 0; i <= LibGens::PerfHistory::FRAME_TOTAL; i++) {
+		const char *name = (i == LibGens::PerfHistory::FRAME_TOTAL
+			? "Frame"
+			: LibGens::PerfCounters::SubsystemName((LibGens::PerfCounters::Subsystem)i));
+		pos += snprintf(&msg[pos], sizeof(msg) - pos, "%s%s %0.2f/%0.2f",
+			(i == 0 ? "" : ((i % 4) == 0 ? "\n" : "  ")), name,
+			(double)history->percentile(i, 50) / 1.0e6,
+			(double)history->percentile(i, 99) / 1.0e6);
+		if (pos >= (int)sizeof(msg))
+			break;
+	}
+	vBackend->osd_print(1000, msg);
+}
+
 /**
  * Update the window title information.
  * This uses the system abbreviation
@@ -524,6 +834,9 @@ int EmuLoop::processSdlEvent(const SDL_Event *event) {
 					if (event->key.keysym.mod & (KMOD_LSHIFT | KMOD_RSHIFT)) {
 						// Take a screenshot.
 						d->doScreenShot();
+					} else {
+						// Rewind while the key is held.
+						d->doRewind(true);
 					}
 					break;
 
@@ -540,6 +853,11 @@ int EmuLoop::processSdlEvent(const SDL_Event *event) {
 					}
 					break;
 
+				case SDLK_F3:
+					// Toggle the performance counters.
+					d->doPerfCounters();
+					break;
+
 				case SDLK_0: case SDLK_1:
 				case SDLK_2: case SDLK_3:
 				case SDLK_4: case SDLK_5:
@@ -573,6 +891,16 @@ int EmuLoop::processSdlEvent(const SDL_Event *event) {
 					d->doLoadState();
 					break;
 
+				case SDLK_F11:
+					if (event->key.keysym.mod & (KMOD_LSHIFT | KMOD_RSHIFT)) {
+						// Start or stop VGM logging.
+						d->doVgmLog();
+					} else {
+						// Start or stop A/V recording.
+						d->doAvRecord();
+					}
+					break;
+
 				default: {
 					// Check if the base class event handler will handle this.
 					int ret = EventLoop::processSdlEvent(event);
@@ -588,6 +916,11 @@ int EmuLoop::processSdlEvent(const SDL_Event *event) {
 			break;
 
 		case SDL_KEYUP:
+			if (event->key.keysym.sym == SDLK_BACKSPACE) {
+				// Stop rewinding.
+				d->doRewind(false);
+				break;
+			}
 			// SDL keycodes nearly match GensKey.
 			d->keyManager->keyUp(SdlHandler::scancodeToGensKey(event->key.keysym.scancode));
 			break;
@@ -677,6 +1010,10 @@ int EmuLoop::run(const Options *options)
 		EmuContext::SetTmssEnabled(true);
 	}
 
+	// Savestate compression settings.
+	Zomg::SetDefaultCompressionProfile(options->zomg_compression());
+	Zomg::SetDefaultPreviewEnabled(options->zomg_preview());
+
 	// Detect the ROM region.
 	SysVersion::RegionCode_t region = options->region();
 	SysVersion::RegionCode_t region_auto = SysVersion::REGION_AUTO;
@@ -708,6 +1045,7 @@ int EmuLoop::run(const Options *options)
 	// TODO: More properties?
 	Vdp *vdp = d->emuContext->m_vdp;
 	vdp->options.spriteLimits = options->sprite_limits();
+	vdp->options.renderThread = options->render_thread();
 
 	// Initialize the SDL handlers.
 	d->sdlHandler = new SdlHandler();
@@ -758,6 +1096,42 @@ int EmuLoop::run(const Options *options)
 
 	// TODO: Close the ROM, or let EmuContext do it?
 
+	// Enable the performance counters, if requested.
+	d->emuContext->setPerfCountersEnabled(options->perf_counters());
+
+	// Create the rewind buffer.
+	d->rewindBuffer = new RewindBuffer();
+	d->rewinding = false;
+
+	// Create the savestate writer.
+	d->saveStateWriter = new SaveStateWriter();
+
+	// Create the A/V recorder.
+	d->avRecorder = new AvRecorder();
+
+	// Create the VGM logger.
+	d->vgmLogger = new VgmLogger();
+
+	// Create the run-ahead manager, if requested.
+	if (options->run_ahead() > 0) {
+		d->runAhead = new RunAhead(d->emuContext, options->run_ahead());
+		if (options->run_ahead_thread()) {
+			if (RunAhead::IsThreadedModeSupported()) {
+				// The hidden frames are run on a second context.
+				EmuContext *secondary = EmuContextFactory::createContext(d->rom, region);
+				if (secondary && secondary->isRomOpened()) {
+					d->runAhead->setSecondary(secondary);
+				} else {
+					delete secondary;
+					d->vBackend->osd_print(1500, "Error initializing the run-ahead thread.");
+				}
+			} else {
+				d->vBackend->osd_print(1500,
+					"Run-ahead thread requires the portable CPU cores.");
+			}
+		}
+	}
+
 	// Set the color depth.
 	MdFb *fb = d->emuContext->m_vdp->MD_Screen->ref();
 	fb->setBpp(options->bpp());
@@ -794,6 +1168,9 @@ int EmuLoop::run(const Options *options)
 			break;
 		}
 
+		// Check for savestates that have been written.
+		d->checkSaveStates();
+
 		// Check if the 'paused' state was changed.
 		// If it was, autosave SRAM/EEPROM.
 		if (d->last_paused.data != d->paused.data) {
@@ -819,6 +1196,11 @@ int EmuLoop::run(const Options *options)
 		// EventLoop::runFrame() handles frameskip timing.
 		runFrame();
 
+		// Show the performance counters, if enabled.
+		if (d->emuContext->isPerfCountersEnabled()) {
+			d->showPerfCounters();
+		}
+
 		// Autosave SRAM/EEPROM.
 		// TODO: EmuContext::execFrame() should probably do this itself...
 		d->emuContext->autoSaveData(1);
@@ -835,6 +1217,22 @@ int EmuLoop::run(const Options *options)
 	d->emuContext->saveData();
 
 	// Shut down LibGens.
+	// NOTE: Deleting saveStateWriter waits for
+	// pending savestates to be written.
+	delete d->saveStateWriter;
+	d->saveStateWriter = nullptr;
+	// NOTE: Deleting avRecorder finishes the recording.
+	d->sdlHandler->set_av_recorder(nullptr);
+	delete d->avRecorder;
+	d->avRecorder = nullptr;
+	// NOTE: Deleting vgmLogger finishes the VGM log.
+	d->emuContext->setVgmLogger(nullptr);
+	delete d->vgmLogger;
+	d->vgmLogger = nullptr;
+	delete d->runAhead;
+	d->runAhead = nullptr;
+	delete d->rewindBuffer;
+	d->rewindBuffer = nullptr;
 	delete d->keyManager;
 	d->keyManager = nullptr;
 	delete d->emuContext;
@@ -867,7 +1265,7 @@ int EmuLoop::run(const Options *options)
 void EmuLoop::runFullFrame(void)
 {
 	EmuLoopPrivate *const d = d_func();
-	d->emuContext->execFrame();
+	d->execFrame(false);
 }
 
 /**
@@ -879,7 +1277,7 @@ void EmuLoop::runFullFrame(void)
 void EmuLoop::runFastFrame(void)
 {
 	EmuLoopPrivate *const d = d_func();
-	d->emuContext->execFrameFast();
+	d->execFrame(true);
 }
 
 }
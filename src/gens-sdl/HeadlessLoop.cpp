@@ -0,0 +1,447 @@
+/***************************************************************************
+ * gens-sdl: Gens/GS II basic SDL frontend.                                *
+ * HeadlessLoop.cpp: Headless batch runner loop.                           *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Reentrant functions.
+// MUST be included before everything else due to
+// _POSIX_SOURCE and _POSIX_C_SOURCE definitions.
+#include "libcompat/reentrant.h"
+
+#include "HeadlessLoop.hpp"
+
+// String lookup for ROM information.
+#include "str_lookup.hpp"
+
+// LibGens
+#include "libgens/Rom.hpp"
+#include "libgens/Vdp/Vdp.hpp"
+#include "libgens/EmuContext/SysVersion.hpp"
+#include "libgens/sound/SoundMgr.hpp"
+#include "libgens/IO/IoManager.hpp"
+#include "libgens/Util/Timing.hpp"
+using LibGens::Rom;
+using LibGens::Vdp;
+using LibGens::SysVersion;
+using LibGens::SoundMgr;
+using LibGens::IoManager;
+using LibGens::Timing;
+
+// Emulation Context.
+#include "libgens/EmuContext/EmuContext.hpp"
+#include "libgens/EmuContext/EmuContextFactory.hpp"
+using LibGens::EmuContext;
+using LibGens::EmuContextFactory;
+
+// Command line parameters.
+#include "Options.hpp"
+
+// aligned_malloc()
+#include "libcompat/aligned_malloc.h"
+
+// C includes. (C++ namespace)
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "EventLoop_p.hpp"
+namespace GensSdl {
+
+class HeadlessLoopPrivate : public EventLoopPrivate
+{
+	public:
+		HeadlessLoopPrivate();
+		virtual ~HeadlessLoopPrivate();
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add GensSdl-specific version of Q_DISABLE_COPY().
+		HeadlessLoopPrivate(const HeadlessLoopPrivate &);
+		HeadlessLoopPrivate &operator=(const HeadlessLoopPrivate &);
+
+	public:
+		Rom *rom;
+		EmuContext *emuContext;
+
+		// Audio is emulated, but discarded.
+		// NOTE: Must be 16-byte aligned for SSE2.
+		int16_t *audioBuf;
+
+		/**
+		 * Input script event.
+		 * Button state for a port, starting at the specified frame.
+		 * The state is held until the next event for the same port.
+		 */
+		struct InputEvent {
+			unsigned int frame;
+			int virtPort;		// IoManager::VirtPort_t
+			uint32_t buttons;	// Active-low button bitfield.
+
+			bool operator<(const InputEvent &other) const
+				{ return (frame < other.frame); }
+		};
+		vector<InputEvent> inputScript;
+
+		/**
+		 * Load an input script.
+		 *
+		 * Each non-empty line that doesn't start with '#'
+		 * has the format "frame port buttons":
+		 * - frame: Frame number where the button state takes effect. (0-based)
+		 * - port: Controller port. (1 or 2)
+		 * - buttons: Pressed buttons, using the characters "UDLRABCSXYZM",
+		 *   or "-" to release all buttons.
+		 *
+		 * @param filename Input script filename.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadInputScript(const char *filename);
+
+		/**
+		 * Parse a button string from an input script.
+		 * @param str Button string.
+		 * @param buttons Active-low button bitfield. (output)
+		 * @return 0 on success; non-zero if an invalid button was found.
+		 */
+		static int parseButtons(const char *str, uint32_t *buttons);
+};
+
+/** HeadlessLoopPrivate **/
+
+HeadlessLoopPrivate::HeadlessLoopPrivate()
+	: rom(nullptr)
+	, emuContext(nullptr)
+{
+	audioBuf = (int16_t*)aligned_malloc(16, SoundMgr::MAX_SEGMENT_SIZE * 2 * sizeof(int16_t));
+}
+
+HeadlessLoopPrivate::~HeadlessLoopPrivate()
+{
+	delete emuContext;
+	delete rom;
+	aligned_free(audioBuf);
+}
+
+/**
+ * Parse a button string from an input script.
+ * @param str Button string.
+ * @param buttons Active-low button bitfield. (output)
+ * @return 0 on success; non-zero if an invalid button was found.
+ */
+int HeadlessLoopPrivate::parseButtons(const char *str, uint32_t *buttons)
+{
+	uint32_t pressed = 0;
+	if (strcmp(str, "-") != 0) {
+		for (; *str != 0; str++) {
+			int btn;
+			switch (toupper(*str)) {
+				case 'U':	btn = IoManager::BTNI_UP; break;
+				case 'D':	btn = IoManager::BTNI_DOWN; break;
+				case 'L':	btn = IoManager::BTNI_LEFT; break;
+				case 'R':	btn = IoManager::BTNI_RIGHT; break;
+				case 'A':	btn = IoManager::BTNI_A; break;
+				case 'B':	btn = IoManager::BTNI_B; break;
+				case 'C':	btn = IoManager::BTNI_C; break;
+				case 'S':	btn = IoManager::BTNI_START; break;
+				case 'X':	btn = IoManager::BTNI_X; break;
+				case 'Y':	btn = IoManager::BTNI_Y; break;
+				case 'Z':	btn = IoManager::BTNI_Z; break;
+				case 'M':	btn = IoManager::BTNI_MODE; break;
+				default:
+					// Invalid button.
+					return -1;
+			}
+			pressed |= (1U << btn);
+		}
+	}
+
+	// Buttons are typically active-low.
+	*buttons = ~pressed;
+	return 0;
+}
+
+/**
+ * Load an input script.
+ * @param filename Input script filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HeadlessLoopPrivate::loadInputScript(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if (!f) {
+		return -errno;
+	}
+
+	inputScript.clear();
+	char line[256];
+	int line_num = 0;
+	int ret = 0;
+	while (fgets(line, sizeof(line), f) != nullptr) {
+		line_num++;
+
+		// Skip leading whitespace.
+		const char *p = line;
+		while (isspace((unsigned char)*p))
+			p++;
+		if (*p == 0 || *p == '#') {
+			// Empty line or comment.
+			continue;
+		}
+
+		unsigned int frame;
+		int port;
+		char btn_str[32];
+		InputEvent event;
+		if (sscanf(p, "%u %d %31s", &frame, &port, btn_str) != 3 ||
+		    (port != 1 && port != 2) ||
+		    parseButtons(btn_str, &event.buttons) != 0)
+		{
+			fprintf(stderr, "%s:%d: invalid input script line\n",
+				filename, line_num);
+			ret = -EINVAL;
+			break;
+		}
+
+		event.frame = frame;
+		event.virtPort = (port == 1 ? IoManager::VIRTPORT_1 : IoManager::VIRTPORT_2);
+		inputScript.push_back(event);
+	}
+	fclose(f);
+
+	// Make sure the events are in frame order.
+	// stable_sort() keeps the file order for events on the same frame.
+	std::stable_sort(inputScript.begin(), inputScript.end());
+	return ret;
+}
+
+/** HeadlessLoop **/
+
+HeadlessLoop::HeadlessLoop()
+	: EventLoop(new HeadlessLoopPrivate())
+{ }
+
+HeadlessLoop::~HeadlessLoop()
+{ }
+
+/**
+ * Run the event loop.
+ * @param options Options.
+ * @return Exit code.
+ */
+int HeadlessLoop::run(const Options *options)
+{
+	HeadlessLoopPrivate *const d = d_func();
+	d->options = options;
+
+	// Load the input script first so syntax errors
+	// are reported before the ROM is loaded.
+	string input_script = options->input_script();
+	if (!input_script.empty()) {
+		int ret = d->loadInputScript(input_script.c_str());
+		if (ret != 0) {
+			if (ret != -EINVAL) {
+				fprintf(stderr, "Error opening input script %s: %s\n",
+					input_script.c_str(), strerror(-ret));
+			}
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Load the ROM image.
+	string rom_filename = options->rom_filename();
+	d->rom = new Rom(rom_filename.c_str());
+	if (!d->rom->isOpen()) {
+		// Error opening the ROM.
+		fprintf(stderr, "Error opening ROM file %s: (TODO get error code)\n",
+			rom_filename.c_str());
+		return EXIT_FAILURE;
+	}
+
+	if (d->rom->isMultiFile()) {
+		// Select the first file.
+		d->rom->select_z_entry(d->rom->get_z_entry_list());
+	}
+
+	// Is the ROM format supported?
+	if (!EmuContextFactory::isRomFormatSupported(d->rom)) {
+		// ROM format is not supported.
+		const char *rom_format = romFormatToString(d->rom->romFormat());
+		fprintf(stderr, "Error loading ROM file %s: ROM is in %s format.\n"
+			"Only plain binary and SMD-format ROMs are supported.\n",
+			rom_filename.c_str(), rom_format);
+		return EXIT_FAILURE;
+	}
+
+	// Check the ROM's system ID.
+	if (!EmuContextFactory::isRomSystemSupported(d->rom)) {
+		// System is not supported.
+		const char *rom_sysId = sysIdToString(d->rom->sysId());
+		fprintf(stderr, "Error loading ROM file %s: ROM is for %s.\n"
+			"Only Mega Drive and Pico ROMs are supported.\n",
+			rom_filename.c_str(), rom_sysId);
+		return EXIT_FAILURE;
+	}
+
+	// NOTE: The SRAM path is not set in headless mode,
+	// so batch runs don't depend on or modify saved data.
+	EmuContext::SetAutoFixChecksum(options->auto_fix_checksum());
+	if (options->is_tmss_enabled()) {
+		EmuContext::SetTmssRomFilename(options->tmss_rom_filename());
+		EmuContext::SetTmssEnabled(true);
+	}
+
+	// Detect the ROM region.
+	SysVersion::RegionCode_t region = options->region();
+	if (region == SysVersion::REGION_AUTO) {
+		// Auto-detect the region code.
+		// Using region code order 0x4812.
+		// (US, Europe, Japan, Asia)
+		region = SysVersion::DetectRegion(d->rom->regionCode(), 0x4812);
+		if (region == SysVersion::REGION_AUTO) {
+			// Detection failed.
+			// Default to US/NTSC.
+			region = SysVersion::REGION_US_NTSC;
+		}
+	}
+	const bool isPal = (region == SysVersion::REGION_EU_PAL ||
+			    region == SysVersion::REGION_ASIA_PAL);
+
+	// Create the emulation context.
+	d->emuContext = EmuContextFactory::createContext(d->rom, region);
+	if (!d->emuContext || !d->emuContext->isRomOpened()) {
+		// Error loading the ROM into EmuMD.
+		fprintf(stderr, "Error initializing EmuContext for %s: (TODO get error code)\n",
+			rom_filename.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// Set VDP properties.
+	Vdp *vdp = d->emuContext->m_vdp;
+	vdp->options.spriteLimits = options->sprite_limits();
+	vdp->options.renderThread = options->render_thread();
+	vdp->MD_Screen->setBpp(options->bpp());
+
+	// Audio is still emulated so the timing matches
+	// normal emulation, but it isn't sent anywhere.
+	SoundMgr::SetRate(options->sound_freq(), true);
+
+	// Initialize the controllers.
+	// Without a KeyManager, all buttons are released
+	// unless the input script says otherwise.
+	IoManager *ioManager = d->emuContext->m_ioManager;
+	if (d->rom->sysId() != Rom::MDP_SYSTEM_PICO) {
+		ioManager->setDevType(IoManager::VIRTPORT_1, IoManager::IOT_6BTN);
+	} else {
+		ioManager->setDevType(IoManager::VIRTPORT_1, IoManager::IOT_PICO);
+	}
+	ioManager->setDevType(IoManager::VIRTPORT_2, IoManager::IOT_NONE);
+
+	// Enable the performance counters, if requested.
+	d->emuContext->setPerfCountersEnabled(options->perf_counters());
+
+	// Timing statistics.
+	const unsigned int frames = options->frames();
+	const bool no_render = options->no_render();
+	Timing &timing = d->clks.timing;
+	uint64_t usec_min = ~0ULL, usec_max = 0;
+
+	const uint64_t start_clk = timing.getTime();
+	vector<HeadlessLoopPrivate::InputEvent>::const_iterator event = d->inputScript.begin();
+	d->running = true;
+	for (unsigned int frame = 0; frame < frames; frame++) {
+		// Apply input script events for this frame.
+		for (; event != d->inputScript.end() && event->frame <= frame; ++event) {
+			ioManager->update(event->virtPort, event->buttons);
+		}
+
+		const uint64_t frame_clk = timing.getTime();
+		if (no_render) {
+			runFastFrame();
+		} else {
+			runFullFrame();
+		}
+		const uint64_t usec = timing.getTime() - frame_clk;
+		if (usec < usec_min)
+			usec_min = usec;
+		if (usec > usec_max)
+			usec_max = usec;
+	}
+	const uint64_t usec_total = timing.getTime() - start_clk;
+	d->running = false;
+
+	// Print the timing statistics.
+	const double sec_total = (double)usec_total / 1000000.0;
+	const double fps = (usec_total > 0 ? ((double)frames / sec_total) : 0.0);
+	printf("Ran %u frames in %0.3f s (%s timer)\n",
+		frames, sec_total, Timing::GetTimingMethodName(timing.getTimingMethod()));
+	printf("Average: %0.1f fps (%0.2fx real time)\n",
+		fps, fps / (isPal ? 50.0 : 60.0));
+	printf("Frame time: min %0.3f ms, avg %0.3f ms, max %0.3f ms\n",
+		(double)usec_min / 1000.0,
+		((double)usec_total / 1000.0) / frames,
+		(double)usec_max / 1000.0);
+
+	if (d->emuContext->isPerfCountersEnabled()) {
+		// Print the per-subsystem times.
+		// NOTE: Only the last HISTORY_SIZE frames are included.
+		const LibGens::PerfHistory *const history = d->emuContext->perfHistory();
+		printf("Subsystem times for the last %d frames:\n%s",
+			history->count(), history->summary().c_str());
+	}
+
+	// Shut down LibGens.
+	delete d->emuContext;
+	d->emuContext = nullptr;
+	delete d->rom;
+	d->rom = nullptr;
+	return 0;
+}
+
+/**
+ * Run a normal frame.
+ * Runs a frame with video and audio updates.
+ */
+void HeadlessLoop::runFullFrame(void)
+{
+	HeadlessLoopPrivate *const d = d_func();
+	d->emuContext->execFrame();
+	SoundMgr::writeStereo(d->audioBuf, SoundMgr::MAX_SEGMENT_SIZE);
+}
+
+/**
+ * Run a fast frame.
+ * Runs a frame with audio updates only.
+ */
+void HeadlessLoop::runFastFrame(void)
+{
+	HeadlessLoopPrivate *const d = d_func();
+	d->emuContext->execFrameFast();
+	SoundMgr::writeStereo(d->audioBuf, SoundMgr::MAX_SEGMENT_SIZE);
+}
+
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ * gens-sdl: Gens/GS II basic SDL frontend.                                *
+ * HeadlessLoop.hpp: Headless batch runner loop.                           *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __GENS_SDL_HEADLESSLOOP_HPP__
+#define __GENS_SDL_HEADLESSLOOP_HPP__
+
+#include "EventLoop.hpp"
+
+namespace GensSdl {
+
+/**
+ * Headless batch runner.
+ * Runs a fixed number of frames as fast as possible,
+ * without a window or an audio device, then prints
+ * timing statistics to stdout.
+ */
+class HeadlessLoopPrivate;
+class HeadlessLoop : public EventLoop
+{
+	public:
+		HeadlessLoop();
+		virtual ~HeadlessLoop();
+
+	private:
+		EVENT_LOOP_DECLARE_PRIVATE(HeadlessLoop)
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add GensSdl-specific version of Q_DISABLE_COPY().
+		HeadlessLoop(const HeadlessLoop &);
+		HeadlessLoop &operator=(const HeadlessLoop &);
+
+	public:
+		/**
+		 * Run the event loop.
+		 * @param options Options.
+		 * @return Exit code.
+		 */
+		virtual int run(const Options *options) final;
+
+	protected:
+		/**
+		 * Run a normal frame.
+		 * Runs a frame with video and audio updates.
+		 */
+		virtual void runFullFrame(void) final;
+
+		/**
+		 * Run a fast frame.
+		 * Runs a frame with audio updates only.
+		 */
+		virtual void runFastFrame(void) final;
+};
+
+}
+
+#endif /* __GENS_SDL_HEADLESSLOOP_HPP__ */
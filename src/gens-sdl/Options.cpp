@@ -25,6 +25,9 @@
 using LibGens::MdFb;
 using LibGens::SysVersion;
 
+// LibZomg
+using LibZomg::Zomg;
+
 // C includes. (C++ namespace)
 #include <cstring>
 #include <cerrno>
@@ -79,15 +82,25 @@ class OptionsPrivate
 		int sprite_limits;		// Enable sprite limits?
 		int auto_fix_checksum;		// Auto fix checksum?
 		SysVersion::RegionCode_t region;	// Region code.
+		int run_ahead;			// Number of frames to run ahead.
+		int run_ahead_thread;		// Run ahead on a second thread?
+		int render_thread;		// Render on a second thread?
+		Zomg::CompressionProfile zomg_compression;	// Savestate compression.
+		int zomg_preview;		// Save preview images in savestates?
 
 		// UI options.
 		int fps_counter;		// Enable FPS counter?
 		int auto_pause;			// Auto pause?
 		int paused_effect;		// Paused effect?
+		int perf_counters;		// Performance counters?
 		MdFb::ColorDepth bpp;		// Color depth. (15, 16, 32)
 
 		// Special run modes.
 		int run_crazy_effect;		// Run the Crazy Effect
+		int headless;			// Run in headless mode.
+		unsigned int frames;		// Number of frames to run. (headless)
+		string input_script;		// Input script. (headless)
+		int no_render;			// Skip VDP rendering. (headless)
 };
 
 /** OptionsPrivate **/
@@ -108,6 +121,7 @@ void OptionsPrivate::reset(void)
 	// TODO: Swap with empty strings?
 	rom_filename.clear();
 	tmss_rom_filename.clear();
+	input_script.clear();
 
 	// Audio options.
 	sound_freq = 44100;
@@ -117,15 +131,24 @@ void OptionsPrivate::reset(void)
 	sprite_limits = true;
 	auto_fix_checksum = false;
 	region = SysVersion::REGION_AUTO;
+	run_ahead = 0;
+	run_ahead_thread = false;
+	render_thread = false;
+	zomg_compression = Zomg::CP_DEFAULT;
+	zomg_preview = true;
 
 	// UI options.
 	fps_counter = true;
 	auto_pause = false;
 	paused_effect = true;
+	perf_counters = false;
 	bpp = MdFb::BPP_32;
 
 	// Special run modes.
 	run_crazy_effect = false;
+	headless = false;
+	frames = 0;
+	no_render = false;
 }
 
 /** Options **/
@@ -208,7 +231,10 @@ int Options::parse(int argc, const char *argv[])
 		const char *rom_filename;
 		const char *tmss_rom_filename;
 		const char *region;
+		const char *zomg_compression;
+		const char *input_script;
 		int bpp;
+		int frames;
 	} tmp;
 	memset(&tmp, 0, sizeof(tmp));
 	tmp.bpp = 32;
@@ -247,6 +273,22 @@ int Options::parse(int argc, const char *argv[])
 			"* Don't automatically fix checksums.", NULL},
 		{"region", '\0', POPT_ARG_STRING, &tmp.region, 0,
 			"  Set the region code: J,U,E,Asia,Auto (default is auto)", "REGION"},
+		{"run-ahead", '\0', POPT_ARG_INT, &d->run_ahead, 0,
+			"  Run ahead to reduce input latency. (0-8, default is 0)", "FRAMES"},
+		{"run-ahead-thread", '\0', POPT_ARG_VAL, &d->run_ahead_thread, 1,
+			"  Run ahead on a second emulation thread.", NULL},
+		{"no-run-ahead-thread", '\0', POPT_ARG_VAL, &d->run_ahead_thread, 0,
+			"* Run ahead on the main emulation thread.", NULL},
+		{"render-thread", '\0', POPT_ARG_VAL, &d->render_thread, 1,
+			"  Render video on a second thread.", NULL},
+		{"no-render-thread", '\0', POPT_ARG_VAL, &d->render_thread, 0,
+			"* Render video on the emulation thread.", NULL},
+		{"zomg-compression", '\0', POPT_ARG_STRING, &tmp.zomg_compression, 0,
+			"  Set the savestate compression: Store,Fast,Default,Best (default is default)", "PROFILE"},
+		{"zomg-preview", '\0', POPT_ARG_VAL, &d->zomg_preview, 1,
+			"* Save a preview image in savestates.", NULL},
+		{"no-zomg-preview", '\0', POPT_ARG_VAL, &d->zomg_preview, 0,
+			"  Don't save a preview image in savestates.", NULL},
 		POPT_TABLEEND
 	};
 
@@ -264,6 +306,10 @@ int Options::parse(int argc, const char *argv[])
 			"* Tint the window when paused.", NULL},
 		{"no-paused-effect", '\0', POPT_ARG_VAL, &d->paused_effect, 0,
 			"  Don't tint the window when paused.", NULL},
+		{"perf-counters", '\0', POPT_ARG_VAL, &d->perf_counters, 1,
+			"  Show per-subsystem frame times. (p50/p99)", NULL},
+		{"no-perf-counters", '\0', POPT_ARG_VAL, &d->perf_counters, 0,
+			"* Don't show per-subsystem frame times.", NULL},
 		{"bpp", '\0', POPT_ARG_INT, &tmp.bpp, 0,
 			"  Set the internal color depth. (15, 16, 32)", "BPP"},
 		POPT_TABLEEND
@@ -273,6 +319,19 @@ int Options::parse(int argc, const char *argv[])
 	struct poptOption runModesTable[] = {
 		{"crazy-effect", '\0', POPT_ARG_VAL, &d->run_crazy_effect, 1,
 			"  Run the \"Crazy\" Effect instead of loading a ROM.", NULL},
+		{"headless", '\0', POPT_ARG_VAL, &d->headless, 1,
+			"  Run without video or audio output, as fast as possible.", NULL},
+		POPT_TABLEEND
+	};
+
+	// popt: Headless mode options table.
+	struct poptOption headlessOptionsTable[] = {
+		{"frames", '\0', POPT_ARG_INT, &tmp.frames, 0,
+			"  Number of frames to run. (required)", "FRAMES"},
+		{"input-script", '\0', POPT_ARG_STRING, &tmp.input_script, 0,
+			"  Read controller input from a script file.", "FILENAME"},
+		{"no-render", '\0', POPT_ARG_VAL, &d->no_render, 1,
+			"  Don't render video. (Audio is still emulated.)", NULL},
 		POPT_TABLEEND
 	};
 
@@ -288,6 +347,8 @@ int Options::parse(int argc, const char *argv[])
 			"UI options: (* indicates default)", NULL},
 		{NULL, '\0', POPT_ARG_INCLUDE_TABLE, runModesTable, 0,
 			"Special run modes:", NULL},
+		{NULL, '\0', POPT_ARG_INCLUDE_TABLE, headlessOptionsTable, 0,
+			"Headless mode options:", NULL},
 		{NULL, '\0', POPT_ARG_INCLUDE_TABLE, helpOptionsTable, 0,
 			"Help options:", NULL},
 		POPT_TABLEEND
@@ -427,6 +488,37 @@ int Options::parse(int argc, const char *argv[])
 		}
 	}
 
+	// Savestate compression profile.
+	if (tmp.zomg_compression != nullptr) {
+		if (!strcasecmp(tmp.zomg_compression, "store") ||
+		    !strcasecmp(tmp.zomg_compression, "none"))
+		{
+			d->zomg_compression = Zomg::CP_STORE;
+		}
+		else if (!strcasecmp(tmp.zomg_compression, "fast"))
+		{
+			d->zomg_compression = Zomg::CP_FAST;
+		}
+		else if (!strcasecmp(tmp.zomg_compression, "default"))
+		{
+			d->zomg_compression = Zomg::CP_DEFAULT;
+		}
+		else if (!strcasecmp(tmp.zomg_compression, "best"))
+		{
+			d->zomg_compression = Zomg::CP_BEST;
+		}
+		else
+		{
+			// Invalid compression profile.
+			fprintf(stderr, "%s: '--zomg-compression=%s': invalid compression profile\n"
+				"Valid options are store, fast, default, and best.\n"
+				"Try `%s --help` for more information.\n",
+				argv[0], tmp.zomg_compression, argv[0]);
+			poptFreeContext(optCon);
+			return -EINVAL;
+		}
+	}
+
 	// Verify certain options.
 	d->bpp = MdFb::bppToColorDepth(tmp.bpp);
 	if (d->bpp < 0 || d->bpp >= MdFb::BPP_MAX) {
@@ -439,6 +531,48 @@ int Options::parse(int argc, const char *argv[])
 		return -EINVAL;
 	}
 
+	if (d->run_ahead < 0 || d->run_ahead > 8) {
+		// Invalid run-ahead frame count.
+		fprintf(stderr, "%s: '--run-ahead=%d': invalid frame count\n"
+			"Valid options are 0 through 8.\n"
+			"Try `%s --help` for more information.\n",
+			argv[0], d->run_ahead, argv[0]);
+		poptFreeContext(optCon);
+		return -EINVAL;
+	}
+
+	// Headless mode options.
+	if (tmp.input_script != nullptr) {
+		// Input script was specified.
+		d->input_script = string(tmp.input_script);
+	}
+	if (d->headless) {
+		if (tmp.frames <= 0) {
+			// Frame count is required in headless mode.
+			fprintf(stderr, "%s: '--headless' requires '--frames' with a positive value\n"
+				"Try `%s --help` for more information.\n",
+				argv[0], argv[0]);
+			poptFreeContext(optCon);
+			return -EINVAL;
+		}
+		if (d->run_crazy_effect) {
+			// Crazy Effect can't be run in headless mode.
+			fprintf(stderr, "%s: '--headless' cannot be used with '--crazy-effect'\n"
+				"Try `%s --help` for more information.\n",
+				argv[0], argv[0]);
+			poptFreeContext(optCon);
+			return -EINVAL;
+		}
+		d->frames = (unsigned int)tmp.frames;
+	} else if (tmp.frames != 0 || tmp.input_script != nullptr || d->no_render) {
+		// Headless mode options were specified without '--headless'.
+		fprintf(stderr, "%s: '--frames', '--input-script', and '--no-render' require '--headless'\n"
+			"Try `%s --help` for more information.\n",
+			argv[0], argv[0]);
+		poptFreeContext(optCon);
+		return -EINVAL;
+	}
+
 	// Check the ROM filename last so we can verify that the other
 	// arguments are correct.
 
@@ -531,14 +665,24 @@ ACCESSOR_BOOL(stereo)
 ACCESSOR_BOOL(sprite_limits)
 ACCESSOR_BOOL(auto_fix_checksum)
 ACCESSOR(SysVersion::RegionCode_t, region);
+ACCESSOR(int, run_ahead)
+ACCESSOR_BOOL(run_ahead_thread)
+ACCESSOR_BOOL(render_thread)
+ACCESSOR(Zomg::CompressionProfile, zomg_compression)
+ACCESSOR_BOOL(zomg_preview)
 
 /** UI options. **/
 ACCESSOR_BOOL(fps_counter)
 ACCESSOR_BOOL(auto_pause)
 ACCESSOR_BOOL(paused_effect)
+ACCESSOR_BOOL(perf_counters)
 ACCESSOR(MdFb::ColorDepth, bpp)
 
 /** Special run modes. **/
 ACCESSOR_BOOL(run_crazy_effect)
+ACCESSOR_BOOL(headless)
+ACCESSOR(unsigned int, frames)
+ACCESSOR(string, input_script)
+ACCESSOR_BOOL(no_render)
 
 }
@@ -26,6 +26,9 @@
 #include "libgens/Util/MdFb.hpp"
 #include "libgens/EmuContext/SysVersion.hpp"
 
+// LibZomg
+#include "libzomg/Zomg.hpp"
+
 // C++ includes.
 #include <string>
 
@@ -130,6 +133,36 @@ class Options
 		 */
 		LibGens::SysVersion::RegionCode_t region(void) const;
 
+		/**
+		 * Number of frames to run ahead.
+		 * @return Number of frames to run ahead. (0 == disabled)
+		 */
+		int run_ahead(void) const;
+
+		/**
+		 * Run the run-ahead frames on a second emulation thread?
+		 * @return True to use a second thread; false to not.
+		 */
+		bool run_ahead_thread(void) const;
+
+		/**
+		 * Render video on a second thread?
+		 * @return True to use a second thread; false to not.
+		 */
+		bool render_thread(void) const;
+
+		/**
+		 * Compression profile for savestates.
+		 * @return Compression profile.
+		 */
+		LibZomg::Zomg::CompressionProfile zomg_compression(void) const;
+
+		/**
+		 * Save a preview image in savestates?
+		 * @return True to save a preview image; false to not.
+		 */
+		bool zomg_preview(void) const;
+
 		/** UI options. **/
 
 		/**
@@ -150,6 +183,12 @@ class Options
 		 */
 		bool paused_effect(void) const;
 
+		/**
+		 * Show per-subsystem performance counters?
+		 * @return True to show performance counters; false to not.
+		 */
+		bool perf_counters(void) const;
+
 		/**
 		 * Color depth to use.
 		 * @return Color depth.
@@ -163,6 +202,32 @@ class Options
 		 * @return True to run the Crazy Effect.
 		 */
 		bool run_crazy_effect(void) const;
+
+		/**
+		 * Run in headless mode?
+		 * Headless mode doesn't open a window or an audio device,
+		 * and runs frames as fast as possible.
+		 * @return True to run in headless mode.
+		 */
+		bool headless(void) const;
+
+		/**
+		 * Number of frames to run in headless mode.
+		 * @return Number of frames.
+		 */
+		unsigned int frames(void) const;
+
+		/**
+		 * Get the filename of the headless mode input script.
+		 * @return Input script filename, or empty string if none.
+		 */
+		std::string input_script(void) const;
+
+		/**
+		 * Skip VDP rendering in headless mode?
+		 * @return True to skip rendering; false to render every frame.
+		 */
+		bool no_render(void) const;
 };
 
 }
@@ -26,6 +26,9 @@ using LibGens::MdFb;
 #include "libgens/sound/SoundMgr.hpp"
 using LibGens::SoundMgr;
 
+#include "libgens/Util/AvRecorder.hpp"
+using LibGens::AvRecorder;
+
 // C includes. (C++ namespace)
 #include <cstdio>
 
@@ -45,8 +48,10 @@ SdlHandler::SdlHandler()
 	, m_framesRendered(0)
 	, m_audioDevice(0)
 	, m_audioBuffer(nullptr)
+	, m_audioRate(0)
 	, m_sampleSize(0)
 	, m_stereo(false)
+	, m_avRecorder(nullptr)
 	, m_segBuffer(nullptr)
 	, m_segBufferLen(0)
 	, m_segBufferSamples(0)
@@ -232,6 +237,7 @@ int SdlHandler::init_audio(int freq, bool stereo)
 	}
 
 	// Determine the sample size.
+	m_audioRate = actual_spec.freq;
 	m_stereo = stereo;
 	m_sampleSize = (stereo ? 4 : 2);
 
@@ -293,6 +299,7 @@ void SdlHandler::end_audio(void)
 	// Free the buffers.
 	delete m_audioBuffer;
 	m_audioBuffer = nullptr;
+	m_audioRate = 0;
 	m_sampleSize = 0;
 	aligned_free(m_segBuffer);
 	m_segBuffer = nullptr;
@@ -346,6 +353,41 @@ void SdlHandler::update_audio(void)
 		m_audioBuffer->write(reinterpret_cast<const uint8_t*>(m_segBuffer), bytes);
 		SDL_UnlockAudioDevice(m_audioDevice);
 	}
+
+	// Send the audio to the A/V recorder.
+	// This only copies the samples; it never blocks.
+	if (m_avRecorder && samples > 0) {
+		m_avRecorder->pushAudio(m_segBuffer, samples, (m_stereo ? 2 : 1));
+	}
+}
+
+/**
+ * Get the audio sampling rate.
+ * @return Sampling rate, or 0 if audio isn't initialized.
+ */
+int SdlHandler::audio_rate(void) const
+{
+	return m_audioRate;
+}
+
+/**
+ * Is audio in stereo?
+ * @return True if stereo; false if mono.
+ */
+bool SdlHandler::audio_stereo(void) const
+{
+	return m_stereo;
+}
+
+/**
+ * Set the A/V recorder.
+ * update_audio() sends audio to the recorder
+ * in addition to the audio device.
+ * @param avRecorder A/V recorder. (If nullptr, audio isn't recorded.)
+ */
+void SdlHandler::set_av_recorder(AvRecorder *avRecorder)
+{
+	m_avRecorder = avRecorder;
 }
 
 }
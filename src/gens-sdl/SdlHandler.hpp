@@ -43,6 +43,10 @@
 #define ATTR_FORMAT_PRINTF(fmt, varargs)
 #endif
 
+namespace LibGens {
+	class AvRecorder;
+}
+
 namespace GensSdl {
 
 class RingBuffer;
@@ -143,6 +147,26 @@ class SdlHandler {
 		 */
 		void update_audio(void);
 
+		/**
+		 * Get the audio sampling rate.
+		 * @return Sampling rate, or 0 if audio isn't initialized.
+		 */
+		int audio_rate(void) const;
+
+		/**
+		 * Is audio in stereo?
+		 * @return True if stereo; false if mono.
+		 */
+		bool audio_stereo(void) const;
+
+		/**
+		 * Set the A/V recorder.
+		 * update_audio() sends audio to the recorder
+		 * in addition to the audio device.
+		 * @param avRecorder A/V recorder. (If nullptr, audio isn't recorded.)
+		 */
+		void set_av_recorder(LibGens::AvRecorder *avRecorder);
+
 		/**
 		 * Convert an SDL2 scancode to a Gens keycode.
 		 * @param scancode SDL2 scancode.
@@ -169,9 +193,13 @@ class SdlHandler {
 		// Audio.
 		SDL_AudioDeviceID m_audioDevice;
 		RingBuffer *m_audioBuffer;
+		int m_audioRate;
 		int m_sampleSize;
 		bool m_stereo;
 
+		// A/V recorder. (not owned by SdlHandler)
+		LibGens::AvRecorder *m_avRecorder;
+
 		// Segment buffer.
 		int16_t *m_segBuffer;
 		// Length of m_segBuffer, in bytes.
@@ -43,6 +43,7 @@ using GensSdl::VBackend;
 // Main event loops.
 #include "EmuLoop.hpp"
 #include "CrazyEffectLoop.hpp"
+#include "HeadlessLoop.hpp"
 
 // Command line parameters.
 #include "Options.hpp"
@@ -141,7 +142,11 @@ static void gsdl_osd(OsdType osd_type, int param)
 
 	if (msg != nullptr) {
 		VBackend *vBackend = eventLoop->vBackend();
-		if (vBackend) {
+		if (options->headless()) {
+			// Headless mode. Print the message to stderr.
+			fprintf(stderr, msg, param);
+			fputc('\n', stderr);
+		} else if (vBackend) {
 			vBackend->osd_printf(1500, msg, param);
 		} else {
 			// SDL handler hasn't been created yet.
@@ -185,6 +190,9 @@ int run(void)
 	if (options->run_crazy_effect()) {
 		// Run the Crazy Effect.
 		eventLoop = new CrazyEffectLoop();
+	} else if (options->headless()) {
+		// Run the headless batch runner.
+		eventLoop = new HeadlessLoop();
 	} else {
 		// Start the emulation loop.
 		eventLoop = new EmuLoop();
@@ -257,8 +257,18 @@ uint32_t LibCompat_GetCPUFlags(void)
 	// Check for XSAVE.
 	if (__ecx & CPUFLAG_IA32_ECX_XSAVE) {
 		// CPU supports XSAVE. Does the OS?
-		/* FIXME: Detect XSAVE. */
-		can_XSAVE = 0;
+		// OSXSAVE indicates that the OS has enabled XSAVE,
+		// and XCR0 indicates which register states it saves.
+		if (__ecx & CPUFLAG_IA32_ECX_OSXSAVE) {
+			uint32_t xcr0;
+			XGETBV(0, xcr0);
+			if ((xcr0 & (IA32_XCR0_SSE | IA32_XCR0_AVX)) ==
+			    (IA32_XCR0_SSE | IA32_XCR0_AVX))
+			{
+				// OS saves both XMM and YMM registers.
+				can_XSAVE = 1;
+			}
+		}
 	}
 
 	// Check for AVX.
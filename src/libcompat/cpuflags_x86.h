@@ -37,6 +37,10 @@
 // CR0.EM: FPU emulation.
 #define IA32_CR0_EM		(1U << 2)
 
+// XCR0: OS-enabled XSAVE state components. (read with XGETBV)
+#define IA32_XCR0_SSE		(1U << 1)
+#define IA32_XCR0_AVX		(1U << 2)
+
 // CPUID function 1: Processor Info and Feature Bits
 
 // Flags stored in the %edx register.
@@ -135,6 +139,31 @@
 #error Missing 'cpuid' asm implementation for this compiler.
 #endif
 
+#if defined(__GNUC__)
+// XGETBV macro. (low 32 bits only)
+// The opcode is emitted directly for older assemblers.
+#define XGETBV(xcr, a) do {					\
+	uint32_t __xgetbv_edx;					\
+	__asm__ (						\
+		".byte 0x0F, 0x01, 0xD0\n"			\
+		: "=a" (a), "=d" (__xgetbv_edx)			\
+		: "c" (xcr)					\
+		);						\
+	((void)__xgetbv_edx);					\
+	} while (0)
+#elif defined(_MSC_VER) && defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219
+// _xgetbv() was added in MSVC 2010 SP1.
+#include <immintrin.h>
+#define XGETBV(xcr, a) do {					\
+	(a) = (uint32_t)_xgetbv(xcr);				\
+} while (0)
+#else
+// XGETBV isn't available. XSAVE won't be detected.
+#define XGETBV(xcr, a) do {					\
+	(a) = 0;						\
+} while (0)
+#endif
+
 /**
  * Force a function to be marked as inline.
  * FORCE_INLINE: Release builds only.
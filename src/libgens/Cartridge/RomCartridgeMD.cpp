@@ -35,7 +35,7 @@
 #include "lg_osd.h"
 
 // ZOMG
-#include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgBase.hpp"
 #include "libzomg/zomg_md_time_reg.h"
 
 // aligned_malloc()
@@ -123,6 +123,11 @@ class RomCartridgeMDPrivate
 				uint32_t addr[4];	// Register addresses.
 				uint16_t reg[4];	// Register values.
 			} registers_ro;
+
+			// Disable 68000 idle loop detection.
+			// Needed if the game's polling loops are timing-sensitive,
+			// e.g. loops that wait for a specific H counter value.
+			bool idle_loop_off;
 		};
 
 		static const MD_RomFixup_t MD_RomFixups[];
@@ -154,37 +159,37 @@ const RomCartridgeMDPrivate::MD_RomFixup_t RomCartridgeMDPrivate::MD_RomFixups[]
 	// Puggsy: Shows an anti-piracy message after the third level if SRAM is detected.
 	{{"GM T-113016", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_SEGA,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 	// Puggsy (Beta)
 	{{"GM T-550055", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_SEGA,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 
 	// Psy-O-Blade: Incorrect SRAM header.
 	{{"GM T-26013 ", 0, 0}, {0x200000, 0x203FFF, false},
 		RomCartridgeMD::CHKSUM_SEGA,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 
 	// Super Street Fighter II: Use SSF2 mapper.
 	{{"GM T-12056 ", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_SSF2, {{0}, {0}, {0}}},	// US
+		RomCartridgeMD::MAPPER_MD_SSF2, {{0}, {0}, {0}}, false},	// US
 	{{"GM MK-12056", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_SSF2, {{0}, {0}, {0}}},	// EU
+		RomCartridgeMD::MAPPER_MD_SSF2, {{0}, {0}, {0}}, false},	// EU
 	{{"GM T-12043 ", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_SSF2, {{0}, {0}, {0}}},	// JP
+		RomCartridgeMD::MAPPER_MD_SSF2, {{0}, {0}, {0}}, false},	// JP
 
 	// Alien Soldier (J): Uses a non-standard checksum.
 	{{"GM G-004130", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 
 	// Cadash (JU): Uses a non-standard checksum.
 	{{"GM T-11086 ", 0, 0}, {0, 0, true},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 
 	/**
 	 * Xin Qi Gai Wang Zi (original version of Beggar Prince):
@@ -196,10 +201,10 @@ const RomCartridgeMDPrivate::MD_RomFixup_t RomCartridgeMDPrivate::MD_RomFixups[]
 	 */
 	{{nullptr, 0, 0xDD2F38B5}, {0x400000, 0x40FFFF, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 	{{nullptr, 0, 0xDA5A4BFE}, {0x400000, 0x40FFFF, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}},
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false},
 
 	/** ROMs that use MAPPER_MD_REGISTERS_RO. **/
 
@@ -209,14 +214,14 @@ const RomCartridgeMDPrivate::MD_RomFixup_t RomCartridgeMDPrivate::MD_RomFixups[]
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0x400004, 0x400006},
-		 {0x55FF, 0x0FFF, 0xAAFF, 0xF0FF}}},
+		 {0x55FF, 0x0FFF, 0xAAFF, 0xF0FF}}, false},
 	// Huan Le Tao Qi Shu: Smart Mouse [h1C]
 	{{nullptr, 0, 0xDA5A4587}, {0, 0, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0x400004, 0x400006},
-		 {0x55FF, 0x0FFF, 0xAAFF, 0xF0FF}}},
+		 {0x55FF, 0x0FFF, 0xAAFF, 0xF0FF}}, false},
 
 	// 777 Casino
 	// NOTE: Only the first register is used.
@@ -227,21 +232,21 @@ const RomCartridgeMDPrivate::MD_RomFixup_t RomCartridgeMDPrivate::MD_RomFixups[]
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0x400004, 0x400006},
-		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}},
+		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}, false},
 	// 777 Casino [h1C]
 	{{nullptr, 0, 0xF14D3F2E}, {0, 0, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0x400004, 0x400006},
-		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}},
+		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}, false},
 	// 777 Casino [h2C]
 	{{nullptr, 0, 0x74B17EAF}, {0, 0, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0x400004, 0x400006},
-		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}},
+		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}, false},
 
 	// Super Bubble Bobble MD
 	{{nullptr, 0, 0x4820A161}, {0, 0, false},
@@ -249,7 +254,7 @@ const RomCartridgeMDPrivate::MD_RomFixup_t RomCartridgeMDPrivate::MD_RomFixups[]
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0, 0},
-		 {0x55FF, 0x0FFF, 0, 0}}},
+		 {0x55FF, 0x0FFF, 0, 0}}, false},
 
 	// Ya Se Chuan Shuo: "The Legend of Arthur" edition
 	{{nullptr, 0, 0x095B9A15}, {0, 0, false},
@@ -257,26 +262,26 @@ const RomCartridgeMDPrivate::MD_RomFixup_t RomCartridgeMDPrivate::MD_RomFixups[]
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0, 0},
-		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}},
+		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}, false},
 	// Ya Se Chuan Shuo: "The Legend of Arthur" edition [f1]
 	{{nullptr, 0, 0xFBA90DC4}, {0, 0, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0, 0},
-		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}},
+		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}, false},
 	// Ya Se Chuan Shuo: "The Legend of Arthur" edition [f2]
 	{{nullptr, 0, 0x359CB75A}, {0, 0, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
 		RomCartridgeMD::MAPPER_MD_REGISTERS_RO,
 		{{0xFFFFFF, 0xFFFFFF, 0xFFFFFF, 0xFFFFFF},
 		 {0x400000, 0x400002, 0, 0},
-		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}},
+		 {0x63FF, 0x98FF, 0xC9FF, 0x18FF}}, false},
 
 	// End of list.
 	{{nullptr, 0, 0}, {0, 0, false},
 		RomCartridgeMD::CHKSUM_DISABLED,
-		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}}
+		RomCartridgeMD::MAPPER_MD_FLAT, {{0}, {0}, {0}}, false}
 };
 
 /**
@@ -345,6 +350,9 @@ RomCartridgeMD::RomCartridgeMD(Rom *rom)
 	, m_mars(false)
 	, m_mars_bank_reg(0)
 {
+	// No ROM is loaded yet. All pages read as open bus.
+	memset(m_cartPages, 0, sizeof(m_cartPages));
+
 	// Set the SRam and EEPRom pathnames.
 	// TODO: Update them if the pathname is changed.
 	m_SRam.setPathname(EmuContext::PathSRam());
@@ -473,6 +481,9 @@ int RomCartridgeMD::loadRom(void)
 		m_EEPRom.setEEPRomType(-1);
 	}
 
+	// Build the cartridge read page table.
+	updateCartPages();
+
 	// ...and we're done here.
 	return 0;
 }
@@ -486,6 +497,17 @@ bool RomCartridgeMD::isRomLoaded(void) const
 	return (m_romData != nullptr);
 }
 
+/**
+ * Can 68000 idle loop detection be used with this ROM?
+ * @return True if idle loop detection can be used; false if not.
+ */
+bool RomCartridgeMD::idleLoopDetect(void) const
+{
+	if (d->romFixup < 0)
+		return true;
+	return !RomCartridgeMDPrivate::MD_RomFixups[d->romFixup].idle_loop_off;
+}
+
 /**
  * Update M68K CPU program access structs for bankswitching purposes.
  * @param M68K_Fetch Pointer to first STARSCREAM_PROGRAMREGION to update.
@@ -499,7 +521,6 @@ int RomCartridgeMD::updateSysBanking(STARSCREAM_PROGRAMREGION *M68K_Fetch, int b
 	if (banks > ARRAY_SIZE(m_cartBanks))
 		banks = ARRAY_SIZE(m_cartBanks);
 
-	// TODO: This is not 64-bit clean!
 	for (int i = 0; i < banks; i++) {
 		if (/*m_cartBanks[i] >= BANK_ROM_00 &&*/
 		    m_cartBanks[i] <= BANK_ROM_3F) {
@@ -510,7 +531,7 @@ int RomCartridgeMD::updateSysBanking(STARSCREAM_PROGRAMREGION *M68K_Fetch, int b
 				// Valid bank. Map it.
 				M68K_Fetch->lowaddr = romAddrStart;
 				M68K_Fetch->highaddr = (romAddrStart + 0x7FFFF);
-				M68K_Fetch->offset = ((uint32_t)m_romData);
+				M68K_Fetch->offset = ((uintptr_t)m_romData);
 				M68K_Fetch++;
 				banksUpdated++;
 			}
@@ -789,42 +810,6 @@ int RomCartridgeMD::initEEPRom(void)
 }
 
 
-/** ROM access functions. **/
-
-/**
- * Read a byte from ROM.
- * @param bank Physical ROM bank.
- * @param address Address.
- * @return Byte from ROM.
- */
-template<uint8_t bank>
-inline uint8_t RomCartridgeMD::T_readByte_Rom(uint32_t address)
-{
-	// TODO: Mirroring; CPU prefetch.
-	address &= 0x7FFFF;
-	address ^= ((bank << 19) | BYTE_ADDR_INVERT);
-	if (address >= m_romData_size)
-		return 0xFF;
-	return (reinterpret_cast<uint8_t*>(m_romData))[address];
-}
-
-/**
- * Read a word from ROM.
- * @param bank Physical ROM bank.
- * @param address Address.
- * @return Word from ROM.
- */
-template<uint8_t bank>
-inline uint16_t RomCartridgeMD::T_readWord_Rom(uint32_t address)
-{
-	// TODO: Mirroring; CPU prefetch.
-	address &= 0x7FFFF;
-	address |= (bank << 19);
-	if (address >= m_romData_size)
-		return 0xFFFF;
-	return (reinterpret_cast<uint16_t*>(m_romData))[address >> 1];
-}
-
 /** Mapper functions. **/
 
 /**
@@ -884,12 +869,67 @@ inline uint16_t RomCartridgeMD::readWord_REGISTERS_RO(uint32_t address)
  * @return Byte from cartridge.
  */
 uint8_t RomCartridgeMD::readByte(uint32_t address)
+{
+	const CartPage_t *const page = &m_cartPages[(address >> 19) & 0x1F];
+	if (page->slow)
+		return readByte_slow(address);
+
+	// TODO: Mirroring; CPU prefetch.
+	address &= 0x7FFFF;
+	if (address >= page->size)
+		return 0xFF;
+	return page->rom[address ^ BYTE_ADDR_INVERT];
+}
+
+/**
+ * Read a word from the standard cartridge area. ($000000-$9FFFFF)
+ * @param address Cartridge address.
+ * @return Word from cartridge.
+ */
+uint16_t RomCartridgeMD::readWord(uint32_t address)
+{
+	const CartPage_t *const page = &m_cartPages[(address >> 19) & 0x1F];
+	if (page->slow)
+		return readWord_slow(address);
+
+	// TODO: Mirroring; CPU prefetch.
+	address &= 0x7FFFE;
+	if (address >= page->size)
+		return 0xFFFF;
+	return *(reinterpret_cast<const uint16_t*>(&page->rom[address]));
+}
+
+/**
+ * Get a direct pointer to plain ROM data.
+ * Used for bulk transfers, e.g. VDP DMA.
+ * @param address Cartridge address. (must be even)
+ * @param len Length, in bytes.
+ * @return Pointer to ROM words in host byte order, or nullptr if the range isn't plain ROM within a single 512 KB bank.
+ */
+const uint16_t *RomCartridgeMD::romPtr(uint32_t address, uint32_t len) const
+{
+	const CartPage_t *const page = &m_cartPages[(address >> 19) & 0x1F];
+	if (page->slow || !page->rom || (address & 1))
+		return nullptr;
+
+	// The entire range must be within the valid part of the bank.
+	address &= 0x7FFFF;
+	if (len > page->size || address > page->size - len)
+		return nullptr;
+	return reinterpret_cast<const uint16_t*>(&page->rom[address]);
+}
+
+/**
+ * Read a byte from a page that isn't plain ROM.
+ * This handles SRAM, EEPROM, and mapper registers.
+ * @param address Cartridge address.
+ * @return Byte from cartridge.
+ */
+uint8_t RomCartridgeMD::readByte_slow(uint32_t address)
 {
 	address &= 0xFFFFFF;
 
 	// Check for save data access.
-	// TODO: Determine the physical banks for SRAM/EEPROM and
-	// check that in order to optimize this.
 	if (EmuContext::GetSaveDataEnable()) {
 		if (m_EEPRom.isEEPRomTypeSet()) {
 			// EEPRom is enabled.
@@ -908,94 +948,31 @@ uint8_t RomCartridgeMD::readByte(uint32_t address)
 	}
 
 	const uint8_t phys_bank = ((address >> 19) & 0x1F);
-
-	switch (m_cartBanks[phys_bank]) {
-		default:
-		case BANK_UNUSED:	return 0xFF;
-
-		// Physical ROM bank.
-		case BANK_ROM_00:	return T_readByte_Rom<0x00>(address);
-		case BANK_ROM_01:	return T_readByte_Rom<0x01>(address);
-		case BANK_ROM_02:	return T_readByte_Rom<0x02>(address);
-		case BANK_ROM_03:	return T_readByte_Rom<0x03>(address);
-		case BANK_ROM_04:	return T_readByte_Rom<0x04>(address);
-		case BANK_ROM_05:	return T_readByte_Rom<0x05>(address);
-		case BANK_ROM_06:	return T_readByte_Rom<0x06>(address);
-		case BANK_ROM_07:	return T_readByte_Rom<0x07>(address);
-		case BANK_ROM_08:	return T_readByte_Rom<0x08>(address);
-		case BANK_ROM_09:	return T_readByte_Rom<0x09>(address);
-		case BANK_ROM_0A:	return T_readByte_Rom<0x0A>(address);
-		case BANK_ROM_0B:	return T_readByte_Rom<0x0B>(address);
-		case BANK_ROM_0C:	return T_readByte_Rom<0x0C>(address);
-		case BANK_ROM_0D:	return T_readByte_Rom<0x0D>(address);
-		case BANK_ROM_0E:	return T_readByte_Rom<0x0E>(address);
-		case BANK_ROM_0F:	return T_readByte_Rom<0x0F>(address);
-		case BANK_ROM_10:	return T_readByte_Rom<0x10>(address);
-		case BANK_ROM_11:	return T_readByte_Rom<0x11>(address);
-		case BANK_ROM_12:	return T_readByte_Rom<0x12>(address);
-		case BANK_ROM_13:	return T_readByte_Rom<0x13>(address);
-		case BANK_ROM_14:	return T_readByte_Rom<0x14>(address);
-		case BANK_ROM_15:	return T_readByte_Rom<0x15>(address);
-		case BANK_ROM_16:	return T_readByte_Rom<0x16>(address);
-		case BANK_ROM_17:	return T_readByte_Rom<0x17>(address);
-		case BANK_ROM_18:	return T_readByte_Rom<0x18>(address);
-		case BANK_ROM_19:	return T_readByte_Rom<0x19>(address);
-		case BANK_ROM_1A:	return T_readByte_Rom<0x1A>(address);
-		case BANK_ROM_1B:	return T_readByte_Rom<0x1B>(address);
-		case BANK_ROM_1C:	return T_readByte_Rom<0x1C>(address);
-		case BANK_ROM_1D:	return T_readByte_Rom<0x1D>(address);
-		case BANK_ROM_1E:	return T_readByte_Rom<0x1E>(address);
-		case BANK_ROM_1F:	return T_readByte_Rom<0x1F>(address);
-		case BANK_ROM_20:	return T_readByte_Rom<0x20>(address);
-		case BANK_ROM_21:	return T_readByte_Rom<0x21>(address);
-		case BANK_ROM_22:	return T_readByte_Rom<0x22>(address);
-		case BANK_ROM_23:	return T_readByte_Rom<0x23>(address);
-		case BANK_ROM_24:	return T_readByte_Rom<0x24>(address);
-		case BANK_ROM_25:	return T_readByte_Rom<0x25>(address);
-		case BANK_ROM_26:	return T_readByte_Rom<0x26>(address);
-		case BANK_ROM_27:	return T_readByte_Rom<0x27>(address);
-		case BANK_ROM_28:	return T_readByte_Rom<0x28>(address);
-		case BANK_ROM_29:	return T_readByte_Rom<0x29>(address);
-		case BANK_ROM_2A:	return T_readByte_Rom<0x2A>(address);
-		case BANK_ROM_2B:	return T_readByte_Rom<0x2B>(address);
-		case BANK_ROM_2C:	return T_readByte_Rom<0x2C>(address);
-		case BANK_ROM_2D:	return T_readByte_Rom<0x2D>(address);
-		case BANK_ROM_2E:	return T_readByte_Rom<0x2E>(address);
-		case BANK_ROM_2F:	return T_readByte_Rom<0x2F>(address);
-		case BANK_ROM_30:	return T_readByte_Rom<0x30>(address);
-		case BANK_ROM_31:	return T_readByte_Rom<0x31>(address);
-		case BANK_ROM_32:	return T_readByte_Rom<0x32>(address);
-		case BANK_ROM_33:	return T_readByte_Rom<0x33>(address);
-		case BANK_ROM_34:	return T_readByte_Rom<0x34>(address);
-		case BANK_ROM_35:	return T_readByte_Rom<0x35>(address);
-		case BANK_ROM_36:	return T_readByte_Rom<0x36>(address);
-		case BANK_ROM_37:	return T_readByte_Rom<0x37>(address);
-		case BANK_ROM_38:	return T_readByte_Rom<0x38>(address);
-		case BANK_ROM_39:	return T_readByte_Rom<0x39>(address);
-		case BANK_ROM_3A:	return T_readByte_Rom<0x3A>(address);
-		case BANK_ROM_3B:	return T_readByte_Rom<0x3B>(address);
-		case BANK_ROM_3C:	return T_readByte_Rom<0x3C>(address);
-		case BANK_ROM_3D:	return T_readByte_Rom<0x3D>(address);
-		case BANK_ROM_3E:	return T_readByte_Rom<0x3E>(address);
-		case BANK_ROM_3F:	return T_readByte_Rom<0x3F>(address);
-
-		// Mappers.
-		case BANK_MD_REGISTERS_RO:	return readByte_REGISTERS_RO(address);
+	if (phys_bank < ARRAY_SIZE(m_cartBanks) &&
+	    m_cartBanks[phys_bank] == BANK_MD_REGISTERS_RO)
+	{
+		return readByte_REGISTERS_RO(address);
 	}
+
+	// ROM bank, or unused.
+	const CartPage_t *const page = &m_cartPages[phys_bank];
+	address &= 0x7FFFF;
+	if (address >= page->size)
+		return 0xFF;
+	return page->rom[address ^ BYTE_ADDR_INVERT];
 }
 
 /**
- * Read a word from the standard cartridge area. ($000000-$9FFFFF)
+ * Read a word from a page that isn't plain ROM.
+ * This handles SRAM, EEPROM, and mapper registers.
  * @param address Cartridge address.
  * @return Word from cartridge.
  */
-uint16_t RomCartridgeMD::readWord(uint32_t address)
+uint16_t RomCartridgeMD::readWord_slow(uint32_t address)
 {
 	address &= 0xFFFFFF;
 
 	// Check for save data access.
-	// TODO: Determine the physical banks for SRAM/EEPROM and
-	// check that in order to optimize this.
 	if (EmuContext::GetSaveDataEnable()) {
 		if (m_EEPRom.isEEPRomTypeSet()) {
 			// EEPRom is enabled.
@@ -1014,80 +991,18 @@ uint16_t RomCartridgeMD::readWord(uint32_t address)
 	}
 
 	const uint8_t phys_bank = ((address >> 19) & 0x1F);
-
-	switch (m_cartBanks[phys_bank]) {
-		default:
-		case BANK_UNUSED:	return 0xFFFF;
-
-		// Physical ROM bank.
-		case BANK_ROM_00:	return T_readWord_Rom<0x00>(address);
-		case BANK_ROM_01:	return T_readWord_Rom<0x01>(address);
-		case BANK_ROM_02:	return T_readWord_Rom<0x02>(address);
-		case BANK_ROM_03:	return T_readWord_Rom<0x03>(address);
-		case BANK_ROM_04:	return T_readWord_Rom<0x04>(address);
-		case BANK_ROM_05:	return T_readWord_Rom<0x05>(address);
-		case BANK_ROM_06:	return T_readWord_Rom<0x06>(address);
-		case BANK_ROM_07:	return T_readWord_Rom<0x07>(address);
-		case BANK_ROM_08:	return T_readWord_Rom<0x08>(address);
-		case BANK_ROM_09:	return T_readWord_Rom<0x09>(address);
-		case BANK_ROM_0A:	return T_readWord_Rom<0x0A>(address);
-		case BANK_ROM_0B:	return T_readWord_Rom<0x0B>(address);
-		case BANK_ROM_0C:	return T_readWord_Rom<0x0C>(address);
-		case BANK_ROM_0D:	return T_readWord_Rom<0x0D>(address);
-		case BANK_ROM_0E:	return T_readWord_Rom<0x0E>(address);
-		case BANK_ROM_0F:	return T_readWord_Rom<0x0F>(address);
-		case BANK_ROM_10:	return T_readWord_Rom<0x10>(address);
-		case BANK_ROM_11:	return T_readWord_Rom<0x11>(address);
-		case BANK_ROM_12:	return T_readWord_Rom<0x12>(address);
-		case BANK_ROM_13:	return T_readWord_Rom<0x13>(address);
-		case BANK_ROM_14:	return T_readWord_Rom<0x14>(address);
-		case BANK_ROM_15:	return T_readWord_Rom<0x15>(address);
-		case BANK_ROM_16:	return T_readWord_Rom<0x16>(address);
-		case BANK_ROM_17:	return T_readWord_Rom<0x17>(address);
-		case BANK_ROM_18:	return T_readWord_Rom<0x18>(address);
-		case BANK_ROM_19:	return T_readWord_Rom<0x19>(address);
-		case BANK_ROM_1A:	return T_readWord_Rom<0x1A>(address);
-		case BANK_ROM_1B:	return T_readWord_Rom<0x1B>(address);
-		case BANK_ROM_1C:	return T_readWord_Rom<0x1C>(address);
-		case BANK_ROM_1D:	return T_readWord_Rom<0x1D>(address);
-		case BANK_ROM_1E:	return T_readWord_Rom<0x1E>(address);
-		case BANK_ROM_1F:	return T_readWord_Rom<0x1F>(address);
-		case BANK_ROM_20:	return T_readWord_Rom<0x20>(address);
-		case BANK_ROM_21:	return T_readWord_Rom<0x21>(address);
-		case BANK_ROM_22:	return T_readWord_Rom<0x22>(address);
-		case BANK_ROM_23:	return T_readWord_Rom<0x23>(address);
-		case BANK_ROM_24:	return T_readWord_Rom<0x24>(address);
-		case BANK_ROM_25:	return T_readWord_Rom<0x25>(address);
-		case BANK_ROM_26:	return T_readWord_Rom<0x26>(address);
-		case BANK_ROM_27:	return T_readWord_Rom<0x27>(address);
-		case BANK_ROM_28:	return T_readWord_Rom<0x28>(address);
-		case BANK_ROM_29:	return T_readWord_Rom<0x29>(address);
-		case BANK_ROM_2A:	return T_readWord_Rom<0x2A>(address);
-		case BANK_ROM_2B:	return T_readWord_Rom<0x2B>(address);
-		case BANK_ROM_2C:	return T_readWord_Rom<0x2C>(address);
-		case BANK_ROM_2D:	return T_readWord_Rom<0x2D>(address);
-		case BANK_ROM_2E:	return T_readWord_Rom<0x2E>(address);
-		case BANK_ROM_2F:	return T_readWord_Rom<0x2F>(address);
-		case BANK_ROM_30:	return T_readWord_Rom<0x30>(address);
-		case BANK_ROM_31:	return T_readWord_Rom<0x31>(address);
-		case BANK_ROM_32:	return T_readWord_Rom<0x32>(address);
-		case BANK_ROM_33:	return T_readWord_Rom<0x33>(address);
-		case BANK_ROM_34:	return T_readWord_Rom<0x34>(address);
-		case BANK_ROM_35:	return T_readWord_Rom<0x35>(address);
-		case BANK_ROM_36:	return T_readWord_Rom<0x36>(address);
-		case BANK_ROM_37:	return T_readWord_Rom<0x37>(address);
-		case BANK_ROM_38:	return T_readWord_Rom<0x38>(address);
-		case BANK_ROM_39:	return T_readWord_Rom<0x39>(address);
-		case BANK_ROM_3A:	return T_readWord_Rom<0x3A>(address);
-		case BANK_ROM_3B:	return T_readWord_Rom<0x3B>(address);
-		case BANK_ROM_3C:	return T_readWord_Rom<0x3C>(address);
-		case BANK_ROM_3D:	return T_readWord_Rom<0x3D>(address);
-		case BANK_ROM_3E:	return T_readWord_Rom<0x3E>(address);
-		case BANK_ROM_3F:	return T_readWord_Rom<0x3F>(address);
-
-		// Mappers.
-		case BANK_MD_REGISTERS_RO:	return readWord_REGISTERS_RO(address);
+	if (phys_bank < ARRAY_SIZE(m_cartBanks) &&
+	    m_cartBanks[phys_bank] == BANK_MD_REGISTERS_RO)
+	{
+		return readWord_REGISTERS_RO(address);
 	}
+
+	// ROM bank, or unused.
+	const CartPage_t *const page = &m_cartPages[phys_bank];
+	address &= 0x7FFFE;
+	if (address >= page->size)
+		return 0xFFFF;
+	return *(reinterpret_cast<const uint16_t*>(&page->rom[address]));
 }
 
 /**
@@ -1207,6 +1122,7 @@ void RomCartridgeMD::writeByte_TIME(uint8_t address, uint8_t data)
 	if (address == 0xF1) {
 		// $A130F1: SRAM control register.
 		m_SRam.writeCtrl(data);
+		updateCartPages();
 		return;
 	}
 
@@ -1233,6 +1149,7 @@ void RomCartridgeMD::writeByte_TIME(uint8_t address, uint8_t data)
 			m_cartBanks[phys_bank] = (BANK_ROM_00 + virt_bank);
 			if (m_mars)
 				updateMarsBanking();
+			updateCartPages();
 			// TODO: Better way to update Starscream?
 			M68K::UpdateSysBanking();
 			return;
@@ -1250,6 +1167,7 @@ void RomCartridgeMD::writeWord_TIME(uint8_t address, uint16_t data)
 	if (address == 0xF0) {
 		// $A130F0: SRAM control register.
 		m_SRam.writeCtrl(data);
+		updateCartPages();
 		return;
 	}
 
@@ -1276,6 +1194,7 @@ void RomCartridgeMD::writeWord_TIME(uint8_t address, uint16_t data)
 			m_cartBanks[phys_bank] = (BANK_ROM_00 + virt_bank);
 			if (m_mars)
 				updateMarsBanking();
+			updateCartPages();
 			// TODO: Better way to update Starscream?
 			M68K::UpdateSysBanking();
 			return;
@@ -1388,13 +1307,59 @@ void RomCartridgeMD::updateMarsBanking(void)
 	m_cartBanks[19] = bank_start + 1;
 }
 
+/**
+ * Rebuild the cartridge read page table.
+ * This must be called whenever m_cartBanks[], the SRAM
+ * control register, or the EEPROM configuration changes.
+ */
+void RomCartridgeMD::updateCartPages(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(m_cartPages); i++) {
+		CartPage_t *const page = &m_cartPages[i];
+		page->rom = nullptr;
+		page->size = 0;
+		page->slow = false;
+
+		const uint8_t bank = (i < ARRAY_SIZE(m_cartBanks) ? m_cartBanks[i] : (uint8_t)BANK_UNUSED);
+		if (/*bank >= BANK_ROM_00 &&*/ bank <= BANK_ROM_3F) {
+			// ROM bank.
+			// NOTE: m_romData is always a multiple of 512 KB.
+			const uint32_t romAddrStart = (0x80000 * (bank - BANK_ROM_00));
+			if (m_romData && romAddrStart < m_romData_size) {
+				page->rom = reinterpret_cast<const uint8_t*>(m_romData) + romAddrStart;
+				page->size = (m_romData_size - romAddrStart);
+				if (page->size > 0x80000)
+					page->size = 0x80000;
+			}
+		} else if (bank == BANK_MD_REGISTERS_RO) {
+			// Mapper registers.
+			page->slow = true;
+		}
+	}
+
+	// Save data may overlap ROM banks.
+	// NOTE: EmuContext::GetSaveDataEnable() is checked in the
+	// slow path, since it can be changed at any time.
+	if (m_EEPRom.isEEPRomTypeSet()) {
+		// EEPRom read port.
+		m_cartPages[(m_EEPRom.readPortAddress() >> 19) & 0x1F].slow = true;
+	} else if (m_SRam.canRead() && m_SRam.start() <= m_SRam.end()) {
+		// SRam is readable.
+		const uint32_t start = (m_SRam.start() & 0xFFFFFF);
+		const uint32_t end = (m_SRam.end() > 0xFFFFFF ? 0xFFFFFF : m_SRam.end());
+		for (uint32_t i = (start >> 19); i <= (end >> 19); i++) {
+			m_cartPages[i].slow = true;
+		}
+	}
+}
+
 /** ZOMG savestate functions. **/
 
 /**
  * Save the cartridge data, including /TIME, SRAM, and/or EEPROM.
  * @param zomg ZOMG savestate to save to.
  */
-void RomCartridgeMD::zomgSave(LibZomg::Zomg *zomg) const
+void RomCartridgeMD::zomgSave(LibZomg::ZomgBase *zomg) const
 {
 	// Save the MD /TIME registers.
 	Zomg_MD_TimeReg_t md_time_reg_save;
@@ -1439,7 +1404,7 @@ void RomCartridgeMD::zomgSave(LibZomg::Zomg *zomg) const
  * @param zomg ZOMG savestate to restore from.
  * @param loadSaveData If true, load the save data in addition to the state.
  */
-void RomCartridgeMD::zomgRestore(LibZomg::Zomg *zomg, bool loadSaveData)
+void RomCartridgeMD::zomgRestore(LibZomg::ZomgBase *zomg, bool loadSaveData)
 {
 	Zomg_MD_TimeReg_t md_time_reg_save;
 	int ret = zomg->loadMD_TimeReg(&md_time_reg_save);
@@ -1506,6 +1471,9 @@ void RomCartridgeMD::zomgRestore(LibZomg::Zomg *zomg, bool loadSaveData)
 		default:
 			break;
 	}
+
+	// SRAM control and banking may have changed.
+	updateCartPages();
 }
 
 }
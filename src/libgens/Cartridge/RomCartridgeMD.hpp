@@ -35,7 +35,7 @@
 #include "Save/EEPRomI2C.hpp"
 
 namespace LibZomg {
-	class Zomg;
+	class ZomgBase;
 }
 
 namespace LibGens {
@@ -79,6 +79,13 @@ class RomCartridgeMD
 		 */
 		bool isRomLoaded(void) const;
 
+		/**
+		 * Can 68000 idle loop detection be used with this ROM?
+		 * Some games have timing-sensitive polling loops.
+		 * @return True if idle loop detection can be used; false if not.
+		 */
+		bool idleLoopDetect(void) const;
+
 		/**
 		 * Update M68K CPU program access structs for bankswitching purposes.
 		 * @param M68K_Fetch Pointer to first STARSCREAM_PROGRAMREGION to update.
@@ -120,8 +127,8 @@ class RomCartridgeMD
 		int autoSaveData(int framesElapsed);
 
 		/** ZOMG savestate functions. **/
-		void zomgSave(LibZomg::Zomg *zomg) const;
-		void zomgRestore(LibZomg::Zomg *zomg, bool loadSaveData);
+		void zomgSave(LibZomg::ZomgBase *zomg) const;
+		void zomgRestore(LibZomg::ZomgBase *zomg, bool loadSaveData);
 
 	protected:
 		/**
@@ -142,11 +149,9 @@ class RomCartridgeMD
 		int initEEPRom(void);
 
 	private:
-		// ROM access.
-		template<uint8_t bank>
-		inline uint8_t T_readByte_Rom(uint32_t address);
-		template<uint8_t bank>
-		inline uint16_t T_readWord_Rom(uint32_t address);
+		// Slow path for pages that aren't plain ROM.
+		uint8_t readByte_slow(uint32_t address);
+		uint16_t readWord_slow(uint32_t address);
 
 		// MAPPER_MD_REGISTERS_RO
 		inline uint8_t readByte_REGISTERS_RO(uint32_t address);
@@ -159,6 +164,15 @@ class RomCartridgeMD
 		void writeByte(uint32_t address, uint8_t data);
 		void writeWord(uint32_t address, uint16_t data);
 
+		/**
+		 * Get a direct pointer to plain ROM data.
+		 * Used for bulk transfers, e.g. VDP DMA.
+		 * @param address Cartridge address. (must be even)
+		 * @param len Length, in bytes.
+		 * @return Pointer to ROM words in host byte order, or nullptr if the range isn't plain ROM within a single 512 KB bank.
+		 */
+		const uint16_t *romPtr(uint32_t address, uint32_t len) const;
+
 		// /TIME register access functions. ($A130xx)
 		// Only the low byte of the address is needed here.
 		uint8_t readByte_TIME(uint8_t address);
@@ -212,6 +226,24 @@ class RomCartridgeMD
 		// Physical memory map: 20 banks of 512 KB each.
 		uint8_t m_cartBanks[20];
 
+		/**
+		 * Cartridge read page table.
+		 * One page per 512 KB physical bank, indexed by (address >> 19).
+		 * Rebuilt by updateCartPages() whenever banking, SRAM, or
+		 * EEPROM state changes, so ROM reads are a single lookup.
+		 */
+		struct CartPage_t {
+			const uint8_t *rom;	// Host pointer to the ROM bank.
+			uint32_t size;		// Number of valid ROM bytes in this page.
+			bool slow;		// If true, use readByte_slow() / readWord_slow().
+		};
+		CartPage_t m_cartPages[32];
+
+		/**
+		 * Rebuild the cartridge read page table.
+		 */
+		void updateCartPages(void);
+
 		// Checksum types.
 		enum ChecksumType_t {
 			CHKSUM_DISABLED = 0,	// No checksum.
@@ -28,36 +28,89 @@
 #endif
 #include <assert.h>
 
+// C includes. (C++ namespace)
+#include <cstring>
+
 // C++ includes.
+#include <new>
 #include <string>
 using std::string;
 
 #include "lg_osd.h"
 
-// ROM data access.
-// TODO: Move ROM data to a cartridge class?
-// NOTE: Currently only needed for fixChecksum() / restoreChecksum().
-// Maybe fixChecksum() / restoreChecksum() should be moved to EmuMD.
+// Per-context emulation state.
+#include "cpu/M68K.hpp"
 #include "cpu/M68K_Mem.hpp"
+#include "cpu/Z80.hpp"
+#include "cpu/Z80_MD_Mem.hpp"
+#include "sound/SoundMgr.hpp"
+#include "Util/VgmLogger.hpp"
+
+// Aligned memory allocation.
+#include "libcompat/aligned_malloc.h"
 
 namespace LibGens
 {
 
-// Reference counter.
-// We're only allowing one emulation context at the moment.
-int EmuContext::ms_RefCount = 0;
+/**
+ * Per-context emulation state.
+ * Bound to the calling thread by makeCurrent().
+ *
+ * NOTE: Starscream and the mdZ80 assembly core access the
+ * global Ram_68k and Ram_Z80 directly, so the portable CPU
+ * cores are required for contexts to have separate RAM.
+ */
+class EmuContext::State
+{
+	public:
+		State();
 
-// Controller I/O manager.
-// TODO: Make this non-static!
-IoManager *EmuContext::m_ioManager;
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		State(const State &);
+		State &operator=(const State &);
 
-// Static pointer. Temporarily needed for SRam/EEPRom.
-EmuContext *EmuContext::m_instance = nullptr;
+	public:
+		M68K::State m68k;
+		M68K_Mem::State m68kMem;
+		Z80::State z80;
+		Z80_MD_Mem::State z80Mem;
+		SoundMgr::State sound;
+
+#ifdef USE_PORTABLE_M68K
+		Ram_68k_t ram68k;
+#endif
+#ifdef USE_PORTABLE_Z80
+		uint8_t ramZ80[8 * 1024];
+#endif
+};
+
+EmuContext::State::State()
+{
+#ifdef USE_PORTABLE_M68K
+	memset(&ram68k, 0x00, sizeof(ram68k));
+	m68kMem.ram = &ram68k;
+#endif
+#ifdef USE_PORTABLE_Z80
+	memset(ramZ80, 0x00, sizeof(ramZ80));
+	z80Mem.ram = &ramZ80[0];
+#endif
+}
+
+// Number of active contexts.
+// If either assembly CPU core is in use, only one
+// context can be active, since they share RAM.
+int EmuContext::ms_RefCount = 0;
+
+// Context bound to the calling thread.
+THREAD_LOCAL EmuContext *EmuContext::m_instance = nullptr;
 
 /**
  * Global settings.
  */
 bool EmuContext::ms_AutoFixChecksum = false;
+bool EmuContext::ms_IdleLoopDetect = true;
 string EmuContext::ms_PathSRam;
 string EmuContext::ms_TmssRomFilename;
 bool EmuContext::ms_TmssEnabled = false;
@@ -96,18 +149,31 @@ void EmuContext::init(MdFb *fb, Rom *rom, SysVersion::RegionCode_t region)
 	// This may change later on.
 	((void)region);
 
+#if !defined(USE_PORTABLE_M68K) || !defined(USE_PORTABLE_Z80)
+	assert(ms_RefCount == 0);
+#endif
 	ms_RefCount++;
-	assert(ms_RefCount == 1);
-	m_instance = this;
 
 	// Initialize variables.
 	m_rom = rom;
 	m_saveDataEnable = true;	// Enabled by default. (TODO: Config setting.)
+	m_perfEnabled = false;
+
+	// Allocate the emulation state.
+	// NOTE: The sound buffers must be 16-byte aligned.
+	void *mem = aligned_malloc(16, sizeof(State));
+	m_state = new (mem) State();
+
+	// Bind the emulation state to this thread and initialize it.
+	makeCurrent();
+	M68K::Init();
+	M68K_Mem::Init();
+	Z80::Init();
+	Z80_MD_Mem::Init();
+	SoundMgr::Init();
 
 	// Create the Controller I/O manager.
-	// TODO: For now, we'll treat them as static.
-	if (!m_ioManager)
-		m_ioManager = new IoManager();
+	m_ioManager = new IoManager();
 
 	// Initialize the VDP.
 	// TODO: Apply user-specified VDP options.
@@ -116,19 +182,79 @@ void EmuContext::init(MdFb *fb, Rom *rom, SysVersion::RegionCode_t region)
 
 EmuContext::~EmuContext()
 {
-	ms_RefCount--;
-	assert(ms_RefCount == 0);
+	// Shut down the emulation state.
+	makeCurrent();
+	Z80_MD_Mem::End();
+	Z80::End();
+	M68K_Mem::End();
+	M68K::End();
+	SoundMgr::End();
+
+	// Unbind the emulation state.
+	M68K::BindState(nullptr);
+	M68K_Mem::BindState(nullptr);
+	Z80::BindState(nullptr);
+	Z80_MD_Mem::BindState(nullptr);
+	SoundMgr::BindState(nullptr);
 	m_instance = nullptr;
 
-	// TODO: Delete the IoManager?
-	//delete m_ioManager;
-	//m_ioManager = nullptr;
+	m_state->~State();
+	aligned_free(m_state);
+	m_state = nullptr;
+
+	ms_RefCount--;
+
+	// Delete the Controller I/O manager.
+	delete m_ioManager;
+	m_ioManager = nullptr;
 
 	// Delete the VDP.
 	delete m_vdp;
 	m_vdp = nullptr;
 }
 
+/**
+ * Bind this context's emulation state to the calling thread.
+ * The CPU, memory, and sound functions will use this context
+ * until another context is made current on this thread.
+ */
+void EmuContext::makeCurrent(void) const
+{
+	if (m_instance == this)
+		return;
+
+	m_instance = const_cast<EmuContext*>(this);
+	M68K::BindState(&m_state->m68k);
+	M68K_Mem::BindState(&m_state->m68kMem);
+	Z80::BindState(&m_state->z80);
+	Z80_MD_Mem::BindState(&m_state->z80Mem);
+	SoundMgr::BindState(&m_state->sound);
+}
+
+/**
+ * Attach a VGM logger to this context.
+ * The current sound chip registers are logged first,
+ * so the log starts with the correct sound chip state.
+ * NOTE: Detach the logger before closing it.
+ * @param vgmLogger VGM logger, or nullptr to detach.
+ */
+void EmuContext::setVgmLogger(VgmLogger *vgmLogger)
+{
+	SoundMgr::State *const snd = &m_state->sound;
+	if (vgmLogger && vgmLogger != snd->vgmLogger) {
+		vgmLogger->logRegisters(&snd->ym2612, &snd->psg);
+	}
+	snd->vgmLogger = vgmLogger;
+}
+
+/**
+ * Get the VGM logger attached to this context.
+ * @return VGM logger, or nullptr if none.
+ */
+VgmLogger *EmuContext::vgmLogger(void) const
+{
+	return m_state->sound.vgmLogger;
+}
 
 /**
  * Set the SRam/EEPRom save path [static]
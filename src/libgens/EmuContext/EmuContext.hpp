@@ -37,11 +37,20 @@
 // VDP.
 #include "../Vdp/Vdp.hpp"
 
+// Performance counters.
+#include "../Util/PerfCounters.hpp"
+#include "../Util/Timing.hpp"
+
+// THREAD_LOCAL
+#include "../macros/common.h"
+
 // C++ includes.
 #include <string>
 
 namespace LibGens {
 
+class VgmLogger;
+
 class EmuContext
 {
 	public:
@@ -59,9 +68,20 @@ class EmuContext
 		void init(MdFb *fb, Rom *rom, SysVersion::RegionCode_t region);
 
 	public:	
-		// Get the current EmuContext instance.
+		/**
+		 * Get the EmuContext bound to the calling thread.
+		 * @return Current EmuContext, or nullptr if none.
+		 */
 		static EmuContext *Instance(void);
 
+		/**
+		 * Bind this context's emulation state to the calling thread.
+		 * The CPU, memory, and sound functions will use this context
+		 * until another context is made current on this thread.
+		 * This is done automatically by the public EmuContext functions.
+		 */
+		void makeCurrent(void) const;
+
 		/**
 		 * Save SRam/EEPRom.
 		 * @return 1 if SRam was saved; 2 if EEPRom was saved; 0 if nothing was saved. (TODO: Enum?)
@@ -98,13 +118,56 @@ class EmuContext
 		virtual void execFrame(void) = 0;
 		virtual void execFrameFast(void) = 0;
 
+		/**
+		 * Are per-subsystem performance counters enabled?
+		 * @return True if enabled; false if not.
+		 */
+		bool isPerfCountersEnabled(void) const;
+
+		/**
+		 * Enable or disable per-subsystem performance counters.
+		 * When disabled, the frame loop doesn't read the timer at all.
+		 * @param enabled True to enable; false to disable.
+		 */
+		void setPerfCountersEnabled(bool enabled);
+
+		/**
+		 * Get the performance counters for the last frame.
+		 * Only valid if performance counters are enabled.
+		 * NOTE: Only read this between calls to execFrame().
+		 * @return Performance counters.
+		 */
+		const PerfCounters *perfCounters(void) const;
+
+		/**
+		 * Get the rolling performance counter history.
+		 * Used for p50/p99 subsystem times.
+		 * NOTE: Only read this between calls to execFrame().
+		 * @return Performance counter history.
+		 */
+		const PerfHistory *perfHistory(void) const;
+
+		/**
+		 * Attach a VGM logger to this context.
+		 * The current sound chip registers are logged first,
+		 * so the log starts with the correct sound chip state.
+		 * NOTE: Detach the logger before closing it.
+		 * @param vgmLogger VGM logger, or nullptr to detach.
+		 */
+		void setVgmLogger(VgmLogger *vgmLogger);
+
+		/**
+		 * Get the VGM logger attached to this context.
+		 * @return VGM logger, or nullptr if none.
+		 */
+		VgmLogger *vgmLogger(void) const;
+
 		// Accessors.
 		inline bool isRomOpened(void)
 			{ return (m_rom != nullptr); }
 
 		// Controller I/O manager.
-		// TODO: Make this non-static!
-		static IoManager *m_ioManager;
+		IoManager *m_ioManager;
 
 		/**
 		 * Read the system version register. (MD)
@@ -141,6 +204,26 @@ class EmuContext
 		 */
 		virtual int zomgSave(const char *filename) const = 0;
 
+		/**
+		 * Save the current state to an in-memory snapshot.
+		 * Snapshots are uncompressed and have no preview image,
+		 * so they're much faster than ZOMG files. They're stored
+		 * in host byteorder, so don't save them to disk.
+		 * @param buf	[out] Buffer. (If nullptr, only the required size is returned.)
+		 * @param siz	[in] Size of buf.
+		 * @return Snapshot size on success; negative errno on error. (-ENOSPC if buf is too small)
+		 */
+		virtual int saveSnapshot(void *buf, size_t siz) const = 0;
+
+		/**
+		 * Load the current state from an in-memory snapshot.
+		 * Unlike zomgLoad(), this also restores SRAM and EEPROM.
+		 * @param buf	[in] Snapshot.
+		 * @param siz	[in] Size of buf.
+		 * @return 0 on success; negative errno on error.
+		 */
+		virtual int loadSnapshot(const void *buf, size_t siz) = 0;
+
 		/**
 		 * Global settings.
 		 */
@@ -150,6 +233,14 @@ class EmuContext
 		static inline void SetAutoFixChecksum(bool newAutoFixChecksum)
 			{ ms_AutoFixChecksum = newAutoFixChecksum; }
 
+		// 68000 idle loop detection.
+		// Applied when a context is created or hard reset.
+		// May be disabled for specific ROMs by RomCartridgeMD.
+		static inline bool IdleLoopDetect(void)
+			{ return ms_IdleLoopDetect; }
+		static inline void SetIdleLoopDetect(bool newIdleLoopDetect)
+			{ ms_IdleLoopDetect = newIdleLoopDetect; }
+
 		/**
 		 * Pathnames.
 		 */
@@ -179,23 +270,46 @@ class EmuContext
 		Rom *m_rom;
 		bool m_saveDataEnable;
 
+		// Performance counters.
+		bool m_perfEnabled;
+		PerfCounters m_perf;
+		PerfHistory m_perfHistory;
+
+		/**
+		 * Add the time elapsed since the last lap to a performance counter.
+		 * @param subsystem Subsystem to charge.
+		 * @param lap [in/out] Timestamp of the last lap. Updated to the current time.
+		 */
+		inline void perfLap(PerfCounters::Subsystem subsystem, uint64_t &lap)
+		{
+			const uint64_t now = Timing::GetTimestampNs();
+			m_perf.ns[subsystem] += (now - lap);
+			lap = now;
+		}
+
 		/**
 		 * System version register.
 		 */
 		SysVersion m_sysVersion;
 
-		// Static pointer. Temporarily needed for SRam/EEPRom.
-		static EmuContext *m_instance;
+		// Context bound to the calling thread.
+		static THREAD_LOCAL EmuContext *m_instance;
 
 		/**
 		 * Global settings.
 		 */
 		static bool ms_AutoFixChecksum;
+		static bool ms_IdleLoopDetect;
 		static std::string ms_PathSRam;
 		static std::string ms_TmssRomFilename;
 		static bool ms_TmssEnabled;
 
 	private:
+		// Per-context emulation state.
+		class State;
+		State *m_state;
+
+		// Number of active contexts.
 		static int ms_RefCount;
 };
 
@@ -217,6 +331,38 @@ inline uint8_t EmuContext::readVersionRegister_MD(void) const
 inline const SysVersion *EmuContext::versionRegisterObject(void) const
 	{ return &m_sysVersion; }
 
+/**
+ * Are per-subsystem performance counters enabled?
+ * @return True if enabled; false if not.
+ */
+inline bool EmuContext::isPerfCountersEnabled(void) const
+	{ return m_perfEnabled; }
+
+/**
+ * Enable or disable per-subsystem performance counters.
+ * @param enabled True to enable; false to disable.
+ */
+inline void EmuContext::setPerfCountersEnabled(bool enabled)
+{
+	m_perfEnabled = enabled;
+	m_perf.clear();
+	m_perfHistory.clear();
+}
+
+/**
+ * Get the performance counters for the last frame.
+ * @return Performance counters.
+ */
+inline const PerfCounters *EmuContext::perfCounters(void) const
+	{ return &m_perf; }
+
+/**
+ * Get the rolling performance counter history.
+ * @return Performance counter history.
+ */
+inline const PerfHistory *EmuContext::perfHistory(void) const
+	{ return &m_perfHistory; }
+
 inline bool EmuContext::saveDataEnable(void)
 	{ return m_saveDataEnable; }
 inline void EmuContext::setSaveDataEnable(bool newSaveDataEnable)
@@ -32,6 +32,7 @@
 
 // Sound Manager.
 #include "sound/SoundMgr.hpp"
+#include "Util/VgmLogger.hpp"
 
 // LibGens OSD handler.
 #include "lg_osd.h"
@@ -74,20 +75,20 @@ EmuMD::EmuMD(Rom *rom, SysVersion::RegionCode_t region )
 	}
 
 	// Load the ROM into memory.
-	M68K_Mem::ms_RomCartridge = new RomCartridgeMD(rom);
-	M68K_Mem::ms_RomCartridge->loadRom();
-	if (!M68K_Mem::ms_RomCartridge->isRomLoaded()) {
+	M68K_Mem::ms_State->romCartridge = new RomCartridgeMD(rom);
+	M68K_Mem::ms_State->romCartridge->loadRom();
+	if (!M68K_Mem::ms_State->romCartridge->isRomLoaded()) {
 		// Error loading the ROM.
 		// TODO: Set an error code.
-		delete M68K_Mem::ms_RomCartridge;
-		M68K_Mem::ms_RomCartridge = nullptr;
+		delete M68K_Mem::ms_State->romCartridge;
+		M68K_Mem::ms_State->romCartridge = nullptr;
 		m_rom = nullptr;
 		return;
 	}
 
 	// Autofix the ROM checksum, if enabled.
 	if (AutoFixChecksum())
-		M68K_Mem::ms_RomCartridge->fixChecksum();
+		M68K_Mem::ms_State->romCartridge->fixChecksum();
 
 	// Initialize TMSS.
 	// NOTE: This must be done *before* calling InitSys(), since
@@ -96,10 +97,12 @@ EmuMD::EmuMD(Rom *rom, SysVersion::RegionCode_t region )
 
 	// Initialize the M68K.
 	M68K::InitSys(M68K::SYSID_MD);
+	M68K::SetIdleLoopDetect(IdleLoopDetect() &&
+		M68K_Mem::ms_State->romCartridge->idleLoopDetect());
 
 	// Reinitialize the Z80.
 	// Z80's initial state is RESET.
-	M68K_Mem::Z80_State = (Z80_STATE_ENABLED | Z80_STATE_RESET);	// TODO: "Sound, Z80" setting.
+	M68K_Mem::ms_State->Z80_State = (Z80_STATE_ENABLED | Z80_STATE_RESET);	// TODO: "Sound, Z80" setting.
 	Z80::ReInit();
 
 	// Initialize the system status.
@@ -107,7 +110,7 @@ EmuMD::EmuMD(Rom *rom, SysVersion::RegionCode_t region )
 	m_vdp->SysStatus.data = 0;
 	m_vdp->SysStatus.Genesis = 1;
 	// If TMSS is disabled, initialize the VDP registers.
-	if (!M68K_Mem::tmss_reg.isTmssEnabled()) {
+	if (!M68K_Mem::ms_State->tmss_reg.isTmssEnabled()) {
 		m_vdp->doFakeBootRomInit();
 	}
 
@@ -124,12 +127,15 @@ EmuMD::EmuMD(Rom *rom, SysVersion::RegionCode_t region )
 
 EmuMD::~EmuMD()
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: Other stuff?
 	M68K::EndSys();
 
 	// Delete the RomCartridgeMD.
-	delete M68K_Mem::ms_RomCartridge;
-	M68K_Mem::ms_RomCartridge = nullptr;
+	delete M68K_Mem::ms_State->romCartridge;
+	M68K_Mem::ms_State->romCartridge = nullptr;
 }
 
 /**
@@ -138,22 +144,25 @@ EmuMD::~EmuMD()
  */
 int EmuMD::softReset(void)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// ROM checksum:
 	// - If autofix is enabled, fix the checksum.
 	// - If autofix is disabled, restore the checksum.
 	if (AutoFixChecksum())
-		M68K_Mem::ms_RomCartridge->fixChecksum();
+		M68K_Mem::ms_State->romCartridge->fixChecksum();
 	else
-		M68K_Mem::ms_RomCartridge->restoreChecksum();
+		M68K_Mem::ms_State->romCartridge->restoreChecksum();
 
 	// Reset the M68K, Z80, and YM2612.
 	M68K::Reset();
 	Z80::SoftReset();
-	SoundMgr::ms_Ym2612.reset();
+	SoundMgr::ms_State->ym2612.reset();
 
 	// Z80 state should be reset to the default value.
 	// Z80's initial state is RESET.
-	M68K_Mem::Z80_State = (Z80_STATE_ENABLED | Z80_STATE_RESET);	// TODO: "Sound, Z80" setting.
+	M68K_Mem::ms_State->Z80_State = (Z80_STATE_ENABLED | Z80_STATE_RESET);	// TODO: "Sound, Z80" setting.
 
 	// TODO: Genesis Plus randomizes the restart line.
 	// See genesis.c:176.
@@ -166,6 +175,9 @@ int EmuMD::softReset(void)
  */
 int EmuMD::hardReset(void)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// Re-initialize TMSS.
 	// NOTE: This must be done *before* calling InitSys(), since
 	// Starscream initializes the internal program counter on reset.
@@ -178,21 +190,23 @@ int EmuMD::hardReset(void)
 	// - If autofix is enabled, fix the checksum.
 	// - If autofix is disabled, restore the checksum.
 	if (AutoFixChecksum())
-		M68K_Mem::ms_RomCartridge->fixChecksum();
+		M68K_Mem::ms_State->romCartridge->fixChecksum();
 	else
-		M68K_Mem::ms_RomCartridge->restoreChecksum();
+		M68K_Mem::ms_State->romCartridge->restoreChecksum();
 
 	// Hard-Reset the M68K, Z80, VDP, PSG, and YM2612.
 	// This includes clearing RAM.
 	M68K::InitSys(M68K::SYSID_MD);
+	M68K::SetIdleLoopDetect(IdleLoopDetect() &&
+		M68K_Mem::ms_State->romCartridge->idleLoopDetect());
 	Z80::ReInit();
-	SoundMgr::ms_Psg.reset();
-	SoundMgr::ms_Ym2612.reset();
+	SoundMgr::ms_State->psg.reset();
+	SoundMgr::ms_State->ym2612.reset();
 
 	// Reset the VDP.
 	m_vdp->reset();
 	// If TMSS is disabled, initialize the VDP registers.
-	if (!M68K_Mem::tmss_reg.isTmssEnabled()) {
+	if (!M68K_Mem::ms_State->tmss_reg.isTmssEnabled()) {
 		m_vdp->doFakeBootRomInit();
 	}
 	// Make sure the VDP's video mode bit is set properly.
@@ -232,6 +246,9 @@ static inline int Round_Double(double val)
  */
 int EmuMD::setRegion_int(SysVersion::RegionCode_t region, bool preserveState)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	SysVersion newRegion(region);
 	if (preserveState && (m_sysVersion.isPal() == newRegion.isPal())) {
 		// preserveState was specified, and the current NTSC/PAL setting
@@ -257,11 +274,11 @@ int EmuMD::setRegion_int(SysVersion::RegionCode_t region, bool preserveState)
 	 * [Round_Double() rounds 0.5 to 0 and 1.5 to 1.] */
 	// TODO: Jorge says CPL is always 3420 master clock cycles...
 	if (m_sysVersion.isPal()) {
-		M68K_Mem::CPL_M68K = Round_Double((((double)CLOCK_PAL / 7.0) / 50.0) / 312.0);
-		M68K_Mem::CPL_Z80 = Round_Double((((double)CLOCK_PAL / 15.0) / 50.0) / 312.0);
+		M68K_Mem::ms_State->CPL_M68K = Round_Double((((double)CLOCK_PAL / 7.0) / 50.0) / 312.0);
+		M68K_Mem::ms_State->CPL_Z80 = Round_Double((((double)CLOCK_PAL / 15.0) / 50.0) / 312.0);
 	} else {
-		M68K_Mem::CPL_M68K = Round_Double((((double)CLOCK_NTSC / 7.0) / 60.0) / 262.0);
-		M68K_Mem::CPL_Z80 = Round_Double((((double)CLOCK_NTSC / 15.0) / 60.0) / 262.0);
+		M68K_Mem::ms_State->CPL_M68K = Round_Double((((double)CLOCK_NTSC / 7.0) / 60.0) / 262.0);
+		M68K_Mem::ms_State->CPL_Z80 = Round_Double((((double)CLOCK_NTSC / 15.0) / 60.0) / 262.0);
 	}
 
 	// Initialize audio.
@@ -278,9 +295,12 @@ int EmuMD::setRegion_int(SysVersion::RegionCode_t region, bool preserveState)
  */
 int EmuMD::saveData(void)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: Call lg_osd here instead of in RomCartridgeMD().
-	if (M68K_Mem::ms_RomCartridge)
-		return M68K_Mem::ms_RomCartridge->saveData();
+	if (M68K_Mem::ms_State->romCartridge)
+		return M68K_Mem::ms_State->romCartridge->saveData();
 
 	// Nothing was saved.
 	return 0;
@@ -293,9 +313,12 @@ int EmuMD::saveData(void)
  */
 int EmuMD::autoSaveData(int framesElapsed)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: Call lg_osd here instead of in RomCartridgeMD().
-	if (M68K_Mem::ms_RomCartridge)
-		return M68K_Mem::ms_RomCartridge->autoSaveData(framesElapsed);
+	if (M68K_Mem::ms_State->romCartridge)
+		return M68K_Mem::ms_State->romCartridge->autoSaveData(framesElapsed);
 
 	// Nothing was saved.
 	return 0;
@@ -311,7 +334,7 @@ void EmuMD::initTmss(void)
 	// TODO: Update TMSS settings when loading a savestate?
 	// TODO: Save TMSS settings to the savestate.
 	m_sysVersion.setVersion(0);
-	if (!M68K_Mem::tmss_reg.loadTmssRom()) {
+	if (!M68K_Mem::ms_State->tmss_reg.loadTmssRom()) {
 		// TMSS ROM initialized.
 		m_sysVersion.setVersion(1);
 	}
@@ -324,38 +347,59 @@ void EmuMD::initTmss(void)
  * Run a scanline.
  * @param LineType Line type.
  * @param VDP If true, VDP is updated.
+ * @param Perf If true, performance counters are updated.
  */
-template<EmuMD::LineType_t LineType, bool VDP>
+template<EmuMD::LineType_t LineType, bool VDP, bool Perf>
 FORCE_INLINE void EmuMD::T_execLine(void)
 {
+	uint64_t lap = 0;
+	if (Perf)
+		lap = Timing::GetTimestampNs();
+
 	int writePos = SoundMgr::GetWritePos(m_vdp->VDP_Lines.currentLine);
-	int32_t *bufL = &SoundMgr::ms_SegBufL[writePos];
-	int32_t *bufR = &SoundMgr::ms_SegBufR[writePos];
+	int32_t *bufL = &SoundMgr::ms_State->segBufL[writePos];
+	int32_t *bufR = &SoundMgr::ms_State->segBufR[writePos];
 
 	// Update the sound chips.
 	int writeLen = SoundMgr::GetWriteLen(m_vdp->VDP_Lines.currentLine);
-	SoundMgr::ms_Ym2612.updateDacAndTimers(bufL, bufR, writeLen);
-	SoundMgr::ms_Ym2612.addWriteLen(writeLen);
-	SoundMgr::ms_Psg.addWriteLen(writeLen);
+	SoundMgr::ms_State->ym2612.updateDacAndTimers(bufL, bufR, writeLen);
+	SoundMgr::ms_State->ym2612.addWriteLen(writeLen);
+	SoundMgr::ms_State->psg.addWriteLen(writeLen);
+	if (Perf)
+		perfLap(PerfCounters::PERF_YM2612, lap);
 
 	// Notify controllers that a new scanline is being drawn.
 	m_ioManager->doScanline();
+	if (Perf)
+		perfLap(PerfCounters::PERF_IO, lap);
 
 	// Increment the cycles counter.
 	// These values are the "last cycle to execute".
 	// e.g. if Cycles_M68K is 5000, then we'll execute instructions
 	// until the 68000's "odometer" reaches 5000.
-	M68K_Mem::Cycles_M68K += M68K_Mem::CPL_M68K;
-	M68K_Mem::Cycles_Z80 += M68K_Mem::CPL_Z80;
-
-	if (m_vdp->DMAT_Length)
-		M68K::AddCycles(m_vdp->updateDMA());
+	M68K_Mem::ms_State->Cycles_M68K += M68K_Mem::ms_State->CPL_M68K;
+	M68K_Mem::ms_State->Cycles_Z80 += M68K_Mem::ms_State->CPL_Z80;
+
+	if (m_vdp->DMAT_Length) {
+		if (Perf)
+			lap = Timing::GetTimestampNs();
+		const unsigned int dmaCycles = m_vdp->updateDMA();
+		M68K::AddCycles(dmaCycles);
+		if (Perf) {
+			perfLap(PerfCounters::PERF_VDP_DMA, lap);
+			m_perf.cycles_dma += dmaCycles;
+		}
+	}
 
 	switch (LineType) {
 		case LINETYPE_ACTIVEDISPLAY:
 			// In visible area.
 			m_vdp->setStatusBit(VdpStatus::VDP_STATUS_HBLANK, true);	// HBlank = 1
-			M68K::Exec(M68K_Mem::Cycles_M68K - 404);
+			if (Perf)
+				lap = Timing::GetTimestampNs();
+			M68K::Exec(M68K_Mem::ms_State->Cycles_M68K - 404);
+			if (Perf)
+				perfLap(PerfCounters::PERF_M68K, lap);
 			m_vdp->setStatusBit(VdpStatus::VDP_STATUS_HBLANK, false);	// HBlank = 0
 
 			// Decrement the HInt counter.
@@ -383,8 +427,14 @@ FORCE_INLINE void EmuMD::T_execLine(void)
 			if (m_vdp->VDP_Lines.NTSC_V30.VBlank_Div != 0)
 				m_vdp->setStatusBit(VdpStatus::VDP_STATUS_VBLANK, false);
 
-			M68K::Exec(M68K_Mem::Cycles_M68K - 360);
+			if (Perf)
+				lap = Timing::GetTimestampNs();
+			M68K::Exec(M68K_Mem::ms_State->Cycles_M68K - 360);
+			if (Perf)
+				perfLap(PerfCounters::PERF_M68K, lap);
 			Z80::Exec(168);
+			if (Perf)
+				perfLap(PerfCounters::PERF_Z80, lap);
 #if 0
 			// TODO: Congratulations! (LibGens)
 			CONGRATULATIONS_POSTCHECK();
@@ -409,22 +459,37 @@ FORCE_INLINE void EmuMD::T_execLine(void)
 			break;
 	}
 
+	if (Perf)
+		lap = Timing::GetTimestampNs();
 	if (VDP) {
 		// VDP needs to be updated.
 		m_vdp->renderLine();
+		if (Perf)
+			perfLap(PerfCounters::PERF_VDP_RENDER, lap);
 	}
 
-	M68K::Exec(M68K_Mem::Cycles_M68K);
+	M68K::Exec(M68K_Mem::ms_State->Cycles_M68K);
+	if (Perf)
+		perfLap(PerfCounters::PERF_M68K, lap);
 	Z80::Exec(0);
+	if (Perf)
+		perfLap(PerfCounters::PERF_Z80, lap);
 }
 
 /**
  * T_execFrame(): Run a frame.
  * @param VDP If true, VDP is updated.
+ * @param Perf If true, performance counters are updated.
  */
-template<bool VDP>
+template<bool VDP, bool Perf>
 FORCE_INLINE void EmuMD::T_execFrame(void)
 {
+	uint64_t frame_start = 0;
+	if (Perf) {
+		m_perf.clear();
+		frame_start = Timing::GetTimestampNs();
+	}
+
 	// Initialize Vdp::VDP_Lines.
 	// Reset the current VDP line variables for the new frame.
 	m_vdp->updateVdpLines(true);
@@ -439,9 +504,9 @@ FORCE_INLINE void EmuMD::T_execFrame(void)
 	SoundMgr::ResetPtrsAndLens();
 
 	// Clear all of the cycle counters.
-	M68K_Mem::Cycles_M68K = 0;
-	M68K_Mem::Cycles_Z80 = 0;
-	M68K_Mem::Last_BUS_REQ_Cnt = -1000;
+	M68K_Mem::ms_State->Cycles_M68K = 0;
+	M68K_Mem::ms_State->Cycles_Z80 = 0;
+	M68K_Mem::ms_State->Last_BUS_REQ_Cnt = -1000;
 	M68K::TripOdometer();
 	Z80::ClearOdometer();
 
@@ -467,30 +532,45 @@ FORCE_INLINE void EmuMD::T_execFrame(void)
 
 	/** Loop 1: Active display. **/
 	do {
-		T_execLine<LINETYPE_ACTIVEDISPLAY, VDP>();
+		T_execLine<LINETYPE_ACTIVEDISPLAY, VDP, Perf>();
 
 		// Next line.
 		m_vdp->VDP_Lines.currentLine++;
 	} while (m_vdp->VDP_Lines.currentLine < m_vdp->VDP_Lines.totalVisibleLines);
 
 	/** Loop 2: VBlank line. **/
-	T_execLine<LINETYPE_VBLANKLINE, VDP>();
+	T_execLine<LINETYPE_VBLANKLINE, VDP, Perf>();
 	m_vdp->VDP_Lines.currentLine++;
 
 	/** Loop 3: Borders. **/
 	do {
-		T_execLine<LINETYPE_BORDER, VDP>();
+		T_execLine<LINETYPE_BORDER, VDP, Perf>();
 
 		// Next line.
 		m_vdp->VDP_Lines.currentLine++;
 	} while (m_vdp->VDP_Lines.currentLine < m_vdp->VDP_Lines.totalDisplayLines);
 
 	// Update the PSG and YM2612 output.
+	uint64_t lap = 0;
+	if (Perf)
+		lap = Timing::GetTimestampNs();
 	SoundMgr::SpecialUpdate();
+	if (Perf) {
+		perfLap(PerfCounters::PERF_SOUND_UPDATE, lap);
+		m_perf.frame_ns = (lap - frame_start);
+		m_perf.cycles_m68k = M68K::ReadOdometer();
+		m_perf.cycles_z80 = Z80::ReadOdometer();
+		m_perfHistory.push(m_perf);
+	}
+
+	// If VGM is being logged, end the VGM frame.
+	VgmLogger *const vgmLogger = SoundMgr::ms_State->vgmLogger;
+	if (vgmLogger) {
+		vgmLogger->endFrame(M68K_Mem::ms_State->Cycles_M68K);
+	}
 
 #if 0
 	// If WAV or GYM is being dumped, update the WAV or GYM.
-	// TODO: VGM dumping
 	if (WAV_Dumping)
 		wav_dump_update();
 	if (GYM_Dumping)
@@ -521,12 +601,20 @@ FORCE_INLINE void EmuMD::T_execFrame(void)
 
 void EmuMD::execFrame(void)
 {
-	T_execFrame<true>();
+	makeCurrent();
+	if (m_perfEnabled)
+		T_execFrame<true, true>();
+	else
+		T_execFrame<true, false>();
 }
 
 void EmuMD::execFrameFast(void)
 {
-	T_execFrame<false>();
+	makeCurrent();
+	if (m_perfEnabled)
+		T_execFrame<false, true>();
+	else
+		T_execFrame<false, false>();
 }
 
 }
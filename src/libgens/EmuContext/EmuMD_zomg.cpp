@@ -39,6 +39,7 @@
 
 // ZOMG save structs.
 #include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgSnapshot.hpp"
 #include "libzomg/Metadata.hpp"
 #include "libzomg/zomg_vdp.h"
 #include "libzomg/zomg_psg.h"
@@ -86,6 +87,9 @@ namespace LibGens {
  */
 int EmuMD::zomgLoad(const char *filename)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// Make sure the file exists.
 	if (access(filename, F_OK))
 		return -ENOENT;
@@ -104,53 +108,88 @@ int EmuMD::zomgLoad(const char *filename)
 	if (!zomg.isOpen())
 		return -EIO;
 
+	// Decompress the large files in parallel.
+	// SRAM isn't loaded, so it doesn't need to be prefetched.
+	zomg.prefetch(false);
+
+	// Load the emulation state.
+	// TODO: Make the 'loadSaveData' parameter user-configurable.
+	int ret = zomgRestoreState(&zomg, false);
+
+	// Close the savestate.
+	zomg.close();
+	return ret;
+}
+
+/**
+ * Restore the emulation state from a ZOMG object.
+ * This is used for both ZOMG files and in-memory snapshots.
+ * NOTE: makeCurrent() must be called first.
+ * @param zomg		[in] ZOMG object.
+ * @param loadSaveData	[in] If true, load SRAM/EEPROM data.
+ * @return 0 on success; negative errno on error.
+ */
+int EmuMD::zomgRestoreState(LibZomg::ZomgBase *zomg, bool loadSaveData)
+{
 	// TODO: Check error codes from the ZOMG functions.
 	// TODO: Load everything first, *then* copy it to LibGens.
 
 	/** VDP **/
-	m_vdp->zomgRestoreMD(&zomg);
+	m_vdp->zomgRestoreMD(zomg);
 
 	/** Audio **/
 
 	// Load the PSG state.
-	Zomg_PsgSave_t psg_save;
-	zomg.loadPsgReg(&psg_save);
-	SoundMgr::ms_Psg.zomgRestore(&psg_save);
+	// Snapshots have the complete internal state, including
+	// the tone counters. Otherwise, restore the registers.
+	Psg *const psg = &SoundMgr::ms_State->psg;
+	if (psg->zomgRestoreInternal(zomg) != 0) {
+		Zomg_PsgSave_t psg_save;
+		zomg->loadPsgReg(&psg_save);
+		psg->zomgRestore(&psg_save);
+	}
 
 	/** Audio: MD-specific **/
 
-	// Load the YM2612 register state.
-	Zomg_Ym2612Save_t ym2612_save;
-	zomg.loadMD_YM2612_reg(&ym2612_save);
-	SoundMgr::ms_Ym2612.zomgRestore(&ym2612_save);
+	// Load the YM2612 state.
+	// Snapshots have the complete internal state, including
+	// timers and envelopes. Otherwise, restore the registers,
+	// which resets the YM2612.
+	Ym2612 *const ym2612 = &SoundMgr::ms_State->ym2612;
+	if (ym2612->zomgRestoreInternal(zomg) != 0) {
+		Zomg_Ym2612Save_t ym2612_save;
+		zomg->loadMD_YM2612_reg(&ym2612_save);
+		ym2612->zomgRestore(&ym2612_save);
+	}
 
 	/** Z80 **/
 
 	// Load the Z80 memory.
 	// TODO: Use the correct size based on system.
-	zomg.loadZ80Mem(Ram_Z80, 8192);
+	zomg->loadZ80Mem(Z80_MD_Mem::ms_State->ram, 8192);
 
 	// Load the Z80 registers.
 	Zomg_Z80RegSave_t z80_reg_save;
-	zomg.loadZ80Reg(&z80_reg_save);
+	zomg->loadZ80Reg(&z80_reg_save);
 	Z80::ZomgRestoreReg(&z80_reg_save);
 
 	/** MD: M68K **/
 
 	// Load the M68K memory.
-	zomg.loadM68KMem(Ram_68k.u16, sizeof(Ram_68k.u16), ZOMG_BYTEORDER_16H);
+	zomg->loadM68KMem(M68K_Mem::ms_State->ram->u16, sizeof(M68K_Mem::ms_State->ram->u16), ZOMG_BYTEORDER_16H);
 
 	// Load the M68K registers.
 	Zomg_M68KRegSave_t m68k_reg_save;
-	zomg.loadM68KReg(&m68k_reg_save);
+	zomg->loadM68KReg(&m68k_reg_save);
 	M68K::ZomgRestoreReg(&m68k_reg_save);
+	M68K::ZomgRestoreInternal(zomg);
 
 	/** MD: Other **/
 
 	// Load the I/O registers. ($A10001-$A1001F, odd bytes)
 	// TODO: Create/use the version register function in M68K_Mem.cpp.
 	Zomg_MD_IoSave_t md_io_save;
-	zomg.loadMD_IO(&md_io_save);
+	zomg->loadMD_IO(&md_io_save);
 	m_ioManager->zomgRestoreMD(&md_io_save);
 
 	// TODO: Set MD version register.
@@ -159,48 +198,44 @@ int EmuMD::zomgLoad(const char *filename)
 
 	// Load the Z80 control registers.
 	Zomg_MD_Z80CtrlSave_t md_z80_ctrl_save;
-	zomg.loadMD_Z80Ctrl(&md_z80_ctrl_save);
+	zomg->loadMD_Z80Ctrl(&md_z80_ctrl_save);
 
-	M68K_Mem::Z80_State &= Z80_STATE_ENABLED;
+	M68K_Mem::ms_State->Z80_State &= Z80_STATE_ENABLED;
 	if (!md_z80_ctrl_save.busreq)
-		M68K_Mem::Z80_State |= Z80_STATE_BUSREQ;
+		M68K_Mem::ms_State->Z80_State |= Z80_STATE_BUSREQ;
 	if (!md_z80_ctrl_save.reset)
-		M68K_Mem::Z80_State |= Z80_STATE_RESET;
-	Z80_MD_Mem::Bank_Z80 = ((md_z80_ctrl_save.m68k_bank & 0x1FF) << 15);
+		M68K_Mem::ms_State->Z80_State |= Z80_STATE_RESET;
+	Z80_MD_Mem::ms_State->Bank_Z80 = ((md_z80_ctrl_save.m68k_bank & 0x1FF) << 15);
 
 	// Load the cartridge data.
 	// This includes:
 	// - MD /TIME registers. (SRAM control, etc.)
 	// - SRAM data.
 	// - EEPROM control and data.
-	// TODO: Make the 'loadSaveData' parameter user-configurable.
-	M68K_Mem::ms_RomCartridge->zomgRestore(&zomg, false);
+	M68K_Mem::ms_State->romCartridge->zomgRestore(zomg, loadSaveData);
 
 	// TODO: Does this need to be loaded before
 	// M68K registers are restored?
-	if (M68K_Mem::tmss_reg.isTmssEnabled()) {
+	if (M68K_Mem::ms_State->tmss_reg.isTmssEnabled()) {
 		// TMSS is enabled.
 		// Load the MD TMSS registers.
 		Zomg_MD_TMSS_reg_t tmss;
-		int ret = zomg.loadMD_TMSS_reg(&tmss);
+		int ret = zomg->loadMD_TMSS_reg(&tmss);
 		if (ret <= 0) {
 			// This savestate doesn't have the TMSS registers.
 			// Assume TMSS is set up properly.
-			M68K_Mem::tmss_reg.a14000.d = 0x53454741; // 'SEGA'
-			M68K_Mem::tmss_reg.n_cart_ce = 1;
+			M68K_Mem::ms_State->tmss_reg.a14000.d = 0x53454741; // 'SEGA'
+			M68K_Mem::ms_State->tmss_reg.n_cart_ce = 1;
 		} else {
 			// Loaded the TMSS registers.
 			// TODO: Wordswapping.
-			M68K_Mem::tmss_reg.a14000.d = tmss.a14000;
-			M68K_Mem::tmss_reg.n_cart_ce = (tmss.n_cart_ce & 1);
+			M68K_Mem::ms_State->tmss_reg.a14000.d = tmss.a14000;
+			M68K_Mem::ms_State->tmss_reg.n_cart_ce = (tmss.n_cart_ce & 1);
 		}
 		// TODO: Only if cart_ce has changed?
 		M68K_Mem::UpdateTmssMapping();
 	}
 
-	// Close the savestate.
-	zomg.close();
-
 	// Savestate loaded.
 	return 0;
 }
@@ -213,6 +248,9 @@ int EmuMD::zomgLoad(const char *filename)
  */
 int EmuMD::zomgSave(const char *filename) const
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: More comprehensive error reporting.
 	LibZomg::Zomg zomg(filename, LibZomg::Zomg::ZOMG_SAVE);
 	if (!zomg.isOpen())
@@ -250,47 +288,65 @@ int EmuMD::zomgSave(const char *filename) const
 	Screenshot::toZomg(&zomg, fb, m_rom);
 	fb->unref();
 
-	// TODO: This is MD only!
+	// Save the emulation state.
+	ret = zomgSaveState(&zomg);
+
+	// Close the savestate.
+	zomg.close();
+	return ret;
+}
+
+/**
+ * Save the emulation state to a ZOMG object.
+ * This is used for both ZOMG files and in-memory snapshots.
+ * NOTE: makeCurrent() must be called first.
+ * @param zomg		[in] ZOMG object.
+ * @return 0 on success; negative errno on error.
+ */
+int EmuMD::zomgSaveState(LibZomg::ZomgBase *zomg) const
+{
 	// TODO: Check error codes from the ZOMG functions.
-	// TODO: Load everything first, *then* copy it to LibGens.
-	
+
 	/** VDP **/
-	m_vdp->zomgSaveMD(&zomg);
+	m_vdp->zomgSaveMD(zomg);
 	
 	/** Audio **/
 	
 	// Save the PSG state.
 	Zomg_PsgSave_t psg_save;
-	SoundMgr::ms_Psg.zomgSave(&psg_save);
-	zomg.savePsgReg(&psg_save);
+	SoundMgr::ms_State->psg.zomgSave(&psg_save);
+	zomg->savePsgReg(&psg_save);
+	SoundMgr::ms_State->psg.zomgSaveInternal(zomg);
 	
 	/** Audio: MD-specific **/
 	
 	// Save the YM2612 register state.
 	Zomg_Ym2612Save_t ym2612_save;
-	SoundMgr::ms_Ym2612.zomgSave(&ym2612_save);
-	zomg.saveMD_YM2612_reg(&ym2612_save);
+	SoundMgr::ms_State->ym2612.zomgSave(&ym2612_save);
+	zomg->saveMD_YM2612_reg(&ym2612_save);
+	SoundMgr::ms_State->ym2612.zomgSaveInternal(zomg);
 	
 	/** Z80 **/
 	
 	// Save the Z80 memory.
 	// TODO: Use the correct size based on system.
-	zomg.saveZ80Mem(Ram_Z80, 8192);
+	zomg->saveZ80Mem(Z80_MD_Mem::ms_State->ram, 8192);
 	
 	// Save the Z80 registers.
 	Zomg_Z80RegSave_t z80_reg_save;
 	Z80::ZomgSaveReg(&z80_reg_save);
-	zomg.saveZ80Reg(&z80_reg_save);
+	zomg->saveZ80Reg(&z80_reg_save);
 	
 	/** MD: M68K **/
 	
 	// Save the M68K memory.
-	zomg.saveM68KMem(Ram_68k.u16, sizeof(Ram_68k.u16), ZOMG_BYTEORDER_16H);
+	zomg->saveM68KMem(M68K_Mem::ms_State->ram->u16, sizeof(M68K_Mem::ms_State->ram->u16), ZOMG_BYTEORDER_16H);
 	
 	// Save the M68K registers.
 	Zomg_M68KRegSave_t m68k_reg_save;
 	M68K::ZomgSaveReg(&m68k_reg_save);
-	zomg.saveM68KReg(&m68k_reg_save);
+	zomg->saveM68KReg(&m68k_reg_save);
+	M68K::ZomgSaveInternal(zomg);
 	
 	/** MD: Other **/
 	
@@ -299,40 +355,82 @@ int EmuMD::zomgSave(const char *filename) const
 	Zomg_MD_IoSave_t md_io_save;
 	m_ioManager->zomgSaveMD(&md_io_save);
 	md_io_save.version_reg = readVersionRegister_MD();
-	zomg.saveMD_IO(&md_io_save);
+	zomg->saveMD_IO(&md_io_save);
 
 	// Save the Z80 control registers.
 	Zomg_MD_Z80CtrlSave_t md_z80_ctrl_save;
-	md_z80_ctrl_save.busreq    = !(M68K_Mem::Z80_State & Z80_STATE_BUSREQ);
-	md_z80_ctrl_save.reset     = !(M68K_Mem::Z80_State & Z80_STATE_RESET);
-	md_z80_ctrl_save.m68k_bank = ((Z80_MD_Mem::Bank_Z80 >> 15) & 0x1FF);
-	zomg.saveMD_Z80Ctrl(&md_z80_ctrl_save);
+	md_z80_ctrl_save.busreq    = !(M68K_Mem::ms_State->Z80_State & Z80_STATE_BUSREQ);
+	md_z80_ctrl_save.reset     = !(M68K_Mem::ms_State->Z80_State & Z80_STATE_RESET);
+	md_z80_ctrl_save.m68k_bank = ((Z80_MD_Mem::ms_State->Bank_Z80 >> 15) & 0x1FF);
+	zomg->saveMD_Z80Ctrl(&md_z80_ctrl_save);
 	
 	// Save the cartridge data.
 	// This includes:
 	// - MD /TIME registers. (SRAM control, etc.)
 	// - SRAM data.
 	// - EEPROM control and data.
-	M68K_Mem::ms_RomCartridge->zomgSave(&zomg);
+	M68K_Mem::ms_State->romCartridge->zomgSave(zomg);
 
-	if (M68K_Mem::tmss_reg.isTmssEnabled()) {
+	if (M68K_Mem::ms_State->tmss_reg.isTmssEnabled()) {
 		// TMSS is enabled.
 		// Save the MD TMSS registers.
 		Zomg_MD_TMSS_reg_t tmss;
 		// TODO: Wordswapping.
 		tmss.header = ZOMG_MD_TMSS_REG_HEADER;
-		tmss.a14000 = M68K_Mem::tmss_reg.a14000.d;
-		tmss.n_cart_ce = M68K_Mem::tmss_reg.n_cart_ce & 1;
-		zomg.saveMD_TMSS_reg(&tmss);
+		tmss.a14000 = M68K_Mem::ms_State->tmss_reg.a14000.d;
+		tmss.n_cart_ce = M68K_Mem::ms_State->tmss_reg.n_cart_ce & 1;
+		zomg->saveMD_TMSS_reg(&tmss);
 	} else {
 		// TODO: Delete MD/TMSS_reg.bin from the savestate?
 	}
 
-	// Close the savestate.
-	zomg.close();
-	
 	// Savestate saved.
 	return 0;
 }
 
+/**
+ * Save the current state to an in-memory snapshot.
+ * Snapshots don't have a preview image or metadata,
+ * and aren't compressed.
+ * @param buf	[out] Buffer. (If nullptr, only the required size is returned.)
+ * @param siz	[in] Size of buf.
+ * @return Snapshot size on success; negative errno on error. (-ENOSPC if buf is too small)
+ */
+int EmuMD::saveSnapshot(void *buf, size_t siz) const
+{
+	// Bind this context to the calling thread.
+	makeCurrent();
+
+	LibZomg::ZomgSnapshot snapshot(buf, siz, LibZomg::ZomgSnapshot::SNAPSHOT_SYS_MD);
+	zomgSaveState(&snapshot);
+	snapshot.close();
+
+	if (buf && !snapshot.isComplete())
+		return -ENOSPC;
+	return (int)snapshot.size();
+}
+
+/**
+ * Load the current state from an in-memory snapshot.
+ * SRAM and EEPROM data is restored as well.
+ * @param buf	[in] Snapshot.
+ * @param siz	[in] Size of buf.
+ * @return 0 on success; negative errno on error.
+ */
+int EmuMD::loadSnapshot(const void *buf, size_t siz)
+{
+	// Bind this context to the calling thread.
+	makeCurrent();
+
+	LibZomg::ZomgSnapshot snapshot(buf, siz);
+	if (!snapshot.isOpen())
+		return snapshot.lastError();
+	if (snapshot.system() != LibZomg::ZomgSnapshot::SNAPSHOT_SYS_MD)
+		return -EINVAL;
+
+	int ret = zomgRestoreState(&snapshot, true);
+	snapshot.close();
+	return ret;
+}
+
 }
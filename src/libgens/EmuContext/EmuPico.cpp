@@ -34,6 +34,7 @@
 #include "cpu/M68K.hpp"
 #include "cpu/M68K_Mem.hpp"
 #include "sound/SoundMgr.hpp"
+#include "Util/VgmLogger.hpp"
 
 // LibGens OSD handler.
 #include "lg_osd.h"
@@ -73,23 +74,25 @@ EmuPico::EmuPico(Rom *rom, SysVersion::RegionCode_t region )
 	}
 
 	// Load the ROM into memory.
-	M68K_Mem::ms_RomCartridge = new RomCartridgeMD(rom);
-	M68K_Mem::ms_RomCartridge->loadRom();
-	if (!M68K_Mem::ms_RomCartridge->isRomLoaded()) {
+	M68K_Mem::ms_State->romCartridge = new RomCartridgeMD(rom);
+	M68K_Mem::ms_State->romCartridge->loadRom();
+	if (!M68K_Mem::ms_State->romCartridge->isRomLoaded()) {
 		// Error loading the ROM.
 		// TODO: Set an error code.
-		delete M68K_Mem::ms_RomCartridge;
-		M68K_Mem::ms_RomCartridge = nullptr;
+		delete M68K_Mem::ms_State->romCartridge;
+		M68K_Mem::ms_State->romCartridge = nullptr;
 		m_rom = nullptr;
 		return;
 	}
 
 	// Autofix the ROM checksum, if enabled.
 	if (AutoFixChecksum())
-		M68K_Mem::ms_RomCartridge->fixChecksum();
+		M68K_Mem::ms_State->romCartridge->fixChecksum();
 
 	// Initialize the M68K.
 	M68K::InitSys(M68K::SYSID_PICO);
+	M68K::SetIdleLoopDetect(IdleLoopDetect() &&
+		M68K_Mem::ms_State->romCartridge->idleLoopDetect());
 
 	// Initialize the system status.
 	// TODO: Move Vdp::SysStatus to EmuContext.
@@ -97,7 +100,7 @@ EmuPico::EmuPico(Rom *rom, SysVersion::RegionCode_t region )
 	m_vdp->SysStatus.Genesis = 1;
 
 	// Pico doesn't use MD-style TMSS.
-	M68K_Mem::tmss_reg.clearTmssRom();
+	M68K_Mem::ms_State->tmss_reg.clearTmssRom();
 
 	// Reset the controllers.
 	m_ioManager->reset();
@@ -113,12 +116,15 @@ EmuPico::EmuPico(Rom *rom, SysVersion::RegionCode_t region )
 
 EmuPico::~EmuPico()
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: Other stuff?
 	M68K::EndSys();
 
 	// Delete the RomCartridgeMD.
-	delete M68K_Mem::ms_RomCartridge;
-	M68K_Mem::ms_RomCartridge = nullptr;
+	delete M68K_Mem::ms_State->romCartridge;
+	M68K_Mem::ms_State->romCartridge = nullptr;
 }
 
 /**
@@ -127,13 +133,16 @@ EmuPico::~EmuPico()
  */
 int EmuPico::softReset(void)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// ROM checksum:
 	// - If autofix is enabled, fix the checksum.
 	// - If autofix is disabled, restore the checksum.
 	if (AutoFixChecksum())
-		M68K_Mem::ms_RomCartridge->fixChecksum();
+		M68K_Mem::ms_State->romCartridge->fixChecksum();
 	else
-		M68K_Mem::ms_RomCartridge->restoreChecksum();
+		M68K_Mem::ms_State->romCartridge->restoreChecksum();
 
 	// Reset the M68K.
 	M68K::Reset();
@@ -149,6 +158,9 @@ int EmuPico::softReset(void)
  */
 int EmuPico::hardReset(void)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// Reset the controllers.
 	m_ioManager->reset();
 
@@ -156,14 +168,16 @@ int EmuPico::hardReset(void)
 	// - If autofix is enabled, fix the checksum.
 	// - If autofix is disabled, restore the checksum.
 	if (AutoFixChecksum())
-		M68K_Mem::ms_RomCartridge->fixChecksum();
+		M68K_Mem::ms_State->romCartridge->fixChecksum();
 	else
-		M68K_Mem::ms_RomCartridge->restoreChecksum();
+		M68K_Mem::ms_State->romCartridge->restoreChecksum();
 
 	// Hard-Reset the M68K, Z80, VDP, PSG, and YM2612.
 	// This includes clearing RAM.
 	M68K::InitSys(M68K::SYSID_PICO);
-	SoundMgr::ms_Psg.reset();
+	M68K::SetIdleLoopDetect(IdleLoopDetect() &&
+		M68K_Mem::ms_State->romCartridge->idleLoopDetect());
+	SoundMgr::ms_State->psg.reset();
 
 	// Reset the VDP.
 	m_vdp->reset();
@@ -204,6 +218,9 @@ static inline int Round_Double(double val)
  */
 int EmuPico::setRegion_int(SysVersion::RegionCode_t region, bool preserveState)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	SysVersion newRegion(region);
 	if (preserveState && (m_sysVersion.isPal() == newRegion.isPal())) {
 		// preserveState was specified, and the current NTSC/PAL setting
@@ -229,13 +246,13 @@ int EmuPico::setRegion_int(SysVersion::RegionCode_t region, bool preserveState)
 	 * [Round_Double() rounds 0.5 to 0 and 1.5 to 1.] */
 	// TODO: Jorge says CPL is always 3420 master clock cycles...
 	if (m_sysVersion.isPal()) {
-		M68K_Mem::CPL_M68K = Round_Double((((double)CLOCK_PAL / 7.0) / 50.0) / 312.0);
+		M68K_Mem::ms_State->CPL_M68K = Round_Double((((double)CLOCK_PAL / 7.0) / 50.0) / 312.0);
 	} else {
-		M68K_Mem::CPL_M68K = Round_Double((((double)CLOCK_NTSC / 7.0) / 60.0) / 262.0);
+		M68K_Mem::ms_State->CPL_M68K = Round_Double((((double)CLOCK_NTSC / 7.0) / 60.0) / 262.0);
 	}
 
 	// No Z80 here...
-	M68K_Mem::CPL_Z80 = 0;
+	M68K_Mem::ms_State->CPL_Z80 = 0;
 
 	// Initialize audio.
 	// NOTE: Only set the region. Sound rate is set by the UI.
@@ -252,9 +269,12 @@ int EmuPico::setRegion_int(SysVersion::RegionCode_t region, bool preserveState)
  */
 int EmuPico::saveData(void)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: Call lg_osd here instead of in RomCartridgeMD().
-	if (M68K_Mem::ms_RomCartridge)
-		return M68K_Mem::ms_RomCartridge->saveData();
+	if (M68K_Mem::ms_State->romCartridge)
+		return M68K_Mem::ms_State->romCartridge->saveData();
 
 	// Nothing was saved.
 	return 0;
@@ -267,9 +287,12 @@ int EmuPico::saveData(void)
  */
 int EmuPico::autoSaveData(int framesElapsed)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: Call lg_osd here instead of in RomCartridgeMD().
-	if (M68K_Mem::ms_RomCartridge)
-		return M68K_Mem::ms_RomCartridge->autoSaveData(framesElapsed);
+	if (M68K_Mem::ms_State->romCartridge)
+		return M68K_Mem::ms_State->romCartridge->autoSaveData(framesElapsed);
 
 	// Nothing was saved.
 	return 0;
@@ -279,31 +302,50 @@ int EmuPico::autoSaveData(int framesElapsed)
  * Run a scanline.
  * @param LineType Line type.
  * @param VDP If true, VDP is updated.
+ * @param Perf If true, performance counters are updated.
  */
-template<EmuPico::LineType_t LineType, bool VDP>
+template<EmuPico::LineType_t LineType, bool VDP, bool Perf>
 FORCE_INLINE void EmuPico::T_execLine(void)
 {
+	uint64_t lap = 0;
+
 	// Update the sound chips.
 	int writeLen = SoundMgr::GetWriteLen(m_vdp->VDP_Lines.currentLine);
-	SoundMgr::ms_Psg.addWriteLen(writeLen);
+	SoundMgr::ms_State->psg.addWriteLen(writeLen);
 
 	// Notify controllers that a new scanline is being drawn.
+	if (Perf)
+		lap = Timing::GetTimestampNs();
 	m_ioManager->doScanline();
+	if (Perf)
+		perfLap(PerfCounters::PERF_IO, lap);
 
 	// Increment the cycles counter.
 	// These values are the "last cycle to execute".
 	// e.g. if Cycles_M68K is 5000, then we'll execute instructions
 	// until the 68000's "odometer" reaches 5000.
-	M68K_Mem::Cycles_M68K += M68K_Mem::CPL_M68K;
-
-	if (m_vdp->DMAT_Length)
-		M68K::AddCycles(m_vdp->updateDMA());
+	M68K_Mem::ms_State->Cycles_M68K += M68K_Mem::ms_State->CPL_M68K;
+
+	if (m_vdp->DMAT_Length) {
+		if (Perf)
+			lap = Timing::GetTimestampNs();
+		const unsigned int dmaCycles = m_vdp->updateDMA();
+		M68K::AddCycles(dmaCycles);
+		if (Perf) {
+			perfLap(PerfCounters::PERF_VDP_DMA, lap);
+			m_perf.cycles_dma += dmaCycles;
+		}
+	}
 
 	switch (LineType) {
 		case LINETYPE_ACTIVEDISPLAY:
 			// In visible area.
 			m_vdp->setStatusBit(VdpStatus::VDP_STATUS_HBLANK, true);	// HBlank = 1
-			M68K::Exec(M68K_Mem::Cycles_M68K - 404);
+			if (Perf)
+				lap = Timing::GetTimestampNs();
+			M68K::Exec(M68K_Mem::ms_State->Cycles_M68K - 404);
+			if (Perf)
+				perfLap(PerfCounters::PERF_M68K, lap);
 			m_vdp->setStatusBit(VdpStatus::VDP_STATUS_HBLANK, false);	// HBlank = 0
 
 			// Decrement the HInt counter.
@@ -331,7 +373,11 @@ FORCE_INLINE void EmuPico::T_execLine(void)
 			if (m_vdp->VDP_Lines.NTSC_V30.VBlank_Div != 0)
 				m_vdp->setStatusBit(VdpStatus::VDP_STATUS_VBLANK, false);
 
-			M68K::Exec(M68K_Mem::Cycles_M68K - 360);
+			if (Perf)
+				lap = Timing::GetTimestampNs();
+			M68K::Exec(M68K_Mem::ms_State->Cycles_M68K - 360);
+			if (Perf)
+				perfLap(PerfCounters::PERF_M68K, lap);
 #if 0
 			// TODO: Congratulations! (LibGens)
 			CONGRATULATIONS_POSTCHECK();
@@ -351,21 +397,34 @@ FORCE_INLINE void EmuPico::T_execLine(void)
 			break;
 	}
 
+	if (Perf)
+		lap = Timing::GetTimestampNs();
 	if (VDP) {
 		// VDP needs to be updated.
 		m_vdp->renderLine();
+		if (Perf)
+			perfLap(PerfCounters::PERF_VDP_RENDER, lap);
 	}
 
-	M68K::Exec(M68K_Mem::Cycles_M68K);
+	M68K::Exec(M68K_Mem::ms_State->Cycles_M68K);
+	if (Perf)
+		perfLap(PerfCounters::PERF_M68K, lap);
 }
 
 /**
  * T_execFrame(): Run a frame.
  * @param VDP If true, VDP is updated.
+ * @param Perf If true, performance counters are updated.
  */
-template<bool VDP>
+template<bool VDP, bool Perf>
 FORCE_INLINE void EmuPico::T_execFrame(void)
 {
+	uint64_t frame_start = 0;
+	if (Perf) {
+		m_perf.clear();
+		frame_start = Timing::GetTimestampNs();
+	}
+
 	// Initialize Vdp::VDP_Lines.
 	// Reset the current VDP line variables for the new frame.
 	m_vdp->updateVdpLines(true);
@@ -380,9 +439,9 @@ FORCE_INLINE void EmuPico::T_execFrame(void)
 	SoundMgr::ResetPtrsAndLens();
 
 	// Clear all of the cycle counters.
-	M68K_Mem::Cycles_M68K = 0;
-	M68K_Mem::Cycles_Z80 = 0;
-	M68K_Mem::Last_BUS_REQ_Cnt = -1000;
+	M68K_Mem::ms_State->Cycles_M68K = 0;
+	M68K_Mem::ms_State->Cycles_Z80 = 0;
+	M68K_Mem::ms_State->Last_BUS_REQ_Cnt = -1000;
 	M68K::TripOdometer();
 
 	// TODO: MDP . (LibGens)
@@ -403,30 +462,44 @@ FORCE_INLINE void EmuPico::T_execFrame(void)
 
 	/** Loop 1: Active display. **/
 	do {
-		T_execLine<LINETYPE_ACTIVEDISPLAY, VDP>();
+		T_execLine<LINETYPE_ACTIVEDISPLAY, VDP, Perf>();
 
 		// Next line.
 		m_vdp->VDP_Lines.currentLine++;
 	} while (m_vdp->VDP_Lines.currentLine < m_vdp->VDP_Lines.totalVisibleLines);
 
 	/** Loop 2: VBlank line. **/
-	T_execLine<LINETYPE_VBLANKLINE, VDP>();
+	T_execLine<LINETYPE_VBLANKLINE, VDP, Perf>();
 	m_vdp->VDP_Lines.currentLine++;
 
 	/** Loop 3: Borders. **/
 	do {
-		T_execLine<LINETYPE_BORDER, VDP>();
+		T_execLine<LINETYPE_BORDER, VDP, Perf>();
 
 		// Next line.
 		m_vdp->VDP_Lines.currentLine++;
 	} while (m_vdp->VDP_Lines.currentLine < m_vdp->VDP_Lines.totalDisplayLines);
 
 	// Update the PSG and YM2612 output.
+	uint64_t lap = 0;
+	if (Perf)
+		lap = Timing::GetTimestampNs();
 	SoundMgr::SpecialUpdate();
+	if (Perf) {
+		perfLap(PerfCounters::PERF_SOUND_UPDATE, lap);
+		m_perf.frame_ns = (lap - frame_start);
+		m_perf.cycles_m68k = M68K::ReadOdometer();
+		m_perfHistory.push(m_perf);
+	}
+
+	// If VGM is being logged, end the VGM frame.
+	VgmLogger *const vgmLogger = SoundMgr::ms_State->vgmLogger;
+	if (vgmLogger) {
+		vgmLogger->endFrame(M68K_Mem::ms_State->Cycles_M68K);
+	}
 
 #if 0
 	// If WAV or GYM is being dumped, update the WAV or GYM.
-	// TODO: VGM dumping
 	if (WAV_Dumping)
 		wav_dump_update();
 	if (GYM_Dumping)
@@ -457,12 +530,20 @@ FORCE_INLINE void EmuPico::T_execFrame(void)
 
 void EmuPico::execFrame(void)
 {
-	T_execFrame<true>();
+	makeCurrent();
+	if (m_perfEnabled)
+		T_execFrame<true, true>();
+	else
+		T_execFrame<true, false>();
 }
 
 void EmuPico::execFrameFast(void)
 {
-	T_execFrame<false>();
+	makeCurrent();
+	if (m_perfEnabled)
+		T_execFrame<false, true>();
+	else
+		T_execFrame<false, false>();
 }
 
 }
@@ -29,6 +29,10 @@
 // Needed for FORCE_INLINE.
 #include "../macros/common.h"
 
+namespace LibZomg {
+	class ZomgBase;
+}
+
 namespace LibGens {
 
 class EmuPico : public EmuContext
@@ -96,7 +100,38 @@ class EmuPico : public EmuContext
 		 */
 		virtual int zomgSave(const char *filename) const final;
 
+		/**
+		 * Save the current state to an in-memory snapshot.
+		 * @param buf	[out] Buffer. (If nullptr, only the required size is returned.)
+		 * @param siz	[in] Size of buf.
+		 * @return Snapshot size on success; negative errno on error.
+		 */
+		virtual int saveSnapshot(void *buf, size_t siz) const final;
+
+		/**
+		 * Load the current state from an in-memory snapshot.
+		 * @param buf	[in] Snapshot.
+		 * @param siz	[in] Size of buf.
+		 * @return 0 on success; negative errno on error.
+		 */
+		virtual int loadSnapshot(const void *buf, size_t siz) final;
+
 	protected:
+		/**
+		 * Save the emulation state to a ZOMG object.
+		 * @param zomg		[in] ZOMG object.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int zomgSaveState(LibZomg::ZomgBase *zomg) const;
+
+		/**
+		 * Restore the emulation state from a ZOMG object.
+		 * @param zomg		[in] ZOMG object.
+		 * @param loadSaveData	[in] If true, load SRAM/EEPROM data.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int zomgRestoreState(LibZomg::ZomgBase *zomg, bool loadSaveData);
+
 		/**
 		 * Line types.
 		 */
@@ -106,10 +141,10 @@ class EmuPico : public EmuContext
 			LINETYPE_BORDER		= 2,
 		};
 
-		template<LineType_t LineType, bool VDP>
+		template<LineType_t LineType, bool VDP, bool Perf>
 		FORCE_INLINE void T_execLine(void);
 
-		template<bool VDP>
+		template<bool VDP, bool Perf>
 		FORCE_INLINE void T_execFrame(void);
 
 		/**
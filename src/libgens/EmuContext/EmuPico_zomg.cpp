@@ -37,6 +37,7 @@
 
 // ZOMG save structs.
 #include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgSnapshot.hpp"
 #include "libzomg/Metadata.hpp"
 #include "libzomg/zomg_vdp.h"
 #include "libzomg/zomg_psg.h"
@@ -79,6 +80,9 @@ namespace LibGens {
  */
 int EmuPico::zomgLoad(const char *filename)
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// Make sure the file exists.
 	if (access(filename, F_OK))
 		return -ENOENT;
@@ -97,28 +101,57 @@ int EmuPico::zomgLoad(const char *filename)
 	if (!zomg.isOpen())
 		return -EIO;
 
+	// Decompress the large files in parallel.
+	// SRAM isn't loaded, so it doesn't need to be prefetched.
+	zomg.prefetch(false);
+
+	// Load the emulation state.
+	// TODO: Make the 'loadSaveData' parameter user-configurable.
+	int ret = zomgRestoreState(&zomg, false);
+
+	// Close the savestate.
+	zomg.close();
+	return ret;
+}
+
+/**
+ * Restore the emulation state from a ZOMG object.
+ * This is used for both ZOMG files and in-memory snapshots.
+ * NOTE: makeCurrent() must be called first.
+ * @param zomg		[in] ZOMG object.
+ * @param loadSaveData	[in] If true, load SRAM/EEPROM data.
+ * @return 0 on success; negative errno on error.
+ */
+int EmuPico::zomgRestoreState(LibZomg::ZomgBase *zomg, bool loadSaveData)
+{
 	// TODO: Check error codes from the ZOMG functions.
 	// TODO: Load everything first, *then* copy it to LibGens.
 
 	/** VDP **/
-	m_vdp->zomgRestoreMD(&zomg);
+	m_vdp->zomgRestoreMD(zomg);
 
 	/** Audio **/
 
 	// Load the PSG state.
-	Zomg_PsgSave_t psg_save;
-	zomg.loadPsgReg(&psg_save);
-	SoundMgr::ms_Psg.zomgRestore(&psg_save);
+	// Snapshots have the complete internal state, including
+	// the tone counters. Otherwise, restore the registers.
+	Psg *const psg = &SoundMgr::ms_State->psg;
+	if (psg->zomgRestoreInternal(zomg) != 0) {
+		Zomg_PsgSave_t psg_save;
+		zomg->loadPsgReg(&psg_save);
+		psg->zomgRestore(&psg_save);
+	}
 
 	/** MD: M68K **/
 
 	// Load the M68K memory.
-	zomg.loadM68KMem(Ram_68k.u16, sizeof(Ram_68k.u16), ZOMG_BYTEORDER_16H);
+	zomg->loadM68KMem(M68K_Mem::ms_State->ram->u16, sizeof(M68K_Mem::ms_State->ram->u16), ZOMG_BYTEORDER_16H);
 
 	// Load the M68K registers.
 	Zomg_M68KRegSave_t m68k_reg_save;
-	zomg.loadM68KReg(&m68k_reg_save);
+	zomg->loadM68KReg(&m68k_reg_save);
 	M68K::ZomgRestoreReg(&m68k_reg_save);
+	M68K::ZomgRestoreInternal(zomg);
 
 	/* TODO: Pico-specific registers. ($800000) */
 
@@ -127,15 +160,11 @@ int EmuPico::zomgLoad(const char *filename)
 	// - MD /TIME registers. (SRAM control, etc.)
 	// - SRAM data.
 	// - EEPROM control and data.
-	// TODO: Make the 'loadSaveData' parameter user-configurable.
-	M68K_Mem::ms_RomCartridge->zomgRestore(&zomg, false);
+	M68K_Mem::ms_State->romCartridge->zomgRestore(zomg, loadSaveData);
 
 	// TODO: Load TMSS.
 	// Pico TMSS only has one register, the 'SEGA' register.
 
-	// Close the savestate.
-	zomg.close();
-
 	// Savestate loaded.
 	return 0;
 }
@@ -148,6 +177,9 @@ int EmuPico::zomgLoad(const char *filename)
  */
 int EmuPico::zomgSave(const char *filename) const
 {
+	// Bind this context to the calling thread.
+	makeCurrent();
+
 	// TODO: More comprehensive error reporting.
 	LibZomg::Zomg zomg(filename, LibZomg::Zomg::ZOMG_SAVE);
 	if (!zomg.isOpen())
@@ -186,28 +218,46 @@ int EmuPico::zomgSave(const char *filename) const
 	Screenshot::toZomg(&zomg, fb, m_rom);
 	fb->unref();
 
+	// Save the emulation state.
+	ret = zomgSaveState(&zomg);
+
+	// Close the savestate.
+	zomg.close();
+	return ret;
+}
+
+/**
+ * Save the emulation state to a ZOMG object.
+ * This is used for both ZOMG files and in-memory snapshots.
+ * NOTE: makeCurrent() must be called first.
+ * @param zomg		[in] ZOMG object.
+ * @return 0 on success; negative errno on error.
+ */
+int EmuPico::zomgSaveState(LibZomg::ZomgBase *zomg) const
+{
 	// TODO: Check error codes from the ZOMG functions.
-	// TODO: Load everything first, *then* copy it to LibGens.
 
 	/** VDP **/
-	m_vdp->zomgSaveMD(&zomg);
+	m_vdp->zomgSaveMD(zomg);
 
 	/** Audio **/
 
 	// Save the PSG state.
 	Zomg_PsgSave_t psg_save;
-	SoundMgr::ms_Psg.zomgSave(&psg_save);
-	zomg.savePsgReg(&psg_save);
+	SoundMgr::ms_State->psg.zomgSave(&psg_save);
+	zomg->savePsgReg(&psg_save);
+	SoundMgr::ms_State->psg.zomgSaveInternal(zomg);
 
 	/** MD: M68K **/
 
 	// Save the M68K memory.
-	zomg.saveM68KMem(Ram_68k.u16, sizeof(Ram_68k.u16), ZOMG_BYTEORDER_16H);
+	zomg->saveM68KMem(M68K_Mem::ms_State->ram->u16, sizeof(M68K_Mem::ms_State->ram->u16), ZOMG_BYTEORDER_16H);
 
 	// Save the M68K registers.
 	Zomg_M68KRegSave_t m68k_reg_save;
 	M68K::ZomgSaveReg(&m68k_reg_save);
-	zomg.saveM68KReg(&m68k_reg_save);
+	zomg->saveM68KReg(&m68k_reg_save);
+	M68K::ZomgSaveInternal(zomg);
 
 	/* TODO: Pico-specific registers. ($800000) */
 
@@ -216,16 +266,58 @@ int EmuPico::zomgSave(const char *filename) const
 	// - MD /TIME registers. (SRAM control, etc.)
 	// - SRAM data.
 	// - EEPROM control and data.
-	M68K_Mem::ms_RomCartridge->zomgSave(&zomg);
+	M68K_Mem::ms_State->romCartridge->zomgSave(zomg);
 
 	// TODO: Save TMSS.
 	// Pico TMSS only has one register, the 'SEGA' register.
 
-	// Close the savestate.
-	zomg.close();
-	
 	// Savestate saved.
 	return 0;
 }
 
+/**
+ * Save the current state to an in-memory snapshot.
+ * Snapshots don't have a preview image or metadata,
+ * and aren't compressed.
+ * @param buf	[out] Buffer. (If nullptr, only the required size is returned.)
+ * @param siz	[in] Size of buf.
+ * @return Snapshot size on success; negative errno on error. (-ENOSPC if buf is too small)
+ */
+int EmuPico::saveSnapshot(void *buf, size_t siz) const
+{
+	// Bind this context to the calling thread.
+	makeCurrent();
+
+	LibZomg::ZomgSnapshot snapshot(buf, siz, LibZomg::ZomgSnapshot::SNAPSHOT_SYS_PICO);
+	zomgSaveState(&snapshot);
+	snapshot.close();
+
+	if (buf && !snapshot.isComplete())
+		return -ENOSPC;
+	return (int)snapshot.size();
+}
+
+/**
+ * Load the current state from an in-memory snapshot.
+ * SRAM and EEPROM data is restored as well.
+ * @param buf	[in] Snapshot.
+ * @param siz	[in] Size of buf.
+ * @return 0 on success; negative errno on error.
+ */
+int EmuPico::loadSnapshot(const void *buf, size_t siz)
+{
+	// Bind this context to the calling thread.
+	makeCurrent();
+
+	LibZomg::ZomgSnapshot snapshot(buf, siz);
+	if (!snapshot.isOpen())
+		return snapshot.lastError();
+	if (snapshot.system() != LibZomg::ZomgSnapshot::SNAPSHOT_SYS_PICO)
+		return -EINVAL;
+
+	int ret = zomgRestoreState(&snapshot, true);
+	snapshot.close();
+	return ret;
+}
+
 }
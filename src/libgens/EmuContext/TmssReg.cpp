@@ -194,7 +194,7 @@ int TmssReg::updateSysBanking(STARSCREAM_PROGRAMREGION *M68K_Fetch, int banks)
 #ifdef GENS_ENABLE_EMULATION
 	M68K_Fetch->lowaddr = 0x000000;
 	M68K_Fetch->highaddr = m_tmssRom_mask;
-	M68K_Fetch->offset = (uint32_t)m_tmssRom;
+	M68K_Fetch->offset = (uintptr_t)m_tmssRom;
 	M68K_Fetch++;
 	return 1;
 #else /* !GENS_ENABLE_EMULATION */
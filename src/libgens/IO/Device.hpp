@@ -153,6 +153,16 @@ class Device
 			return this->buttons;
 		}
 
+		/**
+		 * Get the absolute tablet coordinates.
+		 * @param x [out] X coordinate.
+		 * @param y [out] Y coordinate.
+		 */
+		inline void getAbsolutePosition(int *x, int *y) const {
+			*x = this->m_abs_x;
+			*y = this->m_abs_y;
+		}
+
 		/**
 		 * Check an input line's state.
 		 * @param ioPin I/O pin, or multiple pins.
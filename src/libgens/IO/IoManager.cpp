@@ -862,6 +862,39 @@ void IoManager::updateAbsolutePosition(int virtPort, int x, int y)
 	}
 }
 
+/**
+ * Copy the host-side input state from another IoManager.
+ * This includes device types, buttons, tablet coordinates,
+ * and the Pico page number. The MD-side state isn't copied.
+ * Used to run a secondary context with the same input.
+ * @param src Source IoManager.
+ */
+void IoManager::copyInput(const IoManager *src)
+{
+	d->constrainDPad = src->d->constrainDPad;
+
+	for (int i = VIRTPORT_1; i < VIRTPORT_MAX; i++) {
+		const VirtPort_t virtPort = (VirtPort_t)i;
+		setDevType(virtPort, src->devType(virtPort));
+
+		IO::Device *const dev = d->ioDevices[i];
+		const IO::Device *const srcDev = src->d->ioDevices[i];
+		if (!dev || !srcDev)
+			continue;
+
+		// NOTE: The source buttons have already been
+		// constrained, so the device is updated directly.
+		int x, y;
+		srcDev->getAbsolutePosition(&x, &y);
+		dev->updateAbsolutePosition(x, y);
+		dev->update(srcDev->getButtons());
+	}
+
+	if (devType(VIRTPORT_1) == IOT_PICO) {
+		setPicoCurPageNum(src->picoCurPageNum());
+	}
+}
+
 /** ZOMG savestate functions. **/
 
 /**
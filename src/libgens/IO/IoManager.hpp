@@ -134,6 +134,15 @@ class IoManager
 		 */
 		void updateAbsolutePosition(int virtPort, int x, int y);
 
+		/**
+		 * Copy the host-side input state from another IoManager.
+		 * This includes device types, buttons, tablet coordinates,
+		 * and the Pico page number. The MD-side state isn't copied.
+		 * Used to run a secondary context with the same input.
+		 * @param src Source IoManager.
+		 */
+		void copyInput(const IoManager *src);
+
 		/**
 		 * Update the scanline counter for all controllers.
 		 * This is used by the 6-button controller,
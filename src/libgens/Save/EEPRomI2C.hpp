@@ -30,7 +30,7 @@
 
 // ZOMG
 namespace LibZomg {
-	class Zomg;
+	class ZomgBase;
 }
 
 namespace LibGens {
@@ -99,6 +99,13 @@ class EEPRomI2C
 		inline bool isWriteBytePort(uint32_t address) const;
 		inline bool isWriteWordPort(uint32_t address) const;
 
+		/**
+		 * Get the 68000 address of the SDA_OUT (read) port.
+		 * Only valid if the EEPRom type is set.
+		 * @return SDA_OUT address.
+		 */
+		inline uint32_t readPortAddress(void) const;
+
 		/**
 		 * Check if the EEPRom is dirty.
 		 * @return True if EEPRom has been modified since the last save; false otherwise.
@@ -138,8 +145,8 @@ class EEPRomI2C
 		int autoSave(int framesElapsed);
 
 		/** ZOMG functions. **/
-		int zomgRestore(LibZomg::Zomg *zomg, bool loadSaveData);
-		int zomgSave(LibZomg::Zomg *zomg) const;
+		int zomgRestore(LibZomg::ZomgBase *zomg, bool loadSaveData);
+		int zomgSave(LibZomg::ZomgBase *zomg) const;
 
 	public:
 		// Super secret debug stuff!
@@ -235,6 +242,15 @@ bool EEPRomI2C::isWriteWordPort(uint32_t address) const
 		(address == (eprMapper.sda_in_adr | 1)));
 }
 
+/**
+ * Get the 68000 address of the SDA_OUT (read) port.
+ * @return SDA_OUT address.
+ */
+inline uint32_t EEPRomI2C::readPortAddress(void) const
+{
+	return eprMapper.sda_out_adr;
+}
+
 }
 
 #endif /* __LIBGENS_SAVE_EEPROMI2C_HPP__ */
@@ -32,7 +32,7 @@
 #endif
 
 // ZOMG
-#include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgBase.hpp"
 #include "libzomg/zomg_eeprom.h"
 
 // C includes. (C++ namespace)
@@ -209,7 +209,7 @@ int EEPRomI2C::autoSave(int framesElapsed)
  * @param loadData If true, load the save data in addition to the state.
  * @return 0 on success; non-zero on error.
  */
-int EEPRomI2C::zomgRestore(LibZomg::Zomg *zomg, bool loadSaveData)
+int EEPRomI2C::zomgRestore(LibZomg::ZomgBase *zomg, bool loadSaveData)
 {
 	// TODO
 	return -1;
@@ -221,7 +221,7 @@ int EEPRomI2C::zomgRestore(LibZomg::Zomg *zomg, bool loadSaveData)
  * @param zomg ZOMG savestate.
  * @return 0 on success; non-zero on error.
  */
-int EEPRomI2C::zomgSave(LibZomg::Zomg *zomg) const
+int EEPRomI2C::zomgSave(LibZomg::ZomgBase *zomg) const
 {
 	// Save the EEPROM state.
 	Zomg_EPR_ctrl_t ctrl;
@@ -32,7 +32,7 @@
 #endif
 
 // ZOMG
-#include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgBase.hpp"
 
 // C includes. (C++ namespace)
 #include <climits>
@@ -358,7 +358,7 @@ int SRam::autoSave(int framesElapsed)
  * @param zomg ZOMG savestate.
  * @return 0 on success; non-zero on error.
  */
-int SRam::zomgRestore(LibZomg::Zomg *zomg)
+int SRam::zomgRestore(LibZomg::ZomgBase *zomg)
 {
 	// Load the SRam.
 	int ret = zomg->loadSRam(m_sram, sizeof(m_sram));
@@ -378,7 +378,7 @@ int SRam::zomgRestore(LibZomg::Zomg *zomg)
  * @param zomg ZOMG savestate.
  * @return 0 on success; non-zero on error.
  */
-int SRam::zomgSave(LibZomg::Zomg *zomg) const
+int SRam::zomgSave(LibZomg::ZomgBase *zomg) const
 {
 	// Determine how much of the SRam is currently in use.
 	int bytesUsed = d->getUsedSize();
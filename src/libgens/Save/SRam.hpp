@@ -33,7 +33,7 @@
 
 // ZOMG
 namespace LibZomg {
-	class Zomg;
+	class ZomgBase;
 }
 
 namespace LibGens {
@@ -119,8 +119,8 @@ class SRam
 		int autoSave(int framesElapsed);
 		
 		/** ZOMG functions. **/
-		int zomgRestore(LibZomg::Zomg *zomg);
-		int zomgSave(LibZomg::Zomg *zomg) const;
+		int zomgRestore(LibZomg::ZomgBase *zomg);
+		int zomgSave(LibZomg::ZomgBase *zomg) const;
 
 	protected:
 		// Dirty flag.
@@ -0,0 +1,722 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * AvRecorder.cpp: Lossless audio/video recorder.                          *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "AvRecorder.hpp"
+#include "MdFb.hpp"
+
+// Byteswapping macros.
+#include "libcompat/byteswap.h"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::vector;
+
+namespace LibGens {
+
+class AvRecorderPrivate
+{
+	public:
+		AvRecorderPrivate();
+		~AvRecorderPrivate();
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		AvRecorderPrivate(const AvRecorderPrivate &);
+		AvRecorderPrivate &operator=(const AvRecorderPrivate &);
+
+	public:
+		// Number of queued frames. (Must be a power of two.)
+		// 16 frames of 320x240 at 32-bit color is about 4.7 MB.
+		static const unsigned int FRAME_SLOTS = 16;
+
+		// Size of the audio queue, in int16_t values. (Must be a power of two.)
+		// This is about 1.3 seconds of 48 kHz stereo audio.
+		static const unsigned int AUDIO_RING_SIZE = 131072;
+
+		// Maximum frame size.
+		// Larger frames can be recorded, but they
+		// require reallocating the frame slot.
+		static const unsigned int MAX_FRAME_BYTES = 320 * 240 * 4;
+
+		/**
+		 * Queued video frame.
+		 */
+		struct FrameSlot {
+			vector<uint8_t> data;	// Pixels. (packed rows)
+			int w;
+			int h;
+			MdFb::ColorDepth bpp;
+			// Number of dropped frames before this one.
+			// The previous frame is repeated for each of them.
+			unsigned int repeat;
+
+			FrameSlot() : w(0), h(0), bpp(MdFb::BPP_32), repeat(0) { }
+		};
+
+		// Video queue.
+		// frameHead is only written by the emulation thread;
+		// frameTail is only written by the worker thread.
+		FrameSlot frames[FRAME_SLOTS];
+		std::atomic<unsigned int> frameHead;
+		std::atomic<unsigned int> frameTail;
+
+		// Audio queue.
+		vector<int16_t> audioRing;
+		std::atomic<unsigned int> audioHead;
+		std::atomic<unsigned int> audioTail;
+
+		// Output files.
+		FILE *fVideo;
+		FILE *fAudio;
+		int rate;
+		int channels;
+		uint32_t audioBytes;	// Size of the WAV data chunk.
+		int error;		// First write error. (Worker thread only.)
+
+		// Worker thread.
+		std::thread worker;
+		std::atomic<bool> quit;
+		std::mutex wakeMutex;
+		std::condition_variable wakeCond;
+		bool isOpen;
+
+		// Worker thread buffers.
+		vector<uint8_t> lastFrame;	// Last frame written. (PPM image)
+		vector<int16_t> audioBuf;
+
+		// Dropped data that hasn't been replaced yet. (Emulation thread only.)
+		// pendingRepeat is stored in the next queued frame;
+		// pendingSilence is queued before the next audio.
+		unsigned int pendingRepeat;	// Frames.
+		unsigned int pendingSilence;	// int16_t values.
+
+		// Statistics.
+		std::atomic<unsigned int> framesWritten;
+		std::atomic<unsigned int> droppedFrames;
+		std::atomic<unsigned int> droppedSamples;
+
+		/**
+		 * Worker thread function.
+		 */
+		void workerMain(void);
+
+		/**
+		 * Write all queued frames.
+		 * Called by the worker thread.
+		 * @return True if any frames were written.
+		 */
+		bool writeFrames(void);
+
+		/**
+		 * Write all queued audio.
+		 * Called by the worker thread.
+		 * @return True if any audio was written.
+		 */
+		bool writeAudio(void);
+
+		/**
+		 * Repeat the last frame written.
+		 * @param count Number of times to write the frame.
+		 */
+		void repeatFrame(unsigned int count);
+
+		/**
+		 * Write silence.
+		 * @param count Number of int16_t values to write.
+		 */
+		void writeSilence(unsigned int count);
+
+		/**
+		 * Convert a row of pixels to RGB24.
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 * @param bpp Color depth.
+		 */
+		static void convertRow(uint8_t *dest, const uint8_t *src,
+				       int w, MdFb::ColorDepth bpp);
+
+		/**
+		 * Write a WAV header.
+		 * @param f WAV file. (Must be at the beginning of the file.)
+		 * @param rate Sampling rate.
+		 * @param channels Number of channels.
+		 * @param dataBytes Size of the data chunk.
+		 * @return 0 on success; negative errno on error.
+		 */
+		static int writeWavHeader(FILE *f, int rate, int channels, uint32_t dataBytes);
+};
+
+/** AvRecorderPrivate **/
+
+AvRecorderPrivate::AvRecorderPrivate()
+	: frameHead(0)
+	, frameTail(0)
+	, audioHead(0)
+	, audioTail(0)
+	, fVideo(nullptr)
+	, fAudio(nullptr)
+	, rate(0)
+	, channels(0)
+	, audioBytes(0)
+	, error(0)
+	, quit(false)
+	, isOpen(false)
+	, pendingRepeat(0)
+	, pendingSilence(0)
+	, framesWritten(0)
+	, droppedFrames(0)
+	, droppedSamples(0)
+{ }
+
+AvRecorderPrivate::~AvRecorderPrivate()
+{ }
+
+/**
+ * Worker thread function.
+ */
+void AvRecorderPrivate::workerMain(void)
+{
+	while (true) {
+		// Check for quit *before* writing, so everything
+		// queued before close() is written.
+		const bool doQuit = quit.load(std::memory_order_acquire);
+		bool didWork = writeFrames();
+		didWork |= writeAudio();
+		if (didWork)
+			continue;
+		if (doQuit)
+			break;
+
+		// Nothing to do. Wait for more data.
+		// The emulation thread doesn't lock wakeMutex,
+		// so a wakeup may be missed; the timeout
+		// limits the resulting delay.
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wakeCond.wait_for(lock, std::chrono::milliseconds(10));
+	}
+}
+
+/**
+ * Write all queued frames.
+ * Called by the worker thread.
+ * @return True if any frames were written.
+ */
+bool AvRecorderPrivate::writeFrames(void)
+{
+	unsigned int tail = frameTail.load(std::memory_order_relaxed);
+	const unsigned int head = frameHead.load(std::memory_order_acquire);
+	if (tail == head)
+		return false;
+
+	for (; tail != head; tail++) {
+		const FrameSlot *slot = &frames[tail & (FRAME_SLOTS - 1)];
+
+		// Replace the frames that were dropped before this one.
+		repeatFrame(slot->repeat);
+
+		// Convert the frame to a PPM image.
+		// It's kept in case it has to be repeated.
+		char header[32];
+		const int headerBytes = snprintf(header, sizeof(header),
+				"P6\n%d %d\n255\n", slot->w, slot->h);
+		const int pxSize = (slot->bpp == MdFb::BPP_32 ? 4 : 2);
+		const int rowBytes = slot->w * 3;
+		lastFrame.resize(headerBytes + (rowBytes * slot->h));
+		memcpy(lastFrame.data(), header, headerBytes);
+		uint8_t *dest = &lastFrame[headerBytes];
+		const uint8_t *src = slot->data.data();
+		for (int y = 0; y < slot->h; y++, dest += rowBytes, src += (slot->w * pxSize)) {
+			convertRow(dest, src, slot->w, slot->bpp);
+		}
+
+		// Release the slot.
+		frameTail.store(tail + 1, std::memory_order_release);
+		repeatFrame(1);
+	}
+
+	return true;
+}
+
+/**
+ * Write all queued audio.
+ * Called by the worker thread.
+ * @return True if any audio was written.
+ */
+bool AvRecorderPrivate::writeAudio(void)
+{
+	unsigned int tail = audioTail.load(std::memory_order_relaxed);
+	const unsigned int head = audioHead.load(std::memory_order_acquire);
+	if (tail == head)
+		return false;
+
+	while (tail != head) {
+		// Copy up to the end of the ring buffer.
+		const unsigned int pos = (tail & (AUDIO_RING_SIZE - 1));
+		unsigned int count = (head - tail);
+		if (count > AUDIO_RING_SIZE - pos)
+			count = AUDIO_RING_SIZE - pos;
+
+		if (fAudio && error == 0) {
+			// WAV files are little-endian.
+			audioBuf.assign(&audioRing[pos], &audioRing[pos + count]);
+			cpu_to_le16_array(audioBuf.data(), count * sizeof(int16_t));
+			if (fwrite(audioBuf.data(), sizeof(int16_t), count, fAudio) != count) {
+				error = -EIO;
+			}
+			audioBytes += (count * sizeof(int16_t));
+		}
+
+		tail += count;
+		audioTail.store(tail, std::memory_order_release);
+	}
+
+	return true;
+}
+
+/**
+ * Repeat the last frame written.
+ * @param count Number of times to write the frame.
+ */
+void AvRecorderPrivate::repeatFrame(unsigned int count)
+{
+	if (lastFrame.empty())
+		return;
+
+	for (; count > 0; count--) {
+		if (fVideo && error == 0) {
+			if (fwrite(lastFrame.data(), 1, lastFrame.size(), fVideo) != lastFrame.size())
+				error = -EIO;
+		}
+		framesWritten.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Write silence.
+ * @param count Number of int16_t values to write.
+ */
+void AvRecorderPrivate::writeSilence(unsigned int count)
+{
+	if (!fAudio || count == 0)
+		return;
+
+	audioBuf.assign(count < 4096 ? count : 4096, 0);
+	while (count > 0 && error == 0) {
+		const unsigned int n = (count < audioBuf.size() ? count : audioBuf.size());
+		if (fwrite(audioBuf.data(), sizeof(int16_t), n, fAudio) != n) {
+			error = -EIO;
+		}
+		audioBytes += (n * sizeof(int16_t));
+		count -= n;
+	}
+}
+
+/**
+ * Convert a row of pixels to RGB24.
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
+ * @param bpp Color depth.
+ */
+void AvRecorderPrivate::convertRow(uint8_t *dest, const uint8_t *src,
+				   int w, MdFb::ColorDepth bpp)
+{
+	switch (bpp) {
+		case MdFb::BPP_15: {
+			const uint16_t *px = (const uint16_t*)src;
+			for (; w > 0; w--, px++, dest += 3) {
+				const uint8_t r = (*px >> 10) & 0x1F;
+				const uint8_t g = (*px >> 5) & 0x1F;
+				const uint8_t b = *px & 0x1F;
+				dest[0] = (r << 3) | (r >> 2);
+				dest[1] = (g << 3) | (g >> 2);
+				dest[2] = (b << 3) | (b >> 2);
+			}
+			break;
+		}
+
+		case MdFb::BPP_16: {
+			const uint16_t *px = (const uint16_t*)src;
+			for (; w > 0; w--, px++, dest += 3) {
+				const uint8_t r = (*px >> 11) & 0x1F;
+				const uint8_t g = (*px >> 5) & 0x3F;
+				const uint8_t b = *px & 0x1F;
+				dest[0] = (r << 3) | (r >> 2);
+				dest[1] = (g << 2) | (g >> 4);
+				dest[2] = (b << 3) | (b >> 2);
+			}
+			break;
+		}
+
+		case MdFb::BPP_32:
+		default: {
+			const uint32_t *px = (const uint32_t*)src;
+			for (; w > 0; w--, px++, dest += 3) {
+				dest[0] = (uint8_t)(*px >> 16);
+				dest[1] = (uint8_t)(*px >> 8);
+				dest[2] = (uint8_t)(*px);
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * Write a WAV header.
+ * @param f WAV file. (Must be at the beginning of the file.)
+ * @param rate Sampling rate.
+ * @param channels Number of channels.
+ * @param dataBytes Size of the data chunk.
+ * @return 0 on success; negative errno on error.
+ */
+int AvRecorderPrivate::writeWavHeader(FILE *f, int rate, int channels, uint32_t dataBytes)
+{
+	const uint32_t blockAlign = channels * sizeof(int16_t);
+	const uint32_t fields[] = {
+		dataBytes + 36,		// RIFF chunk size
+		16,			// fmt chunk size
+		(uint32_t)rate,		// Sampling rate
+		rate * blockAlign,	// Bytes per second
+		dataBytes,		// data chunk size
+	};
+
+	uint8_t header[44];
+	memcpy(&header[0], "RIFF", 4);
+	memcpy(&header[8], "WAVEfmt ", 8);
+	memcpy(&header[36], "data", 4);
+
+	// Little-endian fields.
+	#define PUT16(offset, value) do { \
+		header[(offset)+0] = (uint8_t)((value) & 0xFF); \
+		header[(offset)+1] = (uint8_t)(((value) >> 8) & 0xFF); \
+	} while (0)
+	#define PUT32(offset, value) do { \
+		PUT16((offset), (value)); \
+		PUT16((offset)+2, ((value) >> 16)); \
+	} while (0)
+	PUT32(4, fields[0]);
+	PUT32(16, fields[1]);
+	PUT16(20, 1);			// PCM
+	PUT16(22, channels);
+	PUT32(24, fields[2]);
+	PUT32(28, fields[3]);
+	PUT16(32, blockAlign);
+	PUT16(34, 16);			// Bits per sample
+	PUT32(40, fields[4]);
+	#undef PUT32
+	#undef PUT16
+
+	if (fwrite(header, 1, sizeof(header), f) != sizeof(header))
+		return -EIO;
+	return 0;
+}
+
+/** AvRecorder **/
+
+AvRecorder::AvRecorder()
+	: d(new AvRecorderPrivate())
+{ }
+
+/**
+ * Delete the recorder.
+ * If recording, the recording will be closed first.
+ */
+AvRecorder::~AvRecorder()
+{
+	close();
+	delete d;
+}
+
+/**
+ * Start recording.
+ * @param videoFilename	[in, opt] Video file. (PPM stream) If nullptr, video isn't recorded.
+ * @param audioFilename	[in, opt] Audio file. (WAV) If nullptr, audio isn't recorded.
+ * @param rate		[in] Audio sampling rate.
+ * @param channels	[in] Number of audio channels. (1 or 2)
+ * @return 0 on success; negative errno on error.
+ */
+int AvRecorder::open(const char *videoFilename, const char *audioFilename,
+		     int rate, int channels)
+{
+	if (d->isOpen)
+		return -EBUSY;
+	if (!videoFilename && !audioFilename)
+		return -EINVAL;
+	if (audioFilename && (rate <= 0 || channels < 1 || channels > 2))
+		return -EINVAL;
+
+	// Open the output files.
+	if (videoFilename) {
+		d->fVideo = fopen(videoFilename, "wb");
+		if (!d->fVideo)
+			return -errno;
+		// Use a large buffer, since each frame is about 230 KB.
+		setvbuf(d->fVideo, nullptr, _IOFBF, 1024*1024);
+	}
+	if (audioFilename) {
+		d->fAudio = fopen(audioFilename, "wb");
+		if (!d->fAudio) {
+			int err = -errno;
+			if (d->fVideo) {
+				fclose(d->fVideo);
+				d->fVideo = nullptr;
+			}
+			return err;
+		}
+
+		// Write a placeholder WAV header.
+		// The sizes are filled in by close().
+		AvRecorderPrivate::writeWavHeader(d->fAudio, rate, channels, 0);
+	}
+
+	// Allocate the queues.
+	// This is done here so pushFrame() and
+	// pushAudio() don't have to allocate memory.
+	for (unsigned int i = 0; i < AvRecorderPrivate::FRAME_SLOTS; i++) {
+		d->frames[i].data.resize(AvRecorderPrivate::MAX_FRAME_BYTES);
+	}
+	d->audioRing.resize(AvRecorderPrivate::AUDIO_RING_SIZE);
+	d->frameHead = 0;
+	d->frameTail = 0;
+	d->audioHead = 0;
+	d->audioTail = 0;
+
+	d->rate = rate;
+	d->channels = channels;
+	d->audioBytes = 0;
+	d->error = 0;
+	d->pendingRepeat = 0;
+	d->pendingSilence = 0;
+	d->framesWritten = 0;
+	d->droppedFrames = 0;
+	d->droppedSamples = 0;
+
+	// Start the worker thread.
+	d->quit = false;
+	d->worker = std::thread(&AvRecorderPrivate::workerMain, d);
+	d->isOpen = true;
+	return 0;
+}
+
+/**
+ * Stop recording.
+ * All queued data is written before the files are closed.
+ * @return 0 on success; negative errno if a write error occurred.
+ */
+int AvRecorder::close(void)
+{
+	if (!d->isOpen)
+		return 0;
+
+	// Stop the worker thread.
+	d->quit.store(true, std::memory_order_release);
+	d->wakeCond.notify_one();
+	d->worker.join();
+	d->isOpen = false;
+
+	// Replace data that was dropped after the last queued data.
+	d->repeatFrame(d->pendingRepeat);
+	d->writeSilence(d->pendingSilence);
+	d->pendingRepeat = 0;
+	d->pendingSilence = 0;
+
+	int ret = d->error;
+	if (d->fVideo) {
+		if (fclose(d->fVideo) != 0 && ret == 0)
+			ret = -EIO;
+		d->fVideo = nullptr;
+	}
+	if (d->fAudio) {
+		// Update the WAV header.
+		if (fseek(d->fAudio, 0, SEEK_SET) == 0) {
+			int hret = AvRecorderPrivate::writeWavHeader(
+				d->fAudio, d->rate, d->channels, d->audioBytes);
+			if (hret != 0 && ret == 0)
+				ret = hret;
+		}
+		if (fclose(d->fAudio) != 0 && ret == 0)
+			ret = -EIO;
+		d->fAudio = nullptr;
+	}
+
+	// Free the queues.
+	for (unsigned int i = 0; i < AvRecorderPrivate::FRAME_SLOTS; i++) {
+		vector<uint8_t>().swap(d->frames[i].data);
+	}
+	vector<int16_t>().swap(d->audioRing);
+	return ret;
+}
+
+/**
+ * Is the recorder open?
+ * @return True if recording; false if not.
+ */
+bool AvRecorder::isOpen(void) const
+{
+	return d->isOpen;
+}
+
+/**
+ * Queue a video frame.
+ * Only the active display area is recorded.
+ * @param fb MD framebuffer.
+ * @return 0 on success; -ENOSPC if the frame was dropped; -EBADF if not recording.
+ */
+int AvRecorder::pushFrame(const MdFb *fb)
+{
+	if (!d->isOpen || !d->fVideo)
+		return -EBADF;
+
+	const unsigned int head = d->frameHead.load(std::memory_order_relaxed);
+	const unsigned int tail = d->frameTail.load(std::memory_order_acquire);
+	if (head - tail >= AvRecorderPrivate::FRAME_SLOTS) {
+		// Queue is full. Drop the frame.
+		// The previous frame will be repeated in its place.
+		d->pendingRepeat++;
+		d->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+		return -ENOSPC;
+	}
+
+	AvRecorderPrivate::FrameSlot *slot =
+		&d->frames[head & (AvRecorderPrivate::FRAME_SLOTS - 1)];
+	slot->repeat = d->pendingRepeat;
+	d->pendingRepeat = 0;
+	slot->w = fb->imgWidth();
+	slot->h = fb->imgHeight();
+	slot->bpp = fb->bpp();
+
+	// Copy the active display area.
+	const int imgXStart = fb->imgXStart();
+	const int imgYStart = fb->imgYStart();
+	const int pxSize = (slot->bpp == MdFb::BPP_32 ? 4 : 2);
+	const int rowBytes = slot->w * pxSize;
+	if (slot->data.size() < (size_t)(rowBytes * slot->h)) {
+		slot->data.resize(rowBytes * slot->h);
+	}
+	uint8_t *dest = slot->data.data();
+	for (int y = 0; y < slot->h; y++, dest += rowBytes) {
+		const void *src;
+		if (slot->bpp == MdFb::BPP_32) {
+			src = fb->lineBuf32(imgYStart + y) + imgXStart;
+		} else {
+			src = fb->lineBuf16(imgYStart + y) + imgXStart;
+		}
+		memcpy(dest, src, rowBytes);
+	}
+
+	// Queue the frame.
+	d->frameHead.store(head + 1, std::memory_order_release);
+	d->wakeCond.notify_one();
+	return 0;
+}
+
+/**
+ * Queue audio samples.
+ * If the number of channels doesn't match the recording,
+ * the samples are converted.
+ * @param buf		[in] Audio samples. (interleaved if stereo)
+ * @param samples	[in] Number of samples. (1 sample == 1 value per channel)
+ * @param channels	[in] Number of channels in buf. (1 or 2)
+ * @return 0 on success; -ENOSPC if the samples were dropped; -EBADF if not recording.
+ */
+int AvRecorder::pushAudio(const int16_t *buf, int samples, int channels)
+{
+	if (!d->isOpen || !d->fAudio)
+		return -EBADF;
+	if (samples <= 0)
+		return 0;
+
+	unsigned int head = d->audioHead.load(std::memory_order_relaxed);
+	const unsigned int tail = d->audioTail.load(std::memory_order_acquire);
+	const unsigned int count = samples * d->channels;
+	int16_t *const ring = d->audioRing.data();
+	const unsigned int mask = AvRecorderPrivate::AUDIO_RING_SIZE - 1;
+
+	// Queue silence for previously-dropped samples first,
+	// so the audio stays in sync with the video.
+	unsigned int avail = AvRecorderPrivate::AUDIO_RING_SIZE - (head - tail);
+	if (d->pendingSilence > 0) {
+		const unsigned int n = (d->pendingSilence < avail ? d->pendingSilence : avail);
+		for (unsigned int i = 0; i < n; i++, head++) {
+			ring[head & mask] = 0;
+		}
+		d->pendingSilence -= n;
+		avail -= n;
+		d->audioHead.store(head, std::memory_order_release);
+	}
+
+	if (d->pendingSilence > 0 || count > avail) {
+		// Queue is full. Drop the samples.
+		// They'll be replaced with silence.
+		d->pendingSilence += count;
+		d->droppedSamples.fetch_add(samples, std::memory_order_relaxed);
+		return -ENOSPC;
+	}
+
+	// Copy the samples, converting channels if necessary.
+	unsigned int pos = head;
+	if (channels == d->channels) {
+		for (unsigned int i = 0; i < count; i++, pos++) {
+			ring[pos & mask] = buf[i];
+		}
+	} else if (channels == 2) {
+		// Stereo to mono.
+		for (int i = 0; i < samples; i++, buf += 2, pos++) {
+			ring[pos & mask] = (int16_t)(((int)buf[0] + (int)buf[1]) >> 1);
+		}
+	} else {
+		// Mono to stereo.
+		for (int i = 0; i < samples; i++, buf++, pos += 2) {
+			ring[pos & mask] = *buf;
+			ring[(pos + 1) & mask] = *buf;
+		}
+	}
+
+	// Queue the samples.
+	d->audioHead.store(head + count, std::memory_order_release);
+	d->wakeCond.notify_one();
+	return 0;
+}
+
+/**
+ * Get the recording statistics.
+ * Statistics are reset by open().
+ * @param stats [out] Statistics.
+ */
+void AvRecorder::stats(Stats *stats) const
+{
+	stats->frames = d->framesWritten.load(std::memory_order_relaxed);
+	stats->droppedFrames = d->droppedFrames.load(std::memory_order_relaxed);
+	stats->droppedSamples = d->droppedSamples.load(std::memory_order_relaxed);
+}
+
+}
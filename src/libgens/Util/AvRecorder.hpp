@@ -0,0 +1,140 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * AvRecorder.hpp: Lossless audio/video recorder.                          *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * AvRecorder records emulated video and audio losslessly.
+ *
+ * Video is written as a stream of binary PPM (P6) images, one per
+ * frame. Each image has its own header, so H32/H40 and V28/V30
+ * changes don't need any special handling. Audio is written as a
+ * 16-bit PCM WAV file. Both can be read by most video tools, e.g.:
+ *
+ *   ffmpeg -f image2pipe -c:v ppm -framerate 59.92 -i rec.ppm -i rec.wav ...
+ *
+ * pushFrame() and pushAudio() only copy the data into preallocated
+ * single-producer/single-consumer ring buffers. A worker thread
+ * converts and writes the data. If the worker falls behind, new
+ * data is dropped and counted instead of blocking the emulation
+ * thread. Neither format has timestamps, so dropped data is replaced
+ * to keep the audio and video in sync: each dropped frame is written
+ * as a copy of the previous frame, and dropped samples are written
+ * as the same amount of silence.
+ *
+ * pushFrame() and pushAudio() must be called from the same thread.
+ */
+
+#ifndef __LIBGENS_UTIL_AVRECORDER_HPP__
+#define __LIBGENS_UTIL_AVRECORDER_HPP__
+
+// C includes.
+#include <stdint.h>
+
+namespace LibGens {
+
+class MdFb;
+
+class AvRecorderPrivate;
+class AvRecorder
+{
+	public:
+		AvRecorder();
+
+		/**
+		 * Delete the recorder.
+		 * If recording, the recording will be closed first.
+		 */
+		~AvRecorder();
+
+	protected:
+		friend class AvRecorderPrivate;
+		AvRecorderPrivate *const d;
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		AvRecorder(const AvRecorder &);
+		AvRecorder &operator=(const AvRecorder &);
+
+	public:
+		/**
+		 * Start recording.
+		 * @param videoFilename	[in, opt] Video file. (PPM stream) If nullptr, video isn't recorded.
+		 * @param audioFilename	[in, opt] Audio file. (WAV) If nullptr, audio isn't recorded.
+		 * @param rate		[in] Audio sampling rate.
+		 * @param channels	[in] Number of audio channels. (1 or 2)
+		 * @return 0 on success; negative errno on error.
+		 */
+		int open(const char *videoFilename, const char *audioFilename,
+			 int rate, int channels);
+
+		/**
+		 * Stop recording.
+		 * All queued data is written before the files are closed.
+		 * @return 0 on success; negative errno if a write error occurred.
+		 */
+		int close(void);
+
+		/**
+		 * Is the recorder open?
+		 * @return True if recording; false if not.
+		 */
+		bool isOpen(void) const;
+
+		/**
+		 * Queue a video frame.
+		 * Only the active display area is recorded.
+		 * If the frame is dropped, the previous frame is repeated.
+		 * @param fb MD framebuffer.
+		 * @return 0 on success; -ENOSPC if the frame was dropped; -EBADF if not recording.
+		 */
+		int pushFrame(const MdFb *fb);
+
+		/**
+		 * Queue audio samples.
+		 * If the number of channels doesn't match the recording,
+		 * the samples are converted.
+		 * If the samples are dropped, they're replaced with silence.
+		 * @param buf		[in] Audio samples. (interleaved if stereo)
+		 * @param samples	[in] Number of samples. (1 sample == 1 value per channel)
+		 * @param channels	[in] Number of channels in buf. (1 or 2)
+		 * @return 0 on success; -ENOSPC if the samples were dropped; -EBADF if not recording.
+		 */
+		int pushAudio(const int16_t *buf, int samples, int channels);
+
+		/**
+		 * Recording statistics.
+		 */
+		struct Stats {
+			unsigned int frames;		// Frames written, including repeated frames.
+			unsigned int droppedFrames;	// Frames dropped because the queue was full. (repeated)
+			unsigned int droppedSamples;	// Samples dropped because the queue was full. (silenced)
+		};
+
+		/**
+		 * Get the recording statistics.
+		 * Statistics are reset by open().
+		 * @param stats [out] Statistics.
+		 */
+		void stats(Stats *stats) const;
+};
+
+}
+
+#endif /* __LIBGENS_UTIL_AVRECORDER_HPP__ */
@@ -26,6 +26,9 @@
 // C includes.
 #include <stdlib.h>
 
+// C includes. (C++ namespace)
+#include <cerrno>
+
 // C++ includes.
 #include <vector>
 using std::vector;
@@ -86,6 +89,25 @@ void MdFb::reinitFb(void) {
 	}
 }
 
+/**
+ * Copy the image from another framebuffer.
+ * Both framebuffers must have the same color depth.
+ * @param src Source framebuffer.
+ * @return 0 on success; -EINVAL if the framebuffers aren't compatible.
+ */
+int MdFb::copyFrom(const MdFb *src)
+{
+	if (src->m_bpp != m_bpp || src->m_fb_sz != m_fb_sz)
+		return -EINVAL;
+
+	memcpy(m_fb, src->m_fb, m_fb_sz);
+	m_imgWidth = src->m_imgWidth;
+	m_imgHeight = src->m_imgHeight;
+	m_imgXStart = src->m_imgXStart;
+	m_imgYStart = src->m_imgYStart;
+	return 0;
+}
+
 /** Convenience functions. **/
 
 /**
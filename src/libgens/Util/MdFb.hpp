@@ -54,6 +54,14 @@ class MdFb
 		// Clear the screen.
 		void clear(void);
 
+		/**
+		 * Copy the image from another framebuffer.
+		 * Both framebuffers must have the same color depth.
+		 * @param src Source framebuffer.
+		 * @return 0 on success; -EINVAL if the framebuffers aren't compatible.
+		 */
+		int copyFrom(const MdFb *src);
+
 		// Color depth.
 		enum ColorDepth {
 			// RGB color modes.
@@ -0,0 +1,117 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * PerfCounters.cpp: Per-subsystem frame time counters.                    *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "PerfCounters.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <algorithm>
+using std::string;
+
+namespace LibGens {
+
+/** PerfCounters **/
+
+/**
+ * Get the name of a subsystem.
+ * @param subsystem Subsystem.
+ * @return Subsystem name. (ASCII)
+ */
+const char *PerfCounters::SubsystemName(Subsystem subsystem)
+{
+	static const char *const names[PERF_MAX] = {
+		"68000", "Z80", "VDP", "DMA", "YM2612", "Sound", "I/O"
+	};
+	return ((unsigned int)subsystem < PERF_MAX ? names[subsystem] : "(unknown)");
+}
+
+/** PerfHistory **/
+
+/**
+ * Clear the history.
+ */
+void PerfHistory::clear(void)
+{
+	memset(m_ns, 0, sizeof(m_ns));
+	m_pos = 0;
+	m_count = 0;
+}
+
+/**
+ * Add a frame to the history.
+ * @param perf Performance counters for the frame.
+ */
+void PerfHistory::push(const PerfCounters &perf)
+{
+	for (int i = 0; i < PerfCounters::PERF_MAX; i++) {
+		m_ns[i][m_pos] = (uint32_t)std::min<uint64_t>(perf.ns[i], UINT32_MAX);
+	}
+	m_ns[FRAME_TOTAL][m_pos] = (uint32_t)std::min<uint64_t>(perf.frame_ns, UINT32_MAX);
+
+	m_pos = (m_pos + 1) % HISTORY_SIZE;
+	if (m_count < HISTORY_SIZE)
+		m_count++;
+}
+
+/**
+ * Get a percentile for a counter.
+ * @param counter PerfCounters::Subsystem, or FRAME_TOTAL.
+ * @param pct Percentile. (0-100)
+ * @return Time at the specified percentile, in nanoseconds.
+ */
+uint64_t PerfHistory::percentile(int counter, int pct) const
+{
+	if (counter < 0 || counter > FRAME_TOTAL || m_count == 0)
+		return 0;
+
+	// The ring buffer is only filled from index 0 up
+	// until it wraps, so the first m_count entries are valid.
+	uint32_t tmp[HISTORY_SIZE];
+	memcpy(tmp, m_ns[counter], m_count * sizeof(tmp[0]));
+	const int idx = ((m_count - 1) * pct) / 100;
+	std::nth_element(&tmp[0], &tmp[idx], &tmp[m_count]);
+	return tmp[idx];
+}
+
+/**
+ * Format a one-line-per-counter summary of the history.
+ * Each line has the p50 and p99 times in microseconds.
+ * @return Summary. (ASCII)
+ */
+string PerfHistory::summary(void) const
+{
+	string ret;
+	char buf[64];
+	for (int i = 0; i <= FRAME_TOTAL; i++) {
+		const char *name = (i == FRAME_TOTAL
+			? "Frame"
+			: PerfCounters::SubsystemName((PerfCounters::Subsystem)i));
+		snprintf(buf, sizeof(buf), "%-6s p50 %5u us, p99 %5u us\n", name,
+			 (unsigned int)(percentile(i, 50) / 1000),
+			 (unsigned int)(percentile(i, 99) / 1000));
+		ret += buf;
+	}
+	return ret;
+}
+
+}
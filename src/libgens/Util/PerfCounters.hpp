@@ -0,0 +1,144 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * PerfCounters.hpp: Per-subsystem frame time counters.                    *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __LIBGENS_UTIL_PERFCOUNTERS_HPP__
+#define __LIBGENS_UTIL_PERFCOUNTERS_HPP__
+
+// C includes.
+#include <stdint.h>
+#include <string.h>
+
+// C++ includes.
+#include <string>
+
+namespace LibGens {
+
+/**
+ * Time spent in each emulation subsystem during the last frame.
+ * Updated by EmuContext::execFrame() if enabled.
+ */
+struct PerfCounters
+{
+	enum Subsystem {
+		PERF_M68K		= 0,	// M68K::Exec()
+		PERF_Z80		= 1,	// Z80::Exec()
+		PERF_VDP_RENDER		= 2,	// Vdp::renderLine()
+		PERF_VDP_DMA		= 3,	// Vdp::updateDMA()
+		PERF_YM2612		= 4,	// Ym2612::updateDacAndTimers()
+		PERF_SOUND_UPDATE	= 5,	// SoundMgr::SpecialUpdate()
+		PERF_IO			= 6,	// IoManager::doScanline()
+
+		PERF_MAX
+	};
+
+	// Time spent in each subsystem, in nanoseconds.
+	uint64_t ns[PERF_MAX];
+
+	// Total frame time, in nanoseconds.
+	// This includes time not accounted for by any subsystem.
+	uint64_t frame_ns;
+
+	// Cycle counts.
+	unsigned int cycles_m68k;	// 68000 odometer, including DMA.
+	unsigned int cycles_z80;	// Z80 odometer.
+	unsigned int cycles_dma;	// 68000 cycles taken by DMA.
+
+	PerfCounters() { clear(); }
+
+	/**
+	 * Clear the counters.
+	 */
+	inline void clear(void)
+	{
+		memset(ns, 0, sizeof(ns));
+		frame_ns = 0;
+		cycles_m68k = 0;
+		cycles_z80 = 0;
+		cycles_dma = 0;
+	}
+
+	/**
+	 * Get the name of a subsystem.
+	 * @param subsystem Subsystem.
+	 * @return Subsystem name. (ASCII)
+	 */
+	static const char *SubsystemName(Subsystem subsystem);
+};
+
+/**
+ * Rolling history of PerfCounters.
+ * Used to calculate percentiles over the last HISTORY_SIZE frames.
+ */
+class PerfHistory
+{
+	public:
+		PerfHistory() { clear(); }
+
+		// Number of frames in the history.
+		static const int HISTORY_SIZE = 256;
+
+		// Counter index for the total frame time.
+		// Other counter indexes are PerfCounters::Subsystem.
+		static const int FRAME_TOTAL = PerfCounters::PERF_MAX;
+
+		/**
+		 * Clear the history.
+		 */
+		void clear(void);
+
+		/**
+		 * Add a frame to the history.
+		 * @param perf Performance counters for the frame.
+		 */
+		void push(const PerfCounters &perf);
+
+		/**
+		 * Get the number of frames in the history.
+		 * @return Number of frames. (at most HISTORY_SIZE)
+		 */
+		inline int count(void) const
+			{ return m_count; }
+
+		/**
+		 * Get a percentile for a counter.
+		 * @param counter PerfCounters::Subsystem, or FRAME_TOTAL.
+		 * @param pct Percentile. (0-100)
+		 * @return Time at the specified percentile, in nanoseconds.
+		 */
+		uint64_t percentile(int counter, int pct) const;
+
+		/**
+		 * Format a one-line-per-counter summary of the history.
+		 * Each line has the p50 and p99 times in microseconds.
+		 * @return Summary. (ASCII)
+		 */
+		std::string summary(void) const;
+
+	private:
+		// Times are stored as 32-bit nanoseconds. (max ~4.29s)
+		uint32_t m_ns[PerfCounters::PERF_MAX + 1][HISTORY_SIZE];
+		int m_pos;
+		int m_count;
+};
+
+}
+
+#endif /* __LIBGENS_UTIL_PERFCOUNTERS_HPP__ */
@@ -0,0 +1,327 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * RewindBuffer.cpp: Rewind buffer.                                        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "RewindBuffer.hpp"
+#include "EmuContext/EmuContext.hpp"
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+namespace LibGens {
+
+/**
+ * Create a rewind buffer.
+ * @param maxBytes Maximum amount of memory to use for snapshots.
+ * @param interval Number of frames between snapshots.
+ * @param keyframeInterval Number of snapshots between keyframes.
+ */
+RewindBuffer::RewindBuffer(size_t maxBytes, int interval, int keyframeInterval)
+	: m_maxBytes(maxBytes)
+	, m_used(0)
+	, m_interval(interval > 0 ? interval : 1)
+	, m_frames(0)
+	, m_keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1)
+	, m_sinceKeyframe(0)
+{ }
+
+RewindBuffer::~RewindBuffer()
+{ }
+
+/**
+ * Clear the rewind buffer.
+ */
+void RewindBuffer::clear(void)
+{
+	m_entries.clear();
+	m_used = 0;
+	m_frames = 0;
+	m_sinceKeyframe = 0;
+}
+
+/**
+ * Capture the emulation state.
+ * Call this once per emulated frame. A snapshot is
+ * only saved every interval() frames.
+ * @param context Emulation context.
+ * @return 1 if a snapshot was saved; 0 if not; negative errno on error.
+ */
+int RewindBuffer::capture(const EmuContext *context)
+{
+	if (++m_frames < m_interval)
+		return 0;
+	m_frames = 0;
+
+	// The snapshot size is constant for a given ROM,
+	// so the buffer only needs to be resized once.
+	int ret = -ENOSPC;
+	if (!m_snapshot.empty()) {
+		ret = context->saveSnapshot(m_snapshot.data(), m_snapshot.size());
+	}
+	if (ret == -ENOSPC) {
+		ret = context->saveSnapshot(nullptr, 0);
+		if (ret <= 0)
+			return ret;
+		m_snapshot.resize(ret);
+		ret = context->saveSnapshot(m_snapshot.data(), m_snapshot.size());
+	}
+	if (ret <= 0)
+		return ret;
+
+	ret = push(m_snapshot.data(), (size_t)ret);
+	return (ret == 0 ? 1 : ret);
+}
+
+/**
+ * Rewind the emulation state by one snapshot.
+ * The snapshot is removed from the rewind buffer.
+ * @param context Emulation context.
+ * @return 0 on success; -ENOENT if the rewind buffer is empty; other negative errno on error.
+ */
+int RewindBuffer::rewind(EmuContext *context)
+{
+	const uint8_t *snapshot;
+	int ret = pop(&snapshot);
+	if (ret < 0)
+		return ret;
+	return context->loadSnapshot(snapshot, (size_t)ret);
+}
+
+/**
+ * Add a snapshot to the rewind buffer.
+ * @param snapshot Snapshot.
+ * @param siz Size of snapshot.
+ * @return 0 on success; negative errno on error.
+ */
+int RewindBuffer::push(const uint8_t *snapshot, size_t siz)
+{
+	// Snapshots are always a multiple of 8 bytes.
+	// (See ZomgSnapshot.)
+	if (siz == 0 || siz % sizeof(uint32_t) != 0)
+		return -EINVAL;
+
+	m_entries.push_back(Entry());
+	Entry &entry = m_entries.back();
+	entry.siz = (uint32_t)siz;
+
+	// NOTE: lastKeyframe() skips the new entry,
+	// since it isn't a keyframe yet.
+	entry.keyframe = false;
+	const Entry *key = lastKeyframe();
+	if (key && key->siz == siz && m_sinceKeyframe < m_keyframeInterval) {
+		// Encode a delta against the last keyframe.
+		// NOTE: std::vector data is suitably aligned for uint32_t.
+		encodeDelta(reinterpret_cast<const uint32_t*>(snapshot),
+			    reinterpret_cast<const uint32_t*>(key->data.data()),
+			    siz / sizeof(uint32_t));
+
+		// If most of the state changed, a keyframe is
+		// smaller and makes the next deltas smaller too.
+		const size_t deltaSiz = m_delta.size() * sizeof(uint32_t);
+		if (deltaSiz < (siz / 2)) {
+			const uint8_t *const delta = reinterpret_cast<const uint8_t*>(m_delta.data());
+			entry.data.assign(delta, delta + deltaSiz);
+			m_sinceKeyframe++;
+		} else {
+			entry.keyframe = true;
+		}
+	} else {
+		entry.keyframe = true;
+	}
+
+	if (entry.keyframe) {
+		entry.data.assign(snapshot, snapshot + siz);
+		m_sinceKeyframe = 0;
+	}
+
+	m_used += entry.data.size();
+	evict();
+	return 0;
+}
+
+/**
+ * Remove the most recent snapshot from the rewind buffer.
+ * @param pSnapshot [out] Snapshot. Valid until the next call to any RewindBuffer function.
+ * @return Size of the snapshot on success; -ENOENT if the rewind buffer is empty.
+ */
+int RewindBuffer::pop(const uint8_t **pSnapshot)
+{
+	if (m_entries.empty())
+		return -ENOENT;
+
+	Entry &entry = m_entries.back();
+	if (entry.keyframe) {
+		// Keyframes are stored as-is.
+		m_snapshot.swap(entry.data);
+	} else {
+		// Apply the delta to the last keyframe.
+		const Entry *key = lastKeyframe();
+		assert(key != nullptr);
+		assert(key->siz == entry.siz);
+		m_snapshot.assign(key->data.begin(), key->data.end());
+		int ret = decodeDelta(reinterpret_cast<uint32_t*>(m_snapshot.data()),
+				      m_snapshot.size() / sizeof(uint32_t),
+				      reinterpret_cast<const uint32_t*>(entry.data.data()),
+				      entry.data.size() / sizeof(uint32_t));
+		if (ret != 0) {
+			// Delta is corrupted. Discard everything.
+			clear();
+			return ret;
+		}
+	}
+
+	const bool wasKeyframe = entry.keyframe;
+	m_used -= (wasKeyframe ? m_snapshot.size() : entry.data.size());
+	m_entries.pop_back();
+
+	// Recalculate the number of snapshots since the last keyframe.
+	if (wasKeyframe) {
+		m_sinceKeyframe = 0;
+		for (std::deque<Entry>::const_reverse_iterator iter = m_entries.rbegin();
+		     iter != m_entries.rend() && !iter->keyframe; ++iter)
+		{
+			m_sinceKeyframe++;
+		}
+	} else {
+		m_sinceKeyframe--;
+	}
+
+	// Restart the capture interval.
+	m_frames = 0;
+
+	*pSnapshot = m_snapshot.data();
+	return (int)m_snapshot.size();
+}
+
+/**
+ * Find the most recent keyframe.
+ * @return Most recent keyframe, or nullptr if the rewind buffer is empty.
+ */
+const RewindBuffer::Entry *RewindBuffer::lastKeyframe(void) const
+{
+	for (std::deque<Entry>::const_reverse_iterator iter = m_entries.rbegin();
+	     iter != m_entries.rend(); ++iter)
+	{
+		if (iter->keyframe)
+			return &(*iter);
+	}
+	return nullptr;
+}
+
+/**
+ * Discard old entries until the rewind buffer fits in m_maxBytes.
+ * The most recent keyframe and its deltas are never discarded.
+ */
+void RewindBuffer::evict(void)
+{
+	while (m_used > m_maxBytes) {
+		// The first entry is always a keyframe.
+		// Find the next keyframe.
+		size_t next = 1;
+		while (next < m_entries.size() && !m_entries[next].keyframe) {
+			next++;
+		}
+		if (next >= m_entries.size()) {
+			// Only one keyframe is left.
+			break;
+		}
+
+		// Discard the oldest keyframe and its deltas.
+		for (; next > 0; next--) {
+			m_used -= m_entries.front().data.size();
+			m_entries.pop_front();
+		}
+	}
+}
+
+/**
+ * Encode a delta.
+ * @param cur Current snapshot.
+ * @param key Keyframe.
+ * @param words Size of both snapshots, in 32-bit words.
+ */
+void RewindBuffer::encodeDelta(const uint32_t *cur, const uint32_t *key, size_t words)
+{
+	m_delta.clear();
+
+	size_t i = 0;
+	while (i < words) {
+		// Unchanged words.
+		const size_t same_start = i;
+		while (i < words && cur[i] == key[i]) {
+			i++;
+		}
+
+		// Changed words.
+		// A single unchanged word is included in the
+		// changed run, since a new token would be larger.
+		const size_t diff_start = i;
+		while (i < words) {
+			if (cur[i] == key[i] &&
+			    (i + 1 >= words || cur[i+1] == key[i+1]))
+			{
+				break;
+			}
+			i++;
+		}
+
+		m_delta.push_back((uint32_t)(diff_start - same_start));
+		m_delta.push_back((uint32_t)(i - diff_start));
+		for (size_t j = diff_start; j < i; j++) {
+			m_delta.push_back(cur[j] ^ key[j]);
+		}
+	}
+}
+
+/**
+ * Decode a delta.
+ * @param out [out] Snapshot. Must be initialized with the keyframe.
+ * @param words Size of out, in 32-bit words.
+ * @param delta Delta.
+ * @param deltaWords Size of delta, in 32-bit words.
+ * @return 0 on success; -EINVAL if the delta is corrupted.
+ */
+int RewindBuffer::decodeDelta(uint32_t *out, size_t words,
+			      const uint32_t *delta, size_t deltaWords)
+{
+	const uint32_t *const delta_end = delta + deltaWords;
+	size_t pos = 0;
+	while (delta_end - delta >= 2) {
+		const uint32_t same = delta[0];
+		const uint32_t diff = delta[1];
+		delta += 2;
+
+		pos += same;
+		if (pos > words || diff > words - pos ||
+		    diff > (size_t)(delta_end - delta))
+		{
+			return -EINVAL;
+		}
+		for (uint32_t j = 0; j < diff; j++) {
+			out[pos++] ^= *delta++;
+		}
+	}
+
+	return (delta == delta_end && pos == words ? 0 : -EINVAL);
+}
+
+}
@@ -0,0 +1,194 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * RewindBuffer.hpp: Rewind buffer.                                        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * RewindBuffer stores a bounded history of in-memory snapshots.
+ * (See EmuContext::saveSnapshot().)
+ *
+ * Most entries are deltas: the snapshot is XORed with the most
+ * recent keyframe, and runs of unchanged 32-bit words are skipped.
+ * Most of the machine state doesn't change from frame to frame,
+ * so deltas are usually a few KB, compared to ~150 KB for a
+ * full MD snapshot.
+ *
+ * When the buffer is full, the oldest keyframe and its deltas
+ * are discarded.
+ */
+
+#ifndef __LIBGENS_UTIL_REWINDBUFFER_HPP__
+#define __LIBGENS_UTIL_REWINDBUFFER_HPP__
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstddef>
+
+// C++ includes.
+#include <deque>
+#include <vector>
+
+namespace LibGens {
+
+class EmuContext;
+
+class RewindBuffer
+{
+	public:
+		/**
+		 * Create a rewind buffer.
+		 * @param maxBytes Maximum amount of memory to use for snapshots.
+		 * @param interval Number of frames between snapshots.
+		 * @param keyframeInterval Number of snapshots between keyframes.
+		 */
+		RewindBuffer(size_t maxBytes = (32*1024*1024),
+			     int interval = 2, int keyframeInterval = 60);
+		~RewindBuffer();
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		RewindBuffer(const RewindBuffer &);
+		RewindBuffer &operator=(const RewindBuffer &);
+
+	public:
+		/**
+		 * Clear the rewind buffer.
+		 */
+		void clear(void);
+
+		/**
+		 * Capture the emulation state.
+		 * Call this once per emulated frame. A snapshot is
+		 * only saved every interval() frames.
+		 * @param context Emulation context.
+		 * @return 1 if a snapshot was saved; 0 if not; negative errno on error.
+		 */
+		int capture(const EmuContext *context);
+
+		/**
+		 * Rewind the emulation state by one snapshot.
+		 * The snapshot is removed from the rewind buffer.
+		 * @param context Emulation context.
+		 * @return 0 on success; -ENOENT if the rewind buffer is empty; other negative errno on error.
+		 */
+		int rewind(EmuContext *context);
+
+		/**
+		 * Add a snapshot to the rewind buffer.
+		 * @param snapshot Snapshot.
+		 * @param siz Size of snapshot.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int push(const uint8_t *snapshot, size_t siz);
+
+		/**
+		 * Remove the most recent snapshot from the rewind buffer.
+		 * @param pSnapshot [out] Snapshot. Valid until the next call to any RewindBuffer function.
+		 * @return Size of the snapshot on success; -ENOENT if the rewind buffer is empty.
+		 */
+		int pop(const uint8_t **pSnapshot);
+
+		/**
+		 * Get the number of snapshots in the rewind buffer.
+		 * @return Number of snapshots.
+		 */
+		inline size_t count(void) const
+			{ return m_entries.size(); }
+
+		/**
+		 * Get the amount of memory used by snapshots.
+		 * @return Memory used, in bytes.
+		 */
+		inline size_t used(void) const
+			{ return m_used; }
+
+		/**
+		 * Get the number of frames between snapshots.
+		 * @return Number of frames between snapshots.
+		 */
+		inline int interval(void) const
+			{ return m_interval; }
+
+	private:
+		struct Entry {
+			// Size of the decoded snapshot.
+			uint32_t siz;
+			// If true, data contains the full snapshot.
+			// Otherwise, data contains a delta against the
+			// most recent keyframe before this entry.
+			bool keyframe;
+			std::vector<uint8_t> data;
+		};
+		std::deque<Entry> m_entries;
+
+		/**
+		 * Find the most recent keyframe.
+		 * @return Most recent keyframe, or nullptr if the rewind buffer is empty.
+		 */
+		const Entry *lastKeyframe(void) const;
+
+		/**
+		 * Discard old entries until the rewind buffer fits in m_maxBytes.
+		 * The most recent keyframe and its deltas are never discarded.
+		 */
+		void evict(void);
+
+		/**
+		 * Encode a delta.
+		 * Delta format: a series of uint32_t tokens.
+		 * - Number of unchanged words.
+		 * - Number of changed words. (n)
+		 * - n words, XORed with the keyframe.
+		 * @param cur Current snapshot.
+		 * @param key Keyframe.
+		 * @param words Size of both snapshots, in 32-bit words.
+		 */
+		void encodeDelta(const uint32_t *cur, const uint32_t *key, size_t words);
+
+		/**
+		 * Decode a delta.
+		 * @param out [out] Snapshot. Must be initialized with the keyframe.
+		 * @param words Size of out, in 32-bit words.
+		 * @param delta Delta.
+		 * @param deltaWords Size of delta, in 32-bit words.
+		 * @return 0 on success; -EINVAL if the delta is corrupted.
+		 */
+		static int decodeDelta(uint32_t *out, size_t words,
+				       const uint32_t *delta, size_t deltaWords);
+
+		size_t m_maxBytes;	// Maximum memory usage.
+		size_t m_used;		// Current memory usage.
+
+		int m_interval;		// Frames between snapshots.
+		int m_frames;		// Frames since the last snapshot.
+
+		int m_keyframeInterval;	// Snapshots between keyframes.
+		int m_sinceKeyframe;	// Snapshots since the last keyframe.
+
+		// Scratch buffers.
+		std::vector<uint8_t> m_snapshot;	// Current snapshot.
+		std::vector<uint32_t> m_delta;		// Delta being encoded.
+};
+
+}
+
+#endif /* __LIBGENS_UTIL_REWINDBUFFER_HPP__ */
@@ -0,0 +1,544 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * RunAhead.cpp: Run-ahead input latency reduction.                        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include <libgens/config.libgens.h>
+
+#include "RunAhead.hpp"
+#include "MdFb.hpp"
+#include "EmuContext/EmuContext.hpp"
+#include "IO/IoManager.hpp"
+#include "Vdp/Vdp.hpp"
+#include "sound/SoundMgr.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LibGens {
+
+class RunAheadPrivate
+{
+	public:
+		RunAheadPrivate(EmuContext *context, int frames);
+		~RunAheadPrivate();
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		RunAheadPrivate(const RunAheadPrivate &);
+		RunAheadPrivate &operator=(const RunAheadPrivate &);
+
+	public:
+		EmuContext *const context;	// Primary context.
+		int frames;			// Number of frames to run ahead.
+
+		// Snapshot of the primary context.
+		// In threaded mode, this is owned by the worker
+		// thread while a job is in flight.
+		std::vector<uint8_t> snapshot;
+
+		/**
+		 * Save a snapshot of the primary context.
+		 * @return Snapshot size on success; negative errno on error.
+		 */
+		int saveSnapshot(void);
+
+		/**
+		 * Check that snapshots restore the complete state.
+		 * The current state is saved, loaded into the context
+		 * that runs the hidden frames, and saved again.
+		 * The two snapshots must be identical.
+		 * @return True if the snapshots are identical.
+		 */
+		bool checkRoundTrip(void);
+
+		// Has checkRoundTrip() been run?
+		bool roundTripChecked;
+
+		/**
+		 * Run a frame in single-instance mode.
+		 */
+		void execFrameSingle(void);
+
+		// Audio segment from the real frame.
+		// The hidden frames add to the segment buffers,
+		// so the real frame's audio is restored afterwards.
+		int32_t segBufL[SoundMgr::MAX_SEGMENT_SIZE];
+		int32_t segBufR[SoundMgr::MAX_SEGMENT_SIZE];
+
+		/** Threaded mode. **/
+
+		/**
+		 * Run a frame in threaded mode.
+		 */
+		void execFrameThreaded(void);
+
+		/**
+		 * Start the worker thread.
+		 * @param secondary Secondary context.
+		 */
+		void startWorker(EmuContext *secondary);
+
+		/**
+		 * Stop the worker thread and delete the secondary context.
+		 */
+		void stopWorker(void);
+
+		/**
+		 * Wait for the current job to finish.
+		 * Main thread only.
+		 * @return True if the job succeeded; false on error.
+		 */
+		bool waitForJob(void);
+
+		/**
+		 * Worker thread function.
+		 */
+		void workerMain(void);
+
+		EmuContext *secondary;		// Secondary context.
+		std::thread worker;
+		std::mutex mutex;
+		std::condition_variable cond;
+
+		// Main thread only.
+		bool inFlight;		// Was a job started?
+
+		// Protected by mutex.
+		bool jobStart;		// Job is ready to start.
+		bool jobDone;		// Job has finished.
+		bool jobOk;		// Did the job succeed?
+		bool quit;		// Worker thread should exit.
+		int jobSiz;		// Snapshot size.
+		int jobFrames;		// Number of frames to run.
+};
+
+/** RunAheadPrivate **/
+
+RunAheadPrivate::RunAheadPrivate(EmuContext *context, int frames)
+	: context(context)
+	, frames(frames > 0 ? frames : 0)
+	, roundTripChecked(false)
+	, secondary(nullptr)
+	, inFlight(false)
+	, jobStart(false)
+	, jobDone(false)
+	, jobOk(false)
+	, quit(false)
+	, jobSiz(0)
+	, jobFrames(0)
+{ }
+
+RunAheadPrivate::~RunAheadPrivate()
+{
+	stopWorker();
+}
+
+/**
+ * Save a snapshot of the primary context.
+ * @return Snapshot size on success; negative errno on error.
+ */
+int RunAheadPrivate::saveSnapshot(void)
+{
+	// The snapshot size is constant for a given ROM,
+	// so the buffer only needs to be resized once.
+	int ret = -ENOSPC;
+	if (!snapshot.empty()) {
+		ret = context->saveSnapshot(snapshot.data(), snapshot.size());
+	}
+	if (ret == -ENOSPC) {
+		ret = context->saveSnapshot(nullptr, 0);
+		if (ret <= 0)
+			return (ret == 0 ? -EIO : ret);
+		snapshot.resize(ret);
+		ret = context->saveSnapshot(snapshot.data(), snapshot.size());
+	}
+	return ret;
+}
+
+/**
+ * Check that snapshots restore the complete state.
+ * The current state is saved, loaded into the context
+ * that runs the hidden frames, and saved again.
+ * The two snapshots must be identical.
+ * @return True if the snapshots are identical.
+ */
+bool RunAheadPrivate::checkRoundTrip(void)
+{
+	if (inFlight) {
+		// Discard the hidden frames.
+		// The worker thread owns the snapshot buffer.
+		waitForJob();
+		inFlight = false;
+	}
+
+	const int siz = saveSnapshot();
+	if (siz <= 0)
+		return false;
+
+	// NOTE: The worker thread is idle, so the secondary
+	// context can be used on this thread.
+	EmuContext *const target = (secondary ? secondary : context);
+	std::vector<uint8_t> check(siz);
+	bool ok = (target->loadSnapshot(snapshot.data(), siz) == 0 &&
+		   target->saveSnapshot(check.data(), check.size()) == siz &&
+		   !memcmp(snapshot.data(), check.data(), siz));
+
+	// Rebind the primary context.
+	context->makeCurrent();
+	return ok;
+}
+
+/**
+ * Run a frame in single-instance mode.
+ */
+void RunAheadPrivate::execFrameSingle(void)
+{
+	// Run the real frame.
+	// Nothing is rendered, since the displayed image
+	// is taken from the last hidden frame.
+	context->execFrameFast();
+
+	const int siz = saveSnapshot();
+	if (siz <= 0) {
+		// Unable to save a snapshot.
+		// Disable run-ahead. This frame won't be displayed.
+		frames = 0;
+		return;
+	}
+
+	// Save the real frame's audio.
+	// NOTE: execFrameFast() bound the primary context's state.
+	SoundMgr::State *const snd = SoundMgr::ms_State;
+	memcpy(segBufL, snd->segBufL, sizeof(segBufL));
+	memcpy(segBufR, snd->segBufR, sizeof(segBufR));
+
+	// Detach the VGM logger while running the hidden frames.
+	// Only the real frames should be logged.
+	VgmLogger *const vgmLogger = snd->vgmLogger;
+	snd->vgmLogger = nullptr;
+
+	// Run the hidden frames.
+	// Only the last one needs to be rendered.
+	for (int i = frames - 1; i > 0; i--) {
+		context->execFrameFast();
+	}
+	context->execFrame();
+
+	// Restore the real state and audio.
+	// MD_Screen isn't part of the snapshot,
+	// so the last hidden frame is displayed.
+	context->loadSnapshot(snapshot.data(), siz);
+	memcpy(snd->segBufL, segBufL, sizeof(segBufL));
+	memcpy(snd->segBufR, segBufR, sizeof(segBufR));
+	snd->vgmLogger = vgmLogger;
+}
+
+/**
+ * Run a frame in threaded mode.
+ *
+ * The worker thread runs the hidden frames for the previous
+ * frame while the main thread runs the current real frame.
+ * Since the hidden frames are displayed one frame later,
+ * the worker runs one extra hidden frame to make up for it.
+ */
+void RunAheadPrivate::execFrameThreaded(void)
+{
+	MdFb *const fb = context->m_vdp->MD_Screen;
+	if (inFlight) {
+		// The hidden frames will be displayed,
+		// so the real frame doesn't need to be rendered.
+		context->execFrameFast();
+		inFlight = false;
+		if (waitForJob()) {
+			// NOTE: If the color depth was changed by the frontend,
+			// this will fail, and the next job will use the new depth.
+			fb->copyFrom(secondary->m_vdp->MD_Screen);
+		}
+	} else {
+		// No hidden frames are available.
+		context->execFrame();
+	}
+
+	const int siz = saveSnapshot();
+	if (siz <= 0) {
+		// Unable to save a snapshot.
+		// Try again next frame.
+		return;
+	}
+
+	// Copy the current settings to the secondary context.
+	// The worker thread is idle, so this is safe.
+	secondary->m_ioManager->copyInput(context->m_ioManager);
+	secondary->m_vdp->options = context->m_vdp->options;
+	secondary->m_vdp->MD_Screen->setBpp(fb->bpp());
+
+	// Start the next job.
+	std::unique_lock<std::mutex> lock(mutex);
+	jobStart = true;
+	jobDone = false;
+	jobSiz = siz;
+	jobFrames = frames + 1;
+	inFlight = true;
+	cond.notify_all();
+}
+
+/**
+ * Start the worker thread.
+ * @param secondary Secondary context.
+ */
+void RunAheadPrivate::startWorker(EmuContext *secondary)
+{
+	this->secondary = secondary;
+	jobStart = false;
+	jobDone = false;
+	quit = false;
+	inFlight = false;
+	worker = std::thread(&RunAheadPrivate::workerMain, this);
+}
+
+/**
+ * Stop the worker thread and delete the secondary context.
+ */
+void RunAheadPrivate::stopWorker(void)
+{
+	if (!secondary)
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		quit = true;
+		cond.notify_all();
+	}
+	worker.join();
+	inFlight = false;
+
+	// Deleting the secondary context unbinds the
+	// emulation state on this thread, so rebind
+	// the primary context afterwards.
+	delete secondary;
+	secondary = nullptr;
+	context->makeCurrent();
+}
+
+/**
+ * Wait for the current job to finish.
+ * Main thread only.
+ * @return True if the job succeeded; false on error.
+ */
+bool RunAheadPrivate::waitForJob(void)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!jobDone) {
+		cond.wait(lock);
+	}
+	return jobOk;
+}
+
+/**
+ * Worker thread function.
+ */
+void RunAheadPrivate::workerMain(void)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		while (!jobStart && !quit) {
+			cond.wait(lock);
+		}
+		if (quit)
+			break;
+
+		jobStart = false;
+		const int siz = jobSiz;
+		const int n = jobFrames;
+		lock.unlock();
+
+		// Load the primary context's state and run the hidden frames.
+		// NOTE: loadSnapshot() binds the secondary context to this thread.
+		bool ok = (secondary->loadSnapshot(snapshot.data(), siz) == 0);
+		if (ok) {
+			for (int i = n - 1; i > 0; i--) {
+				secondary->execFrameFast();
+			}
+			secondary->execFrame();
+
+			// The secondary context's audio is never played.
+			// Clear it so the additive segment buffers don't overflow.
+			SoundMgr::State *const snd = SoundMgr::ms_State;
+			memset(snd->segBufL, 0, sizeof(snd->segBufL));
+			memset(snd->segBufR, 0, sizeof(snd->segBufR));
+		}
+
+		lock.lock();
+		jobOk = ok;
+		jobDone = true;
+		cond.notify_all();
+	}
+}
+
+/** RunAhead **/
+
+/**
+ * Create a run-ahead manager.
+ * @param context Emulation context.
+ * @param frames Number of frames to run ahead.
+ */
+RunAhead::RunAhead(EmuContext *context, int frames)
+	: d(new RunAheadPrivate(context, frames))
+{ }
+
+/**
+ * Delete the run-ahead manager.
+ * This must be done before the primary context is deleted.
+ */
+RunAhead::~RunAhead()
+{
+	delete d;
+}
+
+/**
+ * Get the number of frames to run ahead.
+ * @return Number of frames to run ahead. (0 == disabled)
+ */
+int RunAhead::frames(void) const
+{
+	return d->frames;
+}
+
+/**
+ * Set the number of frames to run ahead.
+ * @param frames Number of frames to run ahead. (0 == disabled)
+ */
+void RunAhead::setFrames(int frames)
+{
+	if (d->frames <= 0 && frames > 0) {
+		// Run-ahead is being re-enabled.
+		// Check the snapshots again.
+		d->roundTripChecked = false;
+	}
+	d->frames = (frames > 0 ? frames : 0);
+}
+
+/**
+ * Is threaded mode supported?
+ * Threaded mode requires two emulation contexts,
+ * which requires the portable CPU cores.
+ * @return True if threaded mode is supported.
+ */
+bool RunAhead::IsThreadedModeSupported(void)
+{
+#if defined(USE_PORTABLE_M68K) && defined(USE_PORTABLE_Z80)
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Is threaded mode enabled?
+ * @return True if the hidden frames are run on a second context.
+ */
+bool RunAhead::isThreaded(void) const
+{
+	return (d->secondary != nullptr);
+}
+
+/**
+ * Enable threaded mode.
+ * The secondary context must be created from the same ROM
+ * and region as the primary context. RunAhead takes ownership
+ * of the secondary context, even if an error occurs.
+ * @param secondary Secondary context, or nullptr to disable threaded mode.
+ * @return 0 on success; -ENOTSUP if threaded mode isn't supported.
+ */
+int RunAhead::setSecondary(EmuContext *secondary)
+{
+	d->stopWorker();
+	if (!secondary)
+		return 0;
+
+	if (!IsThreadedModeSupported()) {
+		delete secondary;
+		d->context->makeCurrent();
+		return -ENOTSUP;
+	}
+
+	// Creating the secondary context bound it to this thread.
+	d->context->makeCurrent();
+	d->startWorker(secondary);
+
+	// Snapshots have to be checked with the secondary context.
+	d->roundTripChecked = false;
+	return 0;
+}
+
+/**
+ * Run a frame of emulation.
+ * If run-ahead is enabled, the displayed image
+ * will be frames() frames ahead of the emulated state.
+ */
+void RunAhead::execFrame(void)
+{
+	if (d->frames > 0 && !d->roundTripChecked) {
+		// If snapshots don't restore the complete state,
+		// the real frames would diverge from normal emulation.
+		d->roundTripChecked = true;
+		if (!d->checkRoundTrip()) {
+			d->frames = 0;
+		}
+	}
+
+	if (d->frames <= 0) {
+		if (d->inFlight) {
+			// Discard the hidden frames.
+			d->waitForJob();
+			d->inFlight = false;
+		}
+		d->context->execFrame();
+	} else if (d->secondary) {
+		d->execFrameThreaded();
+	} else {
+		d->execFrameSingle();
+	}
+}
+
+/**
+ * Run a frame of emulation without rendering.
+ * Nothing is displayed, so this doesn't run ahead.
+ */
+void RunAhead::execFrameFast(void)
+{
+	if (d->inFlight) {
+		// Discard the hidden frames.
+		// They'll be out of date by the next full frame.
+		d->waitForJob();
+		d->inFlight = false;
+	}
+	d->context->execFrameFast();
+}
+
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * RunAhead.hpp: Run-ahead input latency reduction.                        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * RunAhead hides the input latency built into most games.
+ *
+ * Many games don't react to input until one or two frames after
+ * the button is pressed. Each frame, RunAhead runs the real frame,
+ * saves a snapshot, runs frames() more frames with the same input,
+ * and displays the last one. The snapshot is then restored, so the
+ * hidden frames never affect the emulated state or the audio.
+ *
+ * Single-instance mode runs everything on the calling thread.
+ *
+ * Threaded mode runs the hidden frames on a second EmuContext
+ * in a worker thread, in parallel with the next real frame.
+ * The hidden frames are displayed one frame later, so the
+ * worker runs one extra hidden frame to make up for it.
+ * Threaded mode requires the portable CPU cores.
+ *
+ * Run-ahead is only correct if a snapshot restores the complete
+ * emulated state. Before the first hidden frame, RunAhead loads
+ * a snapshot and saves it again; if the two snapshots differ,
+ * run-ahead is disabled and frames() returns 0.
+ */
+
+#ifndef __LIBGENS_UTIL_RUNAHEAD_HPP__
+#define __LIBGENS_UTIL_RUNAHEAD_HPP__
+
+namespace LibGens {
+
+class EmuContext;
+
+class RunAheadPrivate;
+class RunAhead
+{
+	public:
+		/**
+		 * Create a run-ahead manager.
+		 * @param context Emulation context.
+		 * @param frames Number of frames to run ahead.
+		 */
+		RunAhead(EmuContext *context, int frames = 1);
+
+		/**
+		 * Delete the run-ahead manager.
+		 * This must be done before the primary context is deleted.
+		 */
+		~RunAhead();
+
+	protected:
+		friend class RunAheadPrivate;
+		RunAheadPrivate *const d;
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		RunAhead(const RunAhead &);
+		RunAhead &operator=(const RunAhead &);
+
+	public:
+		/**
+		 * Get the number of frames to run ahead.
+		 * This is 0 if run-ahead was disabled because
+		 * snapshots can't restore the complete state.
+		 * @return Number of frames to run ahead. (0 == disabled)
+		 */
+		int frames(void) const;
+
+		/**
+		 * Set the number of frames to run ahead.
+		 * @param frames Number of frames to run ahead. (0 == disabled)
+		 */
+		void setFrames(int frames);
+
+		/**
+		 * Is threaded mode supported?
+		 * Threaded mode requires two emulation contexts,
+		 * which requires the portable CPU cores.
+		 * @return True if threaded mode is supported.
+		 */
+		static bool IsThreadedModeSupported(void);
+
+		/**
+		 * Is threaded mode enabled?
+		 * @return True if the hidden frames are run on a second context.
+		 */
+		bool isThreaded(void) const;
+
+		/**
+		 * Enable threaded mode.
+		 * The secondary context must be created from the same ROM
+		 * and region as the primary context. RunAhead takes ownership
+		 * of the secondary context, even if an error occurs.
+		 * @param secondary Secondary context, or nullptr to disable threaded mode.
+		 * @return 0 on success; -ENOTSUP if threaded mode isn't supported.
+		 */
+		int setSecondary(EmuContext *secondary);
+
+		/**
+		 * Run a frame of emulation.
+		 * If run-ahead is enabled, the displayed image
+		 * will be frames() frames ahead of the emulated state.
+		 */
+		void execFrame(void);
+
+		/**
+		 * Run a frame of emulation without rendering.
+		 * Nothing is displayed, so this doesn't run ahead.
+		 */
+		void execFrameFast(void);
+};
+
+}
+
+#endif /* __LIBGENS_UTIL_RUNAHEAD_HPP__ */
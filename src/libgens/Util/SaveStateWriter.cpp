@@ -0,0 +1,358 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * SaveStateWriter.cpp: Asynchronous savestate writer.                     *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "SaveStateWriter.hpp"
+#include "MdFb.hpp"
+#include "Screenshot.hpp"
+#include "EmuContext/EmuContext.hpp"
+#include "Vdp/Vdp.hpp"
+#include "Rom.hpp"
+
+// LibZomg
+#include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgSnapshot.hpp"
+#include "libzomg/Metadata.hpp"
+using LibZomg::Zomg;
+using LibZomg::ZomgSnapshot;
+using LibZomg::Metadata;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// C++ includes.
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using std::deque;
+using std::string;
+
+namespace LibGens {
+
+class SaveStateWriterPrivate
+{
+	public:
+		SaveStateWriterPrivate();
+		~SaveStateWriterPrivate();
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		SaveStateWriterPrivate(const SaveStateWriterPrivate &);
+		SaveStateWriterPrivate &operator=(const SaveStateWriterPrivate &);
+
+	public:
+		/**
+		 * Captured savestate.
+		 * Everything the worker thread needs is copied,
+		 * so the emulation context can keep running
+		 * (or be deleted) while the file is written.
+		 */
+		struct Job {
+			string filename;
+			int id;
+
+			std::vector<uint8_t> snapshot;	// In-memory snapshot.
+			MdFb *fb;			// Copy of the framebuffer.
+
+			// ROM information.
+			string romFilename;
+			uint32_t romCrc32;
+			Metadata *previewMetadata;	// Metadata for the preview image.
+
+			// Compression settings.
+			// Captured in save(), since the defaults may be
+			// changed by the UI thread at any time.
+			Zomg::CompressionProfile compression;
+			bool previewEnabled;
+
+			Job() : id(0), fb(nullptr), romCrc32(0), previewMetadata(nullptr)
+				, compression(Zomg::CP_DEFAULT), previewEnabled(true) { }
+			~Job()
+			{
+				if (fb)
+					fb->unref();
+				delete previewMetadata;
+			}
+
+			private:
+				// Q_DISABLE_COPY() equivalent.
+				Job(const Job &);
+				Job &operator=(const Job &);
+		};
+
+		/**
+		 * Write a savestate.
+		 * Called by the worker thread.
+		 * @param job Savestate.
+		 * @return 0 on success; negative errno on error.
+		 */
+		static int write(const Job *job);
+
+		/**
+		 * Worker thread function.
+		 */
+		void workerMain(void);
+
+		std::thread worker;
+		mutable std::mutex mutex;
+		std::condition_variable cond;
+
+		// Protected by mutex.
+		deque<Job*> jobs;			// Pending savestates.
+		deque<SaveStateWriter::Result> results;	// Finished savestates.
+		bool busy;				// Worker is writing a savestate.
+		bool quit;				// Worker thread should exit.
+};
+
+/** SaveStateWriterPrivate **/
+
+SaveStateWriterPrivate::SaveStateWriterPrivate()
+	: busy(false)
+	, quit(false)
+{ }
+
+SaveStateWriterPrivate::~SaveStateWriterPrivate()
+{
+	if (worker.joinable()) {
+		// Pending savestates are written before the worker exits.
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			quit = true;
+			cond.notify_all();
+		}
+		worker.join();
+	}
+
+	for (deque<Job*>::iterator iter = jobs.begin();
+	     iter != jobs.end(); ++iter)
+	{
+		delete *iter;
+	}
+}
+
+/**
+ * Write a savestate.
+ * Called by the worker thread.
+ * @param job Savestate.
+ * @return 0 on success; negative errno on error.
+ */
+int SaveStateWriterPrivate::write(const Job *job)
+{
+	ZomgSnapshot snapshot(job->snapshot.data(), job->snapshot.size());
+	if (!snapshot.isOpen())
+		return snapshot.lastError();
+
+	// TODO: More comprehensive error reporting.
+	Zomg zomg(job->filename.c_str(), Zomg::ZOMG_SAVE);
+	if (!zomg.isOpen())
+		return -ENOENT;
+	zomg.setCompressionProfile(job->compression);
+	zomg.setPreviewEnabled(job->previewEnabled);
+
+	// Create ZOMG.ini.
+	// This matches EmuContext::zomgSave().
+	Metadata metadata;
+	switch (snapshot.system()) {
+		case ZomgSnapshot::SNAPSHOT_SYS_MD:
+			metadata.setSystemId("MD");
+			break;
+		case ZomgSnapshot::SNAPSHOT_SYS_PICO:
+			metadata.setSystemId("Pico");
+			break;
+		default:
+			return -EINVAL;
+	}
+	metadata.setRomFilename(job->romFilename);
+	metadata.setRomCrc32(job->romCrc32);
+
+	int ret = zomg.saveZomgIni(&metadata);
+	if (ret != 0) {
+		// Error saving ZOMG.ini.
+		return ret;
+	}
+
+	// Create the preview image.
+	// TODO: Check the return value?
+	if (job->fb) {
+		Screenshot::toZomg(&zomg, job->fb, job->previewMetadata);
+	}
+
+	// Save the emulation state.
+	ret = snapshot.copyTo(&zomg);
+
+	// Close the savestate.
+	zomg.close();
+	return ret;
+}
+
+/**
+ * Worker thread function.
+ */
+void SaveStateWriterPrivate::workerMain(void)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		while (jobs.empty() && !quit) {
+			cond.wait(lock);
+		}
+		if (jobs.empty()) {
+			// Quit was requested, and everything was written.
+			break;
+		}
+
+		Job *const job = jobs.front();
+		jobs.pop_front();
+		busy = true;
+		lock.unlock();
+
+		SaveStateWriter::Result result;
+		result.filename = job->filename;
+		result.id = job->id;
+		result.ret = write(job);
+		delete job;
+
+		lock.lock();
+		results.push_back(result);
+		busy = false;
+		cond.notify_all();
+	}
+}
+
+/** SaveStateWriter **/
+
+SaveStateWriter::SaveStateWriter()
+	: d(new SaveStateWriterPrivate())
+{ }
+
+/**
+ * Delete the savestate writer.
+ * Any pending savestates will be written first.
+ */
+SaveStateWriter::~SaveStateWriter()
+{
+	delete d;
+}
+
+/**
+ * Save the current state to a ZOMG file.
+ * The state is captured immediately; the file is
+ * written on the worker thread.
+ * @param context	[in] Emulation context.
+ * @param filename	[in] ZOMG file.
+ * @param id		[in] Caller-defined ID, e.g. the savestate slot.
+ * @return 0 if the state was captured; negative errno on error.
+ */
+int SaveStateWriter::save(const EmuContext *context, const char *filename, int id)
+{
+	if (!context || !filename || !filename[0])
+		return -EINVAL;
+
+	// Rom object has some useful ROM information.
+	const Rom *rom = context->rom();
+	if (!rom)
+		return -EINVAL;
+
+	SaveStateWriterPrivate::Job *job = new SaveStateWriterPrivate::Job();
+	job->filename = filename;
+	job->id = id;
+
+	// Save the emulation state.
+	int ret = context->saveSnapshot(nullptr, 0);
+	if (ret > 0) {
+		job->snapshot.resize(ret);
+		ret = context->saveSnapshot(job->snapshot.data(), job->snapshot.size());
+	}
+	if (ret <= 0) {
+		delete job;
+		return (ret == 0 ? -EIO : ret);
+	}
+
+	// Compression settings.
+	job->compression = Zomg::DefaultCompressionProfile();
+	job->previewEnabled = Zomg::DefaultPreviewEnabled();
+
+	// ROM information.
+	job->romFilename = rom->filename_base();
+	job->romCrc32 = rom->rom_crc32();
+
+	if (job->previewEnabled) {
+		// Copy the framebuffer for the preview image.
+		const MdFb *src = context->m_vdp->MD_Screen;
+		job->fb = new MdFb();
+		job->fb->setBpp(src->bpp());
+		job->fb->copyFrom(src);
+
+		job->previewMetadata = new Metadata();
+		Screenshot::getRomMetadata(job->previewMetadata, rom);
+	}
+
+	// Queue the savestate.
+	std::unique_lock<std::mutex> lock(d->mutex);
+	if (!d->worker.joinable()) {
+		// Start the worker thread.
+		d->worker = std::thread(&SaveStateWriterPrivate::workerMain, d);
+	}
+	d->jobs.push_back(job);
+	d->cond.notify_all();
+	return 0;
+}
+
+/**
+ * Get the result of the oldest finished savestate.
+ * @param result	[out] Result.
+ * @return True if a result was returned; false if none are available.
+ */
+bool SaveStateWriter::poll(Result *result)
+{
+	std::unique_lock<std::mutex> lock(d->mutex);
+	if (d->results.empty())
+		return false;
+	*result = d->results.front();
+	d->results.pop_front();
+	return true;
+}
+
+/**
+ * Wait for all pending savestates to be written.
+ * Results are still available from poll() afterwards.
+ */
+void SaveStateWriter::flush(void)
+{
+	std::unique_lock<std::mutex> lock(d->mutex);
+	while (!d->jobs.empty() || d->busy) {
+		d->cond.wait(lock);
+	}
+}
+
+/**
+ * Get the number of savestates that haven't been written yet.
+ * @return Number of pending savestates.
+ */
+int SaveStateWriter::pending(void) const
+{
+	std::unique_lock<std::mutex> lock(d->mutex);
+	return (int)d->jobs.size() + (d->busy ? 1 : 0);
+}
+
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * SaveStateWriter.hpp: Asynchronous savestate writer.                     *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * SaveStateWriter writes ZOMG savestates on a background thread.
+ *
+ * EmuContext::zomgSave() compresses the state, encodes the preview
+ * image, and writes the file on the calling thread, which can take
+ * long enough to drop frames. save() only captures an in-memory
+ * snapshot and a copy of the framebuffer, which takes well under
+ * a millisecond. Everything else is done by a worker thread.
+ *
+ * Savestates are written in the order they were saved.
+ * Call poll() periodically to find out when they're done.
+ */
+
+#ifndef __LIBGENS_UTIL_SAVESTATEWRITER_HPP__
+#define __LIBGENS_UTIL_SAVESTATEWRITER_HPP__
+
+// C++ includes.
+#include <string>
+
+namespace LibGens {
+
+class EmuContext;
+
+class SaveStateWriterPrivate;
+class SaveStateWriter
+{
+	public:
+		SaveStateWriter();
+
+		/**
+		 * Delete the savestate writer.
+		 * Any pending savestates will be written first.
+		 */
+		~SaveStateWriter();
+
+	protected:
+		friend class SaveStateWriterPrivate;
+		SaveStateWriterPrivate *const d;
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		SaveStateWriter(const SaveStateWriter &);
+		SaveStateWriter &operator=(const SaveStateWriter &);
+
+	public:
+		/**
+		 * Result of a savestate write.
+		 */
+		struct Result {
+			std::string filename;	// ZOMG file.
+			int id;			// ID passed to save().
+			int ret;		// 0 on success; negative errno on error.
+		};
+
+		/**
+		 * Save the current state to a ZOMG file.
+		 * The state is captured immediately; the file is
+		 * written on the worker thread.
+		 * @param context	[in] Emulation context.
+		 * @param filename	[in] ZOMG file.
+		 * @param id		[in] Caller-defined ID, e.g. the savestate slot.
+		 * @return 0 if the state was captured; negative errno on error.
+		 */
+		int save(const EmuContext *context, const char *filename, int id = 0);
+
+		/**
+		 * Get the result of the oldest finished savestate.
+		 * @param result	[out] Result.
+		 * @return True if a result was returned; false if none are available.
+		 */
+		bool poll(Result *result);
+
+		/**
+		 * Wait for all pending savestates to be written.
+		 * Results are still available from poll() afterwards.
+		 */
+		void flush(void);
+
+		/**
+		 * Get the number of savestates that haven't been written yet.
+		 * @return Number of pending savestates.
+		 */
+		int pending(void) const;
+};
+
+}
+
+#endif /* __LIBGENS_UTIL_SAVESTATEWRITER_HPP__ */
@@ -68,6 +68,13 @@ class ScreenshotPrivate
 		static void toImgData(Zomg_Img_Data_t *img_data,
 				Metadata *metadata,
 				const MdFb *fb, const Rom *rom);
+
+		/**
+		 * Get ROM metadata for a screenshot.
+		 * @param metadata	[out] Metadata.
+		 * @param rom		[in] ROM object.
+		 */
+		static void romMetadata(Metadata *metadata, const Rom *rom);
 };
 
 /**
@@ -111,59 +118,69 @@ void ScreenshotPrivate::toImgData(Zomg_Img_Data_t *img_data,
 		img_data->bpp = (bpp == MdFb::BPP_16 ? 16 : 15);
 	}
 
+	if (rom && metadata) {
+		romMetadata(metadata, rom);
+	}
+}
+
+/**
+ * Get ROM metadata for a screenshot.
+ * @param metadata	[out] Metadata.
+ * @param rom		[in] ROM object.
+ */
+void ScreenshotPrivate::romMetadata(Metadata *metadata, const Rom *rom)
+{
 	// System ID.
 	// TODO: Pass the MDP system ID directly.
-	if (rom) {
-		const char *sysId;
-		switch (rom->sysId()) {
-			case Rom::MDP_SYSTEM_UNKNOWN:
-			default:
-				sysId = nullptr;
-				break;
-			case Rom::MDP_SYSTEM_MD:
-				sysId = "MD";
-				break;
-			case Rom::MDP_SYSTEM_MCD:
-				sysId = "MCD";
-				break;
-			case Rom::MDP_SYSTEM_32X:
-				sysId = "32X";
-				break;
-			case Rom::MDP_SYSTEM_MCD32X:
-				// TODO: "MCD32X", or "MCD,32X"?
-				// Note that "MCD" and "32X" imply MD.
-				sysId = "MCD,32X";
-				break;
-			case Rom::MDP_SYSTEM_SMS:
-				sysId = "SMS";
-				break;
-			case Rom::MDP_SYSTEM_GG:
-				sysId = "GG";
-				break;
-			case Rom::MDP_SYSTEM_SG1000:
-				sysId = "SG-1000";
-				break;
-			case Rom::MDP_SYSTEM_PICO:
-				sysId = "Pico";
-				break;
-			/* TODO: ColecoVision.
-			case Rom::MDP_SYSTEM_CV:
-				sysId = "CV";
-				break;
-			*/
-		}
-
-		if (sysId != nullptr) {
-			metadata->setSystemId(string(sysId));
-		};
-
-		//metadata.setRegion();		// TODO: Get region code.
-		// TODO: Save ROM filename with extension; also, z_file?
-		metadata->setRomFilename(rom->filename_baseNoExt());
-		metadata->setRomCrc32(rom->rom_crc32());
-		//metadata->setRomSize(rom->romSize());	// TODO; also, include SMD header?
-		// TODO: Add more metadata.
+	const char *sysId;
+	switch (rom->sysId()) {
+		case Rom::MDP_SYSTEM_UNKNOWN:
+		default:
+			sysId = nullptr;
+			break;
+		case Rom::MDP_SYSTEM_MD:
+			sysId = "MD";
+			break;
+		case Rom::MDP_SYSTEM_MCD:
+			sysId = "MCD";
+			break;
+		case Rom::MDP_SYSTEM_32X:
+			sysId = "32X";
+			break;
+		case Rom::MDP_SYSTEM_MCD32X:
+			// TODO: "MCD32X", or "MCD,32X"?
+			// Note that "MCD" and "32X" imply MD.
+			sysId = "MCD,32X";
+			break;
+		case Rom::MDP_SYSTEM_SMS:
+			sysId = "SMS";
+			break;
+		case Rom::MDP_SYSTEM_GG:
+			sysId = "GG";
+			break;
+		case Rom::MDP_SYSTEM_SG1000:
+			sysId = "SG-1000";
+			break;
+		case Rom::MDP_SYSTEM_PICO:
+			sysId = "Pico";
+			break;
+		/* TODO: ColecoVision.
+		case Rom::MDP_SYSTEM_CV:
+			sysId = "CV";
+			break;
+		*/
+	}
+
+	if (sysId != nullptr) {
+		metadata->setSystemId(string(sysId));
 	}
+
+	//metadata.setRegion();		// TODO: Get region code.
+	// TODO: Save ROM filename with extension; also, z_file?
+	metadata->setRomFilename(rom->filename_baseNoExt());
+	metadata->setRomCrc32(rom->rom_crc32());
+	//metadata->setRomSize(rom->romSize());	// TODO; also, include SMD header?
+	// TODO: Add more metadata.
 }
 
 /**
@@ -189,8 +206,11 @@ int Screenshot::toFile(const char *filename, const MdFb *fb, const Rom *rom)
 	// Write the PNG image.
 	// TODO: Do UTF-8 filenames work with libpng on Windows?
 	PngWriter pngWriter;
-	return pngWriter.writeToFile(&img_data, filename,
+	int ret = pngWriter.writeToFile(&img_data, filename,
 				&metadata, Metadata::MF_Default);
+	// toImgData() took a reference to the framebuffer.
+	fb->unref();
+	return ret;
 }
 
 /**
@@ -212,7 +232,48 @@ int Screenshot::toZomg(LibZomg::ZomgBase *zomg, const MdFb *fb, const Rom *rom)
 	ScreenshotPrivate::toImgData(&img_data, &metadata, fb, rom);
 
 	// Write the image to the ZOMG savestate.
-	return zomg->savePreview(&img_data, &metadata, Metadata::MF_Default);
+	int ret = zomg->savePreview(&img_data, &metadata, Metadata::MF_Default);
+	// toImgData() took a reference to the framebuffer.
+	fb->unref();
+	return ret;
+}
+
+/**
+ * Save a screenshot to a ZOMG savestate, using existing ROM metadata.
+ * The metadata can be obtained with getRomMetadata(), so the
+ * Rom object doesn't have to be available when the screenshot
+ * is saved, e.g. when writing savestates on another thread.
+ * TODO: Metadata flags parameter.
+ * @param zomg		[in,out] ZOMG savestate.
+ * @param fb		[in] MD framebuffer.
+ * @param metadata	[in] ROM metadata.
+ * @return 0 on success; negative errno on error.
+ */
+int Screenshot::toZomg(LibZomg::ZomgBase *zomg, const MdFb *fb, const Metadata *metadata)
+{
+	if (!zomg || !fb || !metadata)
+		return -EINVAL;
+
+	Zomg_Img_Data_t img_data;
+	ScreenshotPrivate::toImgData(&img_data, nullptr, fb, nullptr);
+
+	// Write the image to the ZOMG savestate.
+	int ret = zomg->savePreview(&img_data, metadata, Metadata::MF_Default);
+	// toImgData() took a reference to the framebuffer.
+	fb->unref();
+	return ret;
+}
+
+/**
+ * Get the ROM metadata that would be saved with a screenshot.
+ * @param metadata	[out] Metadata.
+ * @param rom		[in] ROM object.
+ */
+void Screenshot::getRomMetadata(Metadata *metadata, const Rom *rom)
+{
+	if (!metadata || !rom)
+		return;
+	ScreenshotPrivate::romMetadata(metadata, rom);
 }
 
 }
\ No newline at end of file
@@ -24,6 +24,7 @@
 
 namespace LibZomg {
 	class ZomgBase;
+	class Metadata;
 }
 
 namespace LibGens {
@@ -65,6 +66,27 @@ class Screenshot
 		 * @return 0 on success; negative errno on error.
 		 */
 		static int toZomg(LibZomg::ZomgBase *zomg, const MdFb *fb, const Rom *rom);
+
+		/**
+		 * Save a screenshot to a ZOMG savestate, using existing ROM metadata.
+		 * The metadata can be obtained with getRomMetadata(), so the
+		 * Rom object doesn't have to be available when the screenshot
+		 * is saved, e.g. when writing savestates on another thread.
+		 * TODO: Metadata flags parameter.
+		 * @param zomg		[in,out] ZOMG savestate.
+		 * @param fb		[in] MD framebuffer.
+		 * @param metadata	[in] ROM metadata.
+		 * @return 0 on success; negative errno on error.
+		 */
+		static int toZomg(LibZomg::ZomgBase *zomg, const MdFb *fb,
+				  const LibZomg::Metadata *metadata);
+
+		/**
+		 * Get the ROM metadata that would be saved with a screenshot.
+		 * @param metadata	[out] Metadata.
+		 * @param rom		[in] ROM object.
+		 */
+		static void getRomMetadata(LibZomg::Metadata *metadata, const Rom *rom);
 };
 
 }
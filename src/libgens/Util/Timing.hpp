@@ -99,6 +99,15 @@ class Timing
 		 */
 		uint64_t getTime(void);
 
+		/**
+		 * Get a monotonic timestamp in nanoseconds.
+		 * This is intended for measuring short intervals,
+		 * e.g. time spent in individual emulation subsystems.
+		 * The epoch is unspecified.
+		 * @return Timestamp, in nanoseconds.
+		 */
+		static uint64_t GetTimestampNs(void);
+
 	protected:
 		TimingMethod m_tMethod;
 
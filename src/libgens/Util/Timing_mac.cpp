@@ -110,4 +110,24 @@ uint64_t Timing::getTime(void)
 	return (uint64_t)(d_abs_time / 1000.0);
 }
 
+/**
+ * Get a monotonic timestamp in nanoseconds.
+ * @return Timestamp, in nanoseconds.
+ */
+uint64_t Timing::GetTimestampNs(void)
+{
+	// Mach timebase information is constant while the system is running.
+	static mach_timebase_info_data_t timebase_info = {0, 0};
+	if (timebase_info.denom == 0) {
+		mach_timebase_info(&timebase_info);
+	}
+
+	uint64_t abs_time = mach_absolute_time();
+	if (timebase_info.numer == timebase_info.denom) {
+		// Timebase is already nanoseconds.
+		return abs_time;
+	}
+	return (uint64_t)((double)abs_time * (double)timebase_info.numer / (double)timebase_info.denom);
+}
+
 }
@@ -124,4 +124,22 @@ uint64_t Timing::getTime(void)
 #endif
 }
 
+/**
+ * Get a monotonic timestamp in nanoseconds.
+ * @return Timestamp, in nanoseconds.
+ */
+uint64_t Timing::GetTimestampNs(void)
+{
+#if defined(HAVE_CLOCK_GETTIME)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#else
+	// NOTE: gettimeofday() is not guaranteed to be monotonic.
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+	return ((uint64_t)tv.tv_sec * 1000000000ULL) + ((uint64_t)tv.tv_usec * 1000);
+#endif
+}
+
 }
@@ -206,4 +206,32 @@ uint64_t Timing::getTime(void)
 	return timer;
 }
 
+/**
+ * Get a monotonic timestamp in nanoseconds.
+ * @return Timestamp, in nanoseconds.
+ */
+uint64_t Timing::GetTimestampNs(void)
+{
+	// QueryPerformanceFrequency() is constant while the system is running.
+	static LARGE_INTEGER perfFreq = {{0, 0}};
+	if (perfFreq.QuadPart == 0) {
+		if (!QueryPerformanceFrequency(&perfFreq) || perfFreq.QuadPart <= 0) {
+			// No high-resolution performance counter.
+			perfFreq.QuadPart = -1;
+		}
+	}
+
+	if (perfFreq.QuadPart < 0) {
+		// Fall back to GetTickCount().
+		return (uint64_t)GetTickCount() * 1000000ULL;
+	}
+
+	// Split the conversion to prevent overflow.
+	LARGE_INTEGER perf_ctr;
+	QueryPerformanceCounter(&perf_ctr);
+	const uint64_t sec = (uint64_t)(perf_ctr.QuadPart / perfFreq.QuadPart);
+	const uint64_t rem = (uint64_t)(perf_ctr.QuadPart % perfFreq.QuadPart);
+	return (sec * 1000000000ULL) + ((rem * 1000000000ULL) / (uint64_t)perfFreq.QuadPart);
+}
+
 }
@@ -0,0 +1,596 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VgmLogger.cpp: VGM sound logger.                                        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "VgmLogger.hpp"
+
+// Sound chips.
+#include "sound/Ym2612.hpp"
+#include "sound/Psg.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::vector;
+
+namespace LibGens {
+
+class VgmLoggerPrivate
+{
+	public:
+		VgmLoggerPrivate(VgmLogger *q);
+		~VgmLoggerPrivate();
+
+	protected:
+		friend class VgmLogger;
+		VgmLogger *const q;
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		VgmLoggerPrivate(const VgmLoggerPrivate &);
+		VgmLoggerPrivate &operator=(const VgmLoggerPrivate &);
+
+	public:
+		// Number of queued frames. (Must be a power of two.)
+		// This is about one second of emulation.
+		static const unsigned int FRAME_SLOTS = 64;
+
+		// Maximum number of events per frame.
+		// A DAC stream at ~26 kHz is about 450 writes per frame.
+		static const unsigned int MAX_EVENTS = 4096;
+
+		// VGM sampling rate.
+		static const unsigned int VGM_RATE = 44100;
+
+		// VGM header size. (v1.50)
+		static const unsigned int VGM_HEADER_SIZE = 0x40;
+
+		/**
+		 * Queued frame.
+		 */
+		struct FrameSlot {
+			vector<VgmLogger::Event> events;
+			unsigned int count;		// Number of events.
+			unsigned int frameCycles;	// Length of the frame.
+			uint64_t skippedCycles;		// Length of frames dropped before this one.
+
+			FrameSlot() : count(0), frameCycles(0), skippedCycles(0) { }
+		};
+
+		// Frame queue.
+		// frameHead is only written by the emulation thread;
+		// frameTail is only written by the worker thread.
+		FrameSlot frames[FRAME_SLOTS];
+		std::atomic<unsigned int> frameHead;
+		std::atomic<unsigned int> frameTail;
+
+		// Cycles in frames that were dropped because
+		// the queue was full. (Emulation thread only.)
+		uint64_t skippedCycles;
+
+		// Output file.
+		FILE *f;
+		bool isPal;
+		uint32_t clockMain;	// 68000 / YM2612 clock.
+		uint32_t clockPsg;	// PSG clock.
+		int error;		// First write error. (Worker thread only.)
+
+		// Timing. (Worker thread only.)
+		uint64_t totalCycles;	// 68000 cycles at the start of the current frame.
+		uint64_t curSample;	// Current VGM sample.
+		vector<uint8_t> outBuf;	// Output buffer.
+
+		// Worker thread.
+		std::thread worker;
+		std::atomic<bool> quit;
+		std::mutex wakeMutex;
+		std::condition_variable wakeCond;
+		bool isOpen;
+
+		// Statistics.
+		std::atomic<unsigned int> framesWritten;
+		std::atomic<unsigned int> droppedEvents;
+
+		/**
+		 * Get a frame slot for the next frame's events.
+		 * Called by the emulation thread.
+		 * If the queue is full, events are dropped
+		 * until a slot is available.
+		 */
+		void acquireSlot(void);
+
+		/**
+		 * Worker thread function.
+		 */
+		void workerMain(void);
+
+		/**
+		 * Write all queued frames.
+		 * Called by the worker thread.
+		 * @return True if any frames were written.
+		 */
+		bool writeFrames(void);
+
+		/**
+		 * Add wait commands up to the specified sample.
+		 * @param sample VGM sample.
+		 */
+		void writeWait(uint64_t sample);
+
+		/**
+		 * Flush the output buffer to the file.
+		 */
+		void flushOutBuf(void);
+
+		/**
+		 * Write the VGM header.
+		 * @param eofOffset Size of the file, minus 4.
+		 * @param totalSamples Total number of samples.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int writeHeader(uint32_t eofOffset, uint32_t totalSamples);
+};
+
+/** VgmLoggerPrivate **/
+
+VgmLoggerPrivate::VgmLoggerPrivate(VgmLogger *q)
+	: q(q)
+	, frameHead(0)
+	, frameTail(0)
+	, skippedCycles(0)
+	, f(nullptr)
+	, isPal(false)
+	, clockMain(0)
+	, clockPsg(0)
+	, error(0)
+	, totalCycles(0)
+	, curSample(0)
+	, quit(false)
+	, isOpen(false)
+	, framesWritten(0)
+	, droppedEvents(0)
+{ }
+
+VgmLoggerPrivate::~VgmLoggerPrivate()
+{ }
+
+/**
+ * Get a frame slot for the next frame's events.
+ * Called by the emulation thread.
+ * If the queue is full, events are dropped
+ * until a slot is available.
+ */
+void VgmLoggerPrivate::acquireSlot(void)
+{
+	const unsigned int head = frameHead.load(std::memory_order_relaxed);
+	const unsigned int tail = frameTail.load(std::memory_order_acquire);
+	if (head - tail < FRAME_SLOTS) {
+		q->m_events = frames[head & (FRAME_SLOTS - 1)].events.data();
+	} else {
+		// Queue is full.
+		q->m_events = nullptr;
+	}
+	q->m_eventCount = 0;
+}
+
+/**
+ * Worker thread function.
+ */
+void VgmLoggerPrivate::workerMain(void)
+{
+	while (true) {
+		// Check for quit *before* writing, so everything
+		// queued before close() is written.
+		const bool doQuit = quit.load(std::memory_order_acquire);
+		if (writeFrames())
+			continue;
+		if (doQuit)
+			break;
+
+		// Nothing to do. Wait for more data.
+		// The emulation thread doesn't lock wakeMutex,
+		// so a wakeup may be missed; the timeout
+		// limits the resulting delay.
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wakeCond.wait_for(lock, std::chrono::milliseconds(50));
+	}
+}
+
+/**
+ * Write all queued frames.
+ * Called by the worker thread.
+ * @return True if any frames were written.
+ */
+bool VgmLoggerPrivate::writeFrames(void)
+{
+	unsigned int tail = frameTail.load(std::memory_order_relaxed);
+	const unsigned int head = frameHead.load(std::memory_order_acquire);
+	if (tail == head)
+		return false;
+
+	for (; tail != head; tail++) {
+		const FrameSlot *slot = &frames[tail & (FRAME_SLOTS - 1)];
+		totalCycles += slot->skippedCycles;
+
+		const VgmLogger::Event *ev = slot->events.data();
+		for (unsigned int i = slot->count; i > 0; i--, ev++) {
+			// The 68000 may overshoot the end of the frame slightly.
+			const unsigned int cycle = (ev->cycle < slot->frameCycles
+						? ev->cycle : slot->frameCycles);
+			writeWait(((totalCycles + cycle) * VGM_RATE) / clockMain);
+
+			outBuf.push_back(ev->cmd);
+			if (ev->cmd != 0x50) {
+				// YM2612 writes have a register number.
+				outBuf.push_back(ev->reg);
+			}
+			outBuf.push_back(ev->data);
+		}
+		totalCycles += slot->frameCycles;
+
+		// Release the slot.
+		frameTail.store(tail + 1, std::memory_order_release);
+		framesWritten.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	flushOutBuf();
+	return true;
+}
+
+/**
+ * Add wait commands up to the specified sample.
+ * @param sample VGM sample.
+ */
+void VgmLoggerPrivate::writeWait(uint64_t sample)
+{
+	while (sample > curSample) {
+		const uint64_t delta = (sample - curSample);
+		unsigned int n;
+		if (delta == 735) {
+			// 0x62: Wait 735 samples. (1/60 second)
+			n = 735;
+			outBuf.push_back(0x62);
+		} else if (delta == 882) {
+			// 0x63: Wait 882 samples. (1/50 second)
+			n = 882;
+			outBuf.push_back(0x63);
+		} else if (delta <= 16) {
+			// 0x7n: Wait n+1 samples.
+			n = (unsigned int)delta;
+			outBuf.push_back(0x70 | (n - 1));
+		} else {
+			// 0x61 nnnn: Wait n samples.
+			n = (delta > 0xFFFF ? 0xFFFF : (unsigned int)delta);
+			outBuf.push_back(0x61);
+			outBuf.push_back(n & 0xFF);
+			outBuf.push_back((n >> 8) & 0xFF);
+		}
+		curSample += n;
+	}
+}
+
+/**
+ * Flush the output buffer to the file.
+ */
+void VgmLoggerPrivate::flushOutBuf(void)
+{
+	if (!outBuf.empty() && error == 0) {
+		if (fwrite(outBuf.data(), 1, outBuf.size(), f) != outBuf.size()) {
+			error = -EIO;
+		}
+	}
+	outBuf.clear();
+}
+
+/**
+ * Write the VGM header.
+ * @param eofOffset Size of the file, minus 4.
+ * @param totalSamples Total number of samples.
+ * @return 0 on success; negative errno on error.
+ */
+int VgmLoggerPrivate::writeHeader(uint32_t eofOffset, uint32_t totalSamples)
+{
+	uint8_t header[VGM_HEADER_SIZE];
+	memset(header, 0, sizeof(header));
+	memcpy(&header[0x00], "Vgm ", 4);
+
+	// Little-endian fields.
+	#define PUT32(offset, value) do { \
+		header[(offset)+0] = (uint8_t)((value) & 0xFF); \
+		header[(offset)+1] = (uint8_t)(((value) >> 8) & 0xFF); \
+		header[(offset)+2] = (uint8_t)(((value) >> 16) & 0xFF); \
+		header[(offset)+3] = (uint8_t)(((value) >> 24) & 0xFF); \
+	} while (0)
+	PUT32(0x04, eofOffset);
+	PUT32(0x08, 0x150);		// Version 1.50
+	PUT32(0x0C, clockPsg);		// SN76489 clock
+	PUT32(0x18, totalSamples);
+	PUT32(0x24, (isPal ? 50 : 60));	// Rate
+	header[0x28] = 0x09;		// SN76489 feedback (0x0009)
+	header[0x2A] = 16;		// SN76489 shift register width
+	PUT32(0x2C, clockMain);		// YM2612 clock
+	PUT32(0x34, VGM_HEADER_SIZE - 0x34);	// VGM data offset
+	#undef PUT32
+
+	if (fwrite(header, 1, sizeof(header), f) != sizeof(header))
+		return -EIO;
+	return 0;
+}
+
+/** VgmLogger **/
+
+VgmLogger::VgmLogger()
+	: d(new VgmLoggerPrivate(this))
+	, m_events(nullptr)
+	, m_eventCount(0)
+	, m_eventMax(VgmLoggerPrivate::MAX_EVENTS)
+	, m_droppedEvents(0)
+{
+	m_ymAddr[0] = 0;
+	m_ymAddr[1] = 0;
+}
+
+/**
+ * Delete the logger.
+ * If logging, the log will be closed first.
+ */
+VgmLogger::~VgmLogger()
+{
+	close();
+	delete d;
+}
+
+/**
+ * Start logging.
+ * @param filename	[in] VGM file.
+ * @param isPal		[in] If true, use PAL clocks; otherwise, use NTSC clocks.
+ * @return 0 on success; negative errno on error.
+ */
+int VgmLogger::open(const char *filename, bool isPal)
+{
+	if (d->isOpen)
+		return -EBUSY;
+	if (!filename || !filename[0])
+		return -EINVAL;
+
+	d->f = fopen(filename, "wb");
+	if (!d->f)
+		return -errno;
+
+	// Clocks are derived from the master clock.
+	// 68000 and YM2612: MCLK/7; PSG: MCLK/15
+	const uint32_t mclk = (isPal ? 53203424 : 53693175);
+	d->isPal = isPal;
+	d->clockMain = (mclk / 7);
+	d->clockPsg = (mclk / 15);
+
+	// Write a placeholder header.
+	// The sizes are filled in by close().
+	d->error = 0;
+	int ret = d->writeHeader(0, 0);
+	if (ret != 0) {
+		fclose(d->f);
+		d->f = nullptr;
+		return ret;
+	}
+
+	// Allocate the frame queue.
+	// This is done here so logging doesn't
+	// have to allocate memory.
+	for (unsigned int i = 0; i < VgmLoggerPrivate::FRAME_SLOTS; i++) {
+		d->frames[i].events.resize(VgmLoggerPrivate::MAX_EVENTS);
+	}
+	d->frameHead = 0;
+	d->frameTail = 0;
+	d->skippedCycles = 0;
+	d->totalCycles = 0;
+	d->curSample = 0;
+	d->framesWritten = 0;
+	d->droppedEvents = 0;
+	m_droppedEvents = 0;
+	m_ymAddr[0] = 0;
+	m_ymAddr[1] = 0;
+	d->acquireSlot();
+
+	// Start the worker thread.
+	d->quit = false;
+	d->worker = std::thread(&VgmLoggerPrivate::workerMain, d);
+	d->isOpen = true;
+	return 0;
+}
+
+/**
+ * Stop logging.
+ * All queued frames are written before the file is closed.
+ * The logger must be detached from the emulation context first.
+ * @return 0 on success; negative errno if a write error occurred.
+ */
+int VgmLogger::close(void)
+{
+	if (!d->isOpen)
+		return 0;
+
+	// Stop the worker thread.
+	// NOTE: Events in the current frame are discarded,
+	// since the frame hasn't finished yet.
+	d->quit.store(true, std::memory_order_release);
+	d->wakeCond.notify_one();
+	d->worker.join();
+	d->isOpen = false;
+	m_events = nullptr;
+	m_eventCount = 0;
+
+	// End of sound data.
+	d->writeWait((d->totalCycles * VgmLoggerPrivate::VGM_RATE) / d->clockMain);
+	d->outBuf.push_back(0x66);
+	d->flushOutBuf();
+
+	// Update the header.
+	int ret = d->error;
+	const long size = ftell(d->f);
+	if (size < 0 || fseek(d->f, 0, SEEK_SET) != 0) {
+		if (ret == 0)
+			ret = -EIO;
+	} else {
+		int hret = d->writeHeader((uint32_t)(size - 4), (uint32_t)d->curSample);
+		if (hret != 0 && ret == 0)
+			ret = hret;
+	}
+	if (fclose(d->f) != 0 && ret == 0)
+		ret = -EIO;
+	d->f = nullptr;
+
+	// Free the frame queue.
+	for (unsigned int i = 0; i < VgmLoggerPrivate::FRAME_SLOTS; i++) {
+		vector<Event>().swap(d->frames[i].events);
+	}
+	return ret;
+}
+
+/**
+ * Is the logger open?
+ * @return True if logging; false if not.
+ */
+bool VgmLogger::isOpen(void) const
+{
+	return d->isOpen;
+}
+
+/**
+ * Log the current sound chip registers.
+ * Called when the logger is attached, so the
+ * log starts with the correct sound chip state.
+ * @param ym2612	[in] YM2612.
+ * @param psg		[in] PSG.
+ */
+void VgmLogger::logRegisters(const Ym2612 *ym2612, const Psg *psg)
+{
+	if (ym2612) {
+		// Key off all channels.
+		static const uint8_t keyOff[6] = {0x00, 0x01, 0x02, 0x04, 0x05, 0x06};
+		for (int i = 0; i < 6; i++) {
+			addEvent(0x52, 0x28, keyOff[i], 0);
+		}
+
+		// Global registers: LFO, channel 3 mode, DAC enable.
+		// Timer bits in 0x27 aren't logged.
+		addEvent(0x52, 0x22, (uint8_t)ym2612->getReg(0x22), 0);
+		addEvent(0x52, 0x27, (uint8_t)ym2612->getReg(0x27) & 0xC0, 0);
+		addEvent(0x52, 0x2B, (uint8_t)ym2612->getReg(0x2B), 0);
+
+		// Frequency MSBs must be written before LSBs.
+		static const uint8_t freqRegs[12] = {
+			0xA4, 0xA5, 0xA6, 0xA0, 0xA1, 0xA2,
+			0xAC, 0xAD, 0xAE, 0xA8, 0xA9, 0xAA,
+		};
+		for (int bank = 0; bank < 2; bank++) {
+			const uint8_t cmd = 0x52 + bank;
+			const int base = (bank << 8);
+			// Operator registers.
+			for (int reg = 0x30; reg < 0xA0; reg++) {
+				if ((reg & 3) == 3)
+					continue;
+				addEvent(cmd, reg, (uint8_t)ym2612->getReg(base + reg), 0);
+			}
+			// Frequency registers.
+			for (int i = 0; i < 12; i++) {
+				addEvent(cmd, freqRegs[i], (uint8_t)ym2612->getReg(base + freqRegs[i]), 0);
+			}
+			// Algorithm, feedback, and panning registers.
+			for (int reg = 0xB0; reg < 0xB7; reg++) {
+				if ((reg & 3) == 3)
+					continue;
+				addEvent(cmd, reg, (uint8_t)ym2612->getReg(base + reg), 0);
+			}
+		}
+	}
+
+	if (psg) {
+		// PSG register order: TONE0, VOL0, TONE1, VOL1, TONE2, VOL2, NOISE, VOL3
+		for (int reg = 0; reg < 8; reg++) {
+			uint16_t val;
+			if (psg->dbg_getReg(reg, &val) != 0)
+				continue;
+			// LATCH/DATA byte.
+			addEvent(0x50, 0, 0x80 | (reg << 4) | (val & 0x0F), 0);
+			if (!(reg & 1) && reg != 6) {
+				// Tone register: DATA byte.
+				addEvent(0x50, 0, (val >> 4) & 0x3F, 0);
+			}
+		}
+	}
+}
+
+/**
+ * End the current frame.
+ * The frame's events are queued for the worker thread.
+ * @param frameCycles [in] Length of the frame, in 68000 cycles.
+ */
+void VgmLogger::endFrame(unsigned int frameCycles)
+{
+	if (!d->isOpen)
+		return;
+
+	if (m_events) {
+		// Queue the frame.
+		const unsigned int head = d->frameHead.load(std::memory_order_relaxed);
+		VgmLoggerPrivate::FrameSlot *slot = &d->frames[head & (VgmLoggerPrivate::FRAME_SLOTS - 1)];
+		slot->count = m_eventCount;
+		slot->frameCycles = frameCycles;
+		slot->skippedCycles = d->skippedCycles;
+		d->skippedCycles = 0;
+		d->frameHead.store(head + 1, std::memory_order_release);
+		d->wakeCond.notify_one();
+	} else {
+		// Queue was full. The frame's events were dropped,
+		// but the time still has to be accounted for.
+		d->skippedCycles += frameCycles;
+	}
+
+	if (m_droppedEvents != 0) {
+		d->droppedEvents.fetch_add(m_droppedEvents, std::memory_order_relaxed);
+		m_droppedEvents = 0;
+	}
+
+	// Get a slot for the next frame.
+	d->acquireSlot();
+}
+
+/**
+ * Get the logging statistics.
+ * Statistics are reset by open().
+ * @param stats [out] Statistics.
+ */
+void VgmLogger::stats(Stats *stats) const
+{
+	stats->frames = d->framesWritten.load(std::memory_order_relaxed);
+	stats->droppedEvents = d->droppedEvents.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,230 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VgmLogger.hpp: VGM sound logger.                                        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * VgmLogger logs YM2612 and PSG writes to a VGM file.
+ *
+ * Writes are timestamped in 68000 cycles since the start of the
+ * frame, and are stored in preallocated per-frame buffers. At the
+ * end of each frame, the buffer is handed to a worker thread, which
+ * converts the timestamps to 44.1 kHz VGM samples and writes the
+ * file. Logging a write never allocates memory or blocks; if the
+ * worker falls behind, events are dropped and counted.
+ *
+ * The logger is attached to an emulation context with
+ * EmuContext::setVgmLogger(). The log*() and endFrame()
+ * functions are called by the emulation thread.
+ */
+
+#ifndef __LIBGENS_UTIL_VGMLOGGER_HPP__
+#define __LIBGENS_UTIL_VGMLOGGER_HPP__
+
+// C includes.
+#include <stdint.h>
+
+namespace LibGens {
+
+class Ym2612;
+class Psg;
+
+class VgmLoggerPrivate;
+class VgmLogger
+{
+	public:
+		VgmLogger();
+
+		/**
+		 * Delete the logger.
+		 * If logging, the log will be closed first.
+		 */
+		~VgmLogger();
+
+	protected:
+		friend class VgmLoggerPrivate;
+		VgmLoggerPrivate *const d;
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		VgmLogger(const VgmLogger &);
+		VgmLogger &operator=(const VgmLogger &);
+
+	public:
+		/**
+		 * Start logging.
+		 * @param filename	[in] VGM file.
+		 * @param isPal		[in] If true, use PAL clocks; otherwise, use NTSC clocks.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int open(const char *filename, bool isPal);
+
+		/**
+		 * Stop logging.
+		 * All queued frames are written before the file is closed.
+		 * The logger must be detached from the emulation context first.
+		 * @return 0 on success; negative errno if a write error occurred.
+		 */
+		int close(void);
+
+		/**
+		 * Is the logger open?
+		 * @return True if logging; false if not.
+		 */
+		bool isOpen(void) const;
+
+		/** Emulation thread functions. **/
+
+		/**
+		 * Log a write to a YM2612 port.
+		 * Address writes are latched; data writes are logged.
+		 * @param port	[in] YM2612 port. (0-3)
+		 * @param data	[in] Data.
+		 * @param cycle	[in] 68000 cycles since the start of the frame.
+		 */
+		inline void logYm2612(int port, uint8_t data, unsigned int cycle);
+
+		/**
+		 * Log a write to the PSG.
+		 * @param data	[in] Data.
+		 * @param cycle	[in] 68000 cycles since the start of the frame.
+		 */
+		inline void logPsg(uint8_t data, unsigned int cycle);
+
+		/**
+		 * Log the current sound chip registers.
+		 * Called when the logger is attached, so the
+		 * log starts with the correct sound chip state.
+		 * @param ym2612	[in] YM2612.
+		 * @param psg		[in] PSG.
+		 */
+		void logRegisters(const Ym2612 *ym2612, const Psg *psg);
+
+		/**
+		 * End the current frame.
+		 * The frame's events are queued for the worker thread.
+		 * @param frameCycles [in] Length of the frame, in 68000 cycles.
+		 */
+		void endFrame(unsigned int frameCycles);
+
+		/**
+		 * Logging statistics.
+		 */
+		struct Stats {
+			unsigned int frames;		// Frames written.
+			unsigned int droppedEvents;	// Events dropped because the queue was full.
+		};
+
+		/**
+		 * Get the logging statistics.
+		 * Statistics are reset by open().
+		 * @param stats [out] Statistics.
+		 */
+		void stats(Stats *stats) const;
+
+	public:
+		/**
+		 * Logged event.
+		 */
+		struct Event {
+			uint32_t cycle;	// 68000 cycles since the start of the frame.
+			uint8_t cmd;	// VGM command.
+			uint8_t reg;	// Register. (YM2612 only)
+			uint8_t data;	// Data.
+			uint8_t reserved;
+		};
+
+	private:
+		/**
+		 * Add an event to the current frame.
+		 * @param cmd	[in] VGM command.
+		 * @param reg	[in] Register.
+		 * @param data	[in] Data.
+		 * @param cycle	[in] 68000 cycles since the start of the frame.
+		 */
+		inline void addEvent(uint8_t cmd, uint8_t reg, uint8_t data, unsigned int cycle);
+
+		// Current frame's event buffer.
+		// Owned by d; nullptr if the queue is full.
+		Event *m_events;
+		unsigned int m_eventCount;
+		unsigned int m_eventMax;
+		unsigned int m_droppedEvents;
+
+		// YM2612 address latches. [port 0, port 2]
+		uint8_t m_ymAddr[2];
+};
+
+/**
+ * Add an event to the current frame.
+ * @param cmd	[in] VGM command.
+ * @param reg	[in] Register.
+ * @param data	[in] Data.
+ * @param cycle	[in] 68000 cycles since the start of the frame.
+ */
+inline void VgmLogger::addEvent(uint8_t cmd, uint8_t reg, uint8_t data, unsigned int cycle)
+{
+	if (!m_events || m_eventCount >= m_eventMax) {
+		// No room in the current frame.
+		m_droppedEvents++;
+		return;
+	}
+
+	Event *const ev = &m_events[m_eventCount++];
+	ev->cycle = cycle;
+	ev->cmd = cmd;
+	ev->reg = reg;
+	ev->data = data;
+	ev->reserved = 0;
+}
+
+/**
+ * Log a write to a YM2612 port.
+ * Address writes are latched; data writes are logged.
+ * @param port	[in] YM2612 port. (0-3)
+ * @param data	[in] Data.
+ * @param cycle	[in] 68000 cycles since the start of the frame.
+ */
+inline void VgmLogger::logYm2612(int port, uint8_t data, unsigned int cycle)
+{
+	const int bank = ((port >> 1) & 1);
+	if (!(port & 1)) {
+		// Address port.
+		m_ymAddr[bank] = data;
+		return;
+	}
+
+	// Data port. (0x52: YM2612 port 0; 0x53: YM2612 port 1)
+	addEvent(0x52 + bank, m_ymAddr[bank], data, cycle);
+}
+
+/**
+ * Log a write to the PSG.
+ * @param data	[in] Data.
+ * @param cycle	[in] 68000 cycles since the start of the frame.
+ */
+inline void VgmLogger::logPsg(uint8_t data, unsigned int cycle)
+{
+	// 0x50: SN76489 write.
+	addEvent(0x50, 0, data, cycle);
+}
+
+}
+
+#endif /* __LIBGENS_UTIL_VGMLOGGER_HPP__ */
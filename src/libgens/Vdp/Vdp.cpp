@@ -30,7 +30,7 @@
 #include <cstring>
 
 // ZOMG
-#include "libzomg/Zomg.hpp"
+#include "libzomg/ZomgBase.hpp"
 
 // VDP includes.
 #include "VdpPalette.hpp"
@@ -55,6 +55,7 @@ const VdpTypes::VdpEmuOptions_t VdpPrivate::def_vdpEmuOptions = {
 	true,				// vscrollBug
 	false,				// updatePaletteInVBlankOnly
 	true,				// enableInterlacedMode
+	false,				// renderThread
 };
 
 VdpPrivate::VdpPrivate(Vdp *q)
@@ -62,6 +63,10 @@ VdpPrivate::VdpPrivate(Vdp *q)
 	, VDP_Model(VdpTypes::VDP_MODEL_MD)	// TODO: Add support for more models.
 	, VRam_Mask(0xFFFF)	// Always ensure this mask is valid.
 	, d_err(new VdpRend_Err_Private(q))
+	, rendLines(&q->VDP_Lines)
+	, rendStatus(&Reg_Status)
+	, rendThread(nullptr)
+	, rendStatusBits(0)
 {
 	// TODO: Initialize all private variables.
 
@@ -116,6 +121,9 @@ Vdp::Vdp(MdFb *fb)
  */
 Vdp::~Vdp(void)
 {
+	// Stop the render thread.
+	d->rendThreadStop();
+
 	// Shut down the VDP rendering subsystem.
 	d->rend_end();
 
@@ -128,14 +136,18 @@ Vdp::~Vdp(void)
  */
 void Vdp::reset(void)
 {
+	d->rendSync();
+
 	// Reset the VDP rendering arrays.
 	d->rend_reset();
 
 	// Clear VRam and VSRam.
 	memset(&d->VRam, 0, sizeof(d->VRam));
 	memset(&d->VSRam, 0, sizeof(d->VSRam));
+	d->patternCache.invalidate();
 	// Clear the Sprite Attribute Table cache.
 	memset(&d->SprAttrTbl_m5.b, 0, sizeof(d->SprAttrTbl_m5.b));
+	d->sprSpans.dirty = true;
 	// Clear the sprite line cache.
 	memset(d->sprLineCache, 0, sizeof(d->sprLineCache));
 	memset(d->sprCountCache, 0, sizeof(d->sprCountCache));
@@ -173,6 +185,8 @@ void Vdp::reset(void)
  */
 void Vdp::doFakeBootRomInit(void)
 {
+	d->rendSync();
+
 	// Initialize the VDP registers to the state
 	// they'd be in if the boot ROM was present.
 	d->resetRegisters(true);
@@ -328,6 +342,16 @@ void Vdp::Check_NTSC_V30_VBlank(void)
  */
 void Vdp::startFrame(void)
 {
+	// Start or stop the render thread.
+	// NOTE: The previous frame is always completed
+	// by the render thread before this function is called.
+	if (options.renderThread) {
+		d->rendThreadStart();
+		d->rendSync();
+	} else {
+		d->rendThreadStop();
+	}
+
 	// Update the odd/even frame flag.
 	// NOTE: enableInterlacedMode does NOT affect this function.
 	if (d->isIM1orIM2()) {
@@ -375,8 +399,10 @@ void Vdp::decrementHIntCounter(bool reload)
  * Save the VDP state. (MD mode)
  * @param zomg ZOMG savestate object to save to.
  */
-void Vdp::zomgSaveMD(LibZomg::Zomg *zomg) const
+void Vdp::zomgSaveMD(LibZomg::ZomgBase *zomg) const
 {
+	d->rendSync();
+
 	// NOTE: This is MD only.
 	// TODO: Assert if called when not emulating MD VDP.
 	// TODO: Error handling.
@@ -405,9 +431,10 @@ void Vdp::zomgSaveMD(LibZomg::Zomg *zomg) const
 	ctrl_reg.reserved1 = 0;
 	ctrl_reg.reserved2 = 0;
 
-	zomg->saveVdpCtrl_16(&ctrl_reg);
-
 	// TODO: Save DMA status.
+	memset(ctrl_reg.dma_TBD, 0, sizeof(ctrl_reg.dma_TBD));
+
+	zomg->saveVdpCtrl_16(&ctrl_reg);
 
 	// Save VRam.
 	zomg->saveVRam(d->VRam.u16, sizeof(d->VRam.u16), ZOMG_BYTEORDER_16H);
@@ -442,8 +469,10 @@ void Vdp::zomgSaveMD(LibZomg::Zomg *zomg) const
  * Restore the VDP state. (MD mode)
  * @param zomg ZOMG savestate object to restore from.
  */
-void Vdp::zomgRestoreMD(LibZomg::Zomg *zomg)
+void Vdp::zomgRestoreMD(LibZomg::ZomgBase *zomg)
 {
+	d->rendSync();
+
 	// NOTE: This is MD only.
 	// TODO: Assert if called when not emulating MD VDP.
 	// TODO: Error handling.
@@ -485,6 +514,7 @@ void Vdp::zomgRestoreMD(LibZomg::Zomg *zomg)
 
 	// Load VRam.
 	zomg->loadVRam(d->VRam.u16, sizeof(d->VRam.u16), ZOMG_BYTEORDER_16H);
+	d->patternCache.invalidate();
 
 	// Load CRam.
 	Zomg_CRam_t cram;
@@ -523,6 +553,7 @@ void Vdp::zomgRestoreMD(LibZomg::Zomg *zomg)
 			sat_cache[5] = sat_zomg[3];
 		}
 	}
+	d->sprSpans.dirty = true;
 
 	// Clear the sprite dot overflow flag.
 	d->sprDotOverflow = false;
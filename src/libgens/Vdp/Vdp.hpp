@@ -36,7 +36,7 @@
 #include "VdpPalette.hpp"
 
 namespace LibZomg {
-	class Zomg;
+	class ZomgBase;
 }
 
 namespace LibGens {
@@ -202,13 +202,13 @@ class Vdp
 		 * Save the VDP state. (MD mode)
 		 * @param zomg ZOMG savestate object to save to.
 		 */
-		void zomgSaveMD(LibZomg::Zomg *zomg) const;
+		void zomgSaveMD(LibZomg::ZomgBase *zomg) const;
 
 		/**
 		 * Restore the VDP state. (MD mode)
 		 * @param zomg ZOMG savestate object to restore from.
 		 */
-		void zomgRestoreMD(LibZomg::Zomg *zomg);
+		void zomgRestoreMD(LibZomg::ZomgBase *zomg);
 
 	public:
 		// TODO: Move to private class.
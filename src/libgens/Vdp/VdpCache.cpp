@@ -142,6 +142,23 @@ inline uint32_t VdpCache::H_flip(uint32_t src)
 	return src;
 }
 
+/**
+ * Convert a packed Mode 5 pattern line to VRAM word order.
+ * This also converts from VRAM word order to packed.
+ * @param src Source pattern.
+ * @return Converted pattern.
+ */
+inline uint32_t VdpCache::to_vram_order(uint32_t src)
+{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	// VRAM is stored as host-endian words, so the
+	// first word is in the low 16 bits.
+	return (src << 16) | (src >> 16);
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	return src;
+#endif
+}
+
 /**
  * Update the pattern cache. (Mode 4)
  * @param vram VRAM source data.
@@ -162,11 +179,11 @@ void VdpCache::update_m4(const VRam_t *vram)
 				uint32_t src = m4_lookup(vram_src[y*2], vram_src[y*2+1]);
 
 				// Update the normal cache.
-				cache.x8[0][tile][y] = src;
+				cache.x8[0][tile][y] = to_vram_order(src);
 
 				// Update the H-flip cache.
 				src = H_flip(src);
-				cache.x8[1][tile][y] = src;
+				cache.x8[1][tile][y] = to_vram_order(src);
 			}
 		}
 
@@ -197,18 +214,14 @@ void VdpCache::update_m5(const VRam_t *vram)
 				// Line is dirty.
 				// TODO: Combine with update_m4, since this function is
 				// nearly identical except for the pattern retrieval code?
-				uint32_t src = vram_src[y];
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-				// Rotate the source data into the correct order.
-				src = (src << 16) | (src >> 16);
-#endif
+				const uint32_t src = vram_src[y];
 
 				// Update the normal cache.
+				// VRAM data is already in the correct order.
 				cache.x8[0][tile][y] = src;
 
 				// Update the H-flip cache.
-				src = H_flip(src);
-				cache.x8[1][tile][y] = src;
+				cache.x8[1][tile][y] = to_vram_order(H_flip(to_vram_order(src)));
 			}
 		}
 
@@ -23,6 +23,10 @@
 // with the various 'flip' options, e.g. Hflip, Vflip, and Hflip+Vflip.
 // In addition, a lookup table is used to convert Mode 4 planar patterns
 // to Mode 5 packed patterns.
+//
+// VRAM writes mark the affected tile lines as dirty. Dirty lines are
+// decoded by update_m4() or update_m5() before the next line is
+// rendered, so unchanged tiles are never decoded more than once.
 
 #ifndef __LIBGENS_MD_VDPCACHE_HPP__
 #define __LIBGENS_MD_VDPCACHE_HPP__
@@ -40,10 +44,8 @@ namespace VdpTypes {
 }
 
 class VdpCache {
-	// NOTE: This class isn't currently in use.
-	private:
+	public:
 		VdpCache();
-		~VdpCache();
 
 	private:
 		// Q_DISABLE_COPY() equivalent.
@@ -59,6 +61,19 @@ class VdpCache {
 		 */
 		void invalidate(void);
 
+		/**
+		 * Mark a VRAM address as dirty.
+		 * This must be called for all VRAM writes.
+		 * @param address VRAM address.
+		 */
+		inline void mark_dirty(uint32_t address);
+
+		/**
+		 * Are any tiles dirty?
+		 * @return True if the cache needs to be updated.
+		 */
+		inline bool is_dirty(void) const;
+
 		/**
 		 * Update the pattern cache. (Mode 4)
 		 * @param vram VRAM source data.
@@ -113,6 +128,15 @@ class VdpCache {
 		 */
 		inline uint32_t pattern_line_m5_spr_8x16(uint16_t attr, int y);
 
+		/**
+		 * Get a pattern line by VRAM address.
+		 * Used for sprites, since the renderer calculates
+		 * the tile address for each sprite cell.
+		 * @param hflip True for the H-flipped pattern line.
+		 * @param address VRAM address.
+		 */
+		inline uint32_t pattern_line_addr(bool hflip, uint32_t address) const;
+
 	protected:
 		/**
 		 * Mode 4 lookup table.
@@ -140,17 +164,24 @@ class VdpCache {
 
 		/**
 		 * H-flip a pattern.
-		 * @param src Source pattern.
+		 * @param src Source pattern. (packed Mode 5 format)
 		 * @return H-flipped pattern.
 		 */
 		static inline uint32_t H_flip(uint32_t src);
 
+		/**
+		 * Convert a packed Mode 5 pattern line to VRAM word order.
+		 * This also converts from VRAM word order to packed.
+		 * @param src Source pattern.
+		 * @return Converted pattern.
+		 */
+		static inline uint32_t to_vram_order(uint32_t src);
+
 		/**
 		 * Pattern cache for Mode 4 and Mode 5.
-		 * Internal data is packed Mode 5 format.
-		 *
-		 * TODO: Store the data "reversed"?
-		 * i.e. left pixel is low nybble for no-flip
+		 * Internal data is packed Mode 5 format, stored in the
+		 * same word order as VRam_t::u32, so the Mode 5 renderer
+		 * can use cached pattern lines in place of VRAM reads.
 		 */
 		union {
 			/**
@@ -186,6 +217,32 @@ class VdpCache {
 		unsigned int dirty_idx;
 };
 
+/**
+ * Mark a VRAM address as dirty.
+ * This must be called for all VRAM writes.
+ * @param address VRAM address.
+ */
+inline void VdpCache::mark_dirty(uint32_t address)
+{
+	// TODO: 128 KB support.
+	const unsigned int tile = (address >> 5) & 0x7FF;
+	const uint8_t line = (1 << ((address >> 2) & 7));
+	if (!dirty_flags[tile]) {
+		// Tile wasn't dirty. Add it to the dirty list.
+		dirty_list[dirty_idx++] = tile;
+	}
+	dirty_flags[tile] |= line;
+}
+
+/**
+ * Are any tiles dirty?
+ * @return True if the cache needs to be updated.
+ */
+inline bool VdpCache::is_dirty(void) const
+{
+	return (dirty_idx != 0);
+}
+
 /**
  * Get a pattern line. (Mode 4, nametable, 8x8 cell)
  * @param attr Nametable attribute word.
@@ -301,6 +358,19 @@ inline uint32_t VdpCache::pattern_line_m5_spr_8x16(uint16_t attr, int y)
 	return cache.x8[(attr >> 11) & 1][tile][y & 7];
 }
 
+/**
+ * Get a pattern line by VRAM address.
+ * Used for sprites, since the renderer calculates
+ * the tile address for each sprite cell.
+ * @param hflip True for the H-flipped pattern line.
+ * @param address VRAM address.
+ */
+inline uint32_t VdpCache::pattern_line_addr(bool hflip, uint32_t address) const
+{
+	// TODO: 128 KB support.
+	return cache.d[hflip][(address & 0xFFFF) >> 2];
+}
+
 }
 
 #endif /* __LIBGENS_MD_VDPCACHE_HPP__ */
@@ -55,6 +55,8 @@ int Vdp::dbg_getReg(int reg_num, uint8_t *out) const
  */
 int Vdp::dbg_setReg(int reg_num, uint8_t val)
 {
+	d->rendSync();
+
 	// TODO: M4 on SMS.
 	// TODO: Don't mask the write if it's M4 on MD.
 	if (reg_num < 0 || reg_num > 23)
@@ -166,6 +168,8 @@ int Vdp::dbg_setTestReg(uint16_t val)
  */
 int Vdp::dbg_writeVRam_16(uint32_t address, const uint16_t *vram, int length)
 {
+	d->rendSync();
+
 	if (address & 1 || length & 1 ||
 	    address >= 0x10000 || address + length > 0x10000) {
 		// Invalid address:
@@ -176,22 +180,7 @@ int Vdp::dbg_writeVRam_16(uint32_t address, const uint16_t *vram, int length)
 		return -1;
 	}
 
-	memcpy(&d->VRam.u16[address>>1], vram, length);
-
-	// Check if the VRAM write overlaps the Sprite Attribute Table.
-	// TODO: Optimize this into a few calculations and a memcpy.
-	for (; length > 0; address += 2, length -= 2, vram++) {
-		if ((address & d->Spr_Tbl_Mask) == d->Spr_Tbl_Addr) {
-			// Sprite Attribute Table.
-			d->SprAttrTbl_m5.w[(address & ~d->Spr_Tbl_Mask) >> 1] = *vram;
-		}
-	}
-
-	/* TODO: Potential optimization things...
-	const uint32_t VRAM_end = address + length + 1;
-	uint32_t SAT_min = d->Spr_Tbl_Addr;
-	uint32_t SAT_max = SAT_min + ~d->Spr_Tbl_Mask;
-	*/
+	d->vdpWriteVRamBlock(address, vram, length >> 1);
 
 	return 0;
 }
@@ -205,6 +194,8 @@ int Vdp::dbg_writeVRam_16(uint32_t address, const uint16_t *vram, int length)
  */
 int Vdp::dbg_writeCRam_16(uint8_t address, const uint16_t *cram, int length)
 {
+	d->rendSync();
+
 	if (address & 1 || length & 1 ||
 	    address >= 0x80 || (int)address + length > 0x80) {
 		// Invalid address:
@@ -229,6 +220,8 @@ int Vdp::dbg_writeCRam_16(uint8_t address, const uint16_t *cram, int length)
  */
 int Vdp::dbg_writeVSRam_16(uint8_t address, const uint16_t *vsram, int length)
 {
+	d->rendSync();
+
 	// TODO: Allow 0x50-0x7F on Genesis 3?
 	if (address & 1 || length & 1 ||
 	    address >= 0x50 || (int)address + length > 0x50) {
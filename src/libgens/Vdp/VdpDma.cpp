@@ -74,9 +74,11 @@ void VdpPrivate::DMA_Fill(uint16_t data)
 			do {
 				// NOTE: DMA FILL writes to the adjacent byte.
 				VRam.u8[address ^ 1 ^ U16DATA_U8_INVERT] = fill_hi;
+				patternCache.mark_dirty(address);
 				if ((address & Spr_Tbl_Mask) == Spr_Tbl_Addr) {
 					// Sprite Attribute Table.
 					SprAttrTbl_m5.b[(address & ~Spr_Tbl_Mask) ^ U16DATA_U8_INVERT] = fill_hi;
+					sprSpans.dirty = true;
 				}
 				address += VDP_Reg.m5.Auto_Inc;
 				address &= VRam_Mask;
@@ -210,8 +212,34 @@ inline void VdpPrivate::T_DMA_Loop(void)
 	// src_base_address is used to ensure 128 KB wrapping.
 	unsigned int src_base_address = ((src_address & 0xFE0000) >> 1);
 
+	if (src_component == DMA_SRC_ROM && dest_component == DMA_DEST_VRAM) {
+		// Bulk fast path for ROM to VRAM transfers.
+		// Requirements:
+		// - Auto-increment is 2.
+		// - Even VRAM address with no wraparound.
+		// - Source doesn't wrap at 128 KB and is plain ROM
+		//   within a single 512 KB bank.
+		// ROM and VRAM are both stored in host byte order,
+		// so this is a straight block copy.
+		const uint32_t dest_address = (VDP_Ctrl.address & VRam_Mask);
+		if (VDP_Reg.m5.Auto_Inc == 2 &&
+		    (VDP_Ctrl.code & VdpTypes::CD_DEST_MASK) == VdpTypes::CD_DEST_VRAM &&
+		    !(dest_address & 1) &&
+		    dest_address + (length * 2) <= sizeof(VRam.u8) &&
+		    (uint32_t)src_word_address + length <= 0x10000)
+		{
+			const uint16_t *rom = M68K_Mem::ms_State->romCartridge->romPtr(
+				((src_word_address | src_base_address) << 1), (length * 2));
+			if (rom) {
+				vdpWriteVRamBlock(dest_address, rom, length);
+				VDP_Ctrl.address = ((dest_address + (length * 2)) & VRam_Mask);
+				length = 0;
+			}
+		}
+	}
+
 	// TODO: Do DMA MEM-to-VRAM line-by-line instead of all at once.
-	do {
+	for (; length != 0; length--) {
 		// Get the word.
 		uint16_t w;
 		switch (src_component) {
@@ -219,13 +247,12 @@ inline void VdpPrivate::T_DMA_Loop(void)
 				// TODO: Banking is done in 512 KB segments.
 				// Optimize this by getting a pointer to the segment?
 				const uint32_t req_addr = ((src_word_address | src_base_address) << 1);
-				w = M68K_Mem::ms_RomCartridge->readWord(req_addr);
+				w = M68K_Mem::ms_State->romCartridge->readWord(req_addr);
 				break;
 			}
 
 			case DMA_SRC_M68K_RAM:
-				//w = M68K_Mem::Ram_68k.u16[src_word_address];
-				w = Ram_68k.u16[src_word_address];
+				w = M68K_Mem::ms_State->ram->u16[src_word_address];
 				break;
 
 			// TODO: Port to LibGens.
@@ -275,7 +302,7 @@ inline void VdpPrivate::T_DMA_Loop(void)
 		// Write the word.
 		// TODO: Might not work if Auto_Inc is odd...
 		vdpDataWrite_int(w);
-	} while (--length != 0);
+	}
 
 	// DMA is done.
 	VDP_Ctrl.code &= ~VdpTypes::CD_DMA_ENABLE;
@@ -369,9 +396,11 @@ void VdpPrivate::processDmaCtrlWrite(void)
 		do {
 			uint8_t src = VRam.u8[src_address];
 			VRam.u8[dest_address] = src;
+			patternCache.mark_dirty(dest_address);
 			if ((dest_address & Spr_Tbl_Mask) == Spr_Tbl_Addr) {
 				// Sprite Attribute Table.
 				SprAttrTbl_m5.b[(dest_address & ~Spr_Tbl_Mask) ^ U16DATA_U8_INVERT] = src;
+				sprSpans.dirty = true;
 			}
 
 			// Increment the addresses.
@@ -581,6 +610,8 @@ void VdpPrivate::processDmaCtrlWrite(void)
  */
 unsigned int Vdp::updateDMA(void)
 {
+	d->rendSync();
+
 	/**
 	 * DMA transfer rate depends on the following:
 	 * - Horizontal resolution. (H32/H40)
@@ -607,7 +638,7 @@ unsigned int Vdp::updateDMA(void)
 	}
 
 	// Cycles elapsed is based on M68K cycles per line.
-	unsigned int cycles = M68K_Mem::CPL_M68K;
+	unsigned int cycles = M68K_Mem::ms_State->CPL_M68K;
 
 	// DMA timing table.
 	static const uint8_t DMA_Timing_Table[4][4] = {
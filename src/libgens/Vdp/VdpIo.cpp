@@ -40,6 +40,10 @@
 // Emulation Context.
 #include "EmuContext/EmuContext.hpp"
 
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cstring>
+
 // C wrapper functions for Starscream.
 #ifdef __cplusplus
 extern "C" {
@@ -47,7 +51,7 @@ extern "C" {
 
 uint8_t VDP_Int_Ack(void)
 {
-	// TODO: This won't work with multiple contexts...
+	// Use the context bound to the calling thread.
 	LibGens::EmuContext *instance = LibGens::EmuContext::Instance();
 	if (instance != nullptr)
 		return instance->m_vdp->Int_Ack();
@@ -109,10 +113,7 @@ void Vdp::updateIRQLine(int interrupt)
 	}
 
 	// No VDP interrupts.
-	// TODO: Move to M68K class.
-#ifdef GENS_ENABLE_EMULATION
-	main68k_context.interrupts[0] &= 0xF0;
-#endif /* GENS_ENABLE_EMULATION */
+	M68K::ClearInterrupts();
 }
 
 /**
@@ -122,7 +123,7 @@ void Vdp::updateIRQLine(int interrupt)
 uint8_t Vdp::readHCounter(void)
 {
 	unsigned int odo_68K = M68K::ReadOdometer();
-	odo_68K -= (M68K_Mem::Cycles_M68K - M68K_Mem::CPL_M68K);
+	odo_68K -= (M68K_Mem::ms_State->Cycles_M68K - M68K_Mem::ms_State->CPL_M68K);
 	odo_68K &= 0x1FF;
 
 	// H_Counter_Table[][0] == H32.
@@ -141,7 +142,7 @@ uint8_t Vdp::readHCounter(void)
 uint8_t Vdp::readVCounter(void)
 {
 	unsigned int odo_68K = M68K::ReadOdometer();
-	odo_68K -= (M68K_Mem::Cycles_M68K - M68K_Mem::CPL_M68K);
+	odo_68K -= (M68K_Mem::ms_State->Cycles_M68K - M68K_Mem::ms_State->CPL_M68K);
 	odo_68K &= 0x1FF;
 
 	unsigned int H_Counter;
@@ -234,6 +235,13 @@ void Vdp::writeTestRegMD_8(uint8_t data)
  */
 uint16_t Vdp::readCtrlMD(void)
 {
+	// Wait for the render thread to finish all queued lines
+	// that can set the sprite collision and overflow bits.
+	// Those bits must be set before the status register is
+	// read, since reading it clears them. Other lines don't
+	// affect the status register, so they're not waited for.
+	d->rendSyncStatus();
+
 	const uint16_t status = d->Reg_Status.read();
 
 	// Reading the control port clears the control word latch.
@@ -339,6 +347,8 @@ void Vdp::writeDataMD_8(uint8_t data)
  */
 void Vdp::writeDataMD(uint16_t data)
 {
+	d->rendSync();
+
 	LOG_MSG(vdp_io, LOG_MSG_LEVEL_DEBUG2,
 		"VDP_Ctrl.code == %02X, VDP_Ctrl.address == %04X, data == %04X",
 		d->VDP_Ctrl.code, d->VDP_Ctrl.address, data);
@@ -383,9 +393,11 @@ void VdpPrivate::vdpDataWrite_int(uint16_t data)
 				tmp_data = data;
 			}
 			VRam.u16[address>>1] = tmp_data;
+			patternCache.mark_dirty(address);
 			if ((address & Spr_Tbl_Mask) == Spr_Tbl_Addr) {
 				// Sprite Attribute Table.
 				SprAttrTbl_m5.w[(address & ~Spr_Tbl_Mask) >> 1] = tmp_data;
+				sprSpans.dirty = true;
 			}
 			break;
 		}
@@ -431,6 +443,40 @@ void VdpPrivate::vdpDataWrite_int(uint16_t data)
 	VDP_Ctrl.address &= VRam_Mask;
 }
 
+/**
+ * Write a block of words to VRAM.
+ * Used by DMA and the debug interface.
+ * This updates the pattern cache and the cached SAT.
+ * @param address Destination address. (Must be even; must not wrap.)
+ * @param src Source data, in host byte order.
+ * @param words Number of words.
+ */
+void VdpPrivate::vdpWriteVRamBlock(uint32_t address, const uint16_t *src, unsigned int words)
+{
+	assert(!(address & 1));
+	assert(address + (words * 2) <= sizeof(VRam.u8));
+
+	const uint32_t end = address + (words * 2);
+	memcpy(&VRam.u16[address >> 1], src, words * 2);
+
+	// Mark the affected pattern lines as dirty.
+	// (One pattern line is 4 bytes.)
+	for (uint32_t addr = (address & ~3); addr < end; addr += 4) {
+		patternCache.mark_dirty(addr);
+	}
+
+	// Check if the write overlaps the Sprite Attribute Table.
+	const uint32_t SAT_min = Spr_Tbl_Addr;
+	const uint32_t SAT_max = SAT_min + (~Spr_Tbl_Mask & 0xFFFF) + 1;
+	const uint32_t ov_min = (address > SAT_min ? address : SAT_min);
+	const uint32_t ov_max = (end < SAT_max ? end : SAT_max);
+	if (ov_min < ov_max) {
+		memcpy(&SprAttrTbl_m5.w[(ov_min - SAT_min) >> 1],
+		       &src[(ov_min - address) >> 1], ov_max - ov_min);
+		sprSpans.dirty = true;
+	}
+}
+
 /**
  * Write to the VDP control port. (M5, 8-bit)
  * Convenience function. This function doubles the bytes
@@ -458,6 +504,8 @@ void Vdp::writeCtrlMD_8(uint8_t ctrl)
  */
 void Vdp::writeCtrlMD(uint16_t ctrl)
 {
+	d->rendSync();
+
 	// TODO: Check endianness with regards to the control words. (Wordswapping!)
 
 	// Check if this is the first or second control word.
@@ -39,6 +39,9 @@ VdpPalettePrivate::VdpPalettePrivate(VdpPalette *q)
 	, maskedBgColorIdx(0)
 	, m5m4bits(0)
 	, mdShadowHighlight(false)
+	, palFullMD_key(0)
+	, palFullSMS_key(0)
+	, palFull32X_key(0)
 	, isAppOs(false)
 { }
 
@@ -97,8 +100,10 @@ VdpPalette::VdpPalette()
 	: d(new VdpPalettePrivate(this))
 	, cram_addr_mask(0x7F)
 	, m_bpp(MdFb::BPP_32)
+	, m_dirtyCRam(0)
 {
 	// Set the dirty flags.
+	m_dirty.data = 0;
 	m_dirty.active = true;
 	m_dirty.full = true;
 
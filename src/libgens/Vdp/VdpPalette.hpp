@@ -232,10 +232,24 @@ class VdpPalette
 			struct {
 				bool active	:1;
 				bool full	:1;
+				bool cram	:1;	// Only entries in m_dirtyCRam changed.
 				// TODO: Add a separate bit for 32X CRAM.
 			};
 		} m_dirty;
 
+		/**
+		 * Per-entry CRam dirty bits.
+		 * Bit n is set if CRam entry n was written since
+		 * the last update. Only valid if m_dirty.cram is set.
+		 */
+		uint64_t m_dirtyCRam;
+
+		/**
+		 * Mark a CRam entry as dirty.
+		 * @param address CRam address. (Masked with cram_addr_mask.)
+		 */
+		void markCRamDirty(uint8_t address);
+
 		/** Active palette recalculation functions. **/
 
 		template<typename pixel>
@@ -247,6 +261,11 @@ class VdpPalette
 					const pixel *palFullMD,
 					const pixel *palFullSMS);
 
+		template<typename pixel>
+		FORCE_INLINE void T_update_MD_entries(pixel *palActiveMD,
+						const pixel *palFullMD,
+						uint64_t dirty);
+
 		// TODO: Needs testing.
 		template<typename pixel>
 		FORCE_INLINE void T_update_32X(pixel *palActive32X,
@@ -272,6 +291,16 @@ class VdpPalette
 inline bool VdpPalette::isDirty(void) const
 	{ return !!(m_dirty.data); }
 
+/**
+ * Mark a CRam entry as dirty.
+ * @param address CRam address. (Masked with cram_addr_mask.)
+ */
+inline void VdpPalette::markCRamDirty(uint8_t address)
+{
+	m_dirtyCRam |= (1ULL << ((address >> 1) & 0x3F));
+	m_dirty.cram = true;
+}
+
 /** CRam functions. **/
 
 /**
@@ -312,8 +341,7 @@ inline void VdpPalette::writeCRam_8(uint8_t address, uint8_t data)
 	address &= cram_addr_mask;
 	// FIXME: Use U16DATA_U8_INVERT?
 	m_cram.u8[address] = data;
-	// TODO: Per-color dirty flag?
-	m_dirty.active = true;
+	markCRamDirty(address);
 }
 
 /**
@@ -328,8 +356,7 @@ inline void VdpPalette::writeCRam_16(uint8_t address, uint16_t data)
 
 	address &= cram_addr_mask;
 	m_cram.u16[address >> 1] = data;
-	// TODO: Per-color dirty flag?
-	m_dirty.active = true;
+	markCRamDirty(address);
 }
 
 /** 32X CRam functions. **/
@@ -123,8 +123,38 @@ class VdpPalettePrivate
 			int RMask, int GMask, int BMask>
 		FORCE_INLINE void T_recalcFull_CGA(pixel *palFullCGA);
 
+		template<typename pixel,
+			int RBits, int GBits, int BBits,
+			int RMask, int GMask, int BMask>
+		FORCE_INLINE void T_recalcFull(pixel *palFullMD,
+					       pixel *palFullSMS,
+					       pixel *palFull32X);
+
 		void recalcFull(void);
 
+		/**
+		 * Full palette contents.
+		 * Full palettes are only recalculated if the
+		 * contents or the color depth have changed.
+		 */
+		enum FullPalType_t {
+			FULLPAL_NONE = 0,
+			FULLPAL_MD,
+			FULLPAL_GG,
+			FULLPAL_SMS,
+			FULLPAL_TMS9918A,
+			FULLPAL_CGA,
+			FULLPAL_32X,
+		};
+
+		// Full palette keys: (FullPalType_t << 8) | bpp
+		// 0 == invalid.
+		uint16_t palFullMD_key;
+		uint16_t palFullSMS_key;
+		uint16_t palFull32X_key;
+
+		bool needsRecalc(uint16_t *key, FullPalType_t type);
+
 	public:
 		/**
 		 * Is the system running an app-based OS?
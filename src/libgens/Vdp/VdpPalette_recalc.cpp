@@ -22,11 +22,105 @@
  ***************************************************************************/
 
 #include "VdpPalette_p.hpp"
+#include "VdpPalette_recalc_x86.hpp"
+
+#include "libcompat/cpuflags.h"
 
 namespace LibGens {
 
+#ifdef HAVE_VDP_PALETTE_X86
+/**
+ * Combine color components using SIMD, if supported.
+ * @param dest Full palette.
+ * @param row Row of color components.
+ * @param rowCount Number of entries in row.
+ * @param bases Base colors.
+ * @param baseCount Number of base colors.
+ * @return True if the palette was combined; false if not.
+ */
+static FORCE_INLINE bool Combine_SIMD(uint16_t *dest, const uint16_t *row, int rowCount,
+				      const uint16_t *bases, int baseCount)
+{
+	if ((CPU_Flags & MDP_CPUFLAG_X86_SSE2) && (rowCount % 8) == 0) {
+		VdpPalette_Combine16_SSE2(dest, row, rowCount, bases, baseCount);
+		return true;
+	}
+	return false;
+}
+
+static FORCE_INLINE bool Combine_SIMD(uint32_t *dest, const uint32_t *row, int rowCount,
+				      const uint32_t *bases, int baseCount)
+{
+	if ((CPU_Flags & MDP_CPUFLAG_X86_SSE2) && (rowCount % 4) == 0) {
+		VdpPalette_Combine32_SSE2(dest, row, rowCount, bases, baseCount);
+		return true;
+	}
+	return false;
+}
+#endif /* HAVE_VDP_PALETTE_X86 */
+
+/**
+ * Calculate a full palette from per-component color values.
+ * Palette index format: [B][G][R], with CompBits bits per component.
+ * Each component is calculated once, and the components are
+ * combined one row of red values at a time.
+ * @param palFull Full palette. (Must have (1 << (CompBits * 3)) entries!)
+ * @param comp 8-bit color component values. (Must have (1 << CompBits) entries!)
+ */
+template<typename pixel,
+	int RBits, int GBits, int BBits,
+	int CompBits>
+static FORCE_INLINE void T_recalcFull_RGB(pixel *palFull, const uint8_t *comp)
+{
+	static const int CompCount = (1 << CompBits);
+
+	// Red components.
+	pixel row[CompCount];
+	for (int i = 0; i < CompCount; i++) {
+		row[i] = ((comp[i] >> (8 - RBits)) << (BBits + GBits));
+	}
+
+	// Green and blue components.
+	pixel bases[CompCount * CompCount];
+	for (int b = 0; b < CompCount; b++) {
+		for (int g = 0; g < CompCount; g++) {
+			bases[(b << CompBits) | g] =
+				((comp[g] >> (8 - GBits)) << BBits) |
+				(comp[b] >> (8 - BBits));
+		}
+	}
+
+	// Combine the color components.
+#ifdef HAVE_VDP_PALETTE_X86
+	if (Combine_SIMD(palFull, row, CompCount, bases, CompCount * CompCount))
+		return;
+#endif /* HAVE_VDP_PALETTE_X86 */
+	for (int j = 0; j < CompCount * CompCount; j++) {
+		const pixel base = bases[j];
+		for (int k = 0; k < CompCount; k++) {
+			*palFull++ = (base | row[k]);
+		}
+	}
+}
+
 /** VdpPalettePrivate **/
 
+/**
+ * Check if a full palette needs to be recalculated.
+ * If it does, the palette key is updated.
+ * @param key [in,out] Full palette key.
+ * @param type Full palette type.
+ * @return True if the full palette needs to be recalculated.
+ */
+bool VdpPalettePrivate::needsRecalc(uint16_t *key, FullPalType_t type)
+{
+	const uint16_t newKey = ((type << 8) | q->m_bpp);
+	if (*key == newKey)
+		return false;
+	*key = newKey;
+	return true;
+}
+
 /**
  * Recalculate the full palette. (Mega Drive)
  * @param palFullMD Full MD palette. (Must have enough space for at least 0x1000 entries!)
@@ -43,31 +137,8 @@ void VdpPalettePrivate::T_recalcFull_MD(pixel *palFullMD)
 		 145, 163, 182, 200, 218, 236, 255, 255};
 
 	// Calculate the MD palette.
-	for (int i = 0x0000; i < 0x1000; i++) {
-		// Scale the color components using the lookup table.
-		int r = PalComponent_MD[(i >> 0) & 0x000F];
-		int g = PalComponent_MD[(i >> 4) & 0x000F];
-		int b = PalComponent_MD[(i >> 8) & 0x000F];
-
-		// Reduce color components to original color depth.
-		r >>= (8 - RBits);
-		g >>= (8 - GBits);
-		b >>= (8 - BBits);
-
-		// TODO: Make this configurable?
-#if 0	
-		if (GMask == 0x3F) {
-			// 16-bit color. (RGB565)
-			// Mask off the LSB of the green component.
-			g &= ~1;
-		}
-#endif
-
-		// Combine the color components.
-		palFullMD[i] = (r << (BBits + GBits)) |
-			       (g << (BBits)) |
-			       (b);
-	}
+	// TODO: Mask off the LSB of the green component for RGB565?
+	T_recalcFull_RGB<pixel, RBits, GBits, BBits, 4>(palFullMD, PalComponent_MD);
 }
 
 /**
@@ -80,37 +151,19 @@ template<typename pixel,
 	int RMask, int GMask, int BMask>
 FORCE_INLINE void VdpPalettePrivate::T_recalcFull_32X(pixel *palFull32X)
 {
-	// Calculate the 32X palette. (first half)
-	for (int i = 0x0000; i < 0x8000; i++) {
-		// Sega 32X uses 15-bit color.
-		// Scale each component by using the following algorithm:
-		// - 32X component: abcde
-		// - RGB component: abcdeabc
-		// Example: 32X 0x15 (10101) -> RGB 0xAD (10101101)
-		int r = ((i << 3) & 0x00F8);	r |= (r >> 5);
-		int g = ((i >> 2) & 0x00F8);	g |= (g >> 5);
-		int b = ((i >> 7) & 0x00F8);	b |= (b >> 5);
-
-		// Reduce color components to original color depth.
-		r >>= (8 - RBits);
-		g >>= (8 - GBits);
-		b >>= (8 - BBits);
-
-		// TODO: Make this configurable?
-#if 0	
-		if (GMask == 0x3F) {
-			// 16-bit color. (RGB565)
-			// Mask off the LSB of the green component.
-			g &= ~1;
-		}
-#endif
-
-		// Combine the color components.
-		palFull32X[i] = (r << (BBits + GBits)) |
-				(g << (BBits)) |
-				(b);
+	// Sega 32X uses 15-bit color.
+	// Scale each component by using the following algorithm:
+	// - 32X component: abcde
+	// - RGB component: abcdeabc
+	// Example: 32X 0x15 (10101) -> RGB 0xAD (10101101)
+	uint8_t PalComponent_32X[32];
+	for (int i = 0; i < 32; i++) {
+		PalComponent_32X[i] = ((i << 3) | (i >> 2));
 	}
 
+	// Calculate the 32X palette. (first half)
+	T_recalcFull_RGB<pixel, RBits, GBits, BBits, 5>(palFull32X, PalComponent_32X);
+
 	// Copy the palette from the first half of palFull32X to the second half.
 	// TODO: Is it better to do this, or should we just mask palette entries by 0x7FFF?
 	memcpy(&palFull32X[0x8000], &palFull32X[0], (0x8000 * sizeof(palFull32X[0])));
@@ -137,31 +190,7 @@ FORCE_INLINE void VdpPalettePrivate::T_recalcFull_SMS(pixel *palFullSMS)
 	static const uint8_t PalComponent_SMS[4] = {0x00, 0x55, 0xAA, 0xFF};
 
 	// Calculate the SMS palette.
-	for (int i = 0x00; i < 0x40; i++) {
-		// Scale the color components using the lookup table.
-		int r = PalComponent_SMS[i & 0x03];
-		int g = PalComponent_SMS[(i >> 2) & 0x03];
-		int b = PalComponent_SMS[(i >> 4) & 0x03];
-
-		// Reduce color components to original color depth.
-		r >>= (8 - RBits);
-		g >>= (8 - GBits);
-		b >>= (8 - BBits);
-
-		// TODO: Make this configurable?
-#if 0	
-		if (GMask == 0x3F) {
-			// 16-bit color. (RGB565)
-			// Mask off the LSB of the green component.
-			g &= ~1;
-		}
-#endif
-
-		// Combine the color components.
-		palFullSMS[i] = (r << (BBits + GBits)) |
-				(g << (BBits)) |
-				(b);
-	}
+	T_recalcFull_RGB<pixel, RBits, GBits, BBits, 2>(palFullSMS, PalComponent_SMS);
 }
 
 /**
@@ -174,33 +203,14 @@ template<typename pixel,
 	int RMask, int GMask, int BMask>
 FORCE_INLINE void VdpPalettePrivate::T_recalcFull_GG(pixel *palFullGG)
 {
-	// Calculate the SMS palette.
-	for (int i = 0x0000; i < 0x1000; i++) {
-		// Game Gear uses 12-bit color.
-		// Scale each component by using the same 4 bits for each nybble.
-		int r = (i & 0x000F);		r |= (r << 4);
-		int g = ((i >> 4) & 0x000F);	g |= (g << 4);
-		int b = ((i >> 8) & 0x000F);	b |= (b << 4);
-
-		// Reduce color components to original color depth.
-		r >>= (8 - RBits);
-		g >>= (8 - GBits);
-		b >>= (8 - BBits);
-
-		// TODO: Make this configurable?
-#if 0	
-		if (GMask == 0x3F) {
-			// 16-bit color. (RGB565)
-			// Mask off the LSB of the green component.
-			g &= ~1;
-		}
-#endif
-
-		// Combine the color components.
-		palFullGG[i] = (r << (BBits + GBits)) |
-			       (g << (BBits)) |
-			       (b);
-	}
+	// Game Gear uses 12-bit color.
+	// Scale each component by using the same 4 bits for each nybble.
+	static const uint8_t PalComponent_GG[16] =
+		{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+		 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+	// Calculate the GG palette.
+	T_recalcFull_RGB<pixel, RBits, GBits, BBits, 4>(palFullGG, PalComponent_GG);
 }
 
 /**
@@ -340,6 +350,60 @@ FORCE_INLINE void VdpPalettePrivate::T_recalcFull_CGA(pixel *palFullCGA)
 	}
 }
 
+/**
+ * Recalculate the full palettes used by the current palette mode.
+ * Full palettes that are already up to date are not recalculated.
+ * @param palFullMD Full MD/GG palette.
+ * @param palFullSMS Full SMS/TMS9918A palette.
+ * @param palFull32X Full 32X palette.
+ */
+template<typename pixel,
+	int RBits, int GBits, int BBits,
+	int RMask, int GMask, int BMask>
+FORCE_INLINE void VdpPalettePrivate::T_recalcFull(pixel *palFullMD,
+						  pixel *palFullSMS,
+						  pixel *palFull32X)
+{
+	switch (this->palMode) {
+		case VdpPalette::PALMODE_32X:
+			if (needsRecalc(&palFull32X_key, FULLPAL_32X)) {
+				T_recalcFull_32X<pixel, RBits, GBits, BBits,
+					RMask, GMask, BMask>(palFull32X);
+			}
+			// NOTE: 32X falls through to MD, since both 32X and MD palettes must be updated.
+			// TODO: Add a separate dirty flag for the 32X palette?
+			// FALLTHROUGH
+		case VdpPalette::PALMODE_MD:
+		default:
+			if (needsRecalc(&palFullMD_key, FULLPAL_MD)) {
+				T_recalcFull_MD<pixel, RBits, GBits, BBits,
+					RMask, GMask, BMask>(palFullMD);
+			}
+			// Also recalculate the SMS palette in case we switch to Mode 4.
+			// FALLTHROUGH
+		case VdpPalette::PALMODE_SMS:
+			if (needsRecalc(&palFullSMS_key, FULLPAL_SMS)) {
+				T_recalcFull_SMS<pixel, RBits, GBits, BBits,
+					RMask, GMask, BMask>(palFullSMS);
+			}
+			break;
+
+		// Game Gear and TMS9918A don't support other CRAM modes.
+		case VdpPalette::PALMODE_GG:
+			if (needsRecalc(&palFullMD_key, FULLPAL_GG)) {
+				T_recalcFull_GG<pixel, RBits, GBits, BBits,
+					RMask, GMask, BMask>(palFullMD);
+			}
+			break;
+		case VdpPalette::PALMODE_TMS9918A:
+			if (needsRecalc(&palFullSMS_key, FULLPAL_TMS9918A)) {
+				T_recalcFull_TMS9918A<pixel, RBits, GBits, BBits,
+					RMask, GMask, BMask>(palFullSMS);
+			}
+			break;
+	}
+}
+
 /**
  * Recalculate the full VDP palette.
  */
@@ -348,22 +412,26 @@ void VdpPalettePrivate::recalcFull(void)
 	if (isAppOs) {
 		// App-based OS.
 		// TODO: 32X?
+		const bool recalc = needsRecalc(&palFullSMS_key, FULLPAL_CGA);
 		switch (q->m_bpp) {
 			case MdFb::BPP_15:
-				T_recalcFull_CGA<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFullSMS.u16);
+				if (recalc)
+					T_recalcFull_CGA<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFullSMS.u16);
 				for (int i = 0; i < 0x100; i += 10) {
 					memcpy(&q->m_palActive.u16[i], &palFullSMS.u16[0], sizeof(q->m_palActive.u16[0]) * 16);
 				}
 				break;
 			case MdFb::BPP_16:
-				T_recalcFull_CGA<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFullSMS.u16);
+				if (recalc)
+					T_recalcFull_CGA<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFullSMS.u16);
 				for (int i = 0; i < 0x100; i += 10) {
 					memcpy(&q->m_palActive.u16[i], &palFullSMS.u16[0], sizeof(q->m_palActive.u16[0]) * 16);
 				}
 				break;
 			case MdFb::BPP_32:
 			default:
-				T_recalcFull_CGA<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFullSMS.u32);
+				if (recalc)
+					T_recalcFull_CGA<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFullSMS.u32);
 				for (int i = 0; i < 0x100; i += 10) {
 					memcpy(&q->m_palActive.u32[i], &palFullSMS.u32[0], sizeof(q->m_palActive.u32[0]) * 16);
 				}
@@ -378,82 +446,17 @@ void VdpPalettePrivate::recalcFull(void)
 	// TODO: Add an AND to each switch() for optimization?
 	switch (q->m_bpp) {
 		case MdFb::BPP_15:
-			switch (this->palMode) {
-				case VdpPalette::PALMODE_32X:
-					T_recalcFull_32X<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFull32X.u16);
-					// NOTE: 32X falls through to MD, since both 32X and MD palettes must be updated.
-					// TODO: Add a separate dirty flag for the 32X palette?
-					// FALLTHROUGH
-				case VdpPalette::PALMODE_MD:
-				default:
-					T_recalcFull_MD<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFullMD.u16);
-					// Also recalculate the SMS palette in case we switch to Mode 4.
-					// FALLTHROUGH
-				case VdpPalette::PALMODE_SMS:
-					T_recalcFull_SMS<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFullSMS.u16);
-					break;
-
-				// Game Gear and TMS9918A don't support other CRAM modes.
-				case VdpPalette::PALMODE_GG:
-					T_recalcFull_GG<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFullMD.u16);
-					break;
-				case VdpPalette::PALMODE_TMS9918A:
-					T_recalcFull_TMS9918A<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(palFullSMS.u16);
-					break;
-			}
+			T_recalcFull<uint16_t, 5, 5, 5, 0x1F, 0x1F, 0x1F>(
+				palFullMD.u16, palFullSMS.u16, palFull32X.u16);
 			break;
-
 		case MdFb::BPP_16:
-			switch (this->palMode) {
-				case VdpPalette::PALMODE_32X:
-					T_recalcFull_32X<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFull32X.u16);
-					// NOTE: 32X falls through to MD, since both 32X and MD palettes must be updated.
-					// TODO: Add a separate dirty flag for the 32X palette?
-					// FALLTHROUGH
-				case VdpPalette::PALMODE_MD:
-				default:
-					T_recalcFull_MD<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFullMD.u16);
-					// Also recalculate the SMS palette in case we switch to Mode 4.
-					// FALLTHROUGH
-				case VdpPalette::PALMODE_SMS:
-					T_recalcFull_SMS<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFullSMS.u16);
-					break;
-
-				// Game Gear and TMS9918A don't support other CRAM modes.
-				case VdpPalette::PALMODE_GG:
-					T_recalcFull_GG<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFullMD.u16);
-					break;
-				case VdpPalette::PALMODE_TMS9918A:
-					T_recalcFull_TMS9918A<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(palFullSMS.u16);
-					break;
-			}
+			T_recalcFull<uint16_t, 5, 6, 5, 0x1F, 0x3F, 0x1F>(
+				palFullMD.u16, palFullSMS.u16, palFull32X.u16);
 			break;
-
 		case MdFb::BPP_32:
 		default:
-			switch (this->palMode) {
-				case VdpPalette::PALMODE_32X:
-					T_recalcFull_32X<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFull32X.u32);
-					// NOTE: 32X falls through to MD, since both 32X and MD palettes must be updated.
-					// TODO: Add a separate dirty flag for the 32X palette?
-					// FALLTHROUGH
-				case VdpPalette::PALMODE_MD:
-				default:
-					T_recalcFull_MD<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFullMD.u32);
-					// Also recalculate the SMS palette in case we switch to Mode 4.
-					// FALLTHROUGH
-				case VdpPalette::PALMODE_SMS:
-					T_recalcFull_SMS<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFullSMS.u32);
-					break;
-
-				// Game Gear and TMS9918A don't support other CRAM modes.
-				case VdpPalette::PALMODE_GG:
-					T_recalcFull_GG<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFullMD.u32);
-					break;
-				case VdpPalette::PALMODE_TMS9918A:
-					T_recalcFull_TMS9918A<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(palFullSMS.u32);
-					break;
-			}
+			T_recalcFull<uint32_t, 8, 8, 8, 0xFF, 0xFF, 0xFF>(
+				palFullMD.u32, palFullSMS.u32, palFull32X.u32);
 			break;
 	}
 
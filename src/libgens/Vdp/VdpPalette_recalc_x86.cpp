@@ -0,0 +1,79 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VdpPalette_recalc_x86.cpp: VDP palette recalculation. (x86 SIMD)        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "VdpPalette_recalc_x86.hpp"
+
+#ifdef HAVE_VDP_PALETTE_X86
+
+#include <cassert>
+#include <emmintrin.h>
+
+namespace LibGens {
+
+/**
+ * Combine a row of color components with a list of base colors. (SSE2-optimized)
+ * dest[(j * rowCount) + k] = (bases[j] | row[k])
+ * @param dest		[out] Full palette.
+ * @param row		[in] Row of color components.
+ * @param rowCount	[in] Number of entries in row. (Must be a multiple of 8!)
+ * @param bases		[in] Base colors.
+ * @param baseCount	[in] Number of base colors.
+ */
+__attribute__((target("sse2")))
+void VdpPalette_Combine16_SSE2(uint16_t *dest, const uint16_t *row, int rowCount,
+			       const uint16_t *bases, int baseCount)
+{
+	assert(rowCount % 8 == 0);
+	for (; baseCount > 0; baseCount--, bases++) {
+		const __m128i base = _mm_set1_epi16(static_cast<short>(*bases));
+		for (int k = 0; k < rowCount; k += 8, dest += 8) {
+			const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row[k]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_or_si128(base, r));
+		}
+	}
+}
+
+/**
+ * Combine a row of color components with a list of base colors. (SSE2-optimized)
+ * dest[(j * rowCount) + k] = (bases[j] | row[k])
+ * @param dest		[out] Full palette.
+ * @param row		[in] Row of color components.
+ * @param rowCount	[in] Number of entries in row. (Must be a multiple of 4!)
+ * @param bases		[in] Base colors.
+ * @param baseCount	[in] Number of base colors.
+ */
+__attribute__((target("sse2")))
+void VdpPalette_Combine32_SSE2(uint32_t *dest, const uint32_t *row, int rowCount,
+			       const uint32_t *bases, int baseCount)
+{
+	assert(rowCount % 4 == 0);
+	for (; baseCount > 0; baseCount--, bases++) {
+		const __m128i base = _mm_set1_epi32(static_cast<int>(*bases));
+		for (int k = 0; k < rowCount; k += 4, dest += 4) {
+			const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row[k]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_or_si128(base, r));
+		}
+	}
+}
+
+}
+
+#endif /* HAVE_VDP_PALETTE_X86 */
@@ -0,0 +1,67 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VdpPalette_recalc_x86.hpp: VDP palette recalculation. (x86 SIMD)        *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __LIBGENS_VDP_VDPPALETTE_RECALC_X86_HPP__
+#define __LIBGENS_VDP_VDPPALETTE_RECALC_X86_HPP__
+
+#include <stdint.h>
+
+// The SIMD kernels are built with per-function target attributes,
+// so they don't require the entire library to be built with -msse2.
+#if (defined(__i386__) || defined(__amd64__) || defined(__x86_64__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define HAVE_VDP_PALETTE_X86 1
+#endif
+
+#ifdef HAVE_VDP_PALETTE_X86
+
+namespace LibGens {
+
+/**
+ * Combine a row of color components with a list of base colors. (SSE2-optimized)
+ * dest[(j * rowCount) + k] = (bases[j] | row[k])
+ * @param dest		[out] Full palette.
+ * @param row		[in] Row of color components.
+ * @param rowCount	[in] Number of entries in row. (Must be a multiple of 8!)
+ * @param bases		[in] Base colors.
+ * @param baseCount	[in] Number of base colors.
+ */
+void VdpPalette_Combine16_SSE2(uint16_t *dest, const uint16_t *row, int rowCount,
+			       const uint16_t *bases, int baseCount);
+
+/**
+ * Combine a row of color components with a list of base colors. (SSE2-optimized)
+ * dest[(j * rowCount) + k] = (bases[j] | row[k])
+ * @param dest		[out] Full palette.
+ * @param row		[in] Row of color components.
+ * @param rowCount	[in] Number of entries in row. (Must be a multiple of 4!)
+ * @param bases		[in] Base colors.
+ * @param baseCount	[in] Number of base colors.
+ */
+void VdpPalette_Combine32_SSE2(uint32_t *dest, const uint32_t *row, int rowCount,
+			       const uint32_t *bases, int baseCount);
+
+}
+
+#endif /* HAVE_VDP_PALETTE_X86 */
+
+#endif /* __LIBGENS_VDP_VDPPALETTE_RECALC_X86_HPP__ */
@@ -160,6 +160,56 @@ FORCE_INLINE void VdpPalette::T_update_MD(pixel *palActiveMD,
 	}
 }
 
+/**
+ * Recalculate individual entries in the active palette. (Mega Drive, Mode 5)
+ * This is used if only CRam has changed since the last update.
+ * The shadow/highlight variants of each entry are also updated.
+ * @param palActiveMD Active MD palette. (Must have 0x100 entries!)
+ * @param palFullMD Full MD palette. (Must have 0x1000 entries!)
+ * @param dirty Dirty CRam entries. (Bit n == entry n)
+ */
+template<typename pixel>
+FORCE_INLINE void VdpPalette::T_update_MD_entries(pixel *palActiveMD,
+					    const pixel *palFullMD,
+					    uint64_t dirty)
+{
+	// Mode 5, PSEL=0: CRAM masks all but the LSB.
+	// Mode 5, PSEL=1: Normal operation.
+	const uint16_t mdColorMask = ((d->m5m4bits & 0x01) ? 0xEEE : 0x222);
+	const int bgIdx = d->maskedBgColorIdx;
+
+	// Entry 0 is replaced with the background color,
+	// so it has to be updated if either entry changes.
+	const bool bgDirty = !!(dirty & ((1ULL << bgIdx) | 1ULL));
+
+	for (int i = 0; dirty != 0; i++, dirty >>= 1) {
+		if (!(dirty & 1))
+			continue;
+
+		const uint16_t color_raw = (m_cram.u16[i] & mdColorMask);
+		palActiveMD[i] = palFullMD[color_raw];
+
+		if (d->mdShadowHighlight) {
+			// Shadow, highlight, and shadow+highlight colors.
+			// See T_update_MD() for details.
+			const uint16_t sh_raw = (color_raw >> 1);
+			palActiveMD[i + 64]  = palFullMD[sh_raw];
+			palActiveMD[i + 128] = palFullMD[(0x888 | sh_raw) - 0x111];
+			palActiveMD[i + 192] = palActiveMD[i];
+		}
+	}
+
+	if (bgDirty) {
+		// Update the background color.
+		palActiveMD[0] = palActiveMD[bgIdx];
+		if (d->mdShadowHighlight) {
+			palActiveMD[64]  = palActiveMD[bgIdx + 64];	// Shadow color.
+			palActiveMD[128] = palActiveMD[bgIdx + 128];	// Highlight color.
+			palActiveMD[192] = palActiveMD[0];		// Normal color.
+		}
+	}
+}
+
 /**
  * Recalculate the active palette. (32X)
  * TODO: Needs testing.
@@ -323,11 +373,29 @@ void VdpPalette::update(void)
 {
 	if (m_dirty.full)
 		d->recalcFull();
-	if (!m_dirty.active)
+	if (!m_dirty.active && !m_dirty.cram)
 		return;
 	if (d->isAppOs)
 		return;
 
+	if (!m_dirty.active &&
+	    (d->palMode == PALMODE_MD || d->palMode == PALMODE_32X) &&
+	    (d->m5m4bits & 0x02))
+	{
+		// Only some CRam entries have changed in Mode 5.
+		// Recalculate those entries instead of the entire palette.
+		// NOTE: The 32X palette doesn't use MD CRam.
+		if (m_bpp != MdFb::BPP_32) {
+			T_update_MD_entries<uint16_t>(m_palActive.u16, d->palFullMD.u16, m_dirtyCRam);
+		} else {
+			T_update_MD_entries<uint32_t>(m_palActive.u32, d->palFullMD.u32, m_dirtyCRam);
+		}
+
+		m_dirty.cram = false;
+		m_dirtyCRam = 0;
+		return;
+	}
+
 	// TODO: Add an AND to each switch() for optimization?
 	if (m_bpp != MdFb::BPP_32) {
 		switch (d->palMode) {
@@ -381,8 +449,10 @@ void VdpPalette::update(void)
 		}
 	}
 
-	// Clear the active palette dirty bit.
+	// Clear the active palette dirty bits.
 	m_dirty.active = false;
+	m_dirty.cram = false;
+	m_dirtyCRam = 0;
 }
 
 // TODO: Port to LibGens: T_update_32X()
@@ -62,6 +62,11 @@ void VdpPrivate::updateVdpMode(void)
 		// NOTE: The AND is probably not necessary...
 		palette.setM5M4bits((VDP_Mode >> 3) & 0x03);
 
+		// Mode 4 and Mode 5 patterns are decoded differently.
+		if ((prevVdpMode ^ VDP_Mode) & (VdpTypes::VDP_MODE_M4 | VdpTypes::VDP_MODE_M5)) {
+			patternCache.invalidate();
+		}
+
 		if (!(VDP_Mode & VdpTypes::VDP_MODE_M2)) {
 			// V28 mode. Reset the NTSC V30 roll values.
 			// TODO: Also if changed from NTSC to PAL?
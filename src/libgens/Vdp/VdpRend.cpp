@@ -73,6 +73,10 @@ void VdpPrivate::rend_reset(void)
 	memset(sprLineCache, 0, sizeof(sprLineCache));
 	memset(sprCountCache, 0, sizeof(sprCountCache));
 
+	// Sprite Y-span index.
+	memset(&sprSpans, 0, sizeof(sprSpans));
+	sprSpans.dirty = true;
+
 	// Sprite dot overflow flag.
 	sprDotOverflow = false;
 }
@@ -82,24 +86,12 @@ void VdpPrivate::rend_reset(void)
  */
 void Vdp::renderLine(void)
 {
-	// TODO: 32X-specific function.
-	if (d->VDP_Mode & VdpTypes::VDP_MODE_M5) {
-		// Mode 5.
-		// TODO: Port to LibGens.
-		if (SysStatus._32X) {
-#if 0
-			d->renderLine_m5_32X();
-#endif
-		} else {
-			d->renderLine_m5();
-		}
+	if (d->rendThread) {
+		// Threaded rendering.
+		d->rendQueueLine();
 	} else {
-		// Unsupported mode.
-		d->renderLine_Err();
+		d->renderLine_int();
 	}
-
-	// Update the VDP render error cache.
-	d->updateErr();
 }
 
 }
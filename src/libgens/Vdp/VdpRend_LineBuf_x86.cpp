@@ -0,0 +1,147 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VdpRend_LineBuf_x86.cpp: VDP line buffer conversion. (x86 SIMD)         *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "VdpRend_LineBuf_x86.hpp"
+
+#ifdef HAVE_VDP_LINEBUF_X86
+
+#include <immintrin.h>
+
+namespace LibGens {
+
+/**
+ * Convert line buffer pixels to 16-bit color. (AVX2-optimized)
+ * The pixel index is the low byte of each line buffer word.
+ * @param dest		[out] Destination surface.
+ * @param linebuf	[in] Line buffer. (LineBuf.u16)
+ * @param md_palette	[in] MD palette. (256 entries)
+ * @param count		[in] Number of pixels.
+ */
+__attribute__((target("avx2")))
+void VdpRend_LineBuf16_AVX2(uint16_t *dest, const uint16_t *linebuf,
+			    const uint16_t *md_palette, int count)
+{
+	// There's no 16-bit gather, so gather the 32-bit palette
+	// word containing each entry and shift the entry down.
+	// This never reads past the end of the 256-entry palette.
+	const int *pal32 = reinterpret_cast<const int*>(md_palette);
+	const __m256i idx_mask = _mm256_set1_epi16(0x00FF);
+	const __m256i one = _mm256_set1_epi32(1);
+
+	// Convert 16 pixels at once.
+	for (; count >= 16; count -= 16, dest += 16, linebuf += 16) {
+		const __m256i px = _mm256_and_si256(idx_mask,
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(linebuf)));
+		const __m256i idx0 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(px));
+		const __m256i idx1 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(px, 1));
+
+		__m256i c0 = _mm256_i32gather_epi32(pal32, _mm256_srli_epi32(idx0, 1), 4);
+		__m256i c1 = _mm256_i32gather_epi32(pal32, _mm256_srli_epi32(idx1, 1), 4);
+		c0 = _mm256_srlv_epi32(c0, _mm256_slli_epi32(_mm256_and_si256(idx0, one), 4));
+		c1 = _mm256_srlv_epi32(c1, _mm256_slli_epi32(_mm256_and_si256(idx1, one), 4));
+		c0 = _mm256_and_si256(c0, _mm256_set1_epi32(0xFFFF));
+		c1 = _mm256_and_si256(c1, _mm256_set1_epi32(0xFFFF));
+
+		// packus works per 128-bit lane; fix up the qword order.
+		const __m256i out = _mm256_permute4x64_epi64(
+			_mm256_packus_epi32(c0, c1), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), out);
+	}
+
+	// Remaining pixels.
+	for (; count > 0; count--, dest++, linebuf++) {
+		*dest = md_palette[*linebuf & 0xFF];
+	}
+}
+
+/**
+ * Convert line buffer pixels to 32-bit color. (AVX2-optimized)
+ * The pixel index is the low byte of each line buffer word.
+ * @param dest		[out] Destination surface.
+ * @param linebuf	[in] Line buffer. (LineBuf.u16)
+ * @param md_palette	[in] MD palette. (256 entries)
+ * @param count		[in] Number of pixels.
+ */
+__attribute__((target("avx2")))
+void VdpRend_LineBuf32_AVX2(uint32_t *dest, const uint16_t *linebuf,
+			    const uint32_t *md_palette, int count)
+{
+	const int *pal32 = reinterpret_cast<const int*>(md_palette);
+	const __m256i idx_mask = _mm256_set1_epi16(0x00FF);
+
+	// Convert 16 pixels at once.
+	for (; count >= 16; count -= 16, dest += 16, linebuf += 16) {
+		const __m256i px = _mm256_and_si256(idx_mask,
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(linebuf)));
+		const __m256i idx0 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(px));
+		const __m256i idx1 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(px, 1));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+			_mm256_i32gather_epi32(pal32, idx0, 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 8),
+			_mm256_i32gather_epi32(pal32, idx1, 4));
+	}
+
+	// Remaining pixels.
+	for (; count > 0; count--, dest++, linebuf++) {
+		*dest = md_palette[*linebuf & 0xFF];
+	}
+}
+
+/**
+ * Fill a border region with a 16-bit color. (SSE2-optimized)
+ * @param dest		[out] Destination surface.
+ * @param color		[in] Border color.
+ * @param count		[in] Number of pixels.
+ */
+__attribute__((target("sse2")))
+void VdpRend_Fill16_SSE2(uint16_t *dest, uint16_t color, int count)
+{
+	const __m128i c = _mm_set1_epi16(static_cast<short>(color));
+	for (; count >= 8; count -= 8, dest += 8) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), c);
+	}
+	for (; count > 0; count--, dest++) {
+		*dest = color;
+	}
+}
+
+/**
+ * Fill a border region with a 32-bit color. (SSE2-optimized)
+ * @param dest		[out] Destination surface.
+ * @param color		[in] Border color.
+ * @param count		[in] Number of pixels.
+ */
+__attribute__((target("sse2")))
+void VdpRend_Fill32_SSE2(uint32_t *dest, uint32_t color, int count)
+{
+	const __m128i c = _mm_set1_epi32(static_cast<int>(color));
+	for (; count >= 4; count -= 4, dest += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), c);
+	}
+	for (; count > 0; count--, dest++) {
+		*dest = color;
+	}
+}
+
+}
+
+#endif /* HAVE_VDP_LINEBUF_X86 */
@@ -0,0 +1,81 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VdpRend_LineBuf_x86.hpp: VDP line buffer conversion. (x86 SIMD)         *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __LIBGENS_VDP_VDPREND_LINEBUF_X86_HPP__
+#define __LIBGENS_VDP_VDPREND_LINEBUF_X86_HPP__
+
+#include <stdint.h>
+
+// The SIMD kernels are built with per-function target attributes,
+// so they don't require the entire library to be built with -mavx2.
+#if (defined(__i386__) || defined(__amd64__) || defined(__x86_64__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define HAVE_VDP_LINEBUF_X86 1
+#endif
+
+#ifdef HAVE_VDP_LINEBUF_X86
+
+namespace LibGens {
+
+/**
+ * Convert line buffer pixels to 16-bit color. (AVX2-optimized)
+ * The pixel index is the low byte of each line buffer word.
+ * @param dest		[out] Destination surface.
+ * @param linebuf	[in] Line buffer. (LineBuf.u16)
+ * @param md_palette	[in] MD palette. (256 entries)
+ * @param count		[in] Number of pixels.
+ */
+void VdpRend_LineBuf16_AVX2(uint16_t *dest, const uint16_t *linebuf,
+			    const uint16_t *md_palette, int count);
+
+/**
+ * Convert line buffer pixels to 32-bit color. (AVX2-optimized)
+ * The pixel index is the low byte of each line buffer word.
+ * @param dest		[out] Destination surface.
+ * @param linebuf	[in] Line buffer. (LineBuf.u16)
+ * @param md_palette	[in] MD palette. (256 entries)
+ * @param count		[in] Number of pixels.
+ */
+void VdpRend_LineBuf32_AVX2(uint32_t *dest, const uint16_t *linebuf,
+			    const uint32_t *md_palette, int count);
+
+/**
+ * Fill a border region with a 16-bit color. (SSE2-optimized)
+ * @param dest		[out] Destination surface.
+ * @param color		[in] Border color.
+ * @param count		[in] Number of pixels.
+ */
+void VdpRend_Fill16_SSE2(uint16_t *dest, uint16_t color, int count);
+
+/**
+ * Fill a border region with a 32-bit color. (SSE2-optimized)
+ * @param dest		[out] Destination surface.
+ * @param color		[in] Border color.
+ * @param count		[in] Number of pixels.
+ */
+void VdpRend_Fill32_SSE2(uint32_t *dest, uint32_t color, int count);
+
+}
+
+#endif /* HAVE_VDP_LINEBUF_X86 */
+
+#endif /* __LIBGENS_VDP_VDPREND_LINEBUF_X86_HPP__ */
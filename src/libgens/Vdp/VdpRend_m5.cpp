@@ -33,6 +33,10 @@
 // ARRAY_SIZE(x)
 #include "macros/common.h"
 
+// SIMD line buffer conversion.
+#include "libcompat/cpuflags.h"
+#include "VdpRend_LineBuf_x86.hpp"
+
 // TODO: Maybe move these to class enum constants?
 #define LINEBUF_HIGH_B	0x80	/* Highlighted. */
 #define LINEBUF_SHAD_B	0x40	/* Shadowed. */
@@ -101,7 +105,7 @@ template<bool interlaced>
 FORCE_INLINE int VdpPrivate::T_GetLineNumber(void) const
 {
 	// Get the current line number.
-	int vdp_line = q->VDP_Lines.currentLine;
+	int vdp_line = rendLines->currentLine;
 
 	if (interlaced) {
 		// Adjust the VDP line number for Flickering Interlaced display.
@@ -121,7 +125,7 @@ FORCE_INLINE int VdpPrivate::T_GetLineNumber(void) const
 
 			case VdpTypes::INTREND_FLICKER:
 				// Flickering Interlaced mode.
-				if (Reg_Status.isOddFrame())
+				if (rendStatus->isOddFrame())
 					vdp_line++;
 				break;
 		}
@@ -470,7 +474,7 @@ FORCE_INLINE void VdpPrivate::T_PutLine_Sprite(int disp_pixnum, uint32_t pattern
 
 	// Check for sprite collision.
 	if (status & LINEBUF_SPR_B)
-		Reg_Status.setBit(VdpStatus::VDP_STATUS_COLLISION, true);
+		setRendStatusBit(VdpStatus::VDP_STATUS_COLLISION);
 }
 
 /**
@@ -483,7 +487,7 @@ FORCE_INLINE uint16_t VdpPrivate::T_Get_X_Offset(void)
 {
 	// NOTE: Multiply by 4 for 16-bit access.
 	// * 2 == select A/B; * 2 == 16-bit
-	const unsigned int H_Scroll_Offset = (q->VDP_Lines.currentLine & H_Scroll_Mask) * 4;
+	const unsigned int H_Scroll_Offset = (rendLines->currentLine & H_Scroll_Mask) * 4;
 
 	if (plane) {
 		// Scroll A.
@@ -626,6 +630,8 @@ FORCE_INLINE uint16_t VdpPrivate::T_Get_Nametable_Word(unsigned int x, unsigned
 
 /**
  * Get pattern data for a given tile for the current line.
+ * Pattern data is read from the pattern cache, and is
+ * already flipped horizontally if H Flip is enabled.
  * @param interlaced True for interlaced; false for non-interlaced.
  * @param pattern Pattern info.
  * @param y_fine_offset Y fine offset.
@@ -634,28 +640,14 @@ FORCE_INLINE uint16_t VdpPrivate::T_Get_Nametable_Word(unsigned int x, unsigned
 template<bool interlaced>
 FORCE_INLINE uint32_t VdpPrivate::T_Get_Pattern_Data(uint16_t pattern, unsigned int y_fine_offset)
 {
-	// Get the tile address.
-	unsigned int TileAddr;
+	// FIXME: Rebase to upper 64 KB if necessary. (128 KB VRAM mode)
 	if (interlaced) {
 		// FIXME: High bit may be usable for 128 KB mode.
-		TileAddr = (pattern & 0x3FF) << 6;
+		return patternCache.pattern_line_m5_nt_8x16(pattern, y_fine_offset);
 	} else {
 		// Non-interlaced, or Interlaced Mode 1.
-		TileAddr = (pattern & 0x7FF) << 5;
+		return patternCache.pattern_line_m5_nt_8x8(pattern, y_fine_offset);
 	}
-
-	if (pattern & 0x1000) {
-		// V Flip enabled. Flip the tile vertically.
-		if (interlaced) {
-			y_fine_offset ^= 15;
-		} else {
-			y_fine_offset ^= 7;
-		}
-	}
-
-	// Return the pattern data.
-	// FIXME: Rebase to upper 64 KB if necessary. (128 KB VRAM mode)
-	return VRam.u32[(TileAddr + (y_fine_offset * 4)) >> 2];
 }
 
 /**
@@ -758,20 +750,11 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_Scroll(int cell_start, int cell_leng
 		if (VDP_Layers & VdpTypes::VDP_LAYER_SCROLLB_SWAP)
 			nametable_word ^= 0x8000;
 
-		// Check for horizontal flip.
-		if (nametable_word & 0x0800) {
-			// Pattern has H-Flip enabled.
-			if (nametable_word & 0x8000)
-				T_PutLine_P1<plane, h_s, true>(disp_pixnum, pattern_data, palette);
-			else
-				T_PutLine_P0<plane, h_s, true>(disp_pixnum, pattern_data, palette);
-		} else {
-			// Pattern doesn't have flip enabled.
-			if (nametable_word & 0x8000)
-				T_PutLine_P1<plane, h_s, false>(disp_pixnum, pattern_data, palette);
-			else
-				T_PutLine_P0<plane, h_s, false>(disp_pixnum, pattern_data, palette);
-		}
+		// NOTE: H-Flip is handled by the pattern cache.
+		if (nametable_word & 0x8000)
+			T_PutLine_P1<plane, h_s, false>(disp_pixnum, pattern_data, palette);
+		else
+			T_PutLine_P0<plane, h_s, false>(disp_pixnum, pattern_data, palette);
 
 		// Go to the next H cell.
 		x_cell_offset = (x_cell_offset + 1) & H_Scroll_CMask;
@@ -796,7 +779,7 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_ScrollA_Window(void)
 	
 	// Check if the entire line is part of the window.
 	// TODO: Verify interlaced operation!
-	const unsigned int vdp_cells = (q->VDP_Lines.currentLine >> 3);
+	const unsigned int vdp_cells = (rendLines->currentLine >> 3);
 	if (VDP_Reg.m5.Win_V_Pos & VDP_REG_M5_WIN_V_DOWN) {
 		// Window starts from the bottom.
 		if (vdp_cells >= Win_Y_Pos) {
@@ -867,20 +850,11 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_ScrollA_Window(void)
 			if (VDP_Layers & VdpTypes::VDP_LAYER_SCROLLA_SWAP)
 				pattern_info ^= 0x8000;
 
-			// Check for horizontal flip.
-			if (pattern_info & 0x0800) {
-				// Pattern has H-Flip enabled.
-				if (pattern_info & 0x8000)
-					T_PutLine_P1<true, h_s, true>(disp_pixnum, pattern_data, palette);
-				else
-					T_PutLine_P0<true, h_s, true>(disp_pixnum, pattern_data, palette);
-			} else {
-				// Pattern doesn't have flip enabled.
-				if (pattern_info & 0x8000)
-					T_PutLine_P1<true, h_s, false>(disp_pixnum, pattern_data, palette);
-				else
-					T_PutLine_P0<true, h_s, false>(disp_pixnum, pattern_data, palette);
-			}
+			// NOTE: H-Flip is handled by the pattern cache.
+			if (pattern_info & 0x8000)
+				T_PutLine_P1<true, h_s, false>(disp_pixnum, pattern_data, palette);
+			else
+				T_PutLine_P0<true, h_s, false>(disp_pixnum, pattern_data, palette);
 		}
 
 		// Mark window pixels.
@@ -916,8 +890,110 @@ FORCE_INLINE void VdpPrivate::Update_Sprite_Line_Cache_m5(int line)
 
 	if (sovr) {
 		// Sprite overflow!
-		Reg_Status.setBit(VdpStatus::VDP_STATUS_SOVR, true);
+		setRendStatusBit(VdpStatus::VDP_STATUS_SOVR);
+	}
+}
+
+/**
+ * Count the trailing zero bits in a 64-bit value.
+ * @param x Value. (Must not be 0.)
+ * @return Number of trailing zero bits.
+ */
+static FORCE_INLINE int ctz64(uint64_t x)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	for (; !(x & 1); x >>= 1, n++) { }
+	return n;
+#endif
+}
+
+/**
+ * Rebuild the sprite Y-span index from the cached SAT.
+ * @param interlaced If true, using Interlaced Mode 2. (2x res)
+ * @param max_spr_frame Maximum number of sprites per frame.
+ */
+template<bool interlaced>
+void VdpPrivate::T_Update_Sprite_Spans_m5(uint8_t max_spr_frame)
+{
+	// Clear the lines that were set by the previous index.
+	if (sprSpans.line_min <= sprSpans.line_max) {
+		memset(&sprSpans.lineMask[sprSpans.line_min], 0,
+		       (sprSpans.line_max - sprSpans.line_min + 1) * sizeof(sprSpans.lineMask[0]));
+	}
+	sprSpans.line_min = ARRAY_SIZE(sprSpans.lineMask);
+	sprSpans.line_max = -1;
+
+	/**
+	 * The following values are read from the cached
+	 * Sprite Attribute Table instead of VRAM:
+	 * - Y position
+	 * - Sprite size
+	 * - Link number
+	 */
+	uint8_t link = 0;
+	const VdpStructs::SprEntry_m5 *spr_SAT = &SprAttrTbl_m5.spr[0];
+
+	// Walk the sprite link list.
+	// NOTE: If the list has a loop, sprites will be
+	// present multiple times, same as on hardware.
+	for (int pos = 0; pos < max_spr_frame; pos++) {
+		// Check the Y position.
+		int y = spr_SAT->y;
+		if (interlaced) {
+			y = (y & 0x3FF) - 256;
+		} else {
+			y = (y & 0x1FF) - 128;
+		}
+
+		// Calculate the sprite's height.
+		const uint8_t sz = spr_SAT->sz;
+		int height = (sz & 3);
+		if (interlaced) {
+			height = (height * 16) + 15;
+		} else {
+			height = (height * 8) + 7;
+		}
+		const int y_max = y + height;	// height is already -1
+
+		sprSpans.link[pos] = link;
+		sprSpans.sz[pos] = sz;
+		sprSpans.y[pos] = y;
+		sprSpans.y_max[pos] = y_max;
+
+		// Add the sprite to each line it's visible on.
+		const int line_start = (y < 0 ? 0 : y);
+		const int line_end = (y_max >= ARRAY_SIZE(sprSpans.lineMask)
+				? (ARRAY_SIZE(sprSpans.lineMask) - 1) : y_max);
+		const uint64_t bit = (1ULL << (pos & 63));
+		for (int line = line_start; line <= line_end; line++) {
+			sprSpans.lineMask[line][pos >> 6] |= bit;
+		}
+		if (line_start <= line_end) {
+			if (line_start < sprSpans.line_min)
+				sprSpans.line_min = line_start;
+			if (line_end > sprSpans.line_max)
+				sprSpans.line_max = line_end;
+		}
+
+		// Link field.
+		// NOTE: Link field is 7-bit. Usually this won't cause a problem,
+		// since most games won't set the high bit.
+		// Dino Land incorrectly sets the high bit on some sprites,
+		// so we have to mask it off.
+		link = spr_SAT->link & 0x7F;
+		if (link == 0 || link >= max_spr_frame)
+			break;
+
+		// Get the next sprite address in the SAT.
+		spr_SAT = &SprAttrTbl_m5.spr[link];
 	}
+
+	sprSpans.max_spr_frame = max_spr_frame;
+	sprSpans.interlaced = interlaced;
+	sprSpans.dirty = false;
 }
 
 /**
@@ -933,7 +1009,6 @@ unsigned int VdpPrivate::T_Update_Sprite_Line_Cache_m5(int line)
 	// is used in Vdp.cpp. gcc-5.1 fails in release builds due to
 	// the function definition not being available there.
 	unsigned int ret = 0;
-	uint8_t link = 0;
 
 	// Determine the maximum number of sprites.
 	// NOTE: Max sprites per frame is always limited
@@ -966,7 +1041,7 @@ unsigned int VdpPrivate::T_Update_Sprite_Line_Cache_m5(int line)
 					line = 1;
 					break;
 				case VdpTypes::INTREND_FLICKER:
-					line = !!(Reg_Status.isOddFrame());
+					line = !!(rendStatus->isOddFrame());
 					break;
 			}
 		} else {
@@ -980,58 +1055,45 @@ unsigned int VdpPrivate::T_Update_Sprite_Line_Cache_m5(int line)
 	SprLineCache_t *cache = &sprLineCache[cacheId][0];
 	uint8_t count = 0;
 
-	/**
-	 * The following values are read from the cached
-	 * Sprite Attribute Table instead of VRAM:
-	 * - Y position
-	 * - Sprite size
-	 * - Link number
-	 */
-	const VdpStructs::SprEntry_m5 *spr_SAT = &SprAttrTbl_m5.spr[0];
+	// Rebuild the sprite Y-span index if necessary.
+	if (sprSpans.dirty ||
+	    sprSpans.interlaced != interlaced ||
+	    sprSpans.max_spr_frame != max_spr_frame)
+	{
+		T_Update_Sprite_Spans_m5<interlaced>(max_spr_frame);
+	}
 
 	// Process up to max_spr_line sprites.
 	// (16 in H32, 20 in H40.)
-	int total_spr_count = max_spr_frame;
-	do {
-		// Check the Y position.
-		int y = spr_SAT->y;
-		if (interlaced) {
-			y = (y & 0x3FF) - 256;
-		} else {
-			y = (y & 0x1FF) - 128;
-		}
-
-		if (line >= y) {
-			// Calculate the sprite's height.
-			const uint8_t sz = spr_SAT->sz;
-			int height = (sz & 3);
-			if (interlaced) {
-				height = (height * 16) + 15;
-			} else {
-				height = (height * 8) + 7;
-			}
-
-			// Check if the bottom of the sprite is in range.
-			const int y_max = y + height;	// height is already -1
-			if (line <= y_max) {
-				// Sprite is in range.
+	// Sprites are processed in link list order.
+	// NOTE: Sprite spans never extend outside of lineMask[],
+	// so out-of-range lines don't have any sprites.
+	if (line >= 0 && line < ARRAY_SIZE(sprSpans.lineMask)) {
+		for (int i = 0; i < ARRAY_SIZE(sprSpans.lineMask[0]) && !ret; i++) {
+			uint64_t mask = sprSpans.lineMask[line][i];
+			while (mask != 0) {
 				if (count == max_spr_line) {
 					// Sprite overflow!
 					ret = VdpStatus::VDP_STATUS_SOVR;
 					break;
 				}
 
+				const int pos = (i * 64) + ctz64(mask);
+				mask &= (mask - 1);
+
 				// Get the remaining sprite information from VRAM.
-				const VdpStructs::SprEntry_m5 *spr_VRam = Spr_Tbl_Addr_PtrM5(link);
+				const VdpStructs::SprEntry_m5 *spr_VRam =
+					Spr_Tbl_Addr_PtrM5(sprSpans.link[pos]);
 
 				// Save the sprite information in the line cache.
+				const uint8_t sz = sprSpans.sz[pos];
 				cache->Pos_X = (spr_VRam->x & 0x1FF) - 128;
-				cache->Pos_Y = y;
+				cache->Pos_Y = sprSpans.y[pos];
 				// NOTE: Size_? is in units of cells, not pixels.
 				cache->Size_X = ((sz >> 2) & 3) + 1;	// 1 more than the original value.
 				cache->Size_Y = (sz & 3);		// Exactly the original value.
 				// Pos_Y_Max is in units of pixels.
-				cache->Pos_Y_Max = y_max;
+				cache->Pos_Y_Max = sprSpans.y_max[pos];
 				// Tile number. (Also includes palette, priority, and flip bits.)
 				cache->Num_Tile = spr_VRam->attr;
 
@@ -1040,19 +1102,7 @@ unsigned int VdpPrivate::T_Update_Sprite_Line_Cache_m5(int line)
 				cache++;
 			}
 		}
-
-		// Link field.
-		// NOTE: Link field is 7-bit. Usually this won't cause a problem,
-		// since most games won't set the high bit.
-		// Dino Land incorrectly sets the high bit on some sprites,
-		// so we have to mask it off.
-		link = spr_SAT->link & 0x7F;
-		if (link == 0 || link >= max_spr_frame)
-			break;
-
-		// Get the next sprite address in the SAT.
-		spr_SAT = &SprAttrTbl_m5.spr[link];
-	} while (--total_spr_count);
+	}
 
 	// Save the sprite count for the next line.
 	sprCountCache[cacheId] = count;
@@ -1203,16 +1253,18 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_Sprite(void)
 			// Draw the sprite.
 			if ((VDP_Layers & VdpTypes::VDP_LAYER_SPRITE_ALWAYSONTOP) || (spr_info & 0x8000)) {
 				// High priority.
+				// NOTE: H-Flip is handled by the pattern cache.
 				for (; H_Pos_Max >= H_Pos_Min; H_Pos_Max -= 8) {
-					uint32_t pattern = Spr_Gen_Addr_u32(tile_num);
-					T_PutLine_Sprite<true, h_s, true>(H_Pos_Max, pattern, palette);
+					uint32_t pattern = patternCache.pattern_line_addr(true, Spr_Gen_Addr + tile_num);
+					T_PutLine_Sprite<true, h_s, false>(H_Pos_Max, pattern, palette);
 					tile_num += Y_cell_size;
 				}
 			} else {
 				// Low priority.
+				// NOTE: H-Flip is handled by the pattern cache.
 				for (; H_Pos_Max >= H_Pos_Min; H_Pos_Max -= 8) {
-					uint32_t pattern = Spr_Gen_Addr_u32(tile_num);
-					T_PutLine_Sprite<false, h_s, true>(H_Pos_Max, pattern, palette);
+					uint32_t pattern = patternCache.pattern_line_addr(true, Spr_Gen_Addr + tile_num);
+					T_PutLine_Sprite<false, h_s, false>(H_Pos_Max, pattern, palette);
 					tile_num += Y_cell_size;
 				}
 			}
@@ -1230,14 +1282,14 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_Sprite(void)
 			if ((VDP_Layers & VdpTypes::VDP_LAYER_SPRITE_ALWAYSONTOP) || (spr_info & 0x8000)) {
 				// High priority.
 				for (; H_Pos_Min < H_Pos_Max; H_Pos_Min += 8) {
-					uint32_t pattern = Spr_Gen_Addr_u32(tile_num);
+					uint32_t pattern = patternCache.pattern_line_addr(false, Spr_Gen_Addr + tile_num);
 					T_PutLine_Sprite<true, h_s, false>(H_Pos_Min, pattern, palette);
 					tile_num += Y_cell_size;
 				}
 			} else {
 				// Low priority.
 				for (; H_Pos_Min < H_Pos_Max; H_Pos_Min += 8) {
-					uint32_t pattern = Spr_Gen_Addr_u32(tile_num);
+					uint32_t pattern = patternCache.pattern_line_addr(false, Spr_Gen_Addr + tile_num);
 					T_PutLine_Sprite<false, h_s, false>(H_Pos_Min, pattern, palette);
 					tile_num += Y_cell_size;
 				}
@@ -1262,6 +1314,10 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_Sprite(void)
 template<bool interlaced, bool h_s>
 FORCE_INLINE void VdpPrivate::T_Render_Line_m5(void)
 {
+	// Decode patterns that were modified since the last line.
+	if (patternCache.is_dirty())
+		patternCache.update_m5(&VRam);
+
 	// Clear the line first.
 	memset(&LineBuf, (h_s ? LINEBUF_SHAD_B : 0), sizeof(LineBuf));
 
@@ -1278,6 +1334,61 @@ FORCE_INLINE void VdpPrivate::T_Render_Line_m5(void)
 	T_Render_Line_Sprite<interlaced, h_s>();
 }
 
+#ifdef HAVE_VDP_LINEBUF_X86
+/**
+ * Render line buffer pixels using SIMD, if supported.
+ * @param dest Destination surface.
+ * @param linebuf Line buffer. (LineBuf.u16)
+ * @param md_palette MD palette buffer.
+ * @param count Number of pixels.
+ * @return True if the pixels were rendered; false if not.
+ */
+static FORCE_INLINE bool Render_LineBuf_SIMD(uint16_t *dest, const uint16_t *linebuf,
+					     const uint16_t *md_palette, int count)
+{
+	if (CPU_Flags & MDP_CPUFLAG_X86_AVX2) {
+		VdpRend_LineBuf16_AVX2(dest, linebuf, md_palette, count);
+		return true;
+	}
+	return false;
+}
+
+static FORCE_INLINE bool Render_LineBuf_SIMD(uint32_t *dest, const uint16_t *linebuf,
+					     const uint32_t *md_palette, int count)
+{
+	if (CPU_Flags & MDP_CPUFLAG_X86_AVX2) {
+		VdpRend_LineBuf32_AVX2(dest, linebuf, md_palette, count);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Fill a border region using SIMD, if supported.
+ * @param dest Destination surface.
+ * @param color Border color.
+ * @param count Number of pixels.
+ * @return True if the region was filled; false if not.
+ */
+static FORCE_INLINE bool Fill_Border_SIMD(uint16_t *dest, uint16_t color, int count)
+{
+	if (CPU_Flags & MDP_CPUFLAG_X86_SSE2) {
+		VdpRend_Fill16_SSE2(dest, color, count);
+		return true;
+	}
+	return false;
+}
+
+static FORCE_INLINE bool Fill_Border_SIMD(uint32_t *dest, uint32_t color, int count)
+{
+	if (CPU_Flags & MDP_CPUFLAG_X86_SSE2) {
+		VdpRend_Fill32_SSE2(dest, color, count);
+		return true;
+	}
+	return false;
+}
+#endif /* HAVE_VDP_LINEBUF_X86 */
+
 /**
  * Render the line buffer to the destination surface.
  * @param pixel Type of pixel.
@@ -1291,16 +1402,21 @@ FORCE_INLINE void VdpPrivate::T_Render_LineBuf(pixel *dest, pixel *md_palette)
 
 	// Render the line buffer to the destination surface.
 	dest += H_Pix_Begin;
-	const pixel *dest_end = dest + H_Pix;
-	for (; dest < dest_end; dest += 8, src += 8) {
-		*(dest+0) = md_palette[src->pixel];
-		*(dest+1) = md_palette[(src+1)->pixel];
-		*(dest+2) = md_palette[(src+2)->pixel];
-		*(dest+3) = md_palette[(src+3)->pixel];
-		*(dest+4) = md_palette[(src+4)->pixel];
-		*(dest+5) = md_palette[(src+5)->pixel];
-		*(dest+6) = md_palette[(src+6)->pixel];
-		*(dest+7) = md_palette[(src+7)->pixel];
+#ifdef HAVE_VDP_LINEBUF_X86
+	if (!Render_LineBuf_SIMD(dest, &LineBuf.u16[8], md_palette, H_Pix))
+#endif /* HAVE_VDP_LINEBUF_X86 */
+	{
+		const pixel *dest_end = dest + H_Pix;
+		for (pixel *px = dest; px < dest_end; px += 8, src += 8) {
+			*(px+0) = md_palette[src->pixel];
+			*(px+1) = md_palette[(src+1)->pixel];
+			*(px+2) = md_palette[(src+2)->pixel];
+			*(px+3) = md_palette[(src+3)->pixel];
+			*(px+4) = md_palette[(src+4)->pixel];
+			*(px+5) = md_palette[(src+5)->pixel];
+			*(px+6) = md_palette[(src+6)->pixel];
+			*(px+7) = md_palette[(src+7)->pixel];
+		}
 	}
 
 	if (H_Pix_Begin == 0)
@@ -1313,33 +1429,25 @@ FORCE_INLINE void VdpPrivate::T_Render_LineBuf(pixel *dest, pixel *md_palette)
 	register const pixel border_color =
 		(q->options.borderColorEmulation ? md_palette[0] : 0);
 
-	// Left border.
-	dest -= H_Pix_Begin;
-	dest -= H_Pix;
-	dest_end = dest + H_Pix_Begin;
-	for (; dest < dest_end; dest += 8) {
-		*(dest+0) = border_color;
-		*(dest+1) = border_color;
-		*(dest+2) = border_color;
-		*(dest+3) = border_color;
-		*(dest+4) = border_color;
-		*(dest+5) = border_color;
-		*(dest+6) = border_color;
-		*(dest+7) = border_color;
-	}
-
-	// Right border.
-	dest += H_Pix;
-	dest_end = dest + H_Pix_Begin;
-	for (; dest < dest_end; dest += 8) {
-		*(dest+0) = border_color;
-		*(dest+1) = border_color;
-		*(dest+2) = border_color;
-		*(dest+3) = border_color;
-		*(dest+4) = border_color;
-		*(dest+5) = border_color;
-		*(dest+6) = border_color;
-		*(dest+7) = border_color;
+	// Left border and right border.
+	pixel *const borders[2] = {dest - H_Pix_Begin, dest + H_Pix};
+	for (int i = 0; i < 2; i++) {
+		pixel *px = borders[i];
+#ifdef HAVE_VDP_LINEBUF_X86
+		if (Fill_Border_SIMD(px, border_color, H_Pix_Begin))
+			continue;
+#endif /* HAVE_VDP_LINEBUF_X86 */
+		const pixel *px_end = px + H_Pix_Begin;
+		for (; px < px_end; px += 8) {
+			*(px+0) = border_color;
+			*(px+1) = border_color;
+			*(px+2) = border_color;
+			*(px+3) = border_color;
+			*(px+4) = border_color;
+			*(px+5) = border_color;
+			*(px+6) = border_color;
+			*(px+7) = border_color;
+		}
 	}
 }
 
@@ -1373,10 +1481,10 @@ void VdpPrivate::renderLine_m5(void)
 {
 	// Determine what part of the screen we're in.
 	bool in_border = false;
-	int lineNum = q->VDP_Lines.currentLine;
+	int lineNum = rendLines->currentLine;
 
 	// TODO: This check needs to be optimized.
-	if (lineNum == (q->VDP_Lines.totalDisplayLines - 1) &&
+	if (lineNum == (rendLines->totalDisplayLines - 1) &&
 	    (VDP_Reg.m5.Set2 & VDP_REG_M5_SET2_DISP))
 	{
 		// Clear the sprite dot overflow variable.
@@ -1389,39 +1497,39 @@ void VdpPrivate::renderLine_m5(void)
 	}
 
 	// Check for borders.
-	if (lineNum >= q->VDP_Lines.Border.borderStartBottom &&
-	    lineNum <= q->VDP_Lines.Border.borderEndBottom)
+	if (lineNum >= rendLines->Border.borderStartBottom &&
+	    lineNum <= rendLines->Border.borderEndBottom)
 	{
 		// Bottom border.
 		in_border = true;
 	}
-	else if (lineNum >= q->VDP_Lines.Border.borderStartTop &&
-	         lineNum <= q->VDP_Lines.Border.borderEndTop)
+	else if (lineNum >= rendLines->Border.borderStartTop &&
+	         lineNum <= rendLines->Border.borderEndTop)
 	{
 		// Top border.
 		in_border = true;
-		lineNum -= q->VDP_Lines.Border.borderStartTop;
-		lineNum -= q->VDP_Lines.Border.borderSize;
+		lineNum -= rendLines->Border.borderStartTop;
+		lineNum -= rendLines->Border.borderSize;
 	}
 
-	if (!in_border && q->VDP_Lines.currentLine >= q->VDP_Lines.totalVisibleLines) {
+	if (!in_border && rendLines->currentLine >= rendLines->totalVisibleLines) {
 		// Off screen.
 		return;
 	}
 
 	// Determine the starting line in MD_Screen.
-	if (Reg_Status.isNtsc() &&
+	if (rendStatus->isNtsc() &&
 	    (VDP_Reg.m5.Set2 & VDP_REG_M5_SET2_M2) &&
 	    q->options.ntscV30Rolling)
 	{
 		// NTSC V30 mode. Simulate screen rolling.
-		lineNum -= q->VDP_Lines.NTSC_V30.Offset;
+		lineNum -= rendLines->NTSC_V30.Offset;
 
 		// Prevent underflow.
 		if (lineNum < 0)
 			lineNum += 240;
 	}
-	lineNum += q->VDP_Lines.Border.borderSize;
+	lineNum += rendLines->Border.borderSize;
 
 	if (in_border && !q->options.borderColorEmulation) {
 		// We're in the border area, but border color emulation is disabled.
@@ -1479,7 +1587,7 @@ void VdpPrivate::renderLine_m5(void)
 		}
 
 		// Update the sprite line cache for the next line.
-		if (q->VDP_Lines.currentLine < (q->VDP_Lines.totalDisplayLines - 1)) {
+		if (rendLines->currentLine < (rendLines->totalDisplayLines - 1)) {
 			// Update only for visible lines.
 			if (im2_flag) {
 				Update_Sprite_Line_Cache_m5(T_GetLineNumber<true>());
@@ -0,0 +1,306 @@
+/***************************************************************************
+ * libgens: Gens Emulation Library.                                        *
+ * VdpRenderThread.cpp: VDP threaded rendering. (Part of the Vdp class.)   *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * Threaded rendering.
+ *
+ * The emulation thread records the per-line state that it changes
+ * every line (line counters and the status register) in a line log,
+ * and the render thread renders each logged line using that state.
+ *
+ * All other VDP state (registers, VRAM, CRAM, VSRAM, caches) is
+ * shared with the render thread. Before modifying any of it, the
+ * emulation thread calls VdpPrivate::rendSync(), which waits for
+ * the render thread to catch up. Rendering therefore overlaps CPU
+ * emulation until the next VDP write.
+ *
+ * The frame is completed before the last line of the frame returns,
+ * so the framebuffer is always complete when execFrame() returns.
+ */
+
+#include "Vdp.hpp"
+#include "Vdp_p.hpp"
+
+// C++ includes.
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace LibGens {
+
+/**
+ * Render thread state.
+ */
+struct VdpPrivate::RenderThread_t {
+	// Number of line log entries. (Must be a power of two.)
+	// This must be larger than the number of lines per frame.
+	static const unsigned int LOG_SIZE = 512;
+
+	// Line log entry.
+	struct LineState_t {
+		VdpTypes::VdpLines_t lines;
+		VdpStatus status;
+	};
+
+	// Line log.
+	// logHead is only written by the emulation thread;
+	// logTail is only written by the render thread.
+	LineState_t log[LOG_SIZE];
+	std::atomic<unsigned int> logHead;
+	std::atomic<unsigned int> logTail;
+
+	// Log position after the last queued line that can set
+	// the sprite collision and overflow bits.
+	// Only used by the emulation thread.
+	unsigned int sprHead;
+
+	// Line state for the line being rendered.
+	VdpTypes::VdpLines_t curLines;
+	VdpStatus curStatus;
+
+	// Render thread.
+	std::thread thread;
+	std::atomic<bool> quit;
+	std::mutex mutex;
+	std::condition_variable wakeCond;	// Lines were queued.
+	std::condition_variable doneCond;	// All lines were rendered.
+
+	RenderThread_t()
+		: logHead(0)
+		, logTail(0)
+		, sprHead(0)
+		, quit(false)
+	{ }
+};
+
+/**
+ * Render the current line.
+ * Called by Vdp::renderLine(), or by the render thread
+ * if threaded rendering is enabled.
+ */
+void VdpPrivate::renderLine_int(void)
+{
+	// TODO: 32X-specific function.
+	if (VDP_Mode & VdpTypes::VDP_MODE_M5) {
+		// Mode 5.
+		// TODO: Port to LibGens.
+		if (q->SysStatus._32X) {
+#if 0
+			renderLine_m5_32X();
+#endif
+		} else {
+			renderLine_m5();
+		}
+	} else {
+		// Unsupported mode.
+		renderLine_Err();
+	}
+
+	// Update the VDP render error cache.
+	updateErr();
+}
+
+/**
+ * Start the render thread.
+ * Called by the emulation thread.
+ */
+void VdpPrivate::rendThreadStart(void)
+{
+	if (rendThread)
+		return;
+
+	RenderThread_t *const rt = new RenderThread_t();
+	rendThread = rt;
+	rendStatusBits.store(0, std::memory_order_relaxed);
+	rendLines = &rt->curLines;
+	rendStatus = &rt->curStatus;
+
+	rt->thread = std::thread(&VdpPrivate::rendThreadMain, this);
+}
+
+/**
+ * Render thread function.
+ */
+void VdpPrivate::rendThreadMain(void)
+{
+	RenderThread_t *const rt = rendThread;
+	std::unique_lock<std::mutex> lock(rt->mutex);
+	while (true) {
+		rt->wakeCond.wait(lock, [rt]() {
+			return rt->quit.load(std::memory_order_relaxed) ||
+			       rt->logTail.load(std::memory_order_relaxed) !=
+			       rt->logHead.load(std::memory_order_acquire);
+		});
+
+		unsigned int tail = rt->logTail.load(std::memory_order_relaxed);
+		if (tail == rt->logHead.load(std::memory_order_acquire)) {
+			// No lines left, so this must be a quit request.
+			break;
+		}
+
+		// Render all queued lines.
+		lock.unlock();
+		do {
+			const RenderThread_t::LineState_t *const state =
+				&rt->log[tail & (RenderThread_t::LOG_SIZE - 1)];
+			rt->curLines = state->lines;
+			rt->curStatus = state->status;
+			renderLine_int();
+			rt->logTail.store(++tail, std::memory_order_release);
+		} while (tail != rt->logHead.load(std::memory_order_acquire));
+		lock.lock();
+
+		// Wake up the emulation thread if it's waiting.
+		rt->doneCond.notify_all();
+	}
+}
+
+/**
+ * Stop the render thread.
+ * All queued lines are rendered first.
+ * Called by the emulation thread.
+ */
+void VdpPrivate::rendThreadStop(void)
+{
+	RenderThread_t *const rt = rendThread;
+	if (!rt)
+		return;
+
+	rendWait();
+	{
+		std::lock_guard<std::mutex> lock(rt->mutex);
+		rt->quit.store(true, std::memory_order_relaxed);
+	}
+	rt->wakeCond.notify_one();
+	rt->thread.join();
+
+	rendThread = nullptr;
+	rendLines = &q->VDP_Lines;
+	rendStatus = &Reg_Status;
+	delete rt;
+}
+
+/**
+ * Queue the current line for rendering.
+ * Called by the emulation thread.
+ */
+void VdpPrivate::rendQueueLine(void)
+{
+	RenderThread_t *const rt = rendThread;
+	const unsigned int head = rt->logHead.load(std::memory_order_relaxed);
+	if (head - rt->logTail.load(std::memory_order_acquire) >= RenderThread_t::LOG_SIZE) {
+		// Line log is full.
+		rendWait();
+	}
+
+	RenderThread_t::LineState_t *const state =
+		&rt->log[head & (RenderThread_t::LOG_SIZE - 1)];
+	state->lines = q->VDP_Lines;
+	state->status = Reg_Status;
+	if (rendLineSetsSprStatus())
+		rt->sprHead = head + 1;
+	rt->logHead.store(head + 1, std::memory_order_release);
+
+	{
+		// Lock the mutex to prevent a lost wakeup.
+		std::lock_guard<std::mutex> lock(rt->mutex);
+	}
+	rt->wakeCond.notify_one();
+
+	// Wait for the frame to be completed on the last line.
+	if (q->VDP_Lines.currentLine >= q->VDP_Lines.totalDisplayLines - 1) {
+		rendWait();
+	}
+}
+
+/**
+ * Wait for the render thread to render all queued lines.
+ * Called by the emulation thread.
+ */
+void VdpPrivate::rendWait(void)
+{
+	RenderThread_t *const rt = rendThread;
+	const unsigned int head = rt->logHead.load(std::memory_order_relaxed);
+	if (rt->logTail.load(std::memory_order_acquire) != head) {
+		std::unique_lock<std::mutex> lock(rt->mutex);
+		rt->doneCond.wait(lock, [rt, head]() {
+			return rt->logTail.load(std::memory_order_acquire) == head;
+		});
+	}
+
+	rendMergeStatus();
+}
+
+/**
+ * Wait for the render thread to render all queued lines
+ * that can set the sprite collision and overflow bits.
+ * Called by the emulation thread.
+ */
+void VdpPrivate::rendWaitSprStatus(void)
+{
+	RenderThread_t *const rt = rendThread;
+	const unsigned int sprHead = rt->sprHead;
+	if ((int)(sprHead - rt->logTail.load(std::memory_order_acquire)) > 0) {
+		std::unique_lock<std::mutex> lock(rt->mutex);
+		rt->doneCond.wait(lock, [rt, sprHead]() {
+			return (int)(rt->logTail.load(std::memory_order_acquire) - sprHead) >= 0;
+		});
+	}
+
+	rendMergeStatus();
+}
+
+/**
+ * Can the current line set the sprite collision and overflow bits?
+ * This must match the sprite handling in renderLine_m5().
+ * Called by the emulation thread.
+ * @return True if rendering the current line may set the bits.
+ */
+bool VdpPrivate::rendLineSetsSprStatus(void) const
+{
+	if (!(VDP_Mode & VdpTypes::VDP_MODE_M5) ||
+	    !(VDP_Reg.m5.Set2 & VDP_REG_M5_SET2_DISP))
+	{
+		// Sprites are only processed in Mode 5 with the display on.
+		return false;
+	}
+
+	// Sprites are processed on visible lines, and on
+	// the last line for the first visible line.
+	const VdpTypes::VdpLines_t *const lines = &q->VDP_Lines;
+	return (lines->currentLine < lines->totalVisibleLines ||
+		lines->currentLine == (lines->totalDisplayLines - 1));
+}
+
+/**
+ * Merge status bits set by the render thread into Reg_Status.
+ * Called by the emulation thread.
+ */
+void VdpPrivate::rendMergeStatus(void)
+{
+	const unsigned int bits = rendStatusBits.exchange(0, std::memory_order_relaxed);
+	if (bits & VdpStatus::VDP_STATUS_COLLISION)
+		Reg_Status.setBit(VdpStatus::VDP_STATUS_COLLISION, true);
+	if (bits & VdpStatus::VDP_STATUS_SOVR)
+		Reg_Status.setBit(VdpStatus::VDP_STATUS_SOVR, true);
+}
+
+}
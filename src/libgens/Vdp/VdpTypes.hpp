@@ -182,6 +182,15 @@ namespace VdpTypes {
 		 * This is similar to Genecyst.
 		 */
 		bool enableInterlacedMode;
+
+		/**
+		 * Render lines on a separate thread.
+		 * Rendering overlaps CPU emulation until the next VDP
+		 * write, and each frame is completed before it returns.
+		 * NOTE: Sprite collision and overflow flags may be
+		 * visible to the CPU a few lines late.
+		 */
+		bool renderThread;
 	};
 
 	// VDP layer flags.
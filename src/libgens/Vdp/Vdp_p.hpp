@@ -36,9 +36,13 @@
 #include "VdpPalette.hpp"
 #include "VdpStatus.hpp"
 #include "VdpStructs.hpp"
+#include "VdpCache.hpp"
 
 #include "VdpRend_Err_p.hpp"
 
+// C++ includes.
+#include <atomic>
+
 namespace LibGens {
 
 class Vdp;
@@ -149,6 +153,10 @@ class VdpPrivate
 		VdpTypes::VRam_t VRam;
 		VdpTypes::VSRam_t VSRam;
 
+		// Decoded pattern cache. (Mode 4, Mode 5)
+		// All VRam writes must call patternCache.mark_dirty().
+		VdpCache patternCache;
+
 		int HInt_Counter;	// Horizontal Interrupt Counter.
 		int VDP_Int;		// VDP interrupt state.
 		VdpStatus Reg_Status;	// VDP status register.
@@ -181,6 +189,16 @@ class VdpPrivate
 		 */
 		void vdpDataWrite_int(uint16_t data);
 
+		/**
+		 * Write a block of words to VRAM.
+		 * Used by DMA and the debug interface.
+		 * This updates the pattern cache and the cached SAT.
+		 * @param address Destination address. (Must be even; must not wrap.)
+		 * @param src Source data, in host byte order.
+		 * @param words Number of words.
+		 */
+		void vdpWriteVRamBlock(uint32_t address, const uint16_t *src, unsigned int words);
+
 		/**
 		 * VDP address pointers.
 		 * These are relative to VRam[] and are based on register values.
@@ -513,6 +531,38 @@ class VdpPrivate
 		// Includes both the current line and the next line.
 		uint8_t sprCountCache[2];
 
+		/**
+		 * Sprite Y-span index. (Mode 5)
+		 * Built from the cached SAT by walking the sprite link list
+		 * once, and rebuilt only if the cached SAT has changed.
+		 * Each line has a bitmask of the link list positions
+		 * of all sprites on that line, so building a line's
+		 * sprite list only touches sprites on that line.
+		 */
+		struct {
+			// Link list positions of sprites on each line.
+			// Sprite Y positions are 10-bit in IM2, so the
+			// sprite spans always fit within 1024 lines.
+			uint64_t lineMask[1024][2];
+
+			// Sprite information, indexed by link list position.
+			uint8_t link[80];	// Sprite number.
+			uint8_t sz[80];		// Sprite size.
+			int16_t y[80];		// Y position.
+			int16_t y_max[80];	// Bottom line.
+
+			// Range of lines with bits set in lineMask[].
+			int line_min;
+			int line_max;
+
+			// Parameters used to build the index.
+			uint8_t max_spr_frame;
+			bool interlaced;
+
+			// If true, the cached SAT has changed.
+			bool dirty;
+		} sprSpans;
+
 	/*!*****************************************
 	 * VdpRend_m5: Mode 5 rendering functions. *
 	 *******************************************/
@@ -575,6 +625,9 @@ class VdpPrivate
 		template<bool interlaced>
 		unsigned int T_Update_Sprite_Line_Cache_m5(int line);
 
+		template<bool interlaced>
+		void T_Update_Sprite_Spans_m5(uint8_t max_spr_frame);
+
 		template<bool interlaced, bool h_s>
 		FORCE_INLINE void T_Render_Line_Sprite(void);
 
@@ -608,6 +661,121 @@ class VdpPrivate
 
 		void renderLine_Err(void);
 		void updateErr(void);
+
+	/*!*****************************************************************
+	 * VdpRenderThread: Threaded rendering functions and variables.    *
+	 *******************************************************************/
+	public:
+		/**
+		 * Render the current line.
+		 * Called by Vdp::renderLine(), or by the render thread
+		 * if threaded rendering is enabled.
+		 */
+		void renderLine_int(void);
+
+		/**
+		 * Line state used by the renderer.
+		 * These point to Vdp::VDP_Lines and Reg_Status, or to the
+		 * render thread's copies if threaded rendering is enabled,
+		 * since the emulation thread updates those every line.
+		 */
+		const VdpTypes::VdpLines_t *rendLines;
+		const VdpStatus *rendStatus;
+
+		// Render thread. (nullptr if threaded rendering is disabled.)
+		struct RenderThread_t;
+		RenderThread_t *rendThread;
+
+		// Status bits set by the render thread.
+		// (Sprite collision, sprite overflow)
+		// These are merged into Reg_Status by the emulation thread.
+		std::atomic<unsigned int> rendStatusBits;
+
+		/**
+		 * Start the render thread.
+		 * Called by the emulation thread.
+		 */
+		void rendThreadStart(void);
+
+		/**
+		 * Render thread function.
+		 */
+		void rendThreadMain(void);
+
+		/**
+		 * Stop the render thread.
+		 * All queued lines are rendered first.
+		 * Called by the emulation thread.
+		 */
+		void rendThreadStop(void);
+
+		/**
+		 * Queue the current line for rendering.
+		 * Called by the emulation thread.
+		 */
+		void rendQueueLine(void);
+
+		/**
+		 * Wait for the render thread to render all queued lines.
+		 * Called by the emulation thread.
+		 */
+		void rendWait(void);
+
+		/**
+		 * Wait for the render thread to render all queued lines
+		 * that can set the sprite collision and overflow bits.
+		 * Called by the emulation thread.
+		 */
+		void rendWaitSprStatus(void);
+
+		/**
+		 * Can the current line set the sprite collision and overflow bits?
+		 * Called by the emulation thread.
+		 * @return True if rendering the current line may set the bits.
+		 */
+		bool rendLineSetsSprStatus(void) const;
+
+		/**
+		 * Merge status bits set by the render thread into Reg_Status.
+		 * Called by the emulation thread.
+		 */
+		void rendMergeStatus(void);
+
+		/**
+		 * Wait for the render thread before modifying VDP state.
+		 * All VDP state used by the renderer must be synchronized
+		 * using this function, except for the line state above.
+		 * Called by the emulation thread.
+		 */
+		inline void rendSync(void)
+		{
+			if (rendThread)
+				rendWait();
+		}
+
+		/**
+		 * Wait for the render thread before reading the status register.
+		 * Unlike rendSync(), this only waits for queued lines that
+		 * can set the sprite collision and overflow bits.
+		 * Called by the emulation thread.
+		 */
+		inline void rendSyncStatus(void)
+		{
+			if (rendThread)
+				rendWaitSprStatus();
+		}
+
+		/**
+		 * Set a status bit from the renderer.
+		 * @param bit Status bit to set.
+		 */
+		inline void setRendStatusBit(VdpStatus::StatusBits bit)
+		{
+			if (rendThread)
+				rendStatusBits.fetch_or(bit, std::memory_order_relaxed);
+			else
+				Reg_Status.setBit(bit, true);
+		}
 };
 
 }
@@ -29,96 +29,54 @@
 #include "macros/common.h"
 #include "Cartridge/RomCartridgeMD.hpp"
 
+#ifdef USE_PORTABLE_M68K
+#include "md68k/md68k.h"
+#endif
+
+// ZOMG
+#include "libzomg/ZomgBase.hpp"
+
 // C includes. (C++ namespace)
+#include <cerrno>
 #include <cstring>
 
 namespace LibGens {
 
-S68000CONTEXT M68K::ms_Context;
-
-// Instruction fetch.
-STARSCREAM_PROGRAMREGION M68K::M68K_Fetch[] =
+/**
+ * Initialize an M68K state.
+ * The memory regions are set up by Init() and InitSys().
+ */
+M68K::State::State()
 {
-#ifdef GENS_ENABLE_EMULATION
-	// 32 entries for RAM, including mirrors.
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-
-	// 64 entries for ROM handlers.
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-	{~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0}, {~0U, ~0U, 0},
-#endif /* GENS_ENABLE_EMULATION */
-	
-	// Terminator.
-	{~0U, ~0U, 0}
-};
+	memset(&context, 0x00, sizeof(context));
+	for (int i = 0; i < M68K_FETCH_REGION_COUNT; i++) {
+		fetch[i].lowaddr = ~0U;
+		fetch[i].highaddr = ~0U;
+		fetch[i].offset = 0;
+	}
+	lastSysID = SYSID_NONE;
+#ifdef USE_PORTABLE_M68K
+	cpu = nullptr;
+#endif
+}
 
-// M68K Starscream has a hack for RAM mirroring for data read.
-STARSCREAM_DATAREGION M68K::M68K_Read_Byte[4] =
-{
-#ifdef GENS_ENABLE_EMULATION
-	// TODO: 0x9FFFFF is valid for MD only.
-	{0x000000, 0x9FFFFF, NULL, NULL},
-	{0xFF0000, 0xFFFFFF, NULL, &Ram_68k.u8[0]},
-	{0xA00000, 0xFEFFFF, (void*)M68K_Mem::M68K_RB, NULL},
-#endif /* GENS_ENABLE_EMULATION */
-	{~0U, ~0U, NULL, NULL}
-};
+// Default state.
+M68K::State M68K::ms_DefaultState;
 
-// M68K Starscream has a hack for RAM mirroring for data read.
-STARSCREAM_DATAREGION M68K::M68K_Read_Word[4] =
-{
-#ifdef GENS_ENABLE_EMULATION
-	// TODO: 0x9FFFFF is valid for MD only.
-	{0x000000, 0x9FFFFF, NULL, NULL},
-	{0xFF0000, 0xFFFFFF, NULL, &Ram_68k.u8[0]},
-	{0xA00000, 0xFEFFFF, (void*)M68K_Mem::M68K_RW, NULL},
-#endif /* GENS_ENABLE_EMULATION */
-	{~0U, ~0U, NULL, NULL}
-};
-
-// M68K Starscream has a hack for RAM mirroring for data write.
-STARSCREAM_DATAREGION M68K::M68K_Write_Byte[3] =
-{
-#ifdef GENS_ENABLE_EMULATION
-	{0xFF0000, 0xFFFFFF, NULL, &Ram_68k.u8[0]},
-	{0x000000, 0xFEFFFF, (void*)M68K_Mem::M68K_WB, NULL},
-#endif /* GENS_ENABLE_EMULATION */
-	{~0U, ~0U, NULL, NULL}
-};
+// Current state.
+THREAD_LOCAL M68K::State *M68K::ms_State = &M68K::ms_DefaultState;
 
-// M68K Starscream has a hack for RAM mirroring for data write.
-STARSCREAM_DATAREGION M68K::M68K_Write_Word[3] =
+/**
+ * Bind a State to the calling thread.
+ * @param state State, or nullptr for the default state.
+ */
+void M68K::BindState(State *state)
 {
-#ifdef GENS_ENABLE_EMULATION
-	{0xFF0000, 0xFFFFFF, NULL, &Ram_68k.u8[0]},
-	{0x000000, 0xFEFFFF, (void*)M68K_Mem::M68K_WW, NULL},
-#endif /* GENS_ENABLE_EMULATION */
-	{~0U, ~0U, NULL, NULL}
-};
-
-// Last system ID.
-M68K::SysID M68K::ms_LastSysID = SYSID_NONE;
+	ms_State = (state ? state : &ms_DefaultState);
+#if defined(GENS_ENABLE_EMULATION) && defined(USE_PORTABLE_M68K)
+	main68k_bindState(ms_State->cpu);
+#endif
+}
 
 /**
  * Reset handler.
@@ -134,30 +92,62 @@ void M68K::M68K_Reset_Handler(void)
  */
 void M68K::Init(void)
 {
+	State *const st = ms_State;
+
+#if defined(GENS_ENABLE_EMULATION) && defined(USE_PORTABLE_M68K)
+	// Allocate the md68k CPU state.
+	if (!st->cpu)
+		st->cpu = main68k_newState();
+	main68k_bindState(st->cpu);
+#endif
+
 	// Clear the 68000 context.
-	memset(&ms_Context, 0x00, sizeof(ms_Context));
+	memset(&st->context, 0x00, sizeof(st->context));
+
+	// Initialize the data regions.
+	// Starscream accesses Ram_68k directly and calls M68K_Mem for
+	// everything else, so it doesn't use these regions.
+	// md68k uses them to build its page tables.
+	// Entry 0 is the M68K_Mem handler. Entries 1-32 are RAM,
+	// including mirrors, and are initialized by InitSys().
+	STARSCREAM_DATAREGION *const regions[4] =
+		{st->readByte, st->readWord, st->writeByte, st->writeWord};
+	void *const handlers[4] = {
+		(void*)M68K_Mem::M68K_RB, (void*)M68K_Mem::M68K_RW,
+		(void*)M68K_Mem::M68K_WB, (void*)M68K_Mem::M68K_WW
+	};
+	for (int i = 0; i < 4; i++) {
+		regions[i][0].lowaddr = 0x000000;
+		regions[i][0].highaddr = 0xDFFFFF;
+		regions[i][0].memorycall = handlers[i];
+		regions[i][0].userdata = nullptr;
+		regions[i][1].lowaddr = ~0U;
+		regions[i][1].highaddr = ~0U;
+		regions[i][1].memorycall = nullptr;
+		regions[i][1].userdata = nullptr;
+	}
 
 	// Initialize the memory handlers.
-	ms_Context.s_fetch = ms_Context.u_fetch =
-		ms_Context.fetch = M68K_Fetch;
+	st->context.s_fetch = st->context.u_fetch =
+		st->context.fetch = st->fetch;
 
-	ms_Context.s_readbyte = ms_Context.u_readbyte =
-		ms_Context.readbyte = M68K_Read_Byte;
+	st->context.s_readbyte = st->context.u_readbyte =
+		st->context.readbyte = st->readByte;
 
-	ms_Context.s_readword = ms_Context.u_readword =
-		ms_Context.readword = M68K_Read_Word;
+	st->context.s_readword = st->context.u_readword =
+		st->context.readword = st->readWord;
 
-	ms_Context.s_writebyte = ms_Context.u_writebyte =
-		ms_Context.writebyte = M68K_Write_Byte;
+	st->context.s_writebyte = st->context.u_writebyte =
+		st->context.writebyte = st->writeByte;
 
-	ms_Context.s_writeword = ms_Context.u_writeword =
-		ms_Context.writeword = M68K_Write_Word;
+	st->context.s_writeword = st->context.u_writeword =
+		st->context.writeword = st->writeWord;
 
-	ms_Context.resethandler = M68K_Reset_Handler;
+	st->context.resethandler = M68K_Reset_Handler;
 
 #ifdef GENS_ENABLE_EMULATION
 	// Set up the main68k context.
-	main68k_SetContext(&ms_Context);
+	main68k_SetContext(&st->context);
 	main68k_init();
 #endif /* GENS_ENABLE_EMULATION */
 }
@@ -167,7 +157,11 @@ void M68K::Init(void)
  */
 void M68K::End(void)
 {
-	// TODO
+#if defined(GENS_ENABLE_EMULATION) && defined(USE_PORTABLE_M68K)
+	// Free the md68k CPU state.
+	main68k_freeState(ms_State->cpu);
+	ms_State->cpu = nullptr;
+#endif
 }
 
 /**
@@ -176,11 +170,10 @@ void M68K::End(void)
  */
 void M68K::InitSys(SysID system)
 {
-	// TODO: This is not 64-bit clean!
-	ms_LastSysID = system;
+	ms_State->lastSysID = system;
 
 	// Clear M68K RAM.
-	memset(Ram_68k.u8, 0x00, sizeof(Ram_68k.u8));
+	memset(M68K_Mem::ms_State->ram, 0x00, sizeof(*M68K_Mem::ms_State->ram));
 
 	// Initialize the M68K memory handlers.
 	M68K_Mem::InitSys(system);
@@ -189,10 +182,14 @@ void M68K::InitSys(SysID system)
 	// Initialize M68K RAM handlers.
 	for (int i = 0; i < 32; i++) {
 		uint32_t ram_addr = (0xE00000 | (i << 16));
-		M68K_Fetch[i].lowaddr = ram_addr;
-		M68K_Fetch[i].highaddr = (ram_addr | 0xFFFF);
-		M68K_Fetch[i].offset = ((uint32_t)(&Ram_68k.u8[0]) - ram_addr);
+		ms_State->fetch[i].lowaddr = ram_addr;
+		ms_State->fetch[i].highaddr = (ram_addr | 0xFFFF);
+		ms_State->fetch[i].offset = ((uintptr_t)(&M68K_Mem::ms_State->ram->u8[0]) - ram_addr);
 	}
+	InitDataRegions(ms_State->readByte);
+	InitDataRegions(ms_State->readWord);
+	InitDataRegions(ms_State->writeByte);
+	InitDataRegions(ms_State->writeWord);
 
 	// Update the system-specific banking setup.
 	UpdateSysBanking();
@@ -202,16 +199,43 @@ void M68K::InitSys(SysID system)
 #endif /* GENS_ENABLE_EMULATION */
 }
 
+/**
+ * Initialize the RAM entries in a data region array.
+ * Entry 0 (M68K_Mem handler) is not modified.
+ * @param regions Data region array.
+ */
+void M68K::InitDataRegions(STARSCREAM_DATAREGION *regions)
+{
+	for (int i = 0; i < 32; i++) {
+		uint32_t ram_addr = (0xE00000 | (i << 16));
+		regions[i+1].lowaddr = ram_addr;
+		regions[i+1].highaddr = (ram_addr | 0xFFFF);
+		regions[i+1].memorycall = nullptr;
+		regions[i+1].userdata = &M68K_Mem::ms_State->ram->u8[0];
+	}
+
+	// Terminator.
+	regions[33].lowaddr = -1;
+	regions[33].highaddr = -1;
+	regions[33].memorycall = nullptr;
+	regions[33].userdata = nullptr;
+}
+
 /**
  * Shut down M68K emulation.
  */
 void M68K::EndSys(void)
 {
-	for (int i = 0; i < ARRAY_SIZE(M68K_Fetch); i++) {
-		M68K_Fetch[i].lowaddr = -1;
-		M68K_Fetch[i].highaddr = -1;
-		M68K_Fetch[i].offset = 0;
+	for (int i = 0; i < M68K_FETCH_REGION_COUNT; i++) {
+		ms_State->fetch[i].lowaddr = -1;
+		ms_State->fetch[i].highaddr = -1;
+		ms_State->fetch[i].offset = 0;
 	}
+
+#if defined(GENS_ENABLE_EMULATION) && defined(USE_PORTABLE_M68K)
+	// Update md68k's page tables.
+	main68k_updateRegions();
+#endif
 }
 
 /**
@@ -220,14 +244,14 @@ void M68K::EndSys(void)
  */
 void M68K::UpdateSysBanking(void)
 {
-	// Start at M68K_Fetch[0x20].
+	// Start at fetch[0x20].
 	int cur_fetch = 0x20;
-	switch (ms_LastSysID) {
+	switch (ms_State->lastSysID) {
 		case SYSID_MD:
 		case SYSID_PICO:
 			// Sega Genesis / Mega Drive.
 			// Also Pico. (This only adds cartridge ROM.)
-			cur_fetch += M68K_Mem::UpdateSysBanking(&M68K_Fetch[cur_fetch], 10);
+			cur_fetch += M68K_Mem::UpdateSysBanking(&ms_State->fetch[cur_fetch], 10);
 			break;
 
 		case SYSID_MCD:
@@ -240,14 +264,14 @@ void M68K::UpdateSysBanking(void)
 			MS68K_Set_Word_Ram();
 			
 			// Set up Program RAM. (Entry 34)
-			M68K_Fetch[34].lowaddr = 0x020000;
-			M68K_Fetch[34].highaddr = 0x03FFFF;
+			ms_State->fetch[34].lowaddr = 0x020000;
+			ms_State->fetch[34].highaddr = 0x03FFFF;
 			M68K_Set_Prg_Ram();
 			
 			// Terminate the list.
-			M68K_Fetch[35].lowaddr = -1;
-			M68K_Fetch[35].highaddr = -1;
-			M68K_Fetch[35].offset = (unsigned int)NULL;
+			ms_State->fetch[35].lowaddr = -1;
+			ms_State->fetch[35].highaddr = -1;
+			ms_State->fetch[35].offset = (unsigned int)NULL;
 #endif
 			break;
 		
@@ -258,9 +282,9 @@ void M68K::UpdateSysBanking(void)
 			Bank_SH2 = 0;
 			
 			// Nothing else is required. Terminate the list.
-			M68K_Fetch[33].lowaddr  = -1;
-			M68K_Fetch[33].highaddr = -1;
-			M68K_Fetch[33].offset   = (unsigned int)NULL;
+			ms_State->fetch[33].lowaddr  = -1;
+			ms_State->fetch[33].highaddr = -1;
+			ms_State->fetch[33].offset   = (unsigned int)NULL;
 #endif
 			break;
 		
@@ -269,12 +293,19 @@ void M68K::UpdateSysBanking(void)
 	}
 
 	// Set the terminator.
-	M68K_Fetch[cur_fetch].lowaddr = -1;
-	M68K_Fetch[cur_fetch].highaddr = -1;
-	M68K_Fetch[cur_fetch].offset = 0;
-
+	ms_State->fetch[cur_fetch].lowaddr = -1;
+	ms_State->fetch[cur_fetch].highaddr = -1;
+	ms_State->fetch[cur_fetch].offset = 0;
+
+#if defined(GENS_ENABLE_EMULATION) && defined(USE_PORTABLE_M68K)
+	// Update md68k's page tables.
+	// The program counter is looked up on every fetch,
+	// so it doesn't need to be rebased.
+	main68k_updateRegions();
+#else
 	// FIXME: Make sure Starscream's internal program counter
-	// is updated to reflect the updated M68K_Fetch[].
+	// is updated to reflect the updated fetch[].
+#endif
 }
 
 /** ZOMG savestate functions. **/
@@ -332,34 +363,90 @@ void M68K::ZomgSaveReg(Zomg_M68KRegSave_t *state)
 void M68K::ZomgRestoreReg(const Zomg_M68KRegSave_t *state)
 {
 #ifdef GENS_ENABLE_EMULATION
-	main68k_GetContext(&ms_Context);
+	main68k_GetContext(&ms_State->context);
 
 	// Load the main registers.
 	for (int i = 0; i < 8; i++)
-		ms_Context.dreg[i] = state->dreg[i];
+		ms_State->context.dreg[i] = state->dreg[i];
 	for (int i = 0; i < 7; i++)
-		ms_Context.areg[i] = state->areg[i];
+		ms_State->context.areg[i] = state->areg[i];
 
 	// Load the stack pointers.
-	if (ms_Context.sr & 0x2000) {
+	// NOTE: This depends on the saved SR, not the current SR.
+	ms_State->context.sr = state->sr;
+	if (ms_State->context.sr & 0x2000) {
 		// Supervisor mode.
-		// ms_Context.areg[7] == ssp
-		// ms_Context.asp     == usp
-		ms_Context.areg[7] = state->ssp;
-		ms_Context.asp     = state->usp;
+		// ms_State->context.areg[7] == ssp
+		// ms_State->context.asp     == usp
+		ms_State->context.areg[7] = state->ssp;
+		ms_State->context.asp     = state->usp;
 	} else {
 		// User mode.
-		// ms_Context.areg[7] == usp
-		// ms_Context.asp     == ssp
-		ms_Context.asp     = state->ssp;
-		ms_Context.areg[7] = state->usp;
+		// ms_State->context.areg[7] == usp
+		// ms_State->context.asp     == ssp
+		ms_State->context.asp     = state->ssp;
+		ms_State->context.areg[7] = state->usp;
 	}
 
 	// Other registers.
-	ms_Context.pc = state->pc;
-	ms_Context.sr = state->sr;
+	ms_State->context.pc = state->pc;
 
-	main68k_SetContext(&ms_Context);
+	main68k_SetContext(&ms_State->context);
+#endif /* GENS_ENABLE_EMULATION */
+}
+
+/**
+ * M68K internal state.
+ * Saved verbatim in snapshots.
+ */
+struct M68K_Internal_t {
+	uint32_t odometer;
+	uint8_t interrupts[8];	// [0] == pending IRQ level and STOP state.
+};
+
+/**
+ * Save the M68K's internal state.
+ * This includes the pending interrupt level and
+ * the STOP state, which aren't part of ZOMG.
+ * @param zomg ZOMG savestate object to save to.
+ */
+void M68K::ZomgSaveInternal(LibZomg::ZomgBase *zomg)
+{
+#ifdef GENS_ENABLE_EMULATION
+	struct S68000CONTEXT m68k_context;
+	main68k_GetContext(&m68k_context);
+
+	M68K_Internal_t internal;
+	internal.odometer = m68k_context.odometer;
+	memcpy(internal.interrupts, m68k_context.interrupts, sizeof(internal.interrupts));
+	zomg->saveInternal(LibZomg::ZomgBase::INTERNAL_M68K, &internal, sizeof(internal));
+#else
+	((void)zomg);
+#endif /* GENS_ENABLE_EMULATION */
+}
+
+/**
+ * Restore the M68K's internal state.
+ * This must be called after ZomgRestoreReg().
+ * @param zomg ZOMG savestate object to restore from.
+ * @return 0 on success; negative errno on error.
+ */
+int M68K::ZomgRestoreInternal(LibZomg::ZomgBase *zomg)
+{
+#ifdef GENS_ENABLE_EMULATION
+	M68K_Internal_t internal;
+	int ret = zomg->loadInternal(LibZomg::ZomgBase::INTERNAL_M68K, &internal, sizeof(internal));
+	if (ret != 0)
+		return ret;
+
+	main68k_GetContext(&ms_State->context);
+	ms_State->context.odometer = internal.odometer;
+	memcpy(ms_State->context.interrupts, internal.interrupts, sizeof(internal.interrupts));
+	main68k_SetContext(&ms_State->context);
+	return 0;
+#else
+	((void)zomg);
+	return -ENOSYS;
 #endif /* GENS_ENABLE_EMULATION */
 }
 
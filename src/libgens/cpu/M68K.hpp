@@ -27,10 +27,19 @@
 #include <libgens/config.libgens.h>
 
 #include "star_68k.h"
+#ifdef USE_PORTABLE_M68K
+#include "md68k/md68k.h"
+#endif
+
+#include "macros/common.h"
 
 // ZOMG M68K structs.
 #include "libzomg/zomg_m68k.h"
 
+namespace LibZomg {
+	class ZomgBase;
+}
+
 // TODO: Move these elsewhere!
 #define CLOCK_NTSC 53693175
 #define CLOCK_PAL  53203424
@@ -68,6 +77,22 @@ class M68K
 		/** ZOMG savestate functions. **/
 		static void ZomgSaveReg(Zomg_M68KRegSave_t *state);
 		static void ZomgRestoreReg(const Zomg_M68KRegSave_t *state);
+
+		/**
+		 * Save the M68K's internal state.
+		 * This includes the pending interrupt level and
+		 * the STOP state, which aren't part of ZOMG.
+		 * @param zomg ZOMG savestate object to save to.
+		 */
+		static void ZomgSaveInternal(LibZomg::ZomgBase *zomg);
+
+		/**
+		 * Restore the M68K's internal state.
+		 * This must be called after ZomgRestoreReg().
+		 * @param zomg ZOMG savestate object to restore from.
+		 * @return 0 on success; negative errno on error.
+		 */
+		static int ZomgRestoreInternal(LibZomg::ZomgBase *zomg);
 		
 		/** BEGIN: Starscream wrapper functions. **/
 		static inline void Reset(void);
@@ -77,16 +102,52 @@ class M68K
 		static inline void AddCycles(int cycles);
 		static inline unsigned int Exec(int n);
 		static inline unsigned int TripOdometer(void);
+		static inline void ClearInterrupts(void);
 		/** END: Starscream wrapper functions. **/
-	
+
+		/**
+		 * Enable or disable idle loop detection.
+		 * Only supported by the portable 68000 core.
+		 * @param enable True to enable; false to disable.
+		 */
+		static inline void SetIdleLoopDetect(bool enable);
+
+		// Fetch regions: 32 RAM mirrors, 64 ROM handlers, terminator.
+		#define M68K_FETCH_REGION_COUNT (32+64+1)
+		// Data regions: M68K_Mem handler, 32 RAM mirrors, terminator.
+		#define M68K_DATA_REGION_COUNT 34
+
+		/**
+		 * Per-context M68K state.
+		 * Each EmuContext has its own State.
+		 * The M68K functions use the State bound to the calling thread.
+		 */
+		struct State {
+			S68000CONTEXT context;
+			STARSCREAM_PROGRAMREGION fetch[M68K_FETCH_REGION_COUNT];
+			STARSCREAM_DATAREGION readByte[M68K_DATA_REGION_COUNT];
+			STARSCREAM_DATAREGION readWord[M68K_DATA_REGION_COUNT];
+			STARSCREAM_DATAREGION writeByte[M68K_DATA_REGION_COUNT];
+			STARSCREAM_DATAREGION writeWord[M68K_DATA_REGION_COUNT];
+			SysID lastSysID;
+#ifdef USE_PORTABLE_M68K
+			md68k_state *cpu;	// Allocated by Init().
+#endif
+
+			State();
+		};
+
+		/**
+		 * Bind a State to the calling thread.
+		 * @param state State, or nullptr for the default state.
+		 */
+		static void BindState(State *state);
+
 	protected:
-		static S68000CONTEXT ms_Context;
-		
-		static STARSCREAM_PROGRAMREGION M68K_Fetch[];
-		static STARSCREAM_DATAREGION M68K_Read_Byte[4];
-		static STARSCREAM_DATAREGION M68K_Read_Word[4];
-		static STARSCREAM_DATAREGION M68K_Write_Byte[3];
-		static STARSCREAM_DATAREGION M68K_Write_Word[3];
+		// Current state.
+		static THREAD_LOCAL State *ms_State;
+
+		static void InitDataRegions(STARSCREAM_DATAREGION *regions);
 		
 		// TODO: What does the Reset Handler function do?
 		static void M68K_Reset_Handler(void);
@@ -95,7 +156,9 @@ class M68K
 		M68K() { }
 		~M68K() { }
 
-		static SysID ms_LastSysID;
+		// Default state.
+		// Used if BindState() hasn't been called on this thread.
+		static State ms_DefaultState;
 };
 
 /** BEGIN: Starscream wrapper functions. **/
@@ -166,6 +229,32 @@ inline unsigned int M68K::TripOdometer(void)
 	return main68k_tripOdometer();
 }
 
+/**
+ * Clear the pending interrupt level.
+ */
+inline void M68K::ClearInterrupts(void)
+{
+#ifdef USE_PORTABLE_M68K
+	main68k_clearInterrupts();
+#else
+	main68k_context.interrupts[0] &= 0xF0;
+#endif
+}
+
+/**
+ * Enable or disable idle loop detection.
+ * Only supported by the portable 68000 core.
+ * @param enable True to enable; false to disable.
+ */
+inline void M68K::SetIdleLoopDetect(bool enable)
+{
+#ifdef USE_PORTABLE_M68K
+	main68k_setIdleLoopDetect(enable);
+#else
+	((void)enable);
+#endif
+}
+
 #else /* !GENS_ENABLE_EMULATION */
 
 inline void M68K::Reset(void) { }
@@ -175,6 +264,8 @@ inline void M68K::ReleaseCycles(int cycles) { ((void)cycles); }
 inline void M68K::AddCycles(int cycles) { ((void)cycles); }
 inline unsigned int M68K::Exec(int n) { ((void)n); return 0; }
 inline unsigned int M68K::TripOdometer(void) { return 0; }
+inline void M68K::ClearInterrupts(void) { }
+inline void M68K::SetIdleLoopDetect(bool enable) { ((void)enable); }
 
 #endif /* GENS_ENABLE_EMULATION */
 
@@ -44,6 +44,7 @@
 
 // Sound Manager.
 #include "sound/SoundMgr.hpp"
+#include "Util/VgmLogger.hpp"
 
 // TODO: Starscream accesses Ram_68k directly.
 // Move Ram_68k back to M68K once Starscream is updated.
@@ -89,37 +90,43 @@ void Gens_M68K_WW(uint32_t address, uint16_t data)
 namespace LibGens
 {
 
-/** ROM and RAM variables. **/
-//M68K_Mem::Ram_68k_t M68K_Mem::Ram_68k;	// TODO: Fix Starscream!
-
-// ROM cartridge.
-RomCartridgeMD *M68K_Mem::ms_RomCartridge = nullptr;
-
-// TMSS registers.
-TmssReg M68K_Mem::tmss_reg;
-
 /** Z80/M68K cycle table. **/
 int M68K_Mem::Z80_M68K_Cycle_Tab[512];
 
-// M68K static variables.
-// TODO: Improve some of these, especially the cycle counters!
-unsigned int M68K_Mem::Z80_State;
-int M68K_Mem::Last_BUS_REQ_Cnt;
-int M68K_Mem::Last_BUS_REQ_St;
-int M68K_Mem::Bank_M68K;
-int M68K_Mem::Fake_Fetch;
+/**
+ * Initialize an M68K memory state.
+ * The default state uses the global Ram_68k.
+ */
+M68K_Mem::State::State()
+	: ram(&Ram_68k)
+	, romCartridge(nullptr)
+	, Z80_State(0)
+	, Last_BUS_REQ_Cnt(0)
+	, Last_BUS_REQ_St(0)
+	, Bank_M68K(0)
+	, Fake_Fetch(0)
+	, CPL_M68K(0)
+	, CPL_Z80(0)
+	, Cycles_M68K(0)
+	, Cycles_Z80(0)
+{
+	memset(M68KBank_Type, 0x00, sizeof(M68KBank_Type));
+}
 
-int M68K_Mem::CPL_M68K;
-int M68K_Mem::CPL_Z80;
-int M68K_Mem::Cycles_M68K;
-int M68K_Mem::Cycles_Z80;
+// Default state.
+M68K_Mem::State M68K_Mem::ms_DefaultState;
+
+// Current state.
+THREAD_LOCAL M68K_Mem::State *M68K_Mem::ms_State = &M68K_Mem::ms_DefaultState;
 
 /**
- * M68K bank type identifiers.
- * These type identifiers indicate what's mapped to each virtual bank.
- * Banks are 2 MB each, for a total of 8 banks.
+ * Bind a State to the calling thread.
+ * @param state State, or nullptr for the default state.
  */
-uint8_t M68K_Mem::ms_M68KBank_Type[8];
+void M68K_Mem::BindState(State *state)
+{
+	ms_State = (state ? state : &ms_DefaultState);
+}
 
 /**
  * Default M68K bank type IDs for MD.
@@ -186,7 +193,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Ram(uint32_t address)
 {
 	address &= 0xFFFF;
 	address ^= U16DATA_U8_INVERT;
-	return Ram_68k.u8[address];
+	return ms_State->ram->u8[address];
 }
 
 /**
@@ -199,7 +206,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Misc(uint32_t address)
 {
 	if (address <= 0xA0FFFF) {
 		// Z80 memory space.
-		if (Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET)) {
+		if (ms_State->Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET)) {
 			// Z80 is either running or has the bus.
 			// Don't do anything.
 			// TODO: I don't think the Z80 needs to be stopped here...
@@ -228,20 +235,20 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Misc(uint32_t address)
 			// NOTE: Genesis Plus does BUSREQ at any even 0xA111xx...
 			if (address & 1) {
 				// FAKE FETCH.
-				Fake_Fetch ^= 0xFF;
-				return Fake_Fetch;
+				ms_State->Fake_Fetch ^= 0xFF;
+				return ms_State->Fake_Fetch;
 			}
 
-			if (Z80_State & Z80_STATE_BUSREQ) {
+			if (ms_State->Z80_State & Z80_STATE_BUSREQ) {
 				// Z80 is currently running.
 				return 0x81;
 			}
 
 			// Z80 is not running.
 			int odo68k = M68K::ReadOdometer();
-			odo68k -= Last_BUS_REQ_Cnt;
+			odo68k -= ms_State->Last_BUS_REQ_Cnt;
 			if (odo68k <= CYCLE_FOR_TAKE_Z80_BUS_GENESIS)
-				return ((Last_BUS_REQ_St | 0x80) & 0xFF);
+				return ((ms_State->Last_BUS_REQ_St | 0x80) & 0xFF);
 			else
 				return 0x80;
 		}
@@ -254,11 +261,11 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Misc(uint32_t address)
 
 		case 0x30:
 			// 0xA130xx: /TIME registers.
-			return ms_RomCartridge->readByte_TIME(address & 0xFF);
+			return ms_State->romCartridge->readByte_TIME(address & 0xFF);
 
 		case 0x40: {
 			// 0xA14000: TMSS ('SEGA' register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				// TODO: Fake Fetch?
 				return 0xFF;
@@ -273,12 +280,12 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Misc(uint32_t address)
 
 			// 'SEGA' register.
 			// TODO: Is this readable?
-			return tmss_reg.a14000.b[(address & 3) ^ U32DATA_U8_INVERT];
+			return ms_State->tmss_reg.a14000.b[(address & 3) ^ U32DATA_U8_INVERT];
 		}
 
 		case 0x41: {
 			// 0xA14101: TMSS (!CART_CE register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				// TODO: Fake Fetch?
 				return 0xFF;
@@ -292,7 +299,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Misc(uint32_t address)
 			}
 
 			// !CART_CE register.
-			return (tmss_reg.n_cart_ce & 1);
+			return (ms_State->tmss_reg.n_cart_ce & 1);
 		}
 
 		case 0x00: {
@@ -320,7 +327,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Misc(uint32_t address)
 			// NOTE: Reads from even addresses are handled the same as odd addresses.
 			// (Least-significant bit is ignored.)
 			uint8_t ret = 0xFF;
-			const LibGens::IoManager *const ioManager = EmuContext::m_ioManager;
+			const LibGens::IoManager *const ioManager = EmuContext::Instance()->m_ioManager;
 			switch (address & 0x1E) {
 				case 0x00: {
 					// 0xA10001: Genesis version register.
@@ -454,7 +461,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_VDP(uint32_t address)
 inline uint8_t M68K_Mem::M68K_Read_Byte_TMSS_Rom(uint32_t address)
 {
 	// TODO: Remove this function?
-	return tmss_reg.readByte(address);
+	return ms_State->tmss_reg.readByte(address);
 }
 
 /**
@@ -471,7 +478,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Pico_IO(uint32_t address)
 		return 0xFF;
 	}
 
-	LibGens::IoManager *const ioManager = EmuContext::m_ioManager;
+	LibGens::IoManager *const ioManager = EmuContext::Instance()->m_ioManager;
 	uint8_t ret = 0xFF; // TODO: Default to prefetched data?
 
 	switch (address & 0x1F) {
@@ -508,7 +515,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Pico_IO(uint32_t address)
 			// Odd bytes here contain "SEGA".
 			// TODO: Is this readable?
 			// NOTE: TMSS ROM is not present!
-			ret = tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT];
+			ret = ms_State->tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT];
 			break;
 		default:
 			break;
@@ -528,7 +535,7 @@ inline uint8_t M68K_Mem::M68K_Read_Byte_Pico_IO(uint32_t address)
 inline uint16_t M68K_Mem::M68K_Read_Word_Ram(uint32_t address)
 {
 	address &= 0xFFFE;
-	return Ram_68k.u16[address >> 1];
+	return ms_State->ram->u16[address >> 1];
 }
 
 /**
@@ -541,7 +548,7 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Misc(uint32_t address)
 {
 	if (address <= 0xA0FFFF) {
 		// Z80 memory space.
-		if (Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET)) {
+		if (ms_State->Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET)) {
 			// Z80 is either running or has the bus.
 			// Don't do anything.
 			// TODO: I don't think the Z80 needs to be stopped here...
@@ -570,30 +577,30 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Misc(uint32_t address)
 		case 0x11: {
 			// 0xA11100: Z80 BUSREQ.
 			// NOTE: Genesis Plus does BUSREQ at any even 0xA111xx...
-			if (Z80_State & Z80_STATE_BUSREQ) {
+			if (ms_State->Z80_State & Z80_STATE_BUSREQ) {
 				// Z80 is currently running.
 				// NOTE: Low byte is supposed to be from
 				// the next fetched instruction.
-				Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
-				return (0x8100 | (Fake_Fetch & 0xFF));
+				ms_State->Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
+				return (0x8100 | (ms_State->Fake_Fetch & 0xFF));
 			}
 
 			// Z80 is not running.
 			int odo68k = M68K::ReadOdometer();
-			odo68k -= Last_BUS_REQ_Cnt;
+			odo68k -= ms_State->Last_BUS_REQ_Cnt;
 			if (odo68k <= CYCLE_FOR_TAKE_Z80_BUS_GENESIS) {
 				// bus not taken yet
 				uint16_t ret;
-				Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
-				ret = (Fake_Fetch & 0xFF);
-				ret |= ((Last_BUS_REQ_St & 0xFF) << 8);
+				ms_State->Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
+				ret = (ms_State->Fake_Fetch & 0xFF);
+				ret |= ((ms_State->Last_BUS_REQ_St & 0xFF) << 8);
 				ret += 0x8000;
 				return ret;
 			} else {
 				// bus taken
 				uint16_t ret;
-				Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
-				ret = (Fake_Fetch & 0xFF) | 0x8000;
+				ms_State->Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
+				ret = (ms_State->Fake_Fetch & 0xFF) | 0x8000;
 				return ret;
 			}
 		}
@@ -606,11 +613,11 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Misc(uint32_t address)
 
 		case 0x30:
 			// 0xA130xx: /TIME registers.
-			return ms_RomCartridge->readWord_TIME(address & 0xFF);
+			return ms_State->romCartridge->readWord_TIME(address & 0xFF);
 
 		case 0x40: {
 			// 0xA14101: TMSS ('SEGA' register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				// TODO: Fake Fetch?
 				return 0xFFFF;
@@ -625,12 +632,12 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Misc(uint32_t address)
 
 			// 'SEGA' register.
 			// TODO: Is this readable?
-			return tmss_reg.a14000.w[((address & 2) >> 1) ^ U32DATA_U16_INVERT];
+			return ms_State->tmss_reg.a14000.w[((address & 2) >> 1) ^ U32DATA_U16_INVERT];
 		}
 
 		case 0x41: {
 			// 0xA14101: TMSS (!CART_CE register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				// TODO: Fake Fetch?
 				return 0xFFFF;
@@ -644,9 +651,9 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Misc(uint32_t address)
 			}
 
 			// !CART_CE register.
-			uint16_t ret = (tmss_reg.n_cart_ce & 1);
-			Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
-			ret |= ((Fake_Fetch & 0xFF) << 8);
+			uint16_t ret = (ms_State->tmss_reg.n_cart_ce & 1);
+			ms_State->Fake_Fetch ^= 0xFF;	// Fake the next fetched instruction. ("random")
+			ret |= ((ms_State->Fake_Fetch & 0xFF) << 8);
 		}
 
 		case 0x00: {
@@ -672,7 +679,7 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Misc(uint32_t address)
 			 * 0xA1001F: Control Port 3: Serial Control.
 			 */
 			uint8_t ret = 0xFF;
-			const LibGens::IoManager *const ioManager = EmuContext::m_ioManager;
+			const LibGens::IoManager *const ioManager = EmuContext::Instance()->m_ioManager;
 			switch (address & 0x1E) {
 				case 0x00: {
 					// 0xA10001: Genesis version register.
@@ -787,7 +794,7 @@ inline uint16_t M68K_Mem::M68K_Read_Word_VDP(uint32_t address)
 inline uint16_t M68K_Mem::M68K_Read_Word_TMSS_Rom(uint32_t address)
 {
 	// TODO: Remove this function?
-	return tmss_reg.readWord(address);
+	return ms_State->tmss_reg.readWord(address);
 }
 
 /**
@@ -804,7 +811,7 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Pico_IO(uint32_t address)
 		return 0xFFFF;
 	}
 
-	LibGens::IoManager *const ioManager = EmuContext::m_ioManager;
+	LibGens::IoManager *const ioManager = EmuContext::Instance()->m_ioManager;
 	uint16_t ret = 0xFFFF; // TODO: Default to prefetched data?
 	switch (address & 0x1E) {
 		case 0x00:
@@ -850,7 +857,7 @@ inline uint16_t M68K_Mem::M68K_Read_Word_Pico_IO(uint32_t address)
 			// TODO: Is this readable?
 			// TODO: Prefetch for high bytes?
 			// NOTE: TMSS ROM is not present!
-			ret = tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT];
+			ret = ms_State->tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT];
 			break;
 		default:
 			break;
@@ -873,7 +880,7 @@ inline void M68K_Mem::M68K_Write_Byte_Ram(uint32_t address, uint8_t data)
 {
 	address &= 0xFFFF;
 	address ^= 1;	// TODO: LE only!
-	Ram_68k.u8[address] = data;
+	ms_State->ram->u8[address] = data;
 }
 
 
@@ -887,7 +894,7 @@ inline void M68K_Mem::M68K_Write_Byte_Misc(uint32_t address, uint8_t data)
 {
 	if (address <= 0xA0FFFF) {
 		// Z80 memory space.
-		if (Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET)) {
+		if (ms_State->Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET)) {
 			// Z80 is either running or has the bus.
 			// Don't do anything.
 			// TODO: I don't think the Z80 needs to be stopped here...
@@ -919,34 +926,34 @@ inline void M68K_Mem::M68K_Write_Byte_Misc(uint32_t address, uint8_t data)
 			if (data & 0x01) {
 				// M68K requests the bus.
 				// Disable the Z80.
-				Last_BUS_REQ_Cnt = M68K::ReadOdometer();
-				Last_BUS_REQ_St = (Z80_State & Z80_STATE_BUSREQ);
+				ms_State->Last_BUS_REQ_Cnt = M68K::ReadOdometer();
+				ms_State->Last_BUS_REQ_St = (ms_State->Z80_State & Z80_STATE_BUSREQ);
 
-				if (Z80_State & Z80_STATE_BUSREQ) {
+				if (ms_State->Z80_State & Z80_STATE_BUSREQ) {
 					// Z80 is running. Disable it.
-					Z80_State &= ~Z80_STATE_BUSREQ;
+					ms_State->Z80_State &= ~Z80_STATE_BUSREQ;
 					
 					// TODO: Rework this.
-					int ebx = (Cycles_M68K - Last_BUS_REQ_Cnt);
+					int ebx = (ms_State->Cycles_M68K - ms_State->Last_BUS_REQ_Cnt);
 					ebx = Z80_M68K_Cycle_Tab[ebx];
 					
-					int edx = Cycles_Z80;
+					int edx = ms_State->Cycles_Z80;
 					edx -= ebx;
 					Z80::Exec(edx);
 				}
 			} else {
 				// M68K releases the bus.
 				// Enable the Z80.
-				if (!(Z80_State & Z80_STATE_BUSREQ))
+				if (!(ms_State->Z80_State & Z80_STATE_BUSREQ))
 				{
 					// Z80 is stopped. Enable it.
-					Z80_State |= Z80_STATE_BUSREQ;
+					ms_State->Z80_State |= Z80_STATE_BUSREQ;
 					
 					// TODO: Rework this.
-					int ebx = Cycles_M68K;
+					int ebx = ms_State->Cycles_M68K;
 					ebx -= M68K::ReadOdometer();
 					
-					int edx = Cycles_Z80;
+					int edx = ms_State->Cycles_Z80;
 					ebx = Z80_M68K_Cycle_Tab[ebx];
 					edx -= ebx;
 					
@@ -965,25 +972,25 @@ inline void M68K_Mem::M68K_Write_Byte_Misc(uint32_t address, uint8_t data)
 
 			if (data & 0x01) {
 				// RESET is high. Start the Z80.
-				Z80_State &= ~Z80_STATE_RESET;
+				ms_State->Z80_State &= ~Z80_STATE_RESET;
 			} else {
 				// RESET is low. Stop the Z80.
 				Z80::SoftReset();
-				Z80_State |= Z80_STATE_RESET;
+				ms_State->Z80_State |= Z80_STATE_RESET;
 
 				// YM2612's RESET line is tied to the Z80's RESET line.
-				SoundMgr::ms_Ym2612.reset();
+				SoundMgr::ms_State->ym2612.reset();
 			}
 			break;
 
 		case 0x30:
 			// 0xA130xx: /TIME registers.
-			ms_RomCartridge->writeByte_TIME(address & 0xFF, data);
+			ms_State->romCartridge->writeByte_TIME(address & 0xFF, data);
 			break;
 
 		case 0x40: {
 			// 0xA14000: TMSS ('SEGA' register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				break;
 			}
@@ -993,13 +1000,13 @@ inline void M68K_Mem::M68K_Write_Byte_Misc(uint32_t address, uint8_t data)
 				break;
 
 			// 'SEGA' register.
-			tmss_reg.a14000.b[(address & 3) ^ U32DATA_U8_INVERT] = data;
+			ms_State->tmss_reg.a14000.b[(address & 3) ^ U32DATA_U8_INVERT] = data;
 			break;
 		}
 
 		case 0x41: {
 			// 0xA14101: TMSS (!CART_CE register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				break;
 			}
@@ -1009,7 +1016,7 @@ inline void M68K_Mem::M68K_Write_Byte_Misc(uint32_t address, uint8_t data)
 				break;
 
 			// !CART_CE register.
-			tmss_reg.n_cart_ce = (data & 1);
+			ms_State->tmss_reg.n_cart_ce = (data & 1);
 
 			// Update TMSS mapping.
 			UpdateTmssMapping();
@@ -1039,7 +1046,7 @@ inline void M68K_Mem::M68K_Write_Byte_Misc(uint32_t address, uint8_t data)
 			 * 0xA1001F: Control Port 3: Serial Control.
 			 */
 			// TODO: Do byte writes to even addresses (e.g. 0xA10002) work?
-			LibGens::IoManager *const ioManager = EmuContext::m_ioManager;
+			LibGens::IoManager *const ioManager = EmuContext::Instance()->m_ioManager;
 			switch (address & 0x1E) {
 				default:
 				case 0x00: /// 0xA10001: Genesis version register.
@@ -1109,7 +1116,11 @@ inline void M68K_Mem::M68K_Write_Byte_VDP(uint32_t address, uint8_t data)
 		case 0x10: case 0x14:
 			// PSG control port. (Odd addresses only)
 			if (address & 1) {
-				SoundMgr::ms_Psg.write(data);
+				SoundMgr::State *const snd = SoundMgr::ms_State;
+				snd->psg.write(data);
+				if (snd->vgmLogger) {
+					snd->vgmLogger->logPsg(data, M68K::ReadOdometer());
+				}
 			}
 			break;
 		case 0x18:
@@ -1155,7 +1166,7 @@ inline void M68K_Mem::M68K_Write_Byte_Pico_IO(uint32_t address, uint8_t data)
 			// TMSS register.
 			// Odd bytes here contain "SEGA".
 			// NOTE: TMSS ROM is not present!
-			tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT] = data;
+			ms_State->tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT] = data;
 			break;
 		default:
 			break;
@@ -1175,7 +1186,7 @@ inline void M68K_Mem::M68K_Write_Byte_Pico_IO(uint32_t address, uint8_t data)
 inline void M68K_Mem::M68K_Write_Word_Ram(uint32_t address, uint16_t data)
 {
 	address &= 0xFFFE;
-	Ram_68k.u16[address >> 1] = data;
+	ms_State->ram->u16[address >> 1] = data;
 }
 
 
@@ -1189,7 +1200,7 @@ inline void M68K_Mem::M68K_Write_Word_Misc(uint32_t address, uint16_t data)
 {
 	if (address <= 0xA0FFFF) {
 		// Z80 memory space.
-		if (Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET))
+		if (ms_State->Z80_State & (Z80_STATE_BUSREQ | Z80_STATE_RESET))
 		{
 			// Z80 is either running or has the bus.
 			// Don't do anything.
@@ -1223,33 +1234,33 @@ inline void M68K_Mem::M68K_Write_Word_Misc(uint32_t address, uint16_t data)
 			if (data & 0x0100) {
 				// M68K requests the bus.
 				// Disable the Z80.
-				Last_BUS_REQ_Cnt = M68K::ReadOdometer();
-				Last_BUS_REQ_St = (Z80_State & Z80_STATE_BUSREQ);
+				ms_State->Last_BUS_REQ_Cnt = M68K::ReadOdometer();
+				ms_State->Last_BUS_REQ_St = (ms_State->Z80_State & Z80_STATE_BUSREQ);
 
-				if (Z80_State & Z80_STATE_BUSREQ) {
+				if (ms_State->Z80_State & Z80_STATE_BUSREQ) {
 					// Z80 is running. Disable it.
-					Z80_State &= ~Z80_STATE_BUSREQ;
+					ms_State->Z80_State &= ~Z80_STATE_BUSREQ;
 
 					// TODO: Rework this.
-					int ebx = (Cycles_M68K - Last_BUS_REQ_Cnt);
+					int ebx = (ms_State->Cycles_M68K - ms_State->Last_BUS_REQ_Cnt);
 					ebx = Z80_M68K_Cycle_Tab[ebx];
 
-					int edx = Cycles_Z80;
+					int edx = ms_State->Cycles_Z80;
 					edx -= ebx;
 					Z80::Exec(edx);
 				}
 			} else {
 				// M68K releases the bus.
 				// Enable the Z80.
-				if (!(Z80_State & Z80_STATE_BUSREQ)) {
+				if (!(ms_State->Z80_State & Z80_STATE_BUSREQ)) {
 					// Z80 is stopped. Enable it.
-					Z80_State |= Z80_STATE_BUSREQ;
+					ms_State->Z80_State |= Z80_STATE_BUSREQ;
 
 					// TODO: Rework this.
-					int ebx = Cycles_M68K;
+					int ebx = ms_State->Cycles_M68K;
 					ebx -= M68K::ReadOdometer();
 
-					int edx = Cycles_Z80;
+					int edx = ms_State->Cycles_Z80;
 					ebx = Z80_M68K_Cycle_Tab[ebx];
 					edx -= ebx;
 
@@ -1267,26 +1278,26 @@ inline void M68K_Mem::M68K_Write_Word_Misc(uint32_t address, uint16_t data)
 			// NOTE: Test data against 0x0100, since 68000 is big-endian.
 			if (data & 0x0100) {
 				// RESET is high. Start the Z80.
-				Z80_State &= ~Z80_STATE_RESET;
+				ms_State->Z80_State &= ~Z80_STATE_RESET;
 			} else {
 				// RESET is low. Stop the Z80.
 				Z80::SoftReset();
-				Z80_State |= Z80_STATE_RESET;
+				ms_State->Z80_State |= Z80_STATE_RESET;
 
 				// YM2612's RESET line is tied to the Z80's RESET line.
-				SoundMgr::ms_Ym2612.reset();
+				SoundMgr::ms_State->ym2612.reset();
 			}
 
 			break;
 
 		case 0x30:
 			// 0xA130xx: /TIME registers.
-			ms_RomCartridge->writeWord_TIME(address & 0xFF, data);
+			ms_State->romCartridge->writeWord_TIME(address & 0xFF, data);
 			break;
 
 		case 0x40: {
 			// 0xA14000: TMSS ('SEGA' register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				break;
 			}
@@ -1296,13 +1307,13 @@ inline void M68K_Mem::M68K_Write_Word_Misc(uint32_t address, uint16_t data)
 				break;
 
 			// 'SEGA' register.
-			tmss_reg.a14000.w[((address & 2) >> 1) ^ U32DATA_U16_INVERT] = data;
+			ms_State->tmss_reg.a14000.w[((address & 2) >> 1) ^ U32DATA_U16_INVERT] = data;
 			break;
 		}
 
 		case 0x41: {
 			// 0xA14101: TMSS (!CART_CE register)
-			if (!tmss_reg.isTmssEnabled()) {
+			if (!ms_State->tmss_reg.isTmssEnabled()) {
 				// TMSS is disabled.
 				break;
 			}
@@ -1312,7 +1323,7 @@ inline void M68K_Mem::M68K_Write_Word_Misc(uint32_t address, uint16_t data)
 				break;
 
 			// !CART_CE register.
-			tmss_reg.n_cart_ce = (data & 1);
+			ms_State->tmss_reg.n_cart_ce = (data & 1);
 
 			// Update TMSS mapping.
 			UpdateTmssMapping();
@@ -1343,7 +1354,7 @@ inline void M68K_Mem::M68K_Write_Word_Misc(uint32_t address, uint16_t data)
 			 */
 			// TODO: Is there special handling for word writes,
 			// or is it just "LSB is written"?
-			LibGens::IoManager *const ioManager = EmuContext::m_ioManager;
+			LibGens::IoManager *const ioManager = EmuContext::Instance()->m_ioManager;
 			switch (address & 0x1E) {
 				default:
 				case 0x00: /// 0xA10001: Genesis version register.
@@ -1410,10 +1421,15 @@ inline void M68K_Mem::M68K_Write_Word_VDP(uint32_t address, uint16_t data)
 			// VDP control port.
 			vdp->writeCtrlMD(data);
 			break;
-		case 0x10: case 0x14:
+		case 0x10: case 0x14: {
 			// PSG control port.
-			SoundMgr::ms_Psg.write(data & 0xFF);
+			SoundMgr::State *const snd = SoundMgr::ms_State;
+			snd->psg.write(data & 0xFF);
+			if (snd->vgmLogger) {
+				snd->vgmLogger->logPsg(data & 0xFF, M68K::ReadOdometer());
+			}
 			break;
+		}
 		case 0x18:
 			// Unused write address.
 			// This address is valid, so a lockup
@@ -1457,7 +1473,7 @@ inline void M68K_Mem::M68K_Write_Word_Pico_IO(uint32_t address, uint16_t data)
 			// TMSS register.
 			// Odd bytes here contain "SEGA".
 			// NOTE: TMSS ROM is not present!
-			tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT] = (data & 0xFF);
+			ms_State->tmss_reg.a14000.b[((address >> 1) & 3) ^ U32DATA_U8_INVERT] = (data & 0xFF);
 			break;
 		default:
 			break;
@@ -1473,15 +1489,15 @@ inline void M68K_Mem::M68K_Write_Word_Pico_IO(uint32_t address, uint16_t data)
  */
 void M68K_Mem::UpdateTmssMapping(void)
 {
-	if (!tmss_reg.isTmssMapped()) {
+	if (!ms_State->tmss_reg.isTmssMapped()) {
 		// TMSS is disabled, or
 		// TMSS is enabled and cartridge is mapped.
-		ms_M68KBank_Type[0] = M68K_BANK_CARTRIDGE;
-		ms_M68KBank_Type[1] = M68K_BANK_CARTRIDGE;
+		ms_State->M68KBank_Type[0] = M68K_BANK_CARTRIDGE;
+		ms_State->M68KBank_Type[1] = M68K_BANK_CARTRIDGE;
 	} else {
 		// TMSS is enabled.
-		ms_M68KBank_Type[0] = M68K_BANK_TMSS_ROM;
-		ms_M68KBank_Type[1] = M68K_BANK_TMSS_ROM;
+		ms_State->M68KBank_Type[0] = M68K_BANK_TMSS_ROM;
+		ms_State->M68KBank_Type[1] = M68K_BANK_TMSS_ROM;
 	}
 
 	// TODO: Better way to update Starscream?
@@ -1495,24 +1511,24 @@ void M68K_Mem::UpdateTmssMapping(void)
 void M68K_Mem::InitSys(M68K::SysID system)
 {
 	// Reset the TMSS registers.
-	tmss_reg.reset();
+	ms_State->tmss_reg.reset();
 
 	// Initialize the M68K bank type identifiers.
 	switch (system) {
 		case M68K::SYSID_MD:
-			memcpy(ms_M68KBank_Type, msc_M68KBank_Def_MD, sizeof(ms_M68KBank_Type));
+			memcpy(ms_State->M68KBank_Type, msc_M68KBank_Def_MD, sizeof(ms_State->M68KBank_Type));
 			UpdateTmssMapping();
 			break;
 
 		case M68K::SYSID_PICO:
-			memcpy(ms_M68KBank_Type, msc_M68KBank_Def_Pico, sizeof(ms_M68KBank_Type));
+			memcpy(ms_State->M68KBank_Type, msc_M68KBank_Def_Pico, sizeof(ms_State->M68KBank_Type));
 			break;
 
 		default:
 			// Unknown system ID.
 			LOG_MSG(68k, LOG_MSG_LEVEL_ERROR,
 				"Unknown system ID: %d", system);
-			memset(ms_M68KBank_Type, 0x00, sizeof(ms_M68KBank_Type));
+			memset(ms_State->M68KBank_Type, 0x00, sizeof(ms_State->M68KBank_Type));
 			break;
 	}
 }
@@ -1528,13 +1544,13 @@ int M68K_Mem::UpdateSysBanking(STARSCREAM_PROGRAMREGION *M68K_Fetch, int banks)
 #ifdef GENS_ENABLE_EMULATION
 	// Mapping depends on if TMSS is mapped.
 	int cur_fetch = 0;
-	if (!tmss_reg.isTmssMapped()) {
+	if (!ms_State->tmss_reg.isTmssMapped()) {
 		// TMSS is not mapped.
 		// Update banking using RomCartridgeMD.
-		cur_fetch += ms_RomCartridge->updateSysBanking(&M68K_Fetch[cur_fetch], banks);
+		cur_fetch += ms_State->romCartridge->updateSysBanking(&M68K_Fetch[cur_fetch], banks);
 	} else {
 		// TMSS is mapped.
-		cur_fetch += tmss_reg.updateSysBanking(&M68K_Fetch[cur_fetch], banks);
+		cur_fetch += ms_State->tmss_reg.updateSysBanking(&M68K_Fetch[cur_fetch], banks);
 	}
 
 	return cur_fetch;
@@ -1556,13 +1572,13 @@ uint8_t M68K_Mem::M68K_RB(uint32_t address)
 	const uint8_t bank = ((address >> 21) & 0x7);
 
 	// TODO: Optimize the switch using a bitwise AND.
-	switch (ms_M68KBank_Type[bank]) {
+	switch (ms_State->M68KBank_Type[bank]) {
 		default:
 		case M68K_BANK_UNUSED:	return 0xFF;
 
 		// ROM cartridge.
 		case M68K_BANK_CARTRIDGE:
-			return ms_RomCartridge->readByte(address);
+			return ms_State->romCartridge->readByte(address);
 
 		// Other MD banks.
 		case M68K_BANK_MD_IO:		return M68K_Read_Byte_Misc(address);
@@ -1588,13 +1604,13 @@ uint16_t M68K_Mem::M68K_RW(uint32_t address)
 	const uint8_t bank = ((address >> 21) & 0x7);
 
 	// TODO: Optimize the switch using a bitwise AND.
-	switch (ms_M68KBank_Type[bank]) {
+	switch (ms_State->M68KBank_Type[bank]) {
 		default:
 		case M68K_BANK_UNUSED:	return 0xFFFF;
 		
 		// ROM cartridge.
 		case M68K_BANK_CARTRIDGE:
-			return ms_RomCartridge->readWord(address);
+			return ms_State->romCartridge->readWord(address);
 
 		// Other MD banks.
 		case M68K_BANK_MD_IO:		return M68K_Read_Word_Misc(address);
@@ -1621,7 +1637,7 @@ void M68K_Mem::M68K_WB(uint32_t address, uint8_t data)
 	const uint8_t bank = ((address >> 21) & 0x7);
 
 	// TODO: Optimize the switch using a bitwise AND.
-	switch (ms_M68KBank_Type[bank]) {
+	switch (ms_State->M68KBank_Type[bank]) {
 		default:
 		case M68K_BANK_UNUSED:
 		case M68K_BANK_TMSS_ROM:
@@ -1629,7 +1645,7 @@ void M68K_Mem::M68K_WB(uint32_t address, uint8_t data)
 
 		// ROM cartridge.
 		case M68K_BANK_CARTRIDGE:
-			ms_RomCartridge->writeByte(address, data);
+			ms_State->romCartridge->writeByte(address, data);
 			break;
 
 		// Other MD banks.
@@ -1653,7 +1669,7 @@ void M68K_Mem::M68K_WW(uint32_t address, uint16_t data)
 	const uint8_t bank = ((address >> 21) & 0x7);
 
 	// TODO: Optimize the switch using a bitwise AND.
-	switch (ms_M68KBank_Type[bank]) {
+	switch (ms_State->M68KBank_Type[bank]) {
 		default:
 		case M68K_BANK_UNUSED:
 		case M68K_BANK_TMSS_ROM:
@@ -1661,7 +1677,7 @@ void M68K_Mem::M68K_WW(uint32_t address, uint16_t data)
 
 		// ROM cartridge.
 		case M68K_BANK_CARTRIDGE:
-			ms_RomCartridge->writeWord(address, data);
+			ms_State->romCartridge->writeWord(address, data);
 			break;
 
 		// Other MD banks.
@@ -31,6 +31,7 @@ extern "C" {
 #endif
 // TODO: Starscream accesses Ram_68k directly.
 // Move Ram_68k back to M68K once Starscream is updated.
+// NOTE: This is the default state's RAM. Use M68K_Mem::ms_State->ram.
 typedef union {
 	uint8_t  u8[64*1024];
 	uint16_t u16[(64*1024)>>1];
@@ -59,42 +60,62 @@ class M68K_Mem
 		static void Init(void);
 		static void End(void);
 
-#if 0
-		// TODO: Starscream accesses Ram_68k directly.
-		// Move Ram_68k back here once Starscream is updated.
-		union Ram_68k_t {
-			uint8_t  u8[64*1024];
-			uint16_t u16[(64*1024)>>1];
-			uint32_t u32[(64*1024)>>2];
-		};
-		static Ram_68k_t Ram_68k;
-#endif
-		// ROM cartridge.
-		static RomCartridgeMD *ms_RomCartridge;
-
-		/**
-		 * TMSS registers.
-		 * NOTE: Only effective if system version != 0.
-		 */
-		static TmssReg tmss_reg;
-
 		/** Z80 state. **/
 		#define Z80_STATE_ENABLED	(1 << 0)
 		#define Z80_STATE_BUSREQ	(1 << 1)
 		#define Z80_STATE_RESET		(1 << 2)
 
-		static unsigned int Z80_State;
-		static int Last_BUS_REQ_Cnt;
-		static int Last_BUS_REQ_St;
-		static int Bank_M68K; // NOTE: This is for Sega CD, not Z80!
-		static int Fake_Fetch;
+		/**
+		 * Per-context M68K memory state.
+		 * Each EmuContext has its own State.
+		 * The M68K_Mem functions use the State bound to the calling thread.
+		 */
+		struct State {
+			// M68K RAM.
+			// NOTE: Starscream accesses the global Ram_68k directly,
+			// so this must point to Ram_68k if Starscream is used.
+			Ram_68k_t *ram;
+
+			// ROM cartridge.
+			RomCartridgeMD *romCartridge;
+
+			/**
+			 * TMSS registers.
+			 * NOTE: Only effective if system version != 0.
+			 */
+			TmssReg tmss_reg;
+
+			unsigned int Z80_State;
+			int Last_BUS_REQ_Cnt;
+			int Last_BUS_REQ_St;
+			int Bank_M68K; // NOTE: This is for Sega CD, not Z80!
+			int Fake_Fetch;
+
+			// Cycles per line.
+			// TODO: Replace with 3420 machine cycles per line.
+			int CPL_M68K;
+			int CPL_Z80;
+			int Cycles_M68K;
+			int Cycles_Z80;
+
+			/**
+			 * M68K bank type identifiers.
+			 * These type identifiers indicate what's mapped to each virtual bank.
+			 * Banks are 2 MB each, for a total of 8 banks.
+			 */
+			uint8_t M68KBank_Type[8];
+
+			State();
+		};
+
+		/**
+		 * Bind a State to the calling thread.
+		 * @param state State, or nullptr for the default state.
+		 */
+		static void BindState(State *state);
 
-		// Cycles per line.
-		// TODO: Replace with 3420 machine cycles per line.
-		static int CPL_M68K;
-		static int CPL_Z80;
-		static int Cycles_M68K;
-		static int Cycles_Z80;
+		// Current state.
+		static THREAD_LOCAL State *ms_State;
 
 		/** System initialization functions. **/
 	public:
@@ -147,13 +168,6 @@ class M68K_Mem
 			M68K_BANK_UNUSED = 0xFF
 		};
 
-		/**
-		 * M68K bank type identifiers.
-		 * These type identifiers indicate what's mapped to each virtual bank.
-		 * Banks are 2 MB each, for a total of 8 banks.
-		 */
-		static uint8_t ms_M68KBank_Type[8];
-
 		/**
 		 * Default M68K bank type IDs for MD.
 		 */
@@ -189,6 +203,10 @@ class M68K_Mem
 		static void M68K_Write_Word_Misc(uint32_t address, uint16_t data);
 		static void M68K_Write_Word_VDP(uint32_t address, uint16_t data);
 		static void M68K_Write_Word_Pico_IO(uint32_t address, uint16_t data);
+
+		// Default state.
+		// Used if BindState() hasn't been called on this thread.
+		static State ms_DefaultState;
 };
 
 }
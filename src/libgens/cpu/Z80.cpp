@@ -34,8 +34,20 @@
 
 namespace LibGens {
 
-// Static class variables.
-mdZ80_context *Z80::ms_Z80 = NULL;
+// Default state.
+Z80::State Z80::ms_DefaultState;
+
+// Current state.
+THREAD_LOCAL Z80::State *Z80::ms_State = &Z80::ms_DefaultState;
+
+/**
+ * Bind a State to the calling thread.
+ * @param state State, or nullptr for the default state.
+ */
+void Z80::BindState(State *state)
+{
+	ms_State = (state ? state : &ms_DefaultState);
+}
 
 /**
  * Initialize the Z80 CPU emulator.
@@ -45,15 +57,17 @@ void Z80::Init(void)
 #ifdef GENS_ENABLE_EMULATION
 	// Allocate the Z80 context.
 	// TODO: Error handling.
-	ms_Z80 = mdZ80_new();
+	mdZ80_context *const z80 = mdZ80_new();
+	ms_State->z80 = z80;
 
 	// Set instruction fetch handlers.
-	mdZ80_Add_Fetch(ms_Z80, 0x00, 0x1F, &Ram_Z80[0]);
-	mdZ80_Add_Fetch(ms_Z80, 0x20, 0x3F, &Ram_Z80[0]);
+	uint8_t *const ram = Z80_MD_Mem::ms_State->ram;
+	mdZ80_Add_Fetch(z80, 0x00, 0x1F, ram);
+	mdZ80_Add_Fetch(z80, 0x20, 0x3F, ram);
 
 	// Set memory read/write handlers.
-	mdZ80_Set_ReadB(ms_Z80, Z80_MD_Mem::Z80_ReadB);
-	mdZ80_Set_WriteB(ms_Z80, Z80_MD_Mem::Z80_WriteB);
+	mdZ80_Set_ReadB(z80, Z80_MD_Mem::Z80_ReadB);
+	mdZ80_Set_WriteB(z80, Z80_MD_Mem::Z80_WriteB);
 #endif
 
 	// Reinitialize the Z80.
@@ -67,9 +81,9 @@ void Z80::End(void)
 {
 	// Free the Z80 context.
 #ifdef GENS_ENABLE_EMULATION
-	mdZ80_free(ms_Z80);
+	mdZ80_free(ms_State->z80);
 #endif
-	ms_Z80 = NULL;
+	ms_State->z80 = NULL;
 
 	// TODO: Other shutdown stuff.
 }
@@ -80,20 +94,20 @@ void Z80::End(void)
 void Z80::ReInit(void)
 {
 	// Clear Z80 memory.
-	memset(Ram_Z80, 0x00, sizeof(Ram_Z80));
+	memset(Z80_MD_Mem::ms_State->ram, 0x00, sizeof(Ram_Z80));
 
 	// Reset the M68K banking register.
 	// TODO: 0xFF8000 or 0x000000?
-	Z80_MD_Mem::Bank_Z80 = 0x000000;
-	Z80_MD_Mem::Bank_Z80 = 0xFF8000;
+	Z80_MD_Mem::ms_State->Bank_Z80 = 0x000000;
+	Z80_MD_Mem::ms_State->Bank_Z80 = 0xFF8000;
 
 	// Disable the Z80 initially.
 	// NOTE: Bit 0 is used for the "Sound, Z80" option.
-	M68K_Mem::Z80_State &= Z80_STATE_ENABLED;
+	M68K_Mem::ms_State->Z80_State &= Z80_STATE_ENABLED;
 
 	// Reset the BUSREQ variables.
-	M68K_Mem::Last_BUS_REQ_Cnt = 0;
-	M68K_Mem::Last_BUS_REQ_St = 0;
+	M68K_Mem::ms_State->Last_BUS_REQ_Cnt = 0;
+	M68K_Mem::ms_State->Last_BUS_REQ_St = 0;
 
 	// Hard-reset the Z80.
 	HardReset();
@@ -110,35 +124,37 @@ void Z80::ZomgSaveReg(Zomg_Z80RegSave_t *state)
 	// NOTE: Byteswapping is done in libzomg.
 
 #ifdef GENS_ENABLE_EMULATION
+	mdZ80_context *const z80 = ms_State->z80;
+
 	// Main register set.
-	state->AF = mdZ80_get_AF(ms_Z80);
-	state->BC = mdZ80_get_BC(ms_Z80);
-	state->DE = mdZ80_get_DE(ms_Z80);
-	state->HL = mdZ80_get_HL(ms_Z80);
-	state->IX = mdZ80_get_IX(ms_Z80);
-	state->IY = mdZ80_get_IY(ms_Z80);
-	state->PC = mdZ80_get_PC(ms_Z80);
-	state->SP = mdZ80_get_SP(ms_Z80);
+	state->AF = mdZ80_get_AF(z80);
+	state->BC = mdZ80_get_BC(z80);
+	state->DE = mdZ80_get_DE(z80);
+	state->HL = mdZ80_get_HL(z80);
+	state->IX = mdZ80_get_IX(z80);
+	state->IY = mdZ80_get_IY(z80);
+	state->PC = mdZ80_get_PC(z80);
+	state->SP = mdZ80_get_SP(z80);
 
 	// Shadow register set.
-	state->AF2 = mdZ80_get_AF2(ms_Z80);
-	state->BC2 = mdZ80_get_BC2(ms_Z80);
-	state->DE2 = mdZ80_get_DE2(ms_Z80);
-	state->HL2 = mdZ80_get_HL2(ms_Z80);
+	state->AF2 = mdZ80_get_AF2(z80);
+	state->BC2 = mdZ80_get_BC2(z80);
+	state->DE2 = mdZ80_get_DE2(z80);
+	state->HL2 = mdZ80_get_HL2(z80);
 
 	// Other registers.
-	state->IFF = mdZ80_get_IFF(ms_Z80);
-	state->R = mdZ80_get_R(ms_Z80);
-	state->I = mdZ80_get_I(ms_Z80);
-	state->IM = mdZ80_get_IM(ms_Z80);
+	state->IFF = mdZ80_get_IFF(z80);
+	state->R = mdZ80_get_R(z80);
+	state->I = mdZ80_get_I(z80);
+	state->IM = mdZ80_get_IM(z80);
 
 	// TODO: Remove this once we switch to CZ80,
 	// since CZ80 supports WZ.
 	state->WZ = 0;
 
 	// Status.
-	uint8_t mdZ80_status = mdZ80_get_Status(ms_Z80);
-	uint8_t IntLine = mdZ80_get_IntLine(ms_Z80);
+	uint8_t mdZ80_status = mdZ80_get_Status(z80);
+	uint8_t IntLine = mdZ80_get_IntLine(z80);
 	uint8_t zomg_status = 0;
 	if (mdZ80_status & Z80_STATE_HALTED) {
 		zomg_status |= ZOMG_Z80_STATUS_HALTED;
@@ -156,7 +172,7 @@ void Z80::ZomgSaveReg(Zomg_Z80RegSave_t *state)
 	state->Status = zomg_status;
 
 	// Interrupt Vector. (IM 2)
-	state->IntVect = mdZ80_get_IntVect(ms_Z80);
+	state->IntVect = mdZ80_get_IntVect(z80);
 #else
 	memset(state, 0x00, sizeof(*state));
 #endif /* GENS_ENABLE_EMULATION */
@@ -171,27 +187,29 @@ void Z80::ZomgRestoreReg(const Zomg_Z80RegSave_t *state)
 	// NOTE: Byteswapping is done in libzomg.
 
 #ifdef GENS_ENABLE_EMULATION
+	mdZ80_context *const z80 = ms_State->z80;
+
 	// Main register set.
-	mdZ80_set_AF(ms_Z80, state->AF);
-	mdZ80_set_BC(ms_Z80, state->BC);
-	mdZ80_set_DE(ms_Z80, state->DE);
-	mdZ80_set_HL(ms_Z80, state->HL);
-	mdZ80_set_IX(ms_Z80, state->IX);
-	mdZ80_set_IY(ms_Z80, state->IY);
-	mdZ80_set_PC(ms_Z80, state->PC);
-	mdZ80_set_SP(ms_Z80, state->SP);
+	mdZ80_set_AF(z80, state->AF);
+	mdZ80_set_BC(z80, state->BC);
+	mdZ80_set_DE(z80, state->DE);
+	mdZ80_set_HL(z80, state->HL);
+	mdZ80_set_IX(z80, state->IX);
+	mdZ80_set_IY(z80, state->IY);
+	mdZ80_set_PC(z80, state->PC);
+	mdZ80_set_SP(z80, state->SP);
 
 	// Shadow register set.
-	mdZ80_set_AF2(ms_Z80, state->AF2);
-	mdZ80_set_BC2(ms_Z80, state->BC2);
-	mdZ80_set_DE2(ms_Z80, state->DE2);
-	mdZ80_set_HL2(ms_Z80, state->HL2);
+	mdZ80_set_AF2(z80, state->AF2);
+	mdZ80_set_BC2(z80, state->BC2);
+	mdZ80_set_DE2(z80, state->DE2);
+	mdZ80_set_HL2(z80, state->HL2);
 
 	// Other registers.
-	mdZ80_set_IFF(ms_Z80, state->IFF);
-	mdZ80_set_R(ms_Z80, state->R);
-	mdZ80_set_I(ms_Z80, state->I);
-	mdZ80_set_IM(ms_Z80, state->IM);
+	mdZ80_set_IFF(z80, state->IFF);
+	mdZ80_set_R(z80, state->R);
+	mdZ80_set_I(z80, state->I);
+	mdZ80_set_IM(z80, state->IM);
 
 	// TODO: Load WZ.
 
@@ -199,7 +217,7 @@ void Z80::ZomgRestoreReg(const Zomg_Z80RegSave_t *state)
 	uint8_t mdZ80_status = 0;
 	uint8_t IntLine = 0;
 	if (state->Status & ZOMG_Z80_STATUS_HALTED) {
-		mdZ80_status |= ZOMG_Z80_STATUS_HALTED;
+		mdZ80_status |= Z80_STATE_HALTED;
 	}
 	if (state->Status & ZOMG_Z80_STATUS_FAULTED) {
 		mdZ80_status |= Z80_STATE_FAULTED;
@@ -211,11 +229,11 @@ void Z80::ZomgRestoreReg(const Zomg_Z80RegSave_t *state)
 	if (state->Status & ZOMG_Z80_STATUS_NMI_PENDING) {
 		IntLine |= 0x80;
 	}
-	mdZ80_set_Status(ms_Z80, mdZ80_status);
-	mdZ80_set_IntLine(ms_Z80, IntLine);
+	mdZ80_set_Status(z80, mdZ80_status);
+	mdZ80_set_IntLine(z80, IntLine);
 
 	// Interrupt Vector. (IM 2)
-	mdZ80_set_IntVect(ms_Z80, state->IntVect);
+	mdZ80_set_IntVect(z80, state->IntVect);
 #endif /* GENS_ENABLE_EMULATION */
 }
 
@@ -28,6 +28,7 @@
 
 // mdZ80: Z80 CPU emulator.
 #include "../mdZ80/mdZ80.h"
+#include "../mdZ80/mdZ80_flags.h"
 
 // M68K_Mem is needed for Z80_State.
 #include "M68K_Mem.hpp"
@@ -35,6 +36,8 @@
 // ZOMG Z80 structs.
 #include "libzomg/zomg_z80.h"
 
+#include "macros/common.h"
+
 // C includes.
 #include <stdint.h>
 #include <stdio.h>
@@ -63,28 +66,76 @@ class Z80
 		static inline void SoftReset(void);
 		static inline void Exec(int cyclesSubtract);
 		static inline void Interrupt(uint8_t irq);
+		static inline unsigned int ReadOdometer(void);
+		static inline unsigned int ReadOdometerExec(void);
 		static inline void ClearOdometer(void);
 		static inline void SetOdometer(unsigned int odo);
+		static inline bool IsRunning(void);
 		/** END: mdZ80 wrapper functions. **/
 	
+		/**
+		 * Per-context Z80 state.
+		 * Each EmuContext has its own State.
+		 * The Z80 functions use the State bound to the calling thread.
+		 */
+		struct State {
+			mdZ80_context *z80;	// Allocated by Init().
+
+			// Deferred odometer value.
+			// While the Z80 can't run, Exec() only records the
+			// odometer here instead of calling into mdZ80.
+			// It's written to the Z80 context when needed.
+			unsigned int odoDeferred;
+			bool odoPending;
+
+			State() : z80(NULL), odoDeferred(0), odoPending(false) { }
+		};
+
+		/**
+		 * Bind a State to the calling thread.
+		 * @param state State, or nullptr for the default state.
+		 */
+		static void BindState(State *state);
+
 	protected:
-		static mdZ80_context *ms_Z80;
+		// Current state.
+		static THREAD_LOCAL State *ms_State;
 	
 	private:
 		Z80() { }
 		~Z80() { }
+
+		/**
+		 * Write the deferred odometer value to the Z80 context.
+		 */
+		static inline void SyncOdometer(void);
+
+		// Default state.
+		// Used if BindState() hasn't been called on this thread.
+		static State ms_DefaultState;
 };
 
 /** BEGIN: mdZ80 wrapper functions. **/
 
 #ifdef GENS_ENABLE_EMULATION
+/**
+ * Write the deferred odometer value to the Z80 context.
+ */
+inline void Z80::SyncOdometer(void)
+{
+	if (ms_State->odoPending) {
+		mdZ80_set_odo(ms_State->z80, ms_State->odoDeferred);
+		ms_State->odoPending = false;
+	}
+}
+
 /**
  * Reset the Z80. (Hard Reset)
  * This function should be called when resetting emulation.
  */
 inline void Z80::HardReset(void)
 {
-	mdZ80_hard_reset(ms_Z80);
+	mdZ80_hard_reset(ms_State->z80);
 }
 
 /**
@@ -93,7 +144,7 @@ inline void Z80::HardReset(void)
  */
 inline void Z80::SoftReset(void)
 {
-	mdZ80_soft_reset(ms_Z80);
+	mdZ80_soft_reset(ms_State->z80);
 }
 
 /**
@@ -102,14 +153,19 @@ inline void Z80::SoftReset(void)
  */
 inline void Z80::Exec(int cyclesSubtract)
 {
-	int cyclesToRun = (M68K_Mem::Cycles_Z80 - cyclesSubtract);
+	int cyclesToRun = (M68K_Mem::ms_State->Cycles_Z80 - cyclesSubtract);
 
 	// Only run the Z80 if it's enabled and it has the bus.
-	if (M68K_Mem::Z80_State == (Z80_STATE_ENABLED | Z80_STATE_BUSREQ)) {
-		z80_Exec(ms_Z80, cyclesToRun);
-	} else {
-		mdZ80_set_odo(ms_Z80, cyclesToRun);
+	if (M68K_Mem::ms_State->Z80_State != (Z80_STATE_ENABLED | Z80_STATE_BUSREQ)) {
+		// Z80 is in reset, or the 68000 has the bus.
+		// Defer the odometer update until the Z80 can run again.
+		ms_State->odoDeferred = cyclesToRun;
+		ms_State->odoPending = true;
+		return;
 	}
+
+	SyncOdometer();
+	z80_Exec(ms_State->z80, cyclesToRun);
 }
 
 /**
@@ -118,7 +174,29 @@ inline void Z80::Exec(int cyclesSubtract)
  */
 inline void Z80::Interrupt(uint8_t irq)
 {
-	mdZ80_interrupt(ms_Z80, irq);
+	mdZ80_interrupt(ms_State->z80, irq);
+}
+
+/**
+ * Read the odometer.
+ * @return Odometer value.
+ */
+inline unsigned int Z80::ReadOdometer(void)
+{
+	if (ms_State->odoPending)
+		return ms_State->odoDeferred;
+	return mdZ80_read_odo(ms_State->z80);
+}
+
+/**
+ * Read the odometer from within a Z80 memory handler.
+ * This includes the cycles executed so far in the current timeslice.
+ * NOTE: Only the portable Z80 core tracks the timeslice position.
+ * @return Odometer value at the start of the current instruction.
+ */
+inline unsigned int Z80::ReadOdometerExec(void)
+{
+	return mdZ80_read_odo_exec(ms_State->z80);
 }
 
 /**
@@ -126,7 +204,8 @@ inline void Z80::Interrupt(uint8_t irq)
  */
 inline void Z80::ClearOdometer(void)
 {
-	mdZ80_clear_odo(ms_Z80);
+	ms_State->odoPending = false;
+	mdZ80_clear_odo(ms_State->z80);
 }
 
 /**
@@ -135,17 +214,32 @@ inline void Z80::ClearOdometer(void)
  */
 inline void Z80::SetOdometer(unsigned int odo)
 {
-	mdZ80_set_odo(ms_Z80, odo);
+	ms_State->odoPending = false;
+	mdZ80_set_odo(ms_State->z80, odo);
+}
+
+/**
+ * Is the Z80 currently executing instructions?
+ * This is true when called from a Z80 memory handler.
+ * @return True if the Z80 is running.
+ */
+inline bool Z80::IsRunning(void)
+{
+	return !!(mdZ80_get_Status(ms_State->z80) & Z80_STATE_RUNNING);
 }
 
 #else /* !GENS_ENABLE_EMULATION */
 
+inline void Z80::SyncOdometer(void) { }
 inline void Z80::HardReset(void) { }
 inline void Z80::SoftReset(void) { }
 inline void Z80::Exec(int cyclesSubtract) { ((void)cyclesSubtract); }
 inline void Z80::Interrupt(uint8_t irq) { ((void)irq); }
+inline unsigned int Z80::ReadOdometer(void) { return 0; }
+inline unsigned int Z80::ReadOdometerExec(void) { return 0; }
 inline void Z80::ClearOdometer(void) { }
 inline void Z80::SetOdometer(unsigned int odo) { ((void)odo); }
+inline bool Z80::IsRunning(void) { return false; }
 
 #endif /* GENS_ENABLE_EMULATION */
 
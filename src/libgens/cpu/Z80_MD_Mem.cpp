@@ -29,10 +29,12 @@
 
 // LibGens includes.
 #include "M68K_Mem.hpp"
+#include "Z80.hpp"
 #include "Vdp/Vdp.hpp"
 
 // Sound Manager.
 #include "sound/SoundMgr.hpp"
+#include "Util/VgmLogger.hpp"
 
 // EmuContext
 #include "EmuContext/EmuContext.hpp"
@@ -55,8 +57,29 @@ uint8_t Ram_Z80[8 * 1024];
 namespace LibGens
 {
 
-// Static class variables.
-int Z80_MD_Mem::Bank_Z80;
+/**
+ * Initialize a Z80 memory state.
+ * The default state uses the global Ram_Z80.
+ */
+Z80_MD_Mem::State::State()
+	: ram(&Ram_Z80[0])
+	, Bank_Z80(0)
+{ }
+
+// Default state.
+Z80_MD_Mem::State Z80_MD_Mem::ms_DefaultState;
+
+// Current state.
+THREAD_LOCAL Z80_MD_Mem::State *Z80_MD_Mem::ms_State = &Z80_MD_Mem::ms_DefaultState;
+
+/**
+ * Bind a State to the calling thread.
+ * @param state State, or nullptr for the default state.
+ */
+void Z80_MD_Mem::BindState(State *state)
+{
+	ms_State = (state ? state : &ms_DefaultState);
+}
 
 void Z80_MD_Mem::Init(void)
 {
@@ -83,11 +106,11 @@ inline uint8_t Z80_MD_Mem::Z80_ReadB_YM2612(uint32_t address)
 	
 	// The YM2612's RESET line is tied to the Z80's RESET line.
 	// TODO: Determine the correct return value.
-	if (M68K_Mem::Z80_State & Z80_STATE_RESET)
+	if (M68K_Mem::ms_State->Z80_State & Z80_STATE_RESET)
 		return 0xFF;
 	
 	// Return the YM2612 status register.
-	return SoundMgr::ms_Ym2612.read();
+	return SoundMgr::ms_State->ym2612.read();
 }
 
 /**
@@ -171,11 +194,11 @@ inline uint8_t Z80_MD_Mem::Z80_ReadB_68K_Rom(uint32_t address)
 	// Z80 cannot read from M68K RAM.
 	// If this is attempted, 0xFF will be returned.
 	// Reference: http://gendev.spritesmind.net/forum/viewtopic.php?t=985
-	if (Bank_Z80 >= 0xE00000)
+	if (ms_State->Bank_Z80 >= 0xE00000)
 		return 0xFF;
 	
 	address &= 0x7FFF;
-	address |= Bank_Z80;
+	address |= ms_State->Bank_Z80;
 	return M68K_Mem::M68K_RB(address);
 }
 
@@ -193,9 +216,35 @@ inline void Z80_MD_Mem::Z80_WriteB_Bank(uint32_t address, uint8_t data)
 		return;
 	}
 
-	uint32_t bank_address = ((Bank_Z80 & 0xFF0000) >> 1);
+	uint32_t bank_address = ((ms_State->Bank_Z80 & 0xFF0000) >> 1);
 	bank_address |= ((data & 1) << 23);
-	Bank_Z80 = bank_address;
+	ms_State->Bank_Z80 = bank_address;
+}
+
+/**
+ * Get the timestamp for a sound chip write, for VGM logging.
+ * Writes from the Z80 are timestamped at the current Z80
+ * instruction. (Assembly core: start of the Z80 timeslice.)
+ * @return 68000 cycles since the start of the frame.
+ */
+static inline unsigned int SoundWriteCycle(void)
+{
+	if (Z80::IsRunning()) {
+		// Write from the Z80.
+#ifdef USE_PORTABLE_Z80
+		// Convert the current Z80 cycle to 68000 cycles.
+		return ((Z80::ReadOdometerExec() * 15) / 7);
+#else /* !USE_PORTABLE_Z80 */
+		// The assembly core doesn't export its position
+		// within the timeslice, so use the start of the
+		// timeslice instead.
+		const M68K_Mem::State *const st = M68K_Mem::ms_State;
+		return (((st->Cycles_Z80 - st->CPL_Z80) * 15) / 7);
+#endif /* USE_PORTABLE_Z80 */
+	}
+
+	// Write from the 68000 via the Z80 bus.
+	return M68K::ReadOdometer();
 }
 
 /**
@@ -206,11 +255,15 @@ inline void Z80_MD_Mem::Z80_WriteB_Bank(uint32_t address, uint8_t data)
 inline void Z80_MD_Mem::Z80_WriteB_YM2612(uint32_t address, uint8_t data)
 {
 	// The YM2612's RESET line is tied to the Z80's RESET line.
-	if (M68K_Mem::Z80_State & Z80_STATE_RESET)
+	if (M68K_Mem::ms_State->Z80_State & Z80_STATE_RESET)
 		return;
 	
 	// Write to the YM2612.
-	SoundMgr::ms_Ym2612.write(address & 0x03, data);
+	SoundMgr::State *const snd = SoundMgr::ms_State;
+	snd->ym2612.write(address & 0x03, data);
+	if (snd->vgmLogger) {
+		snd->vgmLogger->logYm2612(address & 0x03, data, SoundWriteCycle());
+	}
 }
 
 /**
@@ -244,7 +297,11 @@ inline void Z80_MD_Mem::Z80_WriteB_VDP(uint32_t address, uint8_t data)
 		case 0x10: case 0x14:
 			// PSG control port. (Odd addresses only)
 			if (address & 1) {
-				SoundMgr::ms_Psg.write(data);
+				SoundMgr::State *const snd = SoundMgr::ms_State;
+				snd->psg.write(data);
+				if (snd->vgmLogger) {
+					snd->vgmLogger->logPsg(data, SoundWriteCycle());
+				}
 			}
 			break;
 		case 0x18:
@@ -274,7 +331,7 @@ inline void Z80_MD_Mem::Z80_WriteB_68K_Rom(uint32_t address, uint8_t data)
 	// Reference: http://gendev.spritesmind.net/forum/viewtopic.php?t=985
 	
 	address &= 0x7FFF;
-	address |= Bank_Z80;
+	address |= ms_State->Bank_Z80;
 	M68K_Mem::M68K_WB(address, data);
 }
 
@@ -293,7 +350,7 @@ uint8_t Z80_MD_Mem::Z80_ReadB(uint32_t address)
 		case 0x02: case 0x03:
 			// 0x0000-0x1FFF: Z80 RAM.
 			// 0x2000-0x3FFF: Z80 RAM. (mirror)
-			return Ram_Z80[address & 0x1FFF];
+			return ms_State->ram[address & 0x1FFF];
 
 		case 0x04: case 0x05:
 			// 0x4000-0x5FFF: YM2612.
@@ -331,7 +388,7 @@ void Z80_MD_Mem::Z80_WriteB(uint32_t address, uint8_t data)
 		case 0x02: case 0x03:
 			// 0x0000-0x1FFF: Z80 RAM.
 			// 0x2000-0x3FFF: Z80 RAM. (mirror)
-			Ram_Z80[address & 0x1FFF] = data;
+			ms_State->ram[address & 0x1FFF] = data;
 			break;
 
 		case 0x04: case 0x05:
@@ -28,6 +28,7 @@
 
 // NOTE: mdZ80 uses the FASTCALL calling convention.
 #include "macros/fastcall.h"
+#include "macros/common.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +36,7 @@ extern "C" {
 
 // TODO: mdZ80 accesses Ram_Z80 directly.
 // Move Ram_Z80 back to Z80_MD_Mem once mdZ80 is updated.
+// NOTE: This is the default state's RAM. Use Z80_MD_Mem::ms_State->ram.
 extern uint8_t Ram_Z80[8 * 1024];
 
 #ifdef __cplusplus
@@ -56,8 +58,31 @@ class Z80_MD_Mem
 		static uint8_t Ram_Z80[8 * 1024];
 #endif
 		
-		// M68K ROM banking address.
-		static int Bank_Z80;
+		/**
+		 * Per-context Z80 memory state.
+		 * Each EmuContext has its own State.
+		 * The Z80_MD_Mem functions use the State bound to the calling thread.
+		 */
+		struct State {
+			// Z80 RAM. (8 KB)
+			// NOTE: The mdZ80 assembly core accesses the global Ram_Z80
+			// directly, so this must point to Ram_Z80 if it's used.
+			uint8_t *ram;
+
+			// M68K ROM banking address.
+			int Bank_Z80;
+
+			State();
+		};
+
+		/**
+		 * Bind a State to the calling thread.
+		 * @param state State, or nullptr for the default state.
+		 */
+		static void BindState(State *state);
+
+		// Current state.
+		static THREAD_LOCAL State *ms_State;
 
 		/** Public read/write functions. **/
 		// TODO: Make these inline!
@@ -79,6 +104,10 @@ class Z80_MD_Mem
 		static void Z80_WriteB_YM2612(uint32_t address, uint8_t data);
 		static void Z80_WriteB_VDP(uint32_t address, uint8_t data);
 		static void Z80_WriteB_68K_Rom(uint32_t address, uint8_t data);
+
+		// Default state.
+		// Used if BindState() hasn't been called on this thread.
+		static State ms_DefaultState;
 };
 
 }
@@ -9,15 +9,18 @@
 #ifndef __STARCPU_H__
 #define __STARCPU_H__
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* Remember to byte-swap these regions. (read STARDOC.TXT for details) */
+/* NOTE: offset is a host pointer; uintptr_t is 32-bit on i386. */
 struct STARSCREAM_PROGRAMREGION {
 	unsigned lowaddr;
 	unsigned highaddr;
-	unsigned offset;
+	uintptr_t offset;
 };
 
 struct STARSCREAM_DATAREGION {
@@ -79,6 +79,22 @@
 #endif
 #endif /* RESTRICT */
 
+/**
+ * THREAD_LOCAL: Thread-local storage.
+ * Only use this for POD types. (e.g. pointers)
+ */
+#ifndef THREAD_LOCAL
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#define THREAD_LOCAL thread_local
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+#endif /* THREAD_LOCAL */
+
 /** Typedefs. **/
 
 /** Miscellaneous. **/
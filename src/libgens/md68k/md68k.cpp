@@ -0,0 +1,592 @@
+/***************************************************************************
+ * md68k: Portable 68000 CPU emulator.                                     *
+ * md68k.cpp: Starscream-compatible API and main execution loop.           *
+ *                                                                         *
+ * Copyright (c) 2008-2015 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "md68k_p.hpp"
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+namespace Md68k {
+
+// Default CPU instance.
+// Used if main68k_bindState() hasn't been called on this thread.
+static Cpu defaultCpu;
+
+// Current CPU instance.
+THREAD_LOCAL Cpu *cpu = &defaultCpu;
+
+/** Page tables. **/
+
+/**
+ * Build the fetch page table.
+ * @param pages Page table.
+ * @param regions Program region array.
+ */
+static void build_fetch_pages(const uint8_t **pages, const STARSCREAM_PROGRAMREGION *regions)
+{
+	for (uint32_t page = 0; page < 256; page++) {
+		pages[page] = nullptr;
+		if (!regions)
+			continue;
+
+		// The first region that overlaps this page is used.
+		// If it doesn't cover the entire page, the slow path
+		// will scan the region array.
+		const uint32_t lo = (page << 16);
+		const uint32_t hi = (lo | 0xFFFF);
+		for (const STARSCREAM_PROGRAMREGION *r = regions; r->lowaddr != ~0U; r++) {
+			if (r->highaddr < lo || r->lowaddr > hi)
+				continue;
+			if (r->lowaddr <= lo && r->highaddr >= hi)
+				pages[page] = (const uint8_t*)(r->offset + lo);
+			break;
+		}
+	}
+}
+
+/**
+ * Build a data page table.
+ * @param pages Page table.
+ * @param regions Data region array.
+ */
+static void build_data_pages(DataPage *pages, const STARSCREAM_DATAREGION *regions)
+{
+	for (uint32_t page = 0; page < 256; page++) {
+		pages[page].base = nullptr;
+		pages[page].handler = nullptr;
+		if (!regions)
+			continue;
+
+		const uint32_t lo = (page << 16);
+		const uint32_t hi = (lo | 0xFFFF);
+		for (const STARSCREAM_DATAREGION *r = regions; r->lowaddr != ~0U; r++) {
+			if (r->highaddr < lo || r->lowaddr > hi)
+				continue;
+			if (r->lowaddr <= lo && r->highaddr >= hi) {
+				if (r->memorycall) {
+					pages[page].handler = r->memorycall;
+				} else if (r->userdata) {
+					pages[page].base = ((uint8_t*)r->userdata + (lo - r->lowaddr));
+				}
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * Find the data region containing an address.
+ * @param r Data region array.
+ * @param address Address.
+ * @return Data region, or nullptr if the address isn't mapped.
+ */
+static inline const STARSCREAM_DATAREGION *find_data_region(
+	const STARSCREAM_DATAREGION *r, uint32_t address)
+{
+	if (!r)
+		return nullptr;
+	for (; r->lowaddr != ~0U; r++) {
+		if (address >= r->lowaddr && address <= r->highaddr)
+			return r;
+	}
+	return nullptr;
+}
+
+/** Slow paths. **/
+
+uint16_t fetch16_slow(Cpu *c, uint32_t address)
+{
+	const STARSCREAM_PROGRAMREGION *r = c->ctx.fetch;
+	if (r) {
+		for (; r->lowaddr != ~0U; r++) {
+			if (address >= r->lowaddr && address <= r->highaddr)
+				return *(const uint16_t*)(r->offset + address);
+		}
+	}
+
+	// Not in a program region. Use the data read path.
+	return read16(c, address);
+}
+
+uint8_t read8_slow(Cpu *c, uint32_t address)
+{
+	const DataPage *page = &c->readbyte[address >> 16];
+	if (page->handler)
+		return ((ReadByteFn)page->handler)(address);
+
+	const STARSCREAM_DATAREGION *r = find_data_region(c->ctx.readbyte, address);
+	if (r) {
+		if (r->memorycall)
+			return ((ReadByteFn)r->memorycall)(address);
+		if (r->userdata)
+			return ((const uint8_t*)r->userdata)[(address - r->lowaddr) ^ U16DATA_U8_INVERT];
+	}
+	return 0xFF;
+}
+
+uint16_t read16_slow(Cpu *c, uint32_t address)
+{
+	const DataPage *page = &c->readword[address >> 16];
+	if (page->handler)
+		return ((ReadWordFn)page->handler)(address);
+
+	const STARSCREAM_DATAREGION *r = find_data_region(c->ctx.readword, address);
+	if (r) {
+		if (r->memorycall)
+			return ((ReadWordFn)r->memorycall)(address);
+		if (r->userdata)
+			return *(const uint16_t*)((const uint8_t*)r->userdata + (address - r->lowaddr));
+	}
+	return 0xFFFF;
+}
+
+void write8_slow(Cpu *c, uint32_t address, uint8_t data)
+{
+	const DataPage *page = &c->writebyte[address >> 16];
+	if (page->handler) {
+		((WriteByteFn)page->handler)(address, data);
+		return;
+	}
+
+	const STARSCREAM_DATAREGION *r = find_data_region(c->ctx.writebyte, address);
+	if (r) {
+		if (r->memorycall)
+			((WriteByteFn)r->memorycall)(address, data);
+		else if (r->userdata)
+			((uint8_t*)r->userdata)[(address - r->lowaddr) ^ U16DATA_U8_INVERT] = data;
+	}
+}
+
+void write16_slow(Cpu *c, uint32_t address, uint16_t data)
+{
+	const DataPage *page = &c->writeword[address >> 16];
+	if (page->handler) {
+		((WriteWordFn)page->handler)(address, data);
+		return;
+	}
+
+	const STARSCREAM_DATAREGION *r = find_data_region(c->ctx.writeword, address);
+	if (r) {
+		if (r->memorycall)
+			((WriteWordFn)r->memorycall)(address, data);
+		else if (r->userdata)
+			*(uint16_t*)((uint8_t*)r->userdata + (address - r->lowaddr)) = data;
+	}
+}
+
+/** Context synchronization. **/
+
+/**
+ * Load the registers from the Starscream context.
+ * @param c CPU.
+ */
+static void load_context(Cpu *c)
+{
+	for (int i = 0; i < 8; i++) {
+		c->r[i] = c->ctx.dreg[i];
+		c->r[i+8] = c->ctx.areg[i];
+	}
+	c->asp = c->ctx.asp;
+	c->pc = c->ctx.pc;
+	c->sr_sys = (c->ctx.sr & (MD68K_SR_MASK & 0xFF00));
+	set_ccr(c, c->ctx.sr);
+}
+
+/**
+ * Save the registers to the Starscream context.
+ * @param c CPU.
+ */
+static void store_context(Cpu *c)
+{
+	for (int i = 0; i < 8; i++) {
+		c->ctx.dreg[i] = c->r[i];
+		c->ctx.areg[i] = c->r[i+8];
+	}
+	c->ctx.asp = c->asp;
+	c->ctx.pc = (c->pc & 0xFFFFFF);
+	c->ctx.sr = get_sr(c);
+}
+
+/**
+ * Get the current value of SR.
+ * @return SR.
+ */
+static inline uint16_t current_sr(void)
+{
+	return (cpu->running ? get_sr(cpu) : cpu->ctx.sr);
+}
+
+/** Exceptions. **/
+
+/**
+ * Process an exception.
+ * @param c CPU.
+ * @param vector Exception vector number.
+ * @param cycles Number of cycles taken by the exception.
+ */
+void exception(Cpu *c, int vector, int cycles)
+{
+	const uint16_t sr = get_sr(c);
+	set_sr(c, (sr | MD68K_SR_S) & ~MD68K_SR_T);
+	c->r[15] -= 4;
+	write32(c, c->r[15], c->pc);
+	c->r[15] -= 2;
+	write16(c, c->r[15], sr);
+	c->pc = read32(c, vector << 2);
+	c->cycles -= cycles;
+}
+
+/**
+ * Process a pending interrupt, if it isn't masked.
+ * @param c CPU.
+ */
+void check_interrupts(Cpu *c)
+{
+	const unsigned int level = (c->ctx.interrupts[0] & MD68K_INT_LEVEL);
+	if (level == 0)
+		return;
+	if (level != 7 && level <= ((c->sr_sys >> 8) & 7))
+		return;
+
+	exception(c, VEC_AUTOVECTOR + level, 44);
+	c->sr_sys = ((c->sr_sys & ~MD68K_SR_IPL) | (level << 8));
+
+	// Acknowledge the interrupt.
+	// This also clears the STOPPED bit.
+	c->ctx.interrupts[0] = VDP_Int_Ack();
+}
+
+}
+
+using namespace Md68k;
+
+extern "C" {
+
+/**
+ * Rebuild the program and data page tables from the
+ * region arrays in the current context.
+ */
+void main68k_updateRegions(void)
+{
+	build_fetch_pages(cpu->fetch, cpu->ctx.fetch);
+	build_data_pages(cpu->readbyte, cpu->ctx.readbyte);
+	build_data_pages(cpu->readword, cpu->ctx.readword);
+	build_data_pages(cpu->writebyte, cpu->ctx.writebyte);
+	build_data_pages(cpu->writeword, cpu->ctx.writeword);
+
+	// Code may have been banked in or out.
+	memset(cpu->idle_reject, 0, sizeof(cpu->idle_reject));
+}
+
+/**
+ * Initialize the 68000 emulator.
+ * @return 0 on success.
+ */
+int main68k_init(void)
+{
+	static bool opTableBuilt = false;
+	if (!opTableBuilt) {
+		BuildOpTable();
+		opTableBuilt = true;
+	}
+
+	cpu->running = false;
+	cpu->cycles = 0;
+	cpu->cycles_target = 0;
+	main68k_updateRegions();
+	return 0;
+}
+
+/**
+ * Reset the 68000.
+ * @return 0 on success; 1 if the CPU is running or has no program map; -1 on double fault.
+ */
+unsigned main68k_reset(void)
+{
+	if (cpu->running || !cpu->ctx.s_fetch)
+		return 1;
+
+	memset(cpu->ctx.dreg, 0, sizeof(cpu->ctx.dreg));
+	memset(cpu->ctx.areg, 0, sizeof(cpu->ctx.areg));
+	cpu->ctx.asp = 0;
+	cpu->ctx.sr = 0x2700;
+
+	// Use the supervisor address space.
+	cpu->ctx.fetch = cpu->ctx.s_fetch;
+	cpu->ctx.readbyte = cpu->ctx.s_readbyte;
+	cpu->ctx.readword = cpu->ctx.s_readword;
+	cpu->ctx.writebyte = cpu->ctx.s_writebyte;
+	cpu->ctx.writeword = cpu->ctx.s_writeword;
+	main68k_updateRegions();
+
+	// Load the initial SSP and PC.
+	cpu->ctx.areg[7] = ((main68k_fetch(0) & 0xFFFF) << 16) | (main68k_fetch(2) & 0xFFFF);
+	cpu->ctx.pc = ((main68k_fetch(4) & 0xFFFF) << 16) | (main68k_fetch(6) & 0xFFFF);
+	cpu->ctx.interrupts[0] = 0;
+
+	// An odd initial PC is a double fault.
+	return -(cpu->ctx.pc & 1);
+}
+
+/**
+ * Run the 68000 until the odometer reaches the specified value.
+ * @param n Odometer value to run to.
+ * @return 0x80000000 on success; 0x80000003 if already executed; 0x80000004 if stopped; -1 on double fault.
+ */
+unsigned main68k_exec(int n)
+{
+	Cpu *const c = cpu;
+	const int cycles = n - (int)c->ctx.odometer;
+	if (cycles <= 0)
+		return 0x80000003;
+
+	if (c->ctx.interrupts[0] & MD68K_INT_STOPPED) {
+		if (c->ctx.pc & 1)
+			return ~0U;
+		c->ctx.odometer += cycles;
+		return 0x80000004;
+	}
+
+	load_context(c);
+	c->cycles = cycles;
+	c->cycles_target = cycles;
+	c->running = true;
+
+	check_interrupts(c);
+	while (c->cycles > 0) {
+		if (c->ctx.interrupts[0] & MD68K_INT_LEVEL)
+			check_interrupts(c);
+
+		const uint32_t trace = (c->sr_sys & MD68K_SR_T);
+		const uint32_t op = fetch16(c);
+		OpTable[op](c, op);
+		if (trace)
+			exception(c, VEC_TRACE, 34);
+	}
+
+	c->ctx.odometer += (c->cycles_target - c->cycles);
+	c->running = false;
+	store_context(c);
+	return 0x80000000;
+}
+
+/**
+ * Raise an interrupt.
+ * Only autovectored interrupts are supported.
+ * @param level Interrupt level.
+ * @param vector Vector number. (ignored)
+ * @return 0 on success; 2 on invalid input.
+ */
+int main68k_interrupt(int level, int vector)
+{
+	((void)vector);
+	if (level < 1 || level > 7)
+		return 2;
+
+	// HACK by David Korth. (2010/01/31)
+	// If the CPU is stopped and the interrupt is masked,
+	// don't do anything.
+	if ((cpu->ctx.interrupts[0] & MD68K_INT_STOPPED) &&
+	    level != 7 && level <= ((current_sr() >> 8) & 7))
+	{
+		return 0;
+	}
+
+	// Commit the interrupt.
+	// If the CPU is running, it will be processed
+	// before the next instruction.
+	cpu->ctx.interrupts[0] = (unsigned char)level;
+	return 0;
+}
+
+/**
+ * Process pending interrupts.
+ * Ignored if the CPU is running.
+ */
+void main68k_flushInterrupts(void)
+{
+	if (cpu->running)
+		return;
+
+	load_context(cpu);
+	cpu->cycles = 0;
+	check_interrupts(cpu);
+	cpu->ctx.odometer -= cpu->cycles;
+	store_context(cpu);
+}
+
+int main68k_GetContextSize(void)
+{
+	return (int)sizeof(cpu->ctx);
+}
+
+void main68k_GetContext(void *context)
+{
+	if (cpu->running)
+		store_context(cpu);
+	memcpy(context, &cpu->ctx, sizeof(cpu->ctx));
+}
+
+void main68k_SetContext(void *context)
+{
+	memcpy(&cpu->ctx, context, sizeof(cpu->ctx));
+	if (cpu->running)
+		load_context(cpu);
+	main68k_updateRegions();
+}
+
+/**
+ * Read a word using the supervisor program map.
+ * @param address Address.
+ * @return Word, or -1 if the address isn't mapped.
+ */
+int main68k_fetch(unsigned address)
+{
+	address &= 0xFFFFFE;
+	const STARSCREAM_PROGRAMREGION *r = cpu->ctx.s_fetch;
+	if (!r)
+		return -1;
+	for (; r->lowaddr != ~0U; r++) {
+		if (address >= r->lowaddr && address <= r->highaddr)
+			return *(const uint16_t*)(r->offset + address);
+	}
+	return -1;
+}
+
+unsigned main68k_readOdometer(void)
+{
+	if (cpu->running)
+		return cpu->ctx.odometer + (cpu->cycles_target - cpu->cycles);
+	return cpu->ctx.odometer;
+}
+
+unsigned main68k_tripOdometer(void)
+{
+	const unsigned odo = main68k_readOdometer();
+	cpu->ctx.odometer -= odo;
+	return odo;
+}
+
+unsigned main68k_controlOdometer(int n)
+{
+	return (n ? main68k_tripOdometer() : main68k_readOdometer());
+}
+
+/**
+ * End the current timeslice prematurely.
+ * The early exit is reflected in the odometer.
+ */
+void main68k_releaseTimeslice(void)
+{
+	if (!cpu->running)
+		return;
+	cpu->cycles_target -= cpu->cycles;
+	cpu->cycles = 0;
+}
+
+/**
+ * Consume cycles. (used for DMA)
+ * @param cycles Number of cycles.
+ */
+void main68k_releaseCycles(int cycles)
+{
+	if (cpu->running)
+		cpu->cycles -= cycles;
+	else
+		cpu->ctx.odometer += cycles;
+}
+
+/**
+ * Add cycles to the odometer.
+ * @param cycles Number of cycles.
+ */
+void main68k_addCycles(int cycles)
+{
+	cpu->ctx.odometer += cycles;
+}
+
+unsigned main68k_readPC(void)
+{
+	if (cpu->running)
+		return (cpu->pc & 0xFFFFFF);
+	return cpu->ctx.pc;
+}
+
+/**
+ * Clear the pending interrupt level.
+ * The STOPPED bit is not modified.
+ */
+void main68k_clearInterrupts(void)
+{
+	cpu->ctx.interrupts[0] &= 0xF0;
+}
+
+/**
+ * Enable or disable idle loop detection.
+ * @param enable Non-zero to enable; zero to disable.
+ */
+void main68k_setIdleLoopDetect(int enable)
+{
+	cpu->idle_detect = !!enable;
+	memset(cpu->idle_reject, 0, sizeof(cpu->idle_reject));
+}
+
+/** Per-instance state. **/
+
+/**
+ * Allocate a new CPU state.
+ * The state is zeroed and has no program or data regions.
+ * @return CPU state.
+ */
+md68k_state *main68k_newState(void)
+{
+	Cpu *c = new Cpu;
+	memset(c, 0, sizeof(*c));
+	return (md68k_state*)c;
+}
+
+/**
+ * Free a CPU state.
+ * If the state is bound to the calling thread,
+ * the default state is bound instead.
+ * @param state CPU state.
+ */
+void main68k_freeState(md68k_state *state)
+{
+	if (!state)
+		return;
+	if (cpu == (Cpu*)state)
+		cpu = &defaultCpu;
+	delete (Cpu*)state;
+}
+
+/**
+ * Bind a CPU state to the calling thread.
+ * All main68k_*() functions called from this thread
+ * will use the specified state.
+ * @param state CPU state, or nullptr to use the default state.
+ */
+void main68k_bindState(md68k_state *state)
+{
+	cpu = (state ? (Cpu*)state : &defaultCpu);
+}
+
+}
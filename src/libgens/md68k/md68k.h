@@ -0,0 +1,118 @@
+/***************************************************************************
+ * md68k: Portable 68000 CPU emulator.                                     *
+ * md68k.h: Public API. (Starscream-compatible)                            *
+ *                                                                         *
+ * Copyright (c) 2008-2015 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __MD68K_H__
+#define __MD68K_H__
+
+/**
+ * md68k implements the main68k_* subset of the Starscream API
+ * declared in star_68k.h, so the M68K class can use either core.
+ *
+ * Differences from Starscream:
+ * - Program and data regions are converted to 64 KB page tables
+ *   when the context is loaded. If the region arrays are modified
+ *   (e.g. bankswitching), main68k_updateRegions() must be called.
+ * - Data region handlers use the following prototypes:
+ *   - readbyte:  uint8_t  handler(uint32_t address);
+ *   - readword:  uint16_t handler(uint32_t address);
+ *   - writebyte: void     handler(uint32_t address, uint8_t data);
+ *   - writeword: void     handler(uint32_t address, uint16_t data);
+ * - Program region offsets are host pointers, so they're
+ *   stored in uintptr_t. (Starscream is 32-bit only.)
+ * - Interrupts always use autovectors.
+ * - Address errors are not emulated. Word and long accesses
+ *   to odd addresses are aligned to the previous word.
+ */
+
+#include "../cpu/star_68k.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Rebuild the program and data page tables from the
+ * region arrays in the current context.
+ * This must be called after modifying any region array.
+ */
+void main68k_updateRegions(void);
+
+/**
+ * Clear the pending interrupt level.
+ * The STOPPED bit is not modified.
+ */
+void main68k_clearInterrupts(void);
+
+/**
+ * Enable or disable idle loop detection.
+ * If enabled, a short backward branch that closes a loop with
+ * no side effects (e.g. polling a RAM flag or the VDP status)
+ * ends the current timeslice, since every remaining iteration
+ * would have the same result.
+ * @param enable Non-zero to enable; zero to disable.
+ */
+void main68k_setIdleLoopDetect(int enable);
+
+/**
+ * Per-instance CPU state.
+ * Each state has its own registers, odometer, and page tables.
+ * The main68k_*() functions operate on the state bound to
+ * the calling thread; if no state has been bound, a default
+ * state is used. (Starscream only has a single global context.)
+ */
+typedef struct _md68k_state md68k_state;
+
+/**
+ * Allocate a new CPU state.
+ * The state is zeroed and has no program or data regions.
+ * @return CPU state.
+ */
+md68k_state *main68k_newState(void);
+
+/**
+ * Free a CPU state.
+ * If the state is bound to the calling thread,
+ * the default state is bound instead.
+ * @param state CPU state.
+ */
+void main68k_freeState(md68k_state *state);
+
+/**
+ * Bind a CPU state to the calling thread.
+ * All main68k_*() functions called from this thread
+ * will use the specified state.
+ * @param state CPU state, or NULL to use the default state.
+ */
+void main68k_bindState(md68k_state *state);
+
+/**
+ * Interrupt acknowledge callback.
+ * Called when the 68000 accepts an interrupt.
+ * Implemented by the host system. (VdpIo.cpp on MD)
+ * @return New interrupt level.
+ */
+uint8_t VDP_Int_Ack(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MD68K_H__ */
@@ -0,0 +1,2235 @@
+/***************************************************************************
+ * md68k: Portable 68000 CPU emulator.                                     *
+ * md68k_ops.cpp: Instruction handlers and opcode table.                   *
+ *                                                                         *
+ * Copyright (c) 2008-2015 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * Each opcode is mapped to a handler in OpTable[], which is built once by
+ * BuildOpTable(). Handlers are templated on operand size and operation;
+ * the effective address fields are decoded by the handler.
+ *
+ * Cycle counts are from the MC68000 User's Manual.
+ * Address errors are not emulated.
+ */
+
+#include "md68k_p.hpp"
+
+namespace Md68k {
+
+OpFn OpTable[0x10000];
+
+/** Operand sizes. **/
+
+#define SZ_MASK(sz)	((sz) == 1 ? 0xFFU : ((sz) == 2 ? 0xFFFFU : 0xFFFFFFFFU))
+#define SZ_BITS(sz)	((sz) * 8)
+
+template<int SZ>
+static inline uint32_t sext(uint32_t v)
+{
+	if (SZ == 1)
+		return (uint32_t)(int32_t)(int8_t)v;
+	else if (SZ == 2)
+		return (uint32_t)(int32_t)(int16_t)v;
+	return v;
+}
+
+template<int SZ>
+static inline uint32_t msb(uint32_t v)
+{
+	return ((v >> (SZ_BITS(SZ) - 1)) & 1);
+}
+
+/** Effective addresses. **/
+
+enum EaMode {
+	EA_DN, EA_AN, EA_AI, EA_PI, EA_PD, EA_DI, EA_IX,
+	EA_AW, EA_AL, EA_PCDI, EA_PCIX, EA_IMM,
+	EA_INVALID
+};
+
+/**
+ * Decode an effective address mode.
+ * @param mode Mode field.
+ * @param reg Register field.
+ * @return EaMode.
+ */
+static inline int ea_mode(uint32_t mode, uint32_t reg)
+{
+	if (mode < 7)
+		return mode;
+	return (reg <= 4 ? (int)(EA_AW + reg) : EA_INVALID);
+}
+
+#define EA_SRC(op)	ea_mode(((op) >> 3) & 7, (op) & 7)
+
+// Effective address calculation time.
+static const uint8_t ea_cycles_bw[12] = {0, 0, 4, 4, 6, 8, 10, 8, 12, 8, 10, 4};
+static const uint8_t ea_cycles_l[12]  = {0, 0, 8, 8, 10, 12, 14, 12, 16, 12, 14, 8};
+
+template<int SZ>
+static inline int ea_cycles(int m)
+{
+	return (SZ == 4 ? ea_cycles_l[m] : ea_cycles_bw[m]);
+}
+
+/**
+ * Calculate an indexed address. (d8,An,Xn) or (d8,PC,Xn)
+ * @param c CPU.
+ * @param base Base address.
+ * @return Address.
+ */
+static inline uint32_t ea_indexed(Cpu *c, uint32_t base)
+{
+	const uint32_t ext = fetch16(c);
+	uint32_t idx = c->r[(ext >> 12) & 15];
+	if (!(ext & 0x800))
+		idx = sext<2>(idx);
+	return base + idx + sext<1>(ext);
+}
+
+/**
+ * Calculate a memory effective address.
+ * Postincrement and predecrement are applied here.
+ * @param c CPU.
+ * @param m EaMode.
+ * @param reg Register number.
+ * @return Address.
+ */
+template<int SZ>
+static inline uint32_t ea_addr(Cpu *c, int m, int reg)
+{
+	// Byte accesses using A7 keep the stack word-aligned.
+	const uint32_t step = ((SZ == 1 && reg == 7) ? 2 : SZ);
+	uint32_t address;
+
+	switch (m) {
+		case EA_AI:
+			return c->r[8+reg];
+		case EA_PI:
+			address = c->r[8+reg];
+			c->r[8+reg] += step;
+			return address;
+		case EA_PD:
+			c->r[8+reg] -= step;
+			return c->r[8+reg];
+		case EA_DI:
+			address = c->r[8+reg];
+			return address + sext<2>(fetch16(c));
+		case EA_IX:
+			return ea_indexed(c, c->r[8+reg]);
+		case EA_AW:
+			return sext<2>(fetch16(c));
+		case EA_AL:
+			return fetch32(c);
+		case EA_PCDI:
+			address = c->pc;
+			return address + sext<2>(fetch16(c));
+		case EA_PCIX:
+			return ea_indexed(c, c->pc);
+		default:
+			return 0;
+	}
+}
+
+template<int SZ>
+static inline uint32_t rd(Cpu *c, uint32_t address)
+{
+	if (SZ == 1)
+		return read8(c, address);
+	else if (SZ == 2)
+		return read16(c, address);
+	return read32(c, address);
+}
+
+template<int SZ>
+static inline void wr(Cpu *c, uint32_t address, uint32_t data)
+{
+	if (SZ == 1)
+		write8(c, address, (uint8_t)data);
+	else if (SZ == 2)
+		write16(c, address, (uint16_t)data);
+	else
+		write32(c, address, data);
+}
+
+template<int SZ>
+static inline uint32_t imm(Cpu *c)
+{
+	if (SZ == 1)
+		return (fetch16(c) & 0xFF);
+	else if (SZ == 2)
+		return fetch16(c);
+	return fetch32(c);
+}
+
+template<int SZ>
+static inline void set_dreg(Cpu *c, int reg, uint32_t v)
+{
+	c->r[reg] = (c->r[reg] & ~SZ_MASK(SZ)) | (v & SZ_MASK(SZ));
+}
+
+/**
+ * Read an operand.
+ * @param c CPU.
+ * @param m EaMode.
+ * @param reg Register number.
+ * @return Operand.
+ */
+template<int SZ>
+static inline uint32_t ea_read(Cpu *c, int m, int reg)
+{
+	switch (m) {
+		case EA_DN:
+			return (c->r[reg] & SZ_MASK(SZ));
+		case EA_AN:
+			return (c->r[8+reg] & SZ_MASK(SZ));
+		case EA_IMM:
+			return imm<SZ>(c);
+		default:
+			return rd<SZ>(c, ea_addr<SZ>(c, m, reg));
+	}
+}
+
+/**
+ * Write an operand. (data alterable modes)
+ * @param c CPU.
+ * @param m EaMode.
+ * @param reg Register number.
+ * @param v Value.
+ */
+template<int SZ>
+static inline void ea_write(Cpu *c, int m, int reg, uint32_t v)
+{
+	if (m == EA_DN)
+		set_dreg<SZ>(c, reg, v);
+	else
+		wr<SZ>(c, ea_addr<SZ>(c, m, reg), v);
+}
+
+/**
+ * Read-modify-write operand.
+ * The address is calculated once by rmw_read().
+ */
+struct Operand {
+	int m;
+	int reg;
+	uint32_t address;
+};
+
+template<int SZ>
+static inline uint32_t rmw_read(Cpu *c, Operand *o)
+{
+	if (o->m == EA_DN)
+		return (c->r[o->reg] & SZ_MASK(SZ));
+	o->address = ea_addr<SZ>(c, o->m, o->reg);
+	return rd<SZ>(c, o->address);
+}
+
+template<int SZ>
+static inline void rmw_write(Cpu *c, const Operand *o, uint32_t v)
+{
+	if (o->m == EA_DN)
+		set_dreg<SZ>(c, o->reg, v);
+	else
+		wr<SZ>(c, o->address, v);
+}
+
+static inline void push16(Cpu *c, uint32_t v)
+{
+	c->r[15] -= 2;
+	write16(c, c->r[15], (uint16_t)v);
+}
+
+static inline void push32(Cpu *c, uint32_t v)
+{
+	c->r[15] -= 4;
+	write32(c, c->r[15], v);
+}
+
+static inline uint32_t pop16(Cpu *c)
+{
+	const uint32_t v = read16(c, c->r[15]);
+	c->r[15] += 2;
+	return v;
+}
+
+static inline uint32_t pop32(Cpu *c)
+{
+	const uint32_t v = read32(c, c->r[15]);
+	c->r[15] += 4;
+	return v;
+}
+
+/** Flags. **/
+
+template<int SZ>
+static inline void set_nz(Cpu *c, uint32_t res)
+{
+	c->flag_n = msb<SZ>(res);
+	c->flag_z = ((res & SZ_MASK(SZ)) == 0);
+}
+
+template<int SZ>
+static inline void set_logic(Cpu *c, uint32_t res)
+{
+	set_nz<SZ>(c, res);
+	c->flag_v = 0;
+	c->flag_c = 0;
+}
+
+template<int SZ>
+static inline uint32_t do_add(Cpu *c, uint32_t src, uint32_t dst)
+{
+	const uint32_t res = (dst + src) & SZ_MASK(SZ);
+	set_nz<SZ>(c, res);
+	c->flag_v = msb<SZ>((src ^ res) & (dst ^ res));
+	c->flag_c = c->flag_x = msb<SZ>((src & dst) | (~res & (src | dst)));
+	return res;
+}
+
+template<int SZ>
+static inline uint32_t do_sub(Cpu *c, uint32_t src, uint32_t dst)
+{
+	const uint32_t res = (dst - src) & SZ_MASK(SZ);
+	set_nz<SZ>(c, res);
+	c->flag_v = msb<SZ>((src ^ dst) & (res ^ dst));
+	c->flag_c = c->flag_x = msb<SZ>((src & ~dst) | (res & ~dst) | (src & res));
+	return res;
+}
+
+template<int SZ>
+static inline void do_cmp(Cpu *c, uint32_t src, uint32_t dst)
+{
+	const uint32_t res = (dst - src) & SZ_MASK(SZ);
+	set_nz<SZ>(c, res);
+	c->flag_v = msb<SZ>((src ^ dst) & (res ^ dst));
+	c->flag_c = msb<SZ>((src & ~dst) | (res & ~dst) | (src & res));
+}
+
+// ADDX/SUBX: Z is only cleared, never set.
+template<int SZ>
+static inline uint32_t do_addx(Cpu *c, uint32_t src, uint32_t dst)
+{
+	const uint32_t res = (dst + src + c->flag_x) & SZ_MASK(SZ);
+	c->flag_n = msb<SZ>(res);
+	if (res != 0)
+		c->flag_z = 0;
+	c->flag_v = msb<SZ>((src ^ res) & (dst ^ res));
+	c->flag_c = c->flag_x = msb<SZ>((src & dst) | (~res & (src | dst)));
+	return res;
+}
+
+template<int SZ>
+static inline uint32_t do_subx(Cpu *c, uint32_t src, uint32_t dst)
+{
+	const uint32_t res = (dst - src - c->flag_x) & SZ_MASK(SZ);
+	c->flag_n = msb<SZ>(res);
+	if (res != 0)
+		c->flag_z = 0;
+	c->flag_v = msb<SZ>((src ^ dst) & (res ^ dst));
+	c->flag_c = c->flag_x = msb<SZ>((src & ~dst) | (res & ~dst) | (src & res));
+	return res;
+}
+
+static inline uint32_t do_abcd(Cpu *c, uint32_t src, uint32_t dst)
+{
+	uint32_t res = (src & 0x0F) + (dst & 0x0F) + c->flag_x;
+	if (res > 9)
+		res += 6;
+	res += (src & 0xF0) + (dst & 0xF0);
+	c->flag_c = c->flag_x = (res > 0x99);
+	if (c->flag_c)
+		res -= 0xA0;
+	res &= 0xFF;
+	c->flag_n = msb<1>(res);
+	if (res != 0)
+		c->flag_z = 0;
+	return res;
+}
+
+static inline uint32_t do_sbcd(Cpu *c, uint32_t src, uint32_t dst)
+{
+	uint32_t res = (dst & 0x0F) - (src & 0x0F) - c->flag_x;
+	if (res > 9)
+		res -= 6;
+	res += (dst & 0xF0) - (src & 0xF0);
+	c->flag_c = c->flag_x = (res > 0x99);
+	if (c->flag_c)
+		res += 0xA0;
+	res &= 0xFF;
+	c->flag_n = msb<1>(res);
+	if (res != 0)
+		c->flag_z = 0;
+	return res;
+}
+
+/**
+ * Test a condition code.
+ * @param c CPU.
+ * @param cc Condition code.
+ * @return True if the condition is true.
+ */
+static inline bool test_cc(const Cpu *c, int cc)
+{
+	switch (cc & 15) {
+		default:
+		case 0x0:	return true;
+		case 0x1:	return false;
+		case 0x2:	return !c->flag_c && !c->flag_z;	// HI
+		case 0x3:	return c->flag_c || c->flag_z;		// LS
+		case 0x4:	return !c->flag_c;			// CC
+		case 0x5:	return c->flag_c;			// CS
+		case 0x6:	return !c->flag_z;			// NE
+		case 0x7:	return c->flag_z;			// EQ
+		case 0x8:	return !c->flag_v;			// VC
+		case 0x9:	return c->flag_v;			// VS
+		case 0xA:	return !c->flag_n;			// PL
+		case 0xB:	return c->flag_n;			// MI
+		case 0xC:	return c->flag_n == c->flag_v;		// GE
+		case 0xD:	return c->flag_n != c->flag_v;		// LT
+		case 0xE:	return !c->flag_z && c->flag_n == c->flag_v;	// GT
+		case 0xF:	return c->flag_z || c->flag_n != c->flag_v;	// LE
+	}
+}
+
+/**
+ * Check for supervisor mode.
+ * If the CPU is in user mode, a privilege violation is raised.
+ * Must be called before fetching extension words.
+ * @param c CPU.
+ * @return True if the CPU is in supervisor mode.
+ */
+static inline bool check_supervisor(Cpu *c)
+{
+	if (c->sr_sys & MD68K_SR_S)
+		return true;
+	c->pc -= 2;
+	exception(c, VEC_PRIVILEGE, 34);
+	return false;
+}
+
+static inline unsigned int popcount16(uint32_t v)
+{
+	v &= 0xFFFF;
+	unsigned int count = 0;
+	for (; v != 0; v &= (v - 1))
+		count++;
+	return count;
+}
+
+/** Illegal instructions. **/
+
+static void op_illegal(Cpu *c, uint32_t op)
+{
+	((void)op);
+	c->pc -= 2;
+	exception(c, VEC_ILLEGAL, 34);
+}
+
+static void op_line_a(Cpu *c, uint32_t op)
+{
+	((void)op);
+	c->pc -= 2;
+	exception(c, VEC_LINE_A, 34);
+}
+
+static void op_line_f(Cpu *c, uint32_t op)
+{
+	((void)op);
+	c->pc -= 2;
+	exception(c, VEC_LINE_F, 34);
+}
+
+/** ALU operations. **/
+
+enum AluOp { OP_OR, OP_AND, OP_EOR, OP_ADD, OP_SUB, OP_CMP };
+
+template<int SZ, int OP>
+static inline uint32_t alu(Cpu *c, uint32_t src, uint32_t dst)
+{
+	uint32_t res;
+	switch (OP) {
+		case OP_OR:	res = (src | dst); set_logic<SZ>(c, res); return res;
+		case OP_AND:	res = (src & dst); set_logic<SZ>(c, res); return res;
+		case OP_EOR:	res = (src ^ dst); set_logic<SZ>(c, res); return res;
+		case OP_ADD:	return do_add<SZ>(c, src, dst);
+		case OP_SUB:	return do_sub<SZ>(c, src, dst);
+		default:	do_cmp<SZ>(c, src, dst); return dst;
+	}
+}
+
+/**
+ * OR/AND/ADD/SUB/CMP <ea>,Dn
+ */
+template<int SZ, int OP>
+static void op_alu_ea_dn(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const int dn = (op >> 9) & 7;
+	const uint32_t src = ea_read<SZ>(c, m, op & 7);
+	const uint32_t res = alu<SZ, OP>(c, src, c->r[dn] & SZ_MASK(SZ));
+	if (OP != OP_CMP)
+		set_dreg<SZ>(c, dn, res);
+
+	int cycles = 4 + ea_cycles<SZ>(m);
+	if (SZ == 4) {
+		cycles += ((OP != OP_CMP && (m == EA_DN || m == EA_AN || m == EA_IMM)) ? 4 : 2);
+	}
+	c->cycles -= cycles;
+}
+
+/**
+ * OR/AND/EOR/ADD/SUB Dn,<ea>
+ */
+template<int SZ, int OP>
+static void op_alu_dn_ea(Cpu *c, uint32_t op)
+{
+	Operand o = {EA_SRC(op), (int)(op & 7), 0};
+	const uint32_t dst = rmw_read<SZ>(c, &o);
+	rmw_write<SZ>(c, &o, alu<SZ, OP>(c, c->r[(op >> 9) & 7] & SZ_MASK(SZ), dst));
+
+	if (o.m == EA_DN)
+		c->cycles -= (SZ == 4 ? 8 : 4);
+	else
+		c->cycles -= (SZ == 4 ? 12 : 8) + ea_cycles<SZ>(o.m);
+}
+
+/**
+ * ORI/ANDI/EORI/ADDI/SUBI/CMPI #imm,<ea>
+ */
+template<int SZ, int OP>
+static void op_imm(Cpu *c, uint32_t op)
+{
+	const uint32_t src = imm<SZ>(c);
+	Operand o = {EA_SRC(op), (int)(op & 7), 0};
+	const uint32_t dst = rmw_read<SZ>(c, &o);
+	const uint32_t res = alu<SZ, OP>(c, src, dst);
+	if (OP != OP_CMP)
+		rmw_write<SZ>(c, &o, res);
+
+	if (o.m == EA_DN) {
+		if (SZ == 4)
+			c->cycles -= (OP == OP_CMP ? 14 : 16);
+		else
+			c->cycles -= 8;
+	} else {
+		if (OP == OP_CMP)
+			c->cycles -= (SZ == 4 ? 12 : 8) + ea_cycles<SZ>(o.m);
+		else
+			c->cycles -= (SZ == 4 ? 20 : 12) + ea_cycles<SZ>(o.m);
+	}
+}
+
+/**
+ * ORI/ANDI/EORI #imm,CCR
+ */
+template<int OP>
+static void op_imm_ccr(Cpu *c, uint32_t op)
+{
+	((void)op);
+	const uint32_t src = (fetch16(c) & 0x1F);
+	uint32_t ccr = (get_sr(c) & 0x1F);
+	switch (OP) {
+		case OP_OR:	ccr |= src; break;
+		case OP_AND:	ccr &= src; break;
+		default:	ccr ^= src; break;
+	}
+	set_ccr(c, ccr);
+	c->cycles -= 20;
+}
+
+/**
+ * ORI/ANDI/EORI #imm,SR
+ */
+template<int OP>
+static void op_imm_sr(Cpu *c, uint32_t op)
+{
+	((void)op);
+	if (!check_supervisor(c))
+		return;
+	const uint32_t src = fetch16(c);
+	uint32_t sr = get_sr(c);
+	switch (OP) {
+		case OP_OR:	sr |= src; break;
+		case OP_AND:	sr &= src; break;
+		default:	sr ^= src; break;
+	}
+	set_sr(c, sr);
+	c->cycles -= 20;
+}
+
+/**
+ * ADDA/SUBA <ea>,An
+ */
+template<int SZ, int OP>
+static void op_adda(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const uint32_t src = sext<SZ>(ea_read<SZ>(c, m, op & 7));
+	uint32_t *an = &c->r[8 + ((op >> 9) & 7)];
+	if (OP == OP_SUB)
+		*an -= src;
+	else
+		*an += src;
+
+	if (SZ == 2)
+		c->cycles -= 8 + ea_cycles<SZ>(m);
+	else
+		c->cycles -= ((m == EA_DN || m == EA_AN || m == EA_IMM) ? 8 : 6) + ea_cycles<SZ>(m);
+}
+
+/**
+ * CMPA <ea>,An
+ */
+template<int SZ>
+static void op_cmpa(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const uint32_t src = sext<SZ>(ea_read<SZ>(c, m, op & 7));
+	do_cmp<4>(c, src, c->r[8 + ((op >> 9) & 7)]);
+	c->cycles -= 6 + ea_cycles<SZ>(m);
+}
+
+/**
+ * ADDX/SUBX/ABCD/SBCD Dy,Dx
+ */
+enum XOp { XOP_ADDX, XOP_SUBX, XOP_ABCD, XOP_SBCD };
+
+template<int SZ, int OP>
+static inline uint32_t xop(Cpu *c, uint32_t src, uint32_t dst)
+{
+	switch (OP) {
+		case XOP_ADDX:	return do_addx<SZ>(c, src, dst);
+		case XOP_SUBX:	return do_subx<SZ>(c, src, dst);
+		case XOP_ABCD:	return do_abcd(c, src, dst);
+		default:	return do_sbcd(c, src, dst);
+	}
+}
+
+template<int SZ, int OP>
+static void op_x_rr(Cpu *c, uint32_t op)
+{
+	const int dx = (op >> 9) & 7;
+	const uint32_t src = (c->r[op & 7] & SZ_MASK(SZ));
+	set_dreg<SZ>(c, dx, xop<SZ, OP>(c, src, c->r[dx] & SZ_MASK(SZ)));
+	if (OP == XOP_ABCD || OP == XOP_SBCD)
+		c->cycles -= 6;
+	else
+		c->cycles -= (SZ == 4 ? 8 : 4);
+}
+
+/**
+ * ADDX/SUBX/ABCD/SBCD -(Ay),-(Ax)
+ */
+template<int SZ, int OP>
+static void op_x_mm(Cpu *c, uint32_t op)
+{
+	const uint32_t src = rd<SZ>(c, ea_addr<SZ>(c, EA_PD, op & 7));
+	const uint32_t dst_addr = ea_addr<SZ>(c, EA_PD, (op >> 9) & 7);
+	const uint32_t dst = rd<SZ>(c, dst_addr);
+	wr<SZ>(c, dst_addr, xop<SZ, OP>(c, src, dst));
+	c->cycles -= (SZ == 4 ? 30 : 18);
+}
+
+/**
+ * CMPM (Ay)+,(Ax)+
+ */
+template<int SZ>
+static void op_cmpm(Cpu *c, uint32_t op)
+{
+	const uint32_t src = rd<SZ>(c, ea_addr<SZ>(c, EA_PI, op & 7));
+	const uint32_t dst = rd<SZ>(c, ea_addr<SZ>(c, EA_PI, (op >> 9) & 7));
+	do_cmp<SZ>(c, src, dst);
+	c->cycles -= (SZ == 4 ? 20 : 12);
+}
+
+/** Bit operations. **/
+
+enum BitOp { BIT_TST, BIT_CHG, BIT_CLR, BIT_SET };
+
+/**
+ * BTST/BCHG/BCLR/BSET Dn,<ea> or #imm,<ea>
+ */
+template<int OP, bool STATIC>
+static void op_bit(Cpu *c, uint32_t op)
+{
+	uint32_t bit = (STATIC ? fetch16(c) : c->r[(op >> 9) & 7]);
+	const int m = EA_SRC(op);
+	const int reg = (op & 7);
+
+	if (m == EA_DN) {
+		// Data register: 32-bit.
+		const uint32_t mask = (1U << (bit & 31));
+		c->flag_z = !(c->r[reg] & mask);
+		switch (OP) {
+			case BIT_CHG:	c->r[reg] ^= mask; break;
+			case BIT_CLR:	c->r[reg] &= ~mask; break;
+			case BIT_SET:	c->r[reg] |= mask; break;
+			default:	break;
+		}
+
+		switch (OP) {
+			case BIT_TST:	c->cycles -= (STATIC ? 10 : 6); break;
+			case BIT_CLR:	c->cycles -= (STATIC ? 14 : 10); break;
+			default:	c->cycles -= (STATIC ? 12 : 8); break;
+		}
+		return;
+	}
+
+	// Memory: 8-bit.
+	const uint32_t mask = (1U << (bit & 7));
+	if (OP == BIT_TST) {
+		c->flag_z = !(ea_read<1>(c, m, reg) & mask);
+		c->cycles -= (STATIC ? 8 : 4) + ea_cycles<1>(m);
+		return;
+	}
+
+	Operand o = {m, reg, 0};
+	uint32_t v = rmw_read<1>(c, &o);
+	c->flag_z = !(v & mask);
+	switch (OP) {
+		case BIT_CHG:	v ^= mask; break;
+		case BIT_CLR:	v &= ~mask; break;
+		default:	v |= mask; break;
+	}
+	rmw_write<1>(c, &o, v);
+	c->cycles -= (STATIC ? 12 : 8) + ea_cycles<1>(m);
+}
+
+/**
+ * MOVEP (d16,Ay),Dx / MOVEP Dx,(d16,Ay)
+ */
+template<int SZ, bool TO_MEM>
+static void op_movep(Cpu *c, uint32_t op)
+{
+	uint32_t address = c->r[8 + (op & 7)];
+	address += sext<2>(fetch16(c));
+	const int dx = (op >> 9) & 7;
+
+	if (TO_MEM) {
+		const uint32_t v = c->r[dx];
+		if (SZ == 4) {
+			write8(c, address, (uint8_t)(v >> 24));
+			write8(c, address + 2, (uint8_t)(v >> 16));
+			address += 4;
+		}
+		write8(c, address, (uint8_t)(v >> 8));
+		write8(c, address + 2, (uint8_t)v);
+	} else {
+		uint32_t v = 0;
+		if (SZ == 4) {
+			v = (read8(c, address) << 24) | (read8(c, address + 2) << 16);
+			address += 4;
+		}
+		v |= (read8(c, address) << 8) | read8(c, address + 2);
+		set_dreg<SZ>(c, dx, v);
+	}
+
+	c->cycles -= (SZ == 4 ? 24 : 16);
+}
+
+/** MOVE. **/
+
+// MOVE destination timing.
+static const uint8_t move_dst_cycles[12] = {0, 0, 4, 4, 4, 8, 10, 8, 12, 0, 0, 0};
+
+template<int SZ>
+static void op_move(Cpu *c, uint32_t op)
+{
+	const int sm = EA_SRC(op);
+	const uint32_t v = ea_read<SZ>(c, sm, op & 7);
+	const int dm = ea_mode((op >> 6) & 7, (op >> 9) & 7);
+	set_logic<SZ>(c, v);
+	ea_write<SZ>(c, dm, (op >> 9) & 7, v);
+
+	int cycles = 4 + ea_cycles<SZ>(sm) + move_dst_cycles[dm];
+	if (SZ == 4 && dm != EA_DN)
+		cycles += 4;
+	c->cycles -= cycles;
+}
+
+template<int SZ>
+static void op_movea(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	c->r[8 + ((op >> 9) & 7)] = sext<SZ>(ea_read<SZ>(c, m, op & 7));
+	c->cycles -= 4 + ea_cycles<SZ>(m);
+}
+
+static void op_moveq(Cpu *c, uint32_t op)
+{
+	const uint32_t v = sext<1>(op);
+	c->r[(op >> 9) & 7] = v;
+	set_logic<4>(c, v);
+	c->cycles -= 4;
+}
+
+/** Single-operand instructions. **/
+
+enum UnaryOp { UN_NEGX, UN_CLR, UN_NEG, UN_NOT };
+
+/**
+ * NEGX/CLR/NEG/NOT <ea>
+ */
+template<int SZ, int OP>
+static void op_unary(Cpu *c, uint32_t op)
+{
+	Operand o = {EA_SRC(op), (int)(op & 7), 0};
+	const uint32_t dst = rmw_read<SZ>(c, &o);
+	uint32_t res;
+	switch (OP) {
+		case UN_NEGX:
+			res = do_subx<SZ>(c, dst, 0);
+			break;
+		case UN_CLR:
+			res = 0;
+			set_logic<SZ>(c, res);
+			break;
+		case UN_NEG:
+			res = do_sub<SZ>(c, dst, 0);
+			break;
+		default:
+			res = (~dst & SZ_MASK(SZ));
+			set_logic<SZ>(c, res);
+			break;
+	}
+	rmw_write<SZ>(c, &o, res);
+
+	if (o.m == EA_DN)
+		c->cycles -= (SZ == 4 ? 6 : 4);
+	else
+		c->cycles -= (SZ == 4 ? 12 : 8) + ea_cycles<SZ>(o.m);
+}
+
+template<int SZ>
+static void op_tst(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	set_logic<SZ>(c, ea_read<SZ>(c, m, op & 7));
+	c->cycles -= 4 + ea_cycles<SZ>(m);
+}
+
+static void op_nbcd(Cpu *c, uint32_t op)
+{
+	Operand o = {EA_SRC(op), (int)(op & 7), 0};
+	const uint32_t dst = rmw_read<1>(c, &o);
+	rmw_write<1>(c, &o, do_sbcd(c, dst, 0));
+	c->cycles -= (o.m == EA_DN ? 6 : 8 + ea_cycles<1>(o.m));
+}
+
+/**
+ * TAS <ea>
+ * The MD bus doesn't support the read-modify-write cycle,
+ * so the result is only written back to data registers.
+ */
+static void op_tas(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const int reg = (op & 7);
+	if (m == EA_DN) {
+		set_logic<1>(c, c->r[reg]);
+		c->r[reg] |= 0x80;
+		c->cycles -= 4;
+	} else {
+		set_logic<1>(c, rd<1>(c, ea_addr<1>(c, m, reg)));
+		c->cycles -= 14 + ea_cycles<1>(m);
+	}
+}
+
+static void op_swap(Cpu *c, uint32_t op)
+{
+	uint32_t *dn = &c->r[op & 7];
+	*dn = (*dn >> 16) | (*dn << 16);
+	set_logic<4>(c, *dn);
+	c->cycles -= 4;
+}
+
+static void op_ext_w(Cpu *c, uint32_t op)
+{
+	const int reg = (op & 7);
+	const uint32_t v = sext<1>(c->r[reg]);
+	set_dreg<2>(c, reg, v);
+	set_logic<2>(c, v);
+	c->cycles -= 4;
+}
+
+static void op_ext_l(Cpu *c, uint32_t op)
+{
+	const int reg = (op & 7);
+	c->r[reg] = sext<2>(c->r[reg]);
+	set_logic<4>(c, c->r[reg]);
+	c->cycles -= 4;
+}
+
+static void op_scc(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const bool cond = test_cc(c, op >> 8);
+	if (m == EA_DN) {
+		set_dreg<1>(c, op & 7, cond ? 0xFF : 0x00);
+		c->cycles -= (cond ? 6 : 4);
+	} else {
+		wr<1>(c, ea_addr<1>(c, m, op & 7), cond ? 0xFF : 0x00);
+		c->cycles -= 8 + ea_cycles<1>(m);
+	}
+}
+
+/** Multiply and divide. **/
+
+static void op_mulu(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const uint32_t src = ea_read<2>(c, m, op & 7);
+	uint32_t *dn = &c->r[(op >> 9) & 7];
+	*dn = (*dn & 0xFFFF) * src;
+	set_logic<4>(c, *dn);
+	c->cycles -= 38 + (popcount16(src) * 2) + ea_cycles<2>(m);
+}
+
+static void op_muls(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const uint32_t src = ea_read<2>(c, m, op & 7);
+	uint32_t *dn = &c->r[(op >> 9) & 7];
+	*dn = (uint32_t)((int32_t)(int16_t)*dn * (int32_t)(int16_t)src);
+	set_logic<4>(c, *dn);
+
+	// Timing depends on the number of 01/10 bit pairs.
+	const uint32_t pairs = (src << 1);
+	c->cycles -= 38 + (popcount16(pairs ^ (pairs >> 1)) * 2) + ea_cycles<2>(m);
+}
+
+static void op_divu(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const uint32_t src = ea_read<2>(c, m, op & 7);
+	if (src == 0) {
+		exception(c, VEC_ZERO_DIVIDE, 38 + ea_cycles<2>(m));
+		return;
+	}
+
+	uint32_t *dn = &c->r[(op >> 9) & 7];
+	const uint32_t quotient = (*dn / src);
+	if (quotient > 0xFFFF) {
+		// Overflow.
+		c->flag_v = 1;
+		c->flag_c = 0;
+		c->cycles -= 10 + ea_cycles<2>(m);
+		return;
+	}
+
+	*dn = ((*dn % src) << 16) | quotient;
+	set_logic<2>(c, quotient);
+	c->cycles -= 140 + ea_cycles<2>(m);
+}
+
+static void op_divs(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const int32_t src = (int16_t)ea_read<2>(c, m, op & 7);
+	if (src == 0) {
+		exception(c, VEC_ZERO_DIVIDE, 38 + ea_cycles<2>(m));
+		return;
+	}
+
+	uint32_t *dn = &c->r[(op >> 9) & 7];
+	const int32_t dividend = (int32_t)*dn;
+	if (dividend == (int32_t)0x80000000 && src == -1) {
+		// Overflow. (Also avoids a host exception.)
+		c->flag_v = 1;
+		c->flag_c = 0;
+		c->cycles -= 16 + ea_cycles<2>(m);
+		return;
+	}
+
+	const int32_t quotient = dividend / src;
+	if (quotient != (int16_t)quotient) {
+		// Overflow.
+		c->flag_v = 1;
+		c->flag_c = 0;
+		c->cycles -= 16 + ea_cycles<2>(m);
+		return;
+	}
+
+	const int32_t remainder = dividend % src;
+	*dn = ((uint32_t)(remainder & 0xFFFF) << 16) | ((uint32_t)quotient & 0xFFFF);
+	set_logic<2>(c, (uint32_t)quotient);
+	c->cycles -= 158 + ea_cycles<2>(m);
+}
+
+static void op_chk(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const int32_t bound = (int16_t)ea_read<2>(c, m, op & 7);
+	const int32_t v = (int16_t)c->r[(op >> 9) & 7];
+
+	c->flag_z = (v == 0);
+	c->flag_v = 0;
+	c->flag_c = 0;
+	if (v < 0 || v > bound) {
+		c->flag_n = (v < 0);
+		exception(c, VEC_CHK, 40 + ea_cycles<2>(m));
+		return;
+	}
+	c->cycles -= 10 + ea_cycles<2>(m);
+}
+
+/** EXG. **/
+
+static void op_exg_dd(Cpu *c, uint32_t op)
+{
+	const uint32_t tmp = c->r[(op >> 9) & 7];
+	c->r[(op >> 9) & 7] = c->r[op & 7];
+	c->r[op & 7] = tmp;
+	c->cycles -= 6;
+}
+
+static void op_exg_aa(Cpu *c, uint32_t op)
+{
+	const uint32_t tmp = c->r[8 + ((op >> 9) & 7)];
+	c->r[8 + ((op >> 9) & 7)] = c->r[8 + (op & 7)];
+	c->r[8 + (op & 7)] = tmp;
+	c->cycles -= 6;
+}
+
+static void op_exg_da(Cpu *c, uint32_t op)
+{
+	const uint32_t tmp = c->r[(op >> 9) & 7];
+	c->r[(op >> 9) & 7] = c->r[8 + (op & 7)];
+	c->r[8 + (op & 7)] = tmp;
+	c->cycles -= 6;
+}
+
+/** Shifts and rotates. **/
+
+enum ShiftOp { SH_AS, SH_LS, SH_ROX, SH_RO };
+
+/**
+ * Shift or rotate a value.
+ * @param c CPU.
+ * @param v Value.
+ * @param count Shift count. (0-63)
+ * @return Result.
+ */
+template<int SZ, int OP, bool LEFT>
+static inline uint32_t do_shift(Cpu *c, uint32_t v, unsigned int count)
+{
+	const unsigned int bits = SZ_BITS(SZ);
+	const uint64_t mask = SZ_MASK(SZ);
+	const uint64_t v64 = v;
+	uint32_t res = v;
+	c->flag_v = 0;
+
+	if (count == 0) {
+		// X is unaffected. C is cleared, except for ROXL/ROXR.
+		c->flag_c = (OP == SH_ROX ? c->flag_x : 0);
+		set_nz<SZ>(c, res);
+		return res;
+	}
+
+	switch (OP) {
+		case SH_AS:
+			if (LEFT) {
+				if (count < bits) {
+					res = (uint32_t)((v64 << count) & mask);
+					c->flag_c = (uint32_t)((v64 >> (bits - count)) & 1);
+					// V is set if the MSB changes at any time.
+					const uint64_t top = (((1ULL << (count + 1)) - 1) << (bits - count - 1));
+					c->flag_v = ((v64 & top) != 0 && (v64 & top) != top);
+				} else {
+					res = 0;
+					c->flag_c = (count == bits ? (v & 1) : 0);
+					c->flag_v = (v != 0);
+				}
+			} else {
+				const uint32_t sign = msb<SZ>(v);
+				if (count < bits) {
+					res = (uint32_t)((uint64_t)((int64_t)(int32_t)sext<SZ>(v) >> count) & mask);
+					c->flag_c = (uint32_t)((v64 >> (count - 1)) & 1);
+				} else {
+					res = (sign ? (uint32_t)mask : 0);
+					c->flag_c = sign;
+				}
+			}
+			c->flag_x = c->flag_c;
+			break;
+
+		case SH_LS:
+			if (LEFT) {
+				if (count <= bits) {
+					res = (uint32_t)((v64 << count) & mask);
+					c->flag_c = (uint32_t)((v64 >> (bits - count)) & 1);
+				} else {
+					res = 0;
+					c->flag_c = 0;
+				}
+			} else {
+				if (count <= bits) {
+					res = (uint32_t)(v64 >> count);
+					c->flag_c = (uint32_t)((v64 >> (count - 1)) & 1);
+				} else {
+					res = 0;
+					c->flag_c = 0;
+				}
+			}
+			c->flag_x = c->flag_c;
+			break;
+
+		case SH_ROX: {
+			uint32_t x = c->flag_x;
+			for (unsigned int n = count % (bits + 1); n > 0; n--) {
+				uint32_t out;
+				if (LEFT) {
+					out = msb<SZ>(res);
+					res = (uint32_t)((((uint64_t)res << 1) | x) & mask);
+				} else {
+					out = (res & 1);
+					res = (res >> 1) | (x << (bits - 1));
+				}
+				x = out;
+			}
+			c->flag_c = c->flag_x = x;
+			break;
+		}
+
+		default: {
+			const unsigned int n = (count % bits);
+			if (n != 0) {
+				if (LEFT)
+					res = (uint32_t)(((v64 << n) | (v64 >> (bits - n))) & mask);
+				else
+					res = (uint32_t)(((v64 >> n) | (v64 << (bits - n))) & mask);
+			}
+			c->flag_c = (LEFT ? (res & 1) : msb<SZ>(res));
+			break;
+		}
+	}
+
+	set_nz<SZ>(c, res);
+	return res;
+}
+
+/**
+ * ASd/LSd/ROXd/ROd #imm,Dy or Dx,Dy
+ */
+template<int SZ, int OP, bool LEFT>
+static void op_shift_reg(Cpu *c, uint32_t op)
+{
+	const int reg = (op & 7);
+	unsigned int count = (op >> 9) & 7;
+	if (op & 0x20)
+		count = (c->r[count] & 63);
+	else if (count == 0)
+		count = 8;
+
+	set_dreg<SZ>(c, reg, do_shift<SZ, OP, LEFT>(c, c->r[reg] & SZ_MASK(SZ), count));
+	c->cycles -= (SZ == 4 ? 8 : 6) + (count * 2);
+}
+
+/**
+ * ASd/LSd/ROXd/ROd <ea> (word, shift by 1)
+ */
+template<int OP, bool LEFT>
+static void op_shift_mem(Cpu *c, uint32_t op)
+{
+	Operand o = {EA_SRC(op), (int)(op & 7), 0};
+	const uint32_t v = rmw_read<2>(c, &o);
+	rmw_write<2>(c, &o, do_shift<2, OP, LEFT>(c, v, 1));
+	c->cycles -= 8 + ea_cycles<2>(o.m);
+}
+
+/** Status register. **/
+
+static void op_move_from_sr(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	if (m == EA_DN) {
+		set_dreg<2>(c, op & 7, get_sr(c));
+		c->cycles -= 6;
+	} else {
+		const uint32_t address = ea_addr<2>(c, m, op & 7);
+		write16(c, address, get_sr(c));
+		c->cycles -= 8 + ea_cycles<2>(m);
+	}
+}
+
+static void op_move_to_ccr(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	set_ccr(c, ea_read<2>(c, m, op & 7));
+	c->cycles -= 12 + ea_cycles<2>(m);
+}
+
+static void op_move_to_sr(Cpu *c, uint32_t op)
+{
+	if (!check_supervisor(c))
+		return;
+	const int m = EA_SRC(op);
+	set_sr(c, ea_read<2>(c, m, op & 7));
+	c->cycles -= 12 + ea_cycles<2>(m);
+}
+
+static void op_move_to_usp(Cpu *c, uint32_t op)
+{
+	if (!check_supervisor(c))
+		return;
+	c->asp = c->r[8 + (op & 7)];
+	c->cycles -= 4;
+}
+
+static void op_move_from_usp(Cpu *c, uint32_t op)
+{
+	if (!check_supervisor(c))
+		return;
+	c->r[8 + (op & 7)] = c->asp;
+	c->cycles -= 4;
+}
+
+/** Idle loop detection. **/
+
+/**
+ * Read a word from program memory without side effects.
+ * @param c CPU.
+ * @param address Address.
+ * @param word [out] Word.
+ * @return True on success; false if the address isn't in a fetch page.
+ */
+static inline bool idle_fetch16(const Cpu *c, uint32_t address, uint32_t *word)
+{
+	address &= 0xFFFFFE;
+	const uint8_t *page = c->fetch[address >> 16];
+	if (!page)
+		return false;
+	*word = *(const uint16_t*)(page + (address & 0xFFFF));
+	return true;
+}
+
+/**
+ * Check if an idle loop can read from an address.
+ * Only memory that doesn't change during the timeslice
+ * and has no read side effects is allowed:
+ * - Program memory. (ROM and anything else in a fetch page)
+ * - 68000 RAM. ($E00000-$FFFFFF)
+ * Everything else is rejected, including the I/O area ($A1xxxx)
+ * and all VDP ports. The HV counter changes while the 68000 runs,
+ * and reading the status port toggles FIFO FULL/EMPTY and clears
+ * SOVR and COLLISION, so skipping those reads would change what
+ * the game sees.
+ * @param c CPU.
+ * @param address Address.
+ * @param sz Access size, in bytes.
+ * @return True if the address can be read by an idle loop.
+ */
+static inline bool idle_read_ok(const Cpu *c, uint32_t address, int sz)
+{
+	address &= 0xFFFFFF;
+	const uint32_t last = (address + sz - 1);
+	if (last > 0xFFFFFF)
+		return false;
+
+	if (address >= 0xE00000)
+		return true;
+	return (c->fetch[address >> 16] != nullptr &&
+		c->fetch[last >> 16] != nullptr);
+}
+
+/**
+ * Check an idle loop source operand.
+ * Registers are evaluated using their current values. This is valid
+ * because the loop is only idle if every iteration is identical.
+ * @param c CPU.
+ * @param pc [in/out] Address of the extension words. Updated to skip them.
+ * @param mode Mode field.
+ * @param reg Register field.
+ * @param sz Operand size, in bytes.
+ * @param reads [in/out] Registers read. (bits 0-7: D0-D7; bits 8-15: A0-A7)
+ * @return True if the operand can be read without side effects.
+ */
+static bool idle_ea(const Cpu *c, uint32_t *pc, uint32_t mode, uint32_t reg, int sz, uint32_t *reads)
+{
+	uint32_t ext, ext2, address;
+	switch (ea_mode(mode, reg)) {
+		case EA_DN:
+			*reads |= (1U << reg);
+			return true;
+		case EA_AN:
+			*reads |= (1U << (8 + reg));
+			return true;
+		case EA_AI:
+			*reads |= (1U << (8 + reg));
+			address = c->r[8 + reg];
+			break;
+		case EA_DI:
+			if (!idle_fetch16(c, *pc, &ext))
+				return false;
+			*pc += 2;
+			*reads |= (1U << (8 + reg));
+			address = c->r[8 + reg] + sext<2>(ext);
+			break;
+		case EA_IX: {
+			if (!idle_fetch16(c, *pc, &ext))
+				return false;
+			*pc += 2;
+			*reads |= (1U << (8 + reg)) | (1U << ((ext >> 12) & 15));
+			uint32_t idx = c->r[(ext >> 12) & 15];
+			if (!(ext & 0x800))
+				idx = sext<2>(idx);
+			address = c->r[8 + reg] + idx + sext<1>(ext);
+			break;
+		}
+		case EA_AW:
+			if (!idle_fetch16(c, *pc, &ext))
+				return false;
+			*pc += 2;
+			address = sext<2>(ext);
+			break;
+		case EA_AL:
+			if (!idle_fetch16(c, *pc, &ext) || !idle_fetch16(c, *pc + 2, &ext2))
+				return false;
+			*pc += 4;
+			address = ((ext << 16) | ext2);
+			break;
+		case EA_PCDI:
+			*pc += 2;
+			return true;
+		case EA_PCIX:
+			if (!idle_fetch16(c, *pc, &ext))
+				return false;
+			*pc += 2;
+			*reads |= (1U << ((ext >> 12) & 15));
+			return true;
+		case EA_IMM:
+			*pc += (sz == 4 ? 4 : 2);
+			return true;
+		default:
+			// (An)+ and -(An) modify the address register.
+			return false;
+	}
+
+	return idle_read_ok(c, address, sz);
+}
+
+/**
+ * Check if a loop body has no side effects.
+ *
+ * The body must be straight-line code consisting of TST, CMP, CMPA,
+ * CMPI, BTST, MOVE/MOVEA/MOVEQ to a register, AND/ANDI to a data
+ * register, and NOP. A register may only be written if it isn't
+ * read before it's written, so every iteration does the same thing
+ * as long as memory doesn't change.
+ *
+ * On hardware, the Z80 can write to 68000 RAM at any time. Here, the
+ * Z80 and VDP only run between 68000 timeslices, so memory can't change
+ * until the current timeslice ends. Skipping the loop only skips the
+ * rest of the timeslice; the loop is checked again in the next one.
+ *
+ * @param c CPU.
+ * @param pc Start of the loop body. (branch target)
+ * @param end End of the loop body. (address of the branch)
+ * @return True if the loop is idle.
+ */
+static bool idle_loop_body(const Cpu *c, uint32_t pc, uint32_t end)
+{
+	uint32_t written = 0;	// Registers written so far.
+	uint32_t live_in = 0;	// Registers read before being written.
+
+	while (pc < end) {
+		uint32_t op;
+		if (!idle_fetch16(c, pc, &op))
+			return false;
+		pc += 2;
+
+		const uint32_t mode = (op >> 3) & 7;
+		const uint32_t reg = (op & 7);
+		const uint32_t rx = (op >> 9) & 7;
+		const uint32_t szf = (op >> 6) & 3;
+		const int sz = (1 << szf);
+		uint32_t reads = 0, writes = 0;
+
+		switch (op >> 12) {
+			case 0x0:
+				if ((op & 0xFFC0) == 0x0800) {
+					// BTST #imm,<ea>
+					pc += 2;
+					if (!idle_ea(c, &pc, mode, reg, 1, &reads))
+						return false;
+				} else if ((op & 0xF1C0) == 0x0100 && mode != 1) {
+					// BTST Dn,<ea>
+					reads |= (1U << rx);
+					if (!idle_ea(c, &pc, mode, reg, 1, &reads))
+						return false;
+				} else if ((op & 0xFF00) == 0x0C00 && szf != 3) {
+					// CMPI #imm,<ea>
+					pc += (sz == 4 ? 4 : 2);
+					if (!idle_ea(c, &pc, mode, reg, sz, &reads))
+						return false;
+				} else if ((op & 0xFF38) == 0x0200 && szf != 3) {
+					// ANDI #imm,Dn
+					pc += (sz == 4 ? 4 : 2);
+					reads |= (1U << reg);
+					writes |= (1U << reg);
+				} else {
+					return false;
+				}
+				break;
+
+			case 0x1: case 0x2: case 0x3: {
+				// MOVE <ea>,Dn / MOVEA <ea>,An
+				const int msz = ((op >> 12) == 1 ? 1 : ((op >> 12) == 3 ? 2 : 4));
+				const uint32_t dmode = (op >> 6) & 7;
+				if (dmode == 0)
+					writes |= (1U << rx);
+				else if (dmode == 1 && msz != 1)
+					writes |= (1U << (8 + rx));
+				else
+					return false;
+				if (!idle_ea(c, &pc, mode, reg, msz, &reads))
+					return false;
+				break;
+			}
+
+			case 0x4:
+				if (op == 0x4E71) {
+					// NOP
+					break;
+				} else if ((op & 0xFF00) == 0x4A00 && szf != 3) {
+					// TST <ea>
+					if (!idle_ea(c, &pc, mode, reg, sz, &reads))
+						return false;
+				} else {
+					return false;
+				}
+				break;
+
+			case 0x7:
+				// MOVEQ #imm,Dn
+				if (op & 0x100)
+					return false;
+				writes |= (1U << rx);
+				break;
+
+			case 0xB: {
+				const uint32_t opmode = (op >> 6) & 7;
+				if (opmode <= 2) {
+					// CMP <ea>,Dn
+					reads |= (1U << rx);
+					if (!idle_ea(c, &pc, mode, reg, (1 << opmode), &reads))
+						return false;
+				} else if (opmode == 3 || opmode == 7) {
+					// CMPA <ea>,An
+					reads |= (1U << (8 + rx));
+					if (!idle_ea(c, &pc, mode, reg, (opmode == 3 ? 2 : 4), &reads))
+						return false;
+				} else {
+					// CMPM, EOR
+					return false;
+				}
+				break;
+			}
+
+			case 0xC: {
+				// AND <ea>,Dn
+				const uint32_t opmode = (op >> 6) & 7;
+				if (opmode > 2 || mode == 1)
+					return false;
+				reads |= (1U << rx);
+				writes |= (1U << rx);
+				if (!idle_ea(c, &pc, mode, reg, (1 << opmode), &reads))
+					return false;
+				break;
+			}
+
+			default:
+				return false;
+		}
+
+		live_in |= (reads & ~written);
+		if (writes & live_in)
+			return false;
+		written |= writes;
+	}
+
+	return (pc == end);
+}
+
+/**
+ * Check if a taken backward branch closes an idle loop.
+ * If it does, the rest of the timeslice is skipped.
+ * @param c CPU. (c->pc must be the branch target.)
+ * @param branch_pc Address of the branch instruction.
+ */
+static void idle_loop_check(Cpu *c, uint32_t branch_pc)
+{
+	if (c->sr_sys & MD68K_SR_T)
+		return;
+
+	branch_pc &= 0xFFFFFF;
+	uint32_t *const reject = &c->idle_reject[(branch_pc >> 1) & (ARRAY_SIZE(c->idle_reject) - 1)];
+	if (*reject == branch_pc + 1)
+		return;
+
+	if (!idle_loop_body(c, c->pc & 0xFFFFFF, branch_pc)) {
+		*reject = branch_pc + 1;
+		return;
+	}
+
+	// Idle loop. Nothing will change until the next timeslice.
+	c->cycles = 0;
+}
+
+/** Program control. **/
+
+static void op_bcc(Cpu *c, uint32_t op)
+{
+	const uint32_t base = c->pc;
+	uint32_t disp = sext<1>(op);
+	const bool word = (disp == 0);
+	if (word)
+		disp = sext<2>(fetch16(c));
+
+	const int cc = (op >> 8) & 15;
+	if (cc == 1) {
+		// BSR
+		push32(c, c->pc);
+		c->pc = base + disp;
+		c->cycles -= 18;
+	} else if (test_cc(c, cc)) {
+		c->pc = base + disp;
+		c->cycles -= 10;
+
+		// Short backward branches may be idle loops.
+		if (c->idle_detect && (int32_t)disp < 0 &&
+		    (int32_t)disp >= -MD68K_IDLE_LOOP_MAX_LEN)
+		{
+			idle_loop_check(c, base - 2);
+		}
+	} else {
+		c->cycles -= (word ? 12 : 8);
+	}
+}
+
+static void op_dbcc(Cpu *c, uint32_t op)
+{
+	if (test_cc(c, op >> 8)) {
+		c->pc += 2;
+		c->cycles -= 12;
+		return;
+	}
+
+	const int reg = (op & 7);
+	const uint32_t count = ((c->r[reg] - 1) & 0xFFFF);
+	set_dreg<2>(c, reg, count);
+	if (count != 0xFFFF) {
+		const uint32_t base = c->pc;
+		c->pc = base + sext<2>(fetch16(c));
+		c->cycles -= 10;
+	} else {
+		c->pc += 2;
+		c->cycles -= 14;
+	}
+}
+
+// JMP/JSR/LEA/PEA timing.
+static const uint8_t jmp_cycles[12] = {0, 0, 8, 0, 0, 10, 14, 10, 12, 10, 14, 0};
+static const uint8_t lea_cycles[12] = {0, 0, 4, 0, 0, 8, 12, 8, 12, 8, 12, 0};
+
+static void op_jmp(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	c->pc = ea_addr<4>(c, m, op & 7);
+	c->cycles -= jmp_cycles[m];
+}
+
+static void op_jsr(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	const uint32_t address = ea_addr<4>(c, m, op & 7);
+	push32(c, c->pc);
+	c->pc = address;
+	c->cycles -= jmp_cycles[m] + 8;
+}
+
+static void op_lea(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	c->r[8 + ((op >> 9) & 7)] = ea_addr<4>(c, m, op & 7);
+	c->cycles -= lea_cycles[m];
+}
+
+static void op_pea(Cpu *c, uint32_t op)
+{
+	const int m = EA_SRC(op);
+	push32(c, ea_addr<4>(c, m, op & 7));
+	c->cycles -= lea_cycles[m] + 8;
+}
+
+static void op_rts(Cpu *c, uint32_t op)
+{
+	((void)op);
+	c->pc = pop32(c);
+	c->cycles -= 16;
+}
+
+static void op_rtr(Cpu *c, uint32_t op)
+{
+	((void)op);
+	set_ccr(c, pop16(c));
+	c->pc = pop32(c);
+	c->cycles -= 20;
+}
+
+static void op_rte(Cpu *c, uint32_t op)
+{
+	((void)op);
+	if (!check_supervisor(c))
+		return;
+	const uint32_t sr = pop16(c);
+	c->pc = pop32(c);
+	set_sr(c, sr);
+	c->cycles -= 20;
+}
+
+static void op_link(Cpu *c, uint32_t op)
+{
+	const int reg = 8 + (op & 7);
+	const uint32_t disp = sext<2>(fetch16(c));
+	c->r[15] -= 4;
+	write32(c, c->r[15], c->r[reg]);
+	c->r[reg] = c->r[15];
+	c->r[15] += disp;
+	c->cycles -= 16;
+}
+
+static void op_unlk(Cpu *c, uint32_t op)
+{
+	const int reg = 8 + (op & 7);
+	const uint32_t v = read32(c, c->r[reg]);
+	c->r[15] = c->r[reg] + 4;
+	c->r[reg] = v;
+	c->cycles -= 12;
+}
+
+static void op_trap(Cpu *c, uint32_t op)
+{
+	exception(c, VEC_TRAP + (op & 15), 34);
+}
+
+static void op_trapv(Cpu *c, uint32_t op)
+{
+	((void)op);
+	if (c->flag_v)
+		exception(c, VEC_TRAPV, 34);
+	else
+		c->cycles -= 4;
+}
+
+static void op_nop(Cpu *c, uint32_t op)
+{
+	((void)op);
+	c->cycles -= 4;
+}
+
+static void op_reset(Cpu *c, uint32_t op)
+{
+	((void)op);
+	if (!check_supervisor(c))
+		return;
+	if (c->ctx.resethandler)
+		c->ctx.resethandler();
+	c->cycles -= 132;
+}
+
+static void op_stop(Cpu *c, uint32_t op)
+{
+	((void)op);
+	if (!check_supervisor(c))
+		return;
+	set_sr(c, fetch16(c));
+	c->cycles -= 4;
+
+	// Wait for an interrupt.
+	c->ctx.interrupts[0] |= MD68K_INT_STOPPED;
+	check_interrupts(c);
+	if ((c->ctx.interrupts[0] & MD68K_INT_STOPPED) && c->cycles > 0) {
+		// Forfeit all remaining cycles.
+		c->cycles = 0;
+	}
+}
+
+/** MOVEM. **/
+
+// MOVEM timing. (not including registers)
+static const uint8_t movem_re_cycles[12] = {0, 0, 8, 0, 8, 12, 14, 12, 16, 0, 0, 0};
+static const uint8_t movem_er_cycles[12] = {0, 0, 12, 12, 0, 16, 18, 16, 20, 16, 18, 0};
+
+/**
+ * MOVEM <list>,<ea>
+ */
+template<int SZ>
+static void op_movem_re(Cpu *c, uint32_t op)
+{
+	const uint32_t mask = fetch16(c);
+	const int m = EA_SRC(op);
+	const int reg = (op & 7);
+	int count = 0;
+
+	if (m == EA_PD) {
+		// Predecrement: mask is reversed. (bit 0 == A7)
+		// The initial value of An is written if it's in the list.
+		uint32_t address = c->r[8+reg];
+		for (int i = 0; i < 16; i++) {
+			if (mask & (1 << i)) {
+				address -= SZ;
+				wr<SZ>(c, address, c->r[15 - i]);
+				count++;
+			}
+		}
+		c->r[8+reg] = address;
+	} else {
+		uint32_t address = ea_addr<SZ>(c, m, reg);
+		for (int i = 0; i < 16; i++) {
+			if (mask & (1 << i)) {
+				wr<SZ>(c, address, c->r[i]);
+				address += SZ;
+				count++;
+			}
+		}
+	}
+
+	c->cycles -= movem_re_cycles[m] + (count * (SZ == 4 ? 8 : 4));
+}
+
+/**
+ * MOVEM <ea>,<list>
+ */
+template<int SZ>
+static void op_movem_er(Cpu *c, uint32_t op)
+{
+	const uint32_t mask = fetch16(c);
+	const int m = EA_SRC(op);
+	const int reg = (op & 7);
+	int count = 0;
+
+	uint32_t address = (m == EA_PI ? c->r[8+reg] : ea_addr<SZ>(c, m, reg));
+	for (int i = 0; i < 16; i++) {
+		if (mask & (1 << i)) {
+			// Words are sign-extended to 32 bits.
+			c->r[i] = sext<SZ>(rd<SZ>(c, address));
+			address += SZ;
+			count++;
+		}
+	}
+	if (m == EA_PI)
+		c->r[8+reg] = address;
+
+	c->cycles -= movem_er_cycles[m] + (count * (SZ == 4 ? 8 : 4));
+}
+
+/** ADDQ/SUBQ. **/
+
+template<int SZ, int OP>
+static void op_addq(Cpu *c, uint32_t op)
+{
+	uint32_t data = (op >> 9) & 7;
+	if (data == 0)
+		data = 8;
+	const int m = EA_SRC(op);
+
+	if (m == EA_AN) {
+		// Address register: always 32-bit, flags are not affected.
+		uint32_t *an = &c->r[8 + (op & 7)];
+		if (OP == OP_SUB)
+			*an -= data;
+		else
+			*an += data;
+		c->cycles -= 8;
+		return;
+	}
+
+	Operand o = {m, (int)(op & 7), 0};
+	const uint32_t dst = rmw_read<SZ>(c, &o);
+	rmw_write<SZ>(c, &o, alu<SZ, OP>(c, data, dst));
+
+	if (m == EA_DN)
+		c->cycles -= (SZ == 4 ? 8 : 4);
+	else
+		c->cycles -= (SZ == 4 ? 12 : 8) + ea_cycles<SZ>(m);
+}
+
+/** Opcode decoder. **/
+
+#define EAM(m)	(1U << (m))
+static const uint32_t EA_ALL = 0xFFF;
+static const uint32_t EA_DATA = (EA_ALL & ~EAM(EA_AN));
+static const uint32_t EA_ALTERABLE = (EAM(EA_DN) | EAM(EA_AN) | EAM(EA_AI) | EAM(EA_PI) |
+				       EAM(EA_PD) | EAM(EA_DI) | EAM(EA_IX) | EAM(EA_AW) | EAM(EA_AL));
+static const uint32_t EA_DATA_ALT = (EA_ALTERABLE & ~EAM(EA_AN));
+static const uint32_t EA_MEM_ALT = (EA_DATA_ALT & ~EAM(EA_DN));
+static const uint32_t EA_CONTROL = (EAM(EA_AI) | EAM(EA_DI) | EAM(EA_IX) | EAM(EA_AW) |
+				     EAM(EA_AL) | EAM(EA_PCDI) | EAM(EA_PCIX));
+
+// Select a handler by the standard size field. (0 == byte, 1 == word, 2 == long)
+#define SIZED(sz, b, w, l) \
+	((sz) == 0 ? (OpFn)(b) : ((sz) == 1 ? (OpFn)(w) : (OpFn)(l)))
+
+template<int OP>
+static OpFn decode_alu_ea_dn(int sz)
+{
+	return SIZED(sz, (op_alu_ea_dn<1, OP>), (op_alu_ea_dn<2, OP>), (op_alu_ea_dn<4, OP>));
+}
+
+template<int OP>
+static OpFn decode_alu_dn_ea(int sz)
+{
+	return SIZED(sz, (op_alu_dn_ea<1, OP>), (op_alu_dn_ea<2, OP>), (op_alu_dn_ea<4, OP>));
+}
+
+template<int OP>
+static OpFn decode_imm(int sz)
+{
+	return SIZED(sz, (op_imm<1, OP>), (op_imm<2, OP>), (op_imm<4, OP>));
+}
+
+template<int OP>
+static OpFn decode_unary(int sz)
+{
+	return SIZED(sz, (op_unary<1, OP>), (op_unary<2, OP>), (op_unary<4, OP>));
+}
+
+template<int OP>
+static OpFn decode_x(uint32_t op, int sz)
+{
+	if (op & 0x08)
+		return SIZED(sz, (op_x_mm<1, OP>), (op_x_mm<2, OP>), (op_x_mm<4, OP>));
+	return SIZED(sz, (op_x_rr<1, OP>), (op_x_rr<2, OP>), (op_x_rr<4, OP>));
+}
+
+template<int OP, bool LEFT>
+static OpFn decode_shift_reg(int sz)
+{
+	return SIZED(sz, (op_shift_reg<1, OP, LEFT>), (op_shift_reg<2, OP, LEFT>), (op_shift_reg<4, OP, LEFT>));
+}
+
+template<bool STATIC>
+static OpFn decode_bit(int type)
+{
+	switch (type) {
+		case 0:		return op_bit<BIT_TST, STATIC>;
+		case 1:		return op_bit<BIT_CHG, STATIC>;
+		case 2:		return op_bit<BIT_CLR, STATIC>;
+		default:	return op_bit<BIT_SET, STATIC>;
+	}
+}
+
+/**
+ * Decode line 0: Bit manipulation, MOVEP, immediate.
+ */
+static OpFn decode_0(uint32_t op, int sz, uint32_t eam)
+{
+	if (op & 0x100) {
+		if (((op >> 3) & 7) == 1) {
+			// MOVEP
+			switch (sz) {
+				case 0:		return op_movep<2, false>;
+				case 1:		return op_movep<4, false>;
+				case 2:		return op_movep<2, true>;
+				default:	return op_movep<4, true>;
+			}
+		}
+
+		// Dynamic bit operation.
+		if (eam & (sz == 0 ? EA_DATA : EA_DATA_ALT))
+			return decode_bit<false>(sz);
+		return op_illegal;
+	}
+
+	switch ((op >> 9) & 7) {
+		case 0:
+			if (op == 0x003C)
+				return op_imm_ccr<OP_OR>;
+			if (op == 0x007C)
+				return op_imm_sr<OP_OR>;
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_imm<OP_OR>(sz);
+			break;
+		case 1:
+			if (op == 0x023C)
+				return op_imm_ccr<OP_AND>;
+			if (op == 0x027C)
+				return op_imm_sr<OP_AND>;
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_imm<OP_AND>(sz);
+			break;
+		case 2:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_imm<OP_SUB>(sz);
+			break;
+		case 3:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_imm<OP_ADD>(sz);
+			break;
+		case 4:
+			// Static bit operation.
+			if (eam & (sz == 0 ? (EA_DATA & ~EAM(EA_IMM)) : EA_DATA_ALT))
+				return decode_bit<true>(sz);
+			break;
+		case 5:
+			if (op == 0x0A3C)
+				return op_imm_ccr<OP_EOR>;
+			if (op == 0x0A7C)
+				return op_imm_sr<OP_EOR>;
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_imm<OP_EOR>(sz);
+			break;
+		case 6:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_imm<OP_CMP>(sz);
+			break;
+		default:
+			break;
+	}
+
+	return op_illegal;
+}
+
+/**
+ * Decode lines 1-3: MOVE, MOVEA.
+ */
+static OpFn decode_move(uint32_t op, uint32_t eam)
+{
+	int sz;
+	switch ((op >> 12) & 3) {
+		case 1:		sz = 0; break;
+		case 3:		sz = 1; break;
+		default:	sz = 2; break;
+	}
+
+	if (!(eam & EA_ALL) || (sz == 0 && (eam & EAM(EA_AN))))
+		return op_illegal;
+
+	const int dm = ea_mode((op >> 6) & 7, (op >> 9) & 7);
+	if (dm == EA_AN) {
+		if (sz == 0)
+			return op_illegal;
+		return (sz == 1 ? (OpFn)op_movea<2> : (OpFn)op_movea<4>);
+	}
+
+	if (dm == EA_INVALID || !(EAM(dm) & EA_DATA_ALT))
+		return op_illegal;
+	return SIZED(sz, op_move<1>, op_move<2>, op_move<4>);
+}
+
+/**
+ * Decode line 4: Miscellaneous.
+ */
+static OpFn decode_4(uint32_t op, int sz, uint32_t eam)
+{
+	if (op & 0x100) {
+		if (sz == 3 && (eam & EA_CONTROL))
+			return op_lea;
+		if (sz == 2 && (eam & EA_DATA))
+			return op_chk;
+		return op_illegal;
+	}
+
+	const uint32_t mode = ((op >> 3) & 7);
+	switch ((op >> 8) & 0xF) {
+		case 0x0:
+			if (eam & EA_DATA_ALT)
+				return (sz < 3 ? decode_unary<UN_NEGX>(sz) : op_move_from_sr);
+			break;
+		case 0x2:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_unary<UN_CLR>(sz);
+			break;
+		case 0x4:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_unary<UN_NEG>(sz);
+			if (sz == 3 && (eam & EA_DATA))
+				return op_move_to_ccr;
+			break;
+		case 0x6:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return decode_unary<UN_NOT>(sz);
+			if (sz == 3 && (eam & EA_DATA))
+				return op_move_to_sr;
+			break;
+		case 0x8:
+			switch (sz) {
+				case 0:
+					if (eam & EA_DATA_ALT)
+						return op_nbcd;
+					break;
+				case 1:
+					if (mode == 0)
+						return op_swap;
+					if (eam & EA_CONTROL)
+						return op_pea;
+					break;
+				default:
+					if (mode == 0)
+						return (sz == 2 ? op_ext_w : op_ext_l);
+					if (eam & ((EA_CONTROL & EA_ALTERABLE) | EAM(EA_PD)))
+						return (sz == 2 ? (OpFn)op_movem_re<2> : (OpFn)op_movem_re<4>);
+					break;
+			}
+			break;
+		case 0xA:
+			if (sz < 3 && (eam & EA_DATA_ALT))
+				return SIZED(sz, op_tst<1>, op_tst<2>, op_tst<4>);
+			if (sz == 3 && op != 0x4AFC && (eam & EA_DATA_ALT))
+				return op_tas;
+			break;
+		case 0xC:
+			if (sz >= 2 && (eam & (EA_CONTROL | EAM(EA_PI))))
+				return (sz == 2 ? (OpFn)op_movem_er<2> : (OpFn)op_movem_er<4>);
+			break;
+		case 0xE:
+			if (sz == 1) {
+				switch ((op >> 3) & 7) {
+					case 0: case 1:
+						return op_trap;
+					case 2:
+						return op_link;
+					case 3:
+						return op_unlk;
+					case 4:
+						return op_move_to_usp;
+					case 5:
+						return op_move_from_usp;
+					default:
+						switch (op & 0xFFFF) {
+							case 0x4E70:	return op_reset;
+							case 0x4E71:	return op_nop;
+							case 0x4E72:	return op_stop;
+							case 0x4E73:	return op_rte;
+							case 0x4E75:	return op_rts;
+							case 0x4E76:	return op_trapv;
+							case 0x4E77:	return op_rtr;
+							default:	break;
+						}
+						break;
+				}
+			} else if (sz == 2 && (eam & EA_CONTROL)) {
+				return op_jsr;
+			} else if (sz == 3 && (eam & EA_CONTROL)) {
+				return op_jmp;
+			}
+			break;
+		default:
+			break;
+	}
+
+	return op_illegal;
+}
+
+/**
+ * Decode line 5: ADDQ, SUBQ, Scc, DBcc.
+ */
+static OpFn decode_5(uint32_t op, int sz, uint32_t eam)
+{
+	if (sz == 3) {
+		if (((op >> 3) & 7) == 1)
+			return op_dbcc;
+		if (eam & EA_DATA_ALT)
+			return op_scc;
+		return op_illegal;
+	}
+
+	if (!(eam & EA_ALTERABLE) || (sz == 0 && (eam & EAM(EA_AN))))
+		return op_illegal;
+	if (op & 0x100)
+		return SIZED(sz, (op_addq<1, OP_SUB>), (op_addq<2, OP_SUB>), (op_addq<4, OP_SUB>));
+	return SIZED(sz, (op_addq<1, OP_ADD>), (op_addq<2, OP_ADD>), (op_addq<4, OP_ADD>));
+}
+
+/**
+ * Decode lines 8 and C: OR/AND, DIVU/DIVS/MULU/MULS, SBCD/ABCD, EXG.
+ */
+template<int OP>
+static OpFn decode_8c(uint32_t op, uint32_t eam)
+{
+	const int opmode = (op >> 6) & 7;
+	const uint32_t mode = ((op >> 3) & 7);
+
+	switch (opmode) {
+		case 0: case 1: case 2:
+			if (eam & EA_DATA)
+				return decode_alu_ea_dn<OP>(opmode);
+			break;
+		case 3:
+			if (eam & EA_DATA)
+				return (OP == OP_OR ? op_divu : op_mulu);
+			break;
+		case 7:
+			if (eam & EA_DATA)
+				return (OP == OP_OR ? op_divs : op_muls);
+			break;
+		default:
+			if (mode <= 1) {
+				if (opmode == 4)
+					return (OP == OP_OR ? decode_x<XOP_SBCD>(op, 0) : decode_x<XOP_ABCD>(op, 0));
+				if (OP == OP_AND) {
+					if (opmode == 5)
+						return (mode == 0 ? op_exg_dd : op_exg_aa);
+					if (opmode == 6 && mode == 1)
+						return op_exg_da;
+				}
+				break;
+			}
+			if (eam & EA_MEM_ALT)
+				return decode_alu_dn_ea<OP>(opmode - 4);
+			break;
+	}
+
+	return op_illegal;
+}
+
+/**
+ * Decode lines 9 and D: SUB/ADD, SUBA/ADDA, SUBX/ADDX.
+ */
+template<int OP>
+static OpFn decode_9d(uint32_t op, uint32_t eam)
+{
+	const int opmode = (op >> 6) & 7;
+
+	switch (opmode) {
+		case 0: case 1: case 2:
+			if (!(eam & EA_ALL) || (opmode == 0 && (eam & EAM(EA_AN))))
+				break;
+			return decode_alu_ea_dn<OP>(opmode);
+		case 3:
+			if (eam & EA_ALL)
+				return op_adda<2, OP>;
+			break;
+		case 7:
+			if (eam & EA_ALL)
+				return op_adda<4, OP>;
+			break;
+		default:
+			if (((op >> 3) & 7) <= 1)
+				return (OP == OP_ADD ? decode_x<XOP_ADDX>(op, opmode - 4) : decode_x<XOP_SUBX>(op, opmode - 4));
+			if (eam & EA_MEM_ALT)
+				return decode_alu_dn_ea<OP>(opmode - 4);
+			break;
+	}
+
+	return op_illegal;
+}
+
+/**
+ * Decode line B: CMP, CMPA, CMPM, EOR.
+ */
+static OpFn decode_b(uint32_t op, uint32_t eam)
+{
+	const int opmode = (op >> 6) & 7;
+
+	switch (opmode) {
+		case 0: case 1: case 2:
+			if (!(eam & EA_ALL) || (opmode == 0 && (eam & EAM(EA_AN))))
+				break;
+			return decode_alu_ea_dn<OP_CMP>(opmode);
+		case 3:
+			if (eam & EA_ALL)
+				return op_cmpa<2>;
+			break;
+		case 7:
+			if (eam & EA_ALL)
+				return op_cmpa<4>;
+			break;
+		default:
+			if (((op >> 3) & 7) == 1)
+				return SIZED(opmode - 4, op_cmpm<1>, op_cmpm<2>, op_cmpm<4>);
+			if (eam & EA_DATA_ALT)
+				return decode_alu_dn_ea<OP_EOR>(opmode - 4);
+			break;
+	}
+
+	return op_illegal;
+}
+
+/**
+ * Decode line E: Shifts and rotates.
+ */
+static OpFn decode_e(uint32_t op, int sz, uint32_t eam)
+{
+	const bool left = !!(op & 0x100);
+
+	if (sz == 3) {
+		// Memory shift.
+		if ((op & 0x800) || !(eam & EA_MEM_ALT))
+			return op_illegal;
+		switch ((op >> 9) & 3) {
+			case 0:		return (left ? op_shift_mem<SH_AS, true> : op_shift_mem<SH_AS, false>);
+			case 1:		return (left ? op_shift_mem<SH_LS, true> : op_shift_mem<SH_LS, false>);
+			case 2:		return (left ? op_shift_mem<SH_ROX, true> : op_shift_mem<SH_ROX, false>);
+			default:	return (left ? op_shift_mem<SH_RO, true> : op_shift_mem<SH_RO, false>);
+		}
+	}
+
+	// Register shift.
+	switch ((op >> 3) & 3) {
+		case 0:		return (left ? decode_shift_reg<SH_AS, true>(sz) : decode_shift_reg<SH_AS, false>(sz));
+		case 1:		return (left ? decode_shift_reg<SH_LS, true>(sz) : decode_shift_reg<SH_LS, false>(sz));
+		case 2:		return (left ? decode_shift_reg<SH_ROX, true>(sz) : decode_shift_reg<SH_ROX, false>(sz));
+		default:	return (left ? decode_shift_reg<SH_RO, true>(sz) : decode_shift_reg<SH_RO, false>(sz));
+	}
+}
+
+/**
+ * Decode an opcode.
+ * @param op Opcode.
+ * @return Handler.
+ */
+static OpFn decode(uint32_t op)
+{
+	const int sz = (op >> 6) & 3;
+	const int m = EA_SRC(op);
+	const uint32_t eam = (m != EA_INVALID ? EAM(m) : 0);
+
+	switch (op >> 12) {
+		case 0x0:	return decode_0(op, sz, eam);
+		case 0x1: case 0x2: case 0x3:
+				return decode_move(op, eam);
+		case 0x4:	return decode_4(op, sz, eam);
+		case 0x5:	return decode_5(op, sz, eam);
+		case 0x6:	return op_bcc;
+		case 0x7:	return ((op & 0x100) ? op_illegal : op_moveq);
+		case 0x8:	return decode_8c<OP_OR>(op, eam);
+		case 0x9:	return decode_9d<OP_SUB>(op, eam);
+		case 0xA:	return op_line_a;
+		case 0xB:	return decode_b(op, eam);
+		case 0xC:	return decode_8c<OP_AND>(op, eam);
+		case 0xD:	return decode_9d<OP_ADD>(op, eam);
+		case 0xE:	return decode_e(op, sz, eam);
+		default:	return op_line_f;
+	}
+}
+
+/**
+ * Build the opcode table.
+ */
+void BuildOpTable(void)
+{
+	for (uint32_t op = 0; op < 0x10000; op++) {
+		OpTable[op] = decode(op);
+	}
+}
+
+}
@@ -0,0 +1,252 @@
+/***************************************************************************
+ * md68k: Portable 68000 CPU emulator.                                     *
+ * md68k_p.hpp: Private definitions.                                       *
+ *                                                                         *
+ * Copyright (c) 2008-2015 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __MD68K_MD68K_P_HPP__
+#define __MD68K_MD68K_P_HPP__
+
+#include "md68k.h"
+
+// C includes.
+#include <stdint.h>
+
+// Byteswapping macros.
+#include "libcompat/byteswap.h"
+#include "macros/common.h"
+
+namespace Md68k {
+
+// Data region handler prototypes.
+typedef uint8_t  (*ReadByteFn)(uint32_t address);
+typedef uint16_t (*ReadWordFn)(uint32_t address);
+typedef void     (*WriteByteFn)(uint32_t address, uint8_t data);
+typedef void     (*WriteWordFn)(uint32_t address, uint16_t data);
+
+/**
+ * Data page.
+ * The 24-bit address space is split into 256 pages of 64 KB.
+ * - base != nullptr: Page is directly mapped. (host = base + (address & 0xFFFF))
+ * - handler != nullptr: Page is handled by a memory callback.
+ * - Both nullptr: Page is partially mapped or unmapped.
+ *   The region array has to be scanned.
+ */
+struct DataPage {
+	uint8_t *base;
+	void *handler;
+};
+
+// Status register bits.
+#define MD68K_SR_T	0x8000
+#define MD68K_SR_S	0x2000
+#define MD68K_SR_IPL	0x0700
+#define MD68K_SR_MASK	0xA71F
+
+// Starscream status bits in interrupts[0].
+#define MD68K_INT_LEVEL		0x07
+#define MD68K_INT_STOPPED	0x10
+
+// Exception vectors.
+enum Vector {
+	VEC_ILLEGAL	= 4,
+	VEC_ZERO_DIVIDE	= 5,
+	VEC_CHK		= 6,
+	VEC_TRAPV	= 7,
+	VEC_PRIVILEGE	= 8,
+	VEC_TRACE	= 9,
+	VEC_LINE_A	= 10,
+	VEC_LINE_F	= 11,
+	VEC_AUTOVECTOR	= 24,
+	VEC_TRAP	= 32,
+};
+
+/**
+ * CPU state.
+ * While main68k_exec() is running, the registers are stored here.
+ * Otherwise, ctx is authoritative.
+ */
+struct Cpu {
+	// Starscream-compatible context.
+	S68000CONTEXT ctx;
+
+	// Data and address registers. (D0-D7, A0-A7)
+	uint32_t r[16];
+	uint32_t asp;	// Inactive stack pointer.
+	uint32_t pc;
+
+	// System byte of SR. (T, S, IPL)
+	uint32_t sr_sys;
+	// Condition codes. (0 or 1)
+	uint32_t flag_x, flag_n, flag_z, flag_v, flag_c;
+
+	// Cycle counters.
+	int cycles;		// Cycles remaining in this timeslice.
+	int cycles_target;	// Cycles requested for this timeslice.
+	bool running;		// True if main68k_exec() is running.
+
+	// Idle loop detection.
+	// idle_reject[] caches branches that aren't idle loops.
+	// (Index: (PC >> 1) & 15; value: PC + 1, or 0 if empty.)
+	bool idle_detect;
+	uint32_t idle_reject[16];
+
+	// Page tables.
+	const uint8_t *fetch[256];
+	DataPage readbyte[256];
+	DataPage readword[256];
+	DataPage writebyte[256];
+	DataPage writeword[256];
+};
+
+typedef void (*OpFn)(Cpu *cpu, uint32_t op);
+
+// Opcode table. (md68k_ops.cpp)
+extern OpFn OpTable[0x10000];
+void BuildOpTable(void);
+
+// Maximum idle loop length, in bytes, including the branch.
+#define MD68K_IDLE_LOOP_MAX_LEN 32
+
+// Current CPU instance. (md68k.cpp)
+// Bound per thread by main68k_bindState().
+extern THREAD_LOCAL Cpu *cpu;
+
+/** Slow paths. (md68k.cpp) **/
+uint16_t fetch16_slow(Cpu *c, uint32_t address);
+uint8_t read8_slow(Cpu *c, uint32_t address);
+uint16_t read16_slow(Cpu *c, uint32_t address);
+void write8_slow(Cpu *c, uint32_t address, uint8_t data);
+void write16_slow(Cpu *c, uint32_t address, uint16_t data);
+
+/** Memory access. **/
+
+static inline uint8_t read8(Cpu *c, uint32_t address)
+{
+	address &= 0xFFFFFF;
+	const DataPage *page = &c->readbyte[address >> 16];
+	if (page->base)
+		return page->base[(address & 0xFFFF) ^ U16DATA_U8_INVERT];
+	return read8_slow(c, address);
+}
+
+static inline uint16_t read16(Cpu *c, uint32_t address)
+{
+	address &= 0xFFFFFE;
+	const DataPage *page = &c->readword[address >> 16];
+	if (page->base)
+		return *(const uint16_t*)(page->base + (address & 0xFFFF));
+	return read16_slow(c, address);
+}
+
+static inline uint32_t read32(Cpu *c, uint32_t address)
+{
+	const uint32_t hi = read16(c, address);
+	return (hi << 16) | read16(c, address + 2);
+}
+
+static inline void write8(Cpu *c, uint32_t address, uint8_t data)
+{
+	address &= 0xFFFFFF;
+	const DataPage *page = &c->writebyte[address >> 16];
+	if (page->base)
+		page->base[(address & 0xFFFF) ^ U16DATA_U8_INVERT] = data;
+	else
+		write8_slow(c, address, data);
+}
+
+static inline void write16(Cpu *c, uint32_t address, uint16_t data)
+{
+	address &= 0xFFFFFE;
+	const DataPage *page = &c->writeword[address >> 16];
+	if (page->base)
+		*(uint16_t*)(page->base + (address & 0xFFFF)) = data;
+	else
+		write16_slow(c, address, data);
+}
+
+static inline void write32(Cpu *c, uint32_t address, uint32_t data)
+{
+	write16(c, address, (uint16_t)(data >> 16));
+	write16(c, address + 2, (uint16_t)data);
+}
+
+/**
+ * Fetch a word from the program counter.
+ * @param c CPU.
+ * @return Word.
+ */
+static inline uint16_t fetch16(Cpu *c)
+{
+	const uint32_t address = (c->pc & 0xFFFFFE);
+	c->pc += 2;
+	const uint8_t *page = c->fetch[address >> 16];
+	if (page)
+		return *(const uint16_t*)(page + (address & 0xFFFF));
+	return fetch16_slow(c, address);
+}
+
+static inline uint32_t fetch32(Cpu *c)
+{
+	const uint32_t hi = fetch16(c);
+	return (hi << 16) | fetch16(c);
+}
+
+/** Status register. **/
+
+static inline uint16_t get_sr(const Cpu *c)
+{
+	return (uint16_t)(c->sr_sys |
+		(c->flag_x << 4) | (c->flag_n << 3) |
+		(c->flag_z << 2) | (c->flag_v << 1) | c->flag_c);
+}
+
+static inline void set_ccr(Cpu *c, uint32_t ccr)
+{
+	c->flag_x = (ccr >> 4) & 1;
+	c->flag_n = (ccr >> 3) & 1;
+	c->flag_z = (ccr >> 2) & 1;
+	c->flag_v = (ccr >> 1) & 1;
+	c->flag_c = ccr & 1;
+}
+
+/**
+ * Set the status register.
+ * Swaps the stack pointers if the S bit changes.
+ * @param c CPU.
+ * @param sr New SR.
+ */
+static inline void set_sr(Cpu *c, uint32_t sr)
+{
+	sr &= MD68K_SR_MASK;
+	if ((sr ^ c->sr_sys) & MD68K_SR_S) {
+		const uint32_t tmp = c->r[15];
+		c->r[15] = c->asp;
+		c->asp = tmp;
+	}
+	c->sr_sys = (sr & 0xFF00);
+	set_ccr(c, sr);
+}
+
+/** Exceptions. (md68k.cpp) **/
+void exception(Cpu *c, int vector, int cycles);
+void check_interrupts(Cpu *c);
+
+}
+
+#endif /* __MD68K_MD68K_P_HPP__ */
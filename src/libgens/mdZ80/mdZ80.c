@@ -156,6 +156,23 @@ unsigned int mdZ80_read_odo(mdZ80_context *z80)
 }
 
 
+/**
+ * mdZ80_read_odo_exec(): Read the Z80 odometer during z80_Exec().
+ * This includes the cycles executed so far in the current timeslice,
+ * up to the start of the current instruction.
+ * Intended for use by memory and I/O handlers. [portable core only]
+ * @param z80 Pointer to Z80 context.
+ * @return Z80 odometer, or -1 if z80_Exec() isn't running.
+ */
+unsigned int mdZ80_read_odo_exec(mdZ80_context *z80)
+{
+	if (!(z80->Status & Z80_STATE_RUNNING))
+		return -1;
+
+	return (z80->CycleCnt + (z80->CycleTD - z80->CycleLeft) - z80->CycleIO);
+}
+
+
 /**
  * mdZ80_set_odo(): Set the Z80 odometer.
  * @param z80 Pointer to Z80 context.
@@ -319,7 +336,8 @@ void mdZ80_Set_Out(mdZ80_context *z80, Z80_WB *func)
 
 /**
  * mdZ80_Add_Fetch(): Add an instruction fetch handler.
- * TODO: Convert instruction fetch to use standard memory read.
+ * The portable core also uses fetch regions for data reads,
+ * so they must map memory that can be read without side effects.
  * @param z80 Z80 context.
  * @param low_adr Low page.
  * @param high_adr High page.
@@ -329,6 +347,8 @@ void mdZ80_Add_Fetch(mdZ80_context *z80, uint8_t low_adr, uint8_t high_adr, uint
 {
 	int i;
 	region -= (low_adr << 8);
-	for (i = low_adr; i <= high_adr; i++)
+	for (i = low_adr; i <= high_adr; i++) {
 		z80->Fetch[i] = region;
+		z80->Read[i] = region;
+	}
 }
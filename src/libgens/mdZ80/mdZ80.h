@@ -62,6 +62,7 @@ void mdZ80_Add_Fetch(mdZ80_context *z80, uint8_t low_adr, uint8_t high_adr, uint
 
 /*! Odometer (clock cycle) functions. **/
 unsigned int mdZ80_read_odo(mdZ80_context *z80);
+unsigned int mdZ80_read_odo_exec(mdZ80_context *z80);
 void mdZ80_clear_odo(mdZ80_context *z80);
 void mdZ80_set_odo(mdZ80_context *z80, unsigned int odo);
 void mdZ80_add_cycles(mdZ80_context *z80, uint32_t cycles);
@@ -26,6 +26,8 @@
 #ifndef __MDZ80_CONTEXT_H__
 #define __MDZ80_CONTEXT_H__
 
+#include "../../libcompat/byteorder.h"
+
 /****************************/
 /* Structures & definitions */
 /****************************/
@@ -52,8 +54,13 @@ struct _mdZ80_context
 	{
 		struct
 		{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			uint8_t C;
 			uint8_t B;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			uint8_t B;
+			uint8_t C;
+#endif
 		} b;
 		uint16_t w;
 	} BC;
@@ -61,8 +68,13 @@ struct _mdZ80_context
 	{
 		struct
 		{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			uint8_t E;
 			uint8_t D;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			uint8_t D;
+			uint8_t E;
+#endif
 		} b;
 		uint16_t w;
 	} DE;
@@ -70,8 +82,13 @@ struct _mdZ80_context
 	{
 		struct
 		{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			uint8_t L;
 			uint8_t H;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			uint8_t H;
+			uint8_t L;
+#endif
 		} b;
 		uint16_t w;
 	} HL;
@@ -79,8 +96,13 @@ struct _mdZ80_context
 	{
 		struct
 		{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			uint8_t IXL;
 			uint8_t IXH;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			uint8_t IXH;
+			uint8_t IXL;
+#endif
 		} b;
 		uint16_t w;
 	} IX;
@@ -88,21 +110,31 @@ struct _mdZ80_context
 	{
 		struct
 		{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			uint8_t IYL;
 			uint8_t IYH;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			uint8_t IYH;
+			uint8_t IYL;
+#endif
 		} b;
 		uint16_t w;
 	} IY;
-	uint16_t reserved_reg;	// Reserved for struct alignment.
+	uint16_t WZ;	// Internal register. (MEMPTR) [portable core only]
 	
-	uint32_t PC;	// PC == BasePC + Z80 PC [x86 pointer!]
+	uintptr_t PC;	// PC == BasePC + Z80 PC [host pointer!]
 	
 	union
 	{
 		struct
 		{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			uint8_t SPL;
 			uint8_t SPH;
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+			uint8_t SPH;
+			uint8_t SPL;
+#endif
 		} b;
 		uint16_t w;
 	} SP;
@@ -143,7 +175,7 @@ struct _mdZ80_context
 	uint8_t Status;
 	uint8_t reserved_stat;	// Reserved for struct alignment.
 	
-	uint32_t BasePC;	// Pointer to x86 memory location where Z80 RAM starts.
+	uintptr_t BasePC;	// Pointer to host memory location where Z80 RAM starts.
 	
 	uint32_t CycleCnt;
 	uint32_t CycleTD;
@@ -156,6 +188,15 @@ struct _mdZ80_context
 	
 	Z80_RB *IN_C;
 	Z80_WB *OUT_C;
+
+	// Direct data read pages. [portable core only]
+	// Set by mdZ80_Add_Fetch(). NULL pages are read using ReadB.
+	uint8_t *Read[0x100];
+
+	// Cycles remaining in the current z80_Exec() timeslice
+	// at the start of the current instruction. [portable core only]
+	// Updated before any memory or I/O handlers are called.
+	uint32_t CycleLeft;
 };
 
 #endif /* __MDZ80_CONTEXT_H__ */
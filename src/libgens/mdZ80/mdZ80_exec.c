@@ -0,0 +1,1288 @@
+/***************************************************************************
+ * mdZ80: Gens Z80 Emulator                                                *
+ * mdZ80_exec.c: Portable Z80 execution loop.                              *
+ *                                                                         *
+ * Copyright (c) 1999-2002 by Stéphane Dallongeville                       *
+ * Copyright (c) 2003-2004 by Stéphane Akhoun                              *
+ * Copyright (c) 2008-2015 by David Korth                                  *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * Portable replacement for z80_Exec() in mdZ80_x86.asm.
+ *
+ * Differences from the assembly core:
+ * - The X and Y flags are stored in F while running.
+ *   On exit, F is copied to FXY so mdZ80_get_AF() works unchanged.
+ * - PC is stored as a 16-bit value while running, so programs
+ *   can't run past the end of a fetch region.
+ * - Data reads use the fetch regions (see mdZ80_Add_Fetch())
+ *   instead of accessing Ram_Z80[] directly.
+ * - Interrupts are checked before every instruction, not just
+ *   on entry and after EI.
+ * - WZ (MEMPTR) and R are emulated.
+ */
+
+#include "mdZ80.h"
+
+// C includes.
+#include <stddef.h>
+
+// Z80 context definition.
+#include "mdZ80_context.h"
+
+// Z80 flag and state definitions.
+#include "mdZ80_flags.h"
+
+// Flag shorthand.
+#define FLAG_C	Z80_FLAG_C
+#define FLAG_N	Z80_FLAG_N
+#define FLAG_P	Z80_FLAG_P
+#define FLAG_X	Z80_FLAG_X
+#define FLAG_H	Z80_FLAG_H
+#define FLAG_Y	Z80_FLAG_Y
+#define FLAG_Z	Z80_FLAG_Z
+#define FLAG_S	Z80_FLAG_S
+#define FLAG_XY	(FLAG_X | FLAG_Y)
+
+// Register shorthand.
+#define zA	(z80->AF.b.A)
+#define zF	(z80->AF.b.F)
+#define zB	(z80->BC.b.B)
+#define zC	(z80->BC.b.C)
+#define zBC	(z80->BC.w)
+#define zDE	(z80->DE.w)
+#define zHL	(z80->HL.w)
+#define zSP	(z80->SP.w)
+#define zWZ	(z80->WZ)
+
+// Flag lookup tables.
+// SZXY[]: S, Z, X, and Y flags for a result.
+// SZXYP[]: SZXY[] plus parity.
+static uint8_t SZXY[256];
+static uint8_t SZXYP[256];
+static int tables_init = 0;
+
+/**
+ * Initialize the flag lookup tables.
+ */
+static void init_tables(void)
+{
+	int i;
+	for (i = 0; i < 256; i++) {
+		int p = i;
+		p ^= (p >> 4);
+		p ^= (p >> 2);
+		p ^= (p >> 1);
+
+		SZXY[i] = (i & (FLAG_S | FLAG_XY));
+		if (i == 0)
+			SZXY[i] |= FLAG_Z;
+		SZXYP[i] = SZXY[i] | ((p & 1) ? 0 : FLAG_P);
+	}
+	tables_init = 1;
+}
+
+/** Memory access. **/
+
+static inline uint8_t read_byte(mdZ80_context *z80, uint16_t adr)
+{
+	const uint8_t *page = z80->Read[adr >> 8];
+	if (page)
+		return page[adr];
+	return z80->ReadB(adr);
+}
+
+static inline uint16_t read_word(mdZ80_context *z80, uint16_t adr)
+{
+	const uint8_t lo = read_byte(z80, adr);
+	return (lo | (read_byte(z80, (uint16_t)(adr + 1)) << 8));
+}
+
+static inline void write_word(mdZ80_context *z80, uint16_t adr, uint16_t data)
+{
+	z80->WriteB(adr, (data & 0xFF));
+	z80->WriteB((uint16_t)(adr + 1), (data >> 8));
+}
+
+static inline uint8_t fetch_byte(mdZ80_context *z80, uint16_t *pc)
+{
+	const uint16_t adr = (*pc)++;
+	return z80->Fetch[adr >> 8][adr];
+}
+
+static inline uint16_t fetch_word(mdZ80_context *z80, uint16_t *pc)
+{
+	const uint8_t lo = fetch_byte(z80, pc);
+	return (lo | (fetch_byte(z80, pc) << 8));
+}
+
+static inline void push_word(mdZ80_context *z80, uint16_t data)
+{
+	zSP--;
+	z80->WriteB(zSP, (data >> 8));
+	zSP--;
+	z80->WriteB(zSP, (data & 0xFF));
+}
+
+static inline uint16_t pop_word(mdZ80_context *z80)
+{
+	const uint16_t data = read_word(z80, zSP);
+	zSP += 2;
+	return data;
+}
+
+#define RB(adr)		read_byte(z80, (uint16_t)(adr))
+#define WB(adr, data)	z80->WriteB((uint16_t)(adr), (uint8_t)(data))
+#define RW(adr)		read_word(z80, (uint16_t)(adr))
+#define WW(adr, data)	write_word(z80, (uint16_t)(adr), (uint16_t)(data))
+#define FETCH8()	fetch_byte(z80, &pc)
+#define FETCH16()	fetch_word(z80, &pc)
+#define PUSH(data)	push_word(z80, (uint16_t)(data))
+#define POP()		pop_word(z80)
+
+// Increment the refresh register. (Bit 7 is preserved.)
+#define INC_R()		(z80->R = ((z80->R & 0x80) | ((z80->R + 1) & 0x7F)))
+
+/** Arithmetic. **/
+
+/**
+ * 8-bit ALU operation on A.
+ * @param z80 Z80 context.
+ * @param op Operation. (0 == ADD, 1 == ADC, 2 == SUB, 3 == SBC, 4 == AND, 5 == XOR, 6 == OR, 7 == CP)
+ * @param v Operand.
+ */
+static inline void do_alu(mdZ80_context *z80, int op, uint8_t v)
+{
+	const unsigned int a = zA;
+	unsigned int r;
+
+	switch (op) {
+		case 0: case 1:
+			// ADD, ADC
+			r = a + v + ((op == 1) ? (zF & FLAG_C) : 0);
+			zF = SZXY[r & 0xFF] | ((r >> 8) & FLAG_C) |
+				((a ^ v ^ r) & FLAG_H) |
+				(((a ^ r) & (v ^ r) & 0x80) >> 5);
+			zA = (uint8_t)r;
+			break;
+		case 2: case 3: case 7:
+			// SUB, SBC, CP
+			r = a - v - ((op == 3) ? (zF & FLAG_C) : 0);
+			zF = (SZXY[r & 0xFF] & ~FLAG_XY) | FLAG_N |
+				((r >> 8) & FLAG_C) |
+				((a ^ v ^ r) & FLAG_H) |
+				(((a ^ v) & (a ^ r) & 0x80) >> 5);
+			if (op == 7) {
+				// CP takes X and Y from the operand.
+				zF |= (v & FLAG_XY);
+			} else {
+				zF |= (r & FLAG_XY);
+				zA = (uint8_t)r;
+			}
+			break;
+		case 4:
+			// AND
+			zA &= v;
+			zF = SZXYP[zA] | FLAG_H;
+			break;
+		case 5:
+			// XOR
+			zA ^= v;
+			zF = SZXYP[zA];
+			break;
+		default:
+			// OR
+			zA |= v;
+			zF = SZXYP[zA];
+			break;
+	}
+}
+
+static inline uint8_t do_inc(mdZ80_context *z80, uint8_t v)
+{
+	const uint8_t r = v + 1;
+	zF = (zF & FLAG_C) | SZXY[r] |
+		((r & 0x0F) ? 0 : FLAG_H) |
+		((r == 0x80) ? FLAG_P : 0);
+	return r;
+}
+
+static inline uint8_t do_dec(mdZ80_context *z80, uint8_t v)
+{
+	const uint8_t r = v - 1;
+	zF = (zF & FLAG_C) | SZXY[r] | FLAG_N |
+		((v & 0x0F) ? 0 : FLAG_H) |
+		((r == 0x7F) ? FLAG_P : 0);
+	return r;
+}
+
+/**
+ * CB-prefixed rotate/shift.
+ * @param z80 Z80 context.
+ * @param op Operation. (RLC, RRC, RL, RR, SLA, SRA, SLL, SRL)
+ * @param v Operand.
+ * @return Result.
+ */
+static inline uint8_t do_rot(mdZ80_context *z80, int op, uint8_t v)
+{
+	uint8_t r, c;
+	switch (op) {
+		case 0:	c = v >> 7; r = (v << 1) | c; break;			// RLC
+		case 1:	c = v & 1; r = (v >> 1) | (c << 7); break;		// RRC
+		case 2:	c = v >> 7; r = (v << 1) | (zF & FLAG_C); break;	// RL
+		case 3:	c = v & 1; r = (v >> 1) | ((zF & FLAG_C) << 7); break;	// RR
+		case 4:	c = v >> 7; r = (v << 1); break;			// SLA
+		case 5:	c = v & 1; r = (v >> 1) | (v & 0x80); break;		// SRA
+		case 6:	c = v >> 7; r = (v << 1) | 1; break;			// SLL
+		default: c = v & 1; r = (v >> 1); break;			// SRL
+	}
+	zF = SZXYP[r] | c;
+	return r;
+}
+
+/**
+ * BIT b,x.
+ * @param z80 Z80 context.
+ * @param bit Bit number.
+ * @param v Operand.
+ * @param xy Source of the X and Y flags.
+ */
+static inline void do_bit(mdZ80_context *z80, int bit, uint8_t v, uint8_t xy)
+{
+	const uint8_t t = v & (1 << bit);
+	zF = (zF & FLAG_C) | FLAG_H | (t & FLAG_S) |
+		(t ? 0 : (FLAG_Z | FLAG_P)) | (xy & FLAG_XY);
+}
+
+static inline uint16_t do_add16(mdZ80_context *z80, uint16_t a, uint16_t b)
+{
+	const unsigned int r = a + b;
+	zWZ = a + 1;
+	zF = (zF & (FLAG_S | FLAG_Z | FLAG_P)) |
+		((r >> 16) & FLAG_C) |
+		(((a ^ b ^ r) >> 8) & FLAG_H) |
+		((r >> 8) & FLAG_XY);
+	return (uint16_t)r;
+}
+
+static inline void do_adc16(mdZ80_context *z80, uint16_t b)
+{
+	const unsigned int a = zHL;
+	const unsigned int r = a + b + (zF & FLAG_C);
+	zWZ = a + 1;
+	zF = ((r >> 8) & (FLAG_S | FLAG_XY)) |
+		((r & 0xFFFF) ? 0 : FLAG_Z) |
+		((r >> 16) & FLAG_C) |
+		(((a ^ b ^ r) >> 8) & FLAG_H) |
+		(((a ^ r) & (b ^ r) & 0x8000) >> 13);
+	zHL = (uint16_t)r;
+}
+
+static inline void do_sbc16(mdZ80_context *z80, uint16_t b)
+{
+	const unsigned int a = zHL;
+	const unsigned int r = a - b - (zF & FLAG_C);
+	zWZ = a + 1;
+	zF = ((r >> 8) & (FLAG_S | FLAG_XY)) | FLAG_N |
+		((r & 0xFFFF) ? 0 : FLAG_Z) |
+		((r >> 16) & FLAG_C) |
+		(((a ^ b ^ r) >> 8) & FLAG_H) |
+		(((a ^ b) & (a ^ r) & 0x8000) >> 13);
+	zHL = (uint16_t)r;
+}
+
+static inline void do_daa(mdZ80_context *z80)
+{
+	const uint8_t a = zA;
+	uint8_t diff = 0;
+	uint8_t f = (zF & FLAG_N);
+
+	if ((zF & FLAG_H) || (a & 0x0F) > 9)
+		diff |= 0x06;
+	if ((zF & FLAG_C) || a > 0x99) {
+		diff |= 0x60;
+		f |= FLAG_C;
+	}
+
+	if (zF & FLAG_N) {
+		zA = a - diff;
+		if ((zF & FLAG_H) && (a & 0x0F) < 6)
+			f |= FLAG_H;
+	} else {
+		zA = a + diff;
+		if ((a & 0x0F) > 9)
+			f |= FLAG_H;
+	}
+
+	zF = f | SZXYP[zA];
+}
+
+/**
+ * Check a condition code.
+ * @param f Flags.
+ * @param cc Condition code. (NZ, Z, NC, C, PO, PE, P, M)
+ * @return Non-zero if the condition is true.
+ */
+static inline int test_cc(uint8_t f, int cc)
+{
+	static const uint8_t cc_mask[4] = {FLAG_Z, FLAG_C, FLAG_P, FLAG_S};
+	return (!(f & cc_mask[cc >> 1]) == !(cc & 1));
+}
+
+/** Block instructions. **/
+
+static inline void do_ldx(mdZ80_context *z80, int inc)
+{
+	const uint8_t v = RB(zHL);
+	uint8_t n;
+	WB(zDE, v);
+	zHL += inc;
+	zDE += inc;
+	zBC--;
+
+	n = v + zA;
+	zF = (zF & (FLAG_S | FLAG_Z | FLAG_C)) |
+		(zBC ? FLAG_P : 0) |
+		(n & FLAG_X) | ((n << 4) & FLAG_Y);
+}
+
+/**
+ * CPI/CPD.
+ * @return Non-zero if the comparison was equal.
+ */
+static inline int do_cpx(mdZ80_context *z80, int inc)
+{
+	const uint8_t v = RB(zHL);
+	uint8_t r = zA - v;
+	const uint8_t h = ((zA ^ v ^ r) & FLAG_H);
+	zHL += inc;
+	zBC--;
+	zWZ += inc;
+
+	zF = (zF & FLAG_C) | FLAG_N | (SZXY[r] & ~FLAG_XY) | h |
+		(zBC ? FLAG_P : 0);
+	if (h)
+		r--;
+	zF |= (r & FLAG_X) | ((r << 4) & FLAG_Y);
+	return (zA == v);
+}
+
+static inline void do_inx(mdZ80_context *z80, int inc)
+{
+	const uint8_t v = z80->IN_C(zBC);
+	unsigned int k;
+	zWZ = zBC + inc;
+	WB(zHL, v);
+	zB--;
+	zHL += inc;
+
+	k = v + ((zC + inc) & 0xFF);
+	zF = SZXY[zB] | ((v & 0x80) ? FLAG_N : 0) |
+		((k > 0xFF) ? (FLAG_H | FLAG_C) : 0) |
+		(SZXYP[(k & 7) ^ zB] & FLAG_P);
+}
+
+static inline void do_outx(mdZ80_context *z80, int inc)
+{
+	const uint8_t v = RB(zHL);
+	unsigned int k;
+	zB--;
+	zWZ = zBC + inc;
+	z80->OUT_C(zBC, v);
+	zHL += inc;
+
+	k = v + z80->HL.b.L;
+	zF = SZXY[zB] | ((v & 0x80) ? FLAG_N : 0) |
+		((k > 0xFF) ? (FLAG_H | FLAG_C) : 0) |
+		(SZXYP[(k & 7) ^ zB] & FLAG_P);
+}
+
+/** Interrupts. **/
+
+/**
+ * Accept a pending interrupt.
+ * @param z80 Z80 context.
+ * @param pc Program counter.
+ * @return Number of cycles used, or 0 if no interrupt was accepted.
+ */
+static int do_interrupt(mdZ80_context *z80, uint16_t *pc)
+{
+	int cycles;
+
+	if (z80->IntLine & 0x80) {
+		// NMI. IFF1 is cleared; IFF2 remains as-is.
+		PUSH(*pc);
+		z80->IFF &= ~1;
+		z80->IntLine &= ~0x80;
+		z80->Status &= ~Z80_STATE_HALTED;
+		*pc = 0x66;
+		zWZ = *pc;
+		INC_R();
+		return 11;
+	}
+
+	if (!(z80->IntLine & z80->IFF & 1))
+		return 0;
+
+	// INT clears both IFF1 and IFF2.
+	PUSH(*pc);
+	z80->IFF = 0;
+	z80->IntLine &= 0x80;
+	z80->Status &= ~Z80_STATE_HALTED;
+	INC_R();
+
+	switch (z80->IM) {
+		case 0:
+			// Assume the data bus has an RST instruction.
+			*pc = (uint8_t)(z80->IntVect - 0xC7);
+			cycles = 13;
+			break;
+		case 1:
+			*pc = 0x38;
+			cycles = 13;
+			break;
+		default:
+			*pc = RW((z80->I << 8) | z80->IntVect);
+			cycles = 19;
+			break;
+	}
+
+	zWZ = *pc;
+	return cycles;
+}
+
+/*! Z80 main execution loop. **/
+
+/**
+ * Run the Z80 until the odometer reaches the specified value.
+ * @param z80 Pointer to Z80 context.
+ * @param odo Target odometer value.
+ * @return 0 on success; -1 if no cycles need to be run; status if the Z80 can't run.
+ */
+uint32_t z80_Exec(mdZ80_context *z80, int odo)
+{
+	uint16_t pc;
+	int cycles, cycles_td;
+	int ei_delay = 0;
+
+	// HL, IX, or IY, depending on the prefix.
+	uint16_t *phl;
+	// 8-bit registers for each prefix. [B, C, D, E, H, L, (HL), A]
+	uint8_t *r8_hl[8], *r8_ix[8], *r8_iy[8];
+	uint8_t **r8;
+	// 16-bit registers. [BC, DE, HL, SP]
+	uint16_t *rp[4];
+
+	if ((unsigned int)odo <= z80->CycleCnt)
+		return -1;
+	if (z80->Status & (Z80_STATE_RUNNING | Z80_STATE_FAULTED))
+		return z80->Status;
+
+	if ((z80->Status & Z80_STATE_HALTED) && !z80->IntLine) {
+		// Halted with no interrupt pending.
+		// The Z80 would only execute NOPs, so skip the
+		// main loop setup and advance R and the odometer.
+		const int nops = (int)(((unsigned int)odo - z80->CycleCnt + 3) >> 2);
+		z80->R = (z80->R & 0x80) | ((z80->R + nops) & 0x7F);
+		z80->CycleCnt += (nops * 4);
+		return 0;
+	}
+
+	if (!tables_init)
+		init_tables();
+
+	// Register tables.
+	r8_hl[0] = r8_ix[0] = r8_iy[0] = &z80->BC.b.B;
+	r8_hl[1] = r8_ix[1] = r8_iy[1] = &z80->BC.b.C;
+	r8_hl[2] = r8_ix[2] = r8_iy[2] = &z80->DE.b.D;
+	r8_hl[3] = r8_ix[3] = r8_iy[3] = &z80->DE.b.E;
+	r8_hl[4] = &z80->HL.b.H;
+	r8_hl[5] = &z80->HL.b.L;
+	r8_ix[4] = &z80->IX.b.IXH;
+	r8_ix[5] = &z80->IX.b.IXL;
+	r8_iy[4] = &z80->IY.b.IYH;
+	r8_iy[5] = &z80->IY.b.IYL;
+	r8_hl[6] = r8_ix[6] = r8_iy[6] = NULL;
+	r8_hl[7] = r8_ix[7] = r8_iy[7] = &z80->AF.b.A;
+	rp[0] = &z80->BC.w;
+	rp[1] = &z80->DE.w;
+	rp[3] = &z80->SP.w;
+
+	// Merge the X and Y flags into F.
+	zF = (zF & ~FLAG_XY) | (z80->AF.b.FXY & FLAG_XY);
+
+	pc = (uint16_t)(z80->PC - z80->BasePC);
+	cycles_td = cycles = (int)((unsigned int)odo - z80->CycleCnt);
+	z80->CycleTD = cycles_td;
+	z80->CycleIO = 0;
+	z80->CycleLeft = (uint32_t)cycles;
+	z80->Status |= Z80_STATE_RUNNING;
+
+	while (cycles > 0) {
+		uint8_t op, v;
+		uint16_t adr;
+		int x, y, z;
+		int xy;		// Non-zero if DD/FD prefixed.
+
+		// Check for interrupts.
+		// Interrupts aren't accepted immediately after EI.
+		if (z80->IntLine && !ei_delay)
+			cycles -= do_interrupt(z80, &pc);
+		ei_delay = 0;
+
+		if (z80->Status & Z80_STATE_HALTED) {
+			// HALT executes NOPs until an interrupt is accepted.
+			const int nops = (cycles + 3) >> 2;
+			z80->R = (z80->R & 0x80) | ((z80->R + nops) & 0x7F);
+			cycles -= (nops * 4);
+			break;
+		}
+
+		// Save the position within the timeslice for memory handlers.
+		z80->CycleLeft = (uint32_t)cycles;
+
+		xy = 0;
+		phl = &z80->HL.w;
+		r8 = r8_hl;
+		op = FETCH8();
+		INC_R();
+
+dispatch:
+		rp[2] = phl;
+		x = (op >> 6);
+		y = (op >> 3) & 7;
+		z = (op & 7);
+
+		// (HL) or (IX+d)/(IY+d).
+		// Indexed addressing reads the displacement and adds 8 cycles.
+#define EA_HL()	(xy ? (cycles -= 8, zWZ = *phl + (int8_t)FETCH8()) : zHL)
+
+		switch (op) {
+			case 0x00:	// NOP
+				cycles -= 4;
+				break;
+
+			case 0x01: case 0x11: case 0x21: case 0x31:
+				// LD rr,nn
+				*rp[y >> 1] = FETCH16();
+				cycles -= 10;
+				break;
+
+			case 0x02: case 0x12:
+				// LD (BC),A / LD (DE),A
+				adr = *rp[y >> 1];
+				WB(adr, zA);
+				zWZ = (zA << 8) | ((adr + 1) & 0xFF);
+				cycles -= 7;
+				break;
+
+			case 0x0A: case 0x1A:
+				// LD A,(BC) / LD A,(DE)
+				adr = *rp[y >> 1];
+				zA = RB(adr);
+				zWZ = adr + 1;
+				cycles -= 7;
+				break;
+
+			case 0x22:
+				// LD (nn),HL
+				adr = FETCH16();
+				WW(adr, *phl);
+				zWZ = adr + 1;
+				cycles -= 16;
+				break;
+
+			case 0x2A:
+				// LD HL,(nn)
+				adr = FETCH16();
+				*phl = RW(adr);
+				zWZ = adr + 1;
+				cycles -= 16;
+				break;
+
+			case 0x32:
+				// LD (nn),A
+				adr = FETCH16();
+				WB(adr, zA);
+				zWZ = (zA << 8) | ((adr + 1) & 0xFF);
+				cycles -= 13;
+				break;
+
+			case 0x3A:
+				// LD A,(nn)
+				adr = FETCH16();
+				zA = RB(adr);
+				zWZ = adr + 1;
+				cycles -= 13;
+				break;
+
+			case 0x03: case 0x13: case 0x23: case 0x33:
+				// INC rr
+				(*rp[y >> 1])++;
+				cycles -= 6;
+				break;
+
+			case 0x0B: case 0x1B: case 0x2B: case 0x3B:
+				// DEC rr
+				(*rp[y >> 1])--;
+				cycles -= 6;
+				break;
+
+			case 0x04: case 0x0C: case 0x14: case 0x1C:
+			case 0x24: case 0x2C: case 0x3C:
+				// INC r
+				*r8[y] = do_inc(z80, *r8[y]);
+				cycles -= 4;
+				break;
+
+			case 0x05: case 0x0D: case 0x15: case 0x1D:
+			case 0x25: case 0x2D: case 0x3D:
+				// DEC r
+				*r8[y] = do_dec(z80, *r8[y]);
+				cycles -= 4;
+				break;
+
+			case 0x34:
+				// INC (HL)
+				adr = EA_HL();
+				WB(adr, do_inc(z80, RB(adr)));
+				cycles -= 11;
+				break;
+
+			case 0x35:
+				// DEC (HL)
+				adr = EA_HL();
+				WB(adr, do_dec(z80, RB(adr)));
+				cycles -= 11;
+				break;
+
+			case 0x06: case 0x0E: case 0x16: case 0x1E:
+			case 0x26: case 0x2E: case 0x3E:
+				// LD r,n
+				*r8[y] = FETCH8();
+				cycles -= 7;
+				break;
+
+			case 0x36:
+				// LD (HL),n
+				// LD (IX+d),n only takes 5 extra cycles.
+				adr = EA_HL();
+				WB(adr, FETCH8());
+				cycles -= (xy ? 10 - 3 : 10);
+				break;
+
+			case 0x07:
+				// RLCA
+				zA = (zA << 1) | (zA >> 7);
+				zF = (zF & (FLAG_S | FLAG_Z | FLAG_P)) | (zA & (FLAG_XY | FLAG_C));
+				cycles -= 4;
+				break;
+
+			case 0x0F:
+				// RRCA
+				zF = (zF & (FLAG_S | FLAG_Z | FLAG_P)) | (zA & FLAG_C);
+				zA = (zA >> 1) | (zA << 7);
+				zF |= (zA & FLAG_XY);
+				cycles -= 4;
+				break;
+
+			case 0x17:
+				// RLA
+				v = zA >> 7;
+				zA = (zA << 1) | (zF & FLAG_C);
+				zF = (zF & (FLAG_S | FLAG_Z | FLAG_P)) | (zA & FLAG_XY) | v;
+				cycles -= 4;
+				break;
+
+			case 0x1F:
+				// RRA
+				v = zA & 1;
+				zA = (zA >> 1) | ((zF & FLAG_C) << 7);
+				zF = (zF & (FLAG_S | FLAG_Z | FLAG_P)) | (zA & FLAG_XY) | v;
+				cycles -= 4;
+				break;
+
+			case 0x08: {
+				// EX AF,AF'
+				const uint8_t a = zA;
+				const uint8_t f = zF;
+				zA = z80->AF2.b.A2;
+				zF = (z80->AF2.b.F2 & ~FLAG_XY) | (z80->AF2.b.FXY2 & FLAG_XY);
+				z80->AF2.b.A2 = a;
+				z80->AF2.b.F2 = f;
+				z80->AF2.b.FXY2 = f;
+				cycles -= 4;
+				break;
+			}
+
+			case 0x09: case 0x19: case 0x29: case 0x39:
+				// ADD HL,rr
+				*phl = do_add16(z80, *phl, *rp[y >> 1]);
+				cycles -= 11;
+				break;
+
+			case 0x10:
+				// DJNZ e
+				v = FETCH8();
+				if (--zB != 0) {
+					pc += (int8_t)v;
+					zWZ = pc;
+					cycles -= 13;
+				} else {
+					cycles -= 8;
+				}
+				break;
+
+			case 0x18:
+				// JR e
+				v = FETCH8();
+				pc += (int8_t)v;
+				zWZ = pc;
+				cycles -= 12;
+				break;
+
+			case 0x20: case 0x28: case 0x30: case 0x38:
+				// JR cc,e
+				v = FETCH8();
+				if (test_cc(zF, y - 4)) {
+					pc += (int8_t)v;
+					zWZ = pc;
+					cycles -= 12;
+				} else {
+					cycles -= 7;
+				}
+				break;
+
+			case 0x27:	// DAA
+				do_daa(z80);
+				cycles -= 4;
+				break;
+
+			case 0x2F:	// CPL
+				zA = ~zA;
+				zF = (zF & (FLAG_S | FLAG_Z | FLAG_P | FLAG_C)) |
+					FLAG_H | FLAG_N | (zA & FLAG_XY);
+				cycles -= 4;
+				break;
+
+			case 0x37:	// SCF
+				zF = (zF & (FLAG_S | FLAG_Z | FLAG_P)) | FLAG_C | (zA & FLAG_XY);
+				cycles -= 4;
+				break;
+
+			case 0x3F:	// CCF
+				zF = ((zF & (FLAG_S | FLAG_Z | FLAG_P | FLAG_C)) |
+					((zF & FLAG_C) << 4) | (zA & FLAG_XY)) ^ FLAG_C;
+				cycles -= 4;
+				break;
+
+			case 0x76:	// HALT
+				z80->Status |= Z80_STATE_HALTED;
+				cycles -= 4;
+				break;
+
+			case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+			case 0xE0: case 0xE8: case 0xF0: case 0xF8:
+				// RET cc
+				if (test_cc(zF, y)) {
+					pc = POP();
+					zWZ = pc;
+					cycles -= 11;
+				} else {
+					cycles -= 5;
+				}
+				break;
+
+			case 0xC1: case 0xD1: case 0xE1:
+				// POP rr
+				*rp[y >> 1] = POP();
+				cycles -= 10;
+				break;
+
+			case 0xF1: {
+				// POP AF
+				const uint16_t af = POP();
+				zA = (af >> 8);
+				zF = (af & 0xFF);
+				cycles -= 10;
+				break;
+			}
+
+			case 0xC5: case 0xD5: case 0xE5:
+				// PUSH rr
+				PUSH(*rp[y >> 1]);
+				cycles -= 11;
+				break;
+
+			case 0xF5:
+				// PUSH AF
+				PUSH((zA << 8) | zF);
+				cycles -= 11;
+				break;
+
+			case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+			case 0xE2: case 0xEA: case 0xF2: case 0xFA:
+				// JP cc,nn
+				zWZ = FETCH16();
+				if (test_cc(zF, y))
+					pc = zWZ;
+				cycles -= 10;
+				break;
+
+			case 0xC3:
+				// JP nn
+				pc = zWZ = FETCH16();
+				cycles -= 10;
+				break;
+
+			case 0xC4: case 0xCC: case 0xD4: case 0xDC:
+			case 0xE4: case 0xEC: case 0xF4: case 0xFC:
+				// CALL cc,nn
+				zWZ = FETCH16();
+				if (test_cc(zF, y)) {
+					PUSH(pc);
+					pc = zWZ;
+					cycles -= 17;
+				} else {
+					cycles -= 10;
+				}
+				break;
+
+			case 0xCD:
+				// CALL nn
+				zWZ = FETCH16();
+				PUSH(pc);
+				pc = zWZ;
+				cycles -= 17;
+				break;
+
+			case 0xC6: case 0xCE: case 0xD6: case 0xDE:
+			case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+				// ALU A,n
+				do_alu(z80, y, FETCH8());
+				cycles -= 7;
+				break;
+
+			case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+			case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+				// RST n
+				PUSH(pc);
+				pc = zWZ = (y << 3);
+				cycles -= 11;
+				break;
+
+			case 0xC9:
+				// RET
+				pc = zWZ = POP();
+				cycles -= 10;
+				break;
+
+			case 0xD3:
+				// OUT (n),A
+				v = FETCH8();
+				z80->OUT_C((zA << 8) | v, zA);
+				zWZ = (zA << 8) | ((v + 1) & 0xFF);
+				cycles -= 11;
+				break;
+
+			case 0xDB:
+				// IN A,(n)
+				adr = (zA << 8) | FETCH8();
+				zA = z80->IN_C(adr);
+				zWZ = adr + 1;
+				cycles -= 11;
+				break;
+
+			case 0xD9: {
+				// EXX
+				uint16_t tmp;
+				tmp = zBC; zBC = z80->BC2; z80->BC2 = tmp;
+				tmp = zDE; zDE = z80->DE2; z80->DE2 = tmp;
+				tmp = zHL; zHL = z80->HL2; z80->HL2 = tmp;
+				cycles -= 4;
+				break;
+			}
+
+			case 0xE3: {
+				// EX (SP),HL
+				const uint16_t tmp = RW(zSP);
+				WW(zSP, *phl);
+				*phl = zWZ = tmp;
+				cycles -= 19;
+				break;
+			}
+
+			case 0xE9:
+				// JP (HL)
+				pc = *phl;
+				cycles -= 4;
+				break;
+
+			case 0xEB: {
+				// EX DE,HL (not affected by DD/FD)
+				const uint16_t tmp = zDE;
+				zDE = zHL;
+				zHL = tmp;
+				cycles -= 4;
+				break;
+			}
+
+			case 0xF3:
+				// DI
+				z80->IFF = 0;
+				cycles -= 4;
+				break;
+
+			case 0xFB:
+				// EI
+				z80->IFF = 3;
+				ei_delay = 1;
+				cycles -= 4;
+				break;
+
+			case 0xF9:
+				// LD SP,HL
+				zSP = *phl;
+				cycles -= 6;
+				break;
+
+			case 0xDD:
+			case 0xFD:
+				// IX/IY prefix.
+				xy = 1;
+				if (op == 0xDD) {
+					phl = &z80->IX.w;
+					r8 = r8_ix;
+				} else {
+					phl = &z80->IY.w;
+					r8 = r8_iy;
+				}
+				op = FETCH8();
+				INC_R();
+				cycles -= 4;
+				goto dispatch;
+
+			case 0xCB:
+				if (xy) {
+					// DDCB/FDCB: Displacement comes before the opcode.
+					adr = zWZ = *phl + (int8_t)FETCH8();
+					op = FETCH8();
+					y = (op >> 3) & 7;
+					z = (op & 7);
+					v = RB(adr);
+
+					if ((op >> 6) == 1) {
+						// BIT b,(IX+d)
+						do_bit(z80, y, v, (adr >> 8));
+						cycles -= 16;
+						break;
+					}
+
+					switch (op >> 6) {
+						case 0:
+							v = do_rot(z80, y, v);
+							break;
+						case 2:
+							v &= ~(1 << y);
+							break;
+						default:
+							v |= (1 << y);
+							break;
+					}
+
+					// Undocumented: Result is also copied to a register.
+					WB(adr, v);
+					if (z != 6)
+						*r8_hl[z] = v;
+					cycles -= 19;
+					break;
+				}
+
+				op = FETCH8();
+				INC_R();
+				y = (op >> 3) & 7;
+				z = (op & 7);
+
+				if (z == 6) {
+					// (HL)
+					v = RB(zHL);
+					switch (op >> 6) {
+						case 0:
+							WB(zHL, do_rot(z80, y, v));
+							cycles -= 15;
+							break;
+						case 1:
+							do_bit(z80, y, v, (zWZ >> 8));
+							cycles -= 12;
+							break;
+						case 2:
+							WB(zHL, v & ~(1 << y));
+							cycles -= 15;
+							break;
+						default:
+							WB(zHL, v | (1 << y));
+							cycles -= 15;
+							break;
+					}
+				} else {
+					uint8_t *reg = r8_hl[z];
+					switch (op >> 6) {
+						case 0:
+							*reg = do_rot(z80, y, *reg);
+							break;
+						case 1:
+							do_bit(z80, y, *reg, *reg);
+							break;
+						case 2:
+							*reg &= ~(1 << y);
+							break;
+						default:
+							*reg |= (1 << y);
+							break;
+					}
+					cycles -= 8;
+				}
+				break;
+
+			case 0xED:
+				// ED prefix. (DD/FD has no effect.)
+				op = FETCH8();
+				INC_R();
+				y = (op >> 3) & 7;
+				z = (op & 7);
+				rp[2] = &z80->HL.w;
+
+				if (op < 0x40 || op >= 0xC0) {
+					// Invalid opcode. (NOP)
+					cycles -= 8;
+					break;
+				}
+
+				if (op >= 0x80) {
+					// Block instructions.
+					switch (op) {
+						case 0xA0: case 0xB0:	// LDI, LDIR
+						case 0xA8: case 0xB8:	// LDD, LDDR
+							do_ldx(z80, (op & 0x08) ? -1 : 1);
+							if ((op & 0x10) && zBC != 0) {
+								pc -= 2;
+								zWZ = pc + 1;
+								cycles -= 21;
+							} else {
+								cycles -= 16;
+							}
+							break;
+
+						case 0xA1: case 0xB1:	// CPI, CPIR
+						case 0xA9: case 0xB9:	// CPD, CPDR
+							if (do_cpx(z80, (op & 0x08) ? -1 : 1) == 0 &&
+							    (op & 0x10) && zBC != 0)
+							{
+								pc -= 2;
+								zWZ = pc + 1;
+								cycles -= 21;
+							} else {
+								cycles -= 16;
+							}
+							break;
+
+						case 0xA2: case 0xB2:	// INI, INIR
+						case 0xAA: case 0xBA:	// IND, INDR
+							do_inx(z80, (op & 0x08) ? -1 : 1);
+							if ((op & 0x10) && zB != 0) {
+								pc -= 2;
+								cycles -= 21;
+							} else {
+								cycles -= 16;
+							}
+							break;
+
+						case 0xA3: case 0xB3:	// OUTI, OTIR
+						case 0xAB: case 0xBB:	// OUTD, OTDR
+							do_outx(z80, (op & 0x08) ? -1 : 1);
+							if ((op & 0x10) && zB != 0) {
+								pc -= 2;
+								cycles -= 21;
+							} else {
+								cycles -= 16;
+							}
+							break;
+
+						default:
+							// Invalid opcode. (NOP)
+							cycles -= 8;
+							break;
+					}
+					break;
+				}
+
+				switch (z) {
+					case 0:
+						// IN r,(C)
+						v = z80->IN_C(zBC);
+						zF = (zF & FLAG_C) | SZXYP[v];
+						if (y != 6)
+							*r8_hl[y] = v;
+						zWZ = zBC + 1;
+						cycles -= 12;
+						break;
+
+					case 1:
+						// OUT (C),r
+						z80->OUT_C(zBC, (y != 6 ? *r8_hl[y] : 0));
+						zWZ = zBC + 1;
+						cycles -= 12;
+						break;
+
+					case 2:
+						// SBC HL,rr / ADC HL,rr
+						if (y & 1)
+							do_adc16(z80, *rp[y >> 1]);
+						else
+							do_sbc16(z80, *rp[y >> 1]);
+						cycles -= 15;
+						break;
+
+					case 3:
+						// LD (nn),rr / LD rr,(nn)
+						adr = FETCH16();
+						if (y & 1)
+							*rp[y >> 1] = RW(adr);
+						else
+							WW(adr, *rp[y >> 1]);
+						zWZ = adr + 1;
+						cycles -= 20;
+						break;
+
+					case 4:
+						// NEG
+						v = zA;
+						zA = 0;
+						do_alu(z80, 2, v);
+						cycles -= 8;
+						break;
+
+					case 5:
+						// RETN / RETI
+						// IFF2 is copied to IFF1.
+						pc = zWZ = POP();
+						z80->IFF = (z80->IFF & 2) | ((z80->IFF >> 1) & 1);
+						cycles -= 14;
+						break;
+
+					case 6: {
+						// IM n
+						static const uint8_t im_tbl[4] = {0, 0, 1, 2};
+						z80->IM = im_tbl[y & 3];
+						cycles -= 8;
+						break;
+					}
+
+					default:
+						switch (y) {
+							case 0:	// LD I,A
+								z80->I = zA;
+								cycles -= 9;
+								break;
+							case 1:	// LD R,A
+								z80->R = zA;
+								cycles -= 9;
+								break;
+							case 2:	// LD A,I
+							case 3:	// LD A,R
+								// IFF2 is copied to P/V.
+								zA = (y == 2 ? z80->I : z80->R);
+								zF = (zF & FLAG_C) | SZXY[zA] |
+									((z80->IFF & 2) ? FLAG_P : 0);
+								cycles -= 9;
+								break;
+							case 4: {
+								// RRD
+								const uint8_t m = RB(zHL);
+								WB(zHL, (zA << 4) | (m >> 4));
+								zA = (zA & 0xF0) | (m & 0x0F);
+								zF = (zF & FLAG_C) | SZXYP[zA];
+								zWZ = zHL + 1;
+								cycles -= 18;
+								break;
+							}
+							case 5: {
+								// RLD
+								const uint8_t m = RB(zHL);
+								WB(zHL, (m << 4) | (zA & 0x0F));
+								zA = (zA & 0xF0) | (m >> 4);
+								zF = (zF & FLAG_C) | SZXYP[zA];
+								zWZ = zHL + 1;
+								cycles -= 18;
+								break;
+							}
+							default:
+								// Invalid opcode. (NOP)
+								cycles -= 8;
+								break;
+						}
+						break;
+				}
+				break;
+
+			default:
+				if (x == 1) {
+					// LD r,r'
+					// If (HL) is used, H and L are not replaced by IXH/IXL.
+					if (y == 6) {
+						adr = EA_HL();
+						WB(adr, *r8_hl[z]);
+						cycles -= 7;
+					} else if (z == 6) {
+						adr = EA_HL();
+						*r8_hl[y] = RB(adr);
+						cycles -= 7;
+					} else {
+						*r8[y] = *r8[z];
+						cycles -= 4;
+					}
+				} else {
+					// ALU A,r
+					if (z == 6) {
+						adr = EA_HL();
+						do_alu(z80, y, RB(adr));
+						cycles -= 7;
+					} else {
+						do_alu(z80, y, *r8[z]);
+						cycles -= 4;
+					}
+				}
+				break;
+		}
+#undef EA_HL
+	}
+
+	// Save the program counter.
+	z80->BasePC = (uintptr_t)z80->Fetch[pc >> 8];
+	z80->PC = z80->BasePC + pc;
+
+	// Split the X and Y flags back into FXY.
+	z80->AF.b.FXY = zF;
+
+	// Update the odometer.
+	// CycleIO contains cycles added by mdZ80_add_cycles() while running.
+	z80->CycleCnt += (cycles_td - cycles) - (int)z80->CycleIO;
+	z80->CycleTD = 0;
+	z80->CycleIO = 0;
+	z80->Status &= ~Z80_STATE_RUNNING;
+	return 0;
+}
@@ -150,13 +150,12 @@ Z80_SET_REGISTER_FUNC(uint16_t, IY, IY.w)
  */
 void mdZ80_set_PC(mdZ80_context *z80, uint16_t data)
 {
-	unsigned int newPC;
+	uintptr_t newPC;
 	if (z80->Status & Z80_STATE_RUNNING)
 		return;
 
-	// TODO: 32-bit specific code will break on 64-bit!
 	data &= 0xFFFF;
-	newPC = (unsigned int)(z80->Fetch[data >> 8]);
+	newPC = (uintptr_t)(z80->Fetch[data >> 8]);
 	z80->BasePC = newPC;
 	z80->PC = newPC + data;
 }
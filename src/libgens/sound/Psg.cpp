@@ -39,6 +39,7 @@
 // C includes.
 #include <stdint.h>
 // C includes. (C++ namespace)
+#include <cerrno>
 #include <cstring>
 
 // Sound Manager.
@@ -48,6 +49,9 @@
 // TODO: Get rid of EmuContext.
 #include "EmuContext/EmuContext.hpp"
 
+// ZOMG
+#include "libzomg/ZomgBase.hpp"
+
 /* Message logging. */
 #include "macros/log_msg.h"
 
@@ -408,6 +412,55 @@ void Psg::zomgRestore(const Zomg_PsgSave_t *state)
 	// TODO: Implement Game Gear stereo.
 }
 
+/**
+ * Save the PSG's internal state.
+ * This includes the tone counters, which aren't part of ZOMG.
+ * @param zomg ZOMG savestate object to save to.
+ */
+void Psg::zomgSaveInternal(LibZomg::ZomgBase *zomg) const
+{
+	PsgPrivate::internal_t internal;
+	internal.curChan = d->curChan;
+	internal.curReg = d->curReg;
+	memcpy(internal.reg, d->reg, sizeof(internal.reg));
+	memcpy(internal.counter, d->counter, sizeof(internal.counter));
+	memcpy(internal.cntStep, d->cntStep, sizeof(internal.cntStep));
+	memcpy(internal.volume, d->volume, sizeof(internal.volume));
+	internal.lfsrMask = d->lfsrMask;
+	internal.lfsr = d->lfsr;
+	internal.rateStep = d->stepTable[1];
+	zomg->saveInternal(LibZomg::ZomgBase::INTERNAL_PSG, &internal, sizeof(internal));
+}
+
+/**
+ * Restore the PSG's internal state.
+ * If this fails, use zomgRestore() instead.
+ * @param zomg ZOMG savestate object to restore from.
+ * @return 0 on success; negative errno on error.
+ */
+int Psg::zomgRestoreInternal(LibZomg::ZomgBase *zomg)
+{
+	PsgPrivate::internal_t internal;
+	int ret = zomg->loadInternal(LibZomg::ZomgBase::INTERNAL_PSG, &internal, sizeof(internal));
+	if (ret != 0)
+		return ret;
+	if (internal.rateStep != d->stepTable[1]) {
+		// Different sample rate.
+		// The counter steps can't be used.
+		return -EINVAL;
+	}
+
+	d->curChan = internal.curChan;
+	d->curReg = internal.curReg;
+	memcpy(d->reg, internal.reg, sizeof(d->reg));
+	memcpy(d->counter, internal.counter, sizeof(d->counter));
+	memcpy(d->cntStep, internal.cntStep, sizeof(d->cntStep));
+	memcpy(d->volume, internal.volume, sizeof(d->volume));
+	d->lfsrMask = internal.lfsrMask;
+	d->lfsr = internal.lfsr;
+	return 0;
+}
+
 /** Gens-specific code **/
 
 /**
@@ -433,8 +486,8 @@ void Psg::specialUpdate(void)
 	int writePos = SoundMgr::GetWritePos(line_num);
 
 	// Update the PSG buffer pointers.
-	d->bufPtrL = &SoundMgr::ms_SegBufL[writePos];
-	d->bufPtrR = &SoundMgr::ms_SegBufR[writePos];
+	d->bufPtrL = &SoundMgr::ms_State->segBufL[writePos];
+	d->bufPtrR = &SoundMgr::ms_State->segBufR[writePos];
 }
 
 /** PSG write length. **/
@@ -454,8 +507,8 @@ void Psg::clearWriteLen(void)
  */
 void Psg::resetBufferPtrs(void)
 {
-	d->bufPtrL = &SoundMgr::ms_SegBufL[0];
-	d->bufPtrR = &SoundMgr::ms_SegBufR[0];
+	d->bufPtrL = &SoundMgr::ms_State->segBufL[0];
+	d->bufPtrR = &SoundMgr::ms_State->segBufR[0];
 }
 
 // TODO: Eliminate the GSXv7 stuff.
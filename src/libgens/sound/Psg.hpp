@@ -32,6 +32,10 @@
 
 struct _Zomg_PsgSave_t;
 
+namespace LibZomg {
+	class ZomgBase;
+}
+
 namespace LibGens {
 
 class PsgPrivate;
@@ -68,6 +72,21 @@ class Psg
 		/** ZOMG savestate functions. **/
 		void zomgSave(_Zomg_PsgSave_t *state);
 		void zomgRestore(const _Zomg_PsgSave_t *state);
+
+		/**
+		 * Save the PSG's internal state.
+		 * This includes the tone counters, which aren't part of ZOMG.
+		 * @param zomg ZOMG savestate object to save to.
+		 */
+		void zomgSaveInternal(LibZomg::ZomgBase *zomg) const;
+
+		/**
+		 * Restore the PSG's internal state.
+		 * If this fails, use zomgRestore() instead.
+		 * @param zomg ZOMG savestate object to restore from.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int zomgRestoreInternal(LibZomg::ZomgBase *zomg);
 		
 		/** Gens-specific code. */
 		void specialUpdate(void);
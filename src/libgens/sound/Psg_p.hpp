@@ -67,6 +67,23 @@ class PsgPrivate
 		unsigned int lfsrMask;		// Linear Feedback Shift Register mask.
 		unsigned int lfsr;		// Linear Feedback Shift Register contents.
 
+		/**
+		 * Internal state, saved verbatim in snapshots.
+		 * cntStep[] depends on the sample rate, so
+		 * stepTable[1] is saved to detect rate changes.
+		 */
+		struct internal_t {
+			int curChan;
+			int curReg;
+			unsigned int reg[8];
+			unsigned int counter[4];
+			unsigned int cntStep[4];
+			unsigned int volume[4];
+			unsigned int lfsrMask;
+			unsigned int lfsr;
+			unsigned int rateStep;
+		};
+
 		/* Lookup tables. */
 		unsigned int stepTable[1024];
 		unsigned int volumeTable[16];
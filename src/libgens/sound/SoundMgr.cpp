@@ -48,8 +48,8 @@ namespace LibGens {
 /** SoundManagerPrivate **/
 
 // Audio settings.
+// NOTE: The sampling rate is shared by all contexts.
 int SoundMgrPrivate::rate = 44100;
-bool SoundMgrPrivate::isPal = false;
 
 /**
  * Calculate the segment length.
@@ -79,24 +79,34 @@ int SoundMgrPrivate::CalcSegLength(int rate, bool isPal)
 
 /** SoundMgr **/
 
-// Segment buffer.
-// Stores up to 882 32-bit stereo samples.
-// (32-bit instead of 16-bit to handle oversaturation properly.)
-// TODO: Convert to interleaved stereo.
-// TODO: Make SoundMgr non-static and allocate this using aligned_malloc().
-int32_t ALIGN(16) SoundMgr::ms_SegBufL[MAX_SEGMENT_SIZE];
-int32_t ALIGN(16) SoundMgr::ms_SegBufR[MAX_SEGMENT_SIZE];
+/**
+ * Initialize a sound state.
+ * The PSG and YM2612 are initialized by ReInit().
+ */
+SoundMgr::State::State()
+	: segLength(0)
+	, isPal(false)
+	, vgmLogger(nullptr)
+{
+	memset(segBufL, 0x00, sizeof(segBufL));
+	memset(segBufR, 0x00, sizeof(segBufR));
+	memset(extrapol, 0x00, sizeof(extrapol));
+}
 
-// Audio ICs.
-Psg SoundMgr::ms_Psg;
-Ym2612 SoundMgr::ms_Ym2612;
+// Default state.
+SoundMgr::State SoundMgr::ms_DefaultState;
 
-// Static variable initialization.
-int SoundMgr::ms_SegLength = 0;
+// Current state.
+THREAD_LOCAL SoundMgr::State *SoundMgr::ms_State = &SoundMgr::ms_DefaultState;
 
-// Line extrapolation values. [312 + extra room to prevent overflows]
-// Index 0 == start; Index 1 == length
-unsigned int SoundMgr::ms_Extrapol[312+8][2];
+/**
+ * Bind a State to the calling thread.
+ * @param state State, or nullptr for the default state.
+ */
+void SoundMgr::BindState(State *state)
+{
+	ms_State = (state ? state : &ms_DefaultState);
+}
 
 void SoundMgr::Init(void)
 {
@@ -116,50 +126,51 @@ void SoundMgr::End(void)
  */
 void SoundMgr::ReInit(int rate, bool isPal, bool preserveState)
 {
+	State *const st = ms_State;
 	SoundMgrPrivate::rate = rate;
-	SoundMgrPrivate::isPal = isPal;
+	st->isPal = isPal;
 
 	// Calculate the segment length.
-	ms_SegLength = SoundMgrPrivate::CalcSegLength(rate, isPal);
+	st->segLength = SoundMgrPrivate::CalcSegLength(rate, isPal);
 
 	// Build the sound extrapolation table.
 	const int lines = (isPal ? 312 : 262);
 	for (int i = 0; i < lines; i++) {
-		ms_Extrapol[i][0] = ((ms_SegLength * i) / lines);
-		ms_Extrapol[i][1] = (((ms_SegLength * (i+1)) / lines) - ms_Extrapol[i][0]);
+		st->extrapol[i][0] = ((st->segLength * i) / lines);
+		st->extrapol[i][1] = (((st->segLength * (i+1)) / lines) - st->extrapol[i][0]);
 	}
 	// Copy the last extrapolation value to 8 more lines.
 	// This may help at the end of the frame.
 	for (int i = lines; i < lines+8; i++) {
-		ms_Extrapol[i][0] = ms_Extrapol[lines-1][0];
-		ms_Extrapol[i][1] = ms_Extrapol[lines-1][1];
+		st->extrapol[i][0] = st->extrapol[lines-1][0];
+		st->extrapol[i][1] = st->extrapol[lines-1][1];
 	}
 
 	// Clear the segment buffers.
-	memset(ms_SegBufL, 0x00, sizeof(ms_SegBufL));
-	memset(ms_SegBufR, 0x00, sizeof(ms_SegBufR));
+	memset(st->segBufL, 0x00, sizeof(st->segBufL));
+	memset(st->segBufR, 0x00, sizeof(st->segBufR));
 
 	// If requested, save the PSG/YM state.
 	Zomg_PsgSave_t psgState;
 	Zomg_Ym2612Save_t ym2612State;
 	if (preserveState) {
-		ms_Psg.zomgSave(&psgState);
-		ms_Ym2612.zomgSave(&ym2612State);
+		st->psg.zomgSave(&psgState);
+		st->ym2612.zomgSave(&ym2612State);
 	}
 
 	// Initialize the PSG and YM2612.
 	if (isPal) {
-		ms_Psg.reInit((int)((double)CLOCK_PAL / 15.0), rate);
-		ms_Ym2612.reInit((int)((double)CLOCK_PAL / 7.0), rate);
+		st->psg.reInit((int)((double)CLOCK_PAL / 15.0), rate);
+		st->ym2612.reInit((int)((double)CLOCK_PAL / 7.0), rate);
 	} else {
-		ms_Psg.reInit((int)((double)CLOCK_NTSC / 15.0), rate);
-		ms_Ym2612.reInit((int)((double)CLOCK_NTSC / 7.0), rate);
+		st->psg.reInit((int)((double)CLOCK_NTSC / 15.0), rate);
+		st->ym2612.reInit((int)((double)CLOCK_NTSC / 7.0), rate);
 	}
 
 	// If requested, restore the PSG/YM state.
 	if (preserveState) {
-		ms_Psg.zomgRestore(&psgState);
-		ms_Ym2612.zomgRestore(&ym2612State);
+		st->psg.zomgRestore(&psgState);
+		st->ym2612.zomgRestore(&ym2612State);
 	}
 }
 
@@ -167,7 +178,7 @@ void SoundMgr::ReInit(int rate, bool isPal, bool preserveState)
 
 void SoundMgr::SetRate(int rate, bool preserveState)
 {
-	ReInit(rate, SoundMgrPrivate::isPal, preserveState);
+	ReInit(rate, ms_State->isPal, preserveState);
 }
 
 void SoundMgr::SetRegion(bool isPal, bool preserveState)
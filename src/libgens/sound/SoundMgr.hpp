@@ -35,8 +35,14 @@
 #include "../sound/Psg.hpp"
 #include "../sound/Ym2612.hpp"
 
+// ALIGN(), THREAD_LOCAL
+#include "libcompat/aligned_malloc.h"
+#include "../macros/common.h"
+
 namespace LibGens {
 
+class VgmLogger;
+
 class SoundMgr
 {
 	public:
@@ -57,28 +63,62 @@ class SoundMgr
 		static const int MAX_SAMPLING_RATE = 48000;
 		static const int MAX_SEGMENT_SIZE = 960;	// ceil(MAX_SAMPLING_RATE / 50)
 
-		// Segment buffer.
-		// Stores up to MAX_SEGMENT_SIZE 16-bit stereo samples.
-		// (Samples are actually 32-bit in order to handle oversaturation properly.)
-		// TODO: Call the write functions from SoundMgr so this doesn't need to be public.
-		// TODO: Convert to interleaved stereo.
-		static int32_t ms_SegBufL[MAX_SEGMENT_SIZE];
-		static int32_t ms_SegBufR[MAX_SEGMENT_SIZE];
+		/**
+		 * Per-context sound state.
+		 * Each EmuContext has its own State.
+		 * The SoundMgr functions use the State bound to the calling thread.
+		 * NOTE: The segment buffers must be 16-byte aligned.
+		 */
+		struct State {
+			// Segment buffer.
+			// Stores up to MAX_SEGMENT_SIZE 16-bit stereo samples.
+			// (Samples are actually 32-bit in order to handle oversaturation properly.)
+			// TODO: Call the write functions from SoundMgr so this doesn't need to be public.
+			// TODO: Convert to interleaved stereo.
+			int32_t ALIGN(16) segBufL[MAX_SEGMENT_SIZE];
+			int32_t ALIGN(16) segBufR[MAX_SEGMENT_SIZE];
+
+			// Audio ICs.
+			// TODO: Add wrapper functions?
+			Psg psg;
+			Ym2612 ym2612;
+
+			// Segment length.
+			int segLength;
+
+			// Line extrapolation values. [312 + extra room to prevent overflows]
+			// Index 0 == start; Index 1 == length
+			unsigned int extrapol[312+8][2];
+
+			// Region. (Sampling rate is a global setting.)
+			bool isPal;
+
+			// VGM logger. (nullptr if not logging)
+			// Set by EmuContext::setVgmLogger().
+			VgmLogger *vgmLogger;
 
-		// Audio ICs.
-		// TODO: Add wrapper functions?
-		static Psg ms_Psg;
-		static Ym2612 ms_Ym2612;
+			State();
+		};
+
+		/**
+		 * Bind a State to the calling thread.
+		 * @param state State, or nullptr for the default state.
+		 */
+		static void BindState(State *state);
+
+		// Current state.
+		static THREAD_LOCAL State *ms_State;
 
 		/**
 		 * Reset buffer pointers and lengths.
 		 */
 		static inline void ResetPtrsAndLens(void)
 		{
-			ms_Ym2612.resetBufferPtrs();
-			ms_Ym2612.clearWriteLen();
-			ms_Psg.resetBufferPtrs();
-			ms_Psg.clearWriteLen();
+			State *const st = ms_State;
+			st->ym2612.resetBufferPtrs();
+			st->ym2612.clearWriteLen();
+			st->psg.resetBufferPtrs();
+			st->psg.clearWriteLen();
 		}
 
 		/**
@@ -86,8 +126,9 @@ class SoundMgr
 		 */
 		static inline void SpecialUpdate(void)
 		{
-			ms_Psg.specialUpdate();
-			ms_Ym2612.specialUpdate();
+			State *const st = ms_State;
+			st->psg.specialUpdate();
+			st->ym2612.specialUpdate();
 		}
 
 		/**
@@ -108,26 +149,20 @@ class SoundMgr
 		 */
 		static int writeMono(int16_t *dest, int samples);
 
-	protected:
-		// TODO: Move these into the private class.
-
-		// Segment length.
-		static int ms_SegLength;
-
-		// Line extrapolation values. [312 + extra room to prevent overflows]
-		// Index 0 == start; Index 1 == length
-		static unsigned int ms_Extrapol[312+8][2];
-
 	private:
 		SoundMgr() { }
 		~SoundMgr() { }
+
+		// Default state.
+		// Used if BindState() hasn't been called on this thread.
+		static State ms_DefaultState;
 };
 
 /** Inline functions **/
 
 inline int SoundMgr::GetSegLength(void)
 {
-	return ms_SegLength;
+	return ms_State->segLength;
 }
 
 // TODO: Bounds checking.
@@ -136,7 +171,7 @@ inline int SoundMgr::GetWritePos(int line)
 	// NOTE: Line might be 263 or 313 at the end of the frame.
 	// TODO: Figure out why.
 	assert(line >= 0 && line <= 313);
-	return ms_Extrapol[line][0];
+	return ms_State->extrapol[line][0];
 }
 
 inline int SoundMgr::GetWriteLen(int line)
@@ -144,7 +179,7 @@ inline int SoundMgr::GetWriteLen(int line)
 	// NOTE: Line might be 263 or 313 at the end of the frame.
 	// TODO: Figure out why.
 	assert(line >= 0 && line <= 313);
-	return ms_Extrapol[line][1];
+	return ms_State->extrapol[line][1];
 }
 
 }
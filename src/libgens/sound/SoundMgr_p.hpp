@@ -50,8 +50,8 @@ class SoundMgrPrivate
 		// Segment length.
 		static int CalcSegLength(int rate, bool isPal);
 
+		// Sampling rate. (Shared by all contexts.)
 		static int rate;
-		static bool isPal;
 
 	public:
 #ifdef SOUNDMGR_HAS_MMX
@@ -61,12 +61,12 @@ static inline int16_t clamp(int32_t sample)
  */
 void SoundMgrPrivate::writeStereo_SSE2(int16_t *dest, int samples)
 {
-	// samples is clamped to std::min(samples, ms_SegLength)
+	// samples is clamped to std::min(samples, ms_State->segLength)
 	// by writeStereo().
 
 	// Source buffer pointers.
-	const int32_t *srcL = &SoundMgr::ms_SegBufL[0];
-	const int32_t *srcR = &SoundMgr::ms_SegBufR[0];
+	const int32_t *srcL = &SoundMgr::ms_State->segBufL[0];
+	const int32_t *srcR = &SoundMgr::ms_State->segBufR[0];
 
 	// Write 8 samples at once using SSE2.
 	assert((uintptr_t)dest % 16 == 0);
@@ -124,12 +124,12 @@ void SoundMgrPrivate::writeStereo_SSE2(int16_t *dest, int samples)
  */
 void SoundMgrPrivate::writeMono_SSE2(int16_t *dest, int samples)
 {
-	// samples is clamped to std::min(samples, ms_SegLength)
+	// samples is clamped to std::min(samples, ms_State->segLength)
 	// by writeStereo().
 
 	// Source buffer pointers.
-	const int32_t *srcL = &SoundMgr::ms_SegBufL[0];
-	const int32_t *srcR = &SoundMgr::ms_SegBufR[0];
+	const int32_t *srcL = &SoundMgr::ms_State->segBufL[0];
+	const int32_t *srcR = &SoundMgr::ms_State->segBufR[0];
 
 	// Write 8 samples at once using SSE2.
 	assert((uintptr_t)dest % 16 == 0);
@@ -181,12 +181,12 @@ void SoundMgrPrivate::writeMono_SSE2(int16_t *dest, int samples)
  */
 void SoundMgrPrivate::writeStereo_MMX(int16_t *dest, int samples)
 {
-	// samples is clamped to std::min(samples, ms_SegLength)
+	// samples is clamped to std::min(samples, ms_State->segLength)
 	// by writeStereo().
 
 	// Source buffer pointers.
-	const int32_t *srcL = &SoundMgr::ms_SegBufL[0];
-	const int32_t *srcR = &SoundMgr::ms_SegBufR[0];
+	const int32_t *srcL = &SoundMgr::ms_State->segBufL[0];
+	const int32_t *srcR = &SoundMgr::ms_State->segBufR[0];
 
 	// Write 4 samples at once using MMX.
 	int i = samples;
@@ -250,12 +250,12 @@ void SoundMgrPrivate::writeStereo_MMX(int16_t *dest, int samples)
  */
 void SoundMgrPrivate::writeMono_MMX(int16_t *dest, int samples)
 {
-	// samples is clamped to std::min(samples, ms_SegLength)
+	// samples is clamped to std::min(samples, ms_State->segLength)
 	// by writeMono().
 
 	// Source buffer pointers.
-	const int32_t *srcL = &SoundMgr::ms_SegBufL[0];
-	const int32_t *srcR = &SoundMgr::ms_SegBufR[0];
+	const int32_t *srcL = &SoundMgr::ms_State->segBufL[0];
+	const int32_t *srcR = &SoundMgr::ms_State->segBufR[0];
 
 	// Write 4 samples at once using MMX.
 	int i = samples;
@@ -307,12 +307,12 @@ void SoundMgrPrivate::writeMono_MMX(int16_t *dest, int samples)
  */
 void SoundMgrPrivate::writeStereo_noasm(int16_t *dest, int samples)
 {
-	// samples is clamped to std::min(samples, ms_SegLength)
+	// samples is clamped to std::min(samples, ms_State->segLength)
 	// by writeStereo().
 
 	// Source buffer pointers.
-	const int32_t *srcL = &SoundMgr::ms_SegBufL[0];
-	const int32_t *srcR = &SoundMgr::ms_SegBufR[0];
+	const int32_t *srcL = &SoundMgr::ms_State->segBufL[0];
+	const int32_t *srcR = &SoundMgr::ms_State->segBufR[0];
 
 	for (int i = samples; i > 0;
 	     i--, srcL++, srcR++, dest += 2)
@@ -329,12 +329,12 @@ void SoundMgrPrivate::writeStereo_noasm(int16_t *dest, int samples)
  */
 void SoundMgrPrivate::writeMono_noasm(int16_t *dest, int samples)
 {
-	// samples is clamped to std::min(samples, ms_SegLength)
+	// samples is clamped to std::min(samples, ms_State->segLength)
 	// by writeMono().
 
 	// Source buffer pointers.
-	const int32_t *srcL = &SoundMgr::ms_SegBufL[0];
-	const int32_t *srcR = &SoundMgr::ms_SegBufR[0];
+	const int32_t *srcL = &SoundMgr::ms_State->segBufL[0];
+	const int32_t *srcR = &SoundMgr::ms_State->segBufR[0];
 
 	for (int i = samples; i > 0;
 	     i--, srcL++, srcR++, dest++)
@@ -360,7 +360,7 @@ void SoundMgrPrivate::writeMono_noasm(int16_t *dest, int samples)
  */
 int SoundMgr::writeStereo(int16_t *dest, int samples)
 {
-	samples = std::min(samples, ms_SegLength);
+	samples = std::min(samples, ms_State->segLength);
 #ifdef SOUNDMGR_HAS_MMX
 	if (CPU_Flags & MDP_CPUFLAG_X86_SSE2) {
 		SoundMgrPrivate::writeStereo_SSE2(dest, samples);
@@ -375,8 +375,8 @@ int SoundMgr::writeStereo(int16_t *dest, int samples)
 	// Clear the segment buffers.
 	// These buffers are additive, so if they aren't cleared,
 	// we'll end up with static.
-	memset(ms_SegBufL, 0, ms_SegLength * sizeof(ms_SegBufL[0]));
-	memset(ms_SegBufR, 0, ms_SegLength * sizeof(ms_SegBufL[0]));
+	memset(ms_State->segBufL, 0, ms_State->segLength * sizeof(ms_State->segBufL[0]));
+	memset(ms_State->segBufR, 0, ms_State->segLength * sizeof(ms_State->segBufL[0]));
 
 	return samples;
 }
@@ -390,7 +390,7 @@ int SoundMgr::writeStereo(int16_t *dest, int samples)
  */
 int SoundMgr::writeMono(int16_t *dest, int samples)
 {
-	samples = std::min(samples, ms_SegLength);
+	samples = std::min(samples, ms_State->segLength);
 #ifdef SOUNDMGR_HAS_MMX
 	if (CPU_Flags & MDP_CPUFLAG_X86_SSE2) {
 		SoundMgrPrivate::writeMono_SSE2(dest, samples);
@@ -405,8 +405,8 @@ int SoundMgr::writeMono(int16_t *dest, int samples)
 	// Clear the segment buffers.
 	// These buffers are additive, so if they aren't cleared,
 	// we'll end up with static.
-	memset(ms_SegBufL, 0, ms_SegLength * sizeof(ms_SegBufL[0]));
-	memset(ms_SegBufR, 0, ms_SegLength * sizeof(ms_SegBufL[0]));
+	memset(ms_State->segBufL, 0, ms_State->segLength * sizeof(ms_State->segBufL[0]));
+	memset(ms_State->segBufR, 0, ms_State->segLength * sizeof(ms_State->segBufL[0]));
 
 	return samples;
 }
@@ -43,6 +43,7 @@
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <cerrno>
 #include <cassert>
 
 /* Message logging. */
@@ -63,6 +64,7 @@
 
 // ZOMG YM2612 struct.
 #include "libzomg/zomg_ym2612.h"
+#include "libzomg/ZomgBase.hpp"
 
 namespace LibGens {
 
@@ -146,6 +148,7 @@ int Ym2612Private::LFO_FREQ_TAB[LFO_LENGTH];	// LFO FMS TABLE
 
 Ym2612Private::Ym2612Private(Ym2612 *q)
 	: q(q)
+	, int_cnt(0)
 {
 	if (!isInit) {
 		// Initialize the static tables.
@@ -1889,6 +1892,10 @@ void Ym2612::update(int32_t *bufL, int32_t *bufR, int length)
 	d->CALC_FINC_CH(&d->state.CHANNEL[5]);
 	*/
 
+	// Initialize the interpolation counter.
+	// If no channels are updated, it must not change.
+	d->int_cnt = d->state.Inter_Cnt;
+
 	// Determine the algorithm type.
 	int algo_type;
 	if (d->state.Inter_Step & 0x04000) {
@@ -1964,6 +1971,135 @@ void Ym2612::zomgRestore(const Zomg_Ym2612Save_t *state)
 	// TODO: Restore other counters and stuff!
 }
 
+/**
+ * Convert a slot table pointer to a table index.
+ * Indexes cover AR_TAB[], DR_TAB[], NULL_RATE[],
+ * and DT_TAB[], in that order.
+ * @param p Slot table pointer.
+ * @return Table index, or -1 if p isn't in a table.
+ */
+int32_t Ym2612Private::tablePtrToIdx(const unsigned int *p) const
+{
+	const unsigned int *const tabs[4] = {AR_TAB, DR_TAB, NULL_RATE, &DT_TAB[0][0]};
+	const int32_t lens[4] = {ARRAY_SIZE(AR_TAB), ARRAY_SIZE(DR_TAB),
+				 ARRAY_SIZE(NULL_RATE), (int32_t)(sizeof(DT_TAB) / sizeof(DT_TAB[0][0]))};
+
+	int32_t base = 0;
+	for (int i = 0; i < 4; i++) {
+		if (p >= tabs[i] && p < tabs[i] + lens[i])
+			return base + (int32_t)(p - tabs[i]);
+		base += lens[i];
+	}
+	return -1;
+}
+
+/**
+ * Convert a table index to a slot table pointer.
+ * @param idx Table index.
+ * @return Slot table pointer, or nullptr if idx is invalid.
+ */
+unsigned int *Ym2612Private::tableIdxToPtr(int32_t idx)
+{
+	unsigned int *const tabs[4] = {AR_TAB, DR_TAB, NULL_RATE, &DT_TAB[0][0]};
+	const int32_t lens[4] = {ARRAY_SIZE(AR_TAB), ARRAY_SIZE(DR_TAB),
+				 ARRAY_SIZE(NULL_RATE), (int32_t)(sizeof(DT_TAB) / sizeof(DT_TAB[0][0]))};
+
+	if (idx < 0)
+		return nullptr;
+	for (int i = 0; i < 4; i++) {
+		if (idx < lens[i])
+			return tabs[i] + idx;
+		idx -= lens[i];
+	}
+	return nullptr;
+}
+
+/**
+ * Save the YM2612's internal state.
+ * This includes the timers, envelopes, and phase counters,
+ * which aren't part of ZOMG.
+ * @param zomg ZOMG savestate object to save to.
+ */
+void Ym2612::zomgSaveInternal(LibZomg::ZomgBase *zomg) const
+{
+	// NOTE: internal_t is ~4 KB, so it's allocated on the heap.
+	Ym2612Private::internal_t *internal = new Ym2612Private::internal_t;
+	memcpy(&internal->state, &d->state, sizeof(internal->state));
+
+	for (int i = 0; i < 6; i++) {
+		for (int j = 0; j < 4; j++) {
+			Ym2612Private::slot_t *const SL = &internal->state.CHANNEL[i]._SLOT[j];
+			int32_t *const tab = internal->slotTab[i][j];
+			tab[Ym2612Private::SLOT_TAB_DT] = d->tablePtrToIdx(SL->DT);
+			tab[Ym2612Private::SLOT_TAB_AR] = d->tablePtrToIdx(SL->AR);
+			tab[Ym2612Private::SLOT_TAB_DR] = d->tablePtrToIdx(SL->DR);
+			tab[Ym2612Private::SLOT_TAB_SR] = d->tablePtrToIdx(SL->SR);
+			tab[Ym2612Private::SLOT_TAB_RR] = d->tablePtrToIdx(SL->RR);
+
+			// Don't save host pointers.
+			SL->DT = nullptr;
+			SL->AR = nullptr;
+			SL->DR = nullptr;
+			SL->SR = nullptr;
+			SL->RR = nullptr;
+			SL->OUTp = nullptr;
+		}
+	}
+
+	zomg->saveInternal(LibZomg::ZomgBase::INTERNAL_MD_YM2612, internal, sizeof(*internal));
+	delete internal;
+}
+
+/**
+ * Restore the YM2612's internal state.
+ * The YM2612 is not reset.
+ * If this fails, use zomgRestore() instead.
+ * @param zomg ZOMG savestate object to restore from.
+ * @return 0 on success; negative errno on error.
+ */
+int Ym2612::zomgRestoreInternal(LibZomg::ZomgBase *zomg)
+{
+	Ym2612Private::internal_t *internal = new Ym2612Private::internal_t;
+	int ret = zomg->loadInternal(LibZomg::ZomgBase::INTERNAL_MD_YM2612, internal, sizeof(*internal));
+	if (ret != 0) {
+		delete internal;
+		return ret;
+	}
+
+	if (internal->state.Clock != d->state.Clock ||
+	    internal->state.Rate != d->state.Rate)
+	{
+		// Different clock or sample rate.
+		// The rate tables don't match.
+		delete internal;
+		return -EINVAL;
+	}
+
+	// Convert the table indexes back to pointers.
+	for (int i = 0; i < 6; i++) {
+		for (int j = 0; j < 4; j++) {
+			Ym2612Private::slot_t *const SL = &internal->state.CHANNEL[i]._SLOT[j];
+			const int32_t *const tab = internal->slotTab[i][j];
+			SL->DT = d->tableIdxToPtr(tab[Ym2612Private::SLOT_TAB_DT]);
+			SL->AR = d->tableIdxToPtr(tab[Ym2612Private::SLOT_TAB_AR]);
+			SL->DR = d->tableIdxToPtr(tab[Ym2612Private::SLOT_TAB_DR]);
+			SL->SR = d->tableIdxToPtr(tab[Ym2612Private::SLOT_TAB_SR]);
+			SL->RR = d->tableIdxToPtr(tab[Ym2612Private::SLOT_TAB_RR]);
+			// OUTp isn't used.
+			SL->OUTp = d->state.CHANNEL[i]._SLOT[j].OUTp;
+			if (!SL->DT || !SL->AR || !SL->DR || !SL->SR || !SL->RR) {
+				// Invalid table index.
+				delete internal;
+				return -EINVAL;
+			}
+		}
+	}
+
+	memcpy(&d->state, &internal->state, sizeof(d->state));
+	delete internal;
+	return 0;
+}
+
 // TODO: Eliminate the GSXv7 stuff.
 // TODO: Add the YM timer state (and other important stuff) to the ZOMG save format.
 #if 0
@@ -2309,8 +2445,8 @@ void Ym2612::specialUpdate(void)
 	int writePos = SoundMgr::GetWritePos(line_num);
 
 	// Update the PSG buffer pointers.
-	m_bufPtrL = &SoundMgr::ms_SegBufL[writePos];
-	m_bufPtrR = &SoundMgr::ms_SegBufR[writePos];
+	m_bufPtrL = &SoundMgr::ms_State->segBufL[writePos];
+	m_bufPtrR = &SoundMgr::ms_State->segBufR[writePos];
 }
 
 /**
@@ -2331,8 +2467,8 @@ int Ym2612::getReg(int regID) const
  */
 void Ym2612::resetBufferPtrs(void)
 {
-	m_bufPtrL = &SoundMgr::ms_SegBufL[0];
-	m_bufPtrR = &SoundMgr::ms_SegBufR[0];
+	m_bufPtrL = &SoundMgr::ms_State->segBufL[0];
+	m_bufPtrR = &SoundMgr::ms_State->segBufR[0];
 }
 
 /* end */
@@ -28,6 +28,10 @@
 
 struct _Zomg_Ym2612Save_t;
 
+namespace LibZomg {
+	class ZomgBase;
+}
+
 namespace LibGens {
 
 class Ym2612Private;
@@ -65,6 +69,23 @@ class Ym2612
 		void zomgSave(_Zomg_Ym2612Save_t *state) const;
 		void zomgRestore(const _Zomg_Ym2612Save_t *state);
 
+		/**
+		 * Save the YM2612's internal state.
+		 * This includes the timers, envelopes, and phase counters,
+		 * which aren't part of ZOMG.
+		 * @param zomg ZOMG savestate object to save to.
+		 */
+		void zomgSaveInternal(LibZomg::ZomgBase *zomg) const;
+
+		/**
+		 * Restore the YM2612's internal state.
+		 * The YM2612 is not reset.
+		 * If this fails, use zomgRestore() instead.
+		 * @param zomg ZOMG savestate object to restore from.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int zomgRestoreInternal(LibZomg::ZomgBase *zomg);
+
 		/** Gens-specific code. **/
 		void updateDacAndTimers(int32_t *bufL, int32_t *bufR, int length);
 		void specialUpdate(void);
@@ -145,6 +145,40 @@ class Ym2612Private
 		// YM2612 state.
 		state_t state;
 
+		/**
+		 * Internal state, saved verbatim in snapshots.
+		 * The slot table pointers point into per-instance
+		 * tables, so they're saved as table indexes instead.
+		 * (See tablePtrToIdx().)
+		 */
+		enum SlotTable {
+			SLOT_TAB_DT = 0,
+			SLOT_TAB_AR,
+			SLOT_TAB_DR,
+			SLOT_TAB_SR,
+			SLOT_TAB_RR,
+
+			SLOT_TAB_MAX
+		};
+		struct internal_t {
+			state_t state;	// Slot table pointers are nullptr.
+			int32_t slotTab[6][4][SLOT_TAB_MAX];
+		};
+
+		/**
+		 * Convert a slot table pointer to a table index.
+		 * @param p Slot table pointer.
+		 * @return Table index, or -1 if p isn't in a table.
+		 */
+		int32_t tablePtrToIdx(const unsigned int *p) const;
+
+		/**
+		 * Convert a table index to a slot table pointer.
+		 * @param idx Table index.
+		 * @return Slot table pointer, or nullptr if idx is invalid.
+		 */
+		unsigned int *tableIdxToPtr(int32_t idx);
+
 		// Change it if you need to do long update
 		static const int MAX_UPDATE_LENGTH = 2000;
 
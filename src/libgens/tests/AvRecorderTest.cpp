@@ -0,0 +1,311 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * AvRecorderTest.cpp: A/V recorder test.                                  *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// LibGens.
+#include "lg_main.hpp"
+#include "Util/AvRecorder.hpp"
+#include "Util/MdFb.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibGens { namespace Tests {
+
+class AvRecorderTest : public ::testing::Test
+{
+	protected:
+		AvRecorderTest() { }
+		virtual ~AvRecorderTest() { }
+
+		virtual void TearDown(void) override;
+
+		/**
+		 * Read an entire file.
+		 * @param filename Filename.
+		 * @return File contents.
+		 */
+		static vector<uint8_t> readFile(const char *filename);
+
+		/**
+		 * Read a little-endian 32-bit value.
+		 * @param p Data.
+		 * @return Value.
+		 */
+		static inline uint32_t le32(const uint8_t *p)
+		{
+			return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+
+	protected:
+		static const char videoFilename[];
+		static const char audioFilename[];
+};
+
+const char AvRecorderTest::videoFilename[] = "AvRecorderTest.ppm";
+const char AvRecorderTest::audioFilename[] = "AvRecorderTest.wav";
+
+/**
+ * Delete the test files.
+ */
+void AvRecorderTest::TearDown(void)
+{
+	remove(videoFilename);
+	remove(audioFilename);
+}
+
+/**
+ * Read an entire file.
+ * @param filename Filename.
+ * @return File contents.
+ */
+vector<uint8_t> AvRecorderTest::readFile(const char *filename)
+{
+	vector<uint8_t> data;
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+		return data;
+	uint8_t buf[4096];
+	size_t size;
+	while ((size = fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.insert(data.end(), buf, buf + size);
+	}
+	fclose(f);
+	return data;
+}
+
+/**
+ * Record frames and audio, then verify the files.
+ */
+TEST_F(AvRecorderTest, recordFramesAndAudio)
+{
+	AvRecorder recorder;
+	EXPECT_FALSE(recorder.isOpen());
+	EXPECT_EQ(-EBADF, recorder.pushFrame(nullptr));
+	ASSERT_EQ(0, recorder.open(videoFilename, audioFilename, 44100, 2));
+	EXPECT_TRUE(recorder.isOpen());
+	EXPECT_EQ(-EBUSY, recorder.open(videoFilename, audioFilename, 44100, 2));
+
+	// 32-bit frame with a 256x224 active area.
+	MdFb *fb = new MdFb();
+	fb->setBpp(MdFb::BPP_32);
+	fb->setImgWidth(256);
+	fb->setImgHeight(224);
+	fb->setImgXStart(32);
+	fb->setImgYStart(8);
+	for (int y = 0; y < fb->numLines(); y++) {
+		uint32_t *line = fb->lineBuf32(y);
+		for (int x = 0; x < fb->pxPerLine(); x++) {
+			line[x] = (x << 16) | (y << 8) | 0x5A;
+		}
+	}
+
+	// A frame at a time, like the emulator.
+	static const int frames = 8;
+	static const int samplesPerFrame = 735;
+	vector<int16_t> audio(samplesPerFrame * 2);
+	for (int i = 0; i < frames; i++) {
+		EXPECT_EQ(0, recorder.pushFrame(fb));
+		for (int s = 0; s < samplesPerFrame; s++) {
+			audio[s*2] = (int16_t)(i * samplesPerFrame + s);
+			audio[s*2+1] = (int16_t)-(i * samplesPerFrame + s);
+		}
+		EXPECT_EQ(0, recorder.pushAudio(audio.data(), samplesPerFrame, 2));
+	}
+
+	// Mono audio is converted to stereo.
+	const int16_t mono[2] = {1234, -1234};
+	EXPECT_EQ(0, recorder.pushAudio(mono, 2, 1));
+
+	EXPECT_EQ(0, recorder.close());
+	EXPECT_FALSE(recorder.isOpen());
+	fb->unref();
+
+	AvRecorder::Stats stats;
+	recorder.stats(&stats);
+	EXPECT_EQ((unsigned int)frames, stats.frames);
+	EXPECT_EQ(0U, stats.droppedFrames);
+	EXPECT_EQ(0U, stats.droppedSamples);
+
+	// Verify the video.
+	static const char ppmHeader[] = "P6\n256 224\n255\n";
+	const size_t headerSize = sizeof(ppmHeader) - 1;
+	const size_t frameSize = headerSize + (256 * 224 * 3);
+	vector<uint8_t> video = readFile(videoFilename);
+	ASSERT_EQ(frameSize * frames, video.size());
+	for (int i = 0; i < frames; i++) {
+		const uint8_t *p = &video[frameSize * i];
+		ASSERT_EQ(0, memcmp(p, ppmHeader, headerSize));
+		p += headerSize;
+		for (int y = 0; y < 224; y++) {
+			for (int x = 0; x < 256; x++, p += 3) {
+				ASSERT_EQ((uint8_t)(x + 32), p[0]);
+				ASSERT_EQ((uint8_t)(y + 8), p[1]);
+				ASSERT_EQ(0x5A, p[2]);
+			}
+		}
+	}
+
+	// Verify the audio.
+	const uint32_t dataBytes = ((frames * samplesPerFrame) + 2) * 2 * sizeof(int16_t);
+	vector<uint8_t> wav = readFile(audioFilename);
+	ASSERT_EQ(44 + dataBytes, wav.size());
+	EXPECT_EQ(0, memcmp(&wav[0], "RIFF", 4));
+	EXPECT_EQ(36 + dataBytes, le32(&wav[4]));
+	EXPECT_EQ(0, memcmp(&wav[8], "WAVEfmt ", 8));
+	EXPECT_EQ(2, wav[22]);			// Channels
+	EXPECT_EQ(44100U, le32(&wav[24]));	// Sampling rate
+	EXPECT_EQ(0, memcmp(&wav[36], "data", 4));
+	EXPECT_EQ(dataBytes, le32(&wav[40]));
+	for (int s = 0; s < frames * samplesPerFrame; s++) {
+		const uint8_t *p = &wav[44 + (s * 4)];
+		ASSERT_EQ((int16_t)s, (int16_t)(p[0] | (p[1] << 8)));
+		ASSERT_EQ((int16_t)-s, (int16_t)(p[2] | (p[3] << 8)));
+	}
+	const uint8_t *p = &wav[44 + (frames * samplesPerFrame * 4)];
+	EXPECT_EQ(1234, (int16_t)(p[0] | (p[1] << 8)));
+	EXPECT_EQ(1234, (int16_t)(p[2] | (p[3] << 8)));
+	EXPECT_EQ(-1234, (int16_t)(p[4] | (p[5] << 8)));
+	EXPECT_EQ(-1234, (int16_t)(p[6] | (p[7] << 8)));
+}
+
+/**
+ * Frames are dropped instead of blocking if the queue is full.
+ * Dropped frames are replaced by repeating the previous frame.
+ */
+TEST_F(AvRecorderTest, dropFrames)
+{
+	AvRecorder recorder;
+	ASSERT_EQ(0, recorder.open(videoFilename, nullptr, 0, 0));
+	EXPECT_EQ(-EBADF, recorder.pushAudio(nullptr, 1, 2));
+
+	MdFb *fb = new MdFb();
+	fb->setBpp(MdFb::BPP_32);
+	fb->clear();
+
+	// Push frames much faster than they can be written.
+	// Every frame is either queued or dropped.
+	// The first pixel of each frame has the frame number.
+	static const int frames = 256;
+	vector<bool> queued(frames);
+	int dropped = 0;
+	for (int i = 0; i < frames; i++) {
+		fb->lineBuf32(fb->imgYStart())[fb->imgXStart()] = i;
+		int ret = recorder.pushFrame(fb);
+		queued[i] = (ret == 0);
+		if (ret == -ENOSPC) {
+			dropped++;
+		} else {
+			EXPECT_EQ(0, ret);
+		}
+	}
+	EXPECT_EQ(0, recorder.close());
+	fb->unref();
+
+	AvRecorder::Stats stats;
+	recorder.stats(&stats);
+	EXPECT_EQ((unsigned int)dropped, stats.droppedFrames);
+	EXPECT_EQ((unsigned int)frames, stats.frames);
+
+	// 320x240 RGB24 frames.
+	// Each dropped frame is a copy of the previous frame.
+	static const size_t headerSize = sizeof("P6\n320 240\n255\n") - 1;
+	static const size_t frameSize = headerSize + (320 * 240 * 3);
+	vector<uint8_t> video = readFile(videoFilename);
+	ASSERT_EQ(frameSize * frames, video.size());
+	int expected = 0;
+	for (int i = 0; i < frames; i++) {
+		if (queued[i])
+			expected = i;
+		EXPECT_EQ((uint8_t)expected, video[(frameSize * i) + headerSize + 2]);
+	}
+}
+
+/**
+ * Audio is dropped instead of blocking if the queue is full.
+ * Dropped samples are replaced with silence.
+ */
+TEST_F(AvRecorderTest, dropAudio)
+{
+	AvRecorder recorder;
+	ASSERT_EQ(0, recorder.open(nullptr, audioFilename, 44100, 1));
+
+	// Push audio much faster than it can be written.
+	// Each block has a different nonzero value.
+	static const int blocks = 64;
+	static const int samplesPerBlock = 32768;
+	vector<int16_t> audio(samplesPerBlock);
+	vector<bool> queued(blocks);
+	int dropped = 0;
+	for (int i = 0; i < blocks; i++) {
+		audio.assign(samplesPerBlock, (int16_t)(i + 1));
+		int ret = recorder.pushAudio(audio.data(), samplesPerBlock, 1);
+		queued[i] = (ret == 0);
+		if (ret == -ENOSPC) {
+			dropped += samplesPerBlock;
+		} else {
+			EXPECT_EQ(0, ret);
+		}
+	}
+	EXPECT_EQ(0, recorder.close());
+
+	AvRecorder::Stats stats;
+	recorder.stats(&stats);
+	EXPECT_EQ((unsigned int)dropped, stats.droppedSamples);
+
+	// Every block is at its original position,
+	// either with its own samples or with silence.
+	vector<uint8_t> wav = readFile(audioFilename);
+	ASSERT_EQ(44U + (blocks * samplesPerBlock * sizeof(int16_t)), wav.size());
+	for (int i = 0; i < blocks; i++) {
+		const int16_t expected = (queued[i] ? (int16_t)(i + 1) : 0);
+		const uint8_t *p = &wav[44 + (i * samplesPerBlock * sizeof(int16_t))];
+		for (int s = 0; s < samplesPerBlock; s++, p += 2) {
+			ASSERT_EQ(expected, (int16_t)(p[0] | (p[1] << 8))) << "block " << i << ", sample " << s;
+		}
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: AvRecorder tests.\n\n");
+	LibGens::Init();
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
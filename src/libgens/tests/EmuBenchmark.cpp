@@ -0,0 +1,371 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * EmuBenchmark.cpp: Full-system frame throughput benchmark.               *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * Loads a ROM (and optionally a savestate) and times calls to
+ * EmuContext::execFrame() and EmuContext::execFrameFast().
+ *
+ * Each mode is run twice:
+ * - With performance counters disabled, for frames/sec and
+ *   ns/frame percentiles.
+ * - With performance counters enabled, for the per-subsystem split.
+ *
+ * This isn't run by ctest, since it requires a ROM image.
+ */
+
+// LibGens.
+#include "lg_main.hpp"
+#include "Rom.hpp"
+#include "EmuContext/EmuContext.hpp"
+#include "EmuContext/EmuContextFactory.hpp"
+#include "Util/PerfCounters.hpp"
+#include "Util/Timing.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// popt
+#include <popt.h>
+
+namespace LibGens { namespace Tests {
+
+class EmuBenchmark
+{
+	public:
+		EmuBenchmark(EmuContext *context, const char *state_filename,
+			     unsigned int frames, unsigned int warmup);
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibGens-specific version of Q_DISABLE_COPY().
+		EmuBenchmark(const EmuBenchmark &);
+		EmuBenchmark &operator=(const EmuBenchmark &);
+
+	public:
+		/**
+		 * Run the benchmark for a frame execution mode.
+		 * @param fast If true, use execFrameFast(); otherwise, use execFrame().
+		 * @return 0 on success; non-zero on error.
+		 */
+		int run(bool fast);
+
+	private:
+		EmuContext *m_context;
+		const char *m_state_filename;
+		unsigned int m_frames;
+		unsigned int m_warmup;
+		bool m_isPal;
+
+		/**
+		 * Reset the emulator to the initial state.
+		 * If a savestate was specified, it will be reloaded.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int resetState(void);
+
+		/**
+		 * Run a single frame.
+		 * @param fast If true, use execFrameFast(); otherwise, use execFrame().
+		 */
+		inline void execFrame(bool fast)
+		{
+			if (fast)
+				m_context->execFrameFast();
+			else
+				m_context->execFrame();
+		}
+
+		/**
+		 * Get a percentile from a sorted list of frame times.
+		 * @param sorted Sorted frame times.
+		 * @param pct Percentile. (0-100)
+		 * @return Frame time at the specified percentile.
+		 */
+		static uint64_t percentile(const vector<uint64_t> &sorted, int pct);
+};
+
+EmuBenchmark::EmuBenchmark(EmuContext *context, const char *state_filename,
+			   unsigned int frames, unsigned int warmup)
+	: m_context(context)
+	, m_state_filename(state_filename)
+	, m_frames(frames)
+	, m_warmup(warmup)
+{
+	m_isPal = context->versionRegisterObject()->isPal();
+}
+
+/**
+ * Reset the emulator to the initial state.
+ * If a savestate was specified, it will be reloaded.
+ * @return 0 on success; non-zero on error.
+ */
+int EmuBenchmark::resetState(void)
+{
+	m_context->hardReset();
+	if (m_state_filename) {
+		int ret = m_context->zomgLoad(m_state_filename);
+		if (ret != 0) {
+			fprintf(stderr, "Error loading savestate %s: %s\n",
+				m_state_filename, strerror(-ret));
+			return ret;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Get a percentile from a sorted list of frame times.
+ * @param sorted Sorted frame times.
+ * @param pct Percentile. (0-100)
+ * @return Frame time at the specified percentile.
+ */
+uint64_t EmuBenchmark::percentile(const vector<uint64_t> &sorted, int pct)
+{
+	if (sorted.empty())
+		return 0;
+	size_t idx = ((sorted.size() - 1) * pct) / 100;
+	return sorted[idx];
+}
+
+/**
+ * Run the benchmark for a frame execution mode.
+ * @param fast If true, use execFrameFast(); otherwise, use execFrame().
+ * @return 0 on success; non-zero on error.
+ */
+int EmuBenchmark::run(bool fast)
+{
+	const char *const mode = (fast ? "execFrameFast()" : "execFrame()");
+	vector<uint64_t> frame_ns;
+	frame_ns.reserve(m_frames);
+
+	/** Pass 1: Throughput. (counters disabled) **/
+	int ret = resetState();
+	if (ret != 0)
+		return ret;
+	m_context->setPerfCountersEnabled(false);
+	for (unsigned int i = m_warmup; i > 0; i--) {
+		execFrame(fast);
+	}
+
+	const uint64_t start = Timing::GetTimestampNs();
+	uint64_t last = start;
+	for (unsigned int i = m_frames; i > 0; i--) {
+		execFrame(fast);
+		const uint64_t now = Timing::GetTimestampNs();
+		frame_ns.push_back(now - last);
+		last = now;
+	}
+	const uint64_t total_ns = last - start;
+
+	/** Pass 2: Subsystem split. (counters enabled) **/
+	ret = resetState();
+	if (ret != 0)
+		return ret;
+	m_context->setPerfCountersEnabled(true);
+	for (unsigned int i = m_warmup; i > 0; i--) {
+		execFrame(fast);
+	}
+
+	uint64_t sub_ns[PerfCounters::PERF_MAX];
+	uint64_t sub_frame_ns = 0;
+	uint64_t cycles_m68k = 0, cycles_z80 = 0, cycles_dma = 0;
+	memset(sub_ns, 0, sizeof(sub_ns));
+	const PerfCounters *const perf = m_context->perfCounters();
+	for (unsigned int i = m_frames; i > 0; i--) {
+		execFrame(fast);
+		for (int j = 0; j < PerfCounters::PERF_MAX; j++) {
+			sub_ns[j] += perf->ns[j];
+		}
+		sub_frame_ns += perf->frame_ns;
+		cycles_m68k += perf->cycles_m68k;
+		cycles_z80 += perf->cycles_z80;
+		cycles_dma += perf->cycles_dma;
+	}
+
+	// Percentiles are only available for the last HISTORY_SIZE frames.
+	const PerfHistory *const history = m_context->perfHistory();
+	uint64_t sub_p50[PerfCounters::PERF_MAX];
+	uint64_t sub_p99[PerfCounters::PERF_MAX];
+	for (int j = 0; j < PerfCounters::PERF_MAX; j++) {
+		sub_p50[j] = history->percentile(j, 50);
+		sub_p99[j] = history->percentile(j, 99);
+	}
+	m_context->setPerfCountersEnabled(false);
+
+	/** Results. **/
+	std::sort(frame_ns.begin(), frame_ns.end());
+	const double fps = (total_ns > 0 ? ((double)m_frames * 1.0e9 / (double)total_ns) : 0.0);
+	printf("%s: %u frames in %0.3f s\n", mode, m_frames, (double)total_ns / 1.0e9);
+	printf("  Throughput: %0.1f fps (%0.2fx real time)\n",
+		fps, fps / (m_isPal ? 50.0 : 60.0));
+	printf("  ns/frame: min %llu, p50 %llu, p90 %llu, p99 %llu, max %llu\n",
+		(unsigned long long)frame_ns.front(),
+		(unsigned long long)percentile(frame_ns, 50),
+		(unsigned long long)percentile(frame_ns, 90),
+		(unsigned long long)percentile(frame_ns, 99),
+		(unsigned long long)frame_ns.back());
+
+	printf("  Subsystems: (ns/frame, with counters enabled)\n");
+	printf("    %-8s %10s  %7s  %10s %10s\n", "", "average", "", "p50", "p99");
+	uint64_t accounted_ns = 0;
+	for (int j = 0; j < PerfCounters::PERF_MAX; j++) {
+		const uint64_t avg = sub_ns[j] / m_frames;
+		accounted_ns += sub_ns[j];
+		printf("    %-8s %10llu  (%5.1f%%)  %10llu %10llu\n",
+			PerfCounters::SubsystemName((PerfCounters::Subsystem)j),
+			(unsigned long long)avg,
+			(sub_frame_ns > 0 ? (double)sub_ns[j] * 100.0 / (double)sub_frame_ns : 0.0),
+			(unsigned long long)sub_p50[j],
+			(unsigned long long)sub_p99[j]);
+	}
+	const uint64_t other_ns = (sub_frame_ns > accounted_ns ? sub_frame_ns - accounted_ns : 0);
+	printf("    %-8s %10llu  (%5.1f%%)\n", "Other",
+		(unsigned long long)(other_ns / m_frames),
+		(sub_frame_ns > 0 ? (double)other_ns * 100.0 / (double)sub_frame_ns : 0.0));
+	printf("  Cycles/frame: 68000 %llu (DMA %llu), Z80 %llu\n",
+		(unsigned long long)(cycles_m68k / m_frames),
+		(unsigned long long)(cycles_dma / m_frames),
+		(unsigned long long)(cycles_z80 / m_frames));
+	printf("\n");
+	return 0;
+}
+
+} }
+
+int main(int argc, const char *argv[])
+{
+	// Command line options.
+	int frames = 3000;
+	int warmup = 60;
+	int no_full = 0;
+	int no_fast = 0;
+	int no_idle_loop = 0;
+	const char *state_filename = nullptr;
+
+	struct poptOption optionsTable[] = {
+		{"frames", 'n', POPT_ARG_INT, &frames, 0,
+			"Number of frames to time per mode. (default is 3000)", "FRAMES"},
+		{"warmup", '\0', POPT_ARG_INT, &warmup, 0,
+			"Number of untimed frames to run first. (default is 60)", "FRAMES"},
+		{"state", 's', POPT_ARG_STRING, &state_filename, 0,
+			"Load a savestate before each run.", "FILENAME"},
+		{"no-full", '\0', POPT_ARG_VAL, &no_full, 1,
+			"Don't benchmark execFrame().", NULL},
+		{"no-fast", '\0', POPT_ARG_VAL, &no_fast, 1,
+			"Don't benchmark execFrameFast().", NULL},
+		{"no-idle-loop", '\0', POPT_ARG_VAL, &no_idle_loop, 1,
+			"Disable 68000 idle loop detection.", NULL},
+		POPT_AUTOHELP
+		POPT_TABLEEND
+	};
+
+	poptContext optCon = poptGetContext(NULL, argc, argv, optionsTable, 0);
+	poptSetOtherOptionHelp(optCon, "[OPTION...] rom_file");
+	int c;
+	while ((c = poptGetNextOpt(optCon)) >= 0) { }
+	if (c < -1) {
+		fprintf(stderr, "%s: %s: %s\n", argv[0],
+			poptBadOption(optCon, POPT_BADOPTION_NOALIAS),
+			poptStrerror(c));
+		poptFreeContext(optCon);
+		return EXIT_FAILURE;
+	}
+
+	const char *rom_arg = poptGetArg(optCon);
+	if (!rom_arg || frames <= 0 || warmup < 0) {
+		poptPrintUsage(optCon, stderr, 0);
+		poptFreeContext(optCon);
+		return EXIT_FAILURE;
+	}
+	const string rom_filename(rom_arg);
+	const string state_str(state_filename ? state_filename : "");
+	poptFreeContext(optCon);
+
+	// Initialize LibGens.
+	LibGens::Init();
+	LibGens::EmuContext::SetIdleLoopDetect(!no_idle_loop);
+
+	LibGens::Rom *rom = new LibGens::Rom(rom_filename.c_str());
+	if (!rom->isOpen()) {
+		fprintf(stderr, "Error opening ROM file %s.\n", rom_filename.c_str());
+		delete rom;
+		return EXIT_FAILURE;
+	}
+	if (rom->isMultiFile()) {
+		// Select the first file.
+		rom->select_z_entry(rom->get_z_entry_list());
+	}
+	if (!LibGens::EmuContextFactory::isRomFormatSupported(rom) ||
+	    !LibGens::EmuContextFactory::isRomSystemSupported(rom))
+	{
+		fprintf(stderr, "ROM file %s is not supported.\n", rom_filename.c_str());
+		delete rom;
+		return EXIT_FAILURE;
+	}
+
+	// Detect the ROM region.
+	// Using region code order 0x4812. (US, Europe, Japan, Asia)
+	LibGens::SysVersion::RegionCode_t region =
+		LibGens::SysVersion::DetectRegion(rom->regionCode(), 0x4812);
+	if (region == LibGens::SysVersion::REGION_AUTO) {
+		region = LibGens::SysVersion::REGION_US_NTSC;
+	}
+
+	LibGens::EmuContext *context = LibGens::EmuContextFactory::createContext(rom, region);
+	if (!context || !context->isRomOpened()) {
+		fprintf(stderr, "Error initializing EmuContext for %s.\n", rom_filename.c_str());
+		delete context;
+		delete rom;
+		return EXIT_FAILURE;
+	}
+
+	printf("ROM: %s\n", rom_filename.c_str());
+	if (!state_str.empty()) {
+		printf("Savestate: %s\n", state_str.c_str());
+	}
+	printf("Warmup: %d frames\n\n", warmup);
+
+	int ret = 0;
+	{
+		LibGens::Tests::EmuBenchmark benchmark(context,
+			(state_str.empty() ? nullptr : state_str.c_str()),
+			(unsigned int)frames, (unsigned int)warmup);
+		if (!no_full && ret == 0)
+			ret = benchmark.run(false);
+		if (!no_fast && ret == 0)
+			ret = benchmark.run(true);
+	}
+
+	delete context;
+	delete rom;
+	LibGens::End();
+	return (ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
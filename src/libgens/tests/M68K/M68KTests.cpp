@@ -0,0 +1,824 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * M68KTests.cpp: md68k instruction tests.                                 *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+#include "md68k/md68k.h"
+#include "macros/common.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+// NOTE: This test suite uses md68k directly.
+// The M68K class is hard-coded for MD only.
+
+// Interrupt acknowledge.
+// Returns the next interrupt level.
+static uint8_t next_int_level = 0;
+extern "C" uint8_t VDP_Int_Ack(void)
+{
+	return next_int_level;
+}
+
+namespace LibGens { namespace Tests {
+
+class M68KTests : public ::testing::Test
+{
+	protected:
+		M68KTests()
+			: ::testing::Test() { }
+		virtual ~M68KTests() { }
+
+		virtual void SetUp(void) override;
+		virtual void TearDown(void) override;
+
+	protected:
+		// 64 KB of RAM at 0x000000, mirrored at 0xFF0000.
+		// Stored as host-endian 16-bit words.
+		static uint16_t ram[0x8000];
+
+		// I/O port at 0xC00000. (memory handlers)
+		static uint16_t io_last_write;
+		static unsigned int io_read_count;
+		static uint8_t io_rb(uint32_t address) { ((void)address); io_read_count++; return 0x5A; }
+		static uint16_t io_rw(uint32_t address) { ((void)address); io_read_count++; return 0xA55A; }
+		static void io_wb(uint32_t address, uint8_t data) { ((void)address); io_last_write = data; }
+		static void io_ww(uint32_t address, uint16_t data) { ((void)address); io_last_write = data; }
+
+		STARSCREAM_PROGRAMREGION m_fetch[2];
+		STARSCREAM_DATAREGION m_readbyte[4];
+		STARSCREAM_DATAREGION m_readword[4];
+		STARSCREAM_DATAREGION m_writebyte[4];
+		STARSCREAM_DATAREGION m_writeword[4];
+		S68000CONTEXT m_context;
+
+		/**
+		 * Load a program at 0x1000 and reset the CPU.
+		 * SSP is initialized to 0x8000.
+		 * @param prg Program words.
+		 * @param count Number of words.
+		 */
+		void loadProgram(const uint16_t *prg, int count);
+
+		/**
+		 * Run the CPU until it reaches an address.
+		 * @param address Address.
+		 * @return Number of cycles executed.
+		 */
+		unsigned int runTo(uint32_t address);
+
+		static inline void write16(uint32_t address, uint16_t data)
+			{ ram[(address & 0xFFFF) >> 1] = data; }
+		static inline uint16_t read16(uint32_t address)
+			{ return ram[(address & 0xFFFF) >> 1]; }
+		static inline void write32(uint32_t address, uint32_t data)
+			{ write16(address, data >> 16); write16(address + 2, data & 0xFFFF); }
+		static inline uint32_t read32(uint32_t address)
+			{ return (read16(address) << 16) | read16(address + 2); }
+
+		/**
+		 * Get the condition codes.
+		 * @return CCR. (X N Z V C)
+		 */
+		inline uint8_t ccr(void)
+		{
+			main68k_GetContext(&m_context);
+			return (m_context.sr & 0x1F);
+		}
+
+		/**
+		 * Get a data register.
+		 * @param reg Register number.
+		 * @return Register value.
+		 */
+		inline uint32_t dreg(int reg)
+		{
+			main68k_GetContext(&m_context);
+			return m_context.dreg[reg];
+		}
+
+		/**
+		 * Get an address register.
+		 * @param reg Register number.
+		 * @return Register value.
+		 */
+		inline uint32_t areg(int reg)
+		{
+			main68k_GetContext(&m_context);
+			return m_context.areg[reg];
+		}
+
+		static inline void setDataRegions(STARSCREAM_DATAREGION *regions, void *handler)
+		{
+			regions[0].lowaddr = 0x000000;
+			regions[0].highaddr = 0x00FFFF;
+			regions[0].memorycall = nullptr;
+			regions[0].userdata = ram;
+			regions[1].lowaddr = 0xC00000;
+			regions[1].highaddr = 0xC0FFFF;
+			regions[1].memorycall = handler;
+			regions[1].userdata = nullptr;
+			regions[2].lowaddr = 0xFF0000;
+			regions[2].highaddr = 0xFFFFFF;
+			regions[2].memorycall = nullptr;
+			regions[2].userdata = ram;
+			regions[3].lowaddr = ~0U;
+			regions[3].highaddr = ~0U;
+			regions[3].memorycall = nullptr;
+			regions[3].userdata = nullptr;
+		}
+};
+
+uint16_t M68KTests::ram[0x8000];
+uint16_t M68KTests::io_last_write;
+unsigned int M68KTests::io_read_count;
+
+void M68KTests::SetUp(void)
+{
+	memset(ram, 0, sizeof(ram));
+	io_last_write = 0;
+	io_read_count = 0;
+	next_int_level = 0;
+
+	m_fetch[0].lowaddr = 0x000000;
+	m_fetch[0].highaddr = 0x00FFFF;
+	m_fetch[0].offset = (uintptr_t)ram;
+	m_fetch[1].lowaddr = ~0U;
+	m_fetch[1].highaddr = ~0U;
+	m_fetch[1].offset = 0;
+
+	setDataRegions(m_readbyte, (void*)io_rb);
+	setDataRegions(m_readword, (void*)io_rw);
+	setDataRegions(m_writebyte, (void*)io_wb);
+	setDataRegions(m_writeword, (void*)io_ww);
+
+	memset(&m_context, 0, sizeof(m_context));
+	m_context.s_fetch = m_context.u_fetch = m_context.fetch = m_fetch;
+	m_context.s_readbyte = m_context.u_readbyte = m_context.readbyte = m_readbyte;
+	m_context.s_readword = m_context.u_readword = m_context.readword = m_readword;
+	m_context.s_writebyte = m_context.u_writebyte = m_context.writebyte = m_writebyte;
+	m_context.s_writeword = m_context.u_writeword = m_context.writeword = m_writeword;
+
+	main68k_SetContext(&m_context);
+	main68k_init();
+
+	// Reset vectors.
+	write32(0x000000, 0x00008000);
+	write32(0x000004, 0x00001000);
+}
+
+void M68KTests::TearDown(void)
+{ }
+
+void M68KTests::loadProgram(const uint16_t *prg, int count)
+{
+	for (int i = 0; i < count; i++) {
+		write16(0x1000 + (i * 2), prg[i]);
+	}
+	ASSERT_EQ(0U, main68k_reset());
+	main68k_tripOdometer();
+}
+
+unsigned int M68KTests::runTo(uint32_t address)
+{
+	const unsigned int start = main68k_readOdometer();
+	for (int i = 0; i < 100000 && main68k_readPC() != address; i++) {
+		// Run one cycle at a time so we stop on the target address.
+		main68k_exec(main68k_readOdometer() + 1);
+	}
+	EXPECT_EQ(address, main68k_readPC());
+	return main68k_readOdometer() - start;
+}
+
+/** Test cases. **/
+
+/**
+ * Reset should load SSP and PC from the vector table.
+ */
+TEST_F(M68KTests, reset)
+{
+	static const uint16_t prg[] = {0x4E71};	// NOP
+	loadProgram(prg, 1);
+
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x00008000U, m_context.areg[7]);
+	EXPECT_EQ(0x00001000U, m_context.pc);
+	EXPECT_EQ(0x2700, m_context.sr);
+}
+
+/**
+ * Arithmetic, flags, and cycle counts.
+ */
+TEST_F(M68KTests, arithmetic)
+{
+	static const uint16_t prg[] = {
+		0x707F,			// 1000: MOVEQ #$7F,D0		4
+		0x7201,			// 1002: MOVEQ #1,D1		4
+		0xD001,			// 1004: ADD.B D1,D0		4
+		0x4E71,			// 1006: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	EXPECT_EQ(12U, runTo(0x1006));
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x00000080U, m_context.dreg[0]);
+	// ADD.B $7F+1: N=1, V=1, Z=0, C=0, X=0
+	EXPECT_EQ(0x0A, m_context.sr & 0x1F);
+}
+
+/**
+ * ADDX/SUBX/NEGX: Z is only cleared, never set.
+ */
+TEST_F(M68KTests, addx_subx_negx)
+{
+	static const uint16_t prg[] = {
+		0x7000,			// 1000: MOVEQ #0,D0
+		0x72FF,			// 1002: MOVEQ #-1,D1
+		0x44FC, 0x0014,		// 1004: MOVE #$14,CCR		X=1, Z=1
+		0xD101,			// 1008: ADDX.B D1,D0
+		0x7401,			// 100A: MOVEQ #1,D2
+		0xD502,			// 100C: ADDX.B D2,D2
+		0x7605,			// 100E: MOVEQ #5,D3
+		0x7805,			// 1010: MOVEQ #5,D4
+		0x44FC, 0x0004,		// 1012: MOVE #$04,CCR		Z=1
+		0x9704,			// 1016: SUBX.B D4,D3
+		0x7A00,			// 1018: MOVEQ #0,D5
+		0x44FC, 0x0014,		// 101A: MOVE #$14,CCR		X=1, Z=1
+		0x4005,			// 101E: NEGX.B D5
+		0x7C00,			// 1020: MOVEQ #0,D6
+		0x44FC, 0x0004,		// 1022: MOVE #$04,CCR		Z=1
+		0x4086,			// 1026: NEGX.L D6
+		0x4E71,			// 1028: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// $00 + $FF + X: Result is 0, so Z is retained.
+	runTo(0x100A);
+	EXPECT_EQ(0x00U, dreg(0) & 0xFF);
+	EXPECT_EQ(0x15, ccr());		// X, Z, C
+
+	// $01 + $01 + X: Result is non-zero, so Z is cleared.
+	runTo(0x100E);
+	EXPECT_EQ(0x03U, dreg(2) & 0xFF);
+	EXPECT_EQ(0x00, ccr());
+
+	// $05 - $05 - X: Z is retained.
+	runTo(0x1018);
+	EXPECT_EQ(0x00U, dreg(3) & 0xFF);
+	EXPECT_EQ(0x04, ccr());		// Z
+
+	// 0 - $00 - X: Result is $FF, so Z is cleared.
+	runTo(0x1020);
+	EXPECT_EQ(0xFFU, dreg(5) & 0xFF);
+	EXPECT_EQ(0x19, ccr());		// X, N, C
+
+	// 0 - 0 - X: Z is retained.
+	runTo(0x1028);
+	EXPECT_EQ(0x00000000U, dreg(6));
+	EXPECT_EQ(0x04, ccr());		// Z
+}
+
+/**
+ * ABCD/SBCD/NBCD.
+ */
+TEST_F(M68KTests, bcd)
+{
+	static const uint16_t prg[] = {
+		0x44FC, 0x0000,		// 1000: MOVE #0,CCR
+		0x7019,			// 1004: MOVEQ #$19,D0
+		0x7228,			// 1006: MOVEQ #$28,D1
+		0xC101,			// 1008: ABCD D1,D0
+		0x7099,			// 100A: MOVEQ #$99,D0
+		0x7201,			// 100C: MOVEQ #1,D1
+		0x44FC, 0x0004,		// 100E: MOVE #$04,CCR		Z=1
+		0xC101,			// 1012: ABCD D1,D0
+		0x7047,			// 1014: MOVEQ #$47,D0
+		0x7228,			// 1016: MOVEQ #$28,D1
+		0x44FC, 0x0000,		// 1018: MOVE #0,CCR
+		0x8101,			// 101C: SBCD D1,D0
+		0x7001,			// 101E: MOVEQ #1,D0
+		0x44FC, 0x0000,		// 1020: MOVE #0,CCR
+		0x4800,			// 1024: NBCD D0
+		0x4E71,			// 1026: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// $19 + $28 = $47
+	runTo(0x100A);
+	EXPECT_EQ(0x47U, dreg(0) & 0xFF);
+	EXPECT_EQ(0x00, ccr());
+
+	// $99 + $01 = $00, carry. Z is retained.
+	runTo(0x1014);
+	EXPECT_EQ(0x00U, dreg(0) & 0xFF);
+	EXPECT_EQ(0x15, ccr());		// X, Z, C
+
+	// $47 - $28 = $19
+	runTo(0x101E);
+	EXPECT_EQ(0x19U, dreg(0) & 0xFF);
+	EXPECT_EQ(0x00, ccr());
+
+	// 0 - $01 = $99, borrow.
+	runTo(0x1026);
+	EXPECT_EQ(0x99U, dreg(0) & 0xFF);
+	EXPECT_EQ(0x11, ccr() & 0x15);	// X, C; Z cleared
+}
+
+/**
+ * DIVU/DIVS results and overflow.
+ * On overflow, V is set, C is cleared, and the
+ * destination register is not modified.
+ */
+TEST_F(M68KTests, divide)
+{
+	static const uint16_t prg[] = {
+		0x203C, 0x0001, 0x0000,	// 1000: MOVE.L #$10000,D0
+		0x80FC, 0x0001,		// 1006: DIVU #1,D0
+		0x223C, 0x8000, 0x0000,	// 100A: MOVE.L #$80000000,D1
+		0x83FC, 0xFFFF,		// 1010: DIVS #-1,D1
+		0x74F9,			// 1014: MOVEQ #-7,D2
+		0x85FC, 0x0002,		// 1016: DIVS #2,D2
+		0x263C, 0x0010, 0x0000,	// 101A: MOVE.L #$100000,D3
+		0x87FC, 0x0010,		// 1020: DIVS #16,D3
+		0x4E71,			// 1024: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// $10000 / 1: Quotient doesn't fit in 16 bits.
+	runTo(0x100A);
+	EXPECT_EQ(0x00010000U, dreg(0));
+	EXPECT_EQ(0x02, ccr() & 0x03);	// V
+
+	// $80000000 / -1: Quotient doesn't fit in 16 bits.
+	runTo(0x1014);
+	EXPECT_EQ(0x80000000U, dreg(1));
+	EXPECT_EQ(0x02, ccr() & 0x03);	// V
+
+	// -7 / 2 = -3, remainder -1. (Remainder has the sign of the dividend.)
+	runTo(0x101A);
+	EXPECT_EQ(0xFFFFFFFDU, dreg(2));
+	EXPECT_EQ(0x08, ccr() & 0x0F);	// N
+
+	// $100000 / 16 = $10000: Positive signed overflow.
+	runTo(0x1024);
+	EXPECT_EQ(0x00100000U, dreg(3));
+	EXPECT_EQ(0x02, ccr() & 0x03);	// V
+}
+
+/**
+ * Shift and rotate counts of 0, >= 32, and ROXL/ROXR through X.
+ */
+TEST_F(M68KTests, shift_rotate)
+{
+	static const uint16_t prg[] = {
+		0x203C, 0x8000, 0x0001,	// 1000: MOVE.L #$80000001,D0
+		0x7220,			// 1006: MOVEQ #32,D1
+		0xE3A8,			// 1008: LSL.L D1,D0
+		0x203C, 0x8000, 0x0001,	// 100A: MOVE.L #$80000001,D0
+		0x7221,			// 1010: MOVEQ #33,D1
+		0xE3A8,			// 1012: LSL.L D1,D0
+		0x203C, 0x8000, 0x0000,	// 1014: MOVE.L #$80000000,D0
+		0x7228,			// 101A: MOVEQ #40,D1
+		0xE2A0,			// 101C: ASR.L D1,D0
+		0x7005,			// 101E: MOVEQ #5,D0
+		0x7240,			// 1020: MOVEQ #64,D1
+		0x44FC, 0x0011,		// 1022: MOVE #$11,CCR		X=1, C=1
+		0xE2A8,			// 1026: LSR.L D1,D0
+		0x7080,			// 1028: MOVEQ #$80,D0
+		0x44FC, 0x0010,		// 102A: MOVE #$10,CCR		X=1
+		0xE310,			// 102E: ROXL.B #1,D0
+		0x7001,			// 1030: MOVEQ #1,D0
+		0x44FC, 0x0000,		// 1032: MOVE #0,CCR
+		0xE210,			// 1036: ROXR.B #1,D0
+		0x7000,			// 1038: MOVEQ #0,D0
+		0x7209,			// 103A: MOVEQ #9,D1
+		0x44FC, 0x0010,		// 103C: MOVE #$10,CCR		X=1
+		0xE330,			// 1040: ROXL.B D1,D0
+		0x4E71,			// 1042: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// LSL.L #32: Result is 0; C and X are the last bit shifted out. (bit 0)
+	runTo(0x100A);
+	EXPECT_EQ(0x00000000U, dreg(0));
+	EXPECT_EQ(0x15, ccr());		// X, Z, C
+
+	// LSL.L #33: Result is 0; C and X are cleared.
+	runTo(0x1014);
+	EXPECT_EQ(0x00000000U, dreg(0));
+	EXPECT_EQ(0x04, ccr());		// Z
+
+	// ASR.L #40: Result is the sign bit.
+	runTo(0x101E);
+	EXPECT_EQ(0xFFFFFFFFU, dreg(0));
+	EXPECT_EQ(0x19, ccr());		// X, N, C
+
+	// LSR.L D1 with D1 == 64: Count is modulo 64, so nothing is shifted.
+	// C is cleared; X is unaffected.
+	runTo(0x1028);
+	EXPECT_EQ(0x00000005U, dreg(0));
+	EXPECT_EQ(0x10, ccr());		// X
+
+	// ROXL.B #1: X is shifted in; bit 7 is shifted out to X and C.
+	runTo(0x1030);
+	EXPECT_EQ(0xFFFFFF01U, dreg(0));
+	EXPECT_EQ(0x11, ccr());		// X, C
+
+	// ROXR.B #1: X is shifted in; bit 0 is shifted out to X and C.
+	runTo(0x1038);
+	EXPECT_EQ(0x00000000U, dreg(0));
+	EXPECT_EQ(0x15, ccr());		// X, Z, C
+
+	// ROXL.B D1 with D1 == 9: Rotating 9 bits through X is a no-op.
+	// C is set to X.
+	runTo(0x1042);
+	EXPECT_EQ(0x00000000U, dreg(0));
+	EXPECT_EQ(0x15, ccr());		// X, Z, C
+}
+
+/**
+ * MOVEM -(An) register ordering.
+ */
+TEST_F(M68KTests, movem_predec)
+{
+	static const uint16_t prg[] = {
+		0x7011,			// 1000: MOVEQ #$11,D0
+		0x7222,			// 1002: MOVEQ #$22,D1
+		0x207C, 0x0000, 0x7000,	// 1004: MOVEA.L #$7000,A0
+		0x227C, 0x0000, 0x6000,	// 100A: MOVEA.L #$6000,A1
+		0x48E1, 0xC0C0,		// 1010: MOVEM.L D0-D1/A0-A1,-(A1)
+		0x4CD9, 0x003C,		// 1014: MOVEM.L (A1)+,D2-D5
+		0x4E71,			// 1018: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// The lowest-numbered register is stored at the lowest address.
+	// A1 is stored with its initial value.
+	runTo(0x1014);
+	EXPECT_EQ(0x00005FF0U, areg(1));
+	EXPECT_EQ(0x00000011U, read32(0x5FF0));
+	EXPECT_EQ(0x00000022U, read32(0x5FF4));
+	EXPECT_EQ(0x00007000U, read32(0x5FF8));
+	EXPECT_EQ(0x00006000U, read32(0x5FFC));
+
+	runTo(0x1018);
+	EXPECT_EQ(0x00006000U, areg(1));
+	EXPECT_EQ(0x00000011U, dreg(2));
+	EXPECT_EQ(0x00000022U, dreg(3));
+	EXPECT_EQ(0x00007000U, dreg(4));
+	EXPECT_EQ(0x00006000U, dreg(5));
+}
+
+/**
+ * CHK, TRAPV, and divide by zero exceptions.
+ */
+TEST_F(M68KTests, exceptions)
+{
+	static const uint16_t prg[] = {
+		0x7005,			// 1000: MOVEQ #5,D0
+		0x720A,			// 1002: MOVEQ #10,D1
+		0x4181,			// 1004: CHK.W D1,D0
+		0x70FF,			// 1006: MOVEQ #-1,D0
+		0x4181,			// 1008: CHK.W D1,D0
+		0x700B,			// 100A: MOVEQ #11,D0
+		0x4181,			// 100C: CHK.W D1,D0
+		0x44FC, 0x0000,		// 100E: MOVE #0,CCR
+		0x4E76,			// 1012: TRAPV
+		0x44FC, 0x0002,		// 1014: MOVE #$02,CCR		V=1
+		0x4E76,			// 1018: TRAPV
+		0x80FC, 0x0000,		// 101A: DIVU #0,D0
+		0x4E71,			// 101E: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// Exception handler: Count exceptions in D7.
+	write32(0x14, 0x00001100);	// Divide by zero
+	write32(0x18, 0x00001100);	// CHK
+	write32(0x1C, 0x00001100);	// TRAPV
+	write16(0x1100, 0x5287);	// ADDQ.L #1,D7
+	write16(0x1102, 0x4E73);	// RTE
+
+	// In bounds: No exception.
+	runTo(0x1006);
+	EXPECT_EQ(0U, dreg(7));
+
+	// Negative: Exception with N set.
+	// The stacked PC is the next instruction.
+	runTo(0x1100);
+	EXPECT_EQ(0x00008000U - 6, areg(7));
+	EXPECT_EQ(0x0000100AU, read32(areg(7) + 2));
+	runTo(0x100A);
+	EXPECT_EQ(1U, dreg(7));
+	EXPECT_EQ(0x08, ccr() & 0x08);	// N
+	EXPECT_EQ(0x00008000U, areg(7));
+
+	// Greater than the upper bound: Exception with N cleared.
+	runTo(0x1100);
+	EXPECT_EQ(0x0000100EU, read32(areg(7) + 2));
+	runTo(0x100E);
+	EXPECT_EQ(2U, dreg(7));
+	EXPECT_EQ(0x00, ccr() & 0x08);
+
+	// TRAPV with V clear: No exception.
+	runTo(0x1014);
+	EXPECT_EQ(2U, dreg(7));
+
+	// TRAPV with V set.
+	runTo(0x1100);
+	EXPECT_EQ(0x0000101AU, read32(areg(7) + 2));
+	runTo(0x101A);
+	EXPECT_EQ(3U, dreg(7));
+
+	// Divide by zero.
+	runTo(0x1100);
+	EXPECT_EQ(0x0000101EU, read32(areg(7) + 2));
+	runTo(0x101E);
+	EXPECT_EQ(4U, dreg(7));
+}
+
+/**
+ * Word and long accesses to odd addresses.
+ * Address errors are not emulated, same as Starscream;
+ * the access is aligned to the previous word instead.
+ */
+TEST_F(M68KTests, address_error)
+{
+	static const uint16_t prg[] = {
+		0x3039, 0x0000, 0x2001,	// 1000: MOVE.W ($2001).L,D0
+		0x2239, 0x0000, 0x2001,	// 1006: MOVE.L ($2001).L,D1
+		0x33C0, 0x0000, 0x2005,	// 100C: MOVE.W D0,($2005).L
+		0x4E71,			// 1012: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+	write32(0x2000, 0x12345678);
+
+	// Address error vector.
+	write32(0x0C, 0x00001100);
+	write16(0x1100, 0x7EFF);	// MOVEQ #-1,D7
+	write16(0x1102, 0x60FE);	// BRA.S *
+
+	runTo(0x1012);
+	EXPECT_EQ(0x1234U, dreg(0) & 0xFFFF);
+	EXPECT_EQ(0x12345678U, dreg(1));
+	EXPECT_EQ(0x1234, read16(0x2004));
+	EXPECT_EQ(0U, dreg(7));
+	EXPECT_EQ(0x00008000U, areg(7));
+}
+
+/**
+ * DBRA loop with MULU/DIVU.
+ */
+TEST_F(M68KTests, loop)
+{
+	static const uint16_t prg[] = {
+		0x7000,			// 1000: MOVEQ #0,D0
+		0x7209,			// 1002: MOVEQ #9,D1
+		0x5280,			// 1004: ADDQ.L #1,D0
+		0x51C9, 0xFFFC,		// 1006: DBRA D1,$1004
+		0xC0FC, 0x0064,		// 100A: MULU #100,D0
+		0x80FC, 0x0007,		// 100E: DIVU #7,D0
+		0x4E71,			// 1012: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	runTo(0x1012);
+	main68k_GetContext(&m_context);
+	// 1000 / 7 = 142, remainder 6
+	EXPECT_EQ((6U << 16) | 142U, m_context.dreg[0]);
+	EXPECT_EQ(0x0000FFFFU, m_context.dreg[1]);
+}
+
+/**
+ * MOVEM, LINK/UNLK, and BSR/RTS.
+ */
+TEST_F(M68KTests, stack)
+{
+	static const uint16_t prg[] = {
+		0x7011,			// 1000: MOVEQ #$11,D0
+		0x7222,			// 1002: MOVEQ #$22,D1
+		0x48E7, 0xC000,		// 1004: MOVEM.L D0-D1,-(SP)
+		0x7000,			// 1008: MOVEQ #0,D0
+		0x7200,			// 100A: MOVEQ #0,D1
+		0x4CDF, 0x0003,		// 100C: MOVEM.L (SP)+,D0-D1
+		0x6102,			// 1010: BSR.S $1014
+		0x4E71,			// 1012: NOP
+		0x4E56, 0xFFF8,		// 1014: LINK A6,#-8
+		0x4E5E,			// 1018: UNLK A6
+		0x4E75,			// 101A: RTS
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	runTo(0x1018);
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x00000011U, m_context.dreg[0]);
+	EXPECT_EQ(0x00000022U, m_context.dreg[1]);
+	EXPECT_EQ(0x00008000U - 4 - 4 - 8, m_context.areg[7]);
+	EXPECT_EQ(0x00001012U, read32(0x8000 - 4));
+
+	runTo(0x1012);
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x00008000U, m_context.areg[7]);
+}
+
+/**
+ * Byte and word accesses through memory handlers.
+ */
+TEST_F(M68KTests, handlers)
+{
+	static const uint16_t prg[] = {
+		0x1039, 0x00C0, 0x0001,	// 1000: MOVE.B ($C00001).L,D0
+		0x3239, 0x00C0, 0x0000,	// 1006: MOVE.W ($C00000).L,D1
+		0x33C1, 0x00C0, 0x0000,	// 100C: MOVE.W D1,($C00000).L
+		0x4E71,			// 1012: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	runTo(0x1012);
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x5AU, m_context.dreg[0] & 0xFF);
+	EXPECT_EQ(0xA55AU, m_context.dreg[1] & 0xFFFF);
+	EXPECT_EQ(0xA55A, io_last_write);
+}
+
+/**
+ * Autovectored interrupts.
+ */
+TEST_F(M68KTests, interrupt)
+{
+	static const uint16_t prg[] = {
+		0x46FC, 0x2000,		// 1000: MOVE #$2000,SR
+		0x4E72, 0x2000,		// 1004: STOP #$2000
+		0x4E71,			// 1008: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// Level 6 autovector.
+	write32(0x78, 0x00001100);
+	write16(0x1100, 0x7042);	// MOVEQ #$42,D0
+	write16(0x1102, 0x4E73);	// RTE
+
+	// The CPU should stop.
+	EXPECT_EQ(0x80000000U, main68k_exec(100));
+	EXPECT_EQ(0x80000004U, main68k_exec(200));
+	EXPECT_EQ(0x00001008U, main68k_readPC());
+
+	// Raise the interrupt.
+	EXPECT_EQ(0, main68k_interrupt(6, -1));
+	runTo(0x1102);
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x00000042U, m_context.dreg[0]);
+	EXPECT_EQ(0x2600, m_context.sr & 0x2700);
+
+	runTo(0x1008);
+	main68k_GetContext(&m_context);
+	EXPECT_EQ(0x2000, m_context.sr & 0x2700);
+}
+
+/**
+ * Odometer handling.
+ */
+TEST_F(M68KTests, odometer)
+{
+	static const uint16_t prg[] = {
+		0x60FE,			// 1000: BRA.S $1000
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	EXPECT_EQ(0x80000000U, main68k_exec(100));
+	EXPECT_EQ(100U, main68k_readOdometer());
+	EXPECT_EQ(0x80000003U, main68k_exec(100));
+	main68k_addCycles(20);
+	EXPECT_EQ(120U, main68k_tripOdometer());
+	EXPECT_EQ(0U, main68k_readOdometer());
+}
+
+/**
+ * Idle loop: Polling a RAM flag.
+ * The rest of the timeslice is skipped after the first iteration.
+ */
+TEST_F(M68KTests, idle_loop_ram)
+{
+	static const uint16_t prg[] = {
+		0x4A78, 0xA000,		// 1000: TST.W ($FFA000).W	12
+		0x67FA,			// 1004: BEQ.S $1000		10
+		0x4E71,			// 1006: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	// If the loop is skipped, the timeslice ends exactly on time.
+	// Otherwise, the last iteration overshoots. (1001 isn't a multiple of 22.)
+	main68k_setIdleLoopDetect(1);
+	main68k_exec(1001);
+	EXPECT_EQ(1001U, main68k_readOdometer());
+	EXPECT_EQ(0x00001000U, main68k_readPC());
+
+	// Same loop with idle loop detection disabled.
+	loadProgram(prg, ARRAY_SIZE(prg));
+	main68k_setIdleLoopDetect(0);
+	main68k_exec(1001);
+	EXPECT_NE(1001U, main68k_readOdometer());
+}
+
+/**
+ * Polling the HV counter is not an idle loop,
+ * since the value changes within the timeslice.
+ */
+TEST_F(M68KTests, idle_loop_hv_counter)
+{
+	static const uint16_t prg[] = {
+		0x0C39, 0x0042, 0x00C0, 0x0008,	// 1000: CMPI.B #$42,($C00008).L
+		0x66F6,				// 1008: BNE.S $1000
+		0x4E71,				// 100A: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	main68k_setIdleLoopDetect(1);
+	main68k_exec(1000);
+	EXPECT_GT(io_read_count, 1U);
+
+	// Reading the VDP status port has side effects,
+	// so polling it isn't an idle loop either.
+	static const uint16_t prg_status[] = {
+		0x0839, 0x0003, 0x00C0, 0x0005,	// 1000: BTST #3,($C00005).L
+		0x66F6,				// 1008: BNE.S $1000
+		0x4E71,				// 100A: NOP
+	};
+	loadProgram(prg_status, ARRAY_SIZE(prg_status));
+	io_read_count = 0;
+	main68k_exec(1000);
+	EXPECT_GT(io_read_count, 1U);
+}
+
+/**
+ * Waiting for the VDP FIFO to empty is not an idle loop,
+ * since reading the status port updates the FIFO flags.
+ */
+TEST_F(M68KTests, idle_loop_vdp_fifo)
+{
+	static const uint16_t prg[] = {
+		0x3039, 0x00C0, 0x0004,		// 1000: MOVE.W ($C00004).L,D0
+		0x0800, 0x0009,			// 1006: BTST #9,D0
+		0x67F4,				// 100A: BEQ.S $1000
+		0x4E71,				// 100C: NOP
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+
+	main68k_setIdleLoopDetect(1);
+	main68k_exec(1000);
+	EXPECT_GT(io_read_count, 1U);
+}
+
+/**
+ * A loop that writes a register read earlier in the loop
+ * is not idle, since the next iteration sees a different value.
+ */
+TEST_F(M68KTests, idle_loop_live_in)
+{
+	static const uint16_t prg[] = {
+		0x3200,				// 1000: MOVE.W D0,D1
+		0x3039, 0x00FF, 0xA000,		// 1002: MOVE.W ($FFA000).L,D0
+		0xB240,				// 1008: CMP.W D0,D1
+		0x66F4,				// 100A: BNE.S $1000
+		0x60FE,				// 100C: BRA.S $100C
+	};
+	loadProgram(prg, ARRAY_SIZE(prg));
+	write16(0xA000, 5);
+
+	// The first iteration compares 0 to 5; the second compares 5 to 5.
+	main68k_setIdleLoopDetect(1);
+	main68k_exec(1000);
+	EXPECT_EQ(0x0000100CU, main68k_readPC());
+}
+
+} }
+
+
+int main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: M68K tests.\n\n");
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,198 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * RewindBufferTest.cpp: Rewind buffer test.                               *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// LibGens.
+#include "lg_main.hpp"
+#include "Util/RewindBuffer.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibGens { namespace Tests {
+
+class RewindBufferTest : public ::testing::Test
+{
+	protected:
+		RewindBufferTest() { }
+		virtual ~RewindBufferTest() { }
+
+	protected:
+		// Snapshot size. (Similar to an MD snapshot.)
+		static const size_t SNAPSHOT_SIZE = 160*1024;
+
+		/**
+		 * Generate a fake snapshot for the specified frame.
+		 * A small part of the snapshot changes every frame,
+		 * similar to a real emulated system.
+		 * @param frame Frame number.
+		 * @return Snapshot.
+		 */
+		static vector<uint8_t> makeSnapshot(int frame);
+};
+
+/**
+ * Generate a fake snapshot for the specified frame.
+ * @param frame Frame number.
+ * @return Snapshot.
+ */
+vector<uint8_t> RewindBufferTest::makeSnapshot(int frame)
+{
+	vector<uint8_t> snapshot(SNAPSHOT_SIZE);
+	for (size_t i = 0; i < snapshot.size(); i++) {
+		snapshot[i] = (uint8_t)(i * 7);
+	}
+
+	// "Work RAM": A few scattered bytes.
+	for (int i = 0; i < 64; i++) {
+		snapshot[(i * 997) % SNAPSHOT_SIZE] = (uint8_t)(frame + i);
+	}
+	// "VRAM": A contiguous block.
+	memset(&snapshot[65536 + (frame % 64) * 256], frame & 0xFF, 256);
+	return snapshot;
+}
+
+/**
+ * Push several snapshots, then pop them in reverse order.
+ */
+TEST_F(RewindBufferTest, pushPop)
+{
+	RewindBuffer rewind(64*1024*1024, 1, 16);
+	for (int frame = 0; frame < 100; frame++) {
+		const vector<uint8_t> snapshot = makeSnapshot(frame);
+		ASSERT_EQ(0, rewind.push(snapshot.data(), snapshot.size()));
+	}
+	EXPECT_EQ(100U, rewind.count());
+
+	// Deltas should be much smaller than full snapshots.
+	EXPECT_LT(rewind.used(), 10 * SNAPSHOT_SIZE);
+
+	for (int frame = 99; frame >= 0; frame--) {
+		const vector<uint8_t> expected = makeSnapshot(frame);
+		const uint8_t *snapshot;
+		ASSERT_EQ((int)expected.size(), rewind.pop(&snapshot)) << "frame " << frame;
+		ASSERT_EQ(0, memcmp(expected.data(), snapshot, expected.size())) << "frame " << frame;
+	}
+
+	EXPECT_EQ(0U, rewind.count());
+	EXPECT_EQ(0U, rewind.used());
+	const uint8_t *snapshot;
+	EXPECT_EQ(-ENOENT, rewind.pop(&snapshot));
+}
+
+/**
+ * Push snapshots after popping some of them.
+ */
+TEST_F(RewindBufferTest, pushAfterPop)
+{
+	RewindBuffer rewind(64*1024*1024, 1, 8);
+	for (int frame = 0; frame < 20; frame++) {
+		const vector<uint8_t> snapshot = makeSnapshot(frame);
+		ASSERT_EQ(0, rewind.push(snapshot.data(), snapshot.size()));
+	}
+
+	// Pop back past a keyframe.
+	const uint8_t *snapshot;
+	for (int i = 0; i < 12; i++) {
+		ASSERT_GT(rewind.pop(&snapshot), 0);
+	}
+
+	// Push different snapshots.
+	for (int frame = 1000; frame < 1020; frame++) {
+		const vector<uint8_t> snapshot = makeSnapshot(frame);
+		ASSERT_EQ(0, rewind.push(snapshot.data(), snapshot.size()));
+	}
+
+	for (int frame = 1019; frame >= 1000; frame--) {
+		const vector<uint8_t> expected = makeSnapshot(frame);
+		ASSERT_EQ((int)expected.size(), rewind.pop(&snapshot)) << "frame " << frame;
+		ASSERT_EQ(0, memcmp(expected.data(), snapshot, expected.size())) << "frame " << frame;
+	}
+	for (int frame = 7; frame >= 0; frame--) {
+		const vector<uint8_t> expected = makeSnapshot(frame);
+		ASSERT_EQ((int)expected.size(), rewind.pop(&snapshot)) << "frame " << frame;
+		ASSERT_EQ(0, memcmp(expected.data(), snapshot, expected.size())) << "frame " << frame;
+	}
+	EXPECT_EQ(0U, rewind.count());
+}
+
+/**
+ * Make sure old snapshots are discarded when the buffer is full.
+ */
+TEST_F(RewindBufferTest, evict)
+{
+	const size_t maxBytes = 4 * SNAPSHOT_SIZE;
+	RewindBuffer rewind(maxBytes, 1, 8);
+	for (int frame = 0; frame < 200; frame++) {
+		const vector<uint8_t> snapshot = makeSnapshot(frame);
+		ASSERT_EQ(0, rewind.push(snapshot.data(), snapshot.size()));
+		ASSERT_LE(rewind.used(), maxBytes);
+	}
+	EXPECT_LT(rewind.count(), 200U);
+
+	// The most recent snapshots must still be intact.
+	int frame = 199;
+	const uint8_t *snapshot;
+	while (rewind.count() > 0) {
+		const vector<uint8_t> expected = makeSnapshot(frame);
+		ASSERT_EQ((int)expected.size(), rewind.pop(&snapshot)) << "frame " << frame;
+		ASSERT_EQ(0, memcmp(expected.data(), snapshot, expected.size())) << "frame " << frame;
+		frame--;
+	}
+}
+
+/**
+ * Snapshots must be a multiple of 4 bytes.
+ */
+TEST_F(RewindBufferTest, invalidSize)
+{
+	RewindBuffer rewind;
+	uint8_t buf[7] = {0};
+	EXPECT_EQ(-EINVAL, rewind.push(buf, sizeof(buf)));
+	EXPECT_EQ(-EINVAL, rewind.push(buf, 0));
+	EXPECT_EQ(0U, rewind.count());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: RewindBuffer tests.\n\n");
+	LibGens::Init();
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
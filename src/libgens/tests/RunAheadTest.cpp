@@ -0,0 +1,495 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * RunAheadTest.cpp: Snapshot determinism and run-ahead tests.             *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// LibGens.
+#include "lg_main.hpp"
+#include "Rom.hpp"
+#include "EmuContext/EmuMD.hpp"
+#include "Util/MdFb.hpp"
+#include "Util/RunAhead.hpp"
+#include "Vdp/Vdp.hpp"
+#include "sound/SoundMgr.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibGens { namespace Tests {
+
+class RunAheadTest : public ::testing::Test
+{
+	protected:
+		RunAheadTest()
+			: m_rom(nullptr) { }
+		virtual ~RunAheadTest() { }
+
+		virtual void SetUp(void) override;
+		virtual void TearDown(void) override;
+
+		/**
+		 * Results of running a frame.
+		 */
+		struct FrameResult {
+			// Snapshot of the emulated state.
+			vector<uint8_t> snapshot;
+			// Displayed framebuffer.
+			vector<uint32_t> fb;
+			// Audio output.
+			vector<int16_t> audio;
+		};
+
+		// Number of frames to run before each test,
+		// so the sound chips are busy.
+		static const int WARMUP_FRAMES = 10;
+
+		// Number of frames to compare.
+		static const int NUM_FRAMES = 30;
+
+		// Number of frames to run ahead.
+		static const int RUNAHEAD_FRAMES = 2;
+
+		/**
+		 * Create an emulation context for the test ROM.
+		 * @return Emulation context.
+		 */
+		EmuMD *createContext(void);
+
+		/**
+		 * Save a snapshot.
+		 * @param context Emulation context.
+		 * @param snapshot [out] Snapshot.
+		 */
+		static void saveSnapshot(EmuContext *context, vector<uint8_t> *snapshot);
+
+		/**
+		 * Get the results of the last frame.
+		 * This clears the audio buffers.
+		 * @param context Emulation context.
+		 * @param result [out] Results.
+		 */
+		static void getResult(EmuContext *context, FrameResult *result);
+
+		/**
+		 * Run frames without run-ahead.
+		 * @param results [out] Results for each frame.
+		 * @param count Number of frames to run.
+		 */
+		void runPlain(vector<FrameResult> *results, int count);
+
+		/**
+		 * Run frames with run-ahead, and compare them to plain emulation.
+		 * @param threaded If true, use threaded mode.
+		 */
+		void checkRunAhead(bool threaded);
+
+	protected:
+		// Test ROM.
+		static const unsigned int ROM_SIZE = 0x1000;
+		uint8_t m_romData[ROM_SIZE];
+		Rom *m_rom;
+};
+
+/**
+ * Z80 sound driver.
+ *
+ * Sets up YM2612 channel 1 and both timers, then toggles
+ * the channel's key-on and changes the PSG tone every time
+ * YM2612 Timer A overflows.
+ */
+static const uint8_t z80_driver[] = {
+	0xF3,			// 0000: di
+	0x31, 0x00, 0x20,	// 0001: ld sp,2000h
+	0xED, 0x56,		// 0004: im 1
+	0x21, 0x00, 0x40,	// 0006: ld hl,4000h
+	0x11, 0x80, 0x00,	// 0009: ld de,ym_init
+	0x1A,			// 000C: init: ld a,(de)
+	0xFE, 0xFF,		// 000D: cp 0FFh
+	0x28, 0x09,		// 000F: jr z,psg
+	0x77,			// 0011: ld (hl),a
+	0x13,			// 0012: inc de
+	0x1A,			// 0013: ld a,(de)
+	0x32, 0x01, 0x40,	// 0014: ld (4001h),a
+	0x13,			// 0017: inc de
+	0x18, 0xF2,		// 0018: jr init
+	0x21, 0x11, 0x7F,	// 001A: psg: ld hl,7F11h
+	0x36, 0x90,		// 001D: ld (hl),90h	; Tone 0 volume
+	0x36, 0xE4,		// 001F: ld (hl),0E4h	; White noise
+	0x36, 0xF2,		// 0021: ld (hl),0F2h	; Noise volume
+	0x21, 0x00, 0x40,	// 0023: ld hl,4000h
+	0x01, 0x00, 0xF0,	// 0026: ld bc,0F000h	; B = key-on; C = tone
+	0x3A, 0x00, 0x40,	// 0029: main: ld a,(4000h)
+	0xE6, 0x01,		// 002C: and 01h	; Timer A overflow?
+	0x28, 0xF9,		// 002E: jr z,main
+	0x36, 0x27,		// 0030: ld (hl),27h
+	0x3E, 0x1F,		// 0032: ld a,1Fh	; Reload timers; reset A.
+	0x32, 0x01, 0x40,	// 0034: ld (4001h),a
+	0x78,			// 0037: ld a,b
+	0xEE, 0xF0,		// 0038: xor 0F0h	; Toggle key-on.
+	0x47,			// 003A: ld b,a
+	0x36, 0x28,		// 003B: ld (hl),28h
+	0x32, 0x01, 0x40,	// 003D: ld (4001h),a
+	0x0C,			// 0040: inc c
+	0x79,			// 0041: ld a,c
+	0xE6, 0x0F,		// 0042: and 0Fh
+	0xF6, 0x80,		// 0044: or 80h		; Tone 0 low bits
+	0x32, 0x11, 0x7F,	// 0046: ld (7F11h),a
+	0x79,			// 0049: ld a,c
+	0x0F, 0x0F, 0x0F, 0x0F,	// 004A: rrca x4
+	0xE6, 0x0F,		// 004E: and 0Fh
+	0xF6, 0x08,		// 0050: or 08h		; Tone 0 high bits
+	0x32, 0x11, 0x7F,	// 0052: ld (7F11h),a
+	0x18, 0xD2,		// 0055: jr main
+};
+
+/**
+ * YM2612 initialization table for the Z80 driver. (at 0080h)
+ * Register/value pairs, terminated by 0FFh.
+ */
+static const uint8_t z80_ym_init[] = {
+	0x22, 0x00, 0x27, 0x00, 0x28, 0x00, 0x2B, 0x00,	// LFO, timers, key-off, DAC
+	0x30, 0x71, 0x34, 0x0D, 0x38, 0x33, 0x3C, 0x01,	// DT/MUL
+	0x40, 0x23, 0x44, 0x2D, 0x48, 0x26, 0x4C, 0x00,	// TL
+	0x50, 0x5F, 0x54, 0x99, 0x58, 0x5F, 0x5C, 0x94,	// RS/AR
+	0x60, 0x05, 0x64, 0x05, 0x68, 0x05, 0x6C, 0x07,	// AM/D1R
+	0x70, 0x02, 0x74, 0x02, 0x78, 0x02, 0x7C, 0x02,	// D2R
+	0x80, 0x11, 0x84, 0x11, 0x88, 0x11, 0x8C, 0xA6,	// D1L/RR
+	0x90, 0x00, 0x94, 0x00, 0x98, 0x00, 0x9C, 0x00,	// SSG-EG
+	0xB0, 0x32, 0xB4, 0xC0, 0xA4, 0x22, 0xA0, 0x69,	// Algorithm, panning, frequency
+	0x24, 0xC0, 0x25, 0x00, 0x26, 0xE0, 0x27, 0x1F,	// Timers
+	0x28, 0xF0,					// Key-on
+	0xFF
+};
+
+/**
+ * 68000 program. (at $000200)
+ *
+ * Loads the Z80 driver, enables VBlank interrupts,
+ * and waits in STOP. The main loop counts VBlank
+ * interrupts, and the VBlank handler sets the
+ * background color to the count.
+ */
+static const uint16_t m68k_program[] = {
+	0x46FC, 0x2700,				// 000200: move #$2700,sr
+	0x33FC, 0x0100, 0x00A1, 0x1100,		// 000204: move.w #$0100,$A11100	; Z80 bus request
+	0x33FC, 0x0100, 0x00A1, 0x1200,		// 00020C: move.w #$0100,$A11200	; Z80 reset off
+	0x41FA, 0x00EA,				// 000214: lea z80_driver(pc),a0
+	0x43F9, 0x00A0, 0x0000,			// 000218: lea $A00000,a1
+	0x303C, 0x00FF,				// 00021E: move.w #$FF,d0
+	0x12D8,					// 000222: copy: move.b (a0)+,(a1)+
+	0x51C8, 0xFFFC,				// 000224: dbra d0,copy
+	0x33FC, 0x0000, 0x00A1, 0x1200,		// 000228: move.w #$0000,$A11200	; Z80 reset on
+	0x33FC, 0x0000, 0x00A1, 0x1100,		// 000230: move.w #$0000,$A11100	; Z80 bus release
+	0x33FC, 0x0100, 0x00A1, 0x1200,		// 000238: move.w #$0100,$A11200	; Z80 reset off
+	0x41F9, 0x00C0, 0x0004,			// 000240: lea $C00004,a0
+	0x30BC, 0x8004,				// 000246: move.w #$8004,(a0)
+	0x30BC, 0x8164,				// 00024A: move.w #$8164,(a0)	; Display, VBlank, Mode 5
+	0x30BC, 0x8C81,				// 00024E: move.w #$8C81,(a0)	; H40
+	0x30BC, 0x8F02,				// 000252: move.w #$8F02,(a0)
+	0x7E00,					// 000256: moveq #0,d7
+	0x46FC, 0x2000,				// 000258: move #$2000,sr
+	0x4E72, 0x2000,				// 00025C: loop: stop #$2000
+	0x5247,					// 000260: addq.w #1,d7
+	0x60F8,					// 000262: bra.s loop
+	0x20BC, 0xC000, 0x0000,			// 000264: vint: move.l #$C0000000,(a0)	; CRAM write, color 0
+	0x3147, 0xFFFC,				// 00026A: move.w d7,-4(a0)
+	0x4E73,					// 00026E: rte
+	0x60FE,					// 000270: error: bra.s error
+};
+
+/**
+ * Build the test ROM and initialize the library.
+ */
+void RunAheadTest::SetUp(void)
+{
+	memset(m_romData, 0xFF, sizeof(m_romData));
+
+	// Vector table.
+	// All exceptions go to the error loop, except for VBlank.
+	#define WRITE32(addr, val) do { \
+		m_romData[(addr)+0] = (uint8_t)((val) >> 24); \
+		m_romData[(addr)+1] = (uint8_t)((val) >> 16); \
+		m_romData[(addr)+2] = (uint8_t)((val) >> 8); \
+		m_romData[(addr)+3] = (uint8_t)(val); \
+	} while (0)
+	for (int i = 2; i < 64; i++) {
+		WRITE32(i * 4, 0x000270);
+	}
+	WRITE32(0x00, 0x00FFFE00);	// Initial SSP
+	WRITE32(0x04, 0x000200);	// Initial PC
+	WRITE32(0x78, 0x000264);	// Level 6 autovector (VBlank)
+	#undef WRITE32
+
+	// ROM header.
+	static const char header[] = "SEGA MEGA DRIVE (C)GENS 2015.JAN";
+	memcpy(&m_romData[0x100], header, sizeof(header) - 1);
+
+	// 68000 program.
+	for (int i = 0; i < (int)(sizeof(m68k_program)/sizeof(m68k_program[0])); i++) {
+		m_romData[0x200 + (i * 2) + 0] = (uint8_t)(m68k_program[i] >> 8);
+		m_romData[0x200 + (i * 2) + 1] = (uint8_t)(m68k_program[i] & 0xFF);
+	}
+
+	// Z80 driver.
+	memcpy(&m_romData[0x300], z80_driver, sizeof(z80_driver));
+	memcpy(&m_romData[0x380], z80_ym_init, sizeof(z80_ym_init));
+
+	m_rom = new Rom(m_romData, sizeof(m_romData));
+	ASSERT_TRUE(m_rom->isOpen());
+}
+
+/**
+ * Clean up after the test.
+ */
+void RunAheadTest::TearDown(void)
+{
+	delete m_rom;
+	m_rom = nullptr;
+}
+
+/**
+ * Create an emulation context for the test ROM.
+ * @return Emulation context.
+ */
+EmuMD *RunAheadTest::createContext(void)
+{
+	EmuMD *context = new EmuMD(m_rom);
+	context->m_vdp->MD_Screen->setBpp(MdFb::BPP_32);
+	return context;
+}
+
+/**
+ * Save a snapshot.
+ * @param context Emulation context.
+ * @param snapshot [out] Snapshot.
+ */
+void RunAheadTest::saveSnapshot(EmuContext *context, vector<uint8_t> *snapshot)
+{
+	const int siz = context->saveSnapshot(nullptr, 0);
+	ASSERT_GT(siz, 0);
+	snapshot->resize(siz);
+	ASSERT_EQ(siz, context->saveSnapshot(snapshot->data(), snapshot->size()));
+}
+
+/**
+ * Get the results of the last frame.
+ * This clears the audio buffers.
+ * @param context Emulation context.
+ * @param result [out] Results.
+ */
+void RunAheadTest::getResult(EmuContext *context, FrameResult *result)
+{
+	saveSnapshot(context, &result->snapshot);
+
+	const MdFb *fb = context->m_vdp->MD_Screen;
+	result->fb.clear();
+	for (int line = 0; line < fb->numLines(); line++) {
+		const uint32_t *px = fb->lineBuf32(line);
+		result->fb.insert(result->fb.end(), px, px + fb->pxPerLine());
+	}
+
+	// NOTE: saveSnapshot() bound the context to this thread.
+	result->audio.resize(SoundMgr::MAX_SEGMENT_SIZE * 2);
+	const int samples = SoundMgr::writeStereo(result->audio.data(), SoundMgr::MAX_SEGMENT_SIZE);
+	result->audio.resize(samples * 2);
+}
+
+/**
+ * Run frames without run-ahead.
+ * @param results [out] Results for each frame.
+ * @param count Number of frames to run.
+ */
+void RunAheadTest::runPlain(vector<FrameResult> *results, int count)
+{
+	EmuMD *context = createContext();
+	for (int i = 0; i < WARMUP_FRAMES; i++) {
+		context->execFrame();
+		FrameResult discard;
+		getResult(context, &discard);
+	}
+
+	results->resize(count);
+	for (int i = 0; i < count; i++) {
+		context->execFrame();
+		getResult(context, &(*results)[i]);
+	}
+	delete context;
+}
+
+/**
+ * Run frames with run-ahead, and compare them to plain emulation.
+ * @param threaded If true, use threaded mode.
+ */
+void RunAheadTest::checkRunAhead(bool threaded)
+{
+	// The displayed frame is RUNAHEAD_FRAMES frames ahead.
+	vector<FrameResult> expected;
+	runPlain(&expected, NUM_FRAMES + RUNAHEAD_FRAMES);
+
+	EmuMD *context = createContext();
+	for (int i = 0; i < WARMUP_FRAMES; i++) {
+		context->execFrame();
+		FrameResult discard;
+		getResult(context, &discard);
+	}
+
+	RunAhead *runAhead = new RunAhead(context, RUNAHEAD_FRAMES);
+	if (threaded) {
+		ASSERT_EQ(0, runAhead->setSecondary(createContext()));
+		ASSERT_TRUE(runAhead->isThreaded());
+	}
+
+	for (int i = 0; i < NUM_FRAMES; i++) {
+		runAhead->execFrame();
+		ASSERT_EQ((int)RUNAHEAD_FRAMES, runAhead->frames()) <<
+			"Run-ahead was disabled at frame " << i;
+
+		FrameResult actual;
+		getResult(context, &actual);
+
+		// The emulated state and audio must not be affected by run-ahead.
+		EXPECT_TRUE(expected[i].snapshot == actual.snapshot) <<
+			"Snapshot mismatch at frame " << i;
+		EXPECT_TRUE(expected[i].audio == actual.audio) <<
+			"Audio mismatch at frame " << i;
+
+		// In threaded mode, the hidden frames are one frame behind,
+		// so the first frame is displayed without running ahead.
+		const int fbFrame = ((threaded && i == 0) ? i : i + RUNAHEAD_FRAMES);
+		EXPECT_TRUE(expected[fbFrame].fb == actual.fb) <<
+			"Framebuffer mismatch at frame " << i;
+	}
+
+	delete runAhead;
+	delete context;
+}
+
+/**
+ * Load a snapshot and save it again.
+ * The two snapshots must be identical.
+ */
+TEST_F(RunAheadTest, snapshotRoundTrip)
+{
+	EmuMD *context = createContext();
+	for (int i = 0; i < WARMUP_FRAMES; i++) {
+		context->execFrame();
+	}
+
+	vector<uint8_t> before, after;
+	saveSnapshot(context, &before);
+	ASSERT_EQ(0, context->loadSnapshot(before.data(), before.size()));
+	saveSnapshot(context, &after);
+	EXPECT_TRUE(before == after);
+
+	delete context;
+}
+
+/**
+ * Save a snapshot, run frames, load the snapshot,
+ * and run the same frames again.
+ * The results must be identical, both in the original
+ * context and in a new context.
+ */
+TEST_F(RunAheadTest, snapshotDeterminism)
+{
+	EmuMD *context = createContext();
+	for (int i = 0; i < WARMUP_FRAMES; i++) {
+		context->execFrame();
+		FrameResult discard;
+		getResult(context, &discard);
+	}
+
+	vector<uint8_t> start;
+	saveSnapshot(context, &start);
+
+	vector<FrameResult> first(NUM_FRAMES);
+	for (int i = 0; i < NUM_FRAMES; i++) {
+		context->execFrame();
+		getResult(context, &first[i]);
+	}
+
+	// The new context starts from power-on, so any state
+	// that isn't in the snapshot will be different.
+	EmuMD *const contexts[2] = {context, createContext()};
+	for (int c = 0; c < 2; c++) {
+		ASSERT_EQ(0, contexts[c]->loadSnapshot(start.data(), start.size()));
+		for (int i = 0; i < NUM_FRAMES; i++) {
+			contexts[c]->execFrame();
+			FrameResult second;
+			getResult(contexts[c], &second);
+			EXPECT_TRUE(first[i].snapshot == second.snapshot) <<
+				"Context " << c << ": Snapshot mismatch at frame " << i;
+			EXPECT_TRUE(first[i].audio == second.audio) <<
+				"Context " << c << ": Audio mismatch at frame " << i;
+			EXPECT_TRUE(first[i].fb == second.fb) <<
+				"Context " << c << ": Framebuffer mismatch at frame " << i;
+		}
+	}
+
+	delete contexts[1];
+	delete context;
+}
+
+/**
+ * Run-ahead in single-instance mode must match plain emulation.
+ */
+TEST_F(RunAheadTest, singleInstance)
+{
+	checkRunAhead(false);
+}
+
+/**
+ * Run-ahead in threaded mode must match plain emulation.
+ */
+TEST_F(RunAheadTest, threaded)
+{
+	if (!RunAhead::IsThreadedModeSupported()) {
+		printf("Threaded run-ahead is not supported in this build; skipping test.\n");
+		return;
+	}
+	checkRunAhead(true);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: Run-ahead tests.\n\n");
+	LibGens::Init();
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	int ret = RUN_ALL_TESTS();
+	LibGens::End();
+	return ret;
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
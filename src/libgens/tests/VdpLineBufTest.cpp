@@ -0,0 +1,186 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * VdpLineBufTest.cpp: VDP line buffer SIMD kernel tests.                  *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// LibGens.
+#include "lg_main.hpp"
+#include "Vdp/VdpRend_LineBuf_x86.hpp"
+
+// CPU flags.
+#include "libcompat/cpuflags.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+namespace LibGens { namespace Tests {
+
+class VdpLineBufTest : public ::testing::Test
+{
+	protected:
+		VdpLineBufTest() { }
+		virtual ~VdpLineBufTest() { }
+
+		virtual void SetUp(void) override;
+
+		// Line buffer: every palette index, followed by
+		// the same indexes with garbage in the high byte.
+		// (The high byte contains layer flags.)
+		static const int LINEBUF_SIZE = 512;
+		uint16_t linebuf[LINEBUF_SIZE];
+
+		// Palettes. Each entry is unique.
+		uint16_t palette16[256];
+		uint32_t palette32[256];
+
+		/**
+		 * Check if the AVX2 kernels can be tested.
+		 * @return True if AVX2 is supported by the CPU and OS.
+		 */
+		static bool haveAVX2(void);
+
+		/**
+		 * Test a pixel conversion kernel against the scalar loop.
+		 * @param pixel Pixel type.
+		 * @param kernel Kernel function.
+		 * @param palette Palette.
+		 */
+		template<typename pixel>
+		void checkKernel(void (*kernel)(pixel*, const uint16_t*, const pixel*, int),
+				 const pixel *palette);
+};
+
+/**
+ * Set up the test.
+ */
+void VdpLineBufTest::SetUp(void)
+{
+	for (int i = 0; i < LINEBUF_SIZE; i++) {
+		// Use the line buffer position to vary the high byte.
+		const uint16_t flags = ((i >> 8) ? ((i * 0x3B) & 0xFF) : 0);
+		linebuf[i] = (uint16_t)((flags << 8) | (i & 0xFF));
+	}
+	for (int i = 0; i < 256; i++) {
+		palette16[i] = (uint16_t)(0x8000 | (i * 0x0101 + 0x1234));
+		palette32[i] = (0xFF000000 | ((uint32_t)i << 16) | ((uint32_t)(255 - i) << 8) | (uint32_t)i);
+	}
+}
+
+/**
+ * Check if the AVX2 kernels can be tested.
+ * @return True if AVX2 is supported by the CPU and OS.
+ */
+bool VdpLineBufTest::haveAVX2(void)
+{
+#ifdef HAVE_VDP_LINEBUF_X86
+	if (CPU_Flags & MDP_CPUFLAG_X86_AVX2)
+		return true;
+#endif /* HAVE_VDP_LINEBUF_X86 */
+	printf("AVX2 is not supported on this system; skipping test.\n");
+	return false;
+}
+
+/**
+ * Test a pixel conversion kernel against the scalar loop.
+ * @param pixel Pixel type.
+ * @param kernel Kernel function.
+ * @param palette Palette.
+ */
+template<typename pixel>
+void VdpLineBufTest::checkKernel(void (*kernel)(pixel*, const uint16_t*, const pixel*, int),
+				 const pixel *palette)
+{
+	// Check all pixel counts up to 48, which covers the
+	// 16-pixel loop with every tail length, plus the full
+	// line buffer, which covers every palette index.
+	// Each count is also tested at an odd offset.
+	static const int bigCounts[] = {
+		255, 256, 257, LINEBUF_SIZE - 1, LINEBUF_SIZE
+	};
+	static const int numSmall = 49;
+	static const int numBig = (int)(sizeof(bigCounts)/sizeof(bigCounts[0]));
+
+	pixel expected[LINEBUF_SIZE + 1];
+	pixel actual[LINEBUF_SIZE + 1];
+	for (int c = 0; c < numSmall + numBig; c++) {
+		for (int offset = 0; offset <= 1; offset++) {
+			int count = (c < numSmall ? c : bigCounts[c - numSmall]);
+			if (offset + count > LINEBUF_SIZE)
+				count = LINEBUF_SIZE - offset;
+
+			// Scalar loop, as used by T_Render_LineBuf().
+			// The extra element checks for overruns.
+			memset(expected, 0x5A, sizeof(expected));
+			memset(actual, 0x5A, sizeof(actual));
+			for (int i = 0; i < count; i++) {
+				expected[i] = palette[linebuf[offset + i] & 0xFF];
+			}
+
+			kernel(actual, &linebuf[offset], palette, count);
+			ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected))) <<
+				"count == " << count << ", offset == " << offset;
+		}
+	}
+}
+
+/**
+ * Test VdpRend_LineBuf16_AVX2().
+ */
+TEST_F(VdpLineBufTest, lineBuf16_AVX2)
+{
+	if (!haveAVX2())
+		return;
+#ifdef HAVE_VDP_LINEBUF_X86
+	checkKernel<uint16_t>(VdpRend_LineBuf16_AVX2, palette16);
+#endif /* HAVE_VDP_LINEBUF_X86 */
+}
+
+/**
+ * Test VdpRend_LineBuf32_AVX2().
+ */
+TEST_F(VdpLineBufTest, lineBuf32_AVX2)
+{
+	if (!haveAVX2())
+		return;
+#ifdef HAVE_VDP_LINEBUF_X86
+	checkKernel<uint32_t>(VdpRend_LineBuf32_AVX2, palette32);
+#endif /* HAVE_VDP_LINEBUF_X86 */
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: VDP line buffer tests.\n\n");
+	LibGens::Init();
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
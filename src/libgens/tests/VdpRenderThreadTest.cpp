@@ -0,0 +1,237 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * VdpRenderThreadTest.cpp: VDP threaded rendering test.                   *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// LibGens.
+#include "lg_main.hpp"
+
+// LibGens VDP.
+#include "Vdp/Vdp.hpp"
+#include "Util/MdFb.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibGens { namespace Tests {
+
+class VdpRenderThreadTest : public ::testing::Test
+{
+	protected:
+		VdpRenderThreadTest() { }
+		virtual ~VdpRenderThreadTest() { }
+
+		/**
+		 * Results of rendering a frame.
+		 */
+		struct FrameResult {
+			// Status register values read during the frame.
+			vector<uint16_t> status;
+			// Framebuffer contents.
+			vector<uint32_t> fb;
+		};
+
+		// Number of frames to render.
+		static const int NUM_FRAMES = 2;
+
+		// Read the status register every STATUS_INTERVAL lines,
+		// so several lines are queued for the render thread
+		// between reads.
+		static const int STATUS_INTERVAL = 8;
+
+		/**
+		 * Initialize a VDP with sprites that collide and overflow.
+		 * @param vdp VDP.
+		 */
+		static void initVdp(Vdp *vdp);
+
+		/**
+		 * Render frames.
+		 * @param renderThread If true, use the render thread.
+		 * @param result [out] Results.
+		 */
+		static void renderFrames(bool renderThread, FrameResult *result);
+};
+
+/**
+ * Initialize a VDP with sprites that collide and overflow.
+ * @param vdp VDP.
+ */
+void VdpRenderThreadTest::initVdp(Vdp *vdp)
+{
+	vdp->setNtsc();
+	vdp->options.spriteLimits = true;
+
+	// Set initial registers.
+	vdp->dbg_setReg(0x00, 0x04);	// Enable the palette. (?)
+	vdp->dbg_setReg(0x01, 0x44);	// Enable the display, set Mode 5.
+	vdp->dbg_setReg(0x02, 0x30);	// Set scroll A name table base to 0xC000.
+	vdp->dbg_setReg(0x04, 0x05);	// Set scroll B name table base to 0xA000.
+	vdp->dbg_setReg(0x05, 0x70);	// Set the sprite table base to 0xE000.
+	vdp->dbg_setReg(0x0C, 0x81);	// H40.
+	vdp->dbg_setReg(0x0D, 0x3F);	// Set the HScroll table base to 0xFC00.
+	vdp->dbg_setReg(0x10, 0x01);	// Set the scroll size to V32 H64.
+	vdp->dbg_setReg(0x0F, 0x02);	// Set the auto-increment value to 2.
+
+	// CRam: Palette line 0 has a different color for each entry.
+	uint16_t cram[16];
+	for (int i = 0; i < 16; i++) {
+		cram[i] = (uint16_t)((i & 7) << 1) | (((15 - i) & 7) << 5) | (((i * 3) & 7) << 9);
+	}
+	vdp->dbg_writeCRam_16(0, cram, sizeof(cram));
+
+	uint16_t vsram[40];
+	memset(vsram, 0, sizeof(vsram));
+	vdp->dbg_writeVSRam_16(0, vsram, sizeof(vsram));
+
+	// VRam: Tiles 1-16 are filled with colors 1-15.
+	static uint16_t vram[0x8000];
+	memset(vram, 0, sizeof(vram));
+	for (int tile = 1; tile <= 16; tile++) {
+		const uint16_t color = (uint16_t)(((tile - 1) % 15) + 1);
+		const uint16_t px = (uint16_t)(color * 0x1111);
+		for (int i = 0; i < 16; i++) {
+			vram[(tile * 32 / 2) + i] = px;
+		}
+	}
+
+	// Sprite table at 0xE000.
+	// Entry format: Y+128, size/link, tile, X+128
+	uint16_t *const sat = &vram[0xE000 / 2];
+	int spr = 0;
+	#define ADD_SPRITE(y, size, x) do { \
+		sat[(spr * 4) + 0] = (uint16_t)((y) + 128); \
+		sat[(spr * 4) + 1] = (uint16_t)(((size) << 8) | (spr + 1)); \
+		sat[(spr * 4) + 2] = 0x0001; \
+		sat[(spr * 4) + 3] = (uint16_t)((x) + 128); \
+		spr++; \
+	} while (0)
+
+	// Colliding sprites.
+	ADD_SPRITE(16, 0x00, 100);	// 8x8
+	ADD_SPRITE(20, 0x00, 104);	// 8x8, overlaps the previous sprite.
+	ADD_SPRITE(100, 0x0F, 100);	// 32x32
+	ADD_SPRITE(110, 0x05, 120);	// 16x16, overlaps the previous sprite.
+
+	// Sprite overflow: 21 sprites on the same lines.
+	for (int i = 0; i < 21; i++) {
+		ADD_SPRITE(180, 0x00, 8 + (i * 12));
+	}
+	#undef ADD_SPRITE
+
+	// Terminate the sprite list.
+	sat[((spr - 1) * 4) + 1] &= 0xFF00;
+
+	vdp->dbg_writeVRam_16(0, vram, sizeof(vram));
+	vdp->MD_Screen->setBpp(MdFb::BPP_32);
+}
+
+/**
+ * Render frames.
+ * @param renderThread If true, use the render thread.
+ * @param result [out] Results.
+ */
+void VdpRenderThreadTest::renderFrames(bool renderThread, FrameResult *result)
+{
+	Vdp *vdp = new Vdp();
+	initVdp(vdp);
+	vdp->options.renderThread = renderThread;
+
+	result->status.clear();
+	result->fb.clear();
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		vdp->startFrame();
+		vdp->updateVdpLines(true);
+		for (; vdp->VDP_Lines.currentLine < vdp->VDP_Lines.totalDisplayLines;
+		     vdp->VDP_Lines.currentLine++)
+		{
+			vdp->renderLine();
+			if ((vdp->VDP_Lines.currentLine % STATUS_INTERVAL) == (STATUS_INTERVAL - 1)) {
+				result->status.push_back(vdp->readCtrlMD());
+			}
+		}
+		result->status.push_back(vdp->readCtrlMD());
+
+		const MdFb *fb = vdp->MD_Screen;
+		for (int line = 0; line < fb->numLines(); line++) {
+			const uint32_t *px = fb->lineBuf32(line);
+			result->fb.insert(result->fb.end(), px, px + fb->pxPerLine());
+		}
+	}
+
+	delete vdp;
+}
+
+/**
+ * Compare threaded and inline rendering with sprite collisions.
+ * The collision and overflow status bits must be visible
+ * in the same status register reads in both cases.
+ */
+TEST_F(VdpRenderThreadTest, spriteCollision)
+{
+	FrameResult inlineResult, threadResult;
+	renderFrames(false, &inlineResult);
+	renderFrames(true, &threadResult);
+
+	// Make sure the test actually generated collisions
+	// and sprite overflows.
+	unsigned int allStatus = 0;
+	for (size_t i = 0; i < inlineResult.status.size(); i++) {
+		allStatus |= inlineResult.status[i];
+	}
+	ASSERT_NE(0U, allStatus & VdpStatus::VDP_STATUS_COLLISION);
+	ASSERT_NE(0U, allStatus & VdpStatus::VDP_STATUS_SOVR);
+
+	ASSERT_EQ(inlineResult.status.size(), threadResult.status.size());
+	for (size_t i = 0; i < inlineResult.status.size(); i++) {
+		EXPECT_EQ(inlineResult.status[i], threadResult.status[i]) <<
+			"Status register read " << i;
+	}
+
+	ASSERT_EQ(inlineResult.fb.size(), threadResult.fb.size());
+	EXPECT_TRUE(inlineResult.fb == threadResult.fb);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: VDP render thread tests.\n\n");
+	LibGens::Init();
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	int ret = RUN_ALL_TESTS();
+	LibGens::End();
+	return ret;
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
@@ -0,0 +1,210 @@
+/***************************************************************************
+ * libgens/tests: Gens Emulation Library. (Test Suite)                     *
+ * VgmLoggerTest.cpp: VGM logger test.                                     *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// LibGens.
+#include "lg_main.hpp"
+#include "Util/VgmLogger.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibGens { namespace Tests {
+
+class VgmLoggerTest : public ::testing::Test
+{
+	protected:
+		VgmLoggerTest() { }
+		virtual ~VgmLoggerTest() { }
+
+		virtual void TearDown(void) override;
+
+		/**
+		 * Read an entire file.
+		 * @param filename Filename.
+		 * @return File contents.
+		 */
+		static vector<uint8_t> readFile(const char *filename);
+
+		/**
+		 * Read a little-endian 32-bit value.
+		 * @param p Data.
+		 * @return Value.
+		 */
+		static inline uint32_t le32(const uint8_t *p)
+		{
+			return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+
+	protected:
+		static const char vgmFilename[];
+
+		// NTSC frame: 262 lines of 488 cycles.
+		static const unsigned int frameCycles = 262 * 488;
+};
+
+const char VgmLoggerTest::vgmFilename[] = "VgmLoggerTest.vgm";
+
+/**
+ * Delete the test file.
+ */
+void VgmLoggerTest::TearDown(void)
+{
+	remove(vgmFilename);
+}
+
+/**
+ * Read an entire file.
+ * @param filename Filename.
+ * @return File contents.
+ */
+vector<uint8_t> VgmLoggerTest::readFile(const char *filename)
+{
+	vector<uint8_t> data;
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+		return data;
+	uint8_t buf[4096];
+	size_t size;
+	while ((size = fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.insert(data.end(), buf, buf + size);
+	}
+	fclose(f);
+	return data;
+}
+
+/**
+ * Log a few writes, then verify the file.
+ */
+TEST_F(VgmLoggerTest, logWrites)
+{
+	VgmLogger logger;
+	EXPECT_FALSE(logger.isOpen());
+	ASSERT_EQ(0, logger.open(vgmFilename, false));
+	EXPECT_TRUE(logger.isOpen());
+	EXPECT_EQ(-EBUSY, logger.open(vgmFilename, false));
+
+	// Frame 0: PSG write at the start of the frame.
+	logger.logPsg(0x9F, 0);
+	logger.endFrame(frameCycles);
+
+	// Frame 1: YM2612 key on, slightly after the start of the frame.
+	logger.logYm2612(0, 0x28, 100);
+	logger.logYm2612(1, 0xF0, 100);
+	// Port 1 address write without a data write.
+	logger.logYm2612(2, 0x30, 200);
+	logger.endFrame(frameCycles);
+
+	EXPECT_EQ(0, logger.close());
+	EXPECT_FALSE(logger.isOpen());
+
+	VgmLogger::Stats stats;
+	logger.stats(&stats);
+	EXPECT_EQ(2U, stats.frames);
+	EXPECT_EQ(0U, stats.droppedEvents);
+
+	const vector<uint8_t> vgm = readFile(vgmFilename);
+	ASSERT_GE(vgm.size(), 0x40U);
+
+	// Header.
+	EXPECT_EQ(0, memcmp(vgm.data(), "Vgm ", 4));
+	EXPECT_EQ(vgm.size() - 4, le32(&vgm[0x04]));
+	EXPECT_EQ(0x150U, le32(&vgm[0x08]));
+	EXPECT_EQ(3579545U, le32(&vgm[0x0C]));
+	EXPECT_EQ(60U, le32(&vgm[0x24]));
+	EXPECT_EQ(7670453U, le32(&vgm[0x2C]));
+	EXPECT_EQ(0x0CU, le32(&vgm[0x34]));
+
+	// Two NTSC frames are 1,470 samples.
+	EXPECT_EQ(1470U, le32(&vgm[0x18]));
+
+	// Commands.
+	static const uint8_t expected[] = {
+		0x50, 0x9F,		// PSG: Channel 0 volume off
+		0x62,			// Wait 735 samples
+		0x52, 0x28, 0xF0,	// YM2612: Key on
+		0x62,			// Wait 735 samples
+		0x66,			// End of sound data
+	};
+	ASSERT_EQ(0x40 + sizeof(expected), vgm.size());
+	EXPECT_EQ(0, memcmp(&vgm[0x40], expected, sizeof(expected)));
+}
+
+/**
+ * Log more events than fit in a frame.
+ * The extra events should be dropped and counted.
+ */
+TEST_F(VgmLoggerTest, dropEvents)
+{
+	VgmLogger logger;
+	ASSERT_EQ(0, logger.open(vgmFilename, true));
+
+	static const unsigned int count = 5000;
+	for (unsigned int i = 0; i < count; i++) {
+		logger.logPsg(0x9F, i);
+	}
+	logger.endFrame(frameCycles);
+	EXPECT_EQ(0, logger.close());
+
+	VgmLogger::Stats stats;
+	logger.stats(&stats);
+	EXPECT_EQ(1U, stats.frames);
+	EXPECT_GT(stats.droppedEvents, 0U);
+
+	// Every event that wasn't dropped was written.
+	const vector<uint8_t> vgm = readFile(vgmFilename);
+	ASSERT_GE(vgm.size(), 0x40U);
+	EXPECT_EQ(50U, le32(&vgm[0x24]));
+	unsigned int written = 0;
+	for (size_t i = 0x40; i + 1 < vgm.size(); i++) {
+		if (vgm[i] == 0x50 && vgm[i+1] == 0x9F) {
+			written++;
+			i++;
+		}
+	}
+	EXPECT_EQ(count, written + stats.droppedEvents);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibGens test suite: VgmLogger tests.\n\n");
+	LibGens::Init();
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
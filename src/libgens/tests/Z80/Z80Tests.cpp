@@ -30,7 +30,10 @@
 // C includes. (C++ namespace)
 #include <cstdio>
 #include <cstring>
-using namespace std;
+
+// C++ includes.
+#include <string>
+using std::string;
 
 // NOTE: This test suite uses mdZ80 directly.
 // The Z80 class is currently hard-coded for MD only.
@@ -50,7 +53,8 @@ class Z80Tests : public ::testing::Test
 		Z80Tests()
 			: ::testing::Test()
 			, m_Z80(nullptr)
-			, halt(false) { }
+			, halt(false)
+			, errors(0) { }
 		virtual ~Z80Tests() { }
 
 		virtual void SetUp(void) override;
@@ -63,6 +67,10 @@ class Z80Tests : public ::testing::Test
 		// System state.
 		bool halt;
 
+		// Test output.
+		string line;	// Current line.
+		int errors;	// Number of lines containing "ERROR".
+
 		// FIXME: Pass the context in these functions.
 		static uint8_t FASTCALL Z80_ReadB_static(uint32_t adr) {
 			return curZ80Tests->Z80_ReadB(adr);
@@ -93,6 +101,8 @@ void Z80Tests::SetUp()
 	// Set the current Z80Tests.
 	curZ80Tests = this;
 	halt = false;
+	line.clear();
+	errors = 0;
 
 	// Initialize Z80 memory.
 	memset(Ram_Z80, 0, sizeof(Ram_Z80));
@@ -160,8 +170,15 @@ void Z80Tests::Z80_OutB(uint32_t adr, uint8_t data)
 	switch (adr & 0xFF) {
 		case 0x01:
 			// stdout
-			// TODO: Lines beginning with '*' should be in red and trigger an error.
+			// ZEXDOC/ZEXALL print "ERROR" if a CRC doesn't match.
 			fputc(data, stdout);
+			if (data == '\n') {
+				if (line.find("ERROR") != string::npos)
+					errors++;
+				line.clear();
+			} else {
+				line += (char)data;
+			}
 			break;
 
 		case 0x02:
@@ -202,7 +219,8 @@ TEST_F(Z80Tests, zexdoc)
 	}
 	printf("\n");
 
-	// TODO: If any errors occurred, fail the test.
+	// Make sure no errors occurred.
+	EXPECT_EQ(0, errors);
 }
 
 /**
@@ -228,7 +246,8 @@ TEST_F(Z80Tests, zexall)
 	}
 	printf("\n");
 
-	// TODO: If any errors occurred, fail the test.
+	// Make sure no errors occurred.
+	EXPECT_EQ(0, errors);
 }
 
 } }
@@ -100,8 +100,8 @@ void AudioWriteTest::SetUp(void)
 	buf = (int16_t*)aligned_malloc(16, samples * 2 * sizeof(*buf));
 
 	// Copy the test data into SoundMgr.
-	memcpy(SoundMgr::ms_SegBufL, AudioWriteTest_Input_L, sizeof(AudioWriteTest_Input_L));
-	memcpy(SoundMgr::ms_SegBufR, AudioWriteTest_Input_R, sizeof(AudioWriteTest_Input_R));
+	memcpy(SoundMgr::ms_State->segBufL, AudioWriteTest_Input_L, sizeof(AudioWriteTest_Input_L));
+	memcpy(SoundMgr::ms_State->segBufR, AudioWriteTest_Input_R, sizeof(AudioWriteTest_Input_R));
 }
 
 /**
@@ -130,8 +130,8 @@ TEST_P(AudioWriteTest_benchmark, writeStereo)
 		// Copy the test data into SoundMgr.
 		// Note that this has to be done here instead of in SetUp(),
 		// since the segment buffer is erased after every iteration.
-		memcpy(SoundMgr::ms_SegBufL, AudioWriteTest_Input_L, sizeof(AudioWriteTest_Input_L));
-		memcpy(SoundMgr::ms_SegBufR, AudioWriteTest_Input_R, sizeof(AudioWriteTest_Input_R));
+		memcpy(SoundMgr::ms_State->segBufL, AudioWriteTest_Input_L, sizeof(AudioWriteTest_Input_L));
+		memcpy(SoundMgr::ms_State->segBufR, AudioWriteTest_Input_R, sizeof(AudioWriteTest_Input_R));
 
 		int ret = SoundMgr::writeStereo(buf, samples);
 		ASSERT_EQ(samples, ret);
@@ -148,8 +148,8 @@ TEST_P(AudioWriteTest_benchmark, writeMono)
 		// Copy the test data into SoundMgr.
 		// Note that this has to be done here instead of in SetUp(),
 		// since the segment buffer is erased after every iteration.
-		memcpy(SoundMgr::ms_SegBufL, AudioWriteTest_Input_L, sizeof(AudioWriteTest_Input_L));
-		memcpy(SoundMgr::ms_SegBufR, AudioWriteTest_Input_R, sizeof(AudioWriteTest_Input_R));
+		memcpy(SoundMgr::ms_State->segBufL, AudioWriteTest_Input_L, sizeof(AudioWriteTest_Input_L));
+		memcpy(SoundMgr::ms_State->segBufR, AudioWriteTest_Input_R, sizeof(AudioWriteTest_Input_R));
 
 		int ret = SoundMgr::writeMono(buf, samples);
 		ASSERT_EQ(samples, ret);
@@ -46,7 +46,21 @@
 #include <unistd.h>
 #endif
 
+// CPU flags.
+#include "libcompat/cpuflags.h"
+
+// SIMD row conversion.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PNGWRITER_HAS_SSE2 1
+#endif
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_neon.h>
+#define PNGWRITER_HAS_NEON 1
+#endif
+
 // C includes. (C++ namespace)
+#include <cassert>
 #include <cerrno>
 #include <csetjmp>
 #include <cstring>
@@ -90,19 +104,97 @@ class PngWriterPrivate
 		PngWriterPrivate &operator=(const PngWriterPrivate &);
 
 	public:
+		// Encoder settings.
+		int compressionLevel;
+		PngWriter::FilterStrategy filter;
+
+	public:
+		/**
+		 * Row conversion function.
+		 * Converts a row of pixels to RGB24.
+		 * @param dest Destination buffer. (Must be at least w * 3 + 16 bytes.)
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		typedef void (*ConvertRowFn)(uint8_t *dest, const void *src, int w);
+
 		/**
-		 * Write 16-bit PNG rows.
-		 * @param pixel Typename.
+		 * Convert a row of 15-bit or 16-bit pixels to RGB24.
 		 * @param RBits Red bits.
 		 * @param GBits Green bits.
 		 * @param BBits Blue bits.
-		 * @param img_data Image data.
-		 * @param row_buffer Row buffer. (Must be at least width * 3 bytes.)
-		 * @param png_ptr PNG pointer.
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		template<uint8_t RBits, uint8_t GBits, uint8_t BBits>
+		static void T_convertRow_16(uint8_t *dest, const void *src, int w);
+
+		/**
+		 * Convert a row of 32-bit pixels to RGB24.
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		static void convertRow_32(uint8_t *dest, const void *src, int w);
+
+#ifdef PNGWRITER_HAS_SSE2
+		/**
+		 * Convert a row of 15-bit or 16-bit pixels to RGB24. (SSE2-optimized)
+		 * @param RBits Red bits.
+		 * @param GBits Green bits.
+		 * @param BBits Blue bits.
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		template<uint8_t RBits, uint8_t GBits, uint8_t BBits>
+		static void T_convertRow_16_SSE2(uint8_t *dest, const void *src, int w);
+
+		/**
+		 * Convert a row of 32-bit pixels to RGB24. (SSE2-optimized)
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		static void convertRow_32_SSE2(uint8_t *dest, const void *src, int w);
+
+		/**
+		 * Pack four 0x00BBGGRR pixels into 12 bytes of RGB24.
+		 * @param px Pixels.
+		 * @return RGB24 data in the low 12 bytes.
+		 */
+		static inline __m128i packRGB24_SSE2(__m128i px);
+#endif /* PNGWRITER_HAS_SSE2 */
+
+#ifdef PNGWRITER_HAS_NEON
+		/**
+		 * Convert a row of 15-bit or 16-bit pixels to RGB24. (NEON-optimized)
+		 * @param RBits Red bits.
+		 * @param GBits Green bits.
+		 * @param BBits Blue bits.
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		template<uint8_t RBits, uint8_t GBits, uint8_t BBits>
+		static void T_convertRow_16_NEON(uint8_t *dest, const void *src, int w);
+
+		/**
+		 * Convert a row of 32-bit pixels to RGB24. (NEON-optimized)
+		 * @param dest Destination buffer.
+		 * @param src Source row.
+		 * @param w Width, in pixels.
+		 */
+		static void convertRow_32_NEON(uint8_t *dest, const void *src, int w);
+#endif /* PNGWRITER_HAS_NEON */
+
+		/**
+		 * Get the row conversion function for a color depth.
+		 * @param bpp Color depth. (15, 16, 32)
+		 * @return Row conversion function.
 		 */
-		template<typename pixel, uint8_t RBits, uint8_t GBits, uint8_t BBits>
-		static void T_writePNG_rows_16(const Zomg_Img_Data_t *img_data, uint8_t *row_buffer,
-					       png_structp png_ptr);
+		static ConvertRowFn getConvertRowFn(int bpp);
 
 	public:
 		/**
@@ -130,62 +222,279 @@ class PngWriterPrivate
 		 * @param metaFlags	[in, opt] Metadata flags.
 		 * @return 0 on success; negative errno on error.
 		 */
-		static int writeToPng(png_structp png_ptr, png_infop info_ptr,
-				      const Zomg_Img_Data_t *img_data,
-				      const Metadata *metadata, int metaFlags);
+		int writeToPng(png_structp png_ptr, png_infop info_ptr,
+			       const Zomg_Img_Data_t *img_data,
+			       const Metadata *metadata, int metaFlags) const;
 };
 
 PngWriterPrivate::PngWriterPrivate(PngWriter *q)
 	: q(q)
+	, compressionLevel(5)
+	, filter(PngWriter::FILTER_NONE)
 { }
 
 PngWriterPrivate::~PngWriterPrivate()
 { }
 
+#define MMASK(bits) ((1 << (bits)) - 1)
+
 /**
- * Write 16-bit PNG rows.
- * @param pixel Typename.
+ * Convert a row of 15-bit or 16-bit pixels to RGB24.
  * @param RBits Red bits.
  * @param GBits Green bits.
  * @param BBits Blue bits.
- * @param img_data Image data.
- * @param row_buffer Row buffer. (Must be at least width * 3 bytes.)
- * @param png_ptr PNG pointer.
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
  */
-template<typename pixel, uint8_t RBits, uint8_t GBits, uint8_t BBits>
-void PngWriterPrivate::T_writePNG_rows_16(const Zomg_Img_Data_t *img_data, uint8_t *row_buffer,
-					  png_structp png_ptr)
+template<uint8_t RBits, uint8_t GBits, uint8_t BBits>
+void PngWriterPrivate::T_convertRow_16(uint8_t *dest, const void *src, int w)
 {
-	#define MMASK(bits) ((1 << (bits)) - 1)
-	uint8_t r, g, b;
-
-	// Write the rows.
-	const uint16_t *screen = (const uint16_t*)img_data->data;
-	const int row_adj = (img_data->pitch / sizeof(pixel)) - img_data->w;
-	for (int y = img_data->h; y > 0; y--) {
-		uint8_t *rowBufPtr = row_buffer;
-		for (int x = img_data->w; x > 0; x--, rowBufPtr += 3, screen++) {
-			// Get the color components.
-			r = (uint8_t)((*screen >> (GBits + BBits)) & MMASK(RBits)) << (8 - RBits);
-			g = (uint8_t)((*screen >> BBits) & MMASK(GBits)) << (8 - GBits);
-			b = (uint8_t)((*screen) & MMASK(BBits)) << (8 - BBits);
-
-			// Fill in the unused bits with a copy of the MSBs.
-			r |= (r >> RBits);
-			g |= (g >> GBits);
-			b |= (b >> BBits);
-
-			// Save the new color components.
-			*(rowBufPtr + 0) = r;
-			*(rowBufPtr + 1) = g;
-			*(rowBufPtr + 2) = b;
-		}
+	const uint16_t *screen = (const uint16_t*)src;
+	for (; w > 0; w--, dest += 3, screen++) {
+		// Get the color components.
+		uint8_t r = (uint8_t)((*screen >> (GBits + BBits)) & MMASK(RBits)) << (8 - RBits);
+		uint8_t g = (uint8_t)((*screen >> BBits) & MMASK(GBits)) << (8 - GBits);
+		uint8_t b = (uint8_t)((*screen) & MMASK(BBits)) << (8 - BBits);
+
+		// Fill in the unused bits with a copy of the MSBs.
+		r |= (r >> RBits);
+		g |= (g >> GBits);
+		b |= (b >> BBits);
+
+		// Save the new color components.
+		*(dest + 0) = r;
+		*(dest + 1) = g;
+		*(dest + 2) = b;
+	}
+}
 
-		// Write the row.
-		png_write_row(png_ptr, row_buffer);
+/**
+ * Convert a row of 32-bit pixels to RGB24.
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
+ */
+void PngWriterPrivate::convertRow_32(uint8_t *dest, const void *src, int w)
+{
+	// 32-bit pixels are host-endian xRGB.
+	const uint32_t *screen = (const uint32_t*)src;
+	for (; w > 0; w--, dest += 3, screen++) {
+		*(dest + 0) = (uint8_t)(*screen >> 16);
+		*(dest + 1) = (uint8_t)(*screen >> 8);
+		*(dest + 2) = (uint8_t)(*screen);
+	}
+}
+
+#ifdef PNGWRITER_HAS_SSE2
+/**
+ * Pack four 0x00BBGGRR pixels into 12 bytes of RGB24.
+ * @param px Pixels.
+ * @return RGB24 data in the low 12 bytes.
+ */
+inline __m128i PngWriterPrivate::packRGB24_SSE2(__m128i px)
+{
+	// The high byte of each pixel is 0, so each pixel
+	// can be shifted down over the previous pixel's
+	// high byte without masking.
+	const __m128i mask0 = _mm_setr_epi32(-1, 0, 0, 0);
+	const __m128i mask1 = _mm_setr_epi32(0, -1, 0, 0);
+	const __m128i mask2 = _mm_setr_epi32(0, 0, -1, 0);
+	const __m128i mask3 = _mm_setr_epi32(0, 0, 0, -1);
+	__m128i p01 = _mm_or_si128(_mm_and_si128(px, mask0),
+		      _mm_srli_si128(_mm_and_si128(px, mask1), 1));
+	__m128i p23 = _mm_or_si128(_mm_srli_si128(_mm_and_si128(px, mask2), 2),
+		      _mm_srli_si128(_mm_and_si128(px, mask3), 3));
+	return _mm_or_si128(p01, p23);
+}
+
+/**
+ * Convert a row of 15-bit or 16-bit pixels to RGB24. (SSE2-optimized)
+ * @param RBits Red bits.
+ * @param GBits Green bits.
+ * @param BBits Blue bits.
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
+ */
+template<uint8_t RBits, uint8_t GBits, uint8_t BBits>
+void PngWriterPrivate::T_convertRow_16_SSE2(uint8_t *dest, const void *src, int w)
+{
+	const uint16_t *screen = (const uint16_t*)src;
+	const __m128i maskR = _mm_set1_epi16(MMASK(RBits));
+	const __m128i maskG = _mm_set1_epi16(MMASK(GBits));
+	const __m128i maskB = _mm_set1_epi16(MMASK(BBits));
+
+	// Convert 8 pixels at once using SSE2.
+	// Each 16-byte store only has 12 valid bytes;
+	// the next store overwrites the rest.
+	for (; w >= 8; w -= 8, dest += 24, screen += 8) {
+		const __m128i px = _mm_loadu_si128((const __m128i*)screen);
+
+		// Get the color components.
+		__m128i r = _mm_and_si128(_mm_srli_epi16(px, GBits + BBits), maskR);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(px, BBits), maskG);
+		__m128i b = _mm_and_si128(px, maskB);
+
+		// Expand to 8 bits by copying the MSBs into the unused bits.
+		r = _mm_or_si128(_mm_slli_epi16(r, 8 - RBits), _mm_srli_epi16(r, (RBits * 2) - 8));
+		g = _mm_or_si128(_mm_slli_epi16(g, 8 - GBits), _mm_srli_epi16(g, (GBits * 2) - 8));
+		b = _mm_or_si128(_mm_slli_epi16(b, 8 - BBits), _mm_srli_epi16(b, (BBits * 2) - 8));
+
+		// Combine into 0x00BBGGRR pixels.
+		const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		_mm_storeu_si128((__m128i*)dest, packRGB24_SSE2(_mm_unpacklo_epi16(rg, b)));
+		_mm_storeu_si128((__m128i*)(dest + 12), packRGB24_SSE2(_mm_unpackhi_epi16(rg, b)));
+	}
+
+	// Convert the remaining pixels normally.
+	T_convertRow_16<RBits, GBits, BBits>(dest, screen, w);
+}
 
-		// Next row.
-		screen += row_adj;
+/**
+ * Convert a row of 32-bit pixels to RGB24. (SSE2-optimized)
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
+ */
+void PngWriterPrivate::convertRow_32_SSE2(uint8_t *dest, const void *src, int w)
+{
+	const uint32_t *screen = (const uint32_t*)src;
+	const __m128i maskG = _mm_set1_epi32(0x0000FF00);
+	const __m128i maskLo = _mm_set1_epi32(0x000000FF);
+	const __m128i maskHi = _mm_set1_epi32(0x00FF0000);
+
+	// Convert 8 pixels at once using SSE2.
+	for (; w >= 8; w -= 8, dest += 24, screen += 8) {
+		const __m128i px0 = _mm_loadu_si128((const __m128i*)screen);
+		const __m128i px1 = _mm_loadu_si128((const __m128i*)(screen + 4));
+
+		// Swap R and B: 0x00RRGGBB -> 0x00BBGGRR
+		const __m128i bgr0 = _mm_or_si128(_mm_and_si128(px0, maskG),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi32(px0, 16), maskLo),
+				     _mm_and_si128(_mm_slli_epi32(px0, 16), maskHi)));
+		const __m128i bgr1 = _mm_or_si128(_mm_and_si128(px1, maskG),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi32(px1, 16), maskLo),
+				     _mm_and_si128(_mm_slli_epi32(px1, 16), maskHi)));
+
+		_mm_storeu_si128((__m128i*)dest, packRGB24_SSE2(bgr0));
+		_mm_storeu_si128((__m128i*)(dest + 12), packRGB24_SSE2(bgr1));
+	}
+
+	// Convert the remaining pixels normally.
+	convertRow_32(dest, screen, w);
+}
+#endif /* PNGWRITER_HAS_SSE2 */
+
+#ifdef PNGWRITER_HAS_NEON
+/**
+ * Convert a row of 15-bit or 16-bit pixels to RGB24. (NEON-optimized)
+ * @param RBits Red bits.
+ * @param GBits Green bits.
+ * @param BBits Blue bits.
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
+ */
+template<uint8_t RBits, uint8_t GBits, uint8_t BBits>
+void PngWriterPrivate::T_convertRow_16_NEON(uint8_t *dest, const void *src, int w)
+{
+	const uint16_t *screen = (const uint16_t*)src;
+	const uint16x8_t maskR = vdupq_n_u16(MMASK(RBits));
+	const uint16x8_t maskG = vdupq_n_u16(MMASK(GBits));
+	const uint16x8_t maskB = vdupq_n_u16(MMASK(BBits));
+
+	// Convert 8 pixels at once using NEON.
+	for (; w >= 8; w -= 8, dest += 24, screen += 8) {
+		const uint16x8_t px = vld1q_u16(screen);
+
+		// Get the color components.
+		uint16x8_t r = vandq_u16(vshrq_n_u16(px, GBits + BBits), maskR);
+		uint16x8_t g = vandq_u16(vshrq_n_u16(px, BBits), maskG);
+		uint16x8_t b = vandq_u16(px, maskB);
+
+		// Expand to 8 bits by copying the MSBs into the unused bits.
+		r = vorrq_u16(vshlq_n_u16(r, 8 - RBits), vshrq_n_u16(r, (RBits * 2) - 8));
+		g = vorrq_u16(vshlq_n_u16(g, 8 - GBits), vshrq_n_u16(g, (GBits * 2) - 8));
+		b = vorrq_u16(vshlq_n_u16(b, 8 - BBits), vshrq_n_u16(b, (BBits * 2) - 8));
+
+		// Store as interleaved RGB24.
+		uint8x8x3_t rgb;
+		rgb.val[0] = vmovn_u16(r);
+		rgb.val[1] = vmovn_u16(g);
+		rgb.val[2] = vmovn_u16(b);
+		vst3_u8(dest, rgb);
+	}
+
+	// Convert the remaining pixels normally.
+	T_convertRow_16<RBits, GBits, BBits>(dest, screen, w);
+}
+
+/**
+ * Convert a row of 32-bit pixels to RGB24. (NEON-optimized)
+ * @param dest Destination buffer.
+ * @param src Source row.
+ * @param w Width, in pixels.
+ */
+void PngWriterPrivate::convertRow_32_NEON(uint8_t *dest, const void *src, int w)
+{
+	const uint32_t *screen = (const uint32_t*)src;
+
+	// Convert 8 pixels at once using NEON.
+	// Little-endian xRGB is stored as B, G, R, x.
+	for (; w >= 8; w -= 8, dest += 24, screen += 8) {
+		const uint8x8x4_t px = vld4_u8((const uint8_t*)screen);
+		uint8x8x3_t rgb;
+		rgb.val[0] = px.val[2];
+		rgb.val[1] = px.val[1];
+		rgb.val[2] = px.val[0];
+		vst3_u8(dest, rgb);
+	}
+
+	// Convert the remaining pixels normally.
+	convertRow_32(dest, screen, w);
+}
+#endif /* PNGWRITER_HAS_NEON */
+
+/**
+ * Get the row conversion function for a color depth.
+ * @param bpp Color depth. (15, 16, 32)
+ * @return Row conversion function.
+ */
+PngWriterPrivate::ConvertRowFn PngWriterPrivate::getConvertRowFn(int bpp)
+{
+#if defined(PNGWRITER_HAS_SSE2)
+	if (LibCompat_GetCPUFlags() & MDP_CPUFLAG_X86_SSE2) {
+		switch (bpp) {
+			case 15:
+				return &T_convertRow_16_SSE2<5, 5, 5>;
+			case 16:
+				return &T_convertRow_16_SSE2<5, 6, 5>;
+			case 32:
+			default:
+				return &convertRow_32_SSE2;
+		}
+	}
+#elif defined(PNGWRITER_HAS_NEON)
+	switch (bpp) {
+		case 15:
+			return &T_convertRow_16_NEON<5, 5, 5>;
+		case 16:
+			return &T_convertRow_16_NEON<5, 6, 5>;
+		case 32:
+		default:
+			return &convertRow_32_NEON;
+	}
+#endif
+
+	switch (bpp) {
+		case 15:
+			return &T_convertRow_16<5, 5, 5>;
+		case 16:
+			return &T_convertRow_16<5, 6, 5>;
+		case 32:
+		default:
+			return &convertRow_32;
 	}
 }
 
@@ -229,32 +538,17 @@ void PngWriterPrivate::png_io_minizip_flush(png_structp png_ptr)
  */
 int PngWriterPrivate::writeToPng(png_structp png_ptr, png_infop info_ptr,
 				 const Zomg_Img_Data_t *img_data,
-				 const Metadata *metadata, int metaFlags)
+				 const Metadata *metadata, int metaFlags) const
 {
-	// Row pointers and/or buffer.
-	// These need to be allocated here so they can be freed
+	// Row buffer.
+	// libpng doesn't support 15-bit or 16-bit color natively,
+	// and 32-bit color has an unused byte, so all rows are
+	// converted to RGB24 first. The SIMD row converters may
+	// write up to 16 bytes past the end of the row.
+	// This needs to be allocated here so it can be freed
 	// in case an error occurs.
-	// FIXME: gcc-5.2 is showing this warning:
-	// warning: variable ‘row’ might be clobbered by ‘longjmp’ or ‘vfork’ [-Wclobbered]
-	union {
-		void *p;
-
-		// Row pointers. (32-bit color)
-		// Each entry points to the beginning of a row.
-		png_byte **row_pointers;
-
-		// Row buffer. (15-bit or 16-bit color)
-		// libpng doesn't support 15-bit or 16-bit color natively,
-		// so the rows have to be converted.
-		png_byte *row_buffer;
-	} row;
-
-	if (img_data->bpp == 32) {
-		row.row_pointers = (png_byte**)png_malloc(png_ptr, sizeof(png_byte*) * img_data->h);
-	} else {
-		row.row_buffer = (png_byte*)png_malloc(png_ptr, sizeof(png_byte*) * img_data->w * 3);
-	}
-	if (!row.p) {
+	png_byte *const row_buffer = (png_byte*)png_malloc(png_ptr, (img_data->w * 3) + 16);
+	if (!row_buffer) {
 		// Not enough memory is available.
 		return -ENOMEM;
 	}
@@ -263,18 +557,36 @@ int PngWriterPrivate::writeToPng(png_structp png_ptr, png_infop info_ptr,
 #ifdef PNG_SETJMP_SUPPORTED
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		// PNG write failed.
-		png_free(png_ptr, row.p);
+		png_free(png_ptr, row_buffer);
 		// TODO: Better error code?
 		return -ENOMEM;
 	}
 #endif /* PNG_SETJMP_SUPPORTED */
 
-	// Disable PNG filters.
-	png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
+	// Set the PNG filter strategy.
+	int png_filter;
+	switch (filter) {
+		case PngWriter::FILTER_NONE:
+		default:
+			png_filter = PNG_FILTER_NONE;
+			break;
+		case PngWriter::FILTER_SUB:
+			png_filter = PNG_FILTER_SUB;
+			break;
+		case PngWriter::FILTER_UP:
+			png_filter = PNG_FILTER_UP;
+			break;
+		case PngWriter::FILTER_PAETH:
+			png_filter = PNG_FILTER_PAETH;
+			break;
+		case PngWriter::FILTER_ADAPTIVE:
+			png_filter = PNG_ALL_FILTERS;
+			break;
+	}
+	png_set_filter(png_ptr, 0, png_filter);
 
-	// Set the compression level to 5. (Levels range from 1 to 9.)
-	// TODO: Add a parameter for this?
-	png_set_compression_level(png_ptr, 5);
+	// Set the compression level.
+	png_set_compression_level(png_ptr, compressionLevel);
 
 	// Set up the PNG header.
 	png_set_IHDR(png_ptr, info_ptr, img_data->w, img_data->h,
@@ -323,46 +635,15 @@ int PngWriterPrivate::writeToPng(png_structp png_ptr, png_infop info_ptr,
 	png_write_info(png_ptr, info_ptr);
 
 	// Write the image.
-	switch (img_data->bpp) {
-		case 15: {
-			// 15-bit color. (555)
-			T_writePNG_rows_16<uint16_t, 5, 5, 5>
-					  (img_data, row.row_buffer, png_ptr);
-			break;
-		}
-
-		case 16: {
-			// 16-bit color. (565)
-			T_writePNG_rows_16<uint16_t, 5, 6, 5>
-					  (img_data, row.row_buffer, png_ptr);
-			// TODO
-			break;
-		}
-
-		case 32:
-		default:
-			// Initialize the row pointers array.
-			// TODO: const uint8_t*.
-			uint8_t *data = (uint8_t*)img_data->data + ((img_data->h - 1) * img_data->pitch);
-			for (int y = img_data->h - 1; y >= 0; y--, data -= img_data->pitch) {
-				row.row_pointers[y] = data;
-			}
-
-			// libpng expects RGB data with no alpha channel, i.e. 24-bit.
-			// However, there is an option to automatically convert 32-bit
-			// without alpha channel to 24-bit, so we'll use that.
-			png_set_filler(png_ptr, 0, PNG_FILLER_AFTER);
-
-			// We're using "BGR" color.
-			png_set_bgr(png_ptr);
-
-			// Write the image.
-			png_write_image(png_ptr, row.row_pointers);
-			break;
+	const ConvertRowFn convertRow = getConvertRowFn(img_data->bpp);
+	const uint8_t *src = (const uint8_t*)img_data->data;
+	for (unsigned int y = img_data->h; y > 0; y--, src += img_data->pitch) {
+		convertRow(row_buffer, src, img_data->w);
+		png_write_row(png_ptr, row_buffer);
 	}
 
-	// Free the row pointers.
-	png_free(png_ptr, row.p);
+	// Free the row buffer.
+	png_free(png_ptr, row_buffer);
 
 	// Finished writing the PNG image.
 	png_write_end(png_ptr, info_ptr);
@@ -380,6 +661,49 @@ PngWriter::~PngWriter()
 	delete d;
 }
 
+/**
+ * Get the zlib compression level.
+ * @return Compression level. (0-9)
+ */
+int PngWriter::compressionLevel(void) const
+{
+	return d->compressionLevel;
+}
+
+/**
+ * Set the zlib compression level.
+ * Default is 5.
+ * @param level Compression level. (0 == none; 1 == fastest; 9 == best)
+ */
+void PngWriter::setCompressionLevel(int level)
+{
+	if (level < 0)
+		level = 0;
+	else if (level > 9)
+		level = 9;
+	d->compressionLevel = level;
+}
+
+/**
+ * Get the PNG filter strategy.
+ * @return PNG filter strategy.
+ */
+PngWriter::FilterStrategy PngWriter::filterStrategy(void) const
+{
+	return d->filter;
+}
+
+/**
+ * Set the PNG filter strategy.
+ * Default is FILTER_NONE.
+ * @param filter PNG filter strategy.
+ */
+void PngWriter::setFilterStrategy(FilterStrategy filter)
+{
+	assert(filter >= FILTER_NONE && filter < FILTER_MAX);
+	d->filter = filter;
+}
+
 /**
  * Write an image to a PNG file.
  * No metadata other than creation time will be saved.
@@ -48,6 +48,47 @@ class PngWriter
 		PngWriter &operator=(const PngWriter &);
 
 	public:
+		/**
+		 * PNG filter strategy.
+		 * Filtering usually makes the image smaller,
+		 * but it takes longer to compress.
+		 */
+		enum FilterStrategy {
+			FILTER_NONE	= 0,	// No filtering. (fastest)
+			FILTER_SUB	= 1,	// "Sub" filter. (good for emulator screenshots)
+			FILTER_UP	= 2,	// "Up" filter.
+			FILTER_PAETH	= 3,	// "Paeth" filter.
+			FILTER_ADAPTIVE	= 4,	// libpng chooses a filter for each row. (slowest)
+
+			FILTER_MAX
+		};
+
+		/**
+		 * Get the zlib compression level.
+		 * @return Compression level. (0-9)
+		 */
+		int compressionLevel(void) const;
+
+		/**
+		 * Set the zlib compression level.
+		 * Default is 5.
+		 * @param level Compression level. (0 == none; 1 == fastest; 9 == best)
+		 */
+		void setCompressionLevel(int level);
+
+		/**
+		 * Get the PNG filter strategy.
+		 * @return PNG filter strategy.
+		 */
+		FilterStrategy filterStrategy(void) const;
+
+		/**
+		 * Set the PNG filter strategy.
+		 * Default is FILTER_NONE.
+		 * @param filter PNG filter strategy.
+		 */
+		void setFilterStrategy(FilterStrategy filter);
+
 		/**
 		 * Write an image to a PNG file.
 		 * No metadata other than creation time will be saved.
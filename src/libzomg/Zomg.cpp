@@ -48,6 +48,7 @@
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <cassert>
 #include <cerrno>
 
 // C++ includes.
@@ -59,10 +60,16 @@ namespace LibZomg {
 
 /** ZomgPrivate **/
 
+// Default compression settings.
+int ZomgPrivate::ms_defaultCompression = Zomg::CP_DEFAULT;
+bool ZomgPrivate::ms_defaultPreviewEnabled = true;
+
 ZomgPrivate::ZomgPrivate(Zomg *q)
 	: q(q)
 	, unz(nullptr)	// TODO: Combine with zip into a union?
 	, zip(nullptr)	// Need to double-check all users.
+	, compression(ms_defaultCompression)
+	, previewEnabled(ms_defaultPreviewEnabled)
 { }
 
 ZomgPrivate::~ZomgPrivate()
@@ -78,14 +85,7 @@ ZomgPrivate::~ZomgPrivate()
  */
 int ZomgPrivate::initZomgLoad(const char *filename)
 {
-#ifdef _WIN32
-	zlib_filefunc64_def ffunc;
-	fill_win32_filefunc64U(&ffunc);
-	this->unz = unzOpen2_64(filename, &ffunc);
-#else
-	this->unz = unzOpen(filename);
-#endif
-
+	this->unz = openUnz(filename);
 	if (!this->unz) {
 		// TODO: Figure out why open failed.
 		// On Windows, GetLastError() may work.
@@ -111,6 +111,23 @@ int ZomgPrivate::initZomgLoad(const char *filename)
 	return 0;
 }
 
+/**
+ * Open a ZOMG file for reading.
+ * Only the Zip central directory is read.
+ * @param filename ZOMG file.
+ * @return unzFile handle, or nullptr on error.
+ */
+unzFile ZomgPrivate::openUnz(const char *filename)
+{
+#ifdef _WIN32
+	zlib_filefunc64_def ffunc;
+	fill_win32_filefunc64U(&ffunc);
+	return unzOpen2_64(filename, &ffunc);
+#else
+	return unzOpen(filename);
+#endif
+}
+
 /**
  * Initialize the Zomg class for saving a Zomg.
  * @param filename Zomg file to save.
@@ -217,6 +234,7 @@ void Zomg::close(void)
 		unzClose(d->unz);
 		d->unz = nullptr;
 	}
+	d->prefetched.clear();
 
 	if (d->zip) {
 		zipClose(d->zip, nullptr);
@@ -228,6 +246,82 @@ void Zomg::close(void)
 }
 
 
+/**
+ * Get the compression profile.
+ * @return Compression profile.
+ */
+Zomg::CompressionProfile Zomg::compressionProfile(void) const
+{
+	return (CompressionProfile)d->compression;
+}
+
+/**
+ * Set the compression profile.
+ * This only affects files saved afterwards.
+ * @param profile Compression profile.
+ */
+void Zomg::setCompressionProfile(CompressionProfile profile)
+{
+	assert(profile >= CP_STORE && profile < CP_MAX);
+	d->compression = profile;
+}
+
+/**
+ * Is the preview image enabled?
+ * @return True if savePreview() writes the preview image.
+ */
+bool Zomg::isPreviewEnabled(void) const
+{
+	return d->previewEnabled;
+}
+
+/**
+ * Enable or disable the preview image.
+ * If disabled, savePreview() doesn't do anything.
+ * @param enabled True to enable; false to disable.
+ */
+void Zomg::setPreviewEnabled(bool enabled)
+{
+	d->previewEnabled = enabled;
+}
+
+/**
+ * Get the default compression profile for new Zomg objects.
+ * @return Default compression profile.
+ */
+Zomg::CompressionProfile Zomg::DefaultCompressionProfile(void)
+{
+	return (CompressionProfile)ZomgPrivate::ms_defaultCompression;
+}
+
+/**
+ * Set the default compression profile for new Zomg objects.
+ * @param profile Default compression profile.
+ */
+void Zomg::SetDefaultCompressionProfile(CompressionProfile profile)
+{
+	assert(profile >= CP_STORE && profile < CP_MAX);
+	ZomgPrivate::ms_defaultCompression = profile;
+}
+
+/**
+ * Is the preview image enabled by default for new Zomg objects?
+ * @return True if enabled by default.
+ */
+bool Zomg::DefaultPreviewEnabled(void)
+{
+	return ZomgPrivate::ms_defaultPreviewEnabled;
+}
+
+/**
+ * Enable or disable the preview image by default for new Zomg objects.
+ * @param enabled True to enable; false to disable.
+ */
+void Zomg::SetDefaultPreviewEnabled(bool enabled)
+{
+	ZomgPrivate::ms_defaultPreviewEnabled = enabled;
+}
+
 /**
  * Detect if a savestate is supported by this class.
  * @param filename Savestate filename.
@@ -59,6 +59,70 @@ class Zomg : public ZomgBase
 		 */
 		static bool DetectFormat(const char *filename);
 
+		/**
+		 * Decompress the large files in the ZOMG file in parallel.
+		 * (VRam, M68K memory, Z80 memory, and optionally SRAM.)
+		 *
+		 * Opening a ZOMG file for loading only reads the Zip central
+		 * directory. Files are decompressed when they're loaded, so
+		 * reading the preview image or mtime doesn't decompress the
+		 * rest of the savestate. When loading the entire savestate,
+		 * call prefetch() first to use multiple threads.
+		 *
+		 * @param saveData If true, also prefetch SRAM.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int prefetch(bool saveData = false);
+
+		/**
+		 * Compression profile for saving.
+		 * The preview image is always stored without
+		 * compression, since PNG is already compressed.
+		 */
+		enum CompressionProfile {
+			CP_STORE	= 0,	// No compression. (Fastest, but largest files.)
+			CP_FAST		= 1,	// Fast deflate. (zlib level 1)
+			CP_DEFAULT	= 2,	// Default deflate. (zlib level 6)
+			CP_BEST		= 3,	// Best deflate. (zlib level 9)
+
+			CP_MAX
+		};
+
+		/**
+		 * Get the compression profile.
+		 * @return Compression profile.
+		 */
+		CompressionProfile compressionProfile(void) const;
+
+		/**
+		 * Set the compression profile.
+		 * This only affects files saved afterwards.
+		 * @param profile Compression profile.
+		 */
+		void setCompressionProfile(CompressionProfile profile);
+
+		/**
+		 * Is the preview image enabled?
+		 * @return True if savePreview() writes the preview image.
+		 */
+		bool isPreviewEnabled(void) const;
+
+		/**
+		 * Enable or disable the preview image.
+		 * If disabled, savePreview() doesn't do anything.
+		 * @param enabled True to enable; false to disable.
+		 */
+		void setPreviewEnabled(bool enabled);
+
+		/**
+		 * Default compression settings for new Zomg objects.
+		 * Frontends should set these from the user's configuration.
+		 */
+		static CompressionProfile DefaultCompressionProfile(void);
+		static void SetDefaultCompressionProfile(CompressionProfile profile);
+		static bool DefaultPreviewEnabled(void);
+		static void SetDefaultPreviewEnabled(bool enabled);
+
 		/**
 		 * Load savestate functions.
 		 * @param siz Number of bytes to read.
@@ -259,6 +259,23 @@ int ZomgBase::loadEEPRom(uint8_t *eeprom, size_t siz)
 	return -ENOSYS;
 }
 
+/**
+ * Load emulator-internal state.
+ * Only in-memory snapshots support this, so
+ * m_lastError isn't set if it's not supported.
+ * @param id	[in] Internal state ID.
+ * @param data	[out] Buffer for the internal state.
+ * @param siz	[in] Size of data.
+ * @return 0 on success; -ENOENT if not present; -EINVAL if the size doesn't match; -ENOSYS if not supported.
+ */
+int ZomgBase::loadInternal(InternalID id, void *data, size_t siz)
+{
+	((void)id);
+	((void)data);
+	((void)siz);
+	return -ENOSYS;
+}
+
 /** Save functions. **/
 
 /**
@@ -465,4 +482,21 @@ int ZomgBase::saveEEPRom(const uint8_t *eeprom, size_t siz)
 	return -ENOSYS;
 }
 
+/**
+ * Save emulator-internal state.
+ * Only in-memory snapshots support this, so
+ * m_lastError isn't set if it's not supported.
+ * @param id	[in] Internal state ID.
+ * @param data	[in] Internal state.
+ * @param siz	[in] Size of data.
+ * @return 0 on success; -ENOSYS if not supported.
+ */
+int ZomgBase::saveInternal(InternalID id, const void *data, size_t siz)
+{
+	((void)id);
+	((void)data);
+	((void)siz);
+	return -ENOSYS;
+}
+
 }
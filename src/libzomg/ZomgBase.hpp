@@ -154,6 +154,30 @@ class ZomgBase
 		virtual int loadEEPRomCache(uint8_t *cache, size_t siz);
 		virtual int loadEEPRom(uint8_t *eeprom, size_t siz);
 
+		/**
+		 * Emulator-internal state.
+		 * This is state that isn't part of the ZOMG format,
+		 * e.g. YM2612 envelopes and timers. It's stored in
+		 * the emulator's own layout, so it can only be used
+		 * by in-memory snapshots from the same build.
+		 */
+		enum InternalID {
+			INTERNAL_PSG = 0,
+			INTERNAL_MD_YM2612,
+			INTERNAL_M68K,
+
+			INTERNAL_MAX
+		};
+
+		/**
+		 * Load emulator-internal state.
+		 * @param id	[in] Internal state ID.
+		 * @param data	[out] Buffer for the internal state.
+		 * @param siz	[in] Size of data.
+		 * @return 0 on success; -ENOENT if not present; -EINVAL if the size doesn't match; -ENOSYS if not supported.
+		 */
+		virtual int loadInternal(InternalID id, void *data, size_t siz);
+
 		/** Save functions. **/
 
 		// TODO: Determine siz and is16bit from the system type?
@@ -212,6 +236,15 @@ class ZomgBase
 		virtual int saveEEPRomCache(const uint8_t *cache, size_t siz);
 		virtual int saveEEPRom(const uint8_t *eeprom, size_t siz);
 
+		/**
+		 * Save emulator-internal state.
+		 * @param id	[in] Internal state ID.
+		 * @param data	[in] Internal state.
+		 * @param siz	[in] Size of data.
+		 * @return 0 on success; -ENOSYS if not supported.
+		 */
+		virtual int saveInternal(InternalID id, const void *data, size_t siz);
+
 	protected:
 		// TODO: Move to a private class?
 		std::string m_filename;
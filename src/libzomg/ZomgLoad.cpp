@@ -51,6 +51,10 @@
 #include <cassert>
 #include <cerrno>
 
+// C++ includes.
+#include <thread>
+#include <vector>
+
 // PngReader.
 #include "PngReader.hpp"
 #include "img_data.h"
@@ -59,39 +63,162 @@
 namespace LibZomg {
 
 /**
- * Load a file from the ZOMG file.
+ * Read a file from a ZOMG file.
+ * @param unz unzFile handle.
  * @param filename Filename to load from the ZOMG file.
  * @param buf Buffer to store the file in.
  * @param len Length of the buffer.
  * @return Length of file loaded, or negative number on error.
  */
-int ZomgPrivate::loadFromZomg(const char *filename, void *buf, int len)
+int ZomgPrivate::readFromUnz(unzFile unz, const char *filename, void *buf, int len)
 {
-	if (q->m_mode != ZomgBase::ZOMG_LOAD || !this->unz)
-		return -EBADF;
-
 	// Locate the file in the ZOMG file.
-	int ret = unzLocateFile(this->unz, filename, 2);
+	int ret = unzLocateFile(unz, filename, 2);
 	if (ret != UNZ_OK) {
 		// File not found.
 		return -ENOENT;
 	}
 
 	// Open the current file.
-	ret = unzOpenCurrentFile(this->unz);
+	ret = unzOpenCurrentFile(unz);
 	if (ret != UNZ_OK) {
 		// Error opening the current file.
 		return -EIO;
 	}
 
 	// Read the file.
-	ret = unzReadCurrentFile(this->unz, buf, len);
-	unzCloseCurrentFile(this->unz);	// TODO: Check the return value!
+	ret = unzReadCurrentFile(unz, buf, len);
+	unzCloseCurrentFile(unz);	// TODO: Check the return value!
 
 	// Return the number of bytes read.
 	return ret;
 }
 
+/**
+ * Load a file from the ZOMG file.
+ * @param filename Filename to load from the ZOMG file.
+ * @param buf Buffer to store the file in.
+ * @param len Length of the buffer.
+ * @return Length of file loaded, or negative number on error.
+ */
+int ZomgPrivate::loadFromZomg(const char *filename, void *buf, int len)
+{
+	if (q->m_mode != ZomgBase::ZOMG_LOAD || !this->unz)
+		return -EBADF;
+
+	// Check if the file was prefetched.
+	for (std::vector<PrefetchEntry>::const_iterator iter = prefetched.begin();
+	     iter != prefetched.end(); ++iter)
+	{
+		if (strcmp(iter->filename, filename) != 0)
+			continue;
+		if (iter->ret < 0) {
+			// Error reading the file.
+			return iter->ret;
+		}
+
+		const int copy = (iter->ret < len ? iter->ret : len);
+		if (copy > 0) {
+			memcpy(buf, iter->data.data(), copy);
+		}
+		return copy;
+	}
+
+	return readFromUnz(this->unz, filename, buf, len);
+}
+
+/**
+ * Prefetch thread function.
+ * Each thread opens its own unzFile handle,
+ * since MiniZip handles can't be shared.
+ * @param zomgFilename ZOMG file.
+ * @param entry Prefetched file.
+ */
+void ZomgPrivate::prefetchThread(const char *zomgFilename, PrefetchEntry *entry)
+{
+	unzFile unz = openUnz(zomgFilename);
+	if (!unz) {
+		entry->ret = -EIO;
+		return;
+	}
+	entry->ret = readFromUnz(unz, entry->filename,
+			entry->data.data(), (int)entry->data.size());
+	unzClose(unz);
+}
+
+/**
+ * Decompress the large files in the ZOMG file in parallel.
+ * @param saveData If true, also prefetch SRAM.
+ * @return 0 on success; negative errno on error.
+ */
+int Zomg::prefetch(bool saveData)
+{
+	if (m_mode != ZomgBase::ZOMG_LOAD || !d->unz)
+		return -EBADF;
+
+	// Large files. Everything else is only a few bytes.
+	static const char *const files[] = {
+		"common/VRam.bin",
+		"MD/M68K_mem.bin",
+		"common/Z80_mem.bin",
+		"common/SRam.bin",
+	};
+	const int count = (saveData ? 4 : 3);
+
+	// Allocate buffers for the files that are present.
+	// NOTE: The vector must not be resized once
+	// the threads are started.
+	d->prefetched.clear();
+	d->prefetched.reserve(count);
+	for (int i = 0; i < count; i++) {
+		if (unzLocateFile(d->unz, files[i], 2) != UNZ_OK)
+			continue;
+		unz_file_info64 file_info;
+		if (unzGetCurrentFileInfo64(d->unz, &file_info, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+			continue;
+		// Sanity check: These files are normally 64 KB or less.
+		// Anything larger is loaded on demand.
+		if (file_info.uncompressed_size > 1024*1024)
+			continue;
+
+		d->prefetched.push_back(ZomgPrivate::PrefetchEntry());
+		ZomgPrivate::PrefetchEntry &entry = d->prefetched.back();
+		entry.filename = files[i];
+		entry.data.resize((size_t)file_info.uncompressed_size);
+		entry.ret = 0;
+	}
+	if (d->prefetched.empty())
+		return 0;
+
+	// Decompress the files.
+	// The first file is decompressed on this thread
+	// using the existing handle.
+	std::vector<std::thread> threads;
+	if (std::thread::hardware_concurrency() > 1) {
+		threads.reserve(d->prefetched.size() - 1);
+		for (size_t i = 1; i < d->prefetched.size(); i++) {
+			threads.push_back(std::thread(&ZomgPrivate::prefetchThread,
+					m_filename.c_str(), &d->prefetched[i]));
+		}
+	} else {
+		// Single CPU. Decompress everything on this thread.
+		for (size_t i = 1; i < d->prefetched.size(); i++) {
+			ZomgPrivate::PrefetchEntry &entry = d->prefetched[i];
+			entry.ret = ZomgPrivate::readFromUnz(d->unz, entry.filename,
+					entry.data.data(), (int)entry.data.size());
+		}
+	}
+
+	ZomgPrivate::PrefetchEntry &first = d->prefetched[0];
+	first.ret = ZomgPrivate::readFromUnz(d->unz, first.filename,
+			first.data.data(), (int)first.data.size());
+
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	return 0;
+}
+
 /**
  * Load savestate functions.
  * @param siz Number of bytes to read.
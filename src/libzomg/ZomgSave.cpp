@@ -89,20 +89,15 @@ using std::string;
 namespace LibZomg {
 
 /**
- * Save a file to the ZOMG file.
- * @param filename     [in] Filename to save in the ZOMG file.
- * @param buf          [in] Buffer containing the file contents.
- * @param len          [in] Length of the buffer.
- * @param fileType     [in] File type, e.g. binary or text.
- * @return 0 on success; non-zero on error.
+ * Open a new file in the ZOMG file.
+ * @param filename	[in] Filename in the ZOMG file.
+ * @param fileType	[in] File type, e.g. binary or text.
+ * @param compress	[in] If true, compress the file using the current compression profile.
+ * @return 0 on success; negative errno on error.
  */
-int ZomgPrivate::saveToZomg(const char *filename, const void *buf, int len,
-			    ZomgZipFileType_t fileType)
+int ZomgPrivate::openFileInZomg(const char *filename,
+				ZomgZipFileType_t fileType, bool compress)
 {
-	if (q->m_mode != ZomgBase::ZOMG_SAVE || !this->zip)
-		return -EBADF;
-
-	// Open the new file in the ZOMG file.
 	zip_fileinfo zipfi;
 	memcpy(&zipfi.tmz_date, &this->zipfi.tmz_date, sizeof(zipfi.tmz_date));
 	zipfi.dosDate = 0;
@@ -110,6 +105,26 @@ int ZomgPrivate::saveToZomg(const char *filename, const void *buf, int len,
 	zipfi.internal_fa = fileType;
 	zipfi.external_fa = ZIP_EXTERNAL_FA;	// External attributes. (OS-dependent)
 
+	// Compression method and level.
+	int method = Z_DEFLATED;
+	int level;
+	switch (compress ? this->compression : Zomg::CP_STORE) {
+		case Zomg::CP_STORE:
+			method = 0;	// Stored.
+			level = 0;
+			break;
+		case Zomg::CP_FAST:
+			level = Z_BEST_SPEED;
+			break;
+		case Zomg::CP_DEFAULT:
+		default:
+			level = Z_DEFAULT_COMPRESSION;
+			break;
+		case Zomg::CP_BEST:
+			level = Z_BEST_COMPRESSION;
+			break;
+	}
+
 	int ret = zipOpenNewFileInZip4(
 		this->zip,		// zipFile
 		filename,		// Filename in the Zip archive
@@ -119,8 +134,8 @@ int ZomgPrivate::saveToZomg(const char *filename, const void *buf, int len,
 		nullptr,		// extrafield_global,
 		0,			// size_extrafield_global,
 		nullptr,		// comment
-		Z_DEFLATED,		// method
-		Z_DEFAULT_COMPRESSION,  // level
+		method,			// method
+		level,			// level
 		// The following values, except for versionMadeBy,
 		// are all defaults from zipOpenNewFileInZip().
 		0,			// raw
@@ -137,6 +152,27 @@ int ZomgPrivate::saveToZomg(const char *filename, const void *buf, int len,
 		// Error opening the new file in the Zip archive.
 		return -EIO;
 	}
+	return 0;
+}
+
+/**
+ * Save a file to the ZOMG file.
+ * @param filename     [in] Filename to save in the ZOMG file.
+ * @param buf          [in] Buffer containing the file contents.
+ * @param len          [in] Length of the buffer.
+ * @param fileType     [in] File type, e.g. binary or text.
+ * @return 0 on success; non-zero on error.
+ */
+int ZomgPrivate::saveToZomg(const char *filename, const void *buf, int len,
+			    ZomgZipFileType_t fileType)
+{
+	if (q->m_mode != ZomgBase::ZOMG_SAVE || !this->zip)
+		return -EBADF;
+
+	// Open the new file in the ZOMG file.
+	int ret = openFileInZomg(filename, fileType, true);
+	if (ret != 0)
+		return ret;
 
 	// Write the file.
 	zipWriteInFileInZip(this->zip, buf, len);	// TODO: Check the return value!
@@ -208,43 +244,36 @@ int Zomg::savePreview(const Zomg_Img_Data_t *img_data,
 	if (m_mode != ZomgBase::ZOMG_SAVE || !d->zip)
 		return -EBADF;
 
-	// Open the new file in the ZOMG file.
-	zip_fileinfo zipfi;
-	memcpy(&zipfi.tmz_date, &d->zipfi.tmz_date, sizeof(zipfi.tmz_date));
-	zipfi.dosDate = 0;
-	zipfi.internal_fa = ZomgPrivate::ZOMG_FILE_BINARY;
-	zipfi.external_fa = ZIP_EXTERNAL_FA;	// External attributes. (OS-dependent)
-
-	int ret = zipOpenNewFileInZip4(
-		d->zip,			// zipFile
-		"preview.png",		// Filename in the Zip archive
-		&zipfi,			// File information (timestamp, attributes)
-		nullptr,		// extrafield_local
-		0,			// size_extrafield_local,
-		nullptr,		// extrafield_global,
-		0,			// size_extrafield_global,
-		nullptr,		// comment
-		Z_DEFLATED,		// method
-		Z_DEFAULT_COMPRESSION,	// level
-		// The following values, except for versionMadeBy,
-		// are all defaults from zipOpenNewFileInZip().
-		0,			// raw
-		-MAX_WBITS,		// windowBits
-		DEF_MEM_LEVEL,		// memLevel
-		Z_DEFAULT_STRATEGY,	// strategy
-		nullptr,		// password
-		0,			// crcForCrypting
-		ZIP_VERSION_MADE_BY,	// versionMadeBy
-		0			// flagBase
-		);
-
-	if (ret != UNZ_OK) {
-		// Error opening the new file in the Zip archive.
-		return -EIO;
+	if (!d->previewEnabled) {
+		// Preview images are disabled.
+		return 0;
 	}
 
+	// Open the new file in the ZOMG file.
+	// PNG images are already compressed, so
+	// the preview image is always stored.
+	int ret = d->openFileInZomg("preview.png", ZomgPrivate::ZOMG_FILE_BINARY, false);
+	if (ret != 0)
+		return ret;
+
 	// Write the file.
+	// The PNG encoder settings follow the compression profile.
 	PngWriter pngWriter;	// TODO: Make it static?
+	switch (d->compression) {
+		case CP_STORE:
+		case CP_FAST:
+			pngWriter.setCompressionLevel(Z_BEST_SPEED);
+			pngWriter.setFilterStrategy(PngWriter::FILTER_SUB);
+			break;
+		case CP_DEFAULT:
+		default:
+			// Use the PngWriter defaults.
+			break;
+		case CP_BEST:
+			pngWriter.setCompressionLevel(Z_BEST_COMPRESSION);
+			pngWriter.setFilterStrategy(PngWriter::FILTER_ADAPTIVE);
+			break;
+	}
 	ret = pngWriter.writeToZip(img_data, d->zip, metadata, metaFlags);
 	zipCloseFileInZip(d->zip);	// TODO: Check the return value!
 
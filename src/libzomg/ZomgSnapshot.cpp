@@ -0,0 +1,584 @@
+/***************************************************************************
+ * libzomg: Zipped Original Memory from Genesis.                           *
+ * ZomgSnapshot.cpp: In-memory savestate snapshot.                         *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "ZomgSnapshot.hpp"
+
+// ZOMG save structs.
+#include "zomg_vdp.h"
+#include "zomg_psg.h"
+#include "zomg_ym2612.h"
+#include "zomg_m68k.h"
+#include "zomg_z80.h"
+#include "zomg_md_io.h"
+#include "zomg_md_z80_ctrl.h"
+#include "zomg_md_time_reg.h"
+#include "zomg_md_tmss_reg.h"
+#include "zomg_eeprom.h"
+
+// C includes. (C++ namespace)
+#include <cstring>
+#include <cerrno>
+
+namespace LibZomg {
+
+// Snapshot header.
+// All fields are host-endian.
+struct SnapshotHeader {
+	uint32_t magic;		// SNAPSHOT_MAGIC
+	uint16_t version;	// ZomgSnapshot::SNAPSHOT_VERSION
+	uint16_t reserved;
+	uint32_t system;	// ZomgSnapshot::SnapshotSystem
+	uint32_t size;		// Total size, including this header.
+};
+
+// Chunk header.
+struct ChunkHeader {
+	uint16_t id;		// ChunkID
+	uint16_t byteorder;	// ZomgByteorder_t
+	uint32_t size;		// Size of the data, without padding.
+};
+
+// 'GSNP'
+static const uint32_t SNAPSHOT_MAGIC = 0x47534E50;
+
+// Chunk data is padded to a multiple of 8 bytes.
+static inline size_t ChunkPad(size_t siz)
+	{ return ((siz + 7) & ~(size_t)7); }
+
+/**
+ * Create a snapshot in the specified buffer.
+ * If the buffer is too small, nothing else will be written,
+ * but size() will still return the required size.
+ * @param buf	[out] Buffer. (May be nullptr to determine the required size.)
+ * @param siz	[in] Size of buf.
+ * @param system	[in] System ID.
+ */
+ZomgSnapshot::ZomgSnapshot(void *buf, size_t siz, uint32_t system)
+	: ZomgBase(nullptr, ZOMG_SAVE)
+	, m_wbuf(reinterpret_cast<uint8_t*>(buf))
+	, m_rbuf(nullptr)
+	, m_siz(buf ? siz : 0)
+	, m_pos(sizeof(SnapshotHeader))
+	, m_search(0)
+	, m_system(system)
+{
+	// The header is written by close(),
+	// since the total size isn't known yet.
+	m_mode = ZOMG_SAVE;
+}
+
+/**
+ * Open a snapshot for loading.
+ * If the snapshot is invalid, isOpen() will return false.
+ * @param buf	[in] Snapshot.
+ * @param siz	[in] Size of buf.
+ */
+ZomgSnapshot::ZomgSnapshot(const void *buf, size_t siz)
+	: ZomgBase(nullptr, ZOMG_LOAD)
+	, m_wbuf(nullptr)
+	, m_rbuf(reinterpret_cast<const uint8_t*>(buf))
+	, m_siz(siz)
+	, m_pos(0)
+	, m_search(sizeof(SnapshotHeader))
+	, m_system(0)
+{
+	if (!buf || siz < sizeof(SnapshotHeader)) {
+		m_lastError = -EINVAL;
+		return;
+	}
+
+	SnapshotHeader header;
+	memcpy(&header, buf, sizeof(header));
+	if (header.magic != SNAPSHOT_MAGIC ||
+	    header.version != SNAPSHOT_VERSION ||
+	    header.size < sizeof(SnapshotHeader) ||
+	    header.size > siz)
+	{
+		// Not a valid snapshot.
+		m_lastError = -EINVAL;
+		return;
+	}
+
+	m_pos = header.size;
+	m_system = header.system;
+	m_mode = ZOMG_LOAD;
+}
+
+ZomgSnapshot::~ZomgSnapshot()
+{
+	this->close();
+}
+
+/**
+ * Close the snapshot.
+ * In ZOMG_SAVE mode, this writes the header.
+ */
+void ZomgSnapshot::close(void)
+{
+	if (m_mode == ZOMG_SAVE && isComplete() && m_wbuf) {
+		SnapshotHeader header;
+		header.magic = SNAPSHOT_MAGIC;
+		header.version = SNAPSHOT_VERSION;
+		header.reserved = 0;
+		header.system = m_system;
+		header.size = (uint32_t)m_pos;
+		memcpy(m_wbuf, &header, sizeof(header));
+	}
+
+	m_mode = ZOMG_CLOSED;
+}
+
+/**
+ * Save a chunk.
+ * @param id		[in] Chunk ID.
+ * @param data		[in] Chunk data.
+ * @param siz		[in] Size of data.
+ * @param byteorder	[in] Byteorder of data.
+ * @return 0 on success; negative errno on error.
+ */
+int ZomgSnapshot::saveChunk(ChunkID id, const void *data, size_t siz,
+			    ZomgByteorder_t byteorder)
+{
+	if (m_mode != ZOMG_SAVE) {
+		m_lastError = -EBADF;
+		return -EBADF;
+	}
+
+	const size_t next = m_pos + sizeof(ChunkHeader) + ChunkPad(siz);
+	if (next <= m_siz) {
+		ChunkHeader chunk;
+		chunk.id = (uint16_t)id;
+		chunk.byteorder = (uint16_t)byteorder;
+		chunk.size = (uint32_t)siz;
+		memcpy(&m_wbuf[m_pos], &chunk, sizeof(chunk));
+		memcpy(&m_wbuf[m_pos + sizeof(chunk)], data, siz);
+	}
+
+	// Update the position even if the buffer is too small,
+	// so the caller can determine the required size.
+	m_pos = next;
+	if (!isComplete()) {
+		m_lastError = -ENOSPC;
+		return -ENOSPC;
+	}
+
+	m_lastError = 0;
+	return 0;
+}
+
+/**
+ * Load a chunk.
+ * @param id		[in] Chunk ID.
+ * @param data		[out] Buffer for the chunk data.
+ * @param siz		[in] Size of data.
+ * @param byteorder	[in] Requested byteorder.
+ * @param chunkSize	[out, opt] Size of the chunk in the snapshot.
+ * @return Bytes read on success; negative errno on error.
+ */
+int ZomgSnapshot::loadChunk(ChunkID id, void *data, size_t siz,
+			    ZomgByteorder_t byteorder, size_t *chunkSize)
+{
+	if (m_mode != ZOMG_LOAD) {
+		m_lastError = -EBADF;
+		return -EBADF;
+	}
+
+	// Search from the last chunk loaded to the end of the
+	// snapshot, then from the beginning.
+	size_t pos = m_search;
+	bool wrapped = false;
+	while (true) {
+		if (wrapped && pos >= m_search)
+			break;
+		if (pos + sizeof(ChunkHeader) > m_pos) {
+			if (wrapped)
+				break;
+			pos = sizeof(SnapshotHeader);
+			wrapped = true;
+			continue;
+		}
+
+		ChunkHeader chunk;
+		memcpy(&chunk, &m_rbuf[pos], sizeof(chunk));
+		const size_t next = pos + sizeof(chunk) + ChunkPad(chunk.size);
+		if (next > m_pos || next <= pos) {
+			// Corrupted chunk.
+			break;
+		}
+
+		if (chunk.id == id) {
+			if (chunk.byteorder != byteorder) {
+				// Snapshots are never byteswapped.
+				m_lastError = -EINVAL;
+				return -EINVAL;
+			}
+
+			// If the chunk is smaller than the buffer,
+			// clear the rest of the buffer.
+			const size_t copy = (chunk.size < siz ? chunk.size : siz);
+			memcpy(data, &m_rbuf[pos + sizeof(chunk)], copy);
+			if (copy < siz) {
+				memset((uint8_t*)data + copy, 0, siz - copy);
+			}
+			m_search = next;
+			m_lastError = 0;
+			if (chunkSize) {
+				*chunkSize = chunk.size;
+			}
+			return (int)copy;
+		}
+
+		pos = next;
+	}
+
+	// Chunk not found.
+	m_lastError = -ENOENT;
+	return -ENOENT;
+}
+
+/**
+ * Copy the snapshot to another ZOMG object.
+ * This can be used to write a snapshot to a ZOMG file
+ * without access to the emulation context, e.g. from
+ * a background thread.
+ * Only valid in ZOMG_LOAD mode.
+ * @param zomg	[in,out] Destination ZOMG object. (must be in ZOMG_SAVE mode)
+ * @return 0 on success; negative errno on error.
+ */
+int ZomgSnapshot::copyTo(ZomgBase *zomg)
+{
+	if (m_mode != ZOMG_LOAD) {
+		m_lastError = -EBADF;
+		return -EBADF;
+	}
+	if (!zomg || !zomg->isOpen())
+		return -EINVAL;
+
+	size_t pos = sizeof(SnapshotHeader);
+	while (pos + sizeof(ChunkHeader) <= m_pos) {
+		ChunkHeader chunk;
+		memcpy(&chunk, &m_rbuf[pos], sizeof(chunk));
+		const size_t next = pos + sizeof(chunk) + ChunkPad(chunk.size);
+		if (next > m_pos || next <= pos) {
+			// Corrupted chunk.
+			m_lastError = -EINVAL;
+			return -EINVAL;
+		}
+
+		// NOTE: Chunk data is 8-byte aligned within the snapshot,
+		// so it can be passed to the save functions directly.
+		const uint8_t *const data = &m_rbuf[pos + sizeof(chunk)];
+		const ZomgByteorder_t byteorder = (ZomgByteorder_t)chunk.byteorder;
+
+		// Struct chunks must match the struct size.
+		#define CHECK_STRUCT(type) do { \
+			if (chunk.size != sizeof(type)) { \
+				m_lastError = -EINVAL; \
+				return -EINVAL; \
+			} \
+		} while (0)
+
+		int ret;
+		switch (chunk.id) {
+			case CHUNK_END:
+			default:
+				// Unknown chunk, or emulator-internal state.
+				// ZOMG files can't store internal state.
+				ret = 0;
+				break;
+
+			/** VDP **/
+			case CHUNK_VDP_REG:
+				ret = zomg->saveVdpReg(data, chunk.size);
+				break;
+			case CHUNK_VDP_CTRL_8:
+				CHECK_STRUCT(Zomg_VDP_ctrl_8_t);
+				ret = zomg->saveVdpCtrl_8(reinterpret_cast<const Zomg_VDP_ctrl_8_t*>(data));
+				break;
+			case CHUNK_VDP_CTRL_16:
+				CHECK_STRUCT(Zomg_VDP_ctrl_16_t);
+				ret = zomg->saveVdpCtrl_16(reinterpret_cast<const Zomg_VDP_ctrl_16_t*>(data));
+				break;
+			case CHUNK_VRAM:
+				ret = zomg->saveVRam(data, chunk.size, byteorder);
+				break;
+			case CHUNK_CRAM:
+				CHECK_STRUCT(Zomg_CRam_t);
+				ret = zomg->saveCRam(reinterpret_cast<const Zomg_CRam_t*>(data), byteorder);
+				break;
+			case CHUNK_MD_VSRAM:
+				ret = zomg->saveMD_VSRam(reinterpret_cast<const uint16_t*>(data), chunk.size, byteorder);
+				break;
+			case CHUNK_MD_VDP_SAT:
+				ret = zomg->saveMD_VDP_SAT(data, chunk.size, byteorder);
+				break;
+
+			/** Audio **/
+			case CHUNK_PSG_REG:
+				CHECK_STRUCT(Zomg_PsgSave_t);
+				ret = zomg->savePsgReg(reinterpret_cast<const Zomg_PsgSave_t*>(data));
+				break;
+			case CHUNK_MD_YM2612_REG:
+				CHECK_STRUCT(Zomg_Ym2612Save_t);
+				ret = zomg->saveMD_YM2612_reg(reinterpret_cast<const Zomg_Ym2612Save_t*>(data));
+				break;
+
+			/** CPUs **/
+			case CHUNK_Z80_MEM:
+				ret = zomg->saveZ80Mem(data, chunk.size);
+				break;
+			case CHUNK_Z80_REG:
+				CHECK_STRUCT(Zomg_Z80RegSave_t);
+				ret = zomg->saveZ80Reg(reinterpret_cast<const Zomg_Z80RegSave_t*>(data));
+				break;
+			case CHUNK_M68K_MEM:
+				ret = zomg->saveM68KMem(reinterpret_cast<const uint16_t*>(data), chunk.size, byteorder);
+				break;
+			case CHUNK_M68K_REG:
+				CHECK_STRUCT(Zomg_M68KRegSave_t);
+				ret = zomg->saveM68KReg(reinterpret_cast<const Zomg_M68KRegSave_t*>(data));
+				break;
+
+			/** MD-specific registers **/
+			case CHUNK_MD_IO:
+				CHECK_STRUCT(Zomg_MD_IoSave_t);
+				ret = zomg->saveMD_IO(reinterpret_cast<const Zomg_MD_IoSave_t*>(data));
+				break;
+			case CHUNK_MD_Z80_CTRL:
+				CHECK_STRUCT(Zomg_MD_Z80CtrlSave_t);
+				ret = zomg->saveMD_Z80Ctrl(reinterpret_cast<const Zomg_MD_Z80CtrlSave_t*>(data));
+				break;
+			case CHUNK_MD_TIME_REG:
+				CHECK_STRUCT(Zomg_MD_TimeReg_t);
+				ret = zomg->saveMD_TimeReg(reinterpret_cast<const Zomg_MD_TimeReg_t*>(data));
+				break;
+			case CHUNK_MD_TMSS_REG:
+				CHECK_STRUCT(Zomg_MD_TMSS_reg_t);
+				ret = zomg->saveMD_TMSS_reg(reinterpret_cast<const Zomg_MD_TMSS_reg_t*>(data));
+				break;
+
+			/** Miscellaneous **/
+			case CHUNK_SRAM:
+				ret = zomg->saveSRam(data, chunk.size);
+				break;
+			case CHUNK_EEPROM_CTRL:
+				CHECK_STRUCT(Zomg_EPR_ctrl_t);
+				ret = zomg->saveEEPRomCtrl(reinterpret_cast<const Zomg_EPR_ctrl_t*>(data));
+				break;
+			case CHUNK_EEPROM_CACHE:
+				ret = zomg->saveEEPRomCache(data, chunk.size);
+				break;
+			case CHUNK_EEPROM:
+				ret = zomg->saveEEPRom(data, chunk.size);
+				break;
+		}
+		#undef CHECK_STRUCT
+
+		if (ret != 0) {
+			m_lastError = ret;
+			return ret;
+		}
+		pos = next;
+	}
+
+	m_lastError = 0;
+	return 0;
+}
+
+/** Load functions. **/
+
+/** VDP **/
+
+int ZomgSnapshot::loadVdpReg(uint8_t *reg, size_t siz)
+	{ return loadChunk(CHUNK_VDP_REG, reg, siz); }
+int ZomgSnapshot::loadVdpCtrl_8(Zomg_VDP_ctrl_8_t *ctrl)
+	{ return loadChunk(CHUNK_VDP_CTRL_8, ctrl, sizeof(*ctrl)); }
+int ZomgSnapshot::loadVdpCtrl_16(Zomg_VDP_ctrl_16_t *ctrl)
+	{ return loadChunk(CHUNK_VDP_CTRL_16, ctrl, sizeof(*ctrl)); }
+int ZomgSnapshot::loadVRam(void *vram, size_t siz, ZomgByteorder_t byteorder)
+	{ return loadChunk(CHUNK_VRAM, vram, siz, byteorder); }
+int ZomgSnapshot::loadCRam(Zomg_CRam_t *cram, ZomgByteorder_t byteorder)
+	{ return loadChunk(CHUNK_CRAM, cram, sizeof(*cram), byteorder); }
+
+/** VDP (MD-specific) **/
+
+int ZomgSnapshot::loadMD_VSRam(uint16_t *vsram, size_t siz, ZomgByteorder_t byteorder)
+	{ return loadChunk(CHUNK_MD_VSRAM, vsram, siz, byteorder); }
+int ZomgSnapshot::loadMD_VDP_SAT(uint16_t *vdp_sat, size_t siz, ZomgByteorder_t byteorder)
+	{ return loadChunk(CHUNK_MD_VDP_SAT, vdp_sat, siz, byteorder); }
+
+/** Audio **/
+
+int ZomgSnapshot::loadPsgReg(Zomg_PsgSave_t *state)
+	{ return loadChunk(CHUNK_PSG_REG, state, sizeof(*state)); }
+int ZomgSnapshot::loadMD_YM2612_reg(Zomg_Ym2612Save_t *state)
+	{ return loadChunk(CHUNK_MD_YM2612_REG, state, sizeof(*state)); }
+
+/** Z80 **/
+
+int ZomgSnapshot::loadZ80Mem(uint8_t *mem, size_t siz)
+	{ return loadChunk(CHUNK_Z80_MEM, mem, siz); }
+int ZomgSnapshot::loadZ80Reg(Zomg_Z80RegSave_t *state)
+	{ return loadChunk(CHUNK_Z80_REG, state, sizeof(*state)); }
+
+/** M68K (MD-specific) **/
+
+int ZomgSnapshot::loadM68KMem(uint16_t *mem, size_t siz, ZomgByteorder_t byteorder)
+	{ return loadChunk(CHUNK_M68K_MEM, mem, siz, byteorder); }
+int ZomgSnapshot::loadM68KReg(Zomg_M68KRegSave_t *state)
+	{ return loadChunk(CHUNK_M68K_REG, state, sizeof(*state)); }
+
+/** MD-specific registers **/
+
+int ZomgSnapshot::loadMD_IO(Zomg_MD_IoSave_t *state)
+	{ return loadChunk(CHUNK_MD_IO, state, sizeof(*state)); }
+int ZomgSnapshot::loadMD_Z80Ctrl(Zomg_MD_Z80CtrlSave_t *state)
+	{ return loadChunk(CHUNK_MD_Z80_CTRL, state, sizeof(*state)); }
+int ZomgSnapshot::loadMD_TimeReg(Zomg_MD_TimeReg_t *state)
+	{ return loadChunk(CHUNK_MD_TIME_REG, state, sizeof(*state)); }
+int ZomgSnapshot::loadMD_TMSS_reg(Zomg_MD_TMSS_reg_t *tmss)
+	{ return loadChunk(CHUNK_MD_TMSS_REG, tmss, sizeof(*tmss)); }
+
+/** Miscellaneous **/
+
+int ZomgSnapshot::loadSRam(uint8_t *sram, size_t siz)
+	{ return loadChunk(CHUNK_SRAM, sram, siz); }
+int ZomgSnapshot::loadEEPRomCtrl(Zomg_EPR_ctrl_t *ctrl)
+	{ return loadChunk(CHUNK_EEPROM_CTRL, ctrl, sizeof(*ctrl)); }
+int ZomgSnapshot::loadEEPRomCache(uint8_t *cache, size_t siz)
+	{ return loadChunk(CHUNK_EEPROM_CACHE, cache, siz); }
+int ZomgSnapshot::loadEEPRom(uint8_t *eeprom, size_t siz)
+	{ return loadChunk(CHUNK_EEPROM, eeprom, siz); }
+
+/** Emulator-internal state **/
+
+/**
+ * Load emulator-internal state.
+ * @param id	[in] Internal state ID.
+ * @param data	[out] Buffer for the internal state.
+ * @param siz	[in] Size of data.
+ * @return 0 on success; -ENOENT if not present; -EINVAL if the size doesn't match; -ENOSYS if not supported.
+ */
+int ZomgSnapshot::loadInternal(InternalID id, void *data, size_t siz)
+{
+	if (id < 0 || id >= INTERNAL_MAX) {
+		m_lastError = -EINVAL;
+		return -EINVAL;
+	}
+
+	size_t chunkSize;
+	int ret = loadChunk((ChunkID)(CHUNK_INTERNAL + id), data, siz,
+			    ZOMG_BYTEORDER_8, &chunkSize);
+	if (ret < 0)
+		return ret;
+	// Internal state is stored verbatim, so the
+	// size must match exactly.
+	if (chunkSize != siz) {
+		m_lastError = -EINVAL;
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/** Save functions. **/
+
+/** VDP **/
+
+int ZomgSnapshot::saveVdpReg(const uint8_t *reg, size_t siz)
+	{ return saveChunk(CHUNK_VDP_REG, reg, siz); }
+int ZomgSnapshot::saveVdpCtrl_8(const Zomg_VDP_ctrl_8_t *ctrl)
+	{ return saveChunk(CHUNK_VDP_CTRL_8, ctrl, sizeof(*ctrl)); }
+int ZomgSnapshot::saveVdpCtrl_16(const Zomg_VDP_ctrl_16_t *ctrl)
+	{ return saveChunk(CHUNK_VDP_CTRL_16, ctrl, sizeof(*ctrl)); }
+int ZomgSnapshot::saveVRam(const void *vram, size_t siz, ZomgByteorder_t byteorder)
+	{ return saveChunk(CHUNK_VRAM, vram, siz, byteorder); }
+int ZomgSnapshot::saveCRam(const Zomg_CRam_t *cram, ZomgByteorder_t byteorder)
+	{ return saveChunk(CHUNK_CRAM, cram, sizeof(*cram), byteorder); }
+
+/** VDP (MD-specific) **/
+
+int ZomgSnapshot::saveMD_VSRam(const uint16_t *vsram, size_t siz, ZomgByteorder_t byteorder)
+	{ return saveChunk(CHUNK_MD_VSRAM, vsram, siz, byteorder); }
+int ZomgSnapshot::saveMD_VDP_SAT(const void *vdp_sat, size_t siz, ZomgByteorder_t byteorder)
+	{ return saveChunk(CHUNK_MD_VDP_SAT, vdp_sat, siz, byteorder); }
+
+/** Audio **/
+
+int ZomgSnapshot::savePsgReg(const Zomg_PsgSave_t *state)
+	{ return saveChunk(CHUNK_PSG_REG, state, sizeof(*state)); }
+int ZomgSnapshot::saveMD_YM2612_reg(const Zomg_Ym2612Save_t *state)
+	{ return saveChunk(CHUNK_MD_YM2612_REG, state, sizeof(*state)); }
+
+/** Z80 **/
+
+int ZomgSnapshot::saveZ80Mem(const uint8_t *mem, size_t siz)
+	{ return saveChunk(CHUNK_Z80_MEM, mem, siz); }
+int ZomgSnapshot::saveZ80Reg(const Zomg_Z80RegSave_t *state)
+	{ return saveChunk(CHUNK_Z80_REG, state, sizeof(*state)); }
+
+/** M68K (MD-specific) **/
+
+int ZomgSnapshot::saveM68KMem(const uint16_t *mem, size_t siz, ZomgByteorder_t byteorder)
+	{ return saveChunk(CHUNK_M68K_MEM, mem, siz, byteorder); }
+int ZomgSnapshot::saveM68KReg(const Zomg_M68KRegSave_t *state)
+	{ return saveChunk(CHUNK_M68K_REG, state, sizeof(*state)); }
+
+/** MD-specific registers **/
+
+int ZomgSnapshot::saveMD_IO(const Zomg_MD_IoSave_t *state)
+	{ return saveChunk(CHUNK_MD_IO, state, sizeof(*state)); }
+int ZomgSnapshot::saveMD_Z80Ctrl(const Zomg_MD_Z80CtrlSave_t *state)
+	{ return saveChunk(CHUNK_MD_Z80_CTRL, state, sizeof(*state)); }
+int ZomgSnapshot::saveMD_TimeReg(const Zomg_MD_TimeReg_t *state)
+	{ return saveChunk(CHUNK_MD_TIME_REG, state, sizeof(*state)); }
+int ZomgSnapshot::saveMD_TMSS_reg(const Zomg_MD_TMSS_reg_t *tmss)
+	{ return saveChunk(CHUNK_MD_TMSS_REG, tmss, sizeof(*tmss)); }
+
+/** Miscellaneous **/
+
+int ZomgSnapshot::saveSRam(const uint8_t *sram, size_t siz)
+	{ return saveChunk(CHUNK_SRAM, sram, siz); }
+int ZomgSnapshot::saveEEPRomCtrl(const Zomg_EPR_ctrl_t *ctrl)
+	{ return saveChunk(CHUNK_EEPROM_CTRL, ctrl, sizeof(*ctrl)); }
+int ZomgSnapshot::saveEEPRomCache(const uint8_t *cache, size_t siz)
+	{ return saveChunk(CHUNK_EEPROM_CACHE, cache, siz); }
+int ZomgSnapshot::saveEEPRom(const uint8_t *eeprom, size_t siz)
+	{ return saveChunk(CHUNK_EEPROM, eeprom, siz); }
+
+/** Emulator-internal state **/
+
+/**
+ * Save emulator-internal state.
+ * @param id	[in] Internal state ID.
+ * @param data	[in] Internal state.
+ * @param siz	[in] Size of data.
+ * @return 0 on success; -ENOSYS if not supported.
+ */
+int ZomgSnapshot::saveInternal(InternalID id, const void *data, size_t siz)
+{
+	if (id < 0 || id >= INTERNAL_MAX) {
+		m_lastError = -EINVAL;
+		return -EINVAL;
+	}
+	return saveChunk((ChunkID)(CHUNK_INTERNAL + id), data, siz);
+}
+
+}
@@ -0,0 +1,299 @@
+/***************************************************************************
+ * libzomg: Zipped Original Memory from Genesis.                           *
+ * ZomgSnapshot.hpp: In-memory savestate snapshot.                         *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * ZomgSnapshot stores the same data as a ZOMG file, but as a
+ * flat binary blob in memory. There's no compression, no preview
+ * image, no metadata, and no filesystem access.
+ *
+ * Snapshots are intended for rewind, run-ahead, and automated
+ * testing. Structs and memory blocks are stored in host byteorder,
+ * so snapshots should not be saved to disk or moved between hosts.
+ * Use Zomg for that.
+ *
+ * Blob layout:
+ * - Header: magic, version, system ID, total size.
+ * - Chunks: 8-byte header (ID, byteorder, size), followed by
+ *   the data, padded to a multiple of 8 bytes.
+ */
+
+#ifndef __LIBZOMG_ZOMGSNAPSHOT_HPP__
+#define __LIBZOMG_ZOMGSNAPSHOT_HPP__
+
+#include "ZomgBase.hpp"
+
+// C includes. (C++ namespace)
+#include <cstddef>
+
+namespace LibZomg {
+
+class ZomgSnapshot : public ZomgBase
+{
+	public:
+		/**
+		 * Create a snapshot in the specified buffer.
+		 * If the buffer is too small, nothing else will be written,
+		 * but size() will still return the required size.
+		 * @param buf	[out] Buffer. (May be nullptr to determine the required size.)
+		 * @param siz	[in] Size of buf.
+		 * @param system	[in] System ID.
+		 */
+		ZomgSnapshot(void *buf, size_t siz, uint32_t system);
+
+		/**
+		 * Open a snapshot for loading.
+		 * If the snapshot is invalid, isOpen() will return false.
+		 * @param buf	[in] Snapshot.
+		 * @param siz	[in] Size of buf.
+		 */
+		ZomgSnapshot(const void *buf, size_t siz);
+
+		virtual ~ZomgSnapshot();
+
+	private:
+		// Q_DISABLE_COPY() equivalent.
+		// TODO: Add LibZomg-specific version of Q_DISABLE_COPY().
+		ZomgSnapshot(const ZomgSnapshot &);
+		ZomgSnapshot &operator=(const ZomgSnapshot &);
+
+	public:
+		// Snapshot format version.
+		// Increment this if any chunk's contents change.
+		static const uint16_t SNAPSHOT_VERSION = 2;
+
+		// System IDs.
+		enum SnapshotSystem {
+			SNAPSHOT_SYS_MD		= 1,
+			SNAPSHOT_SYS_PICO	= 2,
+		};
+
+		virtual void close(void) final;
+
+		/**
+		 * Get the snapshot size.
+		 * ZOMG_SAVE: Number of bytes required for the snapshot.
+		 * ZOMG_LOAD: Size of the snapshot, from its header.
+		 * @return Snapshot size, in bytes.
+		 */
+		inline size_t size(void) const
+			{ return m_pos; }
+
+		/**
+		 * Did the snapshot fit in the buffer?
+		 * Only valid in ZOMG_SAVE mode.
+		 * @return True if the snapshot fit; false if the buffer was too small.
+		 */
+		inline bool isComplete(void) const
+			{ return (m_pos <= m_siz); }
+
+		/**
+		 * Get the snapshot's system ID.
+		 * @return System ID.
+		 */
+		inline uint32_t system(void) const
+			{ return m_system; }
+
+		/**
+		 * Copy the snapshot to another ZOMG object.
+		 * This can be used to write a snapshot to a ZOMG file
+		 * without access to the emulation context, e.g. from
+		 * a background thread.
+		 * Only valid in ZOMG_LOAD mode.
+		 * @param zomg	[in,out] Destination ZOMG object. (must be in ZOMG_SAVE mode)
+		 * @return 0 on success; negative errno on error.
+		 */
+		int copyTo(ZomgBase *zomg);
+
+		/**
+		 * Load savestate functions.
+		 * @return Bytes read on success; negative errno on error.
+		 */
+
+		// VDP
+		virtual int loadVdpReg(uint8_t *reg, size_t siz) final;
+		virtual int loadVdpCtrl_8(_Zomg_VDP_ctrl_8_t *ctrl) final;
+		virtual int loadVdpCtrl_16(_Zomg_VDP_ctrl_16_t *ctrl) final;
+		virtual int loadVRam(void *vram, size_t siz, ZomgByteorder_t byteorder) final;
+		virtual int loadCRam(_Zomg_CRam_t *cram, ZomgByteorder_t byteorder) final;
+		/// MD-specific
+		virtual int loadMD_VSRam(uint16_t *vsram, size_t siz, ZomgByteorder_t byteorder) final;
+		virtual int loadMD_VDP_SAT(uint16_t *vdp_sat, size_t siz, ZomgByteorder_t byteorder) final;
+
+		// Audio
+		virtual int loadPsgReg(_Zomg_PsgSave_t *state) final;
+		/// MD-specific
+		virtual int loadMD_YM2612_reg(_Zomg_Ym2612Save_t *state) final;
+
+		// Z80
+		virtual int loadZ80Mem(uint8_t *mem, size_t siz) final;
+		virtual int loadZ80Reg(_Zomg_Z80RegSave_t *state) final;
+
+		// M68K (MD-specific)
+		virtual int loadM68KMem(uint16_t *mem, size_t siz, ZomgByteorder_t byteorder) final;
+		virtual int loadM68KReg(_Zomg_M68KRegSave_t *state) final;
+
+		// MD-specific registers
+		virtual int loadMD_IO(_Zomg_MD_IoSave_t *state) final;
+		virtual int loadMD_Z80Ctrl(_Zomg_MD_Z80CtrlSave_t *state) final;
+		virtual int loadMD_TimeReg(_Zomg_MD_TimeReg_t *state) final;
+		virtual int loadMD_TMSS_reg(_Zomg_MD_TMSS_reg_t *tmss) final;
+
+		// Miscellaneous
+		virtual int loadSRam(uint8_t *sram, size_t siz) final;
+		virtual int loadEEPRomCtrl(_Zomg_EPR_ctrl_t *ctrl) final;
+		virtual int loadEEPRomCache(uint8_t *cache, size_t siz) final;
+		virtual int loadEEPRom(uint8_t *eeprom, size_t siz) final;
+
+		// Emulator-internal state
+		virtual int loadInternal(InternalID id, void *data, size_t siz) final;
+
+		/**
+		 * Save savestate functions.
+		 * @return 0 on success; negative errno on error.
+		 */
+
+		// VDP
+		virtual int saveVdpReg(const uint8_t *reg, size_t siz) final;
+		virtual int saveVdpCtrl_8(const _Zomg_VDP_ctrl_8_t *ctrl) final;
+		virtual int saveVdpCtrl_16(const _Zomg_VDP_ctrl_16_t *ctrl) final;
+		virtual int saveVRam(const void *vram, size_t siz, ZomgByteorder_t byteorder) final;
+		virtual int saveCRam(const _Zomg_CRam_t *cram, ZomgByteorder_t byteorder) final;
+		/// MD-specific
+		virtual int saveMD_VSRam(const uint16_t *vsram, size_t siz, ZomgByteorder_t byteorder) final;
+		virtual int saveMD_VDP_SAT(const void *vdp_sat, size_t siz, ZomgByteorder_t byteorder) final;
+
+		// Audio
+		virtual int savePsgReg(const _Zomg_PsgSave_t *state) final;
+		/// MD-specific
+		virtual int saveMD_YM2612_reg(const _Zomg_Ym2612Save_t *state) final;
+
+		// Z80
+		virtual int saveZ80Mem(const uint8_t *mem, size_t siz) final;
+		virtual int saveZ80Reg(const _Zomg_Z80RegSave_t *state) final;
+
+		// M68K (MD-specific)
+		virtual int saveM68KMem(const uint16_t *mem, size_t siz, ZomgByteorder_t byteorder) final;
+		virtual int saveM68KReg(const _Zomg_M68KRegSave_t *state) final;
+
+		// MD-specific registers
+		virtual int saveMD_IO(const _Zomg_MD_IoSave_t *state) final;
+		virtual int saveMD_Z80Ctrl(const _Zomg_MD_Z80CtrlSave_t *state) final;
+		virtual int saveMD_TimeReg(const _Zomg_MD_TimeReg_t *state) final;
+		virtual int saveMD_TMSS_reg(const _Zomg_MD_TMSS_reg_t *tmss) final;
+
+		// Miscellaneous
+		virtual int saveSRam(const uint8_t *sram, size_t siz) final;
+		virtual int saveEEPRomCtrl(const _Zomg_EPR_ctrl_t *ctrl) final;
+		virtual int saveEEPRomCache(const uint8_t *cache, size_t siz) final;
+		virtual int saveEEPRom(const uint8_t *eeprom, size_t siz) final;
+
+		// Emulator-internal state
+		virtual int saveInternal(InternalID id, const void *data, size_t siz) final;
+
+	private:
+		// Chunk IDs.
+		enum ChunkID {
+			CHUNK_END = 0,
+
+			// VDP
+			CHUNK_VDP_REG,
+			CHUNK_VDP_CTRL_8,
+			CHUNK_VDP_CTRL_16,
+			CHUNK_VRAM,
+			CHUNK_CRAM,
+			CHUNK_MD_VSRAM,
+			CHUNK_MD_VDP_SAT,
+
+			// Audio
+			CHUNK_PSG_REG,
+			CHUNK_MD_YM2612_REG,
+
+			// CPUs
+			CHUNK_Z80_MEM,
+			CHUNK_Z80_REG,
+			CHUNK_M68K_MEM,
+			CHUNK_M68K_REG,
+
+			// MD-specific registers
+			CHUNK_MD_IO,
+			CHUNK_MD_Z80_CTRL,
+			CHUNK_MD_TIME_REG,
+			CHUNK_MD_TMSS_REG,
+
+			// Miscellaneous
+			CHUNK_SRAM,
+			CHUNK_EEPROM_CTRL,
+			CHUNK_EEPROM_CACHE,
+			CHUNK_EEPROM,
+
+			// Emulator-internal state.
+			// Chunk ID is CHUNK_INTERNAL + InternalID.
+			// These chunks aren't copied by copyTo().
+			CHUNK_INTERNAL = 0x80,
+		};
+
+		/**
+		 * Save a chunk.
+		 * @param id		[in] Chunk ID.
+		 * @param data		[in] Chunk data.
+		 * @param siz		[in] Size of data.
+		 * @param byteorder	[in] Byteorder of data.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int saveChunk(ChunkID id, const void *data, size_t siz,
+			      ZomgByteorder_t byteorder = ZOMG_BYTEORDER_8);
+
+		/**
+		 * Load a chunk.
+		 * @param id		[in] Chunk ID.
+		 * @param data		[out] Buffer for the chunk data.
+		 * @param siz		[in] Size of data.
+		 * @param byteorder	[in] Requested byteorder.
+		 * @param chunkSize	[out, opt] Size of the chunk in the snapshot.
+		 * @return Bytes read on success; negative errno on error.
+		 */
+		int loadChunk(ChunkID id, void *data, size_t siz,
+			      ZomgByteorder_t byteorder = ZOMG_BYTEORDER_8,
+			      size_t *chunkSize = nullptr);
+
+		// Snapshot buffer.
+		// Only one of these is valid, depending on m_mode.
+		uint8_t *m_wbuf;
+		const uint8_t *m_rbuf;
+		size_t m_siz;
+
+		// Current position.
+		// ZOMG_SAVE: End of the snapshot.
+		// ZOMG_LOAD: Total size of the snapshot.
+		size_t m_pos;
+
+		// ZOMG_LOAD: Position to start the next chunk search.
+		// Chunks are usually loaded in the same order they're
+		// saved, so this is almost always the chunk we need.
+		size_t m_search;
+
+		// System ID.
+		uint32_t m_system;
+};
+
+}
+
+#endif /* __LIBZOMG_ZOMGSNAPSHOT_HPP__ */
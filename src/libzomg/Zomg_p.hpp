@@ -26,6 +26,12 @@
 #include "minizip/zip.h"
 #include "minizip/unzip.h"
 
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <vector>
+
 namespace LibZomg {
 
 class Zomg;
@@ -56,6 +62,44 @@ class ZomgPrivate
 		int initZomgLoad(const char *filename);
 		int initZomgSave(const char *filename);
 
+		/**
+		 * Open a ZOMG file for reading.
+		 * Only the Zip central directory is read.
+		 * @param filename ZOMG file.
+		 * @return unzFile handle, or nullptr on error.
+		 */
+		static unzFile openUnz(const char *filename);
+
+		/**
+		 * Read a file from a ZOMG file.
+		 * @param unz unzFile handle.
+		 * @param filename Filename to load from the ZOMG file.
+		 * @param buf Buffer to store the file in.
+		 * @param len Length of the buffer.
+		 * @return Length of file loaded, or negative number on error.
+		 */
+		static int readFromUnz(unzFile unz, const char *filename, void *buf, int len);
+
+		/**
+		 * Prefetched file.
+		 * See Zomg::prefetch().
+		 */
+		struct PrefetchEntry {
+			const char *filename;		// Filename in the ZOMG file.
+			std::vector<uint8_t> data;	// File data.
+			int ret;			// Result of readFromUnz().
+		};
+		std::vector<PrefetchEntry> prefetched;
+
+		/**
+		 * Prefetch thread function.
+		 * Each thread opens its own unzFile handle,
+		 * since MiniZip handles can't be shared.
+		 * @param zomgFilename ZOMG file.
+		 * @param entry Prefetched file.
+		 */
+		static void prefetchThread(const char *zomgFilename, PrefetchEntry *entry);
+
 		/**
 		 * File type.
 		 * This maps directly to Zip internal file attributes.
@@ -65,6 +109,25 @@ class ZomgPrivate
 			ZOMG_FILE_TEXT = 1,
 		};
 
+		// Compression settings for saving.
+		// Initialized from the defaults in the constructor.
+		int compression;	// Zomg::CompressionProfile
+		bool previewEnabled;
+
+		// Default compression settings.
+		static int ms_defaultCompression;
+		static bool ms_defaultPreviewEnabled;
+
+		/**
+		 * Open a new file in the ZOMG file.
+		 * @param filename	[in] Filename in the ZOMG file.
+		 * @param fileType	[in] File type, e.g. binary or text.
+		 * @param compress	[in] If true, compress the file using the current compression profile.
+		 * @return 0 on success; negative errno on error.
+		 */
+		int openFileInZomg(const char *filename,
+				   ZomgZipFileType_t fileType, bool compress);
+
 		int loadFromZomg(const char *filename, void *buf, int len);
 		int saveToZomg(const char *filename, const void *buf, int len,
 			       ZomgZipFileType_t fileType = ZOMG_FILE_BINARY);
@@ -0,0 +1,260 @@
+/***************************************************************************
+ * libzomg/tests: Zipped Original Memory from Genesis. (Test Suite)        *
+ * PngWriterTest.cpp: PNG writer tests.                                    *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// PngWriter
+#include "PngWriter.hpp"
+#include "PngReader.hpp"
+#include "img_data.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibZomg { namespace Tests {
+
+class PngWriterTest : public ::testing::Test
+{
+	protected:
+		PngWriterTest() { }
+		virtual ~PngWriterTest() { }
+
+		virtual void SetUp(void) override;
+		virtual void TearDown(void) override;
+
+		/**
+		 * Initialize an image.
+		 * @param img_data	[out] Image data.
+		 * @param bpp		[in] Color depth. (15, 16, 32)
+		 */
+		void initImage(Zomg_Img_Data_t *img_data, int bpp);
+
+		/**
+		 * Get the expected 32-bit color of a pixel.
+		 * @param bpp Color depth. (15, 16, 32)
+		 * @param x X coordinate.
+		 * @param y Y coordinate.
+		 * @return Expected 32-bit color. (0x00RRGGBB)
+		 */
+		uint32_t expectedPixel(int bpp, int x, int y) const;
+
+		/**
+		 * Write an image, read it back, and compare it.
+		 * @param pngWriter PngWriter.
+		 * @param bpp Color depth. (15, 16, 32)
+		 */
+		void checkRoundTrip(PngWriter *pngWriter, int bpp);
+
+	protected:
+		static const char filename[];
+
+		// Odd width to test the non-SIMD tail.
+		// The pitch is larger than the width.
+		static const int width = 37;
+		static const int height = 5;
+		static const int pitch = 48;	// in pixels
+
+		uint16_t img16[pitch * height];
+		uint32_t img32[pitch * height];
+};
+
+const char PngWriterTest::filename[] = "PngWriterTest.png";
+
+/**
+ * Initialize the test data.
+ */
+void PngWriterTest::SetUp(void)
+{
+	for (int i = 0; i < pitch * height; i++) {
+		img16[i] = (uint16_t)(i * 0x1D3B);
+		img32[i] = (uint32_t)(i * 0x03A7C9) | 0xAB000000;
+	}
+}
+
+/**
+ * Delete the test file.
+ */
+void PngWriterTest::TearDown(void)
+{
+	remove(filename);
+}
+
+/**
+ * Initialize an image.
+ * @param img_data	[out] Image data.
+ * @param bpp		[in] Color depth. (15, 16, 32)
+ */
+void PngWriterTest::initImage(Zomg_Img_Data_t *img_data, int bpp)
+{
+	memset(img_data, 0, sizeof(*img_data));
+	img_data->w = width;
+	img_data->h = height;
+	img_data->bpp = bpp;
+	if (bpp == 32) {
+		img_data->data = img32;
+		img_data->pitch = pitch * sizeof(uint32_t);
+	} else {
+		img_data->data = img16;
+		img_data->pitch = pitch * sizeof(uint16_t);
+	}
+}
+
+/**
+ * Get the expected 32-bit color of a pixel.
+ * @param bpp Color depth. (15, 16, 32)
+ * @param x X coordinate.
+ * @param y Y coordinate.
+ * @return Expected 32-bit color. (0x00RRGGBB)
+ */
+uint32_t PngWriterTest::expectedPixel(int bpp, int x, int y) const
+{
+	if (bpp == 32) {
+		return (img32[(y * pitch) + x] & 0xFFFFFF);
+	}
+
+	const unsigned int px = img16[(y * pitch) + x];
+	unsigned int r, g, b;
+	if (bpp == 15) {
+		r = (px >> 10) & 0x1F;
+		g = (px >> 5) & 0x1F;
+		b = px & 0x1F;
+		r = (r << 3) | (r >> 2);
+		g = (g << 3) | (g >> 2);
+		b = (b << 3) | (b >> 2);
+	} else {
+		r = (px >> 11) & 0x1F;
+		g = (px >> 5) & 0x3F;
+		b = px & 0x1F;
+		r = (r << 3) | (r >> 2);
+		g = (g << 2) | (g >> 4);
+		b = (b << 3) | (b >> 2);
+	}
+	return (r << 16) | (g << 8) | b;
+}
+
+/**
+ * Write an image, read it back, and compare it.
+ * @param pngWriter PngWriter.
+ * @param bpp Color depth. (15, 16, 32)
+ */
+void PngWriterTest::checkRoundTrip(PngWriter *pngWriter, int bpp)
+{
+	Zomg_Img_Data_t img_data;
+	initImage(&img_data, bpp);
+	ASSERT_EQ(0, pngWriter->writeToFile(&img_data, filename));
+
+	// Read the image back.
+	// PngReader always returns 32-bit color.
+	Zomg_Img_Data_t img_load;
+	memset(&img_load, 0, sizeof(img_load));
+	PngReader pngReader;
+	ASSERT_EQ(0, pngReader.readFromFile(&img_load, filename, PngReader::RF_INVERTED_ALPHA));
+	EXPECT_EQ((uint32_t)width, img_load.w);
+	EXPECT_EQ((uint32_t)height, img_load.h);
+	ASSERT_EQ(32, img_load.bpp);
+
+	for (int y = 0; y < height; y++) {
+		const uint32_t *row = (const uint32_t*)((const uint8_t*)img_load.data + (y * img_load.pitch));
+		for (int x = 0; x < width; x++) {
+			EXPECT_EQ(expectedPixel(bpp, x, y), row[x] & 0xFFFFFF)
+				<< "bpp == " << bpp << ", x == " << x << ", y == " << y;
+		}
+	}
+	free(img_load.data);
+}
+
+/**
+ * Write a 15-bit image.
+ */
+TEST_F(PngWriterTest, write15)
+{
+	PngWriter pngWriter;
+	checkRoundTrip(&pngWriter, 15);
+}
+
+/**
+ * Write a 16-bit image.
+ */
+TEST_F(PngWriterTest, write16)
+{
+	PngWriter pngWriter;
+	checkRoundTrip(&pngWriter, 16);
+}
+
+/**
+ * Write a 32-bit image.
+ */
+TEST_F(PngWriterTest, write32)
+{
+	PngWriter pngWriter;
+	checkRoundTrip(&pngWriter, 32);
+}
+
+/**
+ * Write images with each filter strategy and compression level.
+ */
+TEST_F(PngWriterTest, encoderSettings)
+{
+	PngWriter pngWriter;
+	EXPECT_EQ(5, pngWriter.compressionLevel());
+	EXPECT_EQ(PngWriter::FILTER_NONE, pngWriter.filterStrategy());
+
+	static const int levels[] = {0, 1, 9};
+	for (int i = 0; i < (int)(sizeof(levels)/sizeof(levels[0])); i++) {
+		pngWriter.setCompressionLevel(levels[i]);
+		EXPECT_EQ(levels[i], pngWriter.compressionLevel());
+		for (int f = PngWriter::FILTER_NONE; f < PngWriter::FILTER_MAX; f++) {
+			pngWriter.setFilterStrategy((PngWriter::FilterStrategy)f);
+			checkRoundTrip(&pngWriter, 16);
+			checkRoundTrip(&pngWriter, 32);
+		}
+	}
+
+	// Out-of-range compression levels are clamped.
+	pngWriter.setCompressionLevel(12);
+	EXPECT_EQ(9, pngWriter.compressionLevel());
+	pngWriter.setCompressionLevel(-1);
+	EXPECT_EQ(0, pngWriter.compressionLevel());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibZomg test suite: PngWriter tests.\n\n");
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
@@ -0,0 +1,318 @@
+/***************************************************************************
+ * libzomg/tests: Zipped Original Memory from Genesis. (Test Suite)        *
+ * ZomgLoadTest.cpp: ZOMG file loading tests.                              *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Zomg
+#include "Zomg.hpp"
+#include "Metadata.hpp"
+#include "img_data.h"
+#include "zomg_psg.h"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibZomg { namespace Tests {
+
+class ZomgLoadTest : public ::testing::Test
+{
+	protected:
+		ZomgLoadTest() { }
+		virtual ~ZomgLoadTest() { }
+
+		virtual void SetUp(void) override;
+		virtual void TearDown(void) override;
+
+		/**
+		 * Save the test data to a ZOMG file.
+		 * @param sram If true, save SRAM.
+		 * @param compression Compression profile.
+		 */
+		void saveTestData(bool sram,
+			Zomg::CompressionProfile compression = Zomg::CP_DEFAULT) const;
+
+		/**
+		 * Get the size of the test file.
+		 * @return File size, or -1 on error.
+		 */
+		static long fileSize(void);
+
+		/**
+		 * Load the test data from a ZOMG file and compare it.
+		 * @param zomg ZOMG file.
+		 * @param sram If true, SRAM should be present.
+		 */
+		void checkTestData(Zomg *zomg, bool sram) const;
+
+	protected:
+		static const char filename[];
+
+		uint16_t vram[32768];
+		uint16_t m68k_mem[32768];
+		uint8_t z80_mem[8192];
+		uint8_t sram[16384];
+		_Zomg_PsgSave_t psg;
+};
+
+const char ZomgLoadTest::filename[] = "ZomgLoadTest.zomg";
+
+/**
+ * Initialize the test data.
+ */
+void ZomgLoadTest::SetUp(void)
+{
+	for (int i = 0; i < (int)(sizeof(vram)/sizeof(vram[0])); i++) {
+		vram[i] = (uint16_t)(i ^ 0x5AA5);
+		m68k_mem[i] = (uint16_t)(i * 7);
+	}
+	for (int i = 0; i < (int)sizeof(z80_mem); i++) {
+		z80_mem[i] = (uint8_t)(i * 3);
+	}
+	for (int i = 0; i < (int)sizeof(sram); i++) {
+		sram[i] = (uint8_t)(i >> 3);
+	}
+	memset(&psg, 0, sizeof(psg));
+	psg.tone_reg[0] = 0x123;
+	psg.lfsr_state = 0x8000;
+}
+
+/**
+ * Delete the test file.
+ */
+void ZomgLoadTest::TearDown(void)
+{
+	remove(filename);
+}
+
+/**
+ * Save the test data to a ZOMG file.
+ * @param sram If true, save SRAM.
+ * @param compression Compression profile.
+ */
+void ZomgLoadTest::saveTestData(bool sram, Zomg::CompressionProfile compression) const
+{
+	Zomg zomg(filename, Zomg::ZOMG_SAVE);
+	ASSERT_TRUE(zomg.isOpen());
+	zomg.setCompressionProfile(compression);
+
+	Metadata metadata;
+	metadata.setSystemId("MD");
+	ASSERT_EQ(0, zomg.saveZomgIni(&metadata));
+
+	EXPECT_EQ(0, zomg.saveVRam(vram, sizeof(vram), ZOMG_BYTEORDER_16H));
+	EXPECT_EQ(0, zomg.saveM68KMem(m68k_mem, sizeof(m68k_mem), ZOMG_BYTEORDER_16H));
+	EXPECT_EQ(0, zomg.saveZ80Mem(z80_mem, sizeof(z80_mem)));
+	EXPECT_EQ(0, zomg.savePsgReg(&psg));
+	if (sram) {
+		EXPECT_EQ(0, zomg.saveSRam(this->sram, sizeof(this->sram)));
+	}
+	zomg.close();
+}
+
+/**
+ * Get the size of the test file.
+ * @return File size, or -1 on error.
+ */
+long ZomgLoadTest::fileSize(void)
+{
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+		return -1;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+/**
+ * Load the test data from a ZOMG file and compare it.
+ * @param zomg ZOMG file.
+ * @param sram If true, SRAM should be present.
+ */
+void ZomgLoadTest::checkTestData(Zomg *zomg, bool sram) const
+{
+	vector<uint16_t> vram_load(sizeof(vram)/sizeof(vram[0]));
+	EXPECT_EQ((int)sizeof(vram), zomg->loadVRam(vram_load.data(), sizeof(vram), ZOMG_BYTEORDER_16H));
+	EXPECT_EQ(0, memcmp(vram, vram_load.data(), sizeof(vram)));
+
+	vector<uint16_t> m68k_load(sizeof(m68k_mem)/sizeof(m68k_mem[0]));
+	EXPECT_EQ((int)sizeof(m68k_mem), zomg->loadM68KMem(m68k_load.data(), sizeof(m68k_mem), ZOMG_BYTEORDER_16H));
+	EXPECT_EQ(0, memcmp(m68k_mem, m68k_load.data(), sizeof(m68k_mem)));
+
+	// Load a partial file.
+	vector<uint8_t> z80_load(sizeof(z80_mem) / 2);
+	EXPECT_EQ((int)z80_load.size(), zomg->loadZ80Mem(z80_load.data(), z80_load.size()));
+	EXPECT_EQ(0, memcmp(z80_mem, z80_load.data(), z80_load.size()));
+
+	_Zomg_PsgSave_t psg_load;
+	EXPECT_EQ((int)sizeof(psg_load), zomg->loadPsgReg(&psg_load));
+	EXPECT_EQ(0, memcmp(&psg, &psg_load, sizeof(psg)));
+
+	vector<uint8_t> sram_load(sizeof(this->sram));
+	if (sram) {
+		EXPECT_EQ((int)sizeof(this->sram), zomg->loadSRam(sram_load.data(), sram_load.size()));
+		EXPECT_EQ(0, memcmp(this->sram, sram_load.data(), sizeof(this->sram)));
+	} else {
+		EXPECT_EQ(-ENOENT, zomg->loadSRam(sram_load.data(), sram_load.size()));
+	}
+}
+
+/**
+ * Load a ZOMG file without prefetching.
+ */
+TEST_F(ZomgLoadTest, loadLazy)
+{
+	saveTestData(true);
+	Zomg zomg(filename, Zomg::ZOMG_LOAD);
+	ASSERT_TRUE(zomg.isOpen());
+	checkTestData(&zomg, true);
+}
+
+/**
+ * Load a ZOMG file with prefetching.
+ */
+TEST_F(ZomgLoadTest, loadPrefetch)
+{
+	saveTestData(true);
+	Zomg zomg(filename, Zomg::ZOMG_LOAD);
+	ASSERT_TRUE(zomg.isOpen());
+	EXPECT_EQ(0, zomg.prefetch(true));
+	checkTestData(&zomg, true);
+
+	// Files can be loaded more than once.
+	checkTestData(&zomg, true);
+}
+
+/**
+ * Prefetch a ZOMG file that doesn't have SRAM.
+ */
+TEST_F(ZomgLoadTest, prefetchNoSRam)
+{
+	saveTestData(false);
+	Zomg zomg(filename, Zomg::ZOMG_LOAD);
+	ASSERT_TRUE(zomg.isOpen());
+	EXPECT_EQ(0, zomg.prefetch(true));
+	checkTestData(&zomg, false);
+}
+
+/**
+ * Save and load a ZOMG file with each compression profile.
+ */
+TEST_F(ZomgLoadTest, compressionProfiles)
+{
+	long sizes[Zomg::CP_MAX];
+	for (int i = 0; i < Zomg::CP_MAX; i++) {
+		saveTestData(true, (Zomg::CompressionProfile)i);
+		sizes[i] = fileSize();
+		ASSERT_GT(sizes[i], 0);
+
+		Zomg zomg(filename, Zomg::ZOMG_LOAD);
+		ASSERT_TRUE(zomg.isOpen());
+		EXPECT_EQ(0, zomg.prefetch(true));
+		checkTestData(&zomg, true);
+	}
+
+	// Stored files aren't compressed at all.
+	EXPECT_GT(sizes[Zomg::CP_STORE], (long)(sizeof(vram) + sizeof(m68k_mem) + sizeof(z80_mem)));
+	EXPECT_LT(sizes[Zomg::CP_DEFAULT], sizes[Zomg::CP_STORE]);
+	EXPECT_LE(sizes[Zomg::CP_BEST], sizes[Zomg::CP_FAST]);
+}
+
+/**
+ * The preview image can be disabled.
+ */
+TEST_F(ZomgLoadTest, previewDisabled)
+{
+	uint32_t pixels[16*16];
+	for (int i = 0; i < 16*16; i++) {
+		pixels[i] = (uint32_t)(i * 0x010203);
+	}
+	Zomg_Img_Data_t img_data;
+	memset(&img_data, 0, sizeof(img_data));
+	img_data.data = pixels;
+	img_data.w = 16;
+	img_data.h = 16;
+	img_data.pitch = 16 * sizeof(uint32_t);
+	img_data.bpp = 32;
+	img_data.phys_x = 4;
+	img_data.phys_y = 4;
+
+	for (int preview = 0; preview <= 1; preview++) {
+		{
+			Zomg zomg(filename, Zomg::ZOMG_SAVE);
+			ASSERT_TRUE(zomg.isOpen());
+			zomg.setPreviewEnabled(!!preview);
+			Metadata metadata;
+			metadata.setSystemId("MD");
+			ASSERT_EQ(0, zomg.saveZomgIni(&metadata));
+			EXPECT_EQ(0, zomg.savePreview(&img_data));
+			zomg.close();
+		}
+
+		Zomg zomg(filename, Zomg::ZOMG_LOAD);
+		ASSERT_TRUE(zomg.isOpen());
+		Zomg_Img_Data_t img_load;
+		memset(&img_load, 0, sizeof(img_load));
+		if (preview) {
+			EXPECT_EQ(0, zomg.loadPreview(&img_load));
+			EXPECT_EQ(16U, img_load.w);
+			EXPECT_EQ(16U, img_load.h);
+			free(img_load.data);
+		} else {
+			EXPECT_EQ(-ENOENT, zomg.loadPreview(&img_load));
+		}
+	}
+}
+
+/**
+ * prefetch() only works in ZOMG_LOAD mode.
+ */
+TEST_F(ZomgLoadTest, prefetchNotLoading)
+{
+	Zomg zomg(filename, Zomg::ZOMG_SAVE);
+	ASSERT_TRUE(zomg.isOpen());
+	EXPECT_EQ(-EBADF, zomg.prefetch(true));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibZomg test suite: ZOMG loading tests.\n\n");
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"
@@ -0,0 +1,271 @@
+/***************************************************************************
+ * libzomg/tests: Zipped Original Memory from Genesis. (Test Suite)        *
+ * ZomgSnapshotTest.cpp: In-memory snapshot tests.                         *
+ *                                                                         *
+ * Copyright (c) 2015 by David Korth.                                      *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// ZomgSnapshot
+#include "ZomgSnapshot.hpp"
+#include "zomg_vdp.h"
+#include "zomg_psg.h"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibZomg { namespace Tests {
+
+class ZomgSnapshotTest : public ::testing::Test
+{
+	protected:
+		ZomgSnapshotTest() { }
+		virtual ~ZomgSnapshotTest() { }
+
+		virtual void SetUp(void) override;
+
+		/**
+		 * Save the test data to a snapshot.
+		 * @param snapshot Snapshot.
+		 */
+		void saveTestData(ZomgSnapshot *snapshot) const;
+
+	protected:
+		uint8_t vdp_reg[24];
+		uint16_t vram[32768];
+		_Zomg_PsgSave_t psg;
+};
+
+/**
+ * Initialize the test data.
+ */
+void ZomgSnapshotTest::SetUp(void)
+{
+	for (int i = 0; i < (int)sizeof(vdp_reg); i++) {
+		vdp_reg[i] = (uint8_t)(i * 3);
+	}
+	for (int i = 0; i < (int)(sizeof(vram)/sizeof(vram[0])); i++) {
+		vram[i] = (uint16_t)(i ^ 0x5AA5);
+	}
+	memset(&psg, 0, sizeof(psg));
+	psg.tone_reg[0] = 0x123;
+	psg.tone_reg[3] = 0x4;
+	psg.lfsr_state = 0x8000;
+}
+
+/**
+ * Save the test data to a snapshot.
+ * @param snapshot Snapshot.
+ */
+void ZomgSnapshotTest::saveTestData(ZomgSnapshot *snapshot) const
+{
+	snapshot->saveVdpReg(vdp_reg, sizeof(vdp_reg));
+	snapshot->saveVRam(vram, sizeof(vram), ZOMG_BYTEORDER_16H);
+	snapshot->savePsgReg(&psg);
+}
+
+/**
+ * Save and load a snapshot.
+ */
+TEST_F(ZomgSnapshotTest, roundTrip)
+{
+	// Determine the required size.
+	ZomgSnapshot sizer(nullptr, 0, ZomgSnapshot::SNAPSHOT_SYS_MD);
+	saveTestData(&sizer);
+	sizer.close();
+	const size_t siz = sizer.size();
+	ASSERT_GT(siz, sizeof(vram));
+
+	// Save the snapshot.
+	vector<uint8_t> buf(siz);
+	ZomgSnapshot save(buf.data(), buf.size(), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	saveTestData(&save);
+	save.close();
+	ASSERT_TRUE(save.isComplete());
+	EXPECT_EQ(siz, save.size());
+
+	// Load the snapshot, in a different order.
+	ZomgSnapshot load(buf.data(), buf.size());
+	ASSERT_TRUE(load.isOpen());
+	EXPECT_EQ((uint32_t)ZomgSnapshot::SNAPSHOT_SYS_MD, load.system());
+
+	_Zomg_PsgSave_t psg_load;
+	memset(&psg_load, 0xFF, sizeof(psg_load));
+	EXPECT_EQ((int)sizeof(psg_load), load.loadPsgReg(&psg_load));
+	EXPECT_EQ(0, memcmp(&psg, &psg_load, sizeof(psg)));
+
+	uint8_t vdp_reg_load[24];
+	EXPECT_EQ((int)sizeof(vdp_reg_load), load.loadVdpReg(vdp_reg_load, sizeof(vdp_reg_load)));
+	EXPECT_EQ(0, memcmp(vdp_reg, vdp_reg_load, sizeof(vdp_reg)));
+
+	vector<uint16_t> vram_load(sizeof(vram)/sizeof(vram[0]));
+	EXPECT_EQ((int)sizeof(vram), load.loadVRam(vram_load.data(), sizeof(vram), ZOMG_BYTEORDER_16H));
+	EXPECT_EQ(0, memcmp(vram, vram_load.data(), sizeof(vram)));
+
+	// Chunks that weren't saved can't be loaded.
+	uint8_t z80_mem[8192];
+	EXPECT_EQ(-ENOENT, load.loadZ80Mem(z80_mem, sizeof(z80_mem)));
+}
+
+/**
+ * Load a chunk into a buffer that's larger than the chunk.
+ * The rest of the buffer must be cleared.
+ */
+TEST_F(ZomgSnapshotTest, shortChunk)
+{
+	uint8_t buf[256];
+	ZomgSnapshot save(buf, sizeof(buf), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	save.saveVdpReg(vdp_reg, sizeof(vdp_reg));
+	save.close();
+	ASSERT_TRUE(save.isComplete());
+
+	ZomgSnapshot load(buf, save.size());
+	ASSERT_TRUE(load.isOpen());
+
+	uint8_t vdp_reg_load[32];
+	memset(vdp_reg_load, 0xFF, sizeof(vdp_reg_load));
+	EXPECT_EQ((int)sizeof(vdp_reg), load.loadVdpReg(vdp_reg_load, sizeof(vdp_reg_load)));
+	EXPECT_EQ(0, memcmp(vdp_reg, vdp_reg_load, sizeof(vdp_reg)));
+	for (size_t i = sizeof(vdp_reg); i < sizeof(vdp_reg_load); i++) {
+		EXPECT_EQ(0, vdp_reg_load[i]) << "vdp_reg_load[" << i << "]";
+	}
+}
+
+/**
+ * Save and load emulator-internal state.
+ */
+TEST_F(ZomgSnapshotTest, internalState)
+{
+	uint32_t internal[5];
+	for (int i = 0; i < 5; i++) {
+		internal[i] = (uint32_t)(0x12345678 * (i + 1));
+	}
+
+	uint8_t buf[256];
+	ZomgSnapshot save(buf, sizeof(buf), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	EXPECT_EQ(0, save.saveInternal(ZomgBase::INTERNAL_PSG, internal, sizeof(internal)));
+	save.close();
+	ASSERT_TRUE(save.isComplete());
+
+	ZomgSnapshot load(buf, save.size());
+	ASSERT_TRUE(load.isOpen());
+
+	uint32_t internal_load[5];
+	memset(internal_load, 0xFF, sizeof(internal_load));
+	EXPECT_EQ(0, load.loadInternal(ZomgBase::INTERNAL_PSG, internal_load, sizeof(internal_load)));
+	EXPECT_EQ(0, memcmp(internal, internal_load, sizeof(internal)));
+
+	// Internal state is verbatim, so the size must match.
+	EXPECT_EQ(-EINVAL, load.loadInternal(ZomgBase::INTERNAL_PSG, internal_load, sizeof(internal_load) - 4));
+	// Internal state that wasn't saved can't be loaded.
+	EXPECT_EQ(-ENOENT, load.loadInternal(ZomgBase::INTERNAL_M68K, internal_load, sizeof(internal_load)));
+
+	// Internal state isn't copied by copyTo().
+	uint8_t copy[256];
+	ZomgSnapshot dest(copy, sizeof(copy), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	EXPECT_EQ(0, load.copyTo(&dest));
+	dest.close();
+	ZomgSnapshot loadCopy(copy, dest.size());
+	ASSERT_TRUE(loadCopy.isOpen());
+	EXPECT_EQ(-ENOENT, loadCopy.loadInternal(ZomgBase::INTERNAL_PSG, internal_load, sizeof(internal_load)));
+}
+
+/**
+ * Save a snapshot to a buffer that's too small.
+ */
+TEST_F(ZomgSnapshotTest, bufferTooSmall)
+{
+	vector<uint8_t> buf(4096);
+	ZomgSnapshot save(buf.data(), buf.size(), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	saveTestData(&save);
+	save.close();
+	EXPECT_FALSE(save.isComplete());
+	EXPECT_GT(save.size(), buf.size());
+
+	// The incomplete snapshot must not be loadable.
+	ZomgSnapshot load(buf.data(), buf.size());
+	EXPECT_FALSE(load.isOpen());
+}
+
+/**
+ * Load a snapshot that isn't a snapshot.
+ */
+TEST_F(ZomgSnapshotTest, invalidSnapshot)
+{
+	uint8_t buf[64];
+	memset(buf, 0x55, sizeof(buf));
+	ZomgSnapshot load(buf, sizeof(buf));
+	EXPECT_FALSE(load.isOpen());
+	EXPECT_EQ(-EINVAL, load.lastError());
+}
+
+/**
+ * Copy a snapshot to another ZOMG object.
+ */
+TEST_F(ZomgSnapshotTest, copyTo)
+{
+	ZomgSnapshot sizer(nullptr, 0, ZomgSnapshot::SNAPSHOT_SYS_MD);
+	saveTestData(&sizer);
+	sizer.close();
+
+	vector<uint8_t> buf(sizer.size());
+	ZomgSnapshot save(buf.data(), buf.size(), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	saveTestData(&save);
+	save.close();
+	ASSERT_TRUE(save.isComplete());
+
+	// Copy the snapshot to a second snapshot.
+	// The copy should be identical.
+	vector<uint8_t> copy(buf.size());
+	ZomgSnapshot load(buf.data(), buf.size());
+	ASSERT_TRUE(load.isOpen());
+	ZomgSnapshot dest(copy.data(), copy.size(), ZomgSnapshot::SNAPSHOT_SYS_MD);
+	EXPECT_EQ(0, load.copyTo(&dest));
+	dest.close();
+	ASSERT_TRUE(dest.isComplete());
+	EXPECT_EQ(buf.size(), dest.size());
+	EXPECT_EQ(0, memcmp(buf.data(), copy.data(), buf.size()));
+
+	// copyTo() only works in ZOMG_LOAD mode.
+	ZomgSnapshot sizer2(nullptr, 0, ZomgSnapshot::SNAPSHOT_SYS_MD);
+	EXPECT_EQ(-EBADF, save.copyTo(&sizer2));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.cpp's main().
+ */
+static int test_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibZomg test suite: ZomgSnapshot tests.\n\n");
+	fflush(nullptr);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#include "libcompat/tests/gtest_main.inc.cpp"